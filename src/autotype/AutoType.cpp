@@ -19,13 +19,17 @@
 #include "AutoType.h"
 
 #include <QApplication>
+#include <QCache>
 #include <QDebug>
+#include <QMutex>
 #include <QPluginLoader>
 #include <QRegularExpression>
 #include <QUrl>
+#include <QtConcurrent>
 
 #include "config-keepassx.h"
 
+#include "autotype/AutoTypeMatchIndex.h"
 #include "autotype/AutoTypePlatformPlugin.h"
 #include "autotype/AutoTypeSelectDialog.h"
 #include "autotype/PickcharsDialog.h"
@@ -114,6 +118,100 @@ namespace
                                                         {"f14", Qt::Key_F14},
                                                         {"f15", Qt::Key_F15},
                                                         {"f16", Qt::Key_F16}};
+
+    // Sequences kept tokenized, sequences of all entries usually fit
+    const int MaxCachedSequences = 256;
+
+    struct SequenceToken
+    {
+        Qt::KeyboardModifiers modifiers;
+        // Full placeholder including braces and repeat, the inner placeholder as typed and in lower case
+        QString fullPlaceholder;
+        QString placeholder;
+        QString lowerPlaceholder;
+        int repeat = 1;
+        QString character;
+    };
+
+    struct TokenizedSequence
+    {
+        QVector<SequenceToken> tokens;
+        QString error;
+    };
+
+    TokenizedSequence tokenizeSequence(const QString& entrySequence)
+    {
+        TokenizedSequence result;
+
+        // Replace escaped braces with a template for easier regex
+        QString sequence = entrySequence;
+        sequence.replace("{{}", "{LEFTBRACE}");
+        sequence.replace("{}}", "{RIGHTBRACE}");
+
+        // Quick test for bracket syntax
+        if (sequence.count("{") != sequence.count("}")) {
+            result.error = QCoreApplication::translate("AutoType", "Bracket imbalance detected, found extra { or }");
+            return result;
+        }
+
+        // Group 1 = modifier key (opt)
+        // Group 2 = full placeholder
+        // Group 3 = inner placeholder (allows nested placeholders)
+        // Group 4 = repeat (opt)
+        // Group 5 = character
+        static const QRegularExpression regex("([+%^#]*)(?:({((?>[^{}]+?|(?2))+?)(?:\\s+(\\d+))?})|(.))");
+        auto results = regex.globalMatch(sequence);
+        while (results.hasNext()) {
+            auto match = results.next();
+            SequenceToken token;
+
+            // Parse modifier keys
+            const auto modifiers = match.captured(1);
+            if (modifiers.contains('+')) {
+                token.modifiers |= Qt::ShiftModifier;
+            }
+            if (modifiers.contains('^')) {
+                token.modifiers |= Qt::ControlModifier;
+            }
+            if (modifiers.contains('%')) {
+                token.modifiers |= Qt::AltModifier;
+            }
+            if (modifiers.contains('#')) {
+                token.modifiers |= Qt::MetaModifier;
+            }
+
+            token.fullPlaceholder = match.captured(2);
+            token.placeholder = match.captured(3);
+            token.lowerPlaceholder = token.placeholder.toLower();
+            if (!match.captured(4).isEmpty()) {
+                token.repeat = match.captured(4).toInt();
+            }
+            token.character = match.captured(5);
+            result.tokens.append(token);
+        }
+
+        return result;
+    }
+
+    /**
+     * Tokenize a sequence once, the tokens only depend on the sequence string
+     * while the placeholders are resolved against the entry on every use.
+     */
+    TokenizedSequence cachedTokenizeSequence(const QString& sequence)
+    {
+        static QCache<QString, TokenizedSequence> cache(MaxCachedSequences);
+        static QMutex mutex;
+
+        QMutexLocker locker(&mutex);
+        auto cached = cache.object(sequence);
+        if (cached) {
+            return *cached;
+        }
+
+        auto result = tokenizeSequence(sequence);
+        cache.insert(sequence, new TokenizedSequence(result));
+        return result;
+    }
 } // namespace
 
 AutoType* AutoType::m_instance = nullptr;
@@ -145,13 +243,10 @@ AutoType::AutoType(QObject* parent, bool test)
         pluginName += "test";
     }
 
-    QString pluginPath = resources()->pluginPath(pluginName);
-
-    if (!pluginPath.isEmpty()) {
 #ifdef WITH_XC_AUTOTYPE
-        loadPlugin(pluginPath);
+    // The plugin is loaded on first use, see plugin()
+    m_pluginPath = resources()->pluginPath(pluginName);
 #endif
-    }
 
     connect(qApp, SIGNAL(aboutToQuit()), SLOT(unloadPlugin()));
 }
@@ -195,6 +290,25 @@ void AutoType::loadPlugin(const QString& pluginPath)
     }
 }
 
+/**
+ * Get the platform plugin, loading it on first use.
+ *
+ * @return plugin or nullptr if Auto-Type is not available on this platform
+ */
+AutoTypePlatformInterface* AutoType::plugin()
+{
+    if (!m_pluginPath.isEmpty()) {
+        loadPlugin(m_pluginPath);
+        m_pluginPath.clear();
+    }
+    return m_plugin;
+}
+
+bool AutoType::isAvailable()
+{
+    return plugin();
+}
+
 void AutoType::unloadPlugin()
 {
     if (m_executor) {
@@ -226,7 +340,7 @@ void AutoType::createTestInstance()
 
 QStringList AutoType::windowTitles()
 {
-    if (!m_plugin) {
+    if (!plugin()) {
         return {};
     }
 
@@ -242,7 +356,7 @@ void AutoType::raiseWindow()
 
 bool AutoType::registerGlobalShortcut(Qt::Key key, Qt::KeyboardModifiers modifiers, QString* error)
 {
-    if (!m_plugin) {
+    if (!plugin()) {
         return false;
     }
 
@@ -364,7 +478,7 @@ void AutoType::executeAutoTypeActions(const Entry* entry,
  */
 void AutoType::performAutoType(const Entry* entry)
 {
-    if (!m_plugin) {
+    if (!plugin()) {
         return;
     }
 
@@ -380,7 +494,7 @@ void AutoType::performAutoType(const Entry* entry)
  */
 void AutoType::performAutoTypeWithSequence(const Entry* entry, const QString& sequence)
 {
-    if (!m_plugin) {
+    if (!plugin()) {
         return;
     }
 
@@ -434,7 +548,7 @@ void AutoType::startGlobalAutoType(const QString& search)
  */
 void AutoType::performGlobalAutoType(const QList<QSharedPointer<Database>>& dbList, const QString& search)
 {
-    if (!m_plugin) {
+    if (!plugin()) {
         return;
     }
 
@@ -447,25 +561,56 @@ void AutoType::performGlobalAutoType(const QList<QSharedPointer<Database>>& dbLi
         return;
     }
 
-    QList<AutoTypeMatch> matchList;
     bool hideExpired = config()->get(Config::AutoTypeHideExpiredEntry).toBool();
+    const auto windowTitle = m_windowTitleForGlobal;
 
+    // The indexes are children of their databases and have to be created in this thread
+    QList<QPair<Database*, AutoTypeMatchIndex*>> indexes;
     for (const auto& db : dbList) {
-        const QList<Entry*> dbEntries = db->rootGroup()->entriesRecursive();
-        for (auto entry : dbEntries) {
+        indexes.append({db.data(), AutoTypeMatchIndex::forDatabase(db.data())});
+    }
+
+    auto matchDatabase = [hideExpired, windowTitle](const QPair<Database*, AutoTypeMatchIndex*>& index) {
+        QList<AutoTypeMatch> matches;
+        const auto dbSequences = index.second->sequences(windowTitle);
+        if (dbSequences.isEmpty()) {
+            return matches;
+        }
+        index.first->rootGroup()->forEachEntryRecursive([&](Entry* entry) {
+            auto entrySequences = dbSequences.constFind(entry);
+            if (entrySequences == dbSequences.constEnd()) {
+                return true;
+            }
+
             auto group = entry->group();
             if (!group || !group->resolveAutoTypeEnabled() || !entry->autoTypeEnabled()) {
-                continue;
+                return true;
             }
 
             if (hideExpired && entry->isExpired()) {
-                continue;
+                return true;
             }
-            const QSet<QString> sequences = Tools::asSet(entry->autoTypeSequences(m_windowTitleForGlobal));
+            const QSet<QString> sequences = Tools::asSet(entrySequences.value());
             for (const auto& sequence : sequences) {
-                matchList << AutoTypeMatch(entry, sequence);
+                matches << AutoTypeMatch(entry, sequence);
             }
-        }
+            return true;
+        });
+        return matches;
+    };
+
+    // Databases are matched at the same time, this thread waits without handling events,
+    // so none of them changes in the meantime
+    QList<QList<AutoTypeMatch>> dbMatches;
+    if (indexes.size() > 1) {
+        dbMatches = QtConcurrent::blockingMapped<QList<QList<AutoTypeMatch>>>(indexes, matchDatabase);
+    } else if (!indexes.isEmpty()) {
+        dbMatches << matchDatabase(indexes.first());
+    }
+
+    QList<AutoTypeMatch> matchList;
+    for (const auto& matches : asConst(dbMatches)) {
+        matchList << matches;
     }
 
     // Show the selection dialog if we always ask, have multiple matches, or no matches
@@ -558,56 +703,25 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
 
     QList<QSharedPointer<AutoTypeAction>> actions;
     actions << QSharedPointer<AutoTypeBegin>::create();
-    actions << QSharedPointer<AutoTypeDelay>::create(qMax(0, config()->get(Config::AutoTypeDelay).toInt()), true);
-
-    // Replace escaped braces with a template for easier regex
-    QString sequence = entrySequence;
-    sequence.replace("{{}", "{LEFTBRACE}");
-    sequence.replace("{}}", "{RIGHTBRACE}");
+    // Only the configured delay is adapted to the target, a {DELAY=X} of the sequence is kept as is
+    actions << QSharedPointer<AutoTypeDelay>::create(qMax(0, config()->get(Config::AutoTypeDelay).toInt()), true, true);
 
-    // Quick test for bracket syntax
-    if (sequence.count("{") != sequence.count("}")) {
-        error = tr("Bracket imbalance detected, found extra { or }");
+    const auto tokenized = cachedTokenizeSequence(entrySequence);
+    if (!tokenized.error.isEmpty()) {
+        error = tokenized.error;
         return {};
     }
 
-    // Group 1 = modifier key (opt)
-    // Group 2 = full placeholder
-    // Group 3 = inner placeholder (allows nested placeholders)
-    // Group 4 = repeat (opt)
-    // Group 5 = character
-    QRegularExpression regex("([+%^#]*)(?:({((?>[^{}]+?|(?2))+?)(?:\\s+(\\d+))?})|(.))");
-    auto results = regex.globalMatch(sequence);
-    while (results.hasNext()) {
-        auto match = results.next();
-
-        // Parse modifier keys
-        Qt::KeyboardModifiers modifiers;
-        if (match.captured(1).contains('+')) {
-            modifiers |= Qt::ShiftModifier;
-        }
-        if (match.captured(1).contains('^')) {
-            modifiers |= Qt::ControlModifier;
-        }
-        if (match.captured(1).contains('%')) {
-            modifiers |= Qt::AltModifier;
-        }
-        if (match.captured(1).contains('#')) {
-            modifiers |= Qt::MetaModifier;
-        }
-
-        const auto fullPlaceholder = match.captured(2);
-        auto placeholder = match.captured(3).toLower();
-        auto repeat = 1;
-        if (!match.captured(4).isEmpty()) {
-            repeat = match.captured(4).toInt();
-        }
-        auto character = match.captured(5);
+    for (const auto& token : tokenized.tokens) {
+        const auto modifiers = token.modifiers;
+        const auto& fullPlaceholder = token.fullPlaceholder;
+        auto placeholder = token.lowerPlaceholder;
+        const auto repeat = token.repeat;
 
         if (placeholder.isEmpty()) {
-            if (!character.isEmpty()) {
+            if (!token.character.isEmpty()) {
                 // Type a single character with modifier
-                actions << QSharedPointer<AutoTypeKey>::create(character[0], modifiers);
+                actions << QSharedPointer<AutoTypeKey>::create(token.character[0], modifiers);
             }
             continue;
         }
@@ -653,7 +767,7 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
             }
         } else if (placeholder.startsWith("pickchars")) {
             // Reset to the original capture to preserve case
-            placeholder = match.captured(3);
+            placeholder = token.placeholder;
 
             auto attribute = EntryAttributes::PasswordKey;
             if (placeholder.contains(":")) {
@@ -688,7 +802,7 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
             }
         } else if (placeholder.startsWith("t-conv:")) {
             // Reset to the original capture to preserve case
-            placeholder = match.captured(3);
+            placeholder = token.placeholder;
             placeholder.replace("t-conv:", "", Qt::CaseInsensitive);
             if (!placeholder.isEmpty()) {
                 auto sep = placeholder[0];
@@ -726,7 +840,7 @@ AutoType::parseSequence(const QString& entrySequence, const Entry* entry, QStrin
             }
         } else if (placeholder.startsWith("t-replace-rx:")) {
             // Reset to the original capture to preserve case
-            placeholder = match.captured(3);
+            placeholder = token.placeholder;
             placeholder.replace("t-replace-rx:", "", Qt::CaseInsensitive);
             if (!placeholder.isEmpty()) {
                 auto sep = placeholder[0];
@@ -46,10 +46,7 @@ public:
 
     static bool verifyAutoTypeSyntax(const QString& sequence, const Entry* entry, QString& error);
 
-    inline bool isAvailable()
-    {
-        return m_plugin;
-    }
+    bool isAvailable();
 
     static AutoType* instance();
     static void createTestInstance();
@@ -77,6 +74,7 @@ private:
 
     explicit AutoType(QObject* parent = nullptr, bool test = false);
     ~AutoType() override;
+    AutoTypePlatformInterface* plugin();
     void loadPlugin(const QString& pluginPath);
     void executeAutoTypeActions(const Entry* entry,
                                 const QString& sequence = QString(),
@@ -91,6 +89,7 @@ private:
     QMutex m_inAutoType;
     QMutex m_inGlobalAutoTypeDialog;
     QPluginLoader* m_pluginLoader;
+    QString m_pluginPath;
     AutoTypePlatformInterface* m_plugin;
     AutoTypeExecutor* m_executor;
     static AutoType* m_instance;
@@ -37,9 +37,10 @@ AutoTypeAction::Result AutoTypeKey::exec(AutoTypeExecutor* executor) const
     return executor->execType(this);
 }
 
-AutoTypeDelay::AutoTypeDelay(int delayMs, bool setExecDelay)
+AutoTypeDelay::AutoTypeDelay(int delayMs, bool setExecDelay, bool adaptive)
     : delayMs(delayMs)
     , setExecDelay(setExecDelay)
+    , adaptive(adaptive)
 {
 }
 
@@ -48,6 +49,7 @@ AutoTypeAction::Result AutoTypeDelay::exec(AutoTypeExecutor* executor) const
     if (setExecDelay) {
         // Change the delay between actions
         executor->execDelayMs = delayMs;
+        executor->execDelayAdaptive = adaptive;
     } else {
         // Pause execution
         Tools::wait(delayMs);
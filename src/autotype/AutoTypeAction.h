@@ -99,11 +99,13 @@ public:
 class KEEPASSXC_EXPORT AutoTypeDelay : public AutoTypeAction
 {
 public:
-    explicit AutoTypeDelay(int delayMs, bool setExecDelay = false);
+    explicit AutoTypeDelay(int delayMs, bool setExecDelay = false, bool adaptive = false);
     Result exec(AutoTypeExecutor* executor) const override;
 
     const int delayMs;
     const bool setExecDelay;
+    // The executor may type faster or slower than the delay between actions
+    const bool adaptive;
 };
 
 class KEEPASSXC_EXPORT AutoTypeClearField : public AutoTypeAction
@@ -133,6 +135,8 @@ public:
     virtual AutoTypeAction::Result execClearField(const AutoTypeClearField* action) = 0;
 
     int execDelayMs = 25;
+    // Whether the executor may adapt the delay between actions to the target window
+    bool execDelayAdaptive = false;
     Mode mode = Mode::NORMAL;
     QString error;
 };
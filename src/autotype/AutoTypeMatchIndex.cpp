@@ -0,0 +1,342 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AutoTypeMatchIndex.h"
+
+#include "core/Config.h"
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Tools.h"
+
+#include <QUrl>
+
+namespace
+{
+    // Resolved windows of associations with placeholders that are kept compiled
+    const int MaxLiveMatchers = 1024;
+
+    bool isRegexWindow(const QString& window)
+    {
+        return window.startsWith("//") && window.endsWith("//") && window.size() >= 4;
+    }
+
+    /**
+     * @return case folded text of a wildcard window in front of the first wildcard,
+     *         surrogates end the prefix since they are folded as pairs when matching
+     */
+    QString foldedPrefix(const QString& window)
+    {
+        QString prefix;
+        for (const QChar ch : window) {
+            if (ch == '*' || ch.isSurrogate()) {
+                break;
+            }
+            prefix.append(ch.toCaseFolded());
+        }
+        return prefix;
+    }
+} // namespace
+
+AutoTypeMatchIndex::AutoTypeMatchIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+{
+    connect(db, &Database::groupAdded, this, &AutoTypeMatchIndex::invalidate);
+    connect(db, &Database::groupRemoved, this, &AutoTypeMatchIndex::invalidate);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &AutoTypeMatchIndex::clear);
+    connect(db, &Database::databaseDiscarded, this, &AutoTypeMatchIndex::clear);
+}
+
+/**
+ * Get the index of a database, creating it on first use.
+ *
+ * @param db database to index
+ * @return index owned by the database
+ */
+AutoTypeMatchIndex* AutoTypeMatchIndex::forDatabase(Database* db)
+{
+    auto index = db->findChild<AutoTypeMatchIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index) {
+        index = new AutoTypeMatchIndex(db);
+    }
+    return index;
+}
+
+/**
+ * Match a window title against the associations, titles and URLs of all entries.
+ *
+ * Gives the same sequences as Entry::autoTypeSequences() for every entry.
+ *
+ * @param windowTitle title of the target window, must not be empty
+ * @return sequences of the matching entries, in no particular order
+ */
+QHash<Entry*, QList<QString>> AutoTypeMatchIndex::sequences(const QString& windowTitle)
+{
+    if (!m_valid || m_rootGroup != m_db->rootGroup()) {
+        rebuild();
+    }
+
+    QHash<Entry*, QList<QString>> result;
+    auto addSequence = [&result](Entry* entry, const QString& sequence) {
+        result[entry] << (sequence.isEmpty() ? entry->effectiveAutoTypeSequence() : sequence);
+    };
+
+    int node = 0;
+    int pos = 0;
+    forever {
+        for (int id : asConst(m_trie.at(node).patterns)) {
+            const auto& pattern = m_patterns.at(id);
+            if (matches(pattern.matcher, windowTitle)) {
+                for (const auto& association : pattern.associations) {
+                    addSequence(association.first, association.second);
+                }
+            }
+        }
+        if (pos == windowTitle.size()) {
+            break;
+        }
+        // The root is never a child, so a missing child ends the walk
+        node = m_trie.at(node).children.value(windowTitle.at(pos++).toCaseFolded(), 0);
+        if (node == 0) {
+            break;
+        }
+    }
+
+    const bool titleMatch = config()->get(Config::AutoTypeEntryTitleMatch).toBool();
+    const bool urlMatch = config()->get(Config::AutoTypeEntryURLMatch).toBool();
+    for (const auto& record : asConst(m_entries)) {
+        auto entry = record.entry;
+        for (const auto& association : record.liveAssociations) {
+            if (matches(matcher(entry->resolveMultiplePlaceholders(association.first)), windowTitle)) {
+                addSequence(entry, association.second);
+            }
+        }
+
+        if (!titleMatch && !urlMatch) {
+            continue;
+        }
+        if (record.resolveLive) {
+            auto url = entry->resolvePlaceholder(entry->url());
+            if (titleMatch && titleMatches(entry->resolvePlaceholder(entry->title()), windowTitle)) {
+                addSequence(entry, {});
+            }
+            if (urlMatch && urlMatches(url, QUrl(url).host(), windowTitle)) {
+                addSequence(entry, {});
+            }
+            continue;
+        }
+        if (titleMatch && titleMatches(record.title, windowTitle)) {
+            addSequence(entry, {});
+        }
+        if (urlMatch && urlMatches(record.url, record.host, windowTitle)) {
+            addSequence(entry, {});
+        }
+    }
+
+    return result;
+}
+
+void AutoTypeMatchIndex::invalidate()
+{
+    m_valid = false;
+}
+
+void AutoTypeMatchIndex::clear()
+{
+    // Indexed entries may already be destroyed, their connections are dropped with them
+    if (m_rootGroup) {
+        m_rootGroup->forEachGroupRecursive([this](const Group* group) {
+            disconnect(group, nullptr, this, nullptr);
+            return true;
+        });
+    }
+    m_patterns.clear();
+    m_patternIds.clear();
+    m_trie.clear();
+    m_entries.clear();
+    m_liveMatchers.clear();
+    m_rootGroup.clear();
+    m_valid = false;
+}
+
+/**
+ * Compile the associations of all entries of the database.
+ */
+void AutoTypeMatchIndex::rebuild()
+{
+    // Keep the compiled expressions of windows that did not change
+    QHash<QString, Matcher> matchers;
+    for (const auto& pattern : asConst(m_patterns)) {
+        matchers.insert(pattern.matcher.window, pattern.matcher);
+    }
+    auto liveMatchers = m_liveMatchers;
+    clear();
+    m_liveMatchers = liveMatchers;
+
+    m_valid = true;
+    m_trie.append(TrieNode());
+    m_rootGroup = m_db->rootGroup();
+    if (!m_rootGroup) {
+        return;
+    }
+
+    m_rootGroup->forEachGroupRecursive([this](Group* group) {
+        connect(group, &Group::entryAdded, this, &AutoTypeMatchIndex::invalidate, Qt::UniqueConnection);
+        connect(group, &Group::entryRemoved, this, &AutoTypeMatchIndex::invalidate, Qt::UniqueConnection);
+        return true;
+    });
+
+    m_rootGroup->forEachEntryRecursive([&](Entry* entry) {
+        connect(entry, &Entry::modified, this, &AutoTypeMatchIndex::invalidate, Qt::UniqueConnection);
+        connect(entry, &QObject::destroyed, this, &AutoTypeMatchIndex::invalidate, Qt::UniqueConnection);
+
+        EntryRecord record;
+        record.entry = entry;
+
+        const auto associations = entry->autoTypeAssociations()->getAll();
+        for (const auto& association : associations) {
+            if (association.window.isEmpty()) {
+                continue;
+            }
+            // Placeholders may refer to other entries, which would not invalidate this one
+            if (association.window.contains('{')) {
+                record.liveAssociations.append({association.window, association.sequence});
+                continue;
+            }
+            addPattern(association.window, entry, association.sequence, matchers);
+        }
+
+        record.resolveLive = entry->title().contains('{') || entry->url().contains('{');
+        if (!record.resolveLive) {
+            record.title = entry->title();
+            record.url = entry->url();
+            QUrl url(record.url);
+            if (url.isValid()) {
+                record.host = url.host();
+            }
+        }
+        m_entries.append(record);
+        return true;
+    });
+}
+
+void AutoTypeMatchIndex::addPattern(const QString& window,
+                                    Entry* entry,
+                                    const QString& sequence,
+                                    const QHash<QString, Matcher>& compiled)
+{
+    auto id = m_patternIds.constFind(window);
+    if (id != m_patternIds.constEnd()) {
+        m_patterns[id.value()].associations.append({entry, sequence});
+        return;
+    }
+
+    const int patternId = m_patterns.size();
+    m_patternIds.insert(window, patternId);
+    auto matcher = compiled.constFind(window);
+    m_patterns.append({matcher != compiled.constEnd() ? matcher.value() : compile(window), {{entry, sequence}}});
+
+    // Regular expressions are not anchored and have to be matched against every title
+    int node = 0;
+    if (!isRegexWindow(window)) {
+        for (const QChar ch : foldedPrefix(window)) {
+            int child = m_trie.at(node).children.value(ch, 0);
+            if (child == 0) {
+                child = m_trie.size();
+                m_trie[node].children.insert(ch, child);
+                m_trie.append(TrieNode());
+            }
+            node = child;
+        }
+    }
+    m_trie[node].patterns.append(patternId);
+}
+
+/**
+ * @param window resolved window of an association with placeholders
+ * @return cached compiled window
+ */
+const AutoTypeMatchIndex::Matcher& AutoTypeMatchIndex::matcher(const QString& window)
+{
+    auto it = m_liveMatchers.find(window);
+    if (it == m_liveMatchers.end()) {
+        if (m_liveMatchers.size() >= MaxLiveMatchers) {
+            m_liveMatchers.clear();
+        }
+        it = m_liveMatchers.insert(window, compile(window));
+    }
+    return it.value();
+}
+
+/**
+ * Compile a window the way Entry::autoTypeSequences() matches it.
+ *
+ * @param window window of an association
+ * @return matcher of the window
+ */
+AutoTypeMatchIndex::Matcher AutoTypeMatchIndex::compile(const QString& window)
+{
+    Matcher matcher;
+    matcher.window = window;
+
+    if (isRegexWindow(window)) {
+        matcher.regex =
+            QRegularExpression(window.mid(2, window.size() - 4), QRegularExpression::CaseInsensitiveOption);
+        matcher.regex.optimize();
+        return matcher;
+    }
+
+    if (!window.contains('*')) {
+        matcher.exact = true;
+        return matcher;
+    }
+
+    for (const auto& part : window.split('*', Qt::SkipEmptyParts)) {
+        if (part.size() > matcher.literal.size()) {
+            matcher.literal = part;
+        }
+    }
+    matcher.regex = Tools::convertToRegex(
+        window, Tools::RegexConvertOpts::EXACT_MATCH | Tools::RegexConvertOpts::WILDCARD_UNLIMITED_MATCH);
+    matcher.regex.optimize();
+    return matcher;
+}
+
+bool AutoTypeMatchIndex::matches(const Matcher& matcher, const QString& windowTitle)
+{
+    if (matcher.exact) {
+        return windowTitle.compare(matcher.window, Qt::CaseInsensitive) == 0;
+    }
+    if (!matcher.literal.isEmpty() && !windowTitle.contains(matcher.literal, Qt::CaseInsensitive)) {
+        return false;
+    }
+    return matcher.regex.match(windowTitle).hasMatch();
+}
+
+bool AutoTypeMatchIndex::titleMatches(const QString& title, const QString& windowTitle)
+{
+    return !title.isEmpty() && windowTitle.contains(title, Qt::CaseInsensitive);
+}
+
+bool AutoTypeMatchIndex::urlMatches(const QString& url, const QString& host, const QString& windowTitle)
+{
+    if (!url.isEmpty() && windowTitle.contains(url, Qt::CaseInsensitive)) {
+        return true;
+    }
+    return !host.isEmpty() && windowTitle.contains(host, Qt::CaseInsensitive);
+}
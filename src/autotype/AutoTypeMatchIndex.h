@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_AUTOTYPEMATCHINDEX_H
+#define KEEPASSXC_AUTOTYPEMATCHINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QVector>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Per database matcher for the window titles used by global Auto-Type.
+ *
+ * The window associations of all entries are compiled once and kept until an
+ * entry, association or group of the database changes. Wildcard associations
+ * are stored in a trie keyed by the case folded literal text in front of the
+ * first wildcard, so a window title is only matched against associations whose
+ * prefix it starts with, plus the regular expressions and the associations
+ * starting with a wildcard. Identical windows share one compiled expression.
+ * Associations, titles and URLs containing placeholders are resolved on every
+ * lookup. Auto-Type settings of entries and groups are not part of the index.
+ */
+class AutoTypeMatchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    static AutoTypeMatchIndex* forDatabase(Database* db);
+
+    QHash<Entry*, QList<QString>> sequences(const QString& windowTitle);
+
+private slots:
+    void invalidate();
+    void clear();
+
+private:
+    struct Matcher
+    {
+        QString window;
+        // Longest literal part of a wildcard window, checked before the expression
+        QString literal;
+        QRegularExpression regex;
+        bool exact = false;
+    };
+
+    struct Pattern
+    {
+        Matcher matcher;
+        QVector<QPair<Entry*, QString>> associations;
+    };
+
+    struct TrieNode
+    {
+        QHash<QChar, int> children;
+        QVector<int> patterns;
+    };
+
+    struct EntryRecord
+    {
+        Entry* entry = nullptr;
+        QString title;
+        QString url;
+        QString host;
+        bool resolveLive = false;
+        // Associations with placeholders in the window
+        QVector<QPair<QString, QString>> liveAssociations;
+    };
+
+    explicit AutoTypeMatchIndex(Database* db);
+
+    void rebuild();
+    void addPattern(const QString& window,
+                    Entry* entry,
+                    const QString& sequence,
+                    const QHash<QString, Matcher>& compiled);
+    const Matcher& matcher(const QString& window);
+
+    static Matcher compile(const QString& window);
+    static bool matches(const Matcher& matcher, const QString& windowTitle);
+    static bool titleMatches(const QString& title, const QString& windowTitle);
+    static bool urlMatches(const QString& url, const QString& host, const QString& windowTitle);
+
+    Database* m_db;
+    QPointer<Group> m_rootGroup;
+    bool m_valid = false;
+    QVector<Pattern> m_patterns;
+    QHash<QString, int> m_patternIds;
+    QVector<TrieNode> m_trie;
+    QVector<EntryRecord> m_entries;
+    QHash<QString, Matcher> m_liveMatchers;
+};
+
+#endif // KEEPASSXC_AUTOTYPEMATCHINDEX_H
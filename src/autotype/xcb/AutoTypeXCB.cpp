@@ -21,6 +21,7 @@
 #include "core/Tools.h"
 #include "gui/osutils/nixutils/X11Funcs.h"
 
+#include <QElapsedTimer>
 #include <QX11Info>
 #include <X11/XKBlib.h>
 #include <X11/Xutil.h>
@@ -35,6 +36,15 @@ static const QPair<KeySym, KeySym> deadMap[] = {
     {XK_asciitilde, XK_dead_perispomeni},
 };
 
+/* remapped keycodes are reset once no key was sent for this long */
+static const int remapResetDelayMs = 500;
+
+/* bounds of the learned delay between keys */
+static const int minAdaptiveDelayMs = 5;
+static const int maxAdaptiveDelayMs = 500;
+/* keys answered quickly in a row before the delay is lowered */
+static const int fastKeysBeforeSpeedup = 10;
+
 AutoTypePlatformX11::AutoTypePlatformX11()
 {
     // Qt handles XCB slightly differently so we open our own connection
@@ -57,6 +67,22 @@ AutoTypePlatformX11::AutoTypePlatformX11()
     m_classBlacklist << "xfdesktop" << "xfce4-panel"; // Xfce 4
 
     m_xkb = nullptr;
+    m_keymapChanged = true;
+
+    /* rebuild the keymap only after the mapping changed */
+    int opcode, error;
+    int major = XkbMajorVersion;
+    int minor = XkbMinorVersion;
+    if (XkbQueryExtension(m_dpy, &opcode, &m_xkbEventBase, &error, &major, &minor)) {
+        const unsigned int events = XkbNewKeyboardNotifyMask | XkbMapNotifyMask;
+        XkbSelectEvents(m_dpy, XkbUseCoreKbd, events, events);
+    } else {
+        m_xkbEventBase = -1;
+    }
+
+    m_remapResetTimer.setSingleShot(true);
+    m_remapResetTimer.setInterval(remapResetDelayMs);
+    connect(&m_remapResetTimer, &QTimer::timeout, this, &AutoTypePlatformX11::ResetRemappedKeycodes);
 
     m_loaded = true;
 }
@@ -78,7 +104,12 @@ bool AutoTypePlatformX11::isAvailable()
 
 void AutoTypePlatformX11::unload()
 {
+    ResetRemappedKeycodes();
+    m_remapResetTimer.stop();
     m_keymap.clear();
+    m_keymapIndex.clear();
+    m_spareKeycodes.clear();
+    m_keymapChanged = true;
 
     if (m_xkb) {
         XkbFreeKeyboard(m_xkb, XkbAllComponentsMask, True);
@@ -219,6 +250,11 @@ QString AutoTypePlatformX11::windowClassName(Window window)
     return className;
 }
 
+QString AutoTypePlatformX11::activeWindowClassName()
+{
+    return windowClassName(activeWindow());
+}
+
 QList<Window> AutoTypePlatformX11::widgetsToX11Windows(const QWidgetList& widgetList)
 {
     QList<Window> windows;
@@ -290,31 +326,74 @@ bool AutoTypePlatformX11::isTopLevelWindow(Window window)
 }
 
 /*
- * Update the keyboard and modifier mapping.
+ * Look for changes of the keyboard mapping made by other clients
+ * since the keymap was built.
+ */
+void AutoTypePlatformX11::processKeymapEvents()
+{
+    if (m_xkbEventBase < 0) {
+        m_keymapChanged = true;
+    }
+
+    while (XPending(m_dpy) > 0) {
+        XEvent event;
+        XNextEvent(m_dpy, &event);
+        if (event.type == MappingNotify) {
+            m_keymapChanged = true;
+        } else if (event.type == m_xkbEventBase) {
+            auto xkbEvent = reinterpret_cast<XkbEvent*>(&event);
+            if ((xkbEvent->any.xkb_type == XkbMapNotify || xkbEvent->any.xkb_type == XkbNewKeyboardNotify)
+                && !m_ownMapRequests.contains(xkbEvent->any.serial)) {
+                m_keymapChanged = true;
+            }
+        }
+    }
+    m_ownMapRequests.clear();
+}
+
+/*
+ * Update the keyboard and modifier mapping if it changed.
  * We need the KeyboardMapping for AddKeysym.
  * Modifier mapping is required for clearing the modifiers.
  */
 void AutoTypePlatformX11::updateKeymap()
 {
+    processKeymapEvents();
+    if (m_xkb && !m_keymapChanged) {
+        return;
+    }
+
+    /* remapped keycodes must not end up in the keymap */
+    ResetRemappedKeycodes();
+    m_remapResetTimer.stop();
+
     if (m_xkb) {
         XkbFreeKeyboard(m_xkb, XkbAllComponentsMask, True);
     }
     m_xkb = XkbGetMap(m_dpy, XkbAllClientInfoMask, XkbUseCoreKbd);
 
     /* workaround X11 bug https://gitlab.freedesktop.org/xorg/xserver/-/issues/1155 */
+    m_ownMapRequests.insert(NextRequest(m_dpy));
     XkbSetMap(m_dpy, XkbAllClientInfoMask, m_xkb);
     XSync(m_dpy, False);
+    processKeymapEvents();
+    m_keymapChanged = false;
 
     /* Build updated keymap */
     m_keymap.clear();
-    m_remapKeycode = 0;
+    m_keymapIndex.clear();
+    m_spareKeycodes.clear();
+
+    for (int ckeycode = m_xkb->max_key_code - 1; ckeycode >= m_xkb->min_key_code; ckeycode--) {
+        /* collect remappable keycodes from the highest one down, don't add to keymap */
+        if (XkbKeyNumGroups(m_xkb, ckeycode) == 0) {
+            m_spareKeycodes.append(ckeycode);
+        }
+    }
 
     for (int ckeycode = m_xkb->min_key_code; ckeycode < m_xkb->max_key_code; ckeycode++) {
         int groups = XkbKeyNumGroups(m_xkb, ckeycode);
-
-        /* track highest remappable keycode, don't add to keymap */
         if (groups == 0) {
-            m_remapKeycode = ckeycode;
             continue;
         }
 
@@ -338,6 +417,7 @@ void AutoTypePlatformX11::updateKeymap()
                     continue;
                 }
 
+                m_keymapIndex[sym].append(m_keymap.size());
                 m_keymap.append(AutoTypePlatformX11::KeyDesc{sym, ckeycode, cgroup, mask});
             }
         }
@@ -363,20 +443,12 @@ void AutoTypePlatformX11::updateKeymap()
 // --------------------------------------------------------------------------
 
 /*
- * Send event to the focused window.
- * If input focus is specified explicitly, select the window
- * before send event to the window.
+ * Queue an event for the focused window.
+ * The events of a key are sent together by sendKey().
  */
 void AutoTypePlatformX11::SendKeyEvent(unsigned keycode, bool press)
 {
-    XSync(m_dpy, False);
-    int (*oldHandler)(Display*, XErrorEvent*) = XSetErrorHandler(MyErrorHandler);
-
     XTestFakeKeyEvent(m_dpy, keycode, press, 0);
-    XFlush(m_dpy);
-    XSync(m_dpy, False);
-
-    XSetErrorHandler(oldHandler);
 }
 
 /*
@@ -402,12 +474,11 @@ bool AutoTypePlatformX11::GetKeycode(KeySym keysym, int* keycode, int* group, un
     const KeyDesc* desc = nullptr;
     bool isDead = false;
 
-    for (const auto& key : m_keymap) {
-        if (key.sym == keysym) {
-            // pick this description if we don't have any for this sym or this matches the current group
-            if (desc == nullptr || key.group == *group) {
-                desc = &key;
-            }
+    for (int index : m_keymapIndex.value(keysym)) {
+        const auto& key = m_keymap.at(index);
+        // pick this description if we don't have any for this sym or this matches the current group
+        if (desc == nullptr || key.group == *group) {
+            desc = &key;
         }
     }
 
@@ -415,13 +486,12 @@ bool AutoTypePlatformX11::GetKeycode(KeySym keysym, int* keycode, int* group, un
     if (!desc) {
         for (const auto& map : deadMap) {
             if (map.first == keysym) {
-                for (const auto& key : m_keymap) {
-                    if (key.sym == map.second) {
-                        // same as above, we try to match the group so no breaking out
-                        if (desc == nullptr || key.group == *group) {
-                            desc = &key;
-                            isDead = true;
-                        }
+                for (int index : m_keymapIndex.value(map.second)) {
+                    const auto& key = m_keymap.at(index);
+                    // same as above, we try to match the group so no breaking out
+                    if (desc == nullptr || key.group == *group) {
+                        desc = &key;
+                        isDead = true;
                     }
                 }
             }
@@ -437,8 +507,7 @@ bool AutoTypePlatformX11::GetKeycode(KeySym keysym, int* keycode, int* group, un
     }
 
     /* if we can't find an existing key for this keysym, try remapping */
-    if (RemapKeycode(keysym)) {
-        *keycode = m_remapKeycode;
+    if (RemapKeycode(keysym, keycode)) {
         *group = 0;
         *mask = 0;
         *repeat = false;
@@ -450,30 +519,83 @@ bool AutoTypePlatformX11::GetKeycode(KeySym keysym, int* keycode, int* group, un
 
 /*
  * Get remapped keycode for any keysym.
+ * A keysym stays mapped until the spare keycodes are reset, the least
+ * recently used keycode is taken over once all of them are in use.
  */
-bool AutoTypePlatformX11::RemapKeycode(KeySym keysym)
+bool AutoTypePlatformX11::RemapKeycode(KeySym keysym, int* keycode)
 {
-    if (!m_remapKeycode) {
-        return false;
+    auto remapped = m_remappedKeys.constFind(keysym);
+    if (remapped != m_remappedKeys.constEnd()) {
+        *keycode = remapped.value();
+        m_remapOrder.removeOne(remapped.value());
+        m_remapOrder.append(remapped.value());
+        return true;
     }
 
-    if (keysym != NoSymbol) {
-        int type = XkbOneLevelIndex;
-        if (XkbChangeTypesOfKey(m_xkb, m_remapKeycode, 1, XkbGroup1Mask, &type, NULL) != Success) {
-            return false;
-        }
+    if (m_spareKeycodes.isEmpty()) {
+        return false;
+    }
 
-        XkbKeySymEntry(m_xkb, m_remapKeycode, 0, 0) = keysym;
+    KeyCode code;
+    if (m_remapOrder.size() < m_spareKeycodes.size()) {
+        code = m_spareKeycodes.at(m_remapOrder.size());
     } else {
-        XkbChangeTypesOfKey(m_xkb, m_remapKeycode, 0, XkbGroup1Mask, NULL, NULL);
+        code = m_remapOrder.takeFirst();
+        m_remappedKeys.remove(m_remappedKeys.key(code));
     }
 
-    XkbSetMap(m_dpy, XkbAllClientInfoMask, m_xkb);
-    XFlush(m_dpy);
+    XkbMapChangesRec changes = {};
+    int type = XkbOneLevelIndex;
+    if (XkbChangeTypesOfKey(m_xkb, code, 1, XkbGroup1Mask, &type, &changes) != Success) {
+        return false;
+    }
+    XkbKeySymEntry(m_xkb, code, 0, 0) = keysym;
+    changes.changed |= XkbKeySymsMask;
+    changes.first_key_sym = code;
+    changes.num_key_syms = 1;
+
+    m_ownMapRequests.insert(NextRequest(m_dpy));
+    XkbChangeMap(m_dpy, m_xkb, &changes);
     XSync(m_dpy, False);
+
+    m_remappedKeys.insert(keysym, code);
+    m_remapOrder.append(code);
+    *keycode = code;
     return true;
 }
 
+/*
+ * Remove the keysyms from all remapped keycodes at once
+ * to prevent leaking them longer than necessary.
+ */
+void AutoTypePlatformX11::ResetRemappedKeycodes()
+{
+    if (m_remapOrder.isEmpty() || !m_xkb) {
+        m_remappedKeys.clear();
+        m_remapOrder.clear();
+        return;
+    }
+
+    XkbMapChangesRec changes = {};
+    KeyCode first = m_remapOrder.first();
+    KeyCode last = first;
+    for (KeyCode code : asConst(m_remapOrder)) {
+        XkbChangeTypesOfKey(m_xkb, code, 0, XkbGroup1Mask, NULL, &changes);
+        first = qMin(first, code);
+        last = qMax(last, code);
+    }
+    changes.changed |= XkbKeySymsMask;
+    changes.first_key_sym = first;
+    changes.num_key_syms = last - first + 1;
+
+    m_ownMapRequests.insert(NextRequest(m_dpy));
+    XkbChangeMap(m_dpy, m_xkb, &changes);
+    XSync(m_dpy, False);
+
+    m_remappedKeys.clear();
+    m_remapOrder.clear();
+}
+
 /*
  * Send sequence of KeyPressed/KeyReleased events to the focused
  * window to simulate keyboard.  If modifiers (shift, control, etc)
@@ -527,10 +649,12 @@ AutoTypeAction::Result AutoTypePlatformX11::sendKey(KeySym keysym, unsigned int
     /* modifiers that need to be held but aren't */
     unsigned int press_mask = wanted_mask & ~original_mask;
 
+    /* queue all events of this key and wait for them once, errors are trapped meanwhile */
+    int (*oldHandler)(Display*, XErrorEvent*) = XSetErrorHandler(MyErrorHandler);
+
     /* change layout group if necessary */
     if (group_active != group) {
         XkbLockGroup(m_dpy, XkbUseCoreKbd, group);
-        XFlush(m_dpy);
     }
 
     /* hold modifiers */
@@ -548,12 +672,14 @@ AutoTypeAction::Result AutoTypePlatformX11::sendKey(KeySym keysym, unsigned int
     /* reset layout group if necessary */
     if (group_active != group) {
         XkbLockGroup(m_dpy, XkbUseCoreKbd, group_active);
-        XFlush(m_dpy);
     }
 
-    /* reset remap to prevent leaking remap keysyms longer than necessary */
-    if (keycode == m_remapKeycode) {
-        RemapKeycode(NoSymbol);
+    XSync(m_dpy, False);
+    XSetErrorHandler(oldHandler);
+
+    /* reset remaps shortly after the sequence to prevent leaking remap keysyms longer than necessary */
+    if (!m_remapOrder.isEmpty()) {
+        m_remapResetTimer.start();
     }
 
     return AutoTypeAction::Result::Ok();
@@ -580,6 +706,8 @@ AutoTypeAction::Result AutoTypeExecutorX11::execBegin(const AutoTypeBegin* actio
 {
     Q_UNUSED(action);
     m_platform->updateKeymap();
+    m_targetClass = m_platform->activeWindowClassName();
+    m_fastKeys = 0;
     return AutoTypeAction::Result::Ok();
 }
 
@@ -587,6 +715,8 @@ AutoTypeAction::Result AutoTypeExecutorX11::execType(const AutoTypeKey* action)
 {
     AutoTypeAction::Result result;
 
+    QElapsedTimer roundTrip;
+    roundTrip.start();
     if (action->key != Qt::Key_unknown) {
         result = m_platform->sendKey(qtToNativeKeyCode(action->key), qtToNativeModifiers(action->modifiers));
     } else {
@@ -594,12 +724,36 @@ AutoTypeAction::Result AutoTypeExecutorX11::execType(const AutoTypeKey* action)
     }
 
     if (result.isOk()) {
-        Tools::sleep(execDelayMs);
+        Tools::sleep(execDelayAdaptive ? adaptDelay(roundTrip.elapsed()) : execDelayMs);
     }
 
     return result;
 }
 
+/*
+ * Learn how fast the target window class can be typed into.
+ * sendKey() waits until the X server processed all events of a key, a round trip
+ * longer than the delay means the server or the target falls behind and the delay
+ * is raised at once. The delay is lowered step by step while keys are answered
+ * quickly, remembered per window class and starts at the configured delay.
+ */
+int AutoTypeExecutorX11::adaptDelay(qint64 roundTripMs)
+{
+    auto delay = m_learnedDelays.find(m_targetClass);
+    if (delay == m_learnedDelays.end()) {
+        delay = m_learnedDelays.insert(m_targetClass, execDelayMs);
+    }
+
+    if (roundTripMs > delay.value()) {
+        delay.value() = qMin(maxAdaptiveDelayMs, qMax(delay.value() * 2, static_cast<int>(roundTripMs)));
+        m_fastKeys = 0;
+    } else if (roundTripMs * 4 <= delay.value() && ++m_fastKeys >= fastKeysBeforeSpeedup) {
+        delay.value() = qMax(qMin(minAdaptiveDelayMs, execDelayMs), delay.value() - qMax(1, delay.value() / 5));
+        m_fastKeys = 0;
+    }
+    return delay.value();
+}
+
 AutoTypeAction::Result AutoTypeExecutorX11::execClearField(const AutoTypeClearField* action)
 {
     Q_UNUSED(action);
@@ -21,7 +21,9 @@
 #define KEEPASSX_AUTOTYPEXCB_H
 
 #include <QApplication>
+#include <QHash>
 #include <QSet>
+#include <QTimer>
 #include <QWidget>
 #include <QtPlugin>
 
@@ -47,6 +49,7 @@ public:
     bool raiseWindow(WId window) override;
     AutoTypeExecutor* createExecutor() override;
     void updateKeymap();
+    QString activeWindowClassName();
 
     AutoTypeAction::Result sendKey(KeySym keysym, unsigned int modifiers = 0);
 
@@ -58,7 +61,9 @@ private:
     bool isTopLevelWindow(Window window);
 
     XkbDescPtr getKeyboard();
-    bool RemapKeycode(KeySym keysym);
+    void processKeymapEvents();
+    bool RemapKeycode(KeySym keysym, int* keycode);
+    void ResetRemappedKeycodes();
     void SendKeyEvent(unsigned keycode, bool press);
     void SendModifiers(unsigned int mask, bool press);
     bool GetKeycode(KeySym keysym, int* keycode, int* group, unsigned int* mask, bool* repeat);
@@ -87,8 +92,20 @@ private:
 
     XkbDescPtr m_xkb;
     QList<KeyDesc> m_keymap;
+    // Positions in m_keymap of the descriptions of each keysym, in keymap order
+    QHash<KeySym, QVector<int>> m_keymapIndex;
     KeyCode m_modifier_keycode[N_MOD_INDICES];
-    KeyCode m_remapKeycode;
+    int m_xkbEventBase;
+    bool m_keymapChanged;
+    // Requests changing the keyboard mapping sent by us, their notifications are ignored
+    QSet<unsigned long> m_ownMapRequests;
+
+    // Keycodes without symbols that are mapped to keysyms missing from the keymap
+    QVector<KeyCode> m_spareKeycodes;
+    QHash<KeySym, KeyCode> m_remappedKeys;
+    // Remapped keycodes, least recently used first
+    QList<KeyCode> m_remapOrder;
+    QTimer m_remapResetTimer;
     bool m_loaded;
 };
 
@@ -102,7 +119,13 @@ public:
     AutoTypeAction::Result execClearField(const AutoTypeClearField* action) override;
 
 private:
+    int adaptDelay(qint64 roundTripMs);
+
     AutoTypePlatformX11* const m_platform;
+    // Learned delay between keys of each target window class
+    QHash<QString, int> m_learnedDelays;
+    QString m_targetClass;
+    int m_fastKeys = 0;
 };
 
 #endif // KEEPASSX_AUTOTYPEXCB_H
@@ -38,6 +38,7 @@ static const QString BROWSER_REQUEST_GENERATE_PASSWORD = QStringLiteral("generat
 static const QString BROWSER_REQUEST_GET_DATABASEHASH = QStringLiteral("get-databasehash");
 static const QString BROWSER_REQUEST_GET_DATABASE_GROUPS = QStringLiteral("get-database-groups");
 static const QString BROWSER_REQUEST_GET_LOGINS = QStringLiteral("get-logins");
+static const QString BROWSER_REQUEST_GET_LOGINS_BATCH = QStringLiteral("get-logins-batch");
 static const QString BROWSER_REQUEST_GET_TOTP = QStringLiteral("get-totp");
 static const QString BROWSER_REQUEST_LOCK_DATABASE = QStringLiteral("lock-database");
 static const QString BROWSER_REQUEST_PASSKEYS_GET = QStringLiteral("passkeys-get");
@@ -92,6 +93,8 @@ QJsonObject BrowserAction::handleAction(QLocalSocket* socket, const QJsonObject&
         return handleTestAssociate(json, action);
     } else if (action.compare(BROWSER_REQUEST_GET_LOGINS) == 0) {
         return handleGetLogins(json, action);
+    } else if (action.compare(BROWSER_REQUEST_GET_LOGINS_BATCH) == 0) {
+        return handleGetLoginsBatch(json, action);
     } else if (action.compare(BROWSER_REQUEST_GENERATE_PASSWORD) == 0) {
         return handleGeneratePassword(socket, json, action);
     } else if (action.compare(BROWSER_REQUEST_SET_LOGIN) == 0) {
@@ -262,6 +265,55 @@ QJsonObject BrowserAction::handleGetLogins(const QJsonObject& json, const QStrin
     return buildResponse(action, browserRequest.incrementedNonce, params);
 }
 
+QJsonObject BrowserAction::handleGetLoginsBatch(const QJsonObject& json, const QString& action)
+{
+    if (!m_associated) {
+        return getErrorReply(action, ERROR_KEEPASS_ASSOCIATION_FAILED);
+    }
+
+    const auto browserRequest = decodeRequest(json);
+    if (browserRequest.isEmpty()) {
+        return getErrorReply(action, ERROR_KEEPASS_CANNOT_DECRYPT_MESSAGE);
+    }
+
+    const auto requests = browserRequest.getArray("urls");
+    if (requests.isEmpty()) {
+        return getErrorReply(action, ERROR_KEEPASS_NO_URL_PROVIDED);
+    }
+
+    const auto id = browserRequest.getString("id");
+    const auto keyList = getConnectionKeys(browserRequest);
+
+    QList<EntryParameters> entryParameters;
+    for (const auto& request : requests) {
+        const auto requestObject = request.toObject();
+        const auto siteUrl = requestObject.value("url").toString();
+        if (siteUrl.isEmpty()) {
+            return getErrorReply(action, ERROR_KEEPASS_NO_URL_PROVIDED);
+        }
+
+        EntryParameters parameters;
+        parameters.dbid = id;
+        parameters.hash = browserRequest.hash;
+        parameters.siteUrl = siteUrl;
+        parameters.formUrl = requestObject.value("submitUrl").toString();
+        parameters.httpAuth = requestObject.value("httpAuth").toString().compare(TRUE_STR) == 0;
+        entryParameters << parameters;
+    }
+
+    // One result per requested URL, in request order, an empty list if no logins were found for it
+    const auto foundEntries = browserService()->findEntries(entryParameters, keyList);
+    QJsonArray results;
+    for (int i = 0; i < foundEntries.size(); ++i) {
+        results.append(QJsonObject({{"url", entryParameters.at(i).siteUrl},
+                                    {"count", foundEntries.at(i).count()},
+                                    {"entries", foundEntries.at(i)}}));
+    }
+
+    const Parameters params{{"results", results}, {"hash", browserRequest.hash}, {"id", id}};
+    return buildResponse(action, browserRequest.incrementedNonce, params);
+}
+
 QJsonObject BrowserAction::handleGeneratePassword(QLocalSocket* socket, const QJsonObject& json, const QString& action)
 {
     const auto browserRequest = decodeRequest(json);
@@ -24,10 +24,28 @@
 
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMutex>
 #include <QVariant>
 
 static const char KEEPASSXCBROWSER_NAME[] = "KeePassXC-Browser Settings";
 
+namespace
+{
+    struct ParsedConfig
+    {
+        QSet<QString> allowedHosts;
+        QSet<QString> deniedHosts;
+        QString realm;
+    };
+
+    // Settings of entries that every request matching them would decode again
+    const int MaxCachedConfigs = 4096;
+
+    // Keyed by the stored JSON, so changed settings are parsed again
+    QHash<QString, ParsedConfig> s_parsedConfigs;
+    QMutex s_parsedConfigsMutex;
+} // namespace
+
 BrowserEntryConfig::BrowserEntryConfig(QObject* parent)
     : QObject(parent)
 {
@@ -92,6 +110,16 @@ bool BrowserEntryConfig::load(const Entry* entry)
         return false;
     }
 
+    QMutexLocker locker(&s_parsedConfigsMutex);
+    const auto cached = s_parsedConfigs.constFind(s);
+    if (cached != s_parsedConfigs.constEnd()) {
+        m_allowedHosts = cached->allowedHosts;
+        m_deniedHosts = cached->deniedHosts;
+        m_realm = cached->realm;
+        return true;
+    }
+    locker.unlock();
+
     QJsonDocument doc = QJsonDocument::fromJson(s.toUtf8());
     if (doc.isNull()) {
         return false;
@@ -101,6 +129,12 @@ bool BrowserEntryConfig::load(const Entry* entry)
     for (QVariantMap::const_iterator iter = map.cbegin(); iter != map.cend(); ++iter) {
         setProperty(iter.key().toLatin1(), iter.value());
     }
+
+    locker.relock();
+    if (s_parsedConfigs.size() >= MaxCachedConfigs) {
+        s_parsedConfigs.clear();
+    }
+    s_parsedConfigs.insert(s, {m_allowedHosts, m_deniedHosts, m_realm});
     return true;
 }
 
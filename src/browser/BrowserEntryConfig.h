@@ -43,11 +43,11 @@ public:
     void deny(const QString& host);
     QString realm() const;
     void setRealm(const QString& realm);
+    QStringList allowedHosts() const;
+    QStringList deniedHosts() const;
 
 private:
-    QStringList allowedHosts() const;
     void setAllowedHosts(const QStringList& allowedHosts);
-    QStringList deniedHosts() const;
     void setDeniedHosts(const QStringList& deniedHosts);
 
     QSet<QString> m_allowedHosts;
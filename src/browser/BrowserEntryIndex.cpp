@@ -0,0 +1,317 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrowserEntryIndex.h"
+
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Tools.h"
+#include "gui/UrlTools.h"
+
+#include <QUrl>
+
+namespace
+{
+    bool isUrlAttribute(const QString& key)
+    {
+        return key.startsWith(EntryAttributes::AdditionalUrlAttribute)
+               || key == EntryAttributes::KPEX_PASSKEY_RELYING_PARTY;
+    }
+} // namespace
+
+BrowserEntryIndex::BrowserEntryIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+{
+    connect(db, &Database::groupAdded, this, &BrowserEntryIndex::scheduleSweep);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &BrowserEntryIndex::clear);
+    connect(db, &Database::databaseDiscarded, this, &BrowserEntryIndex::clear);
+}
+
+/**
+ * Get the index of a database, creating it on first use.
+ *
+ * @param db database to index
+ * @return index owned by the database
+ */
+BrowserEntryIndex* BrowserEntryIndex::forDatabase(Database* db)
+{
+    auto index = db->findChild<BrowserEntryIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index) {
+        index = new BrowserEntryIndex(db);
+    }
+    return index;
+}
+
+/**
+ * Find the entries that may match a site.
+ *
+ * @param siteHost host of the site URL
+ * @return entries with an URL on a host the site host ends with, and entries
+ *         whose URLs contain placeholders and have to be matched on every request
+ */
+QSet<Entry*> BrowserEntryIndex::candidates(const QString& siteHost)
+{
+    ensureCurrent();
+
+    QSet<Entry*> result = m_liveEntries;
+    const auto hosts = m_domains.constFind(urlTools()->getBaseDomainFromUrl(siteHost));
+    if (hosts == m_domains.constEnd()) {
+        return result;
+    }
+
+    for (auto it = hosts->constBegin(); it != hosts->constEnd(); ++it) {
+        if (siteHost.endsWith(it.key())) {
+            result.unite(it.value());
+        }
+    }
+    return result;
+}
+
+/**
+ * Find the entries with a passkey for a relying party.
+ *
+ * @param rpId relying party identifier
+ * @return entries whose passkey relying party equals the identifier
+ */
+QSet<Entry*> BrowserEntryIndex::passkeyCandidates(const QString& rpId)
+{
+    ensureCurrent();
+    return m_relyingParties.value(rpId);
+}
+
+/**
+ * @return all entries of the database, including recycled ones, in no particular order
+ */
+QList<Entry*> BrowserEntryIndex::entries()
+{
+    ensureCurrent();
+
+    QList<Entry*> result;
+    result.reserve(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        result.append(const_cast<Entry*>(it.key()));
+    }
+    return result;
+}
+
+/**
+ * @return entries with a passkey private key, including recycled ones, in no particular order
+ */
+QList<Entry*> BrowserEntryIndex::passkeyEntries()
+{
+    ensureCurrent();
+    return m_passkeyEntries.values();
+}
+
+void BrowserEntryIndex::addEntry(Entry* entry)
+{
+    if (entry->database() == m_db) {
+        drop(entry);
+        index(entry);
+    }
+}
+
+void BrowserEntryIndex::invalidateEntry()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry) {
+        addEntry(entry);
+    }
+}
+
+void BrowserEntryIndex::removeEntry(Entry* entry)
+{
+    drop(entry);
+    disconnect(entry, nullptr, this, nullptr);
+}
+
+void BrowserEntryIndex::removeDestroyedEntry(QObject* entry)
+{
+    // The entry is already destroyed at this point, only its address is used
+    drop(static_cast<const Entry*>(entry));
+}
+
+void BrowserEntryIndex::scheduleSweep()
+{
+    // Entries of an added group do not emit entryAdded
+    m_sweepPending = true;
+}
+
+void BrowserEntryIndex::clear()
+{
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    if (m_rootGroup) {
+        m_rootGroup->forEachGroupRecursive([this](const Group* group) {
+            disconnect(group, nullptr, this, nullptr);
+            return true;
+        });
+    }
+    m_domains.clear();
+    m_entries.clear();
+    m_liveEntries.clear();
+    m_relyingParties.clear();
+    m_entryRelyingParties.clear();
+    m_passkeyEntries.clear();
+    m_rootGroup = m_db->rootGroup();
+    m_sweepPending = true;
+}
+
+void BrowserEntryIndex::ensureCurrent()
+{
+    if (m_rootGroup != m_db->rootGroup()) {
+        clear();
+    }
+    if (m_sweepPending) {
+        sweep();
+    }
+}
+
+/**
+ * Index all entries of the database that are not indexed yet.
+ */
+void BrowserEntryIndex::sweep()
+{
+    m_sweepPending = false;
+    m_rootGroup = m_db->rootGroup();
+    if (!m_rootGroup) {
+        return;
+    }
+
+    m_rootGroup->forEachGroupRecursive([this](Group* group) {
+        connect(group, &Group::entryAdded, this, &BrowserEntryIndex::addEntry, Qt::UniqueConnection);
+        connect(group, &Group::entryRemoved, this, &BrowserEntryIndex::removeEntry, Qt::UniqueConnection);
+        for (auto* entry : group->entries()) {
+            if (!m_entries.contains(entry)) {
+                index(entry);
+            }
+        }
+        return true;
+    });
+}
+
+void BrowserEntryIndex::index(Entry* entry)
+{
+    const auto hosts = entryHosts(entry);
+    m_entries.insert(entry, hosts);
+    for (const auto& host : hosts) {
+        if (host.first.isEmpty()) {
+            m_liveEntries.insert(entry);
+        } else {
+            m_domains[host.first][host.second].insert(entry);
+        }
+    }
+
+    const auto rpId = entry->attributes()->value(EntryAttributes::KPEX_PASSKEY_RELYING_PARTY);
+    if (!rpId.isEmpty()) {
+        m_relyingParties[rpId].insert(entry);
+        m_entryRelyingParties.insert(entry, rpId);
+    }
+    if (entry->attributes()->hasKey(EntryAttributes::KPEX_PASSKEY_PRIVATE_KEY_PEM)) {
+        m_passkeyEntries.insert(entry);
+    }
+
+    connect(entry, &Entry::modified, this, &BrowserEntryIndex::invalidateEntry, Qt::UniqueConnection);
+    connect(entry, &QObject::destroyed, this, &BrowserEntryIndex::removeDestroyedEntry, Qt::UniqueConnection);
+}
+
+void BrowserEntryIndex::drop(const Entry* entry)
+{
+    auto it = m_entries.find(entry);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    for (const auto& host : asConst(it.value())) {
+        auto hosts = m_domains.find(host.first);
+        if (hosts == m_domains.end()) {
+            continue;
+        }
+        auto entries = hosts->find(host.second);
+        if (entries != hosts->end()) {
+            entries->remove(const_cast<Entry*>(entry));
+            if (entries->isEmpty()) {
+                hosts->erase(entries);
+            }
+        }
+        if (hosts->isEmpty()) {
+            m_domains.erase(hosts);
+        }
+    }
+    m_liveEntries.remove(const_cast<Entry*>(entry));
+    m_passkeyEntries.remove(const_cast<Entry*>(entry));
+    m_entries.erase(it);
+
+    const auto rpId = m_entryRelyingParties.take(entry);
+    if (!rpId.isEmpty()) {
+        auto entries = m_relyingParties.find(rpId);
+        if (entries != m_relyingParties.end()) {
+            entries->remove(const_cast<Entry*>(entry));
+            if (entries->isEmpty()) {
+                m_relyingParties.erase(entries);
+            }
+        }
+    }
+}
+
+/**
+ * Get the keys of all URLs of an entry the way BrowserService::handleURL() parses them.
+ *
+ * @param entry entry to index
+ * @return pairs of base domain and host, an empty base domain marks an entry
+ *         whose URLs contain placeholders
+ */
+QVector<BrowserEntryIndex::DomainHost> BrowserEntryIndex::entryHosts(const Entry* entry)
+{
+    // Placeholders may refer to other entries, which would not invalidate this one
+    bool resolveLive = entry->url().contains('{');
+    const auto attributes = entry->attributes();
+    for (const auto& key : attributes->keys()) {
+        if (resolveLive) {
+            break;
+        }
+        resolveLive = isUrlAttribute(key) && attributes->value(key).contains('{');
+    }
+    if (resolveLive) {
+        return {DomainHost()};
+    }
+
+    QVector<DomainHost> hosts;
+    auto addHost = [&](const QString& host) {
+        DomainHost key(urlTools()->getBaseDomainFromUrl(host), host);
+        if (!key.first.isEmpty() && !hosts.contains(key)) {
+            hosts.append(key);
+        }
+    };
+
+    for (const auto& url : entry->getAllUrls()) {
+        const auto entryUrl = url.contains("://") ? QUrl(url) : QUrl::fromUserInput(url);
+        const auto host = entryUrl.host();
+        if (host.isEmpty()) {
+            continue;
+        }
+        addHost(host);
+        // Groups may omit the www subdomain from matching
+        if (host.startsWith("www.")) {
+            addHost(QString(host).remove("www."));
+        }
+    }
+    return hosts;
+}
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BROWSERENTRYINDEX_H
+#define KEEPASSXC_BROWSERENTRYINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QSet>
+#include <QVector>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Per database index of the hosts in the entry URLs used by BrowserService.
+ *
+ * Entries are keyed by the registrable domain and the host of their main URL
+ * and all additional URLs, so a site only has to be matched against entries
+ * that share its base domain and whose host is a suffix of the site host.
+ * Entries with a passkey are also keyed by their relying party, and the
+ * entries and passkeys of a database can be listed without walking its groups.
+ * The index is built on the first lookup and updated as entries are added,
+ * modified, moved or deleted. Group and entry options such as hiding or key
+ * restrictions are not part of the index and still have to be checked.
+ */
+class BrowserEntryIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    static BrowserEntryIndex* forDatabase(Database* db);
+
+    QSet<Entry*> candidates(const QString& siteHost);
+    QSet<Entry*> passkeyCandidates(const QString& rpId);
+    QList<Entry*> entries();
+    QList<Entry*> passkeyEntries();
+
+private slots:
+    void addEntry(Entry* entry);
+    void invalidateEntry();
+    void removeEntry(Entry* entry);
+    void removeDestroyedEntry(QObject* entry);
+    void scheduleSweep();
+    void clear();
+
+private:
+    typedef QPair<QString, QString> DomainHost;
+
+    explicit BrowserEntryIndex(Database* db);
+
+    void ensureCurrent();
+    void sweep();
+    void index(Entry* entry);
+    void drop(const Entry* entry);
+
+    static QVector<DomainHost> entryHosts(const Entry* entry);
+
+    Database* m_db;
+    QPointer<Group> m_rootGroup;
+    bool m_sweepPending = true;
+    QHash<QString, QHash<QString, QSet<Entry*>>> m_domains;
+    QHash<const Entry*, QVector<DomainHost>> m_entries;
+    QSet<Entry*> m_liveEntries;
+    QHash<QString, QSet<Entry*>> m_relyingParties;
+    QHash<const Entry*, QString> m_entryRelyingParties;
+    QSet<Entry*> m_passkeyEntries;
+};
+
+#endif // KEEPASSXC_BROWSERENTRYINDEX_H
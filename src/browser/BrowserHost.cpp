@@ -54,6 +54,7 @@ void BrowserHost::start()
 void BrowserHost::stop()
 {
     m_socketList.clear();
+    m_pendingData.clear();
     m_localServer->close();
 }
 
@@ -81,19 +82,33 @@ void BrowserHost::readProxyMessage()
         setsockopt(socketDesc, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<char*>(&max), sizeof(max));
     }
 
-    QJsonParseError error;
-    auto json = QJsonDocument::fromJson(socket->readAll(), &error);
-    if (json.isNull()) {
-        qWarning() << "Failed to read proxy message: " << error.errorString();
-        return;
+    auto& pending = m_pendingData[socket];
+    pending.append(socket->readAll());
+    const auto messages = BrowserShared::takeMessages(pending);
+    if (pending.size() > BrowserShared::NATIVEMSG_MAX_LENGTH) {
+        qWarning() << "Discarding oversized proxy message";
+        pending.clear();
     }
 
-    emit clientMessageReceived(socket, json.object());
+    // A receiver may run a dialog and remove the socket meanwhile
+    QPointer<QLocalSocket> guard(socket);
+    for (const auto& message : messages) {
+        QJsonParseError error;
+        auto json = QJsonDocument::fromJson(message, &error);
+        if (json.isNull()) {
+            qWarning() << "Failed to read proxy message: " << error.errorString();
+            continue;
+        }
+        emit clientMessageReceived(socket, json.object());
+        if (!guard) {
+            return;
+        }
+    }
 }
 
 void BrowserHost::broadcastClientMessage(const QJsonObject& json)
 {
-    QString reply(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    const auto reply = QJsonDocument(json).toJson(QJsonDocument::Compact);
     for (const auto socket : m_socketList) {
         sendClientData(socket, reply);
     }
@@ -101,15 +116,13 @@ void BrowserHost::broadcastClientMessage(const QJsonObject& json)
 
 void BrowserHost::sendClientMessage(QLocalSocket* socket, const QJsonObject& json)
 {
-    QString reply(QJsonDocument(json).toJson(QJsonDocument::Compact));
-    sendClientData(socket, reply);
+    sendClientData(socket, QJsonDocument(json).toJson(QJsonDocument::Compact));
 }
 
-void BrowserHost::sendClientData(QLocalSocket* socket, const QString& data)
+void BrowserHost::sendClientData(QLocalSocket* socket, const QByteArray& data)
 {
     if (socket && socket->isValid() && socket->state() == QLocalSocket::ConnectedState) {
-        QByteArray arr = data.toUtf8();
-        socket->write(arr.constData(), arr.length());
+        socket->write(data);
         socket->flush();
     }
 }
@@ -118,4 +131,5 @@ void BrowserHost::proxyDisconnected()
 {
     auto socket = qobject_cast<QLocalSocket*>(QObject::sender());
     m_socketList.removeOne(socket);
+    m_pendingData.remove(socket);
 }
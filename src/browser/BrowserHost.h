@@ -18,6 +18,7 @@
 #ifndef KEEPASSXC_NATIVEMESSAGINGHOST_H
 #define KEEPASSXC_NATIVEMESSAGINGHOST_H
 
+#include <QHash>
 #include <QJsonObject>
 #include <QObject>
 #include <QPointer>
@@ -49,11 +50,12 @@ private slots:
     void proxyDisconnected();
 
 private:
-    void sendClientData(QLocalSocket* socket, const QString& data);
+    void sendClientData(QLocalSocket* socket, const QByteArray& data);
 
 private:
     QPointer<QLocalServer> m_localServer;
     QList<QLocalSocket*> m_socketList;
+    QHash<QLocalSocket*, QByteArray> m_pendingData;
 };
 
 #endif // KEEPASSXC_NATIVEMESSAGINGHOST_H
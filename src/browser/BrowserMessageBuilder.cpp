@@ -16,8 +16,8 @@
  */
 
 #include "BrowserMessageBuilder.h"
-#include "BrowserShared.h"
 #include "config-keepassx.h"
+#include "core/Base64.h"
 #include "core/Global.h"
 
 #include <QCryptographicHash>
@@ -32,6 +32,12 @@
 
 using namespace Botan::Sodium;
 
+namespace
+{
+    // Clients rotate their keys with every connection, so only a few are in use at once
+    const int MaxSharedKeys = 32;
+} // namespace
+
 Q_GLOBAL_STATIC(BrowserMessageBuilder, s_browserMessageBuilder);
 
 BrowserMessageBuilder* BrowserMessageBuilder::instance()
@@ -170,9 +176,9 @@ QString BrowserMessageBuilder::encryptMessage(const QJsonObject& message,
         return {};
     }
 
-    const QString reply(QJsonDocument(message).toJson());
+    const auto reply = QJsonDocument(message).toJson();
     if (!reply.isEmpty()) {
-        return encrypt(reply, nonce, publicKey, secretKey);
+        return encryptData(reply, nonce, publicKey, secretKey);
     }
 
     return {};
@@ -200,63 +206,111 @@ QString BrowserMessageBuilder::encrypt(const QString& plaintext,
                                        const QString& publicKey,
                                        const QString& secretKey)
 {
-    const QByteArray ma = plaintext.toUtf8();
-    const QByteArray na = base64Decode(nonce);
-    const QByteArray ca = base64Decode(publicKey);
-    const QByteArray sa = base64Decode(secretKey);
-
-    std::vector<unsigned char> m(ma.cbegin(), ma.cend());
-    std::vector<unsigned char> n(na.cbegin(), na.cend());
-    std::vector<unsigned char> ck(ca.cbegin(), ca.cend());
-    std::vector<unsigned char> sk(sa.cbegin(), sa.cend());
+    return encryptData(plaintext.toUtf8(), nonce, publicKey, secretKey);
+}
 
-    std::vector<unsigned char> e;
-    e.resize(BrowserShared::NATIVEMSG_MAX_LENGTH);
+QByteArray BrowserMessageBuilder::decrypt(const QString& encrypted,
+                                          const QString& nonce,
+                                          const QString& publicKey,
+                                          const QString& secretKey)
+{
+    const QByteArray m = base64Decode(encrypted);
+    const QByteArray n = base64Decode(nonce);
+    if (m.size() <= static_cast<int>(crypto_box_MACBYTES) || n.size() != static_cast<int>(crypto_box_NONCEBYTES)) {
+        return {};
+    }
 
-    if (m.empty() || n.empty() || ck.empty() || sk.empty()) {
+    const auto key = sharedKey(publicKey, secretKey);
+    if (key.isEmpty()) {
         return {};
     }
 
-    if (crypto_box_easy(e.data(), m.data(), m.size(), n.data(), ck.data(), sk.data()) == 0) {
-        QByteArray res = getQByteArray(e.data(), (crypto_box_MACBYTES + ma.length()));
-        return res.toBase64();
+    QByteArray d(m.size() - static_cast<int>(crypto_box_MACBYTES), Qt::Uninitialized);
+    if (crypto_box_open_easy_afternm(reinterpret_cast<uint8_t*>(d.data()),
+                                     reinterpret_cast<const uint8_t*>(m.constData()),
+                                     m.size(),
+                                     reinterpret_cast<const uint8_t*>(n.constData()),
+                                     reinterpret_cast<const uint8_t*>(key.constData()))
+        != 0) {
+        return {};
     }
 
-    return {};
+    // Messages are JSON text, anything after a terminating null is ignored
+    const int length = d.indexOf('\0');
+    if (length >= 0) {
+        d.truncate(length);
+    }
+    return d;
 }
 
-QByteArray BrowserMessageBuilder::decrypt(const QString& encrypted,
-                                          const QString& nonce,
-                                          const QString& publicKey,
-                                          const QString& secretKey)
+QString BrowserMessageBuilder::encryptData(const QByteArray& plaintext,
+                                           const QString& nonce,
+                                           const QString& publicKey,
+                                           const QString& secretKey)
 {
-    const QByteArray ma = base64Decode(encrypted);
-    const QByteArray na = base64Decode(nonce);
-    const QByteArray ca = base64Decode(publicKey);
-    const QByteArray sa = base64Decode(secretKey);
+    const QByteArray n = base64Decode(nonce);
+    if (plaintext.isEmpty() || n.size() != static_cast<int>(crypto_box_NONCEBYTES)) {
+        return {};
+    }
+
+    const auto key = sharedKey(publicKey, secretKey);
+    if (key.isEmpty()) {
+        return {};
+    }
 
-    std::vector<unsigned char> m(ma.cbegin(), ma.cend());
-    std::vector<unsigned char> n(na.cbegin(), na.cend());
-    std::vector<unsigned char> ck(ca.cbegin(), ca.cend());
-    std::vector<unsigned char> sk(sa.cbegin(), sa.cend());
+    QByteArray e(plaintext.size() + static_cast<int>(crypto_box_MACBYTES), Qt::Uninitialized);
+    if (crypto_box_easy_afternm(reinterpret_cast<uint8_t*>(e.data()),
+                                reinterpret_cast<const uint8_t*>(plaintext.constData()),
+                                plaintext.size(),
+                                reinterpret_cast<const uint8_t*>(n.constData()),
+                                reinterpret_cast<const uint8_t*>(key.constData()))
+        != 0) {
+        return {};
+    }
+    return Base64::encode(e);
+}
 
-    std::vector<unsigned char> d;
-    d.resize(BrowserShared::NATIVEMSG_MAX_LENGTH);
+/**
+ * Get the box key of a client, the X25519 exchange is only computed for new keys.
+ *
+ * @param publicKey base64 encoded public key of the client
+ * @param secretKey base64 encoded secret key of the connection
+ * @return precomputed key, or an empty array if a key is invalid
+ */
+QByteArray BrowserMessageBuilder::sharedKey(const QString& publicKey, const QString& secretKey)
+{
+    QMutexLocker locker(&m_sharedKeysMutex);
+    const auto keys = qMakePair(publicKey, secretKey);
+    auto it = m_sharedKeys.constFind(keys);
+    if (it != m_sharedKeys.constEnd()) {
+        return it.value();
+    }
 
-    if (m.empty() || n.empty() || ck.empty() || sk.empty()) {
+    const QByteArray pk = base64Decode(publicKey);
+    const QByteArray sk = base64Decode(secretKey);
+    if (pk.size() != static_cast<int>(crypto_box_PUBLICKEYBYTES)
+        || sk.size() != static_cast<int>(crypto_box_SECRETKEYBYTES)) {
         return {};
     }
 
-    if (crypto_box_open_easy(d.data(), m.data(), ma.length(), n.data(), ck.data(), sk.data()) == 0) {
-        return getQByteArray(d.data(), std::char_traits<char>::length(reinterpret_cast<const char*>(d.data())));
+    QByteArray key(static_cast<int>(crypto_box_BEFORENMBYTES), Qt::Uninitialized);
+    if (crypto_box_beforenm(reinterpret_cast<uint8_t*>(key.data()),
+                            reinterpret_cast<const uint8_t*>(pk.constData()),
+                            reinterpret_cast<const uint8_t*>(sk.constData()))
+        != 0) {
+        return {};
     }
 
-    return {};
+    if (m_sharedKeys.size() >= MaxSharedKeys) {
+        m_sharedKeys.clear();
+    }
+    m_sharedKeys.insert(keys, key);
+    return key;
 }
 
 QString BrowserMessageBuilder::getBase64FromKey(const uchar* array, const uint len)
 {
-    return getQByteArray(array, len).toBase64();
+    return Base64::encode(getQByteArray(array, len));
 }
 
 QByteArray BrowserMessageBuilder::getQByteArray(const uchar* array, const uint len) const
@@ -297,7 +351,7 @@ QJsonObject BrowserMessageBuilder::getJsonObject(const QByteArray& ba) const
 
 QByteArray BrowserMessageBuilder::base64Decode(const QString& str)
 {
-    return QByteArray::fromBase64(str.toUtf8());
+    return Base64::decode(str);
 }
 
 QString BrowserMessageBuilder::incrementNonce(const QString& nonce)
@@ -306,7 +360,7 @@ QString BrowserMessageBuilder::incrementNonce(const QString& nonce)
     std::vector<unsigned char> n(nonceArray.cbegin(), nonceArray.cend());
 
     sodium_increment(n.data(), n.size());
-    return getQByteArray(n.data(), n.size()).toBase64();
+    return Base64::encode(getQByteArray(n.data(), n.size()));
 }
 
 QString BrowserMessageBuilder::getRandomBytesAsBase64(int bytes) const
@@ -18,6 +18,8 @@
 #ifndef KEEPASSXC_BROWSERMESSAGEBUILDER_H
 #define KEEPASSXC_BROWSERMESSAGEBUILDER_H
 
+#include <QHash>
+#include <QMutex>
 #include <QPair>
 #include <QString>
 #include <QVariant>
@@ -110,6 +112,16 @@ public:
 private:
     Q_DISABLE_COPY(BrowserMessageBuilder);
 
+    QString encryptData(const QByteArray& plaintext,
+                        const QString& nonce,
+                        const QString& publicKey,
+                        const QString& secretKey);
+    QByteArray sharedKey(const QString& publicKey, const QString& secretKey);
+
+    // Box keys precomputed from the client public key and our secret key
+    QHash<QPair<QString, QString>, QByteArray> m_sharedKeys;
+    QMutex m_sharedKeysMutex;
+
     friend class TestBrowser;
 };
 
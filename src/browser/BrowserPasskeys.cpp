@@ -310,37 +310,28 @@ QByteArray BrowserPasskeys::buildSignature(const QByteArray& authenticatorData,
     const auto attToBeSigned = authenticatorData + clientDataHash;
 
     try {
-        const auto privateKeyArray = privateKeyPem.toUtf8();
-        Botan::DataSource_Memory dataSource(reinterpret_cast<const uint8_t*>(privateKeyArray.constData()),
-                                            privateKeyArray.size());
-
-        const auto key = Botan::PKCS8::load_key(dataSource).release();
-        const auto privateKeyBytes = key->private_key_bits();
-        const auto algName = key->algo_name();
-        const auto algId = key->algorithm_identifier();
+        const auto privateKey = loadPrivateKey(privateKeyPem);
+        const auto algName = privateKey->algo_name();
 
         std::vector<uint8_t> rawSignature;
         if (algName == "ECDSA") {
-            Botan::ECDSA_PrivateKey privateKey(algId, privateKeyBytes);
 #ifdef WITH_XC_BOTAN3
             Botan::PK_Signer signer(
-                privateKey, *randomGen()->getRng(), "EMSA1(SHA-256)", Botan::Signature_Format::DerSequence);
+                *privateKey, *randomGen()->getRng(), "EMSA1(SHA-256)", Botan::Signature_Format::DerSequence);
 #else
-            Botan::PK_Signer signer(privateKey, *randomGen()->getRng(), "EMSA1(SHA-256)", Botan::DER_SEQUENCE);
+            Botan::PK_Signer signer(*privateKey, *randomGen()->getRng(), "EMSA1(SHA-256)", Botan::DER_SEQUENCE);
 #endif
 
             signer.update(reinterpret_cast<const uint8_t*>(attToBeSigned.constData()), attToBeSigned.size());
             rawSignature = signer.signature(*randomGen()->getRng());
         } else if (algName == "RSA") {
-            Botan::RSA_PrivateKey privateKey(algId, privateKeyBytes);
-            Botan::PK_Signer signer(privateKey, *randomGen()->getRng(), "EMSA3(SHA-256)");
+            Botan::PK_Signer signer(*privateKey, *randomGen()->getRng(), "EMSA3(SHA-256)");
 
             signer.update(reinterpret_cast<const uint8_t*>(attToBeSigned.constData()), attToBeSigned.size());
             rawSignature = signer.signature(*randomGen()->getRng());
         } else if (algName == "Ed25519") {
-            Botan::Ed25519_PrivateKey privateKey(algId, privateKeyBytes);
             // "Pure" here means signing message directly. SHA-512 is only used with pre-hashed Ed25519 (Ed25519ph).
-            Botan::PK_Signer signer(privateKey, *randomGen()->getRng(), "Pure");
+            Botan::PK_Signer signer(*privateKey, *randomGen()->getRng(), "Pure");
 
             signer.update(reinterpret_cast<const uint8_t*>(attToBeSigned.constData()), attToBeSigned.size());
             rawSignature = signer.signature(*randomGen()->getRng());
@@ -357,6 +348,41 @@ QByteArray BrowserPasskeys::buildSignature(const QByteArray& authenticatorData,
     }
 }
 
+/**
+ * Parse a private key, or get it from the keys parsed before.
+ *
+ * @param privateKeyPem PKCS#8 PEM of the key
+ * @return parsed key, throws if the key cannot be parsed
+ */
+std::shared_ptr<Botan::Private_Key> BrowserPasskeys::loadPrivateKey(const QString& privateKeyPem)
+{
+    // A changed key of an entry has a different hash, the old one is dropped with the cache
+    const auto keyHash = browserMessageBuilder()->getSha256Hash(privateKeyPem);
+    auto cached = m_privateKeys.constFind(keyHash);
+    if (cached != m_privateKeys.constEnd()) {
+        return cached.value();
+    }
+
+    const auto privateKeyArray = privateKeyPem.toUtf8();
+    Botan::DataSource_Memory dataSource(reinterpret_cast<const uint8_t*>(privateKeyArray.constData()),
+                                        privateKeyArray.size());
+    std::shared_ptr<Botan::Private_Key> privateKey = Botan::PKCS8::load_key(dataSource);
+
+    if (m_privateKeys.size() >= MAX_CACHED_KEYS) {
+        m_privateKeys.clear();
+    }
+    m_privateKeys.insert(keyHash, privateKey);
+    return privateKey;
+}
+
+/**
+ * Drop all parsed private keys, called when a database is locked.
+ */
+void BrowserPasskeys::clearKeyCache()
+{
+    m_privateKeys.clear();
+}
+
 // Parse authentication data byte array to JSON
 // See: https://www.w3.org/TR/webauthn/images/fido-attestation-structures.svg
 // And: https://w3c.github.io/webauthn/#attested-credential-data
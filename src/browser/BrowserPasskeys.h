@@ -19,16 +19,25 @@
 #define BROWSERPASSKEYS_H
 
 #include "BrowserCbor.h"
+#include <QHash>
 #include <QJsonObject>
 #include <QObject>
 
 #include <botan/asn1_obj.h>
 #include <botan/bigint.h>
 
+#include <memory>
+
+namespace Botan
+{
+    class Private_Key;
+}
+
 #define ID_BYTES 32
 #define HASH_BYTES 32
 #define RSA_BITS 2048
 #define RSA_EXPONENT 65537
+#define MAX_CACHED_KEYS 64
 
 enum AuthDataOffsets : int
 {
@@ -86,6 +95,7 @@ public:
                                             const QString& credentialId,
                                             const QString& userHandle,
                                             const QString& privateKeyPem);
+    void clearKeyCache();
 
     static const QString AAGUID;
 
@@ -117,6 +127,7 @@ private:
                                                  const QString& predefinedSecond = QString());
     QByteArray
     buildSignature(const QByteArray& authenticatorData, const QByteArray& clientData, const QString& privateKeyPem);
+    std::shared_ptr<Botan::Private_Key> loadPrivateKey(const QString& privateKeyPem);
     QJsonObject parseAuthData(const QByteArray& authData) const;
     QJsonObject parseFlags(const QByteArray& flags) const;
     char setFlagsFromJson(const QJsonObject& flags) const;
@@ -129,6 +140,8 @@ private:
 
 private:
     BrowserCbor m_browserCbor;
+    // Parsed private keys by hash of their PEM, the key material is kept in Botan's secure memory
+    QHash<QByteArray, std::shared_ptr<Botan::Private_Key>> m_privateKeys;
 };
 
 static inline BrowserPasskeys* browserPasskeys()
@@ -20,11 +20,13 @@
 #include "BrowserService.h"
 #include "BrowserAction.h"
 #include "BrowserEntryConfig.h"
+#include "BrowserEntryIndex.h"
 #include "BrowserEntrySaveDialog.h"
 #include "BrowserHost.h"
 #include "BrowserMessageBuilder.h"
 #include "BrowserSettings.h"
 #include "core/EntryAttributes.h"
+#include "core/PerformanceStats.h"
 #include "core/Tools.h"
 #include "gui/MainWindow.h"
 #include "gui/MessageBox.h"
@@ -52,6 +54,7 @@
 #include <QLocale>
 #include <QProgressDialog>
 #include <QUrl>
+#include <QtConcurrent>
 
 const QString BrowserService::KEEPASSXCBROWSER_NAME = QStringLiteral("KeePassXC-Browser Settings");
 const QString BrowserService::KEEPASSXCBROWSER_OLD_NAME = QStringLiteral("keepassxc-browser Settings");
@@ -244,9 +247,10 @@ QJsonArray BrowserService::getDatabaseEntries()
     }
 
     QJsonArray entries;
-    for (const auto& group : rootGroup->groupsRecursive(true)) {
-        if (group == db->metadata()->recycleBin()) {
-            continue;
+    const auto recycleBin = db->metadata()->recycleBin();
+    rootGroup->forEachGroupRecursive([&](const Group* group) {
+        if (group == recycleBin) {
+            return true;
         }
 
         for (const auto& entry : group->entries()) {
@@ -256,7 +260,8 @@ QJsonArray BrowserService::getDatabaseEntries()
             jentry["url"] = entry->resolveMultiplePlaceholders(entry->url());
             entries.push_back(jentry);
         }
-    }
+        return true;
+    });
     return entries;
 }
 
@@ -366,6 +371,62 @@ QString BrowserService::getCurrentTotp(const QString& uuid)
 
 QJsonArray
 BrowserService::findEntries(const EntryParameters& entryParameters, const StringPairList& keyList, bool* entriesFound)
+{
+    return authorizeEntries(
+        entryParameters, searchEntries(entryParameters.siteUrl, entryParameters.formUrl, keyList), entriesFound);
+}
+
+/**
+ * Find the entries for several sites, e.g. all frames of a page, with one search of the databases.
+ *
+ * @param entryParameters parameters of each site
+ * @param keyList connection keys of the browser
+ * @return allowed entries for each site, in the same order as the parameters
+ */
+QList<QJsonArray> BrowserService::findEntries(const QList<EntryParameters>& entryParameters,
+                                              const StringPairList& keyList)
+{
+    // Frames of a page often share their URLs, search for each pair of URLs only once
+    StringPairList urls;
+    for (const auto& parameters : entryParameters) {
+        const StringPair url(parameters.siteUrl, parameters.formUrl);
+        if (!urls.contains(url)) {
+            urls << url;
+        }
+    }
+    const auto searchResults = searchEntries(urls, keyList);
+
+    QList<QJsonArray> results;
+    for (int i = 0; i < entryParameters.size(); ++i) {
+        const auto& parameters = entryParameters.at(i);
+        const auto begin = entryParameters.constBegin();
+        const auto same = std::find_if(begin, begin + i, [&](const EntryParameters& other) {
+            return other.siteUrl == parameters.siteUrl && other.formUrl == parameters.formUrl
+                   && other.httpAuth == parameters.httpAuth;
+        });
+
+        // Identical requests share the access check and the sort priorities
+        if (same != begin + i) {
+            results << results.at(static_cast<int>(same - begin));
+        } else {
+            const auto& entries = searchResults.at(urls.indexOf({parameters.siteUrl, parameters.formUrl}));
+            results << authorizeEntries(parameters, entries, nullptr);
+        }
+    }
+    return results;
+}
+
+/**
+ * Check the access of found entries and sort them for a site.
+ *
+ * @param entryParameters parameters of the site
+ * @param foundEntries entries matching the site
+ * @param entriesFound set to whether any entry was allowed, may be null
+ * @return allowed entries prepared for the browser extension
+ */
+QJsonArray BrowserService::authorizeEntries(const EntryParameters& entryParameters,
+                                            const QList<Entry*>& foundEntries,
+                                            bool* entriesFound)
 {
     if (entriesFound) {
         *entriesFound = false;
@@ -379,7 +440,7 @@ BrowserService::findEntries(const EntryParameters& entryParameters, const String
     // Check entries for authorization
     QList<Entry*> entriesToConfirm;
     QList<Entry*> allowedEntries;
-    for (auto* entry : searchEntries(entryParameters.siteUrl, entryParameters.formUrl, keyList)) {
+    for (auto* entry : foundEntries) {
         auto entryCustomData = entry->customData();
 
         if (!entryParameters.httpAuth
@@ -1015,22 +1076,49 @@ QList<Entry*> BrowserService::searchEntries(const QSharedPointer<Database>& db,
         return entries;
     }
 
-    for (const auto& group : rootGroup->groupsRecursive(true)) {
+    // Only entries with an URL on the site host or a passkey of the relying party can match,
+    // special schemes check all entries
+    const auto siteHost = QUrl(siteUrl).host();
+    const bool useIndex = passkey
+                          || (!siteHost.isEmpty() && !siteUrl.startsWith("keepassxc://")
+                              && !siteUrl.startsWith("file://"));
+    QSet<Entry*> candidates;
+    QSet<const Group*> candidateGroups;
+    if (useIndex) {
+        auto index = BrowserEntryIndex::forDatabase(db.data());
+        candidates = passkey ? index->passkeyCandidates(siteUrl) : index->candidates(siteHost);
+        if (candidates.isEmpty()) {
+            return entries;
+        }
+        for (const auto* entry : asConst(candidates)) {
+            candidateGroups.insert(entry->group());
+        }
+    }
+
+    rootGroup->forEachGroupRecursive([&](const Group* group) {
+        if (useIndex && !candidateGroups.contains(group)) {
+            return true;
+        }
+
         if (group->isRecycled()
             || group->resolveCustomDataTriState(BrowserService::OPTION_HIDE_ENTRY) == Group::Enable) {
-            continue;
+            return true;
         }
 
         // If a key restriction is specified and not contained in the keys list then skip this group.
         auto restrictKey = group->resolveCustomDataString(BrowserService::OPTION_RESTRICT_KEY);
         if (!restrictKey.isEmpty() && !keys.contains(restrictKey)) {
-            continue;
+            return true;
         }
 
         const auto omitWwwSubdomain =
             group->resolveCustomDataTriState(BrowserService::OPTION_OMIT_WWW) == Group::Enable;
 
         for (auto* entry : group->entries()) {
+            if (useIndex && !candidates.contains(entry)) {
+                continue;
+            }
+
             if (entry->isRecycled()
                 || (entry->customData()->contains(BrowserService::OPTION_HIDE_ENTRY)
                     && entry->customData()->value(BrowserService::OPTION_HIDE_ENTRY) == TRUE_STR)) {
@@ -1053,7 +1141,8 @@ QList<Entry*> BrowserService::searchEntries(const QSharedPointer<Database>& db,
                 entries.append(entry);
             }
         }
-    }
+        return true;
+    });
 
     return entries;
 }
@@ -1062,6 +1151,28 @@ QList<Entry*> BrowserService::searchEntries(const QString& siteUrl,
                                             const QString& formUrl,
                                             const StringPairList& keyList,
                                             bool passkey)
+{
+    PerformanceStats::ScopedTimer timer("browser.search");
+    // Search entries matching the hostname
+    QString hostname = QUrl(siteUrl).host();
+    QList<Entry*> entries;
+    do {
+        entries << searchEntries(StringPairList{{siteUrl, formUrl}}, keyList, passkey).first();
+    } while (entries.isEmpty() && removeFirstDomain(hostname));
+
+    return entries;
+}
+
+/**
+ * Search the connected databases for several sites at once.
+ *
+ * @param urls pairs of site and form URL
+ * @param keyList connection keys of the browser
+ * @param passkey whether to match passkey relying parties instead of URLs
+ * @return matching entries of all databases for each pair of URLs
+ */
+QList<QList<Entry*>>
+BrowserService::searchEntries(const StringPairList& urls, const StringPairList& keyList, bool passkey)
 {
     // Check if database is connected with KeePassXC-Browser. If so, return browser key (otherwise empty)
     auto databaseConnected = [&](const QSharedPointer<Database>& db) {
@@ -1095,16 +1206,40 @@ QList<Entry*> BrowserService::searchEntries(const QString& siteUrl,
         }
     }
 
-    // Search entries matching the hostname
-    QString hostname = QUrl(siteUrl).host();
-    QList<Entry*> entries;
-    do {
-        for (const auto& db : databases) {
-            entries << searchEntries(db, siteUrl, formUrl, keys, passkey);
+    // Databases are independent, search them in parallel and merge the results in database order.
+    // The GUI thread is blocked meanwhile, so none of the databases can change during the search.
+    struct DatabaseSearch
+    {
+        QSharedPointer<Database> db;
+        QList<QList<Entry*>> entries;
+    };
+    QVector<DatabaseSearch> searches;
+    for (const auto& db : asConst(databases)) {
+        // Created here since the index has to live in the thread of its database
+        BrowserEntryIndex::forDatabase(db.data());
+        searches.append({db, {}});
+    }
+    auto searchDatabase = [&](DatabaseSearch& search) {
+        for (const auto& url : urls) {
+            search.entries << searchEntries(search.db, url.first, url.second, keys, passkey);
         }
-    } while (entries.isEmpty() && removeFirstDomain(hostname));
+    };
 
-    return entries;
+    if (searches.size() > 1) {
+        QtConcurrent::blockingMap(searches, searchDatabase);
+    } else if (!searches.isEmpty()) {
+        searchDatabase(searches.first());
+    }
+
+    QList<QList<Entry*>> results;
+    for (int i = 0; i < urls.size(); ++i) {
+        QList<Entry*> entries;
+        for (const auto& search : asConst(searches)) {
+            entries << search.entries.at(i);
+        }
+        results << entries;
+    }
+    return results;
 }
 
 QString BrowserService::decodeCustomDataRestrictKey(const QString& key)
@@ -1251,10 +1386,15 @@ Group* BrowserService::getDefaultEntryGroup(const QSharedPointer<Database>& sele
         return nullptr;
     }
 
-    for (auto* g : rootGroup->groupsRecursive(true)) {
+    Group* browserGroup = nullptr;
+    rootGroup->forEachGroupRecursive([&browserGroup](Group* g) {
         if (g->name() == KEEPASSXCBROWSER_GROUP_NAME && !g->isRecycled()) {
-            return db->rootGroup()->findGroupByUuid(g->uuid());
+            browserGroup = g;
         }
+        return !browserGroup;
+    });
+    if (browserGroup) {
+        return browserGroup;
     }
 
     auto* group = new Group();
@@ -1270,25 +1410,11 @@ Group* BrowserService::getDefaultEntryGroup(const QSharedPointer<Database>& sele
 int BrowserService::sortPriority(const QStringList& urls, const QString& siteUrl, const QString& formUrl)
 {
     QList<int> priorityList;
-    // NOTE: QUrl::matches is utterly broken in Qt < 5.11, so we work around that
-    // by removing parts of the url that we don't match and direct matching others
-    const auto stdOpts = QUrl::RemoveFragment | QUrl::RemoveUserInfo;
-    const auto adjustedSiteUrl = QUrl(siteUrl).adjusted(stdOpts);
-    const auto adjustedFormUrl = QUrl(formUrl).adjusted(stdOpts);
+    const auto adjustedSiteUrl = parseUrl(siteUrl, true).sortUrl;
+    const auto adjustedFormUrl = parseUrl(formUrl, true).sortUrl;
 
     auto getPriority = [&](const QString& givenUrl) {
-        auto url = QUrl::fromUserInput(givenUrl).adjusted(stdOpts);
-
-        // Default to https scheme if undefined
-        if (url.scheme().isEmpty() || !givenUrl.contains("://")) {
-            url.setScheme("https");
-        }
-
-        // Add the empty path to the URL if it's missing.
-        // URL's from the extension always have a path set, entry URL's can be without.
-        if (url.path().isEmpty() && !url.hasFragment() && !url.hasQuery()) {
-            url.setPath("/");
-        }
+        const auto url = parseUrl(givenUrl).sortUrl;
 
         // Reject invalid urls and hosts, except 'localhost', and scheme mismatch
         if (!url.isValid() || (!url.host().contains(".") && url.host() != "localhost")
@@ -1465,63 +1591,114 @@ bool BrowserService::handleURL(const QString& entryUrl,
         return false;
     }
 
-    QUrl entryQUrl;
-    if (entryUrl.contains("://")) {
-        entryQUrl = entryUrl;
-    } else {
-        entryQUrl = QUrl::fromUserInput(entryUrl);
-
-        if (browserSettings()->matchUrlScheme()) {
-            entryQUrl.setScheme("https");
-        }
-    }
-
-    // Remove WWW subdomain from matching if group setting is enabled
-    if (omitWwwSubdomain && entryQUrl.host().startsWith("www.")) {
-        entryQUrl.setHost(entryQUrl.host().remove("www."));
-    }
-
     // Make a direct compare if a local file is used
     if (siteUrl.startsWith("file://")) {
         return entryUrl == formUrl;
     }
 
+    const auto entry = parseUrl(entryUrl);
+    auto entryHost = entry.url.host();
+    auto entryBaseDomain = entry.baseDomain;
+
+    // Remove WWW subdomain from matching if group setting is enabled
+    if (omitWwwSubdomain && entryHost.startsWith("www.")) {
+        entryHost.remove("www.");
+        entryBaseDomain = urlTools()->getBaseDomainFromUrl(entryHost);
+    }
+
     // URL host validation fails
-    if (entryQUrl.host().isEmpty()) {
+    if (entryHost.isEmpty()) {
         return false;
     }
 
     // Match port, if used
-    QUrl siteQUrl(siteUrl);
-    if (entryQUrl.port() > 0 && entryQUrl.port() != siteQUrl.port()) {
+    const auto site = parseUrl(siteUrl, true);
+    if (entry.url.port() > 0 && entry.url.port() != site.url.port()) {
         return false;
     }
 
     // Match scheme
-    if (browserSettings()->matchUrlScheme() && !entryQUrl.scheme().isEmpty()
-        && entryQUrl.scheme().compare(siteQUrl.scheme()) != 0) {
-        return false;
+    if (browserSettings()->matchUrlScheme()) {
+        const auto entryScheme = entry.hasScheme ? entry.url.scheme() : QStringLiteral("https");
+        if (!entryScheme.isEmpty() && entryScheme.compare(site.url.scheme()) != 0) {
+            return false;
+        }
     }
 
     // Check for illegal characters
-    QRegularExpression re("[<>\\^`{|}]");
-    if (re.match(entryUrl).hasMatch()) {
+    if (entry.hasIllegalCharacters) {
         return false;
     }
 
     // Match the base domain
-    if (urlTools()->getBaseDomainFromUrl(siteQUrl.host()) != urlTools()->getBaseDomainFromUrl(entryQUrl.host())) {
+    if (site.baseDomain != entryBaseDomain) {
         return false;
     }
 
     // Match the subdomains with the limited wildcard
-    if (siteQUrl.host().endsWith(entryQUrl.host())) {
+    if (site.url.host().endsWith(entryHost)) {
         return true;
     }
 
     return false;
 }
 
+/**
+ * Parse an URL once for all entries and requests it is matched against.
+ *
+ * @param url entry URL, or URL sent by the browser
+ * @param isSiteUrl whether the URL was sent by the browser
+ * @return cached parsed URL
+ */
+BrowserService::ParsedUrl BrowserService::parseUrl(const QString& url, bool isSiteUrl)
+{
+    // Bounds the cache, the URLs of all databases fit in it many times
+    const int MaxParsedUrls = 8192;
+
+    const auto key = qMakePair(url, isSiteUrl);
+    QMutexLocker locker(&m_parsedUrlsMutex);
+    auto it = m_parsedUrls.constFind(key);
+    if (it != m_parsedUrls.constEnd()) {
+        return it.value();
+    }
+    locker.unlock();
+
+    // NOTE: QUrl::matches is utterly broken in Qt < 5.11, so we work around that
+    // by removing parts of the url that we don't match and direct matching others
+    const auto stdOpts = QUrl::RemoveFragment | QUrl::RemoveUserInfo;
+
+    ParsedUrl parsed;
+    parsed.hasScheme = url.contains("://");
+    if (isSiteUrl) {
+        parsed.url = QUrl(url);
+        parsed.sortUrl = parsed.url.adjusted(stdOpts);
+    } else {
+        parsed.url = parsed.hasScheme ? QUrl(url) : QUrl::fromUserInput(url);
+
+        static const QRegularExpression illegalCharacters("[<>\\^`{|}]");
+        parsed.hasIllegalCharacters = illegalCharacters.match(url).hasMatch();
+
+        parsed.sortUrl = QUrl::fromUserInput(url).adjusted(stdOpts);
+        // Default to https scheme if undefined
+        if (parsed.sortUrl.scheme().isEmpty() || !parsed.hasScheme) {
+            parsed.sortUrl.setScheme("https");
+        }
+        // Add the empty path to the URL if it's missing.
+        // URL's from the extension always have a path set, entry URL's can be without.
+        if (parsed.sortUrl.path().isEmpty() && !parsed.sortUrl.hasFragment() && !parsed.sortUrl.hasQuery()) {
+            parsed.sortUrl.setPath("/");
+        }
+    }
+    parsed.baseDomain = urlTools()->getBaseDomainFromUrl(parsed.url.host());
+
+    locker.relock();
+    if (m_parsedUrls.size() >= MaxParsedUrls) {
+        m_parsedUrls.clear();
+    }
+    m_parsedUrls.insert(key, parsed);
+    return parsed;
+}
+
 QSharedPointer<Database> BrowserService::getDatabase(const QUuid& rootGroupUuid)
 {
     if (!rootGroupUuid.isNull()) {
@@ -1644,6 +1821,10 @@ void BrowserService::updateWindowState()
 
 void BrowserService::databaseLocked(DatabaseWidget* dbWidget)
 {
+#ifdef WITH_XC_BROWSER_PASSKEYS
+    browserPasskeys()->clearKeyCache();
+#endif
+
     if (dbWidget) {
         QJsonObject msg;
         msg["action"] = QString("database-locked");
@@ -1685,12 +1866,53 @@ void BrowserService::processClientMessage(QLocalSocket* socket, const QJsonObjec
         return;
     }
 
+    // Dialogs run a nested event loop that keeps serving other clients, the requests of the
+    // waiting client are answered in order once its current request is done
+    if (m_busyClients.contains(clientID)) {
+        m_queuedClientMessages[clientID].append({socket, message});
+        return;
+    }
+
     // Create a new client action if we haven't seen this id yet
     if (!m_browserClients.contains(clientID)) {
         m_browserClients.insert(clientID, QSharedPointer<BrowserAction>::create());
     }
 
-    auto& action = m_browserClients.value(clientID);
-    auto response = action->processClientMessage(socket, message);
+    m_busyClients.insert(clientID);
+    auto action = m_browserClients.value(clientID);
+    QJsonObject response;
+    {
+        // Includes the time spent in confirmation dialogs
+        PerformanceStats::ScopedTimer timer("browser.request");
+        response = action->processClientMessage(socket, message);
+    }
+    if (message.contains("requestID")) {
+        response["requestID"] = message.value("requestID");
+    }
     m_browserHost->sendClientMessage(socket, response);
+    m_busyClients.remove(clientID);
+
+    if (m_queuedClientMessages.contains(clientID)) {
+        QMetaObject::invokeMethod(
+            this, "processQueuedClientMessage", Qt::QueuedConnection, Q_ARG(QString, clientID));
+    }
+}
+
+void BrowserService::processQueuedClientMessage(const QString& clientID)
+{
+    auto queue = m_queuedClientMessages.find(clientID);
+    if (queue == m_queuedClientMessages.end() || m_busyClients.contains(clientID)) {
+        return;
+    }
+
+    const auto request = queue->takeFirst();
+    if (queue->isEmpty()) {
+        m_queuedClientMessages.erase(queue);
+    }
+    if (request.first) {
+        processClientMessage(request.first, request.second);
+    } else if (m_queuedClientMessages.contains(clientID)) {
+        QMetaObject::invokeMethod(
+            this, "processQueuedClientMessage", Qt::QueuedConnection, Q_ARG(QString, clientID));
+    }
 }
@@ -25,6 +25,9 @@
 #include "core/Entry.h"
 #include "gui/PasswordGeneratorWidget.h"
 
+#include <QMutex>
+#include <QUrl>
+
 class QLocalSocket;
 
 typedef QPair<QString, QString> StringPair;
@@ -121,6 +124,7 @@ public:
     bool deleteEntry(const QString& uuid);
     void removePluginData(Entry* entry) const;
     QJsonArray findEntries(const EntryParameters& entryParameters, const StringPairList& keyList, bool* entriesFound);
+    QList<QJsonArray> findEntries(const QList<EntryParameters>& entryParameters, const StringPairList& keyList);
     void requestGlobalAutoType(const QString& search);
 
     static QString decodeCustomDataRestrictKey(const QString& key);
@@ -145,6 +149,7 @@ public slots:
 
 private slots:
     void processClientMessage(QLocalSocket* socket, const QJsonObject& message);
+    void processQueuedClientMessage(const QString& clientID);
 
 private:
     enum Access
@@ -168,7 +173,11 @@ private:
                                 bool passkey = false);
     QList<Entry*>
     searchEntries(const QString& siteUrl, const QString& formUrl, const StringPairList& keyList, bool passkey = false);
+    QList<QList<Entry*>>
+    searchEntries(const StringPairList& urls, const StringPairList& keyList, bool passkey = false);
     QList<Entry*> sortEntries(QList<Entry*>& entries, const QString& siteUrl, const QString& formUrl);
+    QJsonArray
+    authorizeEntries(const EntryParameters& entryParameters, const QList<Entry*>& foundEntries, bool* entriesFound);
     QList<Entry*> confirmEntries(QList<Entry*>& entriesToConfirm,
                                  const EntryParameters& entryParameters,
                                  const QString& siteHost,
@@ -199,6 +208,19 @@ private:
                    const QString& siteUrl,
                    const QString& formUrl,
                    const bool omitWwwSubdomain = false);
+
+    struct ParsedUrl
+    {
+        // Parsed the way handleURL() matches it
+        QUrl url;
+        QString baseDomain;
+        bool hasScheme = false;
+        bool hasIllegalCharacters = false;
+        // Normalized the way sortPriority() compares it
+        QUrl sortUrl;
+    };
+    ParsedUrl parseUrl(const QString& url, bool isSiteUrl = false);
+
     QString getDatabaseRootUuid();
     QString getDatabaseRecycleBinUuid();
     void hideWindow() const;
@@ -207,6 +229,12 @@ private:
 
     QPointer<BrowserHost> m_browserHost;
     QHash<QString, QSharedPointer<BrowserAction>> m_browserClients;
+    // Requests of clients that wait for an earlier request, for example one showing a dialog
+    QHash<QString, QList<QPair<QPointer<QLocalSocket>, QJsonObject>>> m_queuedClientMessages;
+    QSet<QString> m_busyClients;
+    // Searches of several databases run in parallel and share the parsed URLs
+    QHash<QPair<QString, bool>, ParsedUrl> m_parsedUrls;
+    QMutex m_parsedUrlsMutex;
 
     bool m_dialogActive;
     bool m_bringToFrontRequested;
@@ -219,6 +247,7 @@ private:
     Q_DISABLE_COPY(BrowserService);
 
     friend class TestBrowser;
+    friend class BenchmarkBrowser;
 #ifdef WITH_XC_BROWSER_PASSKEYS
     friend class TestPasskeys;
 #endif
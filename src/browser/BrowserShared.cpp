@@ -57,4 +57,46 @@ namespace BrowserShared
         return QStandardPaths::writableLocation(QStandardPaths::TempLocation) + serverName;
 #endif
     }
+
+    /**
+     * Split the complete JSON objects off a stream of messages.
+     *
+     * The local socket has no framing, several messages may arrive in one read
+     * and a message may be split across reads.
+     *
+     * @param buffer received data, complete messages are removed from it
+     * @return complete messages in the order they were received
+     */
+    QList<QByteArray> takeMessages(QByteArray& buffer)
+    {
+        QList<QByteArray> messages;
+        int depth = 0;
+        int start = 0;
+        int consumed = 0;
+        bool inString = false;
+        bool escaped = false;
+        for (int i = 0; i < buffer.size(); ++i) {
+            const char ch = buffer.at(i);
+            if (inString) {
+                if (escaped) {
+                    escaped = false;
+                } else if (ch == '\\') {
+                    escaped = true;
+                } else if (ch == '"') {
+                    inString = false;
+                }
+            } else if (ch == '"') {
+                inString = true;
+            } else if (ch == '{') {
+                if (depth++ == 0) {
+                    start = i;
+                }
+            } else if (ch == '}' && depth > 0 && --depth == 0) {
+                messages.append(buffer.mid(start, i - start + 1));
+                consumed = i + 1;
+            }
+        }
+        buffer.remove(0, consumed);
+        return messages;
+    }
 } // namespace BrowserShared
@@ -18,6 +18,7 @@
 #ifndef KEEPASSXC_BROWSERSHARED_H
 #define KEEPASSXC_BROWSERSHARED_H
 
+#include <QList>
 #include <QString>
 
 namespace BrowserShared
@@ -38,6 +39,7 @@ namespace BrowserShared
     };
 
     QString localServerPath();
+    QList<QByteArray> takeMessages(QByteArray& buffer);
 } // namespace BrowserShared
 
 #endif // KEEPASSXC_BROWSERSHARED_H
@@ -17,19 +17,22 @@
 
 #include "Analyze.h"
 
+#include "JsonStream.h"
 #include "Utils.h"
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/HibpOffline.h"
+#include "core/PasswordHealth.h"
 
 #include <QCommandLineParser>
 #include <QFile>
+#include <QtConcurrent>
 
 const QCommandLineOption Analyze::HIBPDatabaseOption = QCommandLineOption(
     {"H", "hibp"},
     QObject::tr("Check if any passwords have been publicly leaked. FILENAME must be the path of a file listing "
                 "SHA-1 hashes of leaked passwords in HIBP format, as available from "
-                "https://haveibeenpwned.com/Passwords."),
+                "https://haveibeenpwned.com/Passwords, or a file converted with hibp-convert."),
     QObject::tr("FILENAME"));
 
 const QCommandLineOption Analyze::OkonOption =
@@ -37,12 +40,59 @@ const QCommandLineOption Analyze::OkonOption =
                        QObject::tr("Path to okon-cli to search a formatted HIBP file"),
                        QObject::tr("okon-cli"));
 
+const QCommandLineOption Analyze::HealthOption =
+    QCommandLineOption("health", QObject::tr("Also report weak and reused passwords."));
+
+const QCommandLineOption Analyze::ProgressOption =
+    QCommandLineOption("progress", QObject::tr("Print the progress of reading the HIBP file to stderr."));
+
+namespace
+{
+    QString entryPath(const Entry* entry)
+    {
+        QString path = entry->title();
+        for (auto g = entry->group(); g && g != g->database()->rootGroup(); g = g->parentGroup()) {
+            path.prepend("/").prepend(g->name());
+        }
+        return path;
+    }
+
+    QString qualityName(PasswordHealth::Quality quality)
+    {
+        switch (quality) {
+        case PasswordHealth::Quality::Bad:
+            return QStringLiteral("bad");
+        case PasswordHealth::Quality::Poor:
+            return QStringLiteral("poor");
+        case PasswordHealth::Quality::Weak:
+            return QStringLiteral("weak");
+        case PasswordHealth::Quality::Good:
+            return QStringLiteral("good");
+        case PasswordHealth::Quality::Excellent:
+            return QStringLiteral("excellent");
+        }
+        return {};
+    }
+
+    QJsonObject findingObject(const QString& type, const Entry* entry)
+    {
+        QJsonObject object;
+        object.insert("type", type);
+        object.insert("uuid", entry->uuidToHex());
+        object.insert("path", entryPath(entry));
+        return object;
+    }
+} // namespace
+
 Analyze::Analyze()
 {
     name = QString("analyze");
     description = QObject::tr("Analyze passwords for weaknesses and problems.");
     options.append(Analyze::HIBPDatabaseOption);
     options.append(Analyze::OkonOption);
+    options.append(Analyze::HealthOption);
+    options.append(Analyze::ProgressOption);
+    options.append(Command::OutputFormatOption);
 }
 
 int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -53,50 +103,133 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
     QList<QPair<const Entry*, int>> findings;
     QString error;
 
+    JsonStream::Format jsonFormat;
+    const QString format = parser->value(Command::OutputFormatOption);
+    const bool json = JsonStream::parseFormat(format, jsonFormat);
+    if (!json && format.compare("text", Qt::CaseInsensitive) != 0) {
+        err << QObject::tr("Unsupported format %1").arg(format) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+    // Status messages would break the JSON output
+    auto& info = json ? err : out;
+
+    const bool health = parser->isSet(Analyze::HealthOption);
     auto hibpDatabase = parser->value(Analyze::HIBPDatabaseOption);
-    if (!QFile::exists(hibpDatabase) || hibpDatabase.isEmpty()) {
+    const bool hibp = !hibpDatabase.isEmpty() || !health;
+    if (hibp && (!QFile::exists(hibpDatabase) || hibpDatabase.isEmpty())) {
         err << QObject::tr("Cannot find HIBP file: %1").arg(hibpDatabase);
         return EXIT_FAILURE;
     }
 
-    auto okon = parser->value(Analyze::OkonOption);
-    if (!okon.isEmpty()) {
-        out << QObject::tr("Evaluating database entries using okon…") << Qt::endl;
-
-        if (!HibpOffline::okonReport(database, okon, hibpDatabase, findings, &error)) {
-            err << error << Qt::endl;
-            return EXIT_FAILURE;
+    // Passwords are scored on the thread pool while the HIBP file is read
+    QList<const Entry*> candidates;
+    QHash<QString, int> passwordUses;
+    for (const auto* entry : database->rootGroup()->entriesRecursive()) {
+        if (!health || entry->isRecycled() || entry->password().isEmpty() || entry->excludeFromReports()) {
+            continue;
         }
+        candidates.append(entry);
+        if (!entry->isAttributeReference("Password")) {
+            ++passwordUses[entry->password()];
+        }
+    }
+    HealthChecker checker(database);
+    const std::function<QSharedPointer<PasswordHealth>(const Entry*)> evaluate = [&checker](const Entry* entry) {
+        return checker.evaluate(entry);
+    };
+    auto healthResults = QtConcurrent::run([&candidates, &evaluate] {
+        return QtConcurrent::blockingMapped<QList<QSharedPointer<PasswordHealth>>>(candidates, evaluate);
+    });
+
+    bool ok = true;
+    auto okon = parser->value(Analyze::OkonOption);
+    if (!hibp) {
+        // Only the health check was requested
+    } else if (!okon.isEmpty()) {
+        info << QObject::tr("Evaluating database entries using okon…") << Qt::endl;
+        ok = HibpOffline::okonReport(database, okon, hibpDatabase, findings, &error);
     } else {
         QFile hibpFile(hibpDatabase);
         if (!hibpFile.open(QFile::ReadOnly)) {
-            err << QObject::tr("Failed to open HIBP file %1: %2").arg(hibpDatabase).arg(hibpFile.errorString())
-                << Qt::endl;
-            return EXIT_FAILURE;
+            error = QObject::tr("Failed to open HIBP file %1: %2").arg(hibpDatabase).arg(hibpFile.errorString());
+            ok = false;
+        } else if (HibpOffline::isBinaryFormat(hibpFile)) {
+            info << QObject::tr("Evaluating database entries against HIBP file…") << Qt::endl;
+            ok = HibpOffline::report(database, hibpFile, findings, &error);
+        } else {
+            info << QObject::tr("Evaluating database entries against HIBP file, this will take a while…") << Qt::endl;
+
+            HibpOffline::ProgressCallback progress;
+            int lastPercent = -1;
+            if (parser->isSet(Analyze::ProgressOption)) {
+                progress = [&err, &lastPercent](qint64 processed, qint64 total) {
+                    const int percent = total > 0 ? static_cast<int>(processed * 100 / total) : 0;
+                    if (total > 0 && percent != lastPercent) {
+                        lastPercent = percent;
+                        err << QObject::tr("\rRead %1% of the HIBP file").arg(percent) << Qt::flush;
+                    }
+                };
+            }
+            ok = HibpOffline::report(database, hibpFile, findings, &error, progress);
+            if (lastPercent >= 0) {
+                err << Qt::endl;
+            }
         }
+    }
 
-        out << QObject::tr("Evaluating database entries against HIBP file, this will take a while…") << Qt::endl;
-
-        if (!HibpOffline::report(database, hibpFile, findings, &error)) {
-            err << error << Qt::endl;
-            return EXIT_FAILURE;
-        }
+    healthResults.waitForFinished();
+    if (!ok) {
+        err << error << Qt::endl;
+        return EXIT_FAILURE;
     }
 
+    QScopedPointer<JsonStream> jsonStream(json ? new JsonStream(out, jsonFormat) : nullptr);
     for (const auto& finding : findings) {
         const auto entry = finding.first;
         auto count = finding.second;
 
-        QString path = entry->title();
-        for (auto g = entry->group(); g && g != g->database()->rootGroup(); g = g->parentGroup()) {
-            path.prepend("/").prepend(g->name());
-        }
-
-        if (count > 0) {
-            out << QObject::tr("Password for '%1' has been leaked %2 time(s)!", "", count).arg(path).arg(count)
+        if (jsonStream) {
+            auto object = findingObject("leaked", entry);
+            object.insert("count", count);
+            jsonStream->write(object);
+        } else if (count > 0) {
+            out << QObject::tr("Password for '%1' has been leaked %2 time(s)!", "", count)
+                       .arg(entryPath(entry))
+                       .arg(count)
                 << Qt::endl;
         } else {
-            out << QObject::tr("Password for '%1' has been leaked!").arg(path) << Qt::endl;
+            out << QObject::tr("Password for '%1' has been leaked!").arg(entryPath(entry)) << Qt::endl;
+        }
+    }
+
+    const auto results = healthResults.result();
+    for (int i = 0; i < candidates.size(); ++i) {
+        const auto entry = candidates.at(i);
+        const auto quality = results.at(i)->quality();
+        if (quality < PasswordHealth::Quality::Good) {
+            if (jsonStream) {
+                auto object = findingObject("weak", entry);
+                object.insert("quality", qualityName(quality));
+                object.insert("score", results.at(i)->score());
+                jsonStream->write(object);
+            } else {
+                out << QObject::tr("Password for '%1' is %2 (score %3)")
+                           .arg(entryPath(entry), qualityName(quality))
+                           .arg(results.at(i)->score())
+                    << Qt::endl;
+            }
+        }
+
+        const int uses = passwordUses.value(entry->password());
+        if (uses > 1 && !entry->isAttributeReference("Password")) {
+            if (jsonStream) {
+                auto object = findingObject("reused", entry);
+                object.insert("count", uses);
+                jsonStream->write(object);
+            } else {
+                out << QObject::tr("Password for '%1' is used %2 time(s)", "", uses).arg(entryPath(entry)).arg(uses)
+                    << Qt::endl;
+            }
         }
     }
 
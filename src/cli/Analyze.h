@@ -28,6 +28,8 @@ public:
 
     static const QCommandLineOption HIBPDatabaseOption;
     static const QCommandLineOption OkonOption;
+    static const QCommandLineOption HealthOption;
+    static const QCommandLineOption ProgressOption;
 };
 
 #endif // KEEPASSXC_HIBP_H
@@ -30,6 +30,7 @@ const QCommandLineOption AttachmentExport::StdoutOption =
 AttachmentExport::AttachmentExport()
 {
     name = QString("attachment-export");
+    readOnly = true;
     description = QObject::tr("Export an attachment of an entry.");
     options.append(AttachmentExport::StdoutOption);
     positionalArguments.append(
@@ -62,9 +63,20 @@ int AttachmentExport::executeWithDatabase(QSharedPointer<Database> database, QSh
         return EXIT_FAILURE;
     }
 
+    // Deferred attachments are read before anything is written, the database file may have changed since
+    QString error;
+    if (!attachments->loadDeferred(&error)) {
+        err << error << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
     if (parser->isSet(AttachmentExport::StdoutOption)) {
-        // Output to STDOUT even in quiet mode
-        Utils::STDOUT << attachments->value(attachmentName) << Qt::flush;
+        // Output to STDOUT even in quiet mode, the data is written as is
+        Utils::STDOUT.flush();
+        if (!attachments->writeTo(attachmentName, Utils::STDOUT.device())) {
+            err << QObject::tr("Could not write attachment %1.").arg(attachmentName) << Qt::endl;
+            return EXIT_FAILURE;
+        }
         return EXIT_SUCCESS;
     }
 
@@ -79,7 +91,10 @@ int AttachmentExport::executeWithDatabase(QSharedPointer<Database> database, QSh
         err << QObject::tr("Could not open output file %1.").arg(exportFileName) << Qt::endl;
         return EXIT_FAILURE;
     }
-    exportFile.write(attachments->value(attachmentName));
+    if (!attachments->writeTo(attachmentName, &exportFile, &error)) {
+        err << QObject::tr("Could not write output file %1: %2").arg(exportFileName, error) << Qt::endl;
+        return EXIT_FAILURE;
+    }
 
     out << QObject::tr("Successfully exported attachment %1 of entry %2 to %3.")
                .arg(attachmentName, entryPath, exportFileName)
@@ -70,11 +70,16 @@ int AttachmentImport::executeWithDatabase(QSharedPointer<Database> database, QSh
     }
 
     entry->beginUpdate();
-    attachments->set(attachmentName, importFile.readAll());
+    const bool readOk = attachments->readFrom(attachmentName, &importFile);
     entry->endUpdate();
+    if (!readOk) {
+        err << QObject::tr("Could not read attachment file %1: %2").arg(importFileName, importFile.errorString())
+            << Qt::endl;
+        return EXIT_FAILURE;
+    }
 
     QString errorMessage;
-    if (!database->save(Database::Atomic, {}, &errorMessage)) {
+    if (!saveDatabase(database, &errorMessage)) {
         err << QObject::tr("Writing the database failed %1.").arg(errorMessage) << Qt::endl;
         return EXIT_FAILURE;
     }
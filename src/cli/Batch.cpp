@@ -0,0 +1,196 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Batch.h"
+
+#include "TextStream.h"
+#include "Utils.h"
+#include "core/Global.h"
+
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+const QCommandLineOption Batch::SaveEveryOption =
+    QCommandLineOption(QStringList() << "save-every",
+                       QObject::tr("Save the database after this number of modifying commands, "
+                                   "by default it is only saved after the last command."),
+                       QObject::tr("count"),
+                       QString("0"));
+
+const QCommandLineOption Batch::StopOnErrorOption =
+    QCommandLineOption(QStringList() << "stop-on-error",
+                       QObject::tr("Stop at the first failing command, the changes of the commands before "
+                                   "it are still saved."));
+
+namespace
+{
+    /**
+     * Parse a line of the batch input, either a command line or a JSON array of arguments.
+     *
+     * @param line trimmed input line
+     * @param json set to true if the line is a JSON array
+     * @param error set if the line is not valid
+     * @return arguments starting with the command name
+     */
+    QStringList parseLine(const QString& line, bool& json, QString& error)
+    {
+        json = line.startsWith('[');
+        if (!json) {
+            return Utils::splitCommandString(line);
+        }
+
+        QJsonParseError parseError;
+        const auto document = QJsonDocument::fromJson(line.toUtf8(), &parseError);
+        if (parseError.error != QJsonParseError::NoError || !document.isArray()) {
+            error = QObject::tr("Invalid JSON: %1").arg(parseError.errorString());
+            return {};
+        }
+
+        QStringList args;
+        for (const auto& value : document.array()) {
+            if (!value.isString()) {
+                error = QObject::tr("Command arguments have to be strings.");
+                return {};
+            }
+            args << value.toString();
+        }
+        return args;
+    }
+} // namespace
+
+Batch::Batch()
+{
+    name = QString("batch");
+    description = QObject::tr("Run a list of commands against a database and save it once.");
+    options.append(Batch::SaveEveryOption);
+    options.append(Batch::StopOnErrorOption);
+    optionalArguments.append(
+        {QString("commands"), QObject::tr("File with one command per line, read from stdin if omitted."), ""});
+}
+
+int Batch::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
+{
+    auto& out = Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    bool ok = false;
+    const int saveEvery = parser->value(Batch::SaveEveryOption).toInt(&ok);
+    if (!ok || saveEvery < 0) {
+        err << QObject::tr("Invalid value for the number of commands between saves.") << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    QFile file;
+    TextStream fileStream;
+    QTextStream* in = &Utils::STDIN;
+    const QStringList args = parser->positionalArguments();
+    if (args.size() > 1 && args.at(1) != "-") {
+        file.setFileName(args.at(1));
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << QObject::tr("Failed to open command file %1: %2").arg(args.at(1), file.errorString()) << Qt::endl;
+            return EXIT_FAILURE;
+        }
+        fileStream.setDevice(&file);
+        in = &fileStream;
+    }
+
+    auto save = [&]() {
+        QString errorMessage;
+        if (!database->save(Database::Atomic, {}, &errorMessage)) {
+            err << QObject::tr("Writing the database failed: %1").arg(errorMessage) << Qt::endl;
+            return false;
+        }
+        return true;
+    };
+
+    int failed = 0;
+    int unsaved = 0;
+    int lineNumber = 0;
+    forever {
+        QString line = in->readLine();
+        if (line.isNull()) {
+            break;
+        }
+        line = line.trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        bool json = false;
+        QString error;
+        QStringList commandArgs = parseLine(line, json, error);
+        QString commandName = commandArgs.value(0);
+
+        auto command = Commands::getCommand(commandName);
+        if (error.isEmpty() && !command) {
+            error = QObject::tr("Unknown command %1").arg(commandName);
+        } else if (command && (command->name == name || command->name == "open" || command->name == "close")) {
+            error = QObject::tr("Command %1 can not be used in a batch.").arg(commandName);
+        }
+
+        int result = EXIT_FAILURE;
+        const auto revision = database->dataRevision();
+        if (error.isEmpty()) {
+            command->currentDatabase = database;
+            command->saveDeferred = true;
+            result = command->execute(commandArgs);
+            command->saveDeferred = false;
+            command->currentDatabase.reset();
+        } else {
+            err << error << Qt::endl;
+        }
+
+        // Status of every command in the format of its input line
+        if (json) {
+            QJsonObject status;
+            status.insert("line", lineNumber);
+            status.insert("command", commandName);
+            status.insert("status", result == EXIT_SUCCESS ? "ok" : "error");
+            if (!error.isEmpty()) {
+                status.insert("error", error);
+            }
+            out << QJsonDocument(status).toJson(QJsonDocument::Compact) << Qt::endl;
+        } else {
+            out << QString("%1\t%2\t%3").arg(lineNumber).arg(result == EXIT_SUCCESS ? "ok" : "error", commandName)
+                << Qt::endl;
+        }
+
+        if (result != EXIT_SUCCESS) {
+            ++failed;
+            if (parser->isSet(Batch::StopOnErrorOption)) {
+                break;
+            }
+            continue;
+        }
+
+        if (database->dataRevision() != revision && ++unsaved == saveEvery) {
+            if (!save()) {
+                return EXIT_FAILURE;
+            }
+            unsaved = 0;
+        }
+    }
+
+    if (database->isModified() && !save()) {
+        return EXIT_FAILURE;
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -44,6 +44,7 @@ const QCommandLineOption Clip::BestMatchOption =
 Clip::Clip()
 {
     name = QString("clip");
+    readOnly = true;
     description = QObject::tr("Copy an entry's attribute to the clipboard.");
     options.append(Clip::AttributeOption);
     options.append(Clip::TotpOption);
@@ -21,18 +21,22 @@
 #include "AttachmentExport.h"
 #include "AttachmentImport.h"
 #include "AttachmentRemove.h"
+#include "Batch.h"
 #include "Clip.h"
 #include "Close.h"
 #include "DatabaseCreate.h"
+#include "DatabaseGenerate.h"
 #include "DatabaseEdit.h"
 #include "DatabaseInfo.h"
 #include "Diceware.h"
+#include "Diff.h"
 #include "Edit.h"
 #include "Estimate.h"
 #include "Exit.h"
 #include "Export.h"
 #include "Generate.h"
 #include "Help.h"
+#include "HibpConvert.h"
 #include "Import.h"
 #include "List.h"
 #include "Merge.h"
@@ -40,6 +44,7 @@
 #include "Open.h"
 #include "Remove.h"
 #include "RemoveGroup.h"
+#include "Serve.h"
 #include "Search.h"
 #include "Show.h"
 #include "Utils.h"
@@ -71,6 +76,19 @@ const QCommandLineOption Command::YubiKeyOption =
                        QObject::tr("Yubikey slot and optional serial used to access the database (e.g., 1:7370001)."),
                        QObject::tr("slot[:serial]"));
 
+const QCommandLineOption Command::OutputFormatOption =
+    QCommandLineOption(QStringList() << "format",
+                       QObject::tr("Output format, 'text', 'json' for a JSON array or 'jsonl' for one JSON object per "
+                                   "line. Defaults to 'text'."),
+                       QStringLiteral("text|json|jsonl"),
+                       QStringLiteral("text"));
+
+const QCommandLineOption Command::FieldsOption =
+    QCommandLineOption(QStringList() << "fields",
+                       QObject::tr("Comma separated entry fields of the JSON output. Defaults to "
+                                   "'uuid,path,title,username,url,tags'."),
+                       QObject::tr("fields"));
+
 namespace
 {
 
@@ -141,7 +159,8 @@ QSharedPointer<QCommandLineParser> Command::getCommandLineParser(const QStringLi
         err << getHelpText();
         return {};
     }
-    if (parser->positionalArguments().size() > (positionalArguments.size() + optionalArguments.size())) {
+    if (!repeatOptionalArguments
+        && parser->positionalArguments().size() > (positionalArguments.size() + optionalArguments.size())) {
         err << QObject::tr("Too many arguments provided.") << "\n\n";
         err << getHelpText();
         return {};
@@ -170,12 +189,15 @@ namespace Commands
         s_commands.insert(QStringLiteral("close"), QSharedPointer<Command>(new Close()));
         s_commands.insert(QStringLiteral("db-create"), QSharedPointer<Command>(new DatabaseCreate()));
         s_commands.insert(QStringLiteral("db-edit"), QSharedPointer<Command>(new DatabaseEdit()));
+        s_commands.insert(QStringLiteral("db-generate"), QSharedPointer<Command>(new DatabaseGenerate()));
         s_commands.insert(QStringLiteral("db-info"), QSharedPointer<Command>(new DatabaseInfo()));
         s_commands.insert(QStringLiteral("diceware"), QSharedPointer<Command>(new Diceware()));
+        s_commands.insert(QStringLiteral("diff"), QSharedPointer<Command>(new Diff()));
         s_commands.insert(QStringLiteral("edit"), QSharedPointer<Command>(new Edit()));
         s_commands.insert(QStringLiteral("estimate"), QSharedPointer<Command>(new Estimate()));
         s_commands.insert(QStringLiteral("generate"), QSharedPointer<Command>(new Generate()));
         s_commands.insert(QStringLiteral("help"), QSharedPointer<Command>(new Help()));
+        s_commands.insert(QStringLiteral("hibp-convert"), QSharedPointer<Command>(new HibpConvert()));
         s_commands.insert(QStringLiteral("ls"), QSharedPointer<Command>(new List()));
         s_commands.insert(QStringLiteral("merge"), QSharedPointer<Command>(new Merge()));
         s_commands.insert(QStringLiteral("mkdir"), QSharedPointer<Command>(new AddGroup()));
@@ -190,8 +212,10 @@ namespace Commands
             s_commands.insert(QStringLiteral("exit"), QSharedPointer<Command>(new Exit("exit")));
             s_commands.insert(QStringLiteral("quit"), QSharedPointer<Command>(new Exit("quit")));
         } else {
+            s_commands.insert(QStringLiteral("batch"), QSharedPointer<Command>(new Batch()));
             s_commands.insert(QStringLiteral("export"), QSharedPointer<Command>(new Export()));
             s_commands.insert(QStringLiteral("import"), QSharedPointer<Command>(new Import()));
+            s_commands.insert(QStringLiteral("serve"), QSharedPointer<Command>(new Serve()));
         }
     }
 
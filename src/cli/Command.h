@@ -42,8 +42,12 @@ public:
     QString name;
     QString description;
     QSharedPointer<Database> currentDatabase;
+    // Leave saving the modified current database to the caller, see Batch
+    bool saveDeferred = false;
     QList<CommandLineArgument> positionalArguments;
     QList<CommandLineArgument> optionalArguments;
+    // Accept any number of arguments after the positional ones, see Merge
+    bool repeatOptionalArguments = false;
     QList<QCommandLineOption> options;
 
     QString getDescriptionLine();
@@ -55,6 +59,8 @@ public:
     static const QCommandLineOption KeyFileOption;
     static const QCommandLineOption NoPasswordOption;
     static const QCommandLineOption YubiKeyOption;
+    static const QCommandLineOption OutputFormatOption;
+    static const QCommandLineOption FieldsOption;
 };
 
 namespace Commands
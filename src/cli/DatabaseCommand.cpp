@@ -60,7 +60,8 @@ int DatabaseCommand::execute(const QStringList& arguments)
 #else
                                    "",
 #endif
-                                   parser->isSet(Command::QuietOption));
+                                   parser->isSet(Command::QuietOption),
+                                   readOnly);
         if (!db) {
             return EXIT_FAILURE;
         }
@@ -68,3 +69,18 @@ int DatabaseCommand::execute(const QStringList& arguments)
 
     return executeWithDatabase(db, parser);
 }
+
+/**
+ * Save a database modified by the command.
+ *
+ * @param database modified database
+ * @param error error message if saving failed
+ * @return true if the database was saved, or saving is deferred to the caller
+ */
+bool DatabaseCommand::saveDatabase(QSharedPointer<Database> database, QString* error) const
+{
+    if (saveDeferred) {
+        return true;
+    }
+    return database->save(Database::Atomic, {}, error);
+}
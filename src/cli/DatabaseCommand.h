@@ -26,6 +26,12 @@ public:
     DatabaseCommand();
     int execute(const QStringList& arguments) override;
     virtual int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) = 0;
+
+protected:
+    bool saveDatabase(QSharedPointer<Database> database, QString* error) const;
+
+    // Commands that only look up entries open the database without its history
+    bool readOnly = false;
 };
 
 #endif // KEEPASSXC_DATABASECOMMAND_H
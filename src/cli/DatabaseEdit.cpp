@@ -90,7 +90,7 @@ int DatabaseEdit::executeWithDatabase(QSharedPointer<Database> database, QShared
     }
 
     QString errorMessage;
-    if (!database->save(Database::Atomic, {}, &errorMessage)) {
+    if (!saveDatabase(database, &errorMessage)) {
         err << QObject::tr("Writing the database failed: %1").arg(errorMessage) << Qt::endl;
         return EXIT_FAILURE;
     }
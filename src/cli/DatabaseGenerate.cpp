@@ -0,0 +1,178 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseGenerate.h"
+
+#include "DatabaseCreate.h"
+#include "Utils.h"
+#include "core/Global.h"
+#include "core/SyntheticDatabase.h"
+
+#include <QCommandLineParser>
+#include <QFileInfo>
+
+#include <limits>
+
+const QCommandLineOption DatabaseGenerate::EntriesOption =
+    QCommandLineOption(QStringList() << "entries",
+                       QObject::tr("Number of entries, 1000 by default."),
+                       QObject::tr("count", "CLI parameter"));
+
+const QCommandLineOption DatabaseGenerate::GroupsOption =
+    QCommandLineOption(QStringList() << "groups",
+                       QObject::tr("Number of groups, 10 by default."),
+                       QObject::tr("count", "CLI parameter"));
+
+const QCommandLineOption DatabaseGenerate::DepthOption =
+    QCommandLineOption(QStringList() << "depth",
+                       QObject::tr("Number of group levels below the root group, 1 by default."),
+                       QObject::tr("count", "CLI parameter"));
+
+const QCommandLineOption DatabaseGenerate::HistoryOption =
+    QCommandLineOption(QStringList() << "history",
+                       QObject::tr("Number of history items of each entry."),
+                       QObject::tr("count", "CLI parameter"));
+
+const QCommandLineOption DatabaseGenerate::AttachmentsOption =
+    QCommandLineOption(QStringList() << "attachments",
+                       QObject::tr("Percentage of entries with an attachment."),
+                       QObject::tr("percent"));
+
+const QCommandLineOption DatabaseGenerate::AttachmentSizeOption =
+    QCommandLineOption(QStringList() << "attachment-size",
+                       QObject::tr("Largest attachment size in KiB, sizes are spread from 1 KiB up to it."),
+                       QObject::tr("size"));
+
+const QCommandLineOption DatabaseGenerate::ReferencesOption =
+    QCommandLineOption(QStringList() << "references",
+                       QObject::tr("Percentage of entries whose username references another entry."),
+                       QObject::tr("percent"));
+
+const QCommandLineOption DatabaseGenerate::TotpOption =
+    QCommandLineOption(QStringList() << "totp",
+                       QObject::tr("Percentage of entries with TOTP settings."),
+                       QObject::tr("percent"));
+
+const QCommandLineOption DatabaseGenerate::PasskeysOption =
+    QCommandLineOption(QStringList() << "passkeys",
+                       QObject::tr("Percentage of entries with a passkey."),
+                       QObject::tr("percent"));
+
+const QCommandLineOption DatabaseGenerate::IconsOption =
+    QCommandLineOption(QStringList() << "icons",
+                       QObject::tr("Number of custom icons."),
+                       QObject::tr("count", "CLI parameter"));
+
+const QCommandLineOption DatabaseGenerate::SeedOption =
+    QCommandLineOption(QStringList() << "seed",
+                       QObject::tr("Seed of the generator, the same seed and options give the same database."),
+                       QObject::tr("seed"));
+
+DatabaseGenerate::DatabaseGenerate()
+{
+    name = QString("db-generate");
+    description = QObject::tr("Create a new database with generated contents for testing.");
+    positionalArguments.append({QString("database"), QObject::tr("Path of the database."), QString("")});
+    options.append(DatabaseCreate::SetKeyFileOption);
+    options.append(DatabaseCreate::SetKeyFileShortOption);
+    options.append(DatabaseCreate::SetPasswordOption);
+    options.append(DatabaseCreate::DecryptionTimeOption);
+    options.append(DatabaseGenerate::EntriesOption);
+    options.append(DatabaseGenerate::GroupsOption);
+    options.append(DatabaseGenerate::DepthOption);
+    options.append(DatabaseGenerate::HistoryOption);
+    options.append(DatabaseGenerate::AttachmentsOption);
+    options.append(DatabaseGenerate::AttachmentSizeOption);
+    options.append(DatabaseGenerate::ReferencesOption);
+    options.append(DatabaseGenerate::TotpOption);
+    options.append(DatabaseGenerate::PasskeysOption);
+    options.append(DatabaseGenerate::IconsOption);
+    options.append(DatabaseGenerate::SeedOption);
+}
+
+/**
+ * Create a database file filled by SyntheticDatabase. The database is
+ * encrypted with a password and/or key file as with db-create.
+ *
+ * @return EXIT_SUCCESS on success, or EXIT_FAILURE on failure
+ */
+int DatabaseGenerate::execute(const QStringList& arguments)
+{
+    QSharedPointer<QCommandLineParser> parser = getCommandLineParser(arguments);
+    if (parser.isNull()) {
+        return EXIT_FAILURE;
+    }
+
+    auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    const QStringList args = parser->positionalArguments();
+    const QString& databaseFilename = args.at(0);
+    if (QFileInfo::exists(databaseFilename)) {
+        err << QObject::tr("File %1 already exists.").arg(databaseFilename) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Validate all numbers before asking for a password
+    bool valid = true;
+    auto readNumber = [&](const QCommandLineOption& option, int defaultValue, int maximum) {
+        if (!parser->isSet(option)) {
+            return defaultValue;
+        }
+        bool ok = false;
+        const auto value = parser->value(option).toInt(&ok);
+        if (!ok || value < 0 || value > maximum) {
+            err << QObject::tr("Invalid value %1 for --%2.").arg(parser->value(option), option.names().first())
+                << Qt::endl;
+            valid = false;
+        }
+        return value;
+    };
+
+    SyntheticDatabase::Options options;
+    options.entries = readNumber(EntriesOption, options.entries, 10000000);
+    options.groups = readNumber(GroupsOption, options.groups, 1000000);
+    options.depth = readNumber(DepthOption, options.depth, 1000);
+    options.historyItems = readNumber(HistoryOption, options.historyItems, 1000);
+    options.attachmentPercent = readNumber(AttachmentsOption, options.attachmentPercent, 100);
+    options.maxAttachmentSize =
+        readNumber(AttachmentSizeOption, options.maxAttachmentSize / 1024, 1024 * 1024) * 1024;
+    options.referencePercent = readNumber(ReferencesOption, options.referencePercent, 100);
+    options.totpPercent = readNumber(TotpOption, options.totpPercent, 100);
+    options.passkeyPercent = readNumber(PasskeysOption, options.passkeyPercent, 100);
+    options.customIcons = readNumber(IconsOption, options.customIcons, 100000);
+    options.seed = static_cast<quint32>(readNumber(SeedOption, 0, std::numeric_limits<int>::max()));
+    if (!valid) {
+        return EXIT_FAILURE;
+    }
+
+    QSharedPointer<Database> db = DatabaseCreate::initializeDatabaseFromOptions(parser);
+    if (!db) {
+        return EXIT_FAILURE;
+    }
+
+    SyntheticDatabase(options).populate(db.data());
+
+    QString errorMessage;
+    if (!db->saveAs(databaseFilename, Database::Atomic, {}, &errorMessage)) {
+        err << QObject::tr("Failed to save the database: %1.").arg(errorMessage) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Successfully generated new database with %n entries.", "", options.entries) << Qt::endl;
+    return EXIT_SUCCESS;
+}
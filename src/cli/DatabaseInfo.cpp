@@ -69,6 +69,10 @@ int DatabaseInfo::executeWithDatabase(QSharedPointer<Database> database, QShared
     out << QObject::tr("Entries excluded from reports") << ": " << QString::number(stats.excludedEntries) << Qt::endl;
     out << QObject::tr("Average password length") << ": " << QObject::tr("%1 characters").arg(stats.averagePwdLength())
         << Qt::endl;
+    out << QObject::tr("Estimated memory usage") << ":" << Qt::endl;
+    for (const auto& line : stats.memoryUsage.toStringList()) {
+        out << "  " << line << Qt::endl;
+    }
 
     return EXIT_SUCCESS;
 }
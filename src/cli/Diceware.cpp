@@ -17,6 +17,7 @@
 
 #include "Diceware.h"
 
+#include "Generate.h"
 #include "Utils.h"
 #include "core/Global.h"
 #include "core/PassphraseGenerator.h"
@@ -39,6 +40,7 @@ Diceware::Diceware()
     description = QObject::tr("Generate a new random diceware passphrase.");
     options.append(Diceware::WordCountOption);
     options.append(Diceware::WordListOption);
+    options.append(Generate::CountOption);
 }
 
 int Diceware::execute(const QStringList& arguments)
@@ -75,8 +77,15 @@ int Diceware::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
-    QString password = dicewareGenerator.generatePassphrase();
-    out << password << Qt::endl;
+    const int count = Generate::parseCount(parser);
+    if (count <= 0) {
+        return EXIT_FAILURE;
+    }
+
+    for (const auto& passphrase : dicewareGenerator.generatePassphrases(count)) {
+        out << passphrase << '\n';
+    }
+    out.flush();
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Diff.h"
+
+#include "Utils.h"
+#include "core/DatabaseDiff.h"
+#include "core/Group.h"
+
+#include <QCommandLineParser>
+
+const QCommandLineOption Diff::SameCredentialsOption =
+    QCommandLineOption(QStringList() << "s" << "same-credentials",
+                       QObject::tr("Use the same credentials for both database files."));
+
+const QCommandLineOption Diff::KeyFileFromOption =
+    QCommandLineOption(QStringList() << "key-file-from",
+                       QObject::tr("Key file of the database to compare with."),
+                       QObject::tr("path"));
+
+const QCommandLineOption Diff::NoPasswordFromOption =
+    QCommandLineOption(QStringList() << "no-password-from",
+                       QObject::tr("Deactivate password key for the database to compare with."));
+
+const QCommandLineOption Diff::YubiKeyFromOption(QStringList() << "yubikey-from",
+                                                 QObject::tr("Yubikey slot for the second database."),
+                                                 QObject::tr("slot"));
+
+Diff::Diff()
+{
+    name = QString("diff");
+    description = QObject::tr("Show the entries added, removed or modified between two databases.");
+    options.append(Diff::SameCredentialsOption);
+    options.append(Diff::KeyFileFromOption);
+    options.append(Diff::NoPasswordFromOption);
+#ifdef WITH_XC_YUBIKEY
+    options.append(Diff::YubiKeyFromOption);
+#endif
+    positionalArguments.append(
+        {QString("database2"), QObject::tr("Path of the database to compare with."), QString("")});
+}
+
+int Diff::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
+{
+    auto& out = Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    const QStringList args = parser->positionalArguments();
+    auto& otherDatabasePath = args.at(1);
+
+    QSharedPointer<Database> db2;
+    if (!parser->isSet(Diff::SameCredentialsOption)) {
+        db2 = Utils::unlockDatabase(otherDatabasePath,
+                                    !parser->isSet(Diff::NoPasswordFromOption),
+                                    parser->value(Diff::KeyFileFromOption),
+                                    parser->value(Diff::YubiKeyFromOption),
+                                    parser->isSet(Command::QuietOption),
+                                    true);
+        if (!db2) {
+            return EXIT_FAILURE;
+        }
+    } else {
+        db2 = QSharedPointer<Database>::create();
+        QString errorMessage;
+        if (!db2->open(otherDatabasePath, database->key(), &errorMessage, Database::ReadOnly)) {
+            err << QObject::tr("Error reading database file:\n%1").arg(errorMessage) << Qt::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto changes = DatabaseDiff::compare(database->rootGroup(), db2->rootGroup());
+    for (const auto& change : changes) {
+        const auto path = change.entry->path();
+        const auto uuid = change.entry->uuidToHex();
+        switch (change.type) {
+        case DatabaseDiff::ChangeType::Added:
+            out << QObject::tr("Added %1 [%2]").arg(path, uuid) << Qt::endl;
+            break;
+        case DatabaseDiff::ChangeType::Removed:
+            out << QObject::tr("Removed %1 [%2]").arg(path, uuid) << Qt::endl;
+            break;
+        case DatabaseDiff::ChangeType::Modified:
+            out << QObject::tr("Modified %1 [%2]").arg(path, uuid) << Qt::endl;
+            break;
+        }
+    }
+
+    if (changes.isEmpty() && !parser->isSet(Command::QuietOption)) {
+        out << QObject::tr("The databases contain the same entries.") << Qt::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -17,132 +17,205 @@
 
 #include "Estimate.h"
 
+#include "JsonStream.h"
 #include "Utils.h"
 #include "core/Global.h"
 #include "core/PasswordHealth.h"
 
 #include <QCommandLineParser>
+#include <QJsonArray>
+#include <QtConcurrent>
 #include <zxcvbn.h>
 
 const QCommandLineOption Estimate::AdvancedOption =
     QCommandLineOption(QStringList() << "a" << "advanced", QObject::tr("Perform advanced analysis on the password."));
 
-Estimate::Estimate()
-{
-    name = QString("estimate");
-    optionalArguments.append(
-        {QString("password"), QObject::tr("Password for which to estimate the entropy."), QString("[password]")});
-    options.append(Estimate::AdvancedOption);
-    description = QObject::tr("Estimate the entropy of a password.");
-}
+const QCommandLineOption Estimate::BatchOption =
+    QCommandLineOption(QStringList() << "batch",
+                       QObject::tr("Estimate every line read from STDIN as a password, the results are printed in "
+                                   "the order of the lines."));
 
-static void estimate(const char* pwd, bool advanced)
+namespace
 {
-    auto& out = Utils::STDOUT;
+    // Lines of a batch that are estimated in parallel before their results are printed
+    const int BatchChunkSize = 1024;
 
-    auto len = static_cast<int>(strlen(pwd));
-    if (!advanced) {
-        const auto e = PasswordHealth(pwd).entropy();
-        // clang-format off
-        out << QObject::tr("Length %1").arg(len, 0) << '\t'
-            << QObject::tr("Entropy %1").arg(e, 0, 'f', 3) << '\t'
-            << QObject::tr("Log10 %1").arg(e * 0.301029996, 0, 'f', 3) << Qt::endl;
-        // clang-format on
-    } else {
-        int pwdLen = 0;
-        ZxcMatch_t *info, *p;
-        double m = 0.0;
-        const auto e = ZxcvbnMatch(pwd, nullptr, &info);
-        for (p = info; p; p = p->Next) {
-            m += p->Entrpy;
+    struct Match
+    {
+        int type;
+        int length;
+        double entropy;
+        QByteArray token;
+    };
+
+    struct Estimation
+    {
+        QByteArray password;
+        double entropy = 0.0;
+        // Entropy of the whole password beyond the sum of its matches
+        double extraBits = 0.0;
+        QVector<Match> matches;
+    };
+
+    Estimation evaluate(const QString& password, bool advanced)
+    {
+        Estimation estimation;
+        estimation.password = password.toUtf8();
+        if (!advanced) {
+            estimation.entropy = PasswordHealth(password).entropy();
+            return estimation;
         }
-        m = e - m;
+
+        ZxcMatch_t* info;
+        estimation.entropy = ZxcvbnMatch(estimation.password.constData(), nullptr, &info);
+        estimation.extraBits = estimation.entropy;
+        int offset = 0;
+        for (auto p = info; p; p = p->Next) {
+            estimation.extraBits -= p->Entrpy;
+            estimation.matches.append(
+                {static_cast<int>(p->Type), p->Length, p->Entrpy, estimation.password.mid(offset, p->Length)});
+            offset += p->Length;
+        }
+        ZxcvbnFreeInfo(info);
+        return estimation;
+    }
+
+    QString matchTypeText(int type)
+    {
+        switch (type) {
+        case BRUTE_MATCH:
+            return QObject::tr("Type: Bruteforce") + "       ";
+        case DICTIONARY_MATCH:
+            return QObject::tr("Type: Dictionary") + "       ";
+        case DICT_LEET_MATCH:
+            return QObject::tr("Type: Dict+Leet") + "        ";
+        case USER_MATCH:
+            return QObject::tr("Type: User Words") + "       ";
+        case USER_LEET_MATCH:
+            return QObject::tr("Type: User+Leet") + "        ";
+        case REPEATS_MATCH:
+            return QObject::tr("Type: Repeated") + "         ";
+        case SEQUENCE_MATCH:
+            return QObject::tr("Type: Sequence") + "         ";
+        case SPATIAL_MATCH:
+            return QObject::tr("Type: Spatial") + "          ";
+        case DATE_MATCH:
+            return QObject::tr("Type: Date") + "             ";
+        case BRUTE_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: Bruteforce(Rep)") + "  ";
+        case DICTIONARY_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: Dictionary(Rep)") + "  ";
+        case DICT_LEET_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: Dict+Leet(Rep)") + "   ";
+        case USER_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: User Words(Rep)") + "  ";
+        case USER_LEET_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: User+Leet(Rep)") + "   ";
+        case REPEATS_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: Repeated(Rep)") + "    ";
+        case SEQUENCE_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: Sequence(Rep)") + "    ";
+        case SPATIAL_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: Spatial(Rep)") + "     ";
+        case DATE_MATCH + MULTIPLE_MATCH:
+            return QObject::tr("Type: Date(Rep)") + "        ";
+        default:
+            return QObject::tr("Type: Unknown (%1)").arg(type) + "        ";
+        }
+    }
+
+    QString matchTypeName(int type)
+    {
+        switch (type & ~MULTIPLE_MATCH) {
+        case BRUTE_MATCH:
+            return QStringLiteral("bruteforce");
+        case DICTIONARY_MATCH:
+            return QStringLiteral("dictionary");
+        case DICT_LEET_MATCH:
+            return QStringLiteral("dictionary_leet");
+        case USER_MATCH:
+            return QStringLiteral("user_words");
+        case USER_LEET_MATCH:
+            return QStringLiteral("user_words_leet");
+        case REPEATS_MATCH:
+            return QStringLiteral("repeated");
+        case SEQUENCE_MATCH:
+            return QStringLiteral("sequence");
+        case SPATIAL_MATCH:
+            return QStringLiteral("spatial");
+        case DATE_MATCH:
+            return QStringLiteral("date");
+        default:
+            return QStringLiteral("unknown");
+        }
+    }
+
+    void printText(QTextStream& out, const Estimation& estimation, bool advanced)
+    {
+        const auto len = estimation.password.size();
+        const auto e = estimation.entropy;
+        if (!advanced) {
+            // clang-format off
+            out << QObject::tr("Length %1").arg(len, 0) << '\t'
+                << QObject::tr("Entropy %1").arg(e, 0, 'f', 3) << '\t'
+                << QObject::tr("Log10 %1").arg(e * 0.301029996, 0, 'f', 3) << Qt::endl;
+            // clang-format on
+            return;
+        }
+
         // clang-format off
         out << QObject::tr("Length %1").arg(len) << '\t'
             << QObject::tr("Entropy %1").arg(e, 0, 'f', 3) << '\t'
             << QObject::tr("Log10 %1").arg(e * 0.301029996, 0, 'f', 3) << "\n  "
-            << QObject::tr("Multi-word extra bits %1").arg(m, 0, 'f', 1) << Qt::endl;
+            << QObject::tr("Multi-word extra bits %1").arg(estimation.extraBits, 0, 'f', 1) << Qt::endl;
         // clang-format on
-        p = info;
-        pwdLen = 0;
-        while (p) {
-            int n;
-            switch (static_cast<int>(p->Type)) {
-            case BRUTE_MATCH:
-                out << "  " << QObject::tr("Type: Bruteforce") << "       ";
-                break;
-            case DICTIONARY_MATCH:
-                out << "  " << QObject::tr("Type: Dictionary") << "       ";
-                break;
-            case DICT_LEET_MATCH:
-                out << "  " << QObject::tr("Type: Dict+Leet") << "        ";
-                break;
-            case USER_MATCH:
-                out << "  " << QObject::tr("Type: User Words") << "       ";
-                break;
-            case USER_LEET_MATCH:
-                out << "  " << QObject::tr("Type: User+Leet") << "        ";
-                break;
-            case REPEATS_MATCH:
-                out << "  " << QObject::tr("Type: Repeated") << "         ";
-                break;
-            case SEQUENCE_MATCH:
-                out << "  " << QObject::tr("Type: Sequence") << "         ";
-                break;
-            case SPATIAL_MATCH:
-                out << "  " << QObject::tr("Type: Spatial") << "          ";
-                break;
-            case DATE_MATCH:
-                out << "  " << QObject::tr("Type: Date") << "             ";
-                break;
-            case BRUTE_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: Bruteforce(Rep)") << "  ";
-                break;
-            case DICTIONARY_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: Dictionary(Rep)") << "  ";
-                break;
-            case DICT_LEET_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: Dict+Leet(Rep)") << "   ";
-                break;
-            case USER_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: User Words(Rep)") << "  ";
-                break;
-            case USER_LEET_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: User+Leet(Rep)") << "   ";
-                break;
-            case REPEATS_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: Repeated(Rep)") << "    ";
-                break;
-            case SEQUENCE_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: Sequence(Rep)") << "    ";
-                break;
-            case SPATIAL_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: Spatial(Rep)") << "     ";
-                break;
-            case DATE_MATCH + MULTIPLE_MATCH:
-                out << "  " << QObject::tr("Type: Date(Rep)") << "        ";
-                break;
-
-            default:
-                out << "  " << QObject::tr("Type: Unknown (%1)").arg(p->Type) << "        ";
-                break;
-            }
-            pwdLen += p->Length;
-            out << QObject::tr("Length %1").arg(p->Length) << '\t'
-                << QObject::tr("Entropy %1 (%2)").arg(p->Entrpy, 6, 'f', 3).arg(p->Entrpy * 0.301029996, 0, 'f', 2)
-                << '\t';
-            for (n = 0; n < p->Length; ++n, ++pwd) {
-                out << *pwd;
-            }
-            out << Qt::endl;
-            p = p->Next;
+        int pwdLen = 0;
+        for (const auto& match : estimation.matches) {
+            pwdLen += match.length;
+            const auto log10 = match.entropy * 0.301029996;
+            out << "  " << matchTypeText(match.type) << QObject::tr("Length %1").arg(match.length) << '\t'
+                << QObject::tr("Entropy %1 (%2)").arg(match.entropy, 6, 'f', 3).arg(log10, 0, 'f', 2) << '\t'
+                << match.token << Qt::endl;
         }
-        ZxcvbnFreeInfo(info);
         if (pwdLen != len) {
             out << QObject::tr("*** Password length (%1) != sum of length of parts (%2) ***").arg(len).arg(pwdLen)
                 << Qt::endl;
         }
     }
+
+    QJsonObject estimationObject(const Estimation& estimation, bool advanced)
+    {
+        QJsonObject object;
+        object.insert("length", QString::fromUtf8(estimation.password).length());
+        object.insert("entropy", estimation.entropy);
+        object.insert("log10", estimation.entropy * 0.301029996);
+        object.insert("score", PasswordHealth(estimation.entropy).score());
+        if (advanced) {
+            object.insert("extra_bits", estimation.extraBits);
+            QJsonArray matches;
+            for (const auto& match : estimation.matches) {
+                QJsonObject matchObject;
+                matchObject.insert("type", matchTypeName(match.type));
+                matchObject.insert("repeated", (match.type & MULTIPLE_MATCH) != 0);
+                matchObject.insert("entropy", match.entropy);
+                matchObject.insert("token", QString::fromUtf8(match.token));
+                matches.append(matchObject);
+            }
+            object.insert("matches", matches);
+        }
+        return object;
+    }
+} // namespace
+
+Estimate::Estimate()
+{
+    name = QString("estimate");
+    optionalArguments.append(
+        {QString("password"), QObject::tr("Password for which to estimate the entropy."), QString("[password]")});
+    options.append(Estimate::AdvancedOption);
+    options.append(Estimate::BatchOption);
+    options.append(Command::OutputFormatOption);
+    description = QObject::tr("Estimate the entropy of a password.");
 }
 
 int Estimate::execute(const QStringList& arguments)
@@ -153,15 +226,58 @@ int Estimate::execute(const QStringList& arguments)
     }
 
     auto& in = Utils::STDIN;
+    auto& out = Utils::STDOUT;
+    auto& err = Utils::STDERR;
     const QStringList args = parser->positionalArguments();
 
-    QString password;
-    if (args.size() == 1) {
-        password = args.at(0);
-    } else {
-        password = in.readLine();
+    JsonStream::Format jsonFormat;
+    const QString format = parser->value(Command::OutputFormatOption);
+    const bool json = JsonStream::parseFormat(format, jsonFormat);
+    if (!json && format.compare("text", Qt::CaseInsensitive) != 0) {
+        err << QObject::tr("Unsupported format %1").arg(format) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    const bool batch = parser->isSet(Estimate::BatchOption);
+    if (batch && !args.isEmpty()) {
+        err << QObject::tr("Passwords are read from STDIN in batch mode.") << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    const bool advanced = parser->isSet(Estimate::AdvancedOption);
+    QScopedPointer<JsonStream> jsonStream(json ? new JsonStream(out, jsonFormat) : nullptr);
+    auto print = [&](const Estimation& estimation) {
+        if (jsonStream) {
+            jsonStream->write(estimationObject(estimation, advanced));
+        } else {
+            printText(out, estimation, advanced);
+        }
+    };
+
+    if (!batch) {
+        print(evaluate(args.size() == 1 ? args.at(0) : in.readLine(), advanced));
+        return EXIT_SUCCESS;
     }
 
-    estimate(password.toUtf8(), parser->isSet(Estimate::AdvancedOption));
+    const std::function<Estimation(const QString&)> estimate = [advanced](const QString& password) {
+        return evaluate(password, advanced);
+    };
+    QStringList passwords;
+    forever {
+        const QString line = in.readLine();
+        if (!line.isNull()) {
+            passwords.append(line);
+        }
+        if (passwords.size() == BatchChunkSize || (line.isNull() && !passwords.isEmpty())) {
+            // The mapped results keep the order of the lines
+            for (const auto& estimation : QtConcurrent::blockingMapped<QList<Estimation>>(passwords, estimate)) {
+                print(estimation);
+            }
+            passwords.clear();
+        }
+        if (line.isNull()) {
+            break;
+        }
+    }
     return EXIT_SUCCESS;
 }
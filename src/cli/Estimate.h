@@ -27,6 +27,7 @@ public:
     int execute(const QStringList& arguments) override;
 
     static const QCommandLineOption AdvancedOption;
+    static const QCommandLineOption BatchOption;
 };
 
 #endif // KEEPASSXC_ESTIMATE_H
@@ -17,6 +17,7 @@
 
 #include "Export.h"
 
+#include "JsonStream.h"
 #include "TextStream.h"
 #include "Utils.h"
 #include "core/Global.h"
@@ -26,13 +27,15 @@
 
 const QCommandLineOption Export::FormatOption = QCommandLineOption(
     QStringList() << "f" << "format",
-    QObject::tr("Format to use when exporting. Available choices are 'xml' or 'csv'. Defaults to 'xml'."),
-    QStringLiteral("xml|csv"));
+    QObject::tr("Format to use when exporting. Available choices are 'xml', 'csv', 'json' or 'jsonl'. "
+                "Defaults to 'xml'."),
+    QStringLiteral("xml|csv|json|jsonl"));
 
 Export::Export()
 {
     name = QStringLiteral("export");
     options.append(Export::FormatOption);
+    options.append(Command::FieldsOption);
     description = QObject::tr("Exports the content of a database to standard output in the specified format.");
 }
 
@@ -42,17 +45,38 @@ int Export::executeWithDatabase(QSharedPointer<Database> database, QSharedPointe
     auto& err = Utils::STDERR;
 
     QString format = parser->value(Export::FormatOption);
-    if (format.isEmpty() || format.startsWith(QStringLiteral("xml"), Qt::CaseInsensitive)) {
-        QByteArray xmlData;
+    JsonStream::Format jsonFormat;
+    if (JsonStream::parseFormat(format, jsonFormat)) {
+        QStringList fields;
+        QString error;
+        // All fields are exported unless asked otherwise
+        if (!JsonStream::parseFields(parser->value(Command::FieldsOption), JsonStream::EntryFields, fields, error)) {
+            err << error << Qt::endl;
+            return EXIT_FAILURE;
+        }
+
+        JsonStream jsonStream(out, jsonFormat);
+        for (const Group* group : database->rootGroup()->groupsRecursive(true)) {
+            for (const Entry* entry : group->entries()) {
+                jsonStream.write(JsonStream::entryObject(entry, fields));
+            }
+        }
+    } else if (format.isEmpty() || format.startsWith(QStringLiteral("xml"), Qt::CaseInsensitive)) {
+        // The XML is written to standard output as the groups are traversed
+        out.flush();
         QString errorMessage;
-        if (!database->extract(xmlData, &errorMessage)) {
+        if (!database->extract(out.device(), &errorMessage)) {
             err << QObject::tr("Unable to export database to XML: %1").arg(errorMessage) << Qt::endl;
             return EXIT_FAILURE;
         }
-        out.write(xmlData.constData());
     } else if (format.startsWith(QStringLiteral("csv"), Qt::CaseInsensitive)) {
+        // Rows are written to standard output as the groups are traversed
+        out.flush();
         CsvExporter csvExporter;
-        out << csvExporter.exportDatabase(database);
+        if (!csvExporter.exportDatabase(out.device(), database)) {
+            err << QObject::tr("Unable to export database to CSV: %1").arg(csvExporter.errorString()) << Qt::endl;
+            return EXIT_FAILURE;
+        }
     } else {
         err << QObject::tr("Unsupported format %1").arg(format) << Qt::endl;
         return EXIT_FAILURE;
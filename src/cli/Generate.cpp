@@ -54,6 +54,12 @@ const QCommandLineOption Generate::ExcludeSimilarCharsOption =
 
 const QCommandLineOption Generate::IncludeEveryGroupOption =
     QCommandLineOption(QStringList() << "every-group", QObject::tr("Include characters from every selected group"));
+
+const QCommandLineOption Generate::CountOption =
+    QCommandLineOption(QStringList() << "count",
+                       QObject::tr("Number of passwords to generate, one per line"),
+                       QObject::tr("count", "CLI parameter"));
+
 Generate::Generate()
 {
     name = QString("generate");
@@ -68,6 +74,24 @@ Generate::Generate()
     options.append(Generate::ExcludeSimilarCharsOption);
     options.append(Generate::IncludeEveryGroupOption);
     options.append(Generate::CustomCharacterSetOption);
+    options.append(Generate::CountOption);
+}
+
+/**
+ * Get the number of passwords to generate from the count option.
+ *
+ * @return number of passwords, 0 if the option value is invalid
+ */
+int Generate::parseCount(QSharedPointer<QCommandLineParser> parser)
+{
+    const QString count = parser->value(Generate::CountOption);
+    if (count.isEmpty()) {
+        return 1;
+    } else if (count.toInt() <= 0) {
+        Utils::STDERR << QObject::tr("Invalid count %1").arg(count) << Qt::endl;
+        return 0;
+    }
+    return count.toInt();
 }
 
 /**
@@ -147,9 +171,16 @@ int Generate::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
+    const int count = Generate::parseCount(parser);
+    if (count <= 0) {
+        return EXIT_FAILURE;
+    }
+
     auto& out = Utils::STDOUT;
-    QString password = passwordGenerator->generatePassword();
-    out << password << Qt::endl;
+    for (const auto& password : passwordGenerator->generatePasswords(count)) {
+        out << password << '\n';
+    }
+    out.flush();
 
     return EXIT_SUCCESS;
 }
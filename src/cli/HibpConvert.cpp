@@ -0,0 +1,78 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HibpConvert.h"
+
+#include "Utils.h"
+#include "core/Global.h"
+#include "core/HibpOffline.h"
+
+#include <QCommandLineParser>
+#include <QFile>
+#include <QSaveFile>
+
+HibpConvert::HibpConvert()
+{
+    name = QString("hibp-convert");
+    description = QObject::tr("Convert a HIBP file into a compact format for fast offline checks.");
+    positionalArguments.append({QString("input"), QObject::tr("Path of the HIBP file ordered by hash."), QString("")});
+    positionalArguments.append({QString("output"), QObject::tr("Path of the converted file."), QString("")});
+}
+
+int HibpConvert::execute(const QStringList& arguments)
+{
+    QSharedPointer<QCommandLineParser> parser = getCommandLineParser(arguments);
+    if (parser.isNull()) {
+        return EXIT_FAILURE;
+    }
+
+    auto& out = Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    const QStringList args = parser->positionalArguments();
+    const QString& inputPath = args.at(0);
+    const QString& outputPath = args.at(1);
+
+    QFile input(inputPath);
+    if (!input.open(QFile::ReadOnly)) {
+        err << QObject::tr("Failed to open HIBP file %1: %2").arg(inputPath, input.errorString()) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    QSaveFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        err << QObject::tr("Failed to open output file %1: %2").arg(outputPath, output.errorString()) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Converting HIBP file, this will take a while…") << Qt::endl;
+
+    QString error;
+    if (!HibpOffline::convert(input, output, &error)) {
+        output.cancelWriting();
+        err << error << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!output.commit()) {
+        err << QObject::tr("Failed to write converted HIBP file: %1").arg(output.errorString()) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Successfully converted HIBP file to %1.").arg(outputPath) << Qt::endl;
+    return EXIT_SUCCESS;
+}
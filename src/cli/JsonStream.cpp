@@ -0,0 +1,182 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "JsonStream.h"
+
+#include "core/Group.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTextStream>
+
+const QStringList JsonStream::EntryFields = {"uuid",
+                                             "path",
+                                             "group",
+                                             "title",
+                                             "username",
+                                             "password",
+                                             "url",
+                                             "notes",
+                                             "tags",
+                                             "created",
+                                             "modified",
+                                             "expires",
+                                             "attributes"};
+
+// Protected values are only written when they are asked for
+const QStringList JsonStream::DefaultFields = {"uuid", "path", "title", "username", "url", "tags"};
+
+namespace
+{
+    // Paths start below the root group, the same way entry paths are given to the commands
+    QString groupPath(const Group* group)
+    {
+        return group->hierarchy().mid(1).join("/").prepend('/');
+    }
+} // namespace
+
+JsonStream::JsonStream(QTextStream& out, Format format)
+    : m_out(out)
+    , m_format(format)
+{
+}
+
+JsonStream::~JsonStream()
+{
+    finish();
+}
+
+void JsonStream::write(const QJsonObject& object)
+{
+    if (m_format == Array) {
+        m_out << (m_empty ? "[\n" : ",\n");
+    }
+    m_out << QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    if (m_format == Lines) {
+        m_out << "\n";
+    }
+    m_empty = false;
+}
+
+/**
+ * Close the JSON array and flush the stream.
+ */
+void JsonStream::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    if (m_format == Array) {
+        m_out << (m_empty ? "[]\n" : "\n]\n");
+    }
+    m_out.flush();
+}
+
+/**
+ * @param value name of a JSON output format, json or jsonl
+ * @param format set to the format
+ * @return true if the value names a JSON format
+ */
+bool JsonStream::parseFormat(const QString& value, Format& format)
+{
+    if (value.compare("json", Qt::CaseInsensitive) == 0) {
+        format = Array;
+        return true;
+    }
+    if (value.compare("jsonl", Qt::CaseInsensitive) == 0) {
+        format = Lines;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @param value comma separated list of entry fields, may be empty
+ * @param defaults fields used for an empty value
+ * @param fields set to the selected fields
+ * @param error set to an error message for unknown fields
+ * @return true if all fields are known
+ */
+bool JsonStream::parseFields(const QString& value, const QStringList& defaults, QStringList& fields, QString& error)
+{
+    if (value.isEmpty()) {
+        fields = defaults;
+        return true;
+    }
+
+    fields.clear();
+    for (const auto& field : value.split(',', Qt::SkipEmptyParts)) {
+        const auto name = field.trimmed().toLower();
+        if (!EntryFields.contains(name)) {
+            error = QObject::tr("Unknown field %1, available fields are %2.").arg(name, EntryFields.join(", "));
+            return false;
+        }
+        fields << name;
+    }
+    return true;
+}
+
+QJsonObject JsonStream::entryObject(const Entry* entry, const QStringList& fields)
+{
+    QJsonObject object;
+    for (const auto& field : fields) {
+        if (field == "uuid") {
+            object.insert(field, entry->uuid().toString());
+        } else if (field == "path") {
+            object.insert(field, entry->path().prepend('/'));
+        } else if (field == "group") {
+            object.insert(field, entry->group() ? groupPath(entry->group()) : QString());
+        } else if (field == "title") {
+            object.insert(field, entry->title());
+        } else if (field == "username") {
+            object.insert(field, entry->username());
+        } else if (field == "password") {
+            object.insert(field, entry->password());
+        } else if (field == "url") {
+            object.insert(field, entry->url());
+        } else if (field == "notes") {
+            object.insert(field, entry->notes());
+        } else if (field == "tags") {
+            object.insert(field, QJsonArray::fromStringList(entry->tagList()));
+        } else if (field == "created") {
+            object.insert(field, entry->timeInfo().creationTime().toString(Qt::ISODate));
+        } else if (field == "modified") {
+            object.insert(field, entry->timeInfo().lastModificationTime().toString(Qt::ISODate));
+        } else if (field == "expires") {
+            const auto& timeInfo = entry->timeInfo();
+            object.insert(field, timeInfo.expires() ? timeInfo.expiryTime().toString(Qt::ISODate) : QJsonValue());
+        } else if (field == "attributes") {
+            QJsonObject attributes;
+            const auto* entryAttributes = entry->attributes();
+            for (const auto& key : entryAttributes->customKeys()) {
+                attributes.insert(key, entryAttributes->value(key));
+            }
+            object.insert(field, attributes);
+        }
+    }
+    return object;
+}
+
+QJsonObject JsonStream::groupObject(const Group* group)
+{
+    QJsonObject object;
+    object.insert("uuid", group->uuid().toString());
+    object.insert("path", groupPath(group));
+    object.insert("name", group->name());
+    return object;
+}
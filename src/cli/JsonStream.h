@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_JSONSTREAM_H
+#define KEEPASSXC_JSONSTREAM_H
+
+#include <QJsonObject>
+#include <QStringList>
+
+class Entry;
+class Group;
+class QTextStream;
+
+/**
+ * Writes JSON objects to a text stream as soon as they are produced.
+ *
+ * The objects are either written as a JSON array, one element per line, or
+ * as JSON lines, so commands only hold a single entry in memory at a time.
+ */
+class JsonStream
+{
+public:
+    enum Format
+    {
+        Array,
+        Lines
+    };
+
+    JsonStream(QTextStream& out, Format format);
+    ~JsonStream();
+
+    void write(const QJsonObject& object);
+    void finish();
+
+    static bool parseFormat(const QString& value, Format& format);
+    static bool parseFields(const QString& value, const QStringList& defaults, QStringList& fields, QString& error);
+    static QJsonObject entryObject(const Entry* entry, const QStringList& fields);
+    static QJsonObject groupObject(const Group* group);
+
+    static const QStringList EntryFields;
+    static const QStringList DefaultFields;
+
+private:
+    QTextStream& m_out;
+    Format m_format;
+    bool m_empty = true;
+    bool m_finished = false;
+};
+
+#endif // KEEPASSXC_JSONSTREAM_H
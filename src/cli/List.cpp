@@ -17,6 +17,7 @@
 
 #include "List.h"
 
+#include "JsonStream.h"
 #include "Utils.h"
 #include "core/Global.h"
 #include "core/Group.h"
@@ -32,13 +33,36 @@ const QCommandLineOption List::FlattenOption =
 List::List()
 {
     name = QString("ls");
+    readOnly = true;
     description = QObject::tr("List database entries.");
     options.append(List::RecursiveOption);
     options.append(List::FlattenOption);
+    options.append(Command::OutputFormatOption);
+    options.append(Command::FieldsOption);
     optionalArguments.append(
         {QString("group"), QObject::tr("Path of the group to list. Default is /"), QString("[group]")});
 }
 
+namespace
+{
+    void writeGroup(JsonStream& json, const Group* group, bool recursive, const QStringList& fields)
+    {
+        for (const Entry* entry : group->entries()) {
+            auto object = JsonStream::entryObject(entry, fields);
+            object.insert("type", "entry");
+            json.write(object);
+        }
+        for (const Group* child : group->children()) {
+            auto object = JsonStream::groupObject(child);
+            object.insert("type", "group");
+            json.write(object);
+            if (recursive) {
+                writeGroup(json, child, recursive, fields);
+            }
+        }
+    }
+} // namespace
+
 int List::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
     auto& out = Utils::STDOUT;
@@ -48,17 +72,35 @@ int List::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<
     bool recursive = parser->isSet(List::RecursiveOption);
     bool flatten = parser->isSet(List::FlattenOption);
 
+    JsonStream::Format jsonFormat;
+    const QString format = parser->value(Command::OutputFormatOption);
+    const bool json = JsonStream::parseFormat(format, jsonFormat);
+    if (!json && format.compare("text", Qt::CaseInsensitive) != 0) {
+        err << QObject::tr("Unsupported format %1").arg(format) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+    QStringList fields;
+    QString error;
+    if (!JsonStream::parseFields(parser->value(Command::FieldsOption), JsonStream::DefaultFields, fields, error)) {
+        err << error << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
     // No group provided, defaulting to root group.
-    if (args.size() == 1) {
-        out << database->rootGroup()->print(recursive, flatten) << Qt::flush;
-        return EXIT_SUCCESS;
+    Group* group = database->rootGroup();
+    if (args.size() > 1) {
+        const QString& groupPath = args.at(1);
+        group = database->rootGroup()->findGroupByPath(groupPath);
+        if (!group) {
+            err << QObject::tr("Cannot find group %1.").arg(groupPath) << Qt::endl;
+            return EXIT_FAILURE;
+        }
     }
 
-    const QString& groupPath = args.at(1);
-    Group* group = database->rootGroup()->findGroupByPath(groupPath);
-    if (!group) {
-        err << QObject::tr("Cannot find group %1.").arg(groupPath) << Qt::endl;
-        return EXIT_FAILURE;
+    if (json) {
+        JsonStream jsonStream(out, jsonFormat);
+        writeGroup(jsonStream, group, recursive, fields);
+        return EXIT_SUCCESS;
     }
 
     out << group->print(recursive, flatten) << Qt::flush;
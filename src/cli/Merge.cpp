@@ -20,8 +20,20 @@
 #include "Utils.h"
 #include "core/Global.h"
 #include "core/Merger.h"
+#include "keys/CompositeKey.h"
 
 #include <QCommandLineParser>
+#include <QThread>
+#include <QtConcurrent>
+
+namespace
+{
+    struct OpenResult
+    {
+        QSharedPointer<Database> db;
+        QString error;
+    };
+} // namespace
 
 const QCommandLineOption Merge::SameCredentialsOption =
     QCommandLineOption(QStringList() << "s" << "same-credentials",
@@ -46,7 +58,7 @@ const QCommandLineOption Merge::YubiKeyFromOption(QStringList() << "yubikey-from
 Merge::Merge()
 {
     name = QString("merge");
-    description = QObject::tr("Merge two databases.");
+    description = QObject::tr("Merge databases.");
     options.append(Merge::SameCredentialsOption);
     options.append(Merge::KeyFileFromOption);
     options.append(Merge::NoPasswordFromOption);
@@ -55,6 +67,10 @@ Merge::Merge()
     options.append(Merge::YubiKeyFromOption);
 #endif
     positionalArguments.append({QString("database2"), QObject::tr("Path of the database to merge from."), QString("")});
+    optionalArguments.append({QString("databases"),
+                              QObject::tr("Paths of further databases to merge from, in order."),
+                              QString("[database3 ...]")});
+    repeatOptionalArguments = true;
 }
 
 int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -65,29 +81,72 @@ int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer
     const QStringList args = parser->positionalArguments();
 
     auto& toDatabasePath = args.at(0);
-    auto& fromDatabasePath = args.at(1);
-
-    QSharedPointer<Database> db2;
-    if (!parser->isSet(Merge::SameCredentialsOption)) {
-        db2 = Utils::unlockDatabase(fromDatabasePath,
-                                    !parser->isSet(Merge::NoPasswordFromOption),
-                                    parser->value(Merge::KeyFileFromOption),
-                                    parser->value(Merge::YubiKeyFromOption),
-                                    parser->isSet(Command::QuietOption));
-        if (!db2) {
-            return EXIT_FAILURE;
+    const auto fromDatabasePaths = args.mid(1);
+
+    // Credentials are asked for one file after the other, the files are then read at the same time
+    QList<QSharedPointer<CompositeKey>> keys;
+    for (const auto& fromDatabasePath : fromDatabasePaths) {
+        QSharedPointer<CompositeKey> key;
+        if (parser->isSet(Merge::SameCredentialsOption)) {
+            key = database->key();
+        } else {
+            key = Utils::getDatabaseKey(fromDatabasePath,
+                                        !parser->isSet(Merge::NoPasswordFromOption),
+                                        parser->value(Merge::KeyFileFromOption),
+                                        parser->value(Merge::YubiKeyFromOption),
+                                        parser->isSet(Command::QuietOption));
         }
-    } else {
-        db2 = QSharedPointer<Database>::create();
-        QString errorMessage;
-        if (!db2->open(fromDatabasePath, database->key(), &errorMessage)) {
-            err << QObject::tr("Error reading merge file:\n%1").arg(errorMessage);
+        if (!key) {
             return EXIT_FAILURE;
         }
+        keys.append(key);
+    }
+
+    auto mainThread = QThread::currentThread();
+    auto openDatabase = [mainThread](const QString& path, const QSharedPointer<CompositeKey>& key) {
+        OpenResult result;
+        result.db = QSharedPointer<Database>::create();
+        if (result.db->open(path, key, &result.error)) {
+            result.db->moveWithHistoryToThread(mainThread);
+        } else {
+            result.db.reset();
+        }
+        return result;
+    };
+
+    // A hardware key can only answer one challenge at a time
+    bool inParallel = true;
+    for (const auto& key : asConst(keys)) {
+        inParallel = inParallel && key->challengeResponseKeys().isEmpty();
+    }
+
+    QList<QFuture<OpenResult>> pending;
+    if (inParallel) {
+        for (int i = 0; i < fromDatabasePaths.size(); ++i) {
+            pending.append(QtConcurrent::run(openDatabase, fromDatabasePaths.at(i), keys.at(i)));
+        }
     }
 
-    Merger merger(db2.data(), database.data());
-    QStringList changeList = merger.merge();
+    // Merge in the order given, so later files win conflicts the same way as separate invocations
+    QStringList changeList;
+    for (int i = 0; i < fromDatabasePaths.size(); ++i) {
+        const auto result = inParallel ? pending.at(i).result() : openDatabase(fromDatabasePaths.at(i), keys.at(i));
+        if (!result.db) {
+            if (parser->isSet(Merge::SameCredentialsOption)) {
+                err << QObject::tr("Error reading merge file:\n%1").arg(result.error);
+            } else if (!parser->isSet(Command::QuietOption)) {
+                err << result.error << Qt::endl;
+            }
+            // Wait for the other files before their databases are released
+            for (const auto& future : asConst(pending)) {
+                future.waitForFinished();
+            }
+            return EXIT_FAILURE;
+        }
+
+        Merger merger(result.db.data(), database.data());
+        changeList << merger.merge();
+    }
 
     for (auto& mergeChange : changeList) {
         out << "\t" << mergeChange << Qt::endl;
@@ -95,11 +154,12 @@ int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer
 
     if (!changeList.isEmpty() && !parser->isSet(Merge::DryRunOption)) {
         QString errorMessage;
-        if (!database->save(Database::Atomic, {}, &errorMessage)) {
+        if (!saveDatabase(database, &errorMessage)) {
             err << QObject::tr("Unable to save database to file : %1").arg(errorMessage) << Qt::endl;
             return EXIT_FAILURE;
         }
-        out << QObject::tr("Successfully merged %1 into %2.").arg(fromDatabasePath, toDatabasePath) << Qt::endl;
+        out << QObject::tr("Successfully merged %1 into %2.").arg(fromDatabasePaths.join(", "), toDatabasePath)
+            << Qt::endl;
     } else {
         out << QObject::tr("Database was not modified by merge operation.") << Qt::endl;
     }
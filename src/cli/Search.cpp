@@ -19,6 +19,7 @@
 
 #include <QCommandLineParser>
 
+#include "JsonStream.h"
 #include "Utils.h"
 #include "core/EntrySearcher.h"
 #include "core/Global.h"
@@ -27,8 +28,11 @@
 Search::Search()
 {
     name = QString("search");
+    readOnly = true;
     description = QObject::tr("Find entries quickly.");
     positionalArguments.append({QString("term"), QObject::tr("Search term."), QString("")});
+    options.append(Command::OutputFormatOption);
+    options.append(Command::FieldsOption);
 }
 
 int Search::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -38,6 +42,20 @@ int Search::executeWithDatabase(QSharedPointer<Database> database, QSharedPointe
 
     const QStringList args = parser->positionalArguments();
 
+    JsonStream::Format jsonFormat;
+    const QString format = parser->value(Command::OutputFormatOption);
+    const bool json = JsonStream::parseFormat(format, jsonFormat);
+    if (!json && format.compare("text", Qt::CaseInsensitive) != 0) {
+        err << QObject::tr("Unsupported format %1").arg(format) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+    QStringList fields;
+    QString error;
+    if (!JsonStream::parseFields(parser->value(Command::FieldsOption), JsonStream::DefaultFields, fields, error)) {
+        err << error << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
     EntrySearcher searcher;
     auto results = searcher.search(args.at(1), database->rootGroup(), true);
     if (results.isEmpty()) {
@@ -45,6 +63,15 @@ int Search::executeWithDatabase(QSharedPointer<Database> database, QSharedPointe
         return EXIT_FAILURE;
     }
 
+    if (json) {
+        // Each entry is written as soon as its object is built
+        JsonStream jsonStream(out, jsonFormat);
+        for (const Entry* result : asConst(results)) {
+            jsonStream.write(JsonStream::entryObject(result, fields));
+        }
+        return EXIT_SUCCESS;
+    }
+
     for (const Entry* result : asConst(results)) {
         out << result->path().prepend('/') << Qt::endl;
     }
@@ -0,0 +1,204 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Serve.h"
+
+#include "Utils.h"
+#include "core/AsyncTask.h"
+#include "core/Global.h"
+#include "core/Merger.h"
+#include "core/Tools.h"
+
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+
+namespace
+{
+    // Commands that only read the database and write nothing but their output
+    const QStringList ServedCommands = {"db-info", "ls", "search", "show"};
+
+    QByteArray response(int exitCode, const QString& out, const QString& err)
+    {
+        QJsonObject object;
+        object.insert("status", exitCode == EXIT_SUCCESS ? "ok" : "error");
+        object.insert("stdout", out);
+        object.insert("stderr", err);
+        return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    /**
+     * Merge the changes of the database file into the served database.
+     *
+     * The file is read with the key of the served database in a worker thread,
+     * requests are answered from the old state until it is merged.
+     */
+    void reloadDatabase(const QSharedPointer<Database>& database, QObject* context)
+    {
+        const auto filePath = database->filePath();
+        const auto key = database->key();
+        auto mainThread = context->thread();
+        AsyncTask::runThenCallback(
+            [filePath, key, mainThread] {
+                auto db = QSharedPointer<Database>::create();
+                QString error;
+                if (!db->open(filePath, key, &error)) {
+                    Utils::STDERR << QObject::tr("Failed to reload the database: %1").arg(error) << Qt::endl;
+                    db.reset();
+                } else {
+                    db->moveWithHistoryToThread(mainThread);
+                }
+                return db;
+            },
+            context,
+            [database](const QSharedPointer<Database>& db) {
+                if (!db) {
+                    return;
+                }
+                // The file is the only source of changes, deletions in it are applied as well
+                Merger merger(db->rootGroup(), database->rootGroup());
+                merger.setForcedMergeMode(Group::Synchronize);
+                merger.merge();
+                database->markAsClean();
+            });
+    }
+} // namespace
+
+Serve::Serve()
+{
+    name = QString("serve");
+    description = QObject::tr("Keep a database unlocked and answer read requests on a local socket.");
+    positionalArguments.append({QString("socket"), QObject::tr("Path of the socket to listen on."), QString("")});
+}
+
+/**
+ * Run a command against the served database.
+ *
+ * @param database served database
+ * @param request JSON array of the command name and its arguments, without the database path
+ * @return JSON object with the status and the output of the command, terminated by a newline
+ */
+QByteArray Serve::handleRequest(const QSharedPointer<Database>& database, const QByteArray& request)
+{
+    QJsonParseError parseError;
+    const auto document = QJsonDocument::fromJson(request, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isArray()) {
+        return response(EXIT_FAILURE, {}, QObject::tr("Invalid JSON: %1").arg(parseError.errorString()));
+    }
+
+    QStringList args;
+    for (const auto& value : document.array()) {
+        if (!value.isString()) {
+            return response(EXIT_FAILURE, {}, QObject::tr("Command arguments have to be strings."));
+        }
+        args << value.toString();
+    }
+
+    auto command = ServedCommands.contains(args.value(0)) ? Commands::getCommand(args.first()) : nullptr;
+    if (!command) {
+        return response(EXIT_FAILURE, {}, QObject::tr("Command %1 is not served.").arg(args.value(0)));
+    }
+
+    // Capture the output of the command, the served database is never saved
+    QBuffer outBuffer;
+    QBuffer errBuffer;
+    outBuffer.open(QIODevice::WriteOnly);
+    errBuffer.open(QIODevice::WriteOnly);
+    auto outDevice = Utils::STDOUT.device();
+    auto errDevice = Utils::STDERR.device();
+    Utils::STDOUT.setDevice(&outBuffer);
+    Utils::STDERR.setDevice(&errBuffer);
+
+    command->currentDatabase = database;
+    command->saveDeferred = true;
+    const int exitCode = command->execute(args);
+    command->saveDeferred = false;
+    command->currentDatabase.reset();
+
+    Utils::STDOUT.flush();
+    Utils::STDERR.flush();
+    Utils::STDOUT.setDevice(outDevice);
+    Utils::STDERR.setDevice(errDevice);
+
+    return response(exitCode, QString::fromUtf8(outBuffer.data()), QString::fromUtf8(errBuffer.data()));
+}
+
+int Serve::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
+{
+    auto& out = parser->isSet(Command::QuietOption) ? Utils::DEVNULL : Utils::STDOUT;
+    auto& err = Utils::STDERR;
+
+    const QString socketPath = parser->positionalArguments().at(1);
+
+    QLocalServer server;
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    // Never take over a socket that is still served
+    QLocalSocket probe;
+    probe.connectToServer(socketPath);
+    if (probe.waitForConnected(1000)) {
+        err << QObject::tr("The socket %1 is already in use.").arg(socketPath) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Remove a socket left behind by a previous instance, but nothing else at that path
+    if (!Tools::removeStaleSocket(socketPath)) {
+        err << QObject::tr("Refusing to replace %1, it is not a socket of the current user.").arg(socketPath)
+            << Qt::endl;
+        return EXIT_FAILURE;
+    }
+    if (!server.listen(socketPath)) {
+        err << QObject::tr("Failed to listen on %1: %2").arg(socketPath, server.errorString()) << Qt::endl;
+        return EXIT_FAILURE;
+    }
+
+    QObject::connect(database.data(), &Database::databaseFileChanged, &server, [database, &server] {
+        reloadDatabase(database, &server);
+    });
+
+    QObject::connect(&server, &QLocalServer::newConnection, &server, [database, &server] {
+        while (server.hasPendingConnections()) {
+            auto socket = server.nextPendingConnection();
+            QObject::connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+            if (!Tools::isSocketPeerSameUser(socket->socketDescriptor())) {
+                socket->disconnectFromServer();
+                continue;
+            }
+
+            // Every request is a line, clients may send several before reading the responses
+            QObject::connect(socket, &QLocalSocket::readyRead, socket, [database, socket] {
+                while (socket->canReadLine()) {
+                    socket->write(handleRequest(database, socket->readLine().trimmed()));
+                }
+                if (socket->bytesAvailable() > MaxRequestSize) {
+                    socket->disconnectFromServer();
+                    return;
+                }
+                socket->flush();
+            });
+        }
+    });
+
+    out << QObject::tr("Serving %1 on %2.").arg(database->filePath(), server.fullServerName()) << Qt::endl;
+    QCoreApplication::exec();
+    return EXIT_SUCCESS;
+}
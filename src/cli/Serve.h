@@ -0,0 +1,36 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_SERVE_H
+#define KEEPASSXC_SERVE_H
+
+#include "DatabaseCommand.h"
+
+class Serve : public DatabaseCommand
+{
+public:
+    Serve();
+
+    int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
+
+    static QByteArray handleRequest(const QSharedPointer<Database>& database, const QByteArray& request);
+
+    // Longest request line, longer requests close the connection
+    static const int MaxRequestSize = 64 * 1024;
+};
+
+#endif // KEEPASSXC_SERVE_H
@@ -47,6 +47,7 @@ const QCommandLineOption Show::AttributesOption = QCommandLineOption(
 Show::Show()
 {
     name = QString("show");
+    readOnly = true;
     description = QObject::tr("Show an entry's information.");
     options.append(Show::TotpOption);
     options.append(Show::AttributesOption);
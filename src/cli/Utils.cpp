@@ -101,11 +101,16 @@ namespace Utils
 #endif
     }
 
-    QSharedPointer<Database> unlockDatabase(const QString& databaseFilename,
-                                            bool isPasswordProtected,
-                                            const QString& keyFilename,
-                                            const QString& yubiKeySlot,
-                                            bool quiet)
+    /**
+     * Ask for the credentials of a database without opening it.
+     *
+     * @return key of the database, or a null pointer if the file or the credentials cannot be read
+     */
+    QSharedPointer<CompositeKey> getDatabaseKey(const QString& databaseFilename,
+                                                bool isPasswordProtected,
+                                                const QString& keyFilename,
+                                                const QString& yubiKeySlot,
+                                                bool quiet)
     {
         auto& err = quiet ? DEVNULL : STDERR;
         auto compositeKey = QSharedPointer<CompositeKey>::create();
@@ -189,9 +194,25 @@ namespace Utils
         Q_UNUSED(yubiKeySlot);
 #endif // WITH_XC_YUBIKEY
 
+        return compositeKey;
+    }
+
+    QSharedPointer<Database> unlockDatabase(const QString& databaseFilename,
+                                            bool isPasswordProtected,
+                                            const QString& keyFilename,
+                                            const QString& yubiKeySlot,
+                                            bool quiet,
+                                            bool readOnly)
+    {
+        auto& err = quiet ? DEVNULL : STDERR;
+        auto compositeKey = getDatabaseKey(databaseFilename, isPasswordProtected, keyFilename, yubiKeySlot, quiet);
+        if (!compositeKey) {
+            return {};
+        }
+
         auto db = QSharedPointer<Database>::create();
         QString error;
-        if (db->open(databaseFilename, compositeKey, &error)) {
+        if (db->open(databaseFilename, compositeKey, &error, readOnly ? Database::ReadOnly : Database::OpenDefault)) {
             return db;
         } else {
             err << error << Qt::endl;
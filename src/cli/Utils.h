@@ -45,11 +45,17 @@ namespace Utils
     QString getPassword(bool quiet = false);
     QSharedPointer<PasswordKey> getConfirmedPassword();
     int clipText(const QString& text);
+    QSharedPointer<CompositeKey> getDatabaseKey(const QString& databaseFilename,
+                                                bool isPasswordProtected = true,
+                                                const QString& keyFilename = {},
+                                                const QString& yubiKeySlot = {},
+                                                bool quiet = false);
     QSharedPointer<Database> unlockDatabase(const QString& databaseFilename,
                                             bool isPasswordProtected = true,
                                             const QString& keyFilename = {},
                                             const QString& yubiKeySlot = {},
-                                            bool quiet = false);
+                                            bool quiet = false,
+                                            bool readOnly = false);
 
     QStringList splitCommandString(const QString& command);
 
@@ -26,6 +26,7 @@
 #include "core/Bootstrap.h"
 #include "core/Config.h"
 #include "core/Metadata.h"
+#include "core/PerformanceStats.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
 
@@ -182,7 +183,7 @@ int main(int argc, char** argv)
     QCoreApplication app(argc, argv);
     QCoreApplication::setApplicationVersion(KEEPASSXC_VERSION);
 
-    Bootstrap::bootstrap(config()->get(Config::GUI_Language).toString());
+    Bootstrap::bootstrap(config()->get(Config::GUI_Language).toString(), false);
     Utils::setDefaultTextStreams();
     Commands::setupCommands(false);
 
@@ -206,6 +207,10 @@ int main(int argc, char** argv)
 
     QCommandLineOption debugInfoOption(QStringList() << "debug-info", QObject::tr("Displays debugging information."));
     parser.addOption(debugInfoOption);
+    QCommandLineOption performanceStatsOption(
+        QStringList() << "performance-stats",
+        QObject::tr("Prints the timings of database operations to the standard error after the command."));
+    parser.addOption(performanceStatsOption);
     parser.addHelpOption();
     parser.addVersionOption();
     // TODO : use the setOptionsAfterPositionalArgumentsMode (Qt 5.6) function
@@ -213,6 +218,10 @@ int main(int argc, char** argv)
     // recognized by this parser.
     parser.parse(arguments);
 
+    // Recording is off unless asked for, the option is not passed on to the commands
+    PerformanceStats::setEnabled(parser.isSet(performanceStatsOption));
+    arguments.removeAll(QStringLiteral("--performance-stats"));
+
     if (parser.positionalArguments().empty()) {
         if (parser.isSet("version")) {
             // Switch to parser.showVersion() when available (QT 5.4).
@@ -229,7 +238,11 @@ int main(int argc, char** argv)
 
     QString commandName = parser.positionalArguments().at(0);
     if (commandName == "open") {
-        return enterInteractiveMode(arguments);
+        int exitCode = enterInteractiveMode(arguments);
+        if (PerformanceStats::isEnabled()) {
+            err << PerformanceStats::report() << Qt::flush;
+        }
+        return exitCode;
     }
 
     auto command = Commands::getCommand(commandName);
@@ -247,6 +260,10 @@ int main(int argc, char** argv)
         command->currentDatabase.reset();
     }
 
+    if (PerformanceStats::isEnabled()) {
+        err << PerformanceStats::report() << Qt::flush;
+    }
+
 #if defined(WITH_ASAN) && defined(WITH_LSAN)
     // do leak check here to prevent massive tail of end-of-process leak errors from third-party libraries
     __lsan_do_leak_check();
@@ -18,7 +18,9 @@
 #ifndef KEEPASSXC_ASYNCTASK_HPP
 #define KEEPASSXC_ASYNCTASK_HPP
 
+#include <QCoreApplication>
 #include <QFutureWatcher>
+#include <QThread>
 #include <QtConcurrent>
 
 /**
@@ -46,11 +48,18 @@ namespace AsyncTask
     /**
      * Run a given task and wait for it to finish without blocking the event loop.
      *
+     * Outside the main thread there is no event loop to keep responsive and the
+     * task runs directly instead of spinning a nested event loop.
+     *
      * @param task std::function object to run
      * @return async task result
      */
     template <typename FunctionObject> decltype(auto) runAndWaitForFuture(FunctionObject task)
     {
+        auto app = QCoreApplication::instance();
+        if (app && QThread::currentThread() != app->thread()) {
+            return task();
+        }
         return waitForFuture(QtConcurrent::run(task));
     }
 
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Base64.h"
+
+namespace
+{
+    constexpr char Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    // Sextet value of every ASCII character, -1 for characters outside of the alphabet
+    constexpr qint8 DecodeTable[128] = {
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62,
+        -1, -1, -1, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1, -1, 0,
+        1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22,
+        23, 24, 25, -1, -1, -1, -1, -1, -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38,
+        39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    };
+
+    inline int decodeChar(ushort ch)
+    {
+        return ch < 128 ? DecodeTable[ch] : -1;
+    }
+
+    template <typename Char> inline Char encodeSextet(uint value);
+
+    template <> inline QChar encodeSextet<QChar>(uint value)
+    {
+        return QLatin1Char(Alphabet[value & 0x3F]);
+    }
+
+    template <> inline char encodeSextet<char>(uint value)
+    {
+        return Alphabet[value & 0x3F];
+    }
+
+    template <typename Char> void encodeTo(const uchar* in, int size, Char* out)
+    {
+        int i = 0;
+        for (; i + 3 <= size; i += 3) {
+            uint quantum = (uint(in[i]) << 16) | (uint(in[i + 1]) << 8) | uint(in[i + 2]);
+            out[0] = encodeSextet<Char>(quantum >> 18);
+            out[1] = encodeSextet<Char>(quantum >> 12);
+            out[2] = encodeSextet<Char>(quantum >> 6);
+            out[3] = encodeSextet<Char>(quantum);
+            out += 4;
+        }
+
+        if (i < size) {
+            uint quantum = uint(in[i]) << 16;
+            if (i + 1 < size) {
+                quantum |= uint(in[i + 1]) << 8;
+            }
+            out[0] = encodeSextet<Char>(quantum >> 18);
+            out[1] = encodeSextet<Char>(quantum >> 12);
+            out[2] = (i + 1 < size) ? encodeSextet<Char>(quantum >> 6) : Char('=');
+            out[3] = Char('=');
+        }
+    }
+} // namespace
+
+Base64::Decoder::Decoder(QByteArray& output)
+    : m_output(output)
+{
+}
+
+void Base64::Decoder::decode(const QStringRef& text)
+{
+    decode(text.constData(), text.size());
+}
+
+void Base64::Decoder::decode(const QChar* text, int length)
+{
+    int offset = m_output.size();
+    m_output.resize(offset + (length * 3) / 4 + 3);
+    auto out = reinterpret_cast<uchar*>(m_output.data());
+    auto in = reinterpret_cast<const ushort*>(text);
+
+    int i = 0;
+    while (i < length) {
+        // Decode whole quanta at once while they are aligned and free of
+        // whitespace or padding, which is the case for nearly all input
+        if (m_bits == 0) {
+            while (i + 4 <= length) {
+                int a = decodeChar(in[i]);
+                int b = decodeChar(in[i + 1]);
+                int c = decodeChar(in[i + 2]);
+                int d = decodeChar(in[i + 3]);
+                if ((a | b | c | d) < 0) {
+                    break;
+                }
+                uint quantum = (uint(a) << 18) | (uint(b) << 12) | (uint(c) << 6) | uint(d);
+                out[offset] = static_cast<uchar>(quantum >> 16);
+                out[offset + 1] = static_cast<uchar>(quantum >> 8);
+                out[offset + 2] = static_cast<uchar>(quantum);
+                offset += 3;
+                i += 4;
+            }
+            if (i == length) {
+                break;
+            }
+        }
+
+        int d = decodeChar(in[i++]);
+        if (d < 0) {
+            continue;
+        }
+
+        m_buffer = (m_buffer << 6) | static_cast<uint>(d);
+        m_bits += 6;
+        if (m_bits >= 8) {
+            m_bits -= 8;
+            out[offset++] = static_cast<uchar>(m_buffer >> m_bits);
+            m_buffer &= (1u << m_bits) - 1;
+        }
+    }
+
+    m_output.resize(offset);
+}
+
+/**
+ * Encode data as padded base64 text.
+ *
+ * @param data binary data
+ * @return base64 text, identical to QString::fromLatin1(data.toBase64())
+ */
+QString Base64::encode(const QByteArray& data)
+{
+    QString result(encodedSize(data.size()), Qt::Uninitialized);
+    encodeTo(reinterpret_cast<const uchar*>(data.constData()), data.size(), result.data());
+    return result;
+}
+
+/**
+ * Encode data as padded base64 text into a Latin-1 buffer.
+ *
+ * @param data binary data
+ * @param size size of data
+ * @param output buffer of at least encodedSize(size) bytes
+ */
+void Base64::encode(const char* data, int size, char* output)
+{
+    encodeTo(reinterpret_cast<const uchar*>(data), size, output);
+}
+
+/**
+ * @param size size of binary data
+ * @return length of its padded base64 encoding
+ */
+int Base64::encodedSize(int size)
+{
+    return (size + 2) / 3 * 4;
+}
+
+/**
+ * Decode base64 text, ignoring characters outside of the alphabet.
+ *
+ * @param text base64 text
+ * @return decoded data
+ */
+QByteArray Base64::decode(const QString& text)
+{
+    QByteArray result;
+    Decoder decoder(result);
+    decoder.decode(text.constData(), text.size());
+    return result;
+}
+
+QByteArray Base64::decode(const QStringRef& text)
+{
+    QByteArray result;
+    Decoder decoder(result);
+    decoder.decode(text);
+    return result;
+}
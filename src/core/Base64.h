@@ -0,0 +1,57 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Standard base64 alphabet as per RFC 4648, producing the same output as
+ * QByteArray::toBase64() and accepting the same input as
+ * QByteArray::fromBase64(). Text is read and written as UTF-16 directly so
+ * the XML and JSON code does not need an intermediate Latin-1 copy.
+ */
+
+#ifndef KEEPASSXC_BASE64_H
+#define KEEPASSXC_BASE64_H
+
+#include <QByteArray>
+#include <QString>
+
+class Base64
+{
+public:
+    /**
+     * Incremental decoder that appends to an output buffer and can be fed
+     * text in arbitrary pieces, ignoring characters outside of the alphabet.
+     */
+    class Decoder
+    {
+    public:
+        explicit Decoder(QByteArray& output);
+        void decode(const QChar* text, int length);
+        void decode(const QStringRef& text);
+
+    private:
+        QByteArray& m_output;
+        uint m_buffer = 0;
+        int m_bits = 0;
+    };
+
+    Q_REQUIRED_RESULT static QString encode(const QByteArray& data);
+    static void encode(const char* data, int size, char* output);
+    static int encodedSize(int size);
+    Q_REQUIRED_RESULT static QByteArray decode(const QString& text);
+    Q_REQUIRED_RESULT static QByteArray decode(const QStringRef& text);
+};
+
+#endif // KEEPASSXC_BASE64_H
@@ -63,7 +63,7 @@ namespace Bootstrap
      * Perform early application bootstrapping that does not rely on a QApplication
      * being present.
      */
-    void bootstrap(const QString& uiLanguage)
+    void bootstrap(const QString& uiLanguage, bool installQtTranslator)
     {
 #ifdef QT_NO_DEBUG
         disableCoreDumps();
@@ -72,7 +72,7 @@ namespace Bootstrap
         setupSearchPaths();
         applyEarlyQNetworkAccessManagerWorkaround();
 
-        Translator::installTranslators(uiLanguage);
+        Translator::installTranslators(uiLanguage, installQtTranslator);
     }
 
     // LCOV_EXCL_START
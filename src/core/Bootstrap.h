@@ -22,7 +22,7 @@
 
 namespace Bootstrap
 {
-    void bootstrap(const QString& uiLanguage = "system");
+    void bootstrap(const QString& uiLanguage = "system", bool installQtTranslator = true);
     void disableCoreDumps();
     bool createWindowsDACL();
     void setupSearchPaths();
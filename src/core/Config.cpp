@@ -60,6 +60,7 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::AutoReloadOnChange,{QS("AutoReloadOnChange"), Roaming, true}},
     {Config::AutoSaveOnExit,{QS("AutoSaveOnExit"), Roaming, true}},
     {Config::AutoSaveNonDataChanges,{QS("AutoSaveNonDataChanges"), Roaming, true}},
+    {Config::AutoSaveJournal,{QS("AutoSaveJournal"), Roaming, false}},
     {Config::BackupBeforeSave,{QS("BackupBeforeSave"), Roaming, false}},
     {Config::BackupFilePathPattern,{QS("BackupFilePathPattern"), Roaming, QString("{DB_FILENAME}.old.kdbx")}},
     {Config::UseAtomicSaves,{QS("UseAtomicSaves"), Roaming, true}},
@@ -147,6 +148,7 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::Security_NoConfirmMoveEntryToRecycleBin,{QS("Security/NoConfirmMoveEntryToRecycleBin"), Roaming, true}},
     {Config::Security_EnableCopyOnDoubleClick,{QS("Security/EnableCopyOnDoubleClick"), Roaming, false}},
     {Config::Security_QuickUnlock, {QS("Security/QuickUnlock"), Local, true}},
+    {Config::Security_QuickUnlockKeepTransformedKey, {QS("Security/QuickUnlockKeepTransformedKey"), Local, false}},
     {Config::Security_DatabasePasswordMinimumQuality, {QS("Security/DatabasePasswordMinimumQuality"), Local, 0}},
 
     // Browser
@@ -181,6 +183,8 @@ static const QHash<Config::ConfigKey, ConfigDirective> configStrings = {
     {Config::SSHAgent_UsePageant, {QS("SSHAgent/UsePageant"), Roaming, true} },
     {Config::SSHAgent_AuthSockOverride, {QS("SSHAgent/AuthSockOverride"), Local, {}}},
     {Config::SSHAgent_SecurityKeyProviderOverride, {QS("SSHAgent/SecurityKeyProviderOverride"), Local, {}}},
+    {Config::SSHAgent_ServeKeys, {QS("SSHAgent/ServeKeys"), Roaming, false}},
+    {Config::SSHAgent_ServerSocketPath, {QS("SSHAgent/ServerSocketPath"), Local, {}}},
 
     // FdoSecrets
     {Config::FdoSecrets_Enabled, {QS("FdoSecrets/Enabled"), Roaming, false}},
@@ -229,12 +233,7 @@ QPointer<Config> Config::m_instance(nullptr);
 
 QVariant Config::get(ConfigKey key)
 {
-    auto cfg = configStrings[key];
-    auto defaultValue = configStrings[key].defaultValue;
-    if (m_localSettings && cfg.type == Local) {
-        return m_localSettings->value(cfg.name, defaultValue);
-    }
-    return m_settings->value(cfg.name, defaultValue);
+    return m_values.value(key);
 }
 
 QVariant Config::getDefault(Config::ConfigKey key)
@@ -264,6 +263,7 @@ void Config::set(ConfigKey key, const QVariant& value)
     } else {
         m_settings->setValue(cfg.name, value);
     }
+    m_values[key] = value;
 
     emit changed(key);
 }
@@ -276,6 +276,7 @@ void Config::remove(ConfigKey key)
     } else {
         m_settings->remove(cfg.name);
     }
+    m_values[key] = cfg.defaultValue;
 
     emit changed(key);
 }
@@ -293,6 +294,8 @@ void Config::sync()
     if (m_localSettings) {
         m_localSettings->sync();
     }
+    // Syncing also reads what other instances wrote to the files
+    loadValues();
 }
 
 void Config::resetToDefaults()
@@ -301,6 +304,30 @@ void Config::resetToDefaults()
     if (m_localSettings) {
         m_localSettings->clear();
     }
+    loadValues();
+}
+
+/**
+ * Read the values of all keys into memory.
+ *
+ * Values are read from the settings only here, changes are written to the
+ * settings right away and reach the files with the next deferred QSettings sync.
+ */
+void Config::loadValues()
+{
+    m_values.resize(Deleted);
+    for (int key = 0; key < Deleted; ++key) {
+        m_values[key] = readValue(static_cast<ConfigKey>(key));
+    }
+}
+
+QVariant Config::readValue(ConfigKey key) const
+{
+    auto cfg = configStrings[key];
+    if (m_localSettings && cfg.type == Local) {
+        return m_localSettings->value(cfg.name, cfg.defaultValue);
+    }
+    return m_settings->value(cfg.name, cfg.defaultValue);
 }
 
 bool Config::importSettings(const QString& fileName)
@@ -543,6 +570,7 @@ void Config::init(const QString& configFileName, const QString& localConfigFileN
         m_localSettings.reset(new QSettings(localConfigFileName, QSettings::IniFormat));
     }
 
+    loadValues();
     migrate();
     connect(qApp, &QCoreApplication::aboutToQuit, this, &Config::sync);
 }
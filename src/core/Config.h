@@ -43,6 +43,7 @@ public:
         AutoReloadOnChange,
         AutoSaveOnExit,
         AutoSaveNonDataChanges,
+        AutoSaveJournal,
         BackupBeforeSave,
         BackupFilePathPattern,
         UseAtomicSaves,
@@ -128,6 +129,7 @@ public:
         Security_NoConfirmMoveEntryToRecycleBin,
         Security_EnableCopyOnDoubleClick,
         Security_QuickUnlock,
+        Security_QuickUnlockKeepTransformedKey,
         Security_DatabasePasswordMinimumQuality,
 
         Browser_Enabled,
@@ -160,6 +162,8 @@ public:
         SSHAgent_UsePageant,
         SSHAgent_AuthSockOverride,
         SSHAgent_SecurityKeyProviderOverride,
+        SSHAgent_ServeKeys,
+        SSHAgent_ServerSocketPath,
 
         FdoSecrets_Enabled,
         FdoSecrets_ShowNotification,
@@ -238,6 +242,8 @@ private:
     explicit Config(QObject* parent);
     void init(const QString& configFileName, const QString& localConfigFileName);
     void migrate();
+    void loadValues();
+    QVariant readValue(ConfigKey key) const;
     static QPair<QString, QString> defaultConfigFiles();
 
     static QPointer<Config> m_instance;
@@ -245,6 +251,8 @@ private:
     QScopedPointer<QSettings> m_settings;
     QScopedPointer<QSettings> m_localSettings;
     QHash<QString, QVariant> m_defaults;
+    // Values of all keys indexed by ConfigKey, the settings files are only read when they may have changed
+    QVector<QVariant> m_values;
 };
 
 inline Config* config()
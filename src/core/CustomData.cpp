@@ -20,6 +20,9 @@
 #include "core/Clock.h"
 #include "core/Global.h"
 
+#include <QMutex>
+#include <QSet>
+
 const QString CustomData::LastModified = QStringLiteral("_LAST_MODIFIED");
 const QString CustomData::Created = QStringLiteral("_CREATED");
 const QString CustomData::BrowserKeyPrefix = QStringLiteral("KPXC_BROWSER_");
@@ -32,45 +35,94 @@ const QString CustomData::RemoteProgramSettings = QStringLiteral("KPXC_REMOTE_SY
 // Fallback item for return by reference
 static const CustomData::CustomDataItem NULL_ITEM{};
 
+namespace
+{
+    // Keys beyond this are stored as they are, so arbitrary plugin data cannot grow the pool forever
+    const int MaxInternedKeys = 4096;
+
+    /**
+     * Get a shared copy of a key.
+     *
+     * Browser integration, passkeys and KeeShare store the same keys on many
+     * entries, every entry read from a file would otherwise hold its own copy.
+     * Shared keys are also compared without looking at their characters.
+     *
+     * @param key key to intern
+     * @return key sharing its data with all equal interned keys
+     */
+    QString internKey(const QString& key)
+    {
+        // Databases are read in worker threads
+        static QMutex mutex;
+        static QSet<QString> keys;
+
+        QMutexLocker locker(&mutex);
+        const auto interned = keys.constFind(key);
+        if (interned != keys.constEnd()) {
+            return *interned;
+        }
+        if (keys.size() < MaxInternedKeys) {
+            keys.insert(key);
+        }
+        return key;
+    }
+} // namespace
+
 CustomData::CustomData(QObject* parent)
     : ModifiableObject(parent)
 {
 }
 
+int CustomData::indexOf(const QString& key) const
+{
+    for (int i = 0; i < m_data.size(); ++i) {
+        if (m_data.at(i).key == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 QList<QString> CustomData::keys() const
 {
-    return m_data.keys();
+    QList<QString> keys;
+    keys.reserve(m_data.size());
+    for (const auto& item : m_data) {
+        keys.append(item.key);
+    }
+    return keys;
 }
 
 bool CustomData::hasKey(const QString& key) const
 {
-    return m_data.contains(key);
+    return indexOf(key) >= 0;
 }
 
 QString CustomData::value(const QString& key) const
 {
-    return m_data.value(key).value;
+    const int index = indexOf(key);
+    return index >= 0 ? m_data.at(index).data.value : QString();
 }
 
 const CustomData::CustomDataItem& CustomData::item(const QString& key) const
 {
-    auto item = m_data.find(key);
-    Q_ASSERT(item != m_data.end());
-    if (item == m_data.end()) {
+    const int index = indexOf(key);
+    Q_ASSERT(index >= 0);
+    if (index < 0) {
         return NULL_ITEM;
     }
-    return item.value();
+    return m_data.at(index).data;
 }
 
 bool CustomData::contains(const QString& key) const
 {
-    return m_data.contains(key);
+    return indexOf(key) >= 0;
 }
 
 bool CustomData::containsValue(const QString& value) const
 {
-    for (auto i = m_data.constBegin(); i != m_data.constEnd(); ++i) {
-        if (i.value().value == value) {
+    for (const auto& item : m_data) {
+        if (item.data.value == value) {
             return true;
         }
     }
@@ -79,8 +131,9 @@ bool CustomData::containsValue(const QString& value) const
 
 void CustomData::set(const QString& key, CustomDataItem item)
 {
-    bool addAttribute = !m_data.contains(key);
-    bool changeValue = !addAttribute && (m_data.value(key).value != item.value);
+    const int index = indexOf(key);
+    bool addAttribute = index < 0;
+    bool changeValue = !addAttribute && (m_data.at(index).data.value != item.value);
 
     if (addAttribute) {
         emit aboutToBeAdded(key);
@@ -90,13 +143,21 @@ void CustomData::set(const QString& key, CustomDataItem item)
         item.lastModified = Clock::currentDateTimeUtc();
     }
     if (addAttribute || changeValue) {
-        m_data.insert(key, item);
+        // Receivers of aboutToBeAdded() may have changed the items
+        const int current = indexOf(key);
+        if (current < 0) {
+            m_data.append({internKey(key), item});
+        } else {
+            m_data[current].data = item;
+        }
         updateLastModified();
         emitModified();
     }
 
     if (addAttribute) {
         emit added(key);
+    } else if (changeValue) {
+        emit valueChanged(key);
     }
 }
 
@@ -109,8 +170,9 @@ void CustomData::remove(const QString& key)
 {
     emit aboutToBeRemoved(key);
 
-    if (m_data.contains(key)) {
-        m_data.remove(key);
+    const int index = indexOf(key);
+    if (index >= 0) {
+        m_data.remove(index);
         updateLastModified();
         emitModified();
     }
@@ -120,20 +182,23 @@ void CustomData::remove(const QString& key)
 
 void CustomData::rename(const QString& oldKey, const QString& newKey)
 {
-    const bool containsOldKey = m_data.contains(oldKey);
-    const bool containsNewKey = m_data.contains(newKey);
+    const bool containsOldKey = contains(oldKey);
+    const bool containsNewKey = contains(newKey);
     Q_ASSERT(containsOldKey && !containsNewKey);
     if (!containsOldKey || containsNewKey) {
         return;
     }
 
-    CustomDataItem data = m_data.value(oldKey);
+    CustomDataItem data = item(oldKey);
 
     emit aboutToRename(oldKey, newKey);
 
-    m_data.remove(oldKey);
+    const int index = indexOf(oldKey);
+    if (index >= 0) {
+        m_data.remove(index);
+    }
     data.lastModified = Clock::currentDateTimeUtc();
-    m_data.insert(newKey, data);
+    m_data.append({internKey(newKey), data});
 
     updateLastModified();
     emitModified();
@@ -157,15 +222,16 @@ void CustomData::copyDataFrom(const CustomData* other)
 
 QDateTime CustomData::lastModified() const
 {
-    if (m_data.contains(LastModified)) {
-        return Clock::parse(m_data.value(LastModified).value);
+    const int index = indexOf(LastModified);
+    if (index >= 0) {
+        return Clock::parse(m_data.at(index).data.value);
     }
 
     // Try to find the latest modification time in items as a fallback
     QDateTime modified;
-    for (auto i = m_data.constBegin(); i != m_data.constEnd(); ++i) {
-        if (i->lastModified.isValid() && (!modified.isValid() || i->lastModified > modified)) {
-            modified = i->lastModified;
+    for (const auto& item : m_data) {
+        if (item.data.lastModified.isValid() && (!modified.isValid() || item.data.lastModified > modified)) {
+            modified = item.data.lastModified;
         }
     }
     return modified;
@@ -173,20 +239,27 @@ QDateTime CustomData::lastModified() const
 
 QDateTime CustomData::lastModified(const QString& key) const
 {
-    return m_data.value(key).lastModified;
+    const int index = indexOf(key);
+    return index >= 0 ? m_data.at(index).data.lastModified : QDateTime();
 }
 
 void CustomData::updateLastModified(QDateTime lastModified)
 {
-    if (m_data.isEmpty() || (m_data.size() == 1 && m_data.contains(LastModified))) {
-        m_data.remove(LastModified);
+    const int index = indexOf(LastModified);
+    if (m_data.isEmpty() || (m_data.size() == 1 && index == 0)) {
+        m_data.clear();
         return;
     }
 
     if (!lastModified.isValid()) {
         lastModified = Clock::currentDateTimeUtc();
     }
-    m_data.insert(LastModified, {lastModified.toString(), QDateTime()});
+    CustomDataItem item{lastModified.toString(), QDateTime()};
+    if (index >= 0) {
+        m_data[index].data = item;
+    } else {
+        m_data.append({LastModified, item});
+    }
 }
 
 bool CustomData::isProtected(const QString& key) const
@@ -202,12 +275,27 @@ bool CustomData::isAutoGenerated(const QString& key) const
 
 bool CustomData::operator==(const CustomData& other) const
 {
-    return (m_data == other.m_data);
+    if (m_data.size() != other.m_data.size()) {
+        return false;
+    }
+    // Copies share their items
+    if (m_data.constData() == other.m_data.constData()) {
+        return true;
+    }
+
+    // The order of the items does not matter
+    for (const auto& item : m_data) {
+        const int index = other.indexOf(item.key);
+        if (index < 0 || !(other.m_data.at(index).data == item.data)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool CustomData::operator!=(const CustomData& other) const
 {
-    return (m_data != other.m_data);
+    return !(*this == other);
 }
 
 void CustomData::clear()
@@ -234,15 +322,12 @@ int CustomData::dataSize() const
 {
     int size = 0;
 
-    QHashIterator<QString, CustomDataItem> i(m_data);
-    while (i.hasNext()) {
-        i.next();
-
+    for (const auto& item : m_data) {
         // In theory, we should be adding the datetime string size as well, but it makes
         // length calculations rather unpredictable. We also don't know if this instance
         // is entry/group-level CustomData or global CustomData (the only CustomData that
         // actually retains the datetime in the KDBX file).
-        size += i.key().toUtf8().size() + i.value().value.toUtf8().size();
+        size += item.key.toUtf8().size() + item.data.value.toUtf8().size();
     }
     return size;
 }
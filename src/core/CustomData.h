@@ -19,8 +19,8 @@
 #define KEEPASSXC_CUSTOMDATA_H
 
 #include <QDateTime>
-#include <QHash>
 #include <QObject>
+#include <QVector>
 
 #include "core/ModifiableObject.h"
 
@@ -79,6 +79,7 @@ public:
 signals:
     void aboutToBeAdded(const QString& key);
     void added(const QString& key);
+    void valueChanged(const QString& key);
     void aboutToBeRemoved(const QString& key);
     void removed(const QString& key);
     void aboutToRename(const QString& oldKey, const QString& newKey);
@@ -90,7 +91,17 @@ private slots:
     void updateLastModified(QDateTime lastModified = {});
 
 private:
-    QHash<QString, CustomDataItem> m_data;
+    struct Item
+    {
+        QString key;
+        CustomDataItem data;
+    };
+
+    int indexOf(const QString& key) const;
+
+    // Objects hold only a few items, which are scanned faster than they are hashed,
+    // the vector is shared with clones until one of them changes
+    QVector<Item> m_data;
 };
 
 #endif // KEEPASSXC_CUSTOMDATA_H
@@ -19,31 +19,356 @@
 #include "Database.h"
 
 #include "core/AsyncTask.h"
+#include "core/EntryAttachments.h"
+#include "core/EntryReferenceIndex.h"
+#include "core/EntrySearchIndex.h"
+#include "core/EntryTagIndex.h"
 #include "core/FileWatcher.h"
 #include "core/Group.h"
+#include "core/PasswordHealth.h"
+#include "core/PerformanceStats.h"
 #include "crypto/Random.h"
+#include "format/KdbxJournal.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
+#include "streams/EdgeRecordingStream.h"
 
+#include <QBuffer>
+#include <QDir>
 #include <QFileInfo>
 #include <QJsonObject>
 #include <QRegularExpression>
 #include <QSaveFile>
+#include <QStorageInfo>
 #include <QTemporaryFile>
 #include <QTimer>
+#include <QtConcurrent>
+
+#include <cstdio>
+#include <limits>
 
 #ifdef Q_OS_WIN
 #include <Windows.h>
+#include <io.h>
+#elif defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#elif defined(Q_OS_MACOS)
+#include <sys/clonefile.h>
+#endif
+
+namespace
+{
+#ifdef Q_OS_WIN
+    // Smaller files take only a handful of read() calls
+    const qint64 MinimumMappedFileSize = 1024 * 1024;
+#endif
+    // Directories of coalesced saves following each other within this time are synced to disk only once
+    const int CoalescedSyncDelayMs = 5000;
+
+    /**
+     * Map a database file into memory if it cannot be truncated while it is being read.
+     *
+     * Accessing the pages of a mapping past the end of a truncated file crashes the
+     * application on any file system. Only Windows refuses to truncate a file that is
+     * mapped and only for local drives, all other files are read normally.
+     *
+     * @param file file opened for reading
+     * @return pointer to the mapped file contents or nullptr
+     */
+    uchar* mapLocalFile(QFile& file)
+    {
+#ifdef Q_OS_WIN
+        const qint64 size = file.size();
+        if (size < MinimumMappedFileSize || size > std::numeric_limits<int>::max()) {
+            return nullptr;
+        }
+
+        QStorageInfo storage(file.fileName());
+        if (!storage.isValid() || file.fileName().startsWith("//") || file.fileName().startsWith("\\\\")) {
+            return nullptr;
+        }
+        if (GetDriveTypeW(reinterpret_cast<LPCWSTR>(storage.rootPath().utf16())) != DRIVE_FIXED) {
+            return nullptr;
+        }
+        return file.map(0, size);
+#else
+        Q_UNUSED(file)
+        return nullptr;
+#endif
+    }
+
+    /**
+     * Rename a file over another one, which replaces it atomically where the file system allows it.
+     *
+     * @return true on success
+     */
+    bool renameOverFile(const QString& filePath, const QString& destinationFilePath)
+    {
+#ifdef Q_OS_WIN
+        return MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(filePath).utf16()),
+                           reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(destinationFilePath).utf16()),
+                           MOVEFILE_REPLACE_EXISTING)
+               != 0;
+#else
+        return std::rename(QFile::encodeName(filePath).constData(), QFile::encodeName(destinationFilePath).constData())
+               == 0;
+#endif
+    }
+
+    /**
+     * Flush the contents of an open file to disk.
+     *
+     * @return true on success
+     */
+    bool syncFileContents(QFile& file)
+    {
+#ifdef Q_OS_WIN
+        return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()))) != 0;
+#elif defined(Q_OS_UNIX)
+        return ::fsync(file.handle()) == 0;
+#else
+        return file.flush();
+#endif
+    }
+
+    /**
+     * Flush the entries of a directory to disk, a rename within it only survives a crash afterwards.
+     *
+     * @return true on success or if the file system does not need it
+     */
+    bool syncDirectory(const QString& dirPath)
+    {
+#ifdef Q_OS_UNIX
+        int dir = ::open(QFile::encodeName(dirPath).constData(), O_RDONLY | O_CLOEXEC);
+        if (dir < 0) {
+            return false;
+        }
+        bool ok = ::fsync(dir) == 0;
+        ::close(dir);
+        return ok;
+#else
+        Q_UNUSED(dirPath)
+        return true;
 #endif
+    }
+
+    enum class BackupLink
+    {
+        None,
+        Clone,
+        HardLink
+    };
+
+    /**
+     * Create a copy-on-write clone of a file, which shares all data blocks with the
+     * original until one of them is written, on btrfs, XFS, APFS and similar.
+     *
+     * @return true if the file system supports clones and the clone was created
+     */
+    bool cloneFile(const QString& filePath, const QString& clonePath)
+    {
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+        int source = ::open(QFile::encodeName(filePath).constData(), O_RDONLY | O_CLOEXEC);
+        if (source < 0) {
+            return false;
+        }
+        int clone = ::open(QFile::encodeName(clonePath).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (clone < 0) {
+            ::close(source);
+            return false;
+        }
+        bool ok = ::ioctl(clone, FICLONE, source) == 0;
+        ::close(source);
+        ::close(clone);
+        if (!ok) {
+            QFile::remove(clonePath);
+        }
+        return ok;
+#elif defined(Q_OS_MACOS)
+        return ::clonefile(QFile::encodeName(filePath).constData(), QFile::encodeName(clonePath).constData(), 0) == 0;
+#else
+        Q_UNUSED(filePath)
+        Q_UNUSED(clonePath)
+        return false;
+#endif
+    }
+
+    bool linkFile(const QString& filePath, const QString& linkPath)
+    {
+#ifdef Q_OS_UNIX
+        return ::link(QFile::encodeName(filePath).constData(), QFile::encodeName(linkPath).constData()) == 0;
+#else
+        Q_UNUSED(filePath)
+        Q_UNUSED(linkPath)
+        return false;
+#endif
+    }
+
+    /**
+     * Replace the previous backup with a clone or a hard link of the file.
+     *
+     * The new backup is created next to the previous one and renamed over it,
+     * so there is a backup at all times.
+     *
+     * @param allowHardLink the file is replaced instead of written in place when saving,
+     *        so the backup may share it until then
+     * @return how the backup was created, None if the file has to be copied
+     */
+    BackupLink linkBackup(const QString& filePath, const QString& destinationFilePath, bool allowHardLink)
+    {
+#ifdef Q_OS_UNIX
+        const auto tempFilePath = destinationFilePath + QStringLiteral(".tmp");
+        QFile::remove(tempFilePath);
+
+        auto link = BackupLink::None;
+        if (cloneFile(filePath, tempFilePath)) {
+            QFile::setPermissions(tempFilePath, QFile::permissions(filePath));
+            link = BackupLink::Clone;
+        } else if (allowHardLink && linkFile(filePath, tempFilePath)) {
+            link = BackupLink::HardLink;
+        }
+        if (link == BackupLink::None) {
+            return link;
+        }
+
+        // Unlike QFile::rename(), rename() replaces an existing file atomically
+        if (std::rename(QFile::encodeName(tempFilePath).constData(),
+                        QFile::encodeName(destinationFilePath).constData())
+            != 0) {
+            QFile::remove(tempFilePath);
+            return BackupLink::None;
+        }
+        return link;
+#else
+        Q_UNUSED(filePath)
+        Q_UNUSED(destinationFilePath)
+        Q_UNUSED(allowHardLink)
+        return BackupLink::None;
+#endif
+    }
+
+    bool createBackupDirectory(const QString& destinationFilePath)
+    {
+        auto parentDirectory = QFileInfo(destinationFilePath).absoluteDir();
+        return parentDirectory.exists() || QDir().mkpath(parentDirectory.absolutePath());
+    }
+
+    // Entries and groups deleted per event loop pass when a detached subtree is deleted
+    const int DeleteChunkSize = 500;
+
+    /**
+     * Delete a group that is no longer part of a database, scrubbing the memory of many
+     * entries takes a while and the event loop keeps running in between chunks.
+     *
+     * @param trash detached group to delete
+     */
+    void deleteInChunks(Group* trash)
+    {
+        auto app = QCoreApplication::instance();
+        if (!app || QThread::currentThread() != app->thread()) {
+            delete trash;
+            return;
+        }
+
+        for (int deleted = 0; deleted < DeleteChunkSize; ++deleted) {
+            // Delete from the end of the deepest group, so removing items from the lists is cheap
+            Group* group = trash;
+            while (group->hasChildren()) {
+                group = group->children().last();
+            }
+            if (!group->entries().isEmpty()) {
+                delete group->entries().last();
+            } else if (group != trash) {
+                delete group;
+            } else {
+                delete trash;
+                return;
+            }
+        }
+        QTimer::singleShot(0, trash, [trash] { deleteInChunks(trash); });
+    }
+
+    /**
+     * Destroy a tree that is no longer connected to a database on a worker thread,
+     * without notifying anyone of the destruction of its groups and entries.
+     *
+     * @param root detached group to destroy
+     */
+    void destroyInBackground(Group* root)
+    {
+        QList<QObject*> objects{root};
+        root->forEachEntryRecursive([&objects](const Entry* entry) {
+            for (auto* historyItem : entry->historyItems()) {
+                if (!historyItem->parent()) {
+                    objects.append(historyItem);
+                }
+            }
+            return true;
+        });
+
+        // Objects without a thread affinity can be pulled into the worker thread
+        for (auto* object : asConst(objects)) {
+            object->blockSignals(true);
+            for (auto* child : object->findChildren<QObject*>()) {
+                child->blockSignals(true);
+            }
+            object->moveToThread(nullptr);
+        }
+        QtConcurrent::run([root, objects] {
+            for (auto* object : objects) {
+                object->moveToThread(QThread::currentThread());
+            }
+            delete root;
+        });
+    }
+
+    /**
+     * Copy a group with all entries and subgroups.
+     *
+     * Unlike Group::clone() the time info stays untouched, as the merge relies on it.
+     * The copy does not update its time info until it is turned on again.
+     */
+    Group* copyGroupTree(const Group* group)
+    {
+        auto copy = group->clone(Entry::CloneNoFlags, Group::CloneNoFlags);
+        copy->setUpdateTimeinfo(false);
+        for (const Entry* entry : group->entries()) {
+            auto entryCopy = entry->clone(Entry::CloneIncludeHistory);
+            entryCopy->setUpdateTimeinfo(false);
+            entryCopy->setGroup(copy);
+            entryCopy->setUpdateTimeinfo(true);
+        }
+        for (const Group* child : group->children()) {
+            auto childCopy = copyGroupTree(child);
+            childCopy->setParent(copy);
+            childCopy->setUpdateTimeinfo(true);
+        }
+        return copy;
+    }
+} // namespace
 
 QHash<QUuid, QPointer<Database>> Database::s_uuidMap;
+QMutex Database::s_uuidMapMutex;
 
 Database::Database()
     : m_metadata(new Metadata(this))
+    , m_searchIndex(new EntrySearchIndex(this))
+    , m_tagIndex(new EntryTagIndex(this))
     , m_data()
     , m_rootGroup(nullptr)
+    // Moves along with the database to another thread
+    , m_modifiedTimer(this)
+    , m_syncTimer(this)
     , m_fileWatcher(new FileWatcher(this))
+    , m_journal(new KdbxJournal())
+    , m_referenceIndex(new EntryReferenceIndex())
+    , m_passwordEntropyCache(new PasswordEntropyCache())
     , m_uuid(QUuid::createUuid())
 {
     // setup modified timer
@@ -54,19 +379,28 @@ Database::Database()
         }
     });
     connect(&m_modifiedTimer, &QTimer::timeout, this, &Database::emitModified);
+    m_syncTimer.setSingleShot(true);
+    connect(&m_syncTimer, &QTimer::timeout, this, &Database::syncPendingSave);
 
     // other signals
     connect(m_metadata, &Metadata::modified, this, &Database::markAsModified);
     connect(this, &Database::databaseOpened, this, [this]() {
+        // Entries are changed without modified signals while reading and replaying the journal
+        m_referenceIndex->invalidate();
+        ++m_dataRevision;
         updateCommonUsernames();
-        updateTagList();
     });
-    connect(this, &Database::modified, this, [this] { updateTagList(); });
+    connect(m_tagIndex, &EntryTagIndex::tagAdded, this, &Database::tagAdded);
+    connect(m_tagIndex, &EntryTagIndex::tagRemoved, this, &Database::tagRemoved);
+    connect(m_tagIndex, &EntryTagIndex::tagsReset, this, &Database::tagListUpdated);
     connect(this, &Database::databaseSaved, this, [this]() { updateCommonUsernames(); });
     connect(m_fileWatcher, &FileWatcher::fileChanged, this, &Database::databaseFileChanged);
 
-    // static uuid map
-    s_uuidMap.insert(m_uuid, this);
+    // static uuid map, databases may be created in worker threads while reading them
+    {
+        QMutexLocker locker(&s_uuidMapMutex);
+        s_uuidMap.insert(m_uuid, this);
+    }
 
     // block modified signal and set root group
     setEmitModified(false);
@@ -123,10 +457,35 @@ bool Database::open(QSharedPointer<const CompositeKey> key, QString* error)
  * @param filePath path to the file
  * @param key composite key for unlocking the database
  * @param error error message in case of failure
+ * @param flags options for reading the database
+ * @return true on success
+ */
+bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey> key, QString* error, OpenFlags flags)
+{
+    return open(filePath, QByteArray(), std::move(key), error, flags);
+}
+
+/**
+ * Open the database from the contents of a file that were read in advance.
+ *
+ * The file itself is still opened, it is only read when the contents are
+ * empty or attachments are deferred.
+ *
+ * @param filePath path to the file
+ * @param fileData contents of the file, may be empty
+ * @param key composite key for unlocking the database
+ * @param error error message in case of failure
+ * @param flags options for reading the database
  * @return true on success
  */
-bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey> key, QString* error)
+bool Database::open(const QString& filePath,
+                    const QByteArray& fileData,
+                    QSharedPointer<const CompositeKey> key,
+                    QString* error,
+                    OpenFlags flags)
 {
+    PerformanceStats::ScopedTimer timer("database.open");
+
     QFile dbFile(filePath);
     if (!dbFile.exists()) {
         if (error) {
@@ -151,8 +510,39 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
 
     setEmitModified(false);
 
+    if (flags.testFlag(ReadOnly)) {
+        flags |= DeferAttachments;
+    }
+
+    // Read local files straight from the page cache instead of through read() calls where they cannot
+    // be truncated meanwhile, deferred attachments are re-read from the file later and need the file itself
+    QIODevice* device = &dbFile;
+    QBuffer mappedFile;
+    const bool readFromMemory = !fileData.isEmpty() && !flags.testFlag(DeferAttachments);
+    uchar* mappedData = flags.testFlag(DeferAttachments) || readFromMemory ? nullptr : mapLocalFile(dbFile);
+    if (readFromMemory) {
+        mappedFile.setData(fileData);
+        mappedFile.open(QIODevice::ReadOnly);
+        device = &mappedFile;
+    } else if (mappedData) {
+        mappedFile.setData(
+            QByteArray::fromRawData(reinterpret_cast<const char*>(mappedData), static_cast<int>(dbFile.size())));
+        mappedFile.open(QIODevice::ReadOnly);
+        device = &mappedFile;
+    }
+
     KeePass2Reader reader;
-    if (!reader.readDatabase(&dbFile, std::move(key), this)) {
+    reader.setDeferAttachments(flags.testFlag(DeferAttachments));
+    reader.setSkipHistory(flags.testFlag(ReadOnly));
+    bool ok = reader.readDatabase(device, std::move(key), this);
+
+    if (mappedData) {
+        mappedFile.close();
+        mappedFile.setData(QByteArray());
+        dbFile.unmap(mappedData);
+    }
+
+    if (!ok) {
         if (error) {
             *error = tr("Error while reading the database: %1").arg(reader.errorString());
         }
@@ -161,11 +551,25 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
 
     setFilePath(filePath);
     dbFile.close();
+    m_readOnly = flags.testFlag(ReadOnly);
+
+    // Merge changes that were journaled after the file was last written
+    bool journalReplayed = false;
+    if (!m_data.transformedDatabaseKey->rawKey().isEmpty()) {
+        journalReplayed = m_journal->replay(canonicalFilePath(), this);
+    }
 
     markAsClean();
+    if (journalReplayed) {
+        // The file itself does not contain the replayed changes yet
+        m_modified = true;
+    }
 
     emit databaseOpened();
-    m_fileWatcher->start(canonicalFilePath(), 30, 1);
+    // Read-only databases are not kept open long enough to reload them
+    if (!m_readOnly) {
+        m_fileWatcher->start(canonicalFilePath(), 30, 1);
+    }
     setEmitModified(true);
 
     return true;
@@ -192,6 +596,15 @@ bool Database::hasMinorVersionMismatch() const
     return m_data.formatVersion > KeePass2::FILE_VERSION_MAX;
 }
 
+/**
+ * Whether the database was opened with the ReadOnly flag, which leaves out
+ * the history and refuses to save.
+ */
+bool Database::isReadOnly() const
+{
+    return m_readOnly;
+}
+
 bool Database::isSaving()
 {
     bool locked = m_saveMutex.tryLock();
@@ -244,6 +657,16 @@ bool Database::save(SaveAction action, const QString& backupFilePath, QString* e
  */
 bool Database::saveAs(const QString& filePath, SaveAction action, const QString& backupFilePath, QString* error)
 {
+    PerformanceStats::ScopedTimer timer("database.save");
+
+    // The history was not read, saving would drop it
+    if (m_readOnly) {
+        if (error) {
+            *error = tr("Could not save, the database was opened read-only.");
+        }
+        return false;
+    }
+
     // Disallow overlapping save operations
     if (isSaving()) {
         if (error) {
@@ -289,10 +712,30 @@ bool Database::saveAs(const QString& filePath, SaveAction action, const QString&
     bool isHidden = fileInfo.isHidden();
 #endif
 
-    bool ok = AsyncTask::runAndWaitForFuture([&] { return performSave(realFilePath, action, backupFilePath, error); });
+    // Serialize the database here, so it may be modified while the file is written
+    KeePass2Writer writer;
+    if (!snapshotDatabase(writer, error)) {
+        markAsModified();
+        return false;
+    }
+    const auto revision = m_dataRevision;
+
+    WrittenFile writtenFile;
+    bool ok = AsyncTask::runAndWaitForFuture(
+        [&] { return performSave(realFilePath, action, backupFilePath, writer, writtenFile, error); });
     if (ok) {
         setFilePath(filePath);
-        markAsClean();
+        if (m_dataRevision == revision) {
+            markAsClean();
+            m_journal->reset(canonicalFilePath(), this);
+        } else {
+            // Changes made while the file was written are left for the next full save
+            m_journal->reset(canonicalFilePath(), this);
+            m_journal->clear();
+            if (modifiedSignalEnabled()) {
+                startModifiedTimer();
+            }
+        }
         if (isNewFile) {
             QFile::setPermissions(realFilePath, QFile::ReadUser | QFile::WriteUser);
         }
@@ -303,7 +746,12 @@ bool Database::saveAs(const QString& filePath, SaveAction action, const QString&
         }
 #endif
 
-        m_fileWatcher->start(realFilePath, 30, 1);
+        if (action == Coalesced) {
+            m_pendingSyncPath = QFileInfo(realFilePath).absolutePath();
+            m_syncTimer.start(CoalescedSyncDelayMs);
+        }
+
+        m_fileWatcher->start(realFilePath, 30, 1, writtenFile);
     } else {
         // Saving failed, don't rewatch file since it does not represent our database
         markAsModified();
@@ -312,12 +760,107 @@ bool Database::saveAs(const QString& filePath, SaveAction action, const QString&
     return ok;
 }
 
-bool Database::performSave(const QString& filePath, SaveAction action, const QString& backupFilePath, QString* error)
+/**
+ * Append the entry and group changes made since the last save to the save journal
+ * next to the database file instead of rewriting the whole file. The database stays
+ * modified until it is saved in full, which discards the journal.
+ *
+ * @param error error message in case of failure
+ * @return true on success, false if the changes require a full save
+ */
+bool Database::saveToJournal(QString* error)
 {
+    if (m_readOnly) {
+        if (error) {
+            *error = tr("Could not save, the database was opened read-only.");
+        }
+        return false;
+    }
+
+    if (isSaving()) {
+        if (error) {
+            *error = tr("Database save is already in progress.");
+        }
+        return false;
+    }
+
+    if (!isInitialized() || m_data.filePath.isEmpty()) {
+        if (error) {
+            *error = tr("Could not save, database has not been initialized!");
+        }
+        return false;
+    }
+
+    QMutexLocker locker(&m_saveMutex);
+    return m_journal->append(this, error);
+}
+
+/**
+ * Delete the save journal, e.g. when the unsaved changes are discarded.
+ */
+void Database::discardJournal()
+{
+    m_journal->discard();
+}
+
+/**
+ * @return path of a save journal that did not match the file when it was opened and was not replayed
+ */
+QString Database::keptJournalFilePath() const
+{
+    return m_journal->keptJournalFilePath();
+}
+
+bool Database::performSave(const QString& filePath,
+                           SaveAction action,
+                           const QString& backupFilePath,
+                           KeePass2Writer& writer,
+                           WrittenFile& writtenFile,
+                           QString* error)
+{
+    QFuture<bool> backup;
+    auto backupLink = BackupLink::None;
     if (!backupFilePath.isNull()) {
+        if (action == DirectWrite) {
+            // The file is written in place, so the backup has to be complete before
+            backupDatabase(filePath, backupFilePath);
+        } else if (createBackupDirectory(backupFilePath)) {
+            backupLink = linkBackup(filePath, backupFilePath, true);
+            if (backupLink == BackupLink::None) {
+                // The file is only replaced once the new one is written, copy it in the meantime
+                backup = QtConcurrent::run([this, filePath, backupFilePath] {
+                    return backupDatabase(filePath, backupFilePath);
+                });
+            }
+        }
+    }
+
+    bool ok = replaceDatabaseFile(filePath, action, backupFilePath, writer, backup, writtenFile, error);
+    backup.waitForFinished();
+    if (!ok && backupLink == BackupLink::HardLink) {
+        // The file was not replaced and must not keep sharing its data with the backup
         backupDatabase(filePath, backupFilePath);
     }
+    return ok;
+}
 
+/**
+ * Write the snapshot of the database and replace the file with it.
+ *
+ * @param writer writer holding the snapshot
+ * @param backup backup of the file that is still being copied, it has to finish
+ *        before the file is replaced
+ * @param writtenFile receives the start and the end of the written file
+ * @return true on success
+ */
+bool Database::replaceDatabaseFile(const QString& filePath,
+                                   SaveAction action,
+                                   const QString& backupFilePath,
+                                   KeePass2Writer& writer,
+                                   QFuture<bool> backup,
+                                   WrittenFile& writtenFile,
+                                   QString* error)
+{
     QFileInfo info(filePath);
     auto createTime = info.exists() ? info.birthTime() : QDateTime::currentDateTime();
 
@@ -326,13 +869,14 @@ bool Database::performSave(const QString& filePath, SaveAction action, const QSt
         QSaveFile saveFile(filePath);
         if (saveFile.open(QIODevice::WriteOnly)) {
             // write the database to the file
-            if (!writeDatabase(&saveFile, error)) {
+            if (!writeDatabase(&saveFile, writer, writtenFile, error)) {
                 return false;
             }
 
             // Retain original creation time
             saveFile.setFileTime(createTime, QFile::FileBirthTime);
 
+            backup.waitForFinished();
             if (saveFile.commit()) {
                 // successfully saved database file
                 return true;
@@ -348,12 +892,13 @@ bool Database::performSave(const QString& filePath, SaveAction action, const QSt
         QTemporaryFile tempFile;
         if (tempFile.open()) {
             // write the database to the file
-            if (!writeDatabase(&tempFile, error)) {
+            if (!writeDatabase(&tempFile, writer, writtenFile, error)) {
                 return false;
             }
             tempFile.close(); // flush to disk
 
             // Delete the original db and move the temp file in place
+            backup.waitForFinished();
             auto perms = QFile::permissions(filePath);
             QFile::remove(filePath);
 
@@ -383,11 +928,49 @@ bool Database::performSave(const QString& filePath, SaveAction action, const QSt
         }
         break;
     }
+    case Coalesced: {
+        // Written next to the file, so it can be renamed over it
+        QTemporaryFile tempFile(filePath + QStringLiteral(".XXXXXX"));
+        if (tempFile.open()) {
+            if (!writeDatabase(&tempFile, writer, writtenFile, error)) {
+                return false;
+            }
+            // The contents are on disk before the rename, only syncing the directory is deferred,
+            // see syncPendingSave()
+            if (!tempFile.flush() || !syncFileContents(tempFile)) {
+                if (error) {
+                    *error = tempFile.errorString();
+                }
+                return false;
+            }
+            // Retain original creation time
+            tempFile.setFileTime(createTime, QFile::FileBirthTime);
+            tempFile.close();
+
+            backup.waitForFinished();
+            if (info.exists()) {
+                QFile::setPermissions(tempFile.fileName(), QFile::permissions(filePath));
+            }
+            if (renameOverFile(tempFile.fileName(), filePath)) {
+                tempFile.setAutoRemove(false);
+                return true;
+            }
+            if (error) {
+                *error = tr("Could not replace %1 with the saved database.").arg(filePath);
+            }
+            return false;
+        }
+
+        if (error) {
+            *error = tempFile.errorString();
+        }
+        break;
+    }
     case DirectWrite: {
         // Open the original database file for direct-write
         QFile dbFile(filePath);
         if (dbFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            if (!writeDatabase(&dbFile, error)) {
+            if (!writeDatabase(&dbFile, writer, writtenFile, error)) {
                 return false;
             }
             dbFile.close();
@@ -404,7 +987,71 @@ bool Database::performSave(const QString& filePath, SaveAction action, const QSt
     return false;
 }
 
-bool Database::writeDatabase(QIODevice* device, QString* error)
+/**
+ * Serialize the database for a save, the database may change once this returns.
+ *
+ * @param writer writer to keep the snapshot until writeDatabase()
+ * @param error error message in case of failure
+ * @return true on success
+ */
+bool Database::snapshotDatabase(KeePass2Writer& writer, QString* error)
+{
+    // Deferred attachments have to be read before the file gets replaced
+    if (!loadDeferredAttachments(error)) {
+        return false;
+    }
+
+    setEmitModified(false);
+    writer.snapshotDatabase(this);
+    setEmitModified(true);
+
+    if (writer.hasError()) {
+        if (error) {
+            *error = writer.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Load the deferred attachments of all entries and history items into memory.
+ *
+ * Attachments that cannot be read anymore, e.g. because the file was changed on disk,
+ * would otherwise be written empty.
+ *
+ * @param error error message in case of failure
+ * @return true if no attachment is deferred anymore
+ */
+bool Database::loadDeferredAttachments(QString* error)
+{
+    // The attachments of this file are read in one pass
+    if (m_attachmentLoader) {
+        m_attachmentLoader->prefetchAll();
+    }
+
+    QString loadError;
+    bool ok = true;
+    if (m_rootGroup) {
+        ok = m_rootGroup->forEachEntryRecursive(
+            [&loadError](const Entry* entry) { return entry->attachments()->loadDeferred(&loadError); }, true);
+    }
+
+    if (m_attachmentLoader) {
+        m_attachmentLoader->releasePrefetched();
+        if (ok) {
+            // No attachment refers to the file anymore
+            m_attachmentLoader.reset();
+        }
+    }
+
+    if (!ok && error) {
+        *error = loadError;
+    }
+    return ok;
+}
+
+bool Database::writeDatabase(QIODevice* device, KeePass2Writer& writer, WrittenFile& writtenFile, QString* error)
 {
     Q_ASSERT(m_data.key);
     Q_ASSERT(m_data.transformedDatabaseKey);
@@ -414,11 +1061,10 @@ bool Database::writeDatabase(QIODevice* device, QString* error)
         oldTransformedKey.setRawKey(m_data.transformedDatabaseKey->rawKey());
     }
 
-    KeePass2Writer writer;
-    setEmitModified(false);
-    writer.writeDatabase(device, this);
-    setEmitModified(true);
-
+    // Keeps the start and the end of the file, so the file watcher does not read it again
+    EdgeRecordingStream recorder(device, FileWatcher::EdgeSize);
+    recorder.open(QIODevice::WriteOnly);
+    writer.writeDatabase(&recorder, this);
     if (writer.hasError()) {
         if (error) {
             *error = writer.errorString();
@@ -436,13 +1082,55 @@ bool Database::writeDatabase(QIODevice* device, QString* error)
         return false;
     }
 
+    writtenFile.size = recorder.writtenSize();
+    writtenFile.head = recorder.head();
+    writtenFile.tail = recorder.tail();
     return true;
 }
 
+/**
+ * Sync the directory of the last coalesced save to disk, which makes the renamed file durable.
+ *
+ * Syncing a directory takes little time, it is done right away instead of on a worker thread,
+ * which would have to keep the database alive while the event loop runs.
+ */
+void Database::syncPendingSave()
+{
+    m_syncTimer.stop();
+    if (m_pendingSyncPath.isEmpty()) {
+        return;
+    }
+
+    const auto dirPath = m_pendingSyncPath;
+    m_pendingSyncPath.clear();
+    if (!syncDirectory(dirPath)) {
+        qWarning("Database::syncPendingSave: Failed to sync %s to disk", qPrintable(dirPath));
+    }
+}
+
 bool Database::extract(QByteArray& xmlOutput, QString* error)
 {
+    QBuffer buffer(&xmlOutput);
+    buffer.open(QIODevice::WriteOnly);
+    return extract(&buffer, error);
+}
+
+/**
+ * Write the unprotected XML of the database to a device while the groups are traversed.
+ *
+ * @param device output device
+ * @param error receives the error message on failure
+ * @return true on success
+ */
+bool Database::extract(QIODevice* device, QString* error)
+{
+    if (!loadDeferredAttachments(error)) {
+        return false;
+    }
+
     KeePass2Writer writer;
-    writer.extractDatabase(this, xmlOutput);
+    writer.extractDatabase(this, device);
+
     if (writer.hasError()) {
         if (error) {
             *error = writer.errorString();
@@ -455,11 +1143,27 @@ bool Database::extract(QByteArray& xmlOutput, QString* error)
 
 bool Database::import(const QString& xmlExportPath, QString* error)
 {
-    KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
     QFile file(xmlExportPath);
-    file.open(QIODevice::ReadOnly);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return import(&file, error);
+}
 
-    reader.readDatabase(&file, this);
+/**
+ * Read the entries of an unprotected XML export, parsing it as it is read from the device.
+ *
+ * @param device input device
+ * @param error receives the error message on failure
+ * @return true on success
+ */
+bool Database::import(QIODevice* device, QString* error)
+{
+    KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
+    reader.readDatabase(device, this);
 
     if (reader.hasError()) {
         if (error) {
@@ -480,20 +1184,35 @@ bool Database::import(const QString& xmlExportPath, QString* error)
  * A previously reparented root group will not be freed.
  */
 
-void Database::releaseData()
+/**
+ * Release the contents of the database, leaving an empty database behind.
+ *
+ * Key material is cleared right away. The groups and entries can be torn down on a
+ * worker thread, in which case they are destroyed without emitting any signals, so
+ * nothing but the database may refer to them anymore.
+ *
+ * @param teardownInBackground destroy the groups and entries on a worker thread
+ */
+void Database::releaseData(bool teardownInBackground)
 {
     // Prevent data release while saving
     Q_ASSERT(!isSaving());
     QMutexLocker locker(&m_saveMutex);
 
-    if (m_modified) {
+    // A coalesced save must reach the disk before the database goes away
+    syncPendingSave();
+
+    if (m_modified && !teardownInBackground) {
         emit databaseDiscarded();
     }
 
     setEmitModified(false);
     m_modified = false;
 
-    s_uuidMap.remove(m_uuid);
+    {
+        QMutexLocker uuidMapLocker(&s_uuidMapMutex);
+        s_uuidMap.remove(m_uuid);
+    }
     m_uuid = QUuid();
 
     m_data.clear();
@@ -501,18 +1220,31 @@ void Database::releaseData()
 
     // Reset and delete the root group
     auto oldGroup = setRootGroup(new Group());
-    delete oldGroup;
+    if (teardownInBackground && QCoreApplication::instance()) {
+        // Indexes drop the old entries while they still exist
+        emit databaseDiscarded();
+        static_cast<QObject*>(oldGroup)->setParent(nullptr);
+        oldGroup->setDatabaseRecursive(nullptr);
+        destroyInBackground(oldGroup);
+    } else {
+        delete oldGroup;
+    }
 
     m_fileWatcher->stop();
 
     m_deletedObjects.clear();
+    m_deletedObjectCounts.clear();
     m_commonUsernames.clear();
-    m_tagList.clear();
+    m_attachmentLoader.reset();
+    m_journal->clear();
+    m_passwordEntropyCache->clear();
+    m_readOnly = false;
 }
 
 /**
  * Remove the old backup and replace it with a new one. Backup name is taken from destinationFilePath.
- * Non-existing parent directories will be created automatically.
+ * Non-existing parent directories will be created automatically. The backup is a copy-on-write
+ * clone where the file system supports it, a copy otherwise.
  *
  * @param filePath Path to the file to backup
  * @param destinationFilePath Path to the backup destination file
@@ -521,15 +1253,15 @@ void Database::releaseData()
 bool Database::backupDatabase(const QString& filePath, const QString& destinationFilePath)
 {
     // Ensure that the path to write to actually exists
-    auto parentDirectory = QFileInfo(destinationFilePath).absoluteDir();
-    if (!parentDirectory.exists()) {
-        if (!QDir().mkpath(parentDirectory.absolutePath())) {
-            return false;
-        }
+    if (!createBackupDirectory(destinationFilePath)) {
+        return false;
     }
     auto perms = QFile::permissions(filePath);
-    QFile::remove(destinationFilePath);
-    bool res = QFile::copy(filePath, destinationFilePath);
+    bool res = linkBackup(filePath, destinationFilePath, false) != BackupLink::None;
+    if (!res) {
+        QFile::remove(destinationFilePath);
+        res = QFile::copy(filePath, destinationFilePath);
+    }
     QFile::setPermissions(destinationFilePath, perms);
     return res;
 }
@@ -592,6 +1324,9 @@ Group* Database::setRootGroup(Group* group)
     auto oldRoot = m_rootGroup;
     m_rootGroup = group;
     m_rootGroup->setParent(this);
+    m_referenceIndex->invalidate();
+    m_tagIndex->clear();
+    ++m_dataRevision;
 
     // Initialize the root group if not done already
     if (m_rootGroup->uuid().isNull()) {
@@ -660,22 +1395,12 @@ const QList<DeletedObject>& Database::deletedObjects() const
 
 bool Database::containsDeletedObject(const QUuid& uuid) const
 {
-    for (const DeletedObject& currentObject : m_deletedObjects) {
-        if (currentObject.uuid == uuid) {
-            return true;
-        }
-    }
-    return false;
+    return m_deletedObjectCounts.contains(uuid);
 }
 
 bool Database::containsDeletedObject(const DeletedObject& object) const
 {
-    for (const DeletedObject& currentObject : m_deletedObjects) {
-        if (currentObject.uuid == object.uuid) {
-            return true;
-        }
-    }
-    return false;
+    return m_deletedObjectCounts.contains(object.uuid);
 }
 
 void Database::setDeletedObjects(const QList<DeletedObject>& delObjs)
@@ -684,12 +1409,47 @@ void Database::setDeletedObjects(const QList<DeletedObject>& delObjs)
         return;
     }
     m_deletedObjects = delObjs;
+    m_deletedObjectCounts.clear();
+    m_deletedObjectCounts.reserve(m_deletedObjects.size());
+    for (const DeletedObject& object : asConst(m_deletedObjects)) {
+        ++m_deletedObjectCounts[object.uuid];
+    }
 }
 
 void Database::addDeletedObject(const DeletedObject& delObj)
 {
     Q_ASSERT(delObj.deletionTime.timeSpec() == Qt::UTC);
     m_deletedObjects.append(delObj);
+    ++m_deletedObjectCounts[delObj.uuid];
+}
+
+/**
+ * Forget old deletions. Databases synchronized with this one after the
+ * deletions were pruned may bring the deleted entries and groups back.
+ *
+ * @param deletedBefore deletions before this time are removed
+ * @return number of removed deletions
+ */
+int Database::pruneDeletedObjects(const QDateTime& deletedBefore)
+{
+    QList<DeletedObject> kept;
+    kept.reserve(m_deletedObjects.size());
+    for (const DeletedObject& object : asConst(m_deletedObjects)) {
+        if (object.deletionTime >= deletedBefore) {
+            kept.append(object);
+            continue;
+        }
+        auto count = m_deletedObjectCounts.find(object.uuid);
+        if (count != m_deletedObjectCounts.end() && --count.value() <= 0) {
+            m_deletedObjectCounts.erase(count);
+        }
+    }
+
+    const int removed = m_deletedObjects.size() - kept.size();
+    if (removed > 0) {
+        m_deletedObjects = kept;
+    }
+    return removed;
 }
 
 void Database::addDeletedObject(const QUuid& uuid)
@@ -701,44 +1461,72 @@ void Database::addDeletedObject(const QUuid& uuid)
     addDeletedObject(delObj);
 }
 
+/**
+ * @return index of the entries targeted by field references
+ */
+EntryReferenceIndex* Database::referenceIndex()
+{
+    return m_referenceIndex.data();
+}
+
+/**
+ * @return cache of the zxcvbn entropies of the passwords in this database
+ */
+PasswordEntropyCache* Database::passwordEntropyCache() const
+{
+    return m_passwordEntropyCache.data();
+}
+
+/**
+ * @return counter that changes whenever an entry, group or the metadata changed
+ */
+quint64 Database::dataRevision() const
+{
+    return m_dataRevision;
+}
+
+/**
+ * @return cache of the entry fields used by EntrySearcher
+ */
+EntrySearchIndex* Database::searchIndex() const
+{
+    return m_searchIndex;
+}
+
 const QStringList& Database::commonUsernames() const
 {
     return m_commonUsernames;
 }
 
+/**
+ * @return sorted tags of all entries outside the recycle bin, tagAdded() and
+ *         tagRemoved() announce changes to the list
+ */
 const QStringList& Database::tagList() const
 {
-    return m_tagList;
+    return m_tagIndex->tags();
+}
+
+/**
+ * @return sorted usernames of all entries, for completing usernames by prefix
+ */
+const QStringList& Database::usernameList() const
+{
+    return m_tagIndex->usernames();
 }
 
 void Database::updateCommonUsernames(int topN)
 {
-    m_commonUsernames.clear();
-    m_commonUsernames.append(rootGroup()->usernamesRecursive(topN));
+    m_commonUsernames = m_tagIndex->commonUsernames(topN);
 }
 
+/**
+ * Build the tag list again, the tag list is kept up to date as entries change
+ * and this is only needed after entries were changed with modified signals blocked.
+ */
 void Database::updateTagList()
 {
-    m_tagList.clear();
-    if (!m_rootGroup) {
-        emit tagListUpdated();
-        return;
-    }
-
-    // Search groups recursively looking for tags
-    // Use a set to prevent adding duplicates
-    QSet<QString> tagSet;
-    for (auto entry : m_rootGroup->entriesRecursive()) {
-        if (!entry->isRecycled()) {
-            for (auto tag : entry->tagList()) {
-                tagSet.insert(tag);
-            }
-        }
-    }
-
-    m_tagList = tagSet.values();
-    m_tagList.sort();
-    emit tagListUpdated();
+    m_tagIndex->clear();
 }
 
 void Database::removeTag(const QString& tag)
@@ -747,9 +1535,10 @@ void Database::removeTag(const QString& tag)
         return;
     }
 
-    for (auto entry : m_rootGroup->entriesRecursive()) {
+    m_rootGroup->forEachEntryRecursive([&tag](Entry* entry) {
         entry->removeTag(tag);
-    }
+        return true;
+    });
 }
 
 const QUuid& Database::cipher() const
@@ -771,6 +1560,17 @@ QByteArray Database::transformedDatabaseKey() const
     return m_data.transformedDatabaseKey->rawKey();
 }
 
+/**
+ * Set the source of attachments that were not loaded when opening the database.
+ * Deferred attachments are read back in one pass before the database is written.
+ *
+ * @param loader attachment loader
+ */
+void Database::setAttachmentLoader(QSharedPointer<AttachmentLoader> loader)
+{
+    m_attachmentLoader = std::move(loader);
+}
+
 QByteArray Database::challengeResponseKey() const
 {
     Q_ASSERT(m_data.challengeResponseKey);
@@ -841,15 +1641,23 @@ bool Database::setKey(const QSharedPointer<const CompositeKey>& key,
         Q_ASSERT(!m_data.kdf->seed().isEmpty());
     }
 
+    // Writers derive the current key again from a new seed, which is not a change
+    const bool sameKey = m_data.key == key && !updateChangedTime;
+
     PasswordKey oldTransformedDatabaseKey;
     if (m_data.key && !m_data.key->isEmpty()) {
         oldTransformedDatabaseKey.setRawKey(m_data.transformedDatabaseKey->rawKey());
     }
 
     QByteArray transformedDatabaseKey;
+    const ReusableKey reusableKey = m_reusableKey;
+    m_reusableKey = {};
 
     if (!transformKey) {
         transformedDatabaseKey = QByteArray(oldTransformedDatabaseKey.rawKey());
+    } else if (reusableKey.key == key && !reusableKey.transformedKey.isEmpty()
+               && reusableKey.kdfParameters == m_data.kdf->writeParameters()) {
+        transformedDatabaseKey = reusableKey.transformedKey;
     } else if (!key->transform(*m_data.kdf, transformedDatabaseKey, &m_keyError)) {
         return false;
     }
@@ -862,13 +1670,31 @@ bool Database::setKey(const QSharedPointer<const CompositeKey>& key,
         m_metadata->setDatabaseKeyChanged(Clock::currentDateTimeUtc());
     }
 
-    if (oldTransformedDatabaseKey.rawKey() != m_data.transformedDatabaseKey->rawKey()) {
+    if (!sameKey && oldTransformedDatabaseKey.rawKey() != m_data.transformedDatabaseKey->rawKey()) {
         markAsModified();
     }
 
     return true;
 }
 
+/**
+ * Let the next setKey() call take the transformed key of another database.
+ *
+ * Used when opening a copy of a database with the key it is already unlocked with,
+ * e.g. the download of a remote sync. The key is only taken if the composite key is
+ * the same object and the KDF parameters including the seed are identical, a copy
+ * that was saved with a new seed or different KDF settings is transformed as usual.
+ * The hint is dropped by the next setKey() call whether it was used or not.
+ *
+ * @param other unlocked database to take the transformed key from
+ */
+void Database::reuseTransformedKey(const Database& other)
+{
+    m_reusableKey.key = other.m_data.key;
+    m_reusableKey.kdfParameters = other.m_data.kdf->writeParameters();
+    m_reusableKey.transformedKey = other.m_data.transformedDatabaseKey->rawKey();
+}
+
 QString Database::keyError()
 {
     return m_keyError;
@@ -928,18 +1754,28 @@ void Database::recycleGroup(Group* group)
 
 void Database::emptyRecycleBin()
 {
-    if (m_metadata->recycleBinEnabled() && m_metadata->recycleBin()) {
-        // destroying direct entries of the recycle bin
-        QList<Entry*> subEntries = m_metadata->recycleBin()->entries();
-        for (Entry* entry : subEntries) {
-            delete entry;
-        }
-        // destroying direct subgroups of the recycle bin
-        QList<Group*> subGroups = m_metadata->recycleBin()->children();
-        for (Group* group : subGroups) {
-            delete group;
-        }
+    auto recycleBin = m_metadata->recycleBin();
+    if (!m_metadata->recycleBinEnabled() || !recycleBin
+        || (recycleBin->entries().isEmpty() && !recycleBin->hasChildren())) {
+        return;
     }
+
+    // Moving the contents out of the database records their deletion, the direct
+    // children are detached from the end and their subtrees move along at once
+    DatabaseBulkUpdate bulkUpdate(this);
+    auto trash = new Group();
+    const QList<Entry*> subEntries = recycleBin->entries();
+    for (int i = subEntries.size() - 1; i >= 0; --i) {
+        subEntries.at(i)->setGroup(trash, false);
+    }
+    const QList<Group*> subGroups = recycleBin->children();
+    for (int i = subGroups.size() - 1; i >= 0; --i) {
+        subGroups.at(i)->setParent(trash, -1, false);
+    }
+
+    // Deleted with the database if it goes away first
+    static_cast<QObject*>(trash)->setParent(this);
+    deleteInChunks(trash);
 }
 
 bool Database::isModified() const
@@ -954,8 +1790,36 @@ bool Database::hasNonDataChanges() const
 
 void Database::markAsModified()
 {
+    markModified(false);
+}
+
+/**
+ * Mark the database as modified by a change of one of its entries or groups.
+ *
+ * Entries and groups call this directly instead of being connected to the
+ * database one by one.
+ */
+void Database::notifyObjectModified()
+{
+    markModified(true);
+}
+
+/**
+ * @param journaled whether the change is an entry or group change that can be written to the save journal
+ */
+void Database::markModified(bool journaled)
+{
+    m_referenceIndex->invalidate();
+    ++m_dataRevision;
+
+    if (!journaled) {
+        m_journal->invalidate();
+    }
+
     m_modified = true;
-    if (modifiedSignalEnabled() && !m_modifiedTimer.isActive()) {
+    if (m_bulkUpdates > 0) {
+        m_bulkModified = true;
+    } else if (modifiedSignalEnabled() && !m_modifiedTimer.isActive()) {
         // Small time delay prevents numerous consecutive saves due to repeated signals
         startModifiedTimer();
     }
@@ -984,9 +1848,104 @@ void Database::markNonDataChange()
  */
 Database* Database::databaseByUuid(const QUuid& uuid)
 {
+    QMutexLocker locker(&s_uuidMapMutex);
     return s_uuidMap.value(uuid, nullptr);
 }
 
+/**
+ * Copy the contents of the database for a worker thread that runs while this thread keeps
+ * processing events, see the concurrency notes of the class.
+ *
+ * Time info is copied untouched. The copy does not emit modified signals and has no thread
+ * affinity, the worker may pull it in with moveWithHistoryToThread() before changing it.
+ * Compare dataRevision() with its value at the time of the snapshot to detect changes of
+ * the database that the copy does not contain.
+ *
+ * @return detached copy of the groups, entries, metadata and deleted objects
+ */
+QSharedPointer<Database> Database::snapshot() const
+{
+    auto copy = QSharedPointer<Database>::create();
+    copy->setEmitModified(false);
+
+    auto root = copyGroupTree(rootGroup());
+    delete copy->setRootGroup(root);
+    root->setUpdateTimeinfo(true);
+
+    copy->metadata()->copyAttributesFrom(metadata());
+    copy->metadata()->customData()->copyDataFrom(metadata()->customData());
+    for (const QUuid& uuid : metadata()->customIconsOrder()) {
+        copy->metadata()->addCustomIcon(uuid, metadata()->customIcon(uuid));
+    }
+    copy->setDeletedObjects(deletedObjects());
+
+    copy->moveWithHistoryToThread(nullptr);
+    return copy;
+}
+
+/**
+ * Hand the database over to another thread, e.g. the main thread after the
+ * database was read in a worker thread.
+ *
+ * Has to be called from the thread the database belongs to. Unlike
+ * QObject::moveToThread() this also moves the history items, which are not
+ * children of their entries.
+ *
+ * @param thread thread the database is used from afterwards
+ */
+void Database::moveWithHistoryToThread(QThread* thread)
+{
+    moveToThread(thread);
+    if (!m_rootGroup) {
+        return;
+    }
+    m_rootGroup->forEachEntryRecursive([thread](const Entry* entry) {
+        for (auto* historyItem : entry->historyItems()) {
+            if (!historyItem->parent()) {
+                historyItem->moveToThread(thread);
+            }
+        }
+        return true;
+    });
+}
+
+/**
+ * Start changing many entries or groups at once, until the matching call of endBulkUpdate().
+ *
+ * The changes are still signalled as usual, but models may reset once at the end
+ * instead of reporting every row and the database is only marked modified once.
+ * Bulk updates may be nested, receivers must not rely on the database contents
+ * between them.
+ */
+void Database::beginBulkUpdate()
+{
+    if (m_bulkUpdates++ == 0) {
+        m_bulkModified = false;
+    }
+}
+
+/**
+ * Finish a bulk update, the last one emits bulkUpdateFinished().
+ */
+void Database::endBulkUpdate()
+{
+    Q_ASSERT(m_bulkUpdates > 0);
+    if (m_bulkUpdates <= 0 || --m_bulkUpdates > 0) {
+        return;
+    }
+
+    emit bulkUpdateFinished();
+    if (m_bulkModified && modifiedSignalEnabled() && !m_modifiedTimer.isActive()) {
+        startModifiedTimer();
+    }
+    m_bulkModified = false;
+}
+
+bool Database::isBulkUpdating() const
+{
+    return m_bulkUpdates > 0;
+}
+
 QSharedPointer<const CompositeKey> Database::key() const
 {
     return m_data.key;
@@ -1108,3 +2067,18 @@ bool Database::isTemporaryDatabase()
 {
     return m_isTemporaryDatabase;
 }
+
+DatabaseBulkUpdate::DatabaseBulkUpdate(Database* db)
+    : m_db(db)
+{
+    if (m_db) {
+        m_db->beginBulkUpdate();
+    }
+}
+
+DatabaseBulkUpdate::~DatabaseBulkUpdate()
+{
+    if (m_db) {
+        m_db->endBulkUpdate();
+    }
+}
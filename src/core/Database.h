@@ -20,6 +20,7 @@
 #define KEEPASSX_DATABASE_H
 
 #include <QDateTime>
+#include <QFuture>
 #include <QHash>
 #include <QMutex>
 #include <QPointer>
@@ -32,12 +33,20 @@
 #include "keys/CompositeKey.h"
 #include "keys/PasswordKey.h"
 
+class AttachmentLoader;
 class Entry;
 enum class EntryReferenceType;
+class EntryReferenceIndex;
+class EntrySearchIndex;
+class EntryTagIndex;
 class FileWatcher;
 class Group;
+class KdbxJournal;
+class KeePass2Writer;
 class Metadata;
+class PasswordEntropyCache;
 class QIODevice;
+struct WrittenFile;
 
 struct DeletedObject
 {
@@ -51,6 +60,19 @@ struct DeletedObject
 
 Q_DECLARE_TYPEINFO(DeletedObject, Q_MOVABLE_TYPE);
 
+/**
+ * KeePass database with its groups and entries.
+ *
+ * Concurrency: a database, its groups and entries are only changed on the thread the
+ * database belongs to, usually the GUI thread, and none of them take locks. Worker threads
+ * may read them in two ways:
+ * - while the owning thread is blocked waiting for the workers without processing events,
+ *   e.g. in QtConcurrent::blockingFiltered(), nothing can change in the meantime;
+ * - through snapshot() while the owning thread keeps processing events, e.g. in
+ *   AsyncTask::runAndWaitForFuture(), since any event may change the database.
+ * Results computed from a snapshot are checked against dataRevision() before they are
+ * applied to the database on its own thread.
+ */
 class Database : public ModifiableObject
 {
     Q_OBJECT
@@ -68,39 +90,80 @@ public:
         Atomic, // Saves are transactional and atomic
         TempFile, // Write to a temporary location then move into place, may be non-atomic
         DirectWrite, // Directly write to the destination file (dangerous)
+        Coalesced, // Like Atomic, but the directory is only synced to disk once no other save followed for a while
+    };
+
+    enum OpenFlag
+    {
+        OpenDefault = 0,
+        // Read KDBX4 attachment data from the file only when it is first accessed
+        DeferAttachments = 1 << 0,
+        // Open for lookups only: history items are left out, attachments are deferred and saving is refused
+        ReadOnly = 1 << 1,
     };
+    Q_DECLARE_FLAGS(OpenFlags, OpenFlag)
 
     Database();
     explicit Database(const QString& filePath);
     ~Database() override;
 
 private:
-    bool writeDatabase(QIODevice* device, QString* error = nullptr);
+    void markModified(bool journaled);
+    bool snapshotDatabase(KeePass2Writer& writer, QString* error);
+    bool loadDeferredAttachments(QString* error);
+    bool writeDatabase(QIODevice* device, KeePass2Writer& writer, WrittenFile& writtenFile, QString* error);
     bool backupDatabase(const QString& filePath, const QString& destinationFilePath);
     bool restoreDatabase(const QString& filePath, const QString& fromBackupFilePath);
-    bool performSave(const QString& filePath, SaveAction flags, const QString& backupFilePath, QString* error);
+    bool performSave(const QString& filePath,
+                     SaveAction flags,
+                     const QString& backupFilePath,
+                     KeePass2Writer& writer,
+                     WrittenFile& writtenFile,
+                     QString* error);
+    bool replaceDatabaseFile(const QString& filePath,
+                             SaveAction action,
+                             const QString& backupFilePath,
+                             KeePass2Writer& writer,
+                             QFuture<bool> backup,
+                             WrittenFile& writtenFile,
+                             QString* error);
+    void syncPendingSave();
 
 public:
     bool open(QSharedPointer<const CompositeKey> key, QString* error = nullptr);
-    bool open(const QString& filePath, QSharedPointer<const CompositeKey> key, QString* error = nullptr);
+    bool open(const QString& filePath,
+              QSharedPointer<const CompositeKey> key,
+              QString* error = nullptr,
+              OpenFlags flags = OpenDefault);
+    bool open(const QString& filePath,
+              const QByteArray& fileData,
+              QSharedPointer<const CompositeKey> key,
+              QString* error = nullptr,
+              OpenFlags flags = OpenDefault);
     bool save(SaveAction action = Atomic, const QString& backupFilePath = QString(), QString* error = nullptr);
     bool saveAs(const QString& filePath,
                 SaveAction action = Atomic,
                 const QString& backupFilePath = QString(),
                 QString* error = nullptr);
+    bool saveToJournal(QString* error = nullptr);
+    void discardJournal();
+    QString keptJournalFilePath() const;
     bool extract(QByteArray&, QString* error = nullptr);
+    bool extract(QIODevice* device, QString* error = nullptr);
     bool import(const QString& xmlExportPath, QString* error = nullptr);
+    bool import(QIODevice* device, QString* error = nullptr);
 
     quint32 formatVersion() const;
     void setFormatVersion(quint32 version);
     bool hasMinorVersionMismatch() const;
 
-    void releaseData();
+    void releaseData(bool teardownInBackground = false);
 
     bool isInitialized() const;
     bool isModified() const;
     bool hasNonDataChanges() const;
     bool isSaving();
+    bool isReadOnly() const;
 
     QUuid publicUuid();
     QUuid uuid() const;
@@ -134,8 +197,14 @@ public:
     bool containsDeletedObject(const QUuid& uuid) const;
     bool containsDeletedObject(const DeletedObject& uuid) const;
     void setDeletedObjects(const QList<DeletedObject>& delObjs);
+    int pruneDeletedObjects(const QDateTime& deletedBefore);
 
+    EntrySearchIndex* searchIndex() const;
+    EntryReferenceIndex* referenceIndex();
+    PasswordEntropyCache* passwordEntropyCache() const;
+    quint64 dataRevision() const;
     const QStringList& commonUsernames() const;
+    const QStringList& usernameList() const;
     const QStringList& tagList() const;
     void removeTag(const QString& tag);
 
@@ -144,6 +213,7 @@ public:
                 bool updateChangedTime = true,
                 bool updateTransformSalt = false,
                 bool transformKey = true);
+    void reuseTransformedKey(const Database& other);
     QString keyError();
     QByteArray challengeResponseKey() const;
     bool challengeMasterSeed(const QByteArray& masterSeed);
@@ -157,11 +227,22 @@ public:
     bool changeKdf(const QSharedPointer<Kdf>& kdf);
     QByteArray transformedDatabaseKey() const;
 
+    void setAttachmentLoader(QSharedPointer<AttachmentLoader> loader);
+
     void markAsTemporaryDatabase();
     bool isTemporaryDatabase();
 
+    QSharedPointer<Database> snapshot() const;
+    void moveWithHistoryToThread(QThread* thread);
+
+    void beginBulkUpdate();
+    void endBulkUpdate();
+    bool isBulkUpdating() const;
+
     static Database* databaseByUuid(const QUuid& uuid);
 
+    void notifyObjectModified();
+
 public slots:
     void markAsModified();
     void markAsClean();
@@ -184,6 +265,9 @@ signals:
     void databaseFileChanged();
     void databaseNonDataChanged();
     void tagListUpdated();
+    void tagAdded(const QString& tag, int index);
+    void tagRemoved(const QString& tag, int index);
+    void bulkUpdateFinished();
 
 private:
     struct DatabaseData
@@ -228,28 +312,68 @@ private:
         }
     };
 
+    // Transformed key of another database that setKey() may take instead of running the KDF
+    struct ReusableKey
+    {
+        QSharedPointer<const CompositeKey> key;
+        QVariantMap kdfParameters;
+        QByteArray transformedKey;
+    };
+
     void createRecycleBin();
 
     void startModifiedTimer();
     void stopModifiedTimer();
 
     QPointer<Metadata> const m_metadata;
+    QPointer<EntrySearchIndex> const m_searchIndex;
+    QPointer<EntryTagIndex> const m_tagIndex;
     DatabaseData m_data;
     QPointer<Group> m_rootGroup;
     QList<DeletedObject> m_deletedObjects;
+    // Number of records for each uuid in m_deletedObjects, which keeps the order they are written in
+    QHash<QUuid, int> m_deletedObjectCounts;
     QTimer m_modifiedTimer;
+    // Syncs the directory of the last coalesced save to disk
+    QTimer m_syncTimer;
+    QString m_pendingSyncPath;
     QMutex m_saveMutex;
     QPointer<FileWatcher> m_fileWatcher;
+    QSharedPointer<AttachmentLoader> m_attachmentLoader;
+    QScopedPointer<KdbxJournal> m_journal;
+    QScopedPointer<EntryReferenceIndex> m_referenceIndex;
+    QScopedPointer<PasswordEntropyCache> m_passwordEntropyCache;
     bool m_modified = false;
+    int m_bulkUpdates = 0;
+    bool m_bulkModified = false;
+    quint64 m_dataRevision = 0;
     bool m_hasNonDataChange = false;
     QString m_keyError;
+    ReusableKey m_reusableKey;
     bool m_isTemporaryDatabase = false;
+    bool m_readOnly = false;
 
     QStringList m_commonUsernames;
-    QStringList m_tagList;
 
     QUuid m_uuid;
     static QHash<QUuid, QPointer<Database>> s_uuidMap;
+    static QMutex s_uuidMapMutex;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(Database::OpenFlags)
+
+/**
+ * Bulk update of a database for the lifetime of the object, see Database::beginBulkUpdate().
+ */
+class DatabaseBulkUpdate
+{
+public:
+    explicit DatabaseBulkUpdate(Database* db);
+    ~DatabaseBulkUpdate();
+    Q_DISABLE_COPY(DatabaseBulkUpdate)
+
+private:
+    QPointer<Database> m_db;
 };
 
 #endif // KEEPASSX_DATABASE_H
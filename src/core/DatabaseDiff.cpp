@@ -0,0 +1,176 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseDiff.h"
+
+#include "core/Global.h"
+#include "core/Group.h"
+
+#include <QCryptographicHash>
+
+#include <algorithm>
+
+namespace
+{
+    using EntryMap = QHash<QUuid, const Entry*>;
+    using HashMap = QHash<const Group*, QByteArray>;
+
+    void addTimeInfo(QCryptographicHash& hash, const TimeInfo& timeInfo)
+    {
+        const qint64 times[] = {timeInfo.lastModificationTime().toMSecsSinceEpoch(),
+                                timeInfo.locationChanged().toMSecsSinceEpoch()};
+        hash.addData(reinterpret_cast<const char*>(times), sizeof(times));
+    }
+
+    void collectEntries(const Group* group, EntryMap& entries)
+    {
+        group->forEachEntryRecursive([&entries](const Entry* entry) {
+            entries.insert(entry->uuid(), entry);
+            return true;
+        });
+    }
+
+    /**
+     * Collect the entries of two groups that may differ.
+     *
+     * An entry of a subtree that is equal in both trees cannot appear anywhere
+     * else in either of them, so equal subtrees are left out.
+     */
+    void collectDifferences(const Group* oldGroup,
+                            const Group* newGroup,
+                            const HashMap& oldHashes,
+                            const HashMap& newHashes,
+                            EntryMap& oldEntries,
+                            EntryMap& newEntries)
+    {
+        if (oldHashes.value(oldGroup) == newHashes.value(newGroup)) {
+            return;
+        }
+
+        for (const Entry* entry : oldGroup->entries()) {
+            oldEntries.insert(entry->uuid(), entry);
+        }
+        for (const Entry* entry : newGroup->entries()) {
+            newEntries.insert(entry->uuid(), entry);
+        }
+
+        QHash<QUuid, const Group*> newChildren;
+        for (const Group* child : newGroup->children()) {
+            newChildren.insert(child->uuid(), child);
+        }
+        for (const Group* oldChild : oldGroup->children()) {
+            const Group* newChild = newChildren.take(oldChild->uuid());
+            if (newChild) {
+                collectDifferences(oldChild, newChild, oldHashes, newHashes, oldEntries, newEntries);
+            } else {
+                // Moved, added and removed groups have no counterpart to prune against
+                collectEntries(oldChild, oldEntries);
+            }
+        }
+        for (const Group* newChild : asConst(newChildren)) {
+            collectEntries(newChild, newEntries);
+        }
+    }
+} // namespace
+
+/**
+ * Compare the entries of two trees.
+ *
+ * @param oldRoot root group of the old tree
+ * @param newRoot root group of the new tree
+ * @return added, removed and modified entries, sorted by type and path
+ */
+QList<DatabaseDiff::Change> DatabaseDiff::compare(const Group* oldRoot, const Group* newRoot)
+{
+    HashMap oldHashes;
+    HashMap newHashes;
+    hashSubtree(oldRoot, oldHashes);
+    hashSubtree(newRoot, newHashes);
+
+    EntryMap oldEntries;
+    EntryMap newEntries;
+    collectDifferences(oldRoot, newRoot, oldHashes, newHashes, oldEntries, newEntries);
+
+    QList<Change> changes;
+    for (auto it = oldEntries.constBegin(); it != oldEntries.constEnd(); ++it) {
+        const Entry* newEntry = newEntries.take(it.key());
+        if (!newEntry) {
+            changes.append({ChangeType::Removed, it.value()});
+        } else if (isModified(it.value(), newEntry)) {
+            changes.append({ChangeType::Modified, newEntry});
+        }
+    }
+    for (const Entry* entry : asConst(newEntries)) {
+        changes.append({ChangeType::Added, entry});
+    }
+
+    std::sort(changes.begin(), changes.end(), [](const Change& lhs, const Change& rhs) {
+        if (lhs.type != rhs.type) {
+            return lhs.type < rhs.type;
+        }
+        return lhs.entry->path() < rhs.entry->path();
+    });
+    return changes;
+}
+
+/**
+ * Hash the UUIDs and times of a group, its entries and their history and all subgroups.
+ *
+ * @param group root of the subtree
+ * @param hashes receives the hash of every group of the subtree
+ * @return hash of the subtree
+ */
+QByteArray DatabaseDiff::hashSubtree(const Group* group, QHash<const Group*, QByteArray>& hashes)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(group->uuid().toRfc4122());
+    addTimeInfo(hash, group->timeInfo());
+
+    for (const Entry* entry : group->entries()) {
+        hash.addData(entry->uuid().toRfc4122());
+        addTimeInfo(hash, entry->timeInfo());
+        const auto& historyItems = entry->historyItems();
+        const qint64 historySize = historyItems.size();
+        hash.addData(reinterpret_cast<const char*>(&historySize), sizeof(historySize));
+        for (const Entry* historyItem : historyItems) {
+            addTimeInfo(hash, historyItem->timeInfo());
+        }
+    }
+
+    // Keeps subgroups apart from the entries
+    hash.addData("/", 1);
+    for (const Group* child : group->children()) {
+        hash.addData(hashSubtree(child, hashes));
+    }
+
+    auto result = hash.result();
+    hashes.insert(group, result);
+    return result;
+}
+
+/**
+ * @return true if two versions of an entry differ in the information the subtree hashes cover
+ */
+bool DatabaseDiff::isModified(const Entry* oldEntry, const Entry* newEntry)
+{
+    const auto& oldTimeInfo = oldEntry->timeInfo();
+    const auto& newTimeInfo = newEntry->timeInfo();
+    return oldTimeInfo.lastModificationTime() != newTimeInfo.lastModificationTime()
+           || oldTimeInfo.locationChanged() != newTimeInfo.locationChanged()
+           || oldEntry->historyItems().size() != newEntry->historyItems().size()
+           || oldEntry->group()->uuid() != newEntry->group()->uuid();
+}
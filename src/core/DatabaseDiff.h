@@ -0,0 +1,58 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASEDIFF_H
+#define KEEPASSXC_DATABASEDIFF_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+
+class Entry;
+class Group;
+
+/**
+ * Structural comparison of two databases, e.g. two copies of a synchronized database.
+ *
+ * Entries are matched by UUID and compared by their modification and location
+ * times and the number of their history items, the same information Merger uses
+ * to decide whether an entry has to be merged. Subtrees with the same hash in
+ * both databases are skipped without looking at their entries.
+ */
+class DatabaseDiff
+{
+public:
+    enum class ChangeType
+    {
+        Added,
+        Removed,
+        Modified
+    };
+
+    struct Change
+    {
+        ChangeType type;
+        // Entry of the old tree for removed entries, of the new tree otherwise
+        const Entry* entry;
+    };
+
+    static QList<Change> compare(const Group* oldRoot, const Group* newRoot);
+    static QByteArray hashSubtree(const Group* group, QHash<const Group*, QByteArray>& hashes);
+    static bool isModified(const Entry* oldEntry, const Entry* newEntry);
+};
+
+#endif // KEEPASSXC_DATABASEDIFF_H
@@ -0,0 +1,300 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseMemoryIndex.h"
+
+#include "core/DatabaseStatsIndex.h"
+#include "core/EntryReferenceIndex.h"
+#include "core/EntrySearchIndex.h"
+#include "core/EntryTagIndex.h"
+#include "core/Global.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "core/PasswordHealth.h"
+#include "core/Tools.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Header of the shared data of strings and byte arrays
+    const qint64 SharedDataOverhead = 24;
+
+    qint64 byteArraySize(qint64 size)
+    {
+        return size > 0 ? SharedDataOverhead + size + 1 : 0;
+    }
+} // namespace
+
+DatabaseMemoryIndex::DatabaseMemoryIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+{
+    // Entries of an added group do not emit entryAdded, entries of a removed group may live on elsewhere
+    connect(db, &Database::groupAdded, this, &DatabaseMemoryIndex::scheduleSweep);
+    connect(db, &Database::groupRemoved, this, &DatabaseMemoryIndex::clear);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &DatabaseMemoryIndex::clear);
+    connect(db, &Database::databaseDiscarded, this, &DatabaseMemoryIndex::clear);
+}
+
+/**
+ * Get the memory index of a database, creating it on first use.
+ *
+ * The index has to be used from the thread of the database.
+ *
+ * @param db database to index
+ * @return index owned by the database
+ */
+DatabaseMemoryIndex* DatabaseMemoryIndex::forDatabase(Database* db)
+{
+    auto index = db->findChild<DatabaseMemoryIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index) {
+        index = new DatabaseMemoryIndex(db);
+    }
+    return index;
+}
+
+/**
+ * @param string string to estimate
+ * @return heap size of the string data, which may be shared with other strings
+ */
+qint64 DatabaseMemoryIndex::stringSize(const QString& string)
+{
+    return byteArraySize(static_cast<qint64>(string.size()) * static_cast<qint64>(sizeof(QChar)));
+}
+
+/**
+ * @return estimated memory use of the database by category
+ */
+DatabaseMemoryIndex::Usage DatabaseMemoryIndex::usage()
+{
+    if (m_rootGroup != m_db->rootGroup()) {
+        clear();
+    }
+    if (m_sweepPending) {
+        sweep();
+    }
+
+    Usage usage;
+    usage.entries = m_entryBytes;
+    usage.history = m_historyBytes;
+    usage.attachments = m_attachmentBytes;
+    usage.customIcons = m_db->metadata()->customIconsSize();
+
+    // Indexes that were never used do not exist yet and are not created here
+    usage.searchIndexes = m_db->searchIndex()->memoryUsage() + m_db->referenceIndex()->memoryUsage();
+    if (auto tagIndex = m_db->findChild<EntryTagIndex*>(QString(), Qt::FindDirectChildrenOnly)) {
+        usage.searchIndexes += tagIndex->memoryUsage();
+    }
+    if (auto statsIndex = m_db->findChild<DatabaseStatsIndex*>(QString(), Qt::FindDirectChildrenOnly)) {
+        usage.caches += statsIndex->memoryUsage();
+    }
+    usage.caches += m_db->passwordEntropyCache()->memoryUsage();
+    // The records of this index
+    usage.caches += m_records.size() * static_cast<qint64>(sizeof(Record) + 2 * sizeof(void*))
+                    + m_attachments.size() * static_cast<qint64>(sizeof(AttachmentUses) + 3 * sizeof(void*));
+    return usage;
+}
+
+qint64 DatabaseMemoryIndex::Usage::total() const
+{
+    return entries + history + attachments + customIcons + searchIndexes + caches;
+}
+
+/**
+ * @return one line per category with a human readable size
+ */
+QStringList DatabaseMemoryIndex::Usage::toStringList() const
+{
+    return {QObject::tr("Entries: %1").arg(Tools::humanReadableFileSize(entries)),
+            QObject::tr("History: %1").arg(Tools::humanReadableFileSize(history)),
+            QObject::tr("Attachments: %1").arg(Tools::humanReadableFileSize(attachments)),
+            QObject::tr("Custom icons: %1").arg(Tools::humanReadableFileSize(customIcons)),
+            QObject::tr("Search indexes: %1").arg(Tools::humanReadableFileSize(searchIndexes)),
+            QObject::tr("Caches: %1").arg(Tools::humanReadableFileSize(caches)),
+            QObject::tr("Total: %1").arg(Tools::humanReadableFileSize(total()))};
+}
+
+void DatabaseMemoryIndex::addEntry(Entry* entry)
+{
+    drop(entry);
+    if (entry->database() == m_db) {
+        index(entry);
+    }
+}
+
+void DatabaseMemoryIndex::invalidateEntry()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry) {
+        addEntry(entry);
+    }
+}
+
+void DatabaseMemoryIndex::removeEntry(Entry* entry)
+{
+    drop(entry);
+    disconnect(entry, nullptr, this, nullptr);
+}
+
+void DatabaseMemoryIndex::removeDestroyedEntry(QObject* entry)
+{
+    // The entry is already destroyed at this point, only its address is used
+    drop(static_cast<const Entry*>(entry));
+}
+
+void DatabaseMemoryIndex::scheduleSweep()
+{
+    m_sweepPending = true;
+}
+
+void DatabaseMemoryIndex::clear()
+{
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    if (m_rootGroup) {
+        m_rootGroup->forEachGroupRecursive([this](const Group* group) {
+            disconnect(group, nullptr, this, nullptr);
+            return true;
+        });
+    }
+    m_records.clear();
+    m_attachments.clear();
+    m_entryBytes = 0;
+    m_historyBytes = 0;
+    m_attachmentBytes = 0;
+    m_rootGroup = m_db->rootGroup();
+    m_sweepPending = true;
+}
+
+/**
+ * Index all entries of the database that are not indexed yet.
+ */
+void DatabaseMemoryIndex::sweep()
+{
+    m_sweepPending = false;
+    m_rootGroup = m_db->rootGroup();
+    if (!m_rootGroup) {
+        return;
+    }
+
+    m_rootGroup->forEachGroupRecursive([this](Group* group) {
+        connect(group, &Group::entryAdded, this, &DatabaseMemoryIndex::addEntry, Qt::UniqueConnection);
+        connect(group, &Group::entryRemoved, this, &DatabaseMemoryIndex::removeEntry, Qt::UniqueConnection);
+        for (auto* entry : group->entries()) {
+            if (!m_records.contains(entry)) {
+                index(entry);
+            }
+        }
+        return true;
+    });
+}
+
+void DatabaseMemoryIndex::index(Entry* entry)
+{
+    const auto record = makeRecord(entry);
+    m_records.insert(entry, record);
+    m_entryBytes += record.entryBytes;
+    m_historyBytes += record.historyBytes;
+    for (const auto& attachment : record.attachments) {
+        auto& uses = m_attachments[attachment.first];
+        if (uses.count++ == 0) {
+            uses.size = attachment.second;
+            m_attachmentBytes += byteArraySize(attachment.second);
+        }
+    }
+
+    connect(entry, &Entry::modified, this, &DatabaseMemoryIndex::invalidateEntry, Qt::UniqueConnection);
+    connect(entry, &QObject::destroyed, this, &DatabaseMemoryIndex::removeDestroyedEntry, Qt::UniqueConnection);
+}
+
+void DatabaseMemoryIndex::drop(const Entry* entry)
+{
+    auto it = m_records.find(entry);
+    if (it == m_records.end()) {
+        return;
+    }
+
+    m_entryBytes -= it->entryBytes;
+    m_historyBytes -= it->historyBytes;
+    for (const auto& attachment : asConst(it->attachments)) {
+        auto uses = m_attachments.find(attachment.first);
+        if (uses != m_attachments.end() && --uses->count == 0) {
+            m_attachmentBytes -= byteArraySize(uses->size);
+            m_attachments.erase(uses);
+        }
+    }
+    m_records.erase(it);
+}
+
+DatabaseMemoryIndex::Record DatabaseMemoryIndex::makeRecord(const Entry* entry)
+{
+    Record record;
+    record.entryBytes = entrySize(entry);
+
+    auto addAttachments = [&record](const Entry* owner) {
+        for (const auto& data : owner->attachments()->loadedValues()) {
+            QPair<const char*, int> attachment(data.constData(), data.size());
+            if (!data.isEmpty() && !record.attachments.contains(attachment)) {
+                record.attachments.append(attachment);
+            }
+        }
+    };
+    addAttachments(entry);
+    const Entry* previous = entry;
+    for (const auto* item : entry->historyItems()) {
+        // History items share unchanged values with the entry and the item before them
+        record.historyBytes += entrySize(item, {entry, previous});
+        addAttachments(item);
+        previous = item;
+    }
+    return record;
+}
+
+/**
+ * @param entry entry to estimate
+ * @param sharing entries whose attribute values are not counted again if the entry shares them
+ * @return estimated size of an entry without its history and attachment data
+ */
+qint64 DatabaseMemoryIndex::entrySize(const Entry* entry, const QList<const Entry*>& sharing)
+{
+    // Entry, attributes, attachments, auto-type associations, custom data and time info objects
+    qint64 size = sizeof(Entry) + 5 * 2 * sizeof(QObject);
+
+    const auto attributes = entry->attributes();
+    for (const auto& key : attributes->keys()) {
+        const auto value = attributes->value(key);
+        const bool shared = std::any_of(sharing.begin(), sharing.end(), [&](const Entry* other) {
+            return other->attributes()->value(key).constData() == value.constData();
+        });
+        size += stringSize(key) + (shared ? 0 : stringSize(value)) + 4 * sizeof(void*);
+    }
+    for (const auto& key : entry->attachments()->keys()) {
+        size += stringSize(key) + 4 * sizeof(void*);
+    }
+    for (const auto& association : entry->autoTypeAssociations()->getAll()) {
+        size += stringSize(association.window) + stringSize(association.sequence) + 2 * sizeof(void*);
+    }
+    const auto customData = entry->customData();
+    for (const auto& key : customData->keys()) {
+        size += stringSize(key) + stringSize(customData->value(key)) + 6 * sizeof(void*);
+    }
+    size += stringSize(entry->tags());
+    return size;
+}
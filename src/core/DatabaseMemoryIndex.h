@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASEMEMORYINDEX_H
+#define KEEPASSXC_DATABASEMEMORYINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Per database estimate of the memory used by an open database.
+ *
+ * Every entry contributes a record with the estimated size of its fields,
+ * of its history items and the attachment data it holds. The records are
+ * added to running totals as soon as entries are added, modified or deleted.
+ * Attachment data shared between entries and history items is counted once,
+ * attachments that were not loaded yet are not counted. The sizes of custom
+ * icons, indexes and caches are taken from their own counters on request.
+ * Sizes are estimates of the heap use including container overhead, they
+ * are meant to compare databases rather than to account for every byte.
+ */
+class DatabaseMemoryIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Usage
+    {
+        qint64 entries = 0;
+        qint64 history = 0;
+        qint64 attachments = 0;
+        qint64 customIcons = 0;
+        qint64 searchIndexes = 0;
+        qint64 caches = 0;
+
+        qint64 total() const;
+        QStringList toStringList() const;
+    };
+
+    static DatabaseMemoryIndex* forDatabase(Database* db);
+    static qint64 stringSize(const QString& string);
+
+    Usage usage();
+
+private slots:
+    void addEntry(Entry* entry);
+    void invalidateEntry();
+    void removeEntry(Entry* entry);
+    void removeDestroyedEntry(QObject* entry);
+    void scheduleSweep();
+    void clear();
+
+private:
+    struct Record
+    {
+        qint64 entryBytes = 0;
+        qint64 historyBytes = 0;
+        // Shared data of the loaded attachments of the entry and its history items
+        QVector<QPair<const char*, int>> attachments;
+    };
+
+    struct AttachmentUses
+    {
+        int count = 0;
+        int size = 0;
+    };
+
+    explicit DatabaseMemoryIndex(Database* db);
+
+    void sweep();
+    void index(Entry* entry);
+    void drop(const Entry* entry);
+
+    static Record makeRecord(const Entry* entry);
+    static qint64 entrySize(const Entry* entry, const QList<const Entry*>& sharing = {});
+
+    Database* m_db;
+    QPointer<Group> m_rootGroup;
+    bool m_sweepPending = true;
+    QHash<const Entry*, Record> m_records;
+    QHash<const char*, AttachmentUses> m_attachments;
+    qint64 m_entryBytes = 0;
+    qint64 m_historyBytes = 0;
+    qint64 m_attachmentBytes = 0;
+};
+
+#endif // KEEPASSXC_DATABASEMEMORYINDEX_H
@@ -16,12 +16,24 @@
  */
 #include "DatabaseStats.h"
 
+#include "core/DatabaseStatsIndex.h"
+
 // Ctor does all the work
 DatabaseStats::DatabaseStats(QSharedPointer<Database> db)
     : modified(QFileInfo(db->filePath()).lastModified())
-    , m_db(db)
 {
-    gatherStats(db->rootGroup()->groupsRecursive(true));
+    const auto counters = DatabaseStatsIndex::forDatabase(db.data())->counters();
+    groupCount = counters.groupCount;
+    entryCount = counters.entryCount;
+    expiredEntries = counters.expiredEntries;
+    excludedEntries = counters.excludedEntries;
+    weakPasswords = counters.weakPasswords;
+    shortPasswords = counters.shortPasswords;
+    uniquePasswords = counters.uniquePasswords;
+    reusedPasswords = counters.reusedPasswords;
+    totalPasswordLength = counters.totalPasswordLength;
+    m_maxPwdReuse = counters.maxPasswordReuse;
+    memoryUsage = DatabaseMemoryIndex::forDatabase(db.data())->usage();
 }
 
 // Get average password length
@@ -35,11 +47,7 @@ int DatabaseStats::averagePwdLength() const
 // share the same password)
 int DatabaseStats::maxPwdReuse() const
 {
-    int ret = 0;
-    for (const auto& count : m_passwords) {
-        ret = std::max(ret, count);
-    }
-    return ret;
+    return m_maxPwdReuse;
 }
 
 // A warning sign is displayed if one of the
@@ -63,57 +71,3 @@ bool DatabaseStats::isAvgPwdTooShort() const
 {
     return averagePwdLength() < 10;
 }
-
-void DatabaseStats::gatherStats(const QList<Group*>& groups)
-{
-    auto checker = HealthChecker(m_db);
-
-    for (const auto* group : groups) {
-        // Don't count anything in the recycle bin
-        if (group->isRecycled()) {
-            continue;
-        }
-
-        ++groupCount;
-
-        for (const auto* entry : group->entries()) {
-            // Don't count anything in the recycle bin
-            if (entry->isRecycled()) {
-                continue;
-            }
-
-            ++entryCount;
-
-            if (entry->isExpired()) {
-                ++expiredEntries;
-            }
-
-            // Get password statistics
-            const auto pwd = entry->password();
-            if (!pwd.isEmpty()) {
-                if (!m_passwords.contains(pwd)) {
-                    ++uniquePasswords;
-                } else {
-                    ++reusedPasswords;
-                }
-
-                if (pwd.size() < PasswordHealth::Length::Short) {
-                    ++shortPasswords;
-                }
-
-                // Speed up Zxcvbn process by excluding very long passwords and most passphrases
-                if (pwd.size() < PasswordHealth::Length::Long
-                    && checker.evaluate(entry)->quality() <= PasswordHealth::Quality::Weak) {
-                    ++weakPasswords;
-                }
-
-                if (entry->excludeFromReports()) {
-                    ++excludedEntries;
-                }
-
-                totalPasswordLength += pwd.size();
-                m_passwords[pwd]++;
-            }
-        }
-    }
-}
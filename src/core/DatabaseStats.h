@@ -18,9 +18,18 @@
 #ifndef KEEPASSXC_DATABASESTATS_H
 #define KEEPASSXC_DATABASESTATS_H
 #include "PasswordHealth.h"
+#include "core/DatabaseMemoryIndex.h"
 #include "core/Group.h"
 #include <QFileInfo>
 #include <cmath>
+
+/**
+ * Statistics of a database as shown by the statistics report and db-info.
+ *
+ * The counters are taken from the DatabaseStatsIndex of the database, which is
+ * kept up to date as entries change, so the statistics have to be created in
+ * the thread of the database.
+ */
 class DatabaseStats
 {
 public:
@@ -35,6 +44,7 @@ public:
     int uniquePasswords = 0; // Number of unique passwords
     int reusedPasswords = 0; // Number of non-unique passwords
     int totalPasswordLength = 0; // Total length of all passwords
+    DatabaseMemoryIndex::Usage memoryUsage; // Estimated memory use of the open database
 
     explicit DatabaseStats(QSharedPointer<Database> db);
 
@@ -51,9 +61,6 @@ public:
     bool isAvgPwdTooShort() const;
 
 private:
-    QSharedPointer<Database> m_db;
-    QHash<QString, int> m_passwords;
-
-    void gatherStats(const QList<Group*>& groups);
+    int m_maxPwdReuse = 0;
 };
 #endif // KEEPASSXC_DATABASESTATS_H
@@ -0,0 +1,289 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseStatsIndex.h"
+
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "core/PasswordHealth.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+
+DatabaseStatsIndex::DatabaseStatsIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+    , m_key(randomGen()->randomArray(32))
+{
+    // Entries of an added or moved group do not emit entryAdded and may have entered the recycle bin
+    connect(db, &Database::groupAdded, this, &DatabaseStatsIndex::invalidateGroups);
+    connect(db, &Database::groupRemoved, this, &DatabaseStatsIndex::invalidateGroups);
+    connect(db, &Database::groupMoved, this, &DatabaseStatsIndex::invalidateGroups);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &DatabaseStatsIndex::clear);
+    connect(db, &Database::databaseDiscarded, this, &DatabaseStatsIndex::clear);
+}
+
+/**
+ * Get the statistics index of a database, creating it on first use.
+ *
+ * The index has to be used from the thread of the database.
+ *
+ * @param db database to index
+ * @return index owned by the database
+ */
+DatabaseStatsIndex* DatabaseStatsIndex::forDatabase(Database* db)
+{
+    auto index = db->findChild<DatabaseStatsIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index) {
+        index = new DatabaseStatsIndex(db);
+    }
+    return index;
+}
+
+/**
+ * @return current statistics of all groups and entries outside the recycle bin
+ */
+DatabaseStatsIndex::Counters DatabaseStatsIndex::counters()
+{
+    if (m_rootGroup != m_db->rootGroup() || m_recycleBin != m_db->metadata()->recycleBin()) {
+        clear();
+    }
+    if (m_sweepPending) {
+        sweep();
+    }
+
+    Counters counters;
+    counters.groupCount = m_groupCount;
+    counters.entryCount = m_records.size();
+    counters.excludedEntries = m_excludedEntries;
+    counters.shortPasswords = m_shortPasswords;
+    counters.uniquePasswords = m_passwords.size();
+    counters.reusedPasswords = m_passwordCount - m_passwords.size();
+    counters.totalPasswordLength = static_cast<int>(m_totalPasswordLength);
+    for (const auto& uses : m_passwords) {
+        counters.maxPasswordReuse = qMax(counters.maxPasswordReuse, uses.count);
+    }
+
+    // Expiry depends on the current time, the same checks as Entry::isExpired() and HealthChecker::evaluate()
+    const auto now = Clock::currentDateTime();
+    const auto localNow = QDateTime::currentDateTime();
+    for (const auto& record : m_records) {
+        const bool expired = record.expiryTime.isValid() && record.expiryTime < now;
+        if (expired) {
+            ++counters.expiredEntries;
+        }
+        // Speed up Zxcvbn process by excluding very long passwords and most passphrases
+        if (record.passwordId.isEmpty() || record.passwordLength >= PasswordHealth::Length::Long) {
+            continue;
+        }
+        // Re-used and soon expiring passwords are never rated good
+        const auto uses = m_passwords.value(record.passwordId);
+        if (record.weakEntropy || expired || (!record.reference && uses.count - uses.references > 1)
+            || (record.expiryTime.isValid() && localNow.daysTo(record.expiryTime) <= 30)) {
+            ++counters.weakPasswords;
+        }
+    }
+    return counters;
+}
+
+/**
+ * @return estimated size of the records and the password re-use histogram
+ */
+qint64 DatabaseStatsIndex::memoryUsage() const
+{
+    // Password HMACs are held by the records and the histogram
+    const qint64 hmacSize = 24 + 32 + 1;
+    return m_records.size() * (static_cast<qint64>(sizeof(Record) + 3 * sizeof(void*)) + hmacSize)
+           + m_passwords.size() * static_cast<qint64>(sizeof(QByteArray) + sizeof(PasswordUses) + 3 * sizeof(void*));
+}
+
+void DatabaseStatsIndex::addEntry(Entry* entry)
+{
+    drop(entry);
+    if (entry->database() == m_db) {
+        index(entry);
+    }
+}
+
+void DatabaseStatsIndex::invalidateEntry()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry) {
+        addEntry(entry);
+    }
+}
+
+void DatabaseStatsIndex::removeEntry(Entry* entry)
+{
+    drop(entry);
+    disconnect(entry, nullptr, this, nullptr);
+}
+
+void DatabaseStatsIndex::removeDestroyedEntry(QObject* entry)
+{
+    // The entry is already destroyed at this point, only its address is used
+    drop(static_cast<const Entry*>(entry));
+}
+
+void DatabaseStatsIndex::invalidateGroups()
+{
+    m_groupCount = -1;
+    m_sweepPending = true;
+}
+
+void DatabaseStatsIndex::clear()
+{
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    if (m_rootGroup) {
+        for (const auto* group : m_rootGroup->groupsRecursive(true)) {
+            disconnect(group, nullptr, this, nullptr);
+            for (const auto* entry : group->entries()) {
+                disconnect(entry, nullptr, this, nullptr);
+            }
+        }
+    }
+    m_records.clear();
+    m_passwords.clear();
+    m_passwordCount = 0;
+    m_excludedEntries = 0;
+    m_shortPasswords = 0;
+    m_totalPasswordLength = 0;
+    m_groupCount = -1;
+    m_rootGroup = m_db->rootGroup();
+    m_recycleBin = m_db->metadata()->recycleBin();
+    m_sweepPending = true;
+}
+
+/**
+ * Count the groups and index all entries of the database that are not indexed yet.
+ */
+void DatabaseStatsIndex::sweep()
+{
+    m_sweepPending = false;
+    m_rootGroup = m_db->rootGroup();
+    m_recycleBin = m_db->metadata()->recycleBin();
+    m_groupCount = 0;
+    if (!m_rootGroup) {
+        return;
+    }
+
+    for (auto* group : m_rootGroup->groupsRecursive(true)) {
+        connect(group, &Group::entryAdded, this, &DatabaseStatsIndex::addEntry, Qt::UniqueConnection);
+        connect(group, &Group::entryRemoved, this, &DatabaseStatsIndex::removeEntry, Qt::UniqueConnection);
+
+        const bool recycled = group->isRecycled();
+        if (!recycled) {
+            ++m_groupCount;
+        }
+        for (auto* entry : group->entries()) {
+            // The group may have been moved into the recycle bin
+            if (recycled) {
+                drop(entry);
+            }
+            if (!m_records.contains(entry)) {
+                index(entry);
+            }
+        }
+    }
+}
+
+void DatabaseStatsIndex::index(Entry* entry)
+{
+    connect(entry, &Entry::modified, this, &DatabaseStatsIndex::invalidateEntry, Qt::UniqueConnection);
+    connect(entry, &QObject::destroyed, this, &DatabaseStatsIndex::removeDestroyedEntry, Qt::UniqueConnection);
+    // Entries in the recycle bin are only watched, so they are counted again once restored
+    if (entry->isRecycled()) {
+        return;
+    }
+
+    const auto record = makeRecord(entry);
+    m_records.insert(entry, record);
+    if (record.passwordId.isEmpty()) {
+        return;
+    }
+
+    auto& uses = m_passwords[record.passwordId];
+    ++uses.count;
+    if (record.reference) {
+        ++uses.references;
+    }
+    ++m_passwordCount;
+    m_totalPasswordLength += record.passwordLength;
+    if (record.passwordLength < PasswordHealth::Length::Short) {
+        ++m_shortPasswords;
+    }
+    if (record.excluded) {
+        ++m_excludedEntries;
+    }
+}
+
+void DatabaseStatsIndex::drop(const Entry* entry)
+{
+    auto it = m_records.find(entry);
+    if (it == m_records.end()) {
+        return;
+    }
+
+    const auto& record = it.value();
+    if (!record.passwordId.isEmpty()) {
+        auto uses = m_passwords.find(record.passwordId);
+        if (uses != m_passwords.end()) {
+            if (record.reference) {
+                --uses->references;
+            }
+            if (--uses->count == 0) {
+                m_passwords.erase(uses);
+            }
+        }
+        --m_passwordCount;
+        m_totalPasswordLength -= record.passwordLength;
+        if (record.passwordLength < PasswordHealth::Length::Short) {
+            --m_shortPasswords;
+        }
+        if (record.excluded) {
+            --m_excludedEntries;
+        }
+    }
+    m_records.erase(it);
+}
+
+DatabaseStatsIndex::Record DatabaseStatsIndex::makeRecord(const Entry* entry)
+{
+    Record record;
+    if (entry->timeInfo().expires()) {
+        record.expiryTime = entry->timeInfo().expiryTime();
+    }
+
+    const auto pwd = entry->password();
+    if (pwd.isEmpty()) {
+        return record;
+    }
+
+    record.passwordId = CryptoHash::hmac(pwd.toUtf8(), m_key, CryptoHash::Sha256);
+    record.passwordLength = pwd.size();
+    record.reference = entry->isAttributeReference(EntryAttributes::PasswordKey);
+    record.excluded = entry->excludeFromReports();
+    if (record.passwordLength < PasswordHealth::Length::Long) {
+        const PasswordHealth health(m_db->passwordEntropyCache()->entropy(pwd));
+        record.weakEntropy = health.quality() <= PasswordHealth::Quality::Weak;
+    }
+    return record;
+}
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASESTATSINDEX_H
+#define KEEPASSXC_DATABASESTATSINDEX_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Per database counters behind DatabaseStats.
+ *
+ * Every entry outside the recycle bin contributes a small record with the
+ * length and HMAC of its password, its expiry time and the cached entropy
+ * rating of the password. The records are added to running totals and a
+ * password re-use histogram as soon as entries are added, modified, moved or
+ * deleted, so the statistics never have to score or compare passwords again.
+ * Only the expiry dependent counters are summed up on every request.
+ */
+class DatabaseStatsIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Counters
+    {
+        int groupCount = 0;
+        int entryCount = 0;
+        int expiredEntries = 0;
+        int excludedEntries = 0;
+        int weakPasswords = 0;
+        int shortPasswords = 0;
+        int uniquePasswords = 0;
+        int reusedPasswords = 0;
+        int totalPasswordLength = 0;
+        int maxPasswordReuse = 0;
+    };
+
+    static DatabaseStatsIndex* forDatabase(Database* db);
+
+    Counters counters();
+    qint64 memoryUsage() const;
+
+private slots:
+    void addEntry(Entry* entry);
+    void invalidateEntry();
+    void removeEntry(Entry* entry);
+    void removeDestroyedEntry(QObject* entry);
+    void invalidateGroups();
+    void clear();
+
+private:
+    struct Record
+    {
+        // HMAC of the password, empty if the entry has no password
+        QByteArray passwordId;
+        int passwordLength = 0;
+        // Password references are not counted as re-use by HealthChecker
+        bool reference = false;
+        bool excluded = false;
+        // Entropy of the password alone is rated weak or worse
+        bool weakEntropy = false;
+        // Invalid if the entry does not expire
+        QDateTime expiryTime;
+    };
+
+    struct PasswordUses
+    {
+        int count = 0;
+        int references = 0;
+    };
+
+    explicit DatabaseStatsIndex(Database* db);
+
+    void sweep();
+    void index(Entry* entry);
+    void drop(const Entry* entry);
+    Record makeRecord(const Entry* entry);
+
+    Database* m_db;
+    QPointer<Group> m_rootGroup;
+    QPointer<Group> m_recycleBin;
+    bool m_sweepPending = true;
+    int m_groupCount = -1;
+    QByteArray m_key;
+    QHash<const Entry*, Record> m_records;
+    QHash<QByteArray, PasswordUses> m_passwords;
+    int m_passwordCount = 0;
+    int m_excludedEntries = 0;
+    int m_shortPasswords = 0;
+    qint64 m_totalPasswordLength = 0;
+};
+
+#endif // KEEPASSXC_DATABASESTATSINDEX_H
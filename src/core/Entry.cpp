@@ -27,16 +27,55 @@
 #include "core/Tools.h"
 #include "core/Totp.h"
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QRegularExpression>
 #include <QStringBuilder>
 #include <QUrl>
 
+#include <algorithm>
+
 const int Entry::DefaultIconNumber = 0;
 
 namespace
 {
     const int ResolveMaximumDepth = 10;
+    const int PlaceholderCacheSize = 32;
+    // Seconds before the end of a TOTP time step in which the code of the next step is generated
+    const quint64 TotpPrecomputeSeconds = 3;
+
+    /**
+     * State of the outermost placeholder resolution running on this thread.
+     */
+    struct ResolveContext
+    {
+        // Reference chains can fan out on every level, each reference and remaining depth is only followed once
+        QHash<QPair<QString, int>, QString> resolvedReferences;
+        bool usesReferences = false;
+        // the result depends on the time or the database file and cannot be cached
+        bool isVolatile = false;
+    };
+
+    thread_local ResolveContext* t_resolveContext = nullptr;
+
+    void addInt(QCryptographicHash& hash, qint64 value)
+    {
+        hash.addData(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // The length is hashed as well, so consecutive strings cannot run into each other
+    void addString(QCryptographicHash& hash, const QString& value)
+    {
+        addInt(hash, value.size());
+        hash.addData(reinterpret_cast<const char*>(value.constData()), value.size() * sizeof(QChar));
+    }
+
+    void markVolatile()
+    {
+        if (t_resolveContext) {
+            t_resolveContext->isVolatile = true;
+        }
+    }
     const QString AutoTypeSequenceUsername = "{USERNAME}{ENTER}";
     const QString AutoTypeSequencePassword = "{PASSWORD}{ENTER}";
     const QRegularExpression TagDelimiterRegex(R"([,;\t])");
@@ -58,12 +97,13 @@ Entry::Entry()
     connect(m_attributes, &EntryAttributes::modified, this, &Entry::updateTotp);
     connect(m_attributes, &EntryAttributes::modified, this, &Entry::modified);
     connect(m_attributes, &EntryAttributes::defaultKeyModified, this, &Entry::emitDataChanged);
+    // The password may also be changed through the attributes or refer to another field
+    connect(m_attributes, &EntryAttributes::defaultKeyModified, this, [this] { m_data.passwordHealth.reset(); });
     connect(m_attachments, &EntryAttachments::modified, this, &Entry::modified);
     connect(m_autoTypeAssociations, &AutoTypeAssociations::modified, this, &Entry::modified);
     connect(m_customData, &CustomData::modified, this, &Entry::modified);
 
-    connect(this, &Entry::modified, this, &Entry::updateTimeinfo);
-    connect(this, &Entry::modified, this, &Entry::updateModifiedSinceBegin);
+    connect(this, &Entry::modified, this, &Entry::handleModified);
 }
 
 Entry::~Entry()
@@ -84,6 +124,8 @@ template <class T> inline bool Entry::set(T& property, const T& value)
 {
     if (property != value) {
         property = value;
+        // The modified signal may be blocked
+        clearPlaceholderCache();
         emitModified();
         return true;
     }
@@ -230,7 +272,7 @@ QString Entry::defaultAutoTypeSequence() const
 const QSharedPointer<PasswordHealth> Entry::passwordHealth()
 {
     if (!m_data.passwordHealth) {
-        m_data.passwordHealth.reset(new PasswordHealth(resolvePlaceholder(password())));
+        m_data.passwordHealth = calculatePasswordHealth();
     }
     return m_data.passwordHealth;
 }
@@ -238,11 +280,22 @@ const QSharedPointer<PasswordHealth> Entry::passwordHealth()
 const QSharedPointer<PasswordHealth> Entry::passwordHealth() const
 {
     if (!m_data.passwordHealth) {
-        return QSharedPointer<PasswordHealth>::create(resolvePlaceholder(password()));
+        return calculatePasswordHealth();
     }
     return m_data.passwordHealth;
 }
 
+QSharedPointer<PasswordHealth> Entry::calculatePasswordHealth() const
+{
+    const auto pwd = resolvePlaceholder(password());
+    // Entries of a database share the entropies of equal passwords
+    const auto db = database();
+    if (db) {
+        return QSharedPointer<PasswordHealth>::create(db->passwordEntropyCache()->entropy(pwd));
+    }
+    return QSharedPointer<PasswordHealth>::create(pwd);
+}
+
 bool Entry::excludeFromReports() const
 {
     return m_data.excludeFromReports
@@ -393,7 +446,7 @@ QStringList Entry::getAllUrls() const
 
     for (const auto& key : m_attributes->keys()) {
         if (key.startsWith(EntryAttributes::AdditionalUrlAttribute)
-            || key == QString("%1_RELYING_PARTY").arg(EntryAttributes::PasskeyAttribute)) {
+            || key == EntryAttributes::KPEX_PASSKEY_RELYING_PARTY) {
             auto additionalUrl = m_attributes->value(key);
             if (!additionalUrl.isEmpty()) {
                 urlList << resolveMultiplePlaceholders(additionalUrl);
@@ -438,6 +491,11 @@ QString Entry::attribute(const QString& key) const
 
 int Entry::size() const
 {
+    const quint64 modificationCount = dataModificationCount();
+    if (m_size >= 0 && m_sizeModificationCount == modificationCount) {
+        return m_size;
+    }
+
     int size = 0;
     size += attributes()->attributesSize();
     size += autoTypeAssociations()->associationsSize();
@@ -447,9 +505,92 @@ int Entry::size() const
         size += tag.toUtf8().size();
     }
 
+    m_size = size;
+    m_sizeModificationCount = modificationCount;
     return size;
 }
 
+/**
+ * Get a counter of all changes to the entry data, used to validate values derived from it.
+ *
+ * @return sum of the modification counts of the entry, its attributes, auto-type
+ *         associations, attachments and custom data
+ */
+quint64 Entry::dataModificationCount() const
+{
+    return modificationCount() + m_attributes->modificationCount() + m_autoTypeAssociations->modificationCount()
+           + m_attachments->modificationCount() + m_customData->modificationCount();
+}
+
+/**
+ * Get a hash of the data compared by Entry::equals(), except for the uuid, the times and the history.
+ *
+ * Attachments are represented by their names and sizes, so deferred attachments are not loaded.
+ *
+ * @return SHA-256 hash, cached until the entry data changes
+ */
+QByteArray Entry::contentHash() const
+{
+    const quint64 modificationCount = dataModificationCount();
+    if (!m_contentHash.isEmpty() && m_contentHashModificationCount == modificationCount) {
+        return m_contentHash;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    addInt(hash, m_data.iconNumber);
+    hash.addData(m_data.customIcon.toRfc4122());
+    addString(hash, m_data.foregroundColor);
+    addString(hash, m_data.backgroundColor);
+    addString(hash, m_data.overrideUrl);
+    addInt(hash, m_data.tags.size());
+    for (const auto& tag : m_data.tags) {
+        addString(hash, tag);
+    }
+    addInt(hash, m_data.autoTypeEnabled);
+    addInt(hash, m_data.autoTypeObfuscation);
+    addString(hash, m_data.defaultAutoTypeSequence);
+    addInt(hash, !m_data.totpSettings.isNull());
+    if (m_data.totpSettings) {
+        addString(hash, m_data.totpSettings->key);
+        addInt(hash, m_data.totpSettings->digits);
+        addInt(hash, m_data.totpSettings->step);
+    }
+    addInt(hash, m_data.excludeFromReports);
+    hash.addData(m_data.previousParentGroupUuid.toRfc4122());
+
+    const auto attributeKeys = m_attributes->keys();
+    addInt(hash, attributeKeys.size());
+    for (const auto& key : attributeKeys) {
+        addString(hash, key);
+        addString(hash, m_attributes->value(key));
+        addInt(hash, m_attributes->isProtected(key));
+    }
+    const auto attachmentKeys = m_attachments->keys();
+    addInt(hash, attachmentKeys.size());
+    for (const auto& key : attachmentKeys) {
+        addString(hash, key);
+        addInt(hash, m_attachments->valueSize(key));
+    }
+    // Custom data is kept in a hash table, its order differs between copies
+    auto customDataKeys = m_customData->keys();
+    std::sort(customDataKeys.begin(), customDataKeys.end());
+    addInt(hash, customDataKeys.size());
+    for (const auto& key : asConst(customDataKeys)) {
+        addString(hash, key);
+        addString(hash, m_customData->value(key));
+    }
+    const auto associations = m_autoTypeAssociations->getAll();
+    addInt(hash, associations.size());
+    for (const auto& association : associations) {
+        addString(hash, association.window);
+        addString(hash, association.sequence);
+    }
+
+    m_contentHash = hash.result();
+    m_contentHashModificationCount = modificationCount;
+    return m_contentHash;
+}
+
 bool Entry::isExpired() const
 {
     return willExpireInDays(0);
@@ -559,16 +700,43 @@ void Entry::removePasskey()
     removeTag(tr("Passkey"));
 }
 
+/**
+ * Get the TOTP code of the current time step.
+ *
+ * Codes are generated once per time step, and shortly before the step ends the
+ * code of the next step is generated as well, so the many places showing or
+ * copying the code of an entry do not compute the HMAC on every call.
+ *
+ * @return current TOTP code, empty if the entry has no TOTP
+ */
 QString Entry::totp() const
 {
-    if (hasTotp()) {
-        return Totp::generateTotp(m_data.totpSettings);
+    if (!hasTotp()) {
+        return {};
     }
-    return {};
+
+    const quint64 step = m_data.totpSettings->step;
+    const auto now = static_cast<quint64>(Clock::currentSecondsSinceEpoch());
+    const quint64 counter = now / step;
+    // Codes of past time steps are never requested again
+    while (!m_totpCodes.isEmpty() && m_totpCodes.firstKey() < counter) {
+        m_totpCodes.erase(m_totpCodes.begin());
+    }
+
+    auto code = m_totpCodes.constFind(counter);
+    if (code == m_totpCodes.constEnd()) {
+        code = m_totpCodes.insert(counter, Totp::generateTotp(m_data.totpSettings, now));
+    }
+    if (now % step + TotpPrecomputeSeconds >= step && !m_totpCodes.contains(counter + 1)) {
+        m_totpCodes.insert(counter + 1, Totp::generateTotp(m_data.totpSettings, (counter + 1) * step));
+    }
+    return code.value();
 }
 
 void Entry::setTotp(QSharedPointer<Totp::Settings> settings)
 {
+    // The settings may have been modified in place
+    m_totpCodes.clear();
     beginUpdate();
     m_attributes->remove(Totp::ATTRIBUTE_OTP);
     m_attributes->remove(Totp::ATTRIBUTE_SEED);
@@ -592,6 +760,7 @@ void Entry::setTotp(QSharedPointer<Totp::Settings> settings)
 
 void Entry::updateTotp()
 {
+    m_totpCodes.clear();
     if (m_attributes->contains(Totp::ATTRIBUTE_SETTINGS)) {
         m_data.totpSettings = Totp::parseSettings(m_attributes->value(Totp::ATTRIBUTE_SETTINGS),
                                                   m_attributes->value(Totp::ATTRIBUTE_SEED));
@@ -807,6 +976,20 @@ void Entry::addHistoryItem(Entry* entry)
 {
     Q_ASSERT(!entry->parent());
 
+    // Most fields are the same as in the entry or the previous history item, e.g. large notes
+    entry->m_attributes->shareValues(m_attributes);
+    if (!m_history.isEmpty()) {
+        entry->m_attributes->shareValues(m_history.last()->m_attributes);
+    }
+
+    // History items are snapshots that are never edited, they do not need to track their own changes
+    entry->m_attributes->disconnect(entry);
+    entry->m_attachments->disconnect(entry);
+    entry->m_autoTypeAssociations->disconnect(entry);
+    entry->m_customData->disconnect(entry);
+    disconnect(entry, nullptr, entry, nullptr);
+    entry->clearPlaceholderCache();
+
     entry->setHistoryOwner(this);
     m_history.append(entry);
     emitModified();
@@ -840,6 +1023,26 @@ void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
     emitModified();
 }
 
+/**
+ * Remove all history items without deleting them.
+ *
+ * @return former history items, owned by the caller
+ */
+QList<Entry*> Entry::takeHistoryItems()
+{
+    const auto historyEntries = m_history;
+    if (historyEntries.isEmpty()) {
+        return {};
+    }
+
+    m_history.clear();
+    for (Entry* entry : historyEntries) {
+        entry->setHistoryOwner(nullptr);
+    }
+    emitModified();
+    return historyEntries;
+}
+
 void Entry::truncateHistory()
 {
     const Database* db = database();
@@ -867,23 +1070,17 @@ void Entry::truncateHistory()
 
     int histMaxSize = db->metadata()->historyMaxSize();
     if (histMaxSize > -1) {
-        int size = 0;
-
-        QMutableListIterator<Entry*> i(m_history);
-        i.toBack();
-        while (i.hasPrevious()) {
-            Entry* historyItem = i.previous();
-
-            // don't calculate size if it's already above the maximum
-            if (size <= histMaxSize) {
-                size += historyItem->size();
-            }
+        // Sizes are cached, dropping the oldest items keeps the same newest items within the limit
+        qint64 size = 0;
+        for (const Entry* historyItem : asConst(m_history)) {
+            size += historyItem->size();
+        }
 
-            if (size > histMaxSize) {
-                delete historyItem;
-                i.remove();
-                changed = true;
-            }
+        while (size > histMaxSize && !m_history.isEmpty()) {
+            Entry* historyItem = m_history.takeFirst();
+            size -= historyItem->size();
+            delete historyItem;
+            changed = true;
         }
     }
 
@@ -987,6 +1184,9 @@ void Entry::copyDataFrom(const Entry* other)
 {
     setUpdateTimeinfo(false);
     m_data = other->m_data;
+    m_size = -1;
+    m_contentHash.clear();
+    clearPlaceholderCache();
     m_customData->copyDataFrom(other->m_customData);
     m_attributes->copyDataFrom(other->m_attributes);
     m_attachments->copyDataFrom(other->m_attachments);
@@ -1028,6 +1228,26 @@ void Entry::updateModifiedSinceBegin()
     m_modifiedSinceBegin = true;
 }
 
+/**
+ * Update the entry after it was modified and notify its database, which does not
+ * connect to every entry.
+ */
+void Entry::handleModified()
+{
+    updateTimeinfo();
+    updateModifiedSinceBegin();
+    clearPlaceholderCache();
+    if (m_group && m_group->database()) {
+        m_group->database()->notifyObjectModified();
+    }
+}
+
+void Entry::clearPlaceholderCache()
+{
+    QMutexLocker locker(&m_placeholderCacheMutex);
+    m_placeholderCache.clear();
+}
+
 QString Entry::resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth) const
 {
     static const QRegularExpression placeholderRegEx(R"(\{[^}]+\})");
@@ -1076,6 +1296,7 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
     case PlaceholderType::Url:
         return resolveMultiplePlaceholdersRecursive(url(), maxDepth - 1);
     case PlaceholderType::DbDir: {
+        markVolatile();
         QFileInfo fileInfo(database()->filePath());
         return fileInfo.absoluteDir().absolutePath();
     }
@@ -1094,6 +1315,7 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
     }
     case PlaceholderType::Totp:
         // totp can't have placeholder inside
+        markVolatile();
         return totp();
     case PlaceholderType::CustomAttribute: {
         const QString key = placeholder.mid(3, placeholder.length() - 4); // {S:attr} => mid(3, len - 4)
@@ -1115,6 +1337,7 @@ QString Entry::resolvePlaceholderRecursive(const QString& placeholder, int maxDe
     case PlaceholderType::DateTimeUtcHour:
     case PlaceholderType::DateTimeUtcMinute:
     case PlaceholderType::DateTimeUtcSecond:
+        markVolatile();
         return resolveMultiplePlaceholdersRecursive(resolveDateTimePlaceholder(typeOfPlaceholder), maxDepth - 1);
     }
 
@@ -1179,6 +1402,14 @@ QString Entry::resolveReferencePlaceholderRecursive(const QString& placeholder,
         return placeholder;
     }
 
+    if (t_resolveContext) {
+        t_resolveContext->usesReferences = true;
+        auto resolved = t_resolveContext->resolvedReferences.constFind(qMakePair(placeholder, maxDepth));
+        if (resolved != t_resolveContext->resolvedReferences.constEnd()) {
+            return resolved.value();
+        }
+    }
+
     QString result;
     const QString searchIn = match.captured(EntryAttributes::SearchInGroupName);
     const QString searchText = match.captured(EntryAttributes::SearchTextGroupName);
@@ -1197,6 +1428,9 @@ QString Entry::resolveReferencePlaceholderRecursive(const QString& placeholder,
         result = refEntry->resolveMultiplePlaceholdersRecursive(result, maxDepth - 1);
     }
 
+    if (t_resolveContext) {
+        t_resolveContext->resolvedReferences.insert(qMakePair(placeholder, maxDepth), result);
+    }
     return result;
 }
 
@@ -1283,6 +1517,10 @@ void Entry::setGroup(Group* group, bool trackPrevious)
 void Entry::emitDataChanged()
 {
     emit entryDataChanged(this);
+    // The group is not connected to each of its entries
+    if (m_group) {
+        emit m_group->entryDataChanged(this);
+    }
 }
 
 const Database* Entry::database() const
@@ -1322,12 +1560,70 @@ Entry* Entry::resolveReference(const QString& str) const
 
 QString Entry::resolveMultiplePlaceholders(const QString& str) const
 {
-    return resolveMultiplePlaceholdersRecursive(str, ResolveMaximumDepth);
+    return resolveCached(str, false);
 }
 
 QString Entry::resolvePlaceholder(const QString& placeholder) const
 {
-    return resolvePlaceholderRecursive(placeholder, ResolveMaximumDepth);
+    return resolveCached(placeholder, true);
+}
+
+/**
+ * Resolve placeholders through the cache of this entry.
+ *
+ * Results stay valid until this entry is modified, or if they followed
+ * references, until anything in the database is modified. Results that
+ * depend on the time or the database file are not cached.
+ *
+ * @param str string to resolve
+ * @param singlePlaceholder whether to resolve str as one placeholder
+ * @return resolved string
+ */
+QString Entry::resolveCached(const QString& str, bool singlePlaceholder) const
+{
+    if (!str.contains('{')) {
+        return str;
+    }
+
+    // Nested resolutions belong to the outer one which is cached as a whole
+    if (t_resolveContext) {
+        return singlePlaceholder ? resolvePlaceholderRecursive(str, ResolveMaximumDepth)
+                                 : resolveMultiplePlaceholdersRecursive(str, ResolveMaximumDepth);
+    }
+
+    QString key = str;
+    if (!singlePlaceholder) {
+        key.prepend(QChar(0));
+    }
+    const Database* db = database();
+    {
+        QMutexLocker locker(&m_placeholderCacheMutex);
+        auto it = m_placeholderCache.constFind(key);
+        if (it != m_placeholderCache.constEnd()
+            && (!it->database || (it->database == db && it->dataRevision == db->dataRevision()))) {
+            return it->value;
+        }
+    }
+
+    ResolveContext context;
+    t_resolveContext = &context;
+    QString result = singlePlaceholder ? resolvePlaceholderRecursive(str, ResolveMaximumDepth)
+                                       : resolveMultiplePlaceholdersRecursive(str, ResolveMaximumDepth);
+    t_resolveContext = nullptr;
+
+    if (!context.isVolatile) {
+        QMutexLocker locker(&m_placeholderCacheMutex);
+        if (m_placeholderCache.size() >= PlaceholderCacheSize) {
+            m_placeholderCache.clear();
+        }
+        ResolvedPlaceholder resolved{result, nullptr, 0};
+        if (context.usesReferences && db) {
+            resolved.database = db;
+            resolved.dataRevision = db->dataRevision();
+        }
+        m_placeholderCache.insert(key, resolved);
+    }
+    return result;
 }
 
 QString Entry::resolveUrlPlaceholder(const QString& str, Entry::PlaceholderType placeholderType) const
@@ -19,7 +19,9 @@
 #ifndef KEEPASSX_ENTRY_H
 #define KEEPASSX_ENTRY_H
 
+#include <QHash>
 #include <QMap>
+#include <QMutex>
 #include <QPointer>
 #include <QUuid>
 
@@ -114,6 +116,8 @@ public:
     const Group* previousParentGroup() const;
     QUuid previousParentGroupUuid() const;
     int size() const;
+    quint64 dataModificationCount() const;
+    QByteArray contentHash() const;
     QString path() const;
     const QSharedPointer<PasswordHealth> passwordHealth();
     const QSharedPointer<PasswordHealth> passwordHealth() const;
@@ -171,6 +175,7 @@ public:
     void setHistoryOwner(Entry* entry);
     Entry* historyOwner() const;
     void removeHistoryItems(const QList<Entry*>& historyEntries);
+    QList<Entry*> takeHistoryItems();
     void truncateHistory();
 
     bool equals(const Entry* other, CompareItemOptions options = CompareItemDefault) const;
@@ -276,13 +281,25 @@ private slots:
     void emitDataChanged();
     void updateTimeinfo();
     void updateModifiedSinceBegin();
+    void handleModified();
     void updateTotp();
+    void clearPlaceholderCache();
 
 private:
+    struct ResolvedPlaceholder
+    {
+        QString value;
+        // only set if references were resolved, which depend on the state of the whole database
+        const Database* database;
+        quint64 dataRevision;
+    };
+
+    QString resolveCached(const QString& str, bool singlePlaceholder) const;
     QString resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth) const;
     QString resolvePlaceholderRecursive(const QString& placeholder, int maxDepth) const;
     QString resolveReferencePlaceholderRecursive(const QString& placeholder, int maxDepth) const;
     QString referenceFieldValue(EntryReferenceType referenceType) const;
+    QSharedPointer<PasswordHealth> calculatePasswordHealth() const;
 
     static QString buildReference(const QUuid& uuid, const QString& field);
     static EntryReferenceType referenceType(const QString& referenceStr);
@@ -302,6 +319,20 @@ private:
     bool m_modifiedSinceBegin;
     QPointer<Group> m_group;
     bool m_updateTimeinfo;
+
+    // Resolved placeholders keyed by the string, resolveMultiplePlaceholders() keys are prefixed with a null character
+    mutable QHash<QString, ResolvedPlaceholder> m_placeholderCache;
+    mutable QMutex m_placeholderCacheMutex;
+
+    // Cached size(), valid as long as the entry and its parts were not modified
+    mutable int m_size = -1;
+    mutable quint64 m_sizeModificationCount = 0;
+    // Cached contentHash(), valid as long as the entry and its parts were not modified
+    mutable QByteArray m_contentHash;
+    mutable quint64 m_contentHashModificationCount = 0;
+
+    // Generated TOTP codes keyed by time step, cleared whenever the TOTP settings change
+    mutable QMap<quint64, QString> m_totpCodes;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Entry::CloneFlags)
@@ -24,11 +24,20 @@
 
 #include <QDesktopServices>
 #include <QDir>
+#include <QIODevice>
 #include <QProcessEnvironment>
 #include <QSet>
 #include <QTemporaryFile>
 #include <QUrl>
 
+#include <limits>
+
+namespace
+{
+    // Large attachments are copied between devices and memory in pieces of this size
+    const qint64 AttachmentChunkSize = 1024 * 1024;
+} // namespace
+
 EntryAttachments::EntryAttachments(QObject* parent)
     : ModifiableObject(parent)
 {
@@ -51,11 +60,21 @@ bool EntryAttachments::hasKey(const QString& key) const
 
 QSet<QByteArray> EntryAttachments::values() const
 {
+    loadDeferred();
     return Tools::asSet(m_attachments.values());
 }
 
+/**
+ * @return data of the attachments held in memory, deferred attachments that were not loaded yet are empty
+ */
+QList<QByteArray> EntryAttachments::loadedValues() const
+{
+    return m_attachments.values();
+}
+
 QByteArray EntryAttachments::value(const QString& key) const
 {
+    resolve(key);
     return m_attachments.value(key);
 }
 
@@ -63,12 +82,13 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
 {
     bool shouldEmitModified = false;
     bool addAttachment = !m_attachments.contains(key);
+    bool wasDeferred = m_deferred.remove(key) > 0;
 
     if (addAttachment) {
         emit aboutToBeAdded(key);
     }
 
-    if (addAttachment || m_attachments.value(key) != value) {
+    if (addAttachment || wasDeferred || m_attachments.value(key) != value) {
         m_attachments.insert(key, value);
         shouldEmitModified = true;
     }
@@ -84,6 +104,132 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
     }
 }
 
+/**
+ * Add an attachment whose data is read from its loader on first access.
+ *
+ * @param key attachment name
+ * @param deferred loader and index of the attachment data
+ */
+void EntryAttachments::setDeferred(const QString& key, const DeferredAttachment& deferred)
+{
+    bool addAttachment = !m_attachments.contains(key);
+
+    if (addAttachment) {
+        emit aboutToBeAdded(key);
+    }
+
+    m_attachments.insert(key, {});
+    m_deferred.insert(key, deferred);
+
+    if (addAttachment) {
+        emit added(key);
+    } else {
+        emit keyModified(key);
+    }
+
+    emitModified();
+}
+
+/**
+ * Set an attachment to the remaining contents of a device. The data is read into a
+ * single buffer of the final size where the size of the device is known.
+ *
+ * @param key attachment key
+ * @param device device opened for reading
+ * @return true on success, the device error string describes failures
+ */
+bool EntryAttachments::readFrom(const QString& key, QIODevice* device)
+{
+    QByteArray data;
+    const qint64 size = device->isSequential() ? -1 : device->size() - device->pos();
+    if (size < 0 || size > std::numeric_limits<int>::max()) {
+        if (!Tools::readAllFromDevice(device, data)) {
+            return false;
+        }
+    } else {
+        data.resize(static_cast<int>(size));
+        qint64 readBytes = 0;
+        while (readBytes < size) {
+            const qint64 readResult =
+                device->read(data.data() + readBytes, qMin(size - readBytes, AttachmentChunkSize));
+            if (readResult < 0) {
+                return false;
+            }
+            if (readResult == 0) {
+                // The file shrunk while reading it
+                data.resize(static_cast<int>(readBytes));
+                break;
+            }
+            readBytes += readResult;
+        }
+    }
+
+    set(key, data);
+    return true;
+}
+
+/**
+ * Write the data of an attachment to a device. Deferred attachments are loaded
+ * for writing only and stay deferred.
+ *
+ * @param key attachment key
+ * @param device device opened for writing
+ * @param error receives the reason if the attachment could not be loaded or written
+ * @return true on success
+ */
+bool EntryAttachments::writeTo(const QString& key, QIODevice* device, QString* error) const
+{
+    QByteArray data;
+    auto deferred = m_deferred.constFind(key);
+    if (deferred != m_deferred.constEnd()) {
+        data = deferred->loader->load(deferred->index);
+        if (data.size() != deferred->size) {
+            if (error) {
+                *error = tr("Unable to load attachment %1: %2").arg(key, deferred->loader->errorString());
+            }
+            return false;
+        }
+    } else {
+        data = m_attachments.value(key);
+    }
+
+    qint64 writtenBytes = 0;
+    while (writtenBytes < data.size()) {
+        const qint64 writeResult =
+            device->write(data.constData() + writtenBytes, qMin(data.size() - writtenBytes, AttachmentChunkSize));
+        if (writeResult <= 0) {
+            if (error) {
+                *error = device->errorString();
+            }
+            return false;
+        }
+        writtenBytes += writeResult;
+    }
+    return true;
+}
+
+bool EntryAttachments::isDeferred(const QString& key) const
+{
+    return m_deferred.contains(key);
+}
+
+/**
+ * Load the data of all deferred attachments into memory.
+ *
+ * @param error receives the reason if an attachment could not be loaded
+ * @return true if no attachment is deferred anymore
+ */
+bool EntryAttachments::loadDeferred(QString* error) const
+{
+    bool ok = true;
+    const auto keys = m_deferred.keys();
+    for (const auto& key : keys) {
+        // The first failure is reported, the other attachments are still loaded if possible
+        ok = resolve(key, ok ? error : nullptr) && ok;
+    }
+    return ok;
+}
+
 void EntryAttachments::remove(const QString& key)
 {
     if (!m_attachments.contains(key)) {
@@ -94,6 +240,7 @@ void EntryAttachments::remove(const QString& key)
     emit aboutToBeRemoved(key);
 
     m_attachments.remove(key);
+    m_deferred.remove(key);
 
     if (m_openedAttachments.contains(key)) {
         disconnectAndEraseExternalFile(m_openedAttachments.value(key));
@@ -146,6 +293,7 @@ void EntryAttachments::clear()
     emit aboutToBeReset();
 
     m_attachments.clear();
+    m_deferred.clear();
 
     const auto externalPath = m_openedAttachments.values();
     for (auto& path : externalPath) {
@@ -189,6 +337,7 @@ void EntryAttachments::copyDataFrom(const EntryAttachments* other)
         }
 
         m_attachments = other->m_attachments;
+        m_deferred = other->m_deferred;
 
         emit reset();
         emitModified();
@@ -197,27 +346,102 @@ void EntryAttachments::copyDataFrom(const EntryAttachments* other)
 
 bool EntryAttachments::operator==(const EntryAttachments& other) const
 {
-    return m_attachments == other.m_attachments;
+    if (m_attachments.size() != other.m_attachments.size()) {
+        return false;
+    }
+
+    // Loading a deferred attachment modifies the maps, iterate over shallow copies
+    const auto attachments = m_attachments;
+    const auto otherAttachments = other.m_attachments;
+    for (auto it = attachments.constBegin(), otherIt = otherAttachments.constBegin(); it != attachments.constEnd();
+         ++it, ++otherIt) {
+        const QString& key = it.key();
+        if (key != otherIt.key()) {
+            return false;
+        }
+
+        // Attachments deferred to the same source are equal without loading them
+        const bool deferred = m_deferred.contains(key);
+        const bool otherDeferred = other.m_deferred.contains(key);
+        if (deferred && otherDeferred && m_deferred.value(key) == other.m_deferred.value(key)) {
+            continue;
+        }
+        if (!deferred && !otherDeferred) {
+            // Copies of an entry share the data of their attachments, which is equal without comparing it
+            const QByteArray& data = it.value();
+            const QByteArray& otherData = otherIt.value();
+            if ((data.constData() == otherData.constData() && data.size() == otherData.size()) || data == otherData) {
+                continue;
+            }
+            return false;
+        }
+        if (value(key) != other.value(key)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool EntryAttachments::operator!=(const EntryAttachments& other) const
 {
-    return m_attachments != other.m_attachments;
+    return !(*this == other);
+}
+
+/**
+ * @param key name of the attachment
+ * @return size of the attachment data, without loading a deferred attachment
+ */
+int EntryAttachments::valueSize(const QString& key) const
+{
+    auto deferred = m_deferred.constFind(key);
+    return deferred != m_deferred.constEnd() ? deferred->size : m_attachments.value(key).size();
 }
 
 int EntryAttachments::attachmentsSize() const
 {
     int size = 0;
     for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
-        size += it.key().toUtf8().size() + it.value().size();
+        auto deferred = m_deferred.constFind(it.key());
+        size += it.key().toUtf8().size() + (deferred != m_deferred.constEnd() ? deferred->size : it.value().size());
     }
     return size;
 }
 
+/**
+ * Load the data of a deferred attachment into memory.
+ *
+ * An attachment that could not be loaded stays deferred, so a later access can retry
+ * and saving the database fails instead of writing it empty.
+ *
+ * @param key name of the attachment
+ * @param error receives the reason if the attachment could not be loaded
+ * @return true if the attachment is not deferred anymore
+ */
+bool EntryAttachments::resolve(const QString& key, QString* error) const
+{
+    auto deferred = m_deferred.find(key);
+    if (deferred == m_deferred.end()) {
+        return true;
+    }
+
+    QByteArray data = deferred->loader->load(deferred->index);
+    if (data.size() != deferred->size) {
+        const auto message = tr("Unable to load attachment %1: %2").arg(key, deferred->loader->errorString());
+        qWarning("EntryAttachments: %s", qPrintable(message));
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+
+    m_attachments.insert(key, data);
+    m_deferred.erase(deferred);
+    return true;
+}
+
 bool EntryAttachments::openAttachment(const QString& key, QString* errorMessage)
 {
     if (!m_openedAttachments.contains(key)) {
-        const QByteArray attachmentData = value(key);
         auto ext = key.contains(".") ? "." + key.split(".").last() : "";
 
 #if defined(KEEPASSXC_DIST_SNAP)
@@ -234,7 +458,7 @@ bool EntryAttachments::openAttachment(const QString& key, QString* errorMessage)
         QTemporaryFile tmpFile(tmpFileTemplate);
 
         const bool saveOk = tmpFile.open() && tmpFile.setPermissions(QFile::ReadOwner | QFile::WriteOwner)
-                            && tmpFile.write(attachmentData) == attachmentData.size() && tmpFile.flush();
+                            && writeTo(key, &tmpFile) && tmpFile.flush();
 
         if (!saveOk && errorMessage) {
             *errorMessage = QString("%1 - %2").arg(key, tmpFile.errorString());
@@ -28,6 +28,33 @@
 
 class QStringList;
 
+/**
+ * Source of attachment data that is only read when first accessed.
+ */
+class AttachmentLoader
+{
+public:
+    virtual ~AttachmentLoader() = default;
+
+    virtual QByteArray load(int index) = 0;
+    virtual void prefetchAll() = 0;
+    virtual void releasePrefetched() = 0;
+    // Describes why the last load failed
+    virtual QString errorString() const = 0;
+};
+
+struct DeferredAttachment
+{
+    QSharedPointer<AttachmentLoader> loader;
+    int index = -1;
+    int size = 0;
+
+    bool operator==(const DeferredAttachment& other) const
+    {
+        return loader == other.loader && index == other.index;
+    }
+};
+
 class EntryAttachments : public ModifiableObject
 {
     Q_OBJECT
@@ -38,8 +65,15 @@ public:
     QList<QString> keys() const;
     bool hasKey(const QString& key) const;
     QSet<QByteArray> values() const;
+    QList<QByteArray> loadedValues() const;
     QByteArray value(const QString& key) const;
+    int valueSize(const QString& key) const;
     void set(const QString& key, const QByteArray& value);
+    bool readFrom(const QString& key, QIODevice* device);
+    bool writeTo(const QString& key, QIODevice* device, QString* error = nullptr) const;
+    void setDeferred(const QString& key, const DeferredAttachment& deferred);
+    bool isDeferred(const QString& key) const;
+    bool loadDeferred(QString* error = nullptr) const;
     void remove(const QString& key);
     void remove(const QStringList& keys);
     void rename(const QString& key, const QString& newKey);
@@ -66,8 +100,11 @@ private slots:
 
 private:
     void disconnectAndEraseExternalFile(const QString& path);
+    bool resolve(const QString& key, QString* error = nullptr) const;
 
-    QMap<QString, QByteArray> m_attachments;
+    // Deferred attachments keep an empty placeholder in m_attachments until loaded
+    mutable QMap<QString, QByteArray> m_attachments;
+    mutable QHash<QString, DeferredAttachment> m_deferred;
     QHash<QString, QString> m_openedAttachments;
     QHash<QString, QString> m_openedAttachmentsInverse;
     QHash<QString, QSharedPointer<FileWatcher>> m_attachmentFileWatchers;
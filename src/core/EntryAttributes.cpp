@@ -51,6 +51,30 @@ const QString EntryAttributes::KPEX_PASSKEY_PRIVATE_KEY_END = QStringLiteral("--
 const QString EntryAttributes::KPEX_PASSKEY_GENERATED_USER_ID = QStringLiteral("KPEX_PASSKEY_GENERATED_USER_ID");
 const QString EntryAttributes::KPXC_PASSKEY_USERNAME = QStringLiteral("KPXC_PASSKEY_USERNAME");
 
+namespace
+{
+    /**
+     * Get the shared copy of a well known key.
+     *
+     * Keys read from a file are separate strings for every entry and history item otherwise.
+     */
+    QString internedKey(const QString& key)
+    {
+        static const QSet<QString> keys = [] {
+            QSet<QString> keys = Tools::asSet(EntryAttributes::DefaultAttributes);
+            keys << EntryAttributes::RememberCmdExecAttr << EntryAttributes::AdditionalUrlAttribute
+                 << EntryAttributes::KPXC_PASSKEY_USERNAME << EntryAttributes::KPEX_PASSKEY_USERNAME
+                 << EntryAttributes::KPEX_PASSKEY_CREDENTIAL_ID << EntryAttributes::KPEX_PASSKEY_GENERATED_USER_ID
+                 << EntryAttributes::KPEX_PASSKEY_PRIVATE_KEY_PEM << EntryAttributes::KPEX_PASSKEY_RELYING_PARTY
+                 << EntryAttributes::KPEX_PASSKEY_USER_HANDLE;
+            return keys;
+        }();
+
+        const auto it = keys.constFind(key);
+        return it != keys.constEnd() ? *it : key;
+    }
+} // namespace
+
 EntryAttributes::EntryAttributes(QObject* parent)
     : ModifiableObject(parent)
 {
@@ -153,16 +177,19 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
         emit aboutToBeAdded(key);
     }
 
-    if (addAttribute || changeValue) {
+    if (addAttribute) {
+        m_attributes.insert(internedKey(key), value);
+        shouldEmitModified = true;
+    } else if (changeValue) {
         m_attributes.insert(key, value);
         shouldEmitModified = true;
     }
 
     if (protect) {
         if (!m_protectedAttributes.contains(key)) {
+            m_protectedAttributes.insert(internedKey(key));
             shouldEmitModified = true;
         }
-        m_protectedAttributes.insert(key);
     } else if (m_protectedAttributes.remove(key)) {
         shouldEmitModified = true;
     }
@@ -218,10 +245,10 @@ void EntryAttributes::rename(const QString& oldKey, const QString& newKey)
     emit aboutToRename(oldKey, newKey);
 
     m_attributes.remove(oldKey);
-    m_attributes.insert(newKey, data);
+    m_attributes.insert(internedKey(newKey), data);
     if (protect) {
         m_protectedAttributes.remove(oldKey);
-        m_protectedAttributes.insert(newKey);
+        m_protectedAttributes.insert(internedKey(newKey));
     }
 
     emitModified();
@@ -293,6 +320,23 @@ void EntryAttributes::copyDataFrom(const EntryAttributes* other)
     }
 }
 
+/**
+ * Let values equal to those of other attributes share their memory.
+ *
+ * The attributes do not change, so nothing is emitted.
+ *
+ * @param other attributes to share with
+ */
+void EntryAttributes::shareValues(const EntryAttributes* other)
+{
+    for (auto it = m_attributes.begin(); it != m_attributes.end(); ++it) {
+        const auto otherValue = other->m_attributes.constFind(it.key());
+        if (otherValue != other->m_attributes.constEnd() && otherValue.value() == it.value()) {
+            it.value() = otherValue.value();
+        }
+    }
+}
+
 QUuid EntryAttributes::referenceUuid(const QString& key) const
 {
     if (!m_attributes.contains(key)) {
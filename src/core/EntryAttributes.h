@@ -50,6 +50,7 @@ public:
     void clear();
     int attributesSize() const;
     void copyDataFrom(const EntryAttributes* other);
+    void shareValues(const EntryAttributes* other);
     QUuid referenceUuid(const QString& key) const;
     bool operator==(const EntryAttributes& other) const;
     bool operator!=(const EntryAttributes& other) const;
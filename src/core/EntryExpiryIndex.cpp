@@ -0,0 +1,271 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntryExpiryIndex.h"
+
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+
+#include <QMetaMethod>
+
+namespace
+{
+    // Timers cannot be armed for more than about 24 days, far away expiry times are approached in steps
+    const qint64 MaxTimerInterval = 24 * 60 * 60 * 1000;
+} // namespace
+
+EntryExpiryIndex::EntryExpiryIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &EntryExpiryIndex::notifyExpired);
+
+    // Entries of an added or moved group do not emit entryAdded and may have entered the recycle bin
+    connect(db, &Database::groupAdded, this, &EntryExpiryIndex::invalidateGroups);
+    connect(db, &Database::groupRemoved, this, &EntryExpiryIndex::invalidateGroups);
+    connect(db, &Database::groupMoved, this, &EntryExpiryIndex::invalidateGroups);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &EntryExpiryIndex::clear);
+    connect(db, &Database::databaseDiscarded, this, &EntryExpiryIndex::clear);
+}
+
+/**
+ * Get the expiry index of a database, creating it on first use.
+ *
+ * The index has to be used from the thread of the database.
+ *
+ * @param db database to index
+ * @return index owned by the database
+ */
+EntryExpiryIndex* EntryExpiryIndex::forDatabase(Database* db)
+{
+    auto index = db->findChild<EntryExpiryIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index) {
+        index = new EntryExpiryIndex(db);
+    }
+    return index;
+}
+
+/**
+ * Find the entries that expire before a point in time, the same check as Entry::willExpireInDays().
+ *
+ * @param time end of the period, usually an offset from Clock::currentDateTime()
+ * @return entries outside the recycle bin ordered by their expiry time
+ */
+QList<Entry*> EntryExpiryIndex::entriesExpiringBefore(const QDateTime& time)
+{
+    ensureCurrent();
+
+    QList<Entry*> entries;
+    const QMultiMap<QDateTime, Entry*>::const_iterator end = m_queue.lowerBound(time);
+    for (auto it = m_queue.constBegin(); it != end; ++it) {
+        entries.append(it.value());
+    }
+    return entries;
+}
+
+/**
+ * @param time point in time to look after
+ * @return first expiry time later than the given time, invalid if no entry expires after it
+ */
+QDateTime EntryExpiryIndex::nextExpiryAfter(const QDateTime& time)
+{
+    ensureCurrent();
+
+    const QMultiMap<QDateTime, Entry*>::const_iterator next = m_queue.upperBound(time);
+    return next != m_queue.constEnd() ? next.key() : QDateTime();
+}
+
+void EntryExpiryIndex::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&EntryExpiryIndex::entriesExpired)) {
+        ensureCurrent();
+        scheduleTimer();
+    }
+}
+
+void EntryExpiryIndex::addEntry(Entry* entry)
+{
+    drop(entry);
+    if (entry->database() == m_db) {
+        index(entry);
+    }
+    scheduleTimer();
+}
+
+void EntryExpiryIndex::invalidateEntry()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry) {
+        addEntry(entry);
+    }
+}
+
+void EntryExpiryIndex::removeEntry(Entry* entry)
+{
+    drop(entry);
+    disconnect(entry, nullptr, this, nullptr);
+    scheduleTimer();
+}
+
+void EntryExpiryIndex::removeDestroyedEntry(QObject* entry)
+{
+    // The entry is already destroyed at this point, only its address is used
+    drop(static_cast<const Entry*>(entry));
+}
+
+void EntryExpiryIndex::invalidateGroups()
+{
+    m_sweepPending = true;
+    rearmTimer();
+}
+
+void EntryExpiryIndex::clear()
+{
+    if (m_rootGroup) {
+        for (const auto* group : m_rootGroup->groupsRecursive(true)) {
+            disconnect(group, nullptr, this, nullptr);
+            for (const auto* entry : group->entries()) {
+                disconnect(entry, nullptr, this, nullptr);
+            }
+        }
+    }
+    for (auto it = m_expiryTimes.constBegin(); it != m_expiryTimes.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    m_queue.clear();
+    m_expiryTimes.clear();
+    m_rootGroup = m_db->rootGroup();
+    m_recycleBin = m_db->metadata()->recycleBin();
+    m_sweepPending = true;
+    m_nextExpiry = QDateTime();
+    rearmTimer();
+}
+
+void EntryExpiryIndex::notifyExpired()
+{
+    ensureCurrent();
+    // The timer may have been armed in steps for an expiry time that is still ahead
+    const auto now = Clock::currentDateTime();
+    if (m_nextExpiry.isValid() && m_nextExpiry < now) {
+        emit entriesExpired();
+    }
+    scheduleTimer();
+}
+
+void EntryExpiryIndex::ensureCurrent()
+{
+    if (m_rootGroup != m_db->rootGroup() || m_recycleBin != m_db->metadata()->recycleBin()) {
+        clear();
+    }
+    if (m_sweepPending) {
+        sweep();
+    }
+}
+
+/**
+ * Index all entries of the database that are not indexed yet.
+ */
+void EntryExpiryIndex::sweep()
+{
+    m_sweepPending = false;
+    m_rootGroup = m_db->rootGroup();
+    m_recycleBin = m_db->metadata()->recycleBin();
+    if (!m_rootGroup) {
+        return;
+    }
+
+    for (auto* group : m_rootGroup->groupsRecursive(true)) {
+        connect(group, &Group::entryAdded, this, &EntryExpiryIndex::addEntry, Qt::UniqueConnection);
+        connect(group, &Group::entryRemoved, this, &EntryExpiryIndex::removeEntry, Qt::UniqueConnection);
+
+        const bool recycled = group->isRecycled();
+        for (auto* entry : group->entries()) {
+            // The group may have been moved into the recycle bin
+            if (recycled) {
+                drop(entry);
+            }
+            if (!m_expiryTimes.contains(entry)) {
+                index(entry);
+            }
+        }
+    }
+    scheduleTimer();
+}
+
+void EntryExpiryIndex::index(Entry* entry)
+{
+    connect(entry, &Entry::modified, this, &EntryExpiryIndex::invalidateEntry, Qt::UniqueConnection);
+    connect(entry, &QObject::destroyed, this, &EntryExpiryIndex::removeDestroyedEntry, Qt::UniqueConnection);
+    // Entries in the recycle bin and entries that do not expire are only watched
+    if (entry->isRecycled() || !entry->timeInfo().expires()) {
+        return;
+    }
+
+    const auto expiryTime = entry->timeInfo().expiryTime();
+    m_queue.insert(expiryTime, entry);
+    m_expiryTimes.insert(entry, expiryTime);
+}
+
+void EntryExpiryIndex::drop(const Entry* entry)
+{
+    auto it = m_expiryTimes.find(entry);
+    if (it == m_expiryTimes.end()) {
+        return;
+    }
+
+    m_queue.remove(it.value(), const_cast<Entry*>(entry));
+    m_expiryTimes.erase(it);
+}
+
+/**
+ * Let the timer sweep the database and look for the next expiry time again.
+ */
+void EntryExpiryIndex::rearmTimer()
+{
+    if (isSignalConnected(QMetaMethod::fromSignal(&EntryExpiryIndex::entriesExpired))) {
+        m_timer.start(0);
+    } else {
+        m_timer.stop();
+    }
+}
+
+/**
+ * Arm the timer for the next expiry time while somebody listens to entriesExpired().
+ */
+void EntryExpiryIndex::scheduleTimer()
+{
+    m_nextExpiry = QDateTime();
+    if (!isSignalConnected(QMetaMethod::fromSignal(&EntryExpiryIndex::entriesExpired))) {
+        m_timer.stop();
+        return;
+    }
+
+    const auto now = Clock::currentDateTime();
+    const QMultiMap<QDateTime, Entry*>::const_iterator next = m_queue.upperBound(now);
+    if (next == m_queue.constEnd()) {
+        m_timer.stop();
+        return;
+    }
+    // Expiry is checked with a strict comparison, so wait until just after the expiry time
+    m_nextExpiry = next.key();
+    const auto interval = qBound<qint64>(0, now.msecsTo(next.key()) + 1, MaxTimerInterval);
+    m_timer.start(static_cast<int>(interval));
+}
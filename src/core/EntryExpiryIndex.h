@@ -0,0 +1,85 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYEXPIRYINDEX_H
+#define KEEPASSXC_ENTRYEXPIRYINDEX_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMultiMap>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Per database queue of the expiry times of all entries outside the recycle bin.
+ *
+ * Entries are ordered by their expiry time as soon as they are added, modified,
+ * moved or deleted, so finding the entries that expire before a point in time
+ * only walks the front of the queue. While the entriesExpired() signal is
+ * connected, a single timer is armed for the next expiry time.
+ */
+class EntryExpiryIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    static EntryExpiryIndex* forDatabase(Database* db);
+
+    QList<Entry*> entriesExpiringBefore(const QDateTime& time);
+    QDateTime nextExpiryAfter(const QDateTime& time);
+
+signals:
+    void entriesExpired();
+
+protected:
+    void connectNotify(const QMetaMethod& signal) override;
+
+private slots:
+    void addEntry(Entry* entry);
+    void invalidateEntry();
+    void removeEntry(Entry* entry);
+    void removeDestroyedEntry(QObject* entry);
+    void invalidateGroups();
+    void clear();
+    void notifyExpired();
+
+private:
+    explicit EntryExpiryIndex(Database* db);
+
+    void ensureCurrent();
+    void sweep();
+    void index(Entry* entry);
+    void drop(const Entry* entry);
+    void rearmTimer();
+    void scheduleTimer();
+
+    Database* m_db;
+    QPointer<Group> m_rootGroup;
+    QPointer<Group> m_recycleBin;
+    bool m_sweepPending = true;
+    QMultiMap<QDateTime, Entry*> m_queue;
+    QHash<const Entry*, QDateTime> m_expiryTimes;
+    QDateTime m_nextExpiry;
+    QTimer m_timer;
+};
+
+#endif // KEEPASSXC_ENTRYEXPIRYINDEX_H
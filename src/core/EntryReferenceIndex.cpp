@@ -0,0 +1,211 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntryReferenceIndex.h"
+
+#include "core/Group.h"
+
+#include <QSet>
+
+namespace
+{
+    const int UuidHexSize = 32;
+
+    bool isHexDigit(QChar ch)
+    {
+        return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+    }
+
+    /**
+     * Collect every uuid whose hex form is part of a text, the way Entry::hasReferencesTo() matches them.
+     *
+     * @param text value of a reference attribute
+     * @param uuids receives the uuids
+     */
+    void collectUuids(const QString& text, QSet<QUuid>& uuids)
+    {
+        int runStart = -1;
+        for (int i = 0; i <= text.size(); ++i) {
+            if (i < text.size() && isHexDigit(text.at(i))) {
+                if (runStart < 0) {
+                    runStart = i;
+                }
+                continue;
+            }
+            for (int start = runStart; runStart >= 0 && start + UuidHexSize <= i; ++start) {
+                uuids.insert(QUuid::fromRfc4122(QByteArray::fromHex(text.mid(start, UuidHexSize).toLatin1())));
+            }
+            runStart = -1;
+        }
+    }
+} // namespace
+
+/**
+ * @param referenceType field a reference searches in
+ * @return whether references searching in this field can be looked up in the index
+ */
+bool EntryReferenceIndex::isIndexed(EntryReferenceType referenceType)
+{
+    return referenceType == EntryReferenceType::QUuid || referenceType == EntryReferenceType::Title
+           || referenceType == EntryReferenceType::UserName;
+}
+
+/**
+ * Find the first entry whose field equals the search term.
+ *
+ * @param rootGroup root group of the database this index belongs to
+ * @param term search text of the reference, the hex encoded uuid for uuid references
+ * @param referenceType field to search in, must be indexed
+ * @return the referenced entry or nullptr
+ */
+Entry* EntryReferenceIndex::find(Group* rootGroup, const QString& term, EntryReferenceType referenceType)
+{
+    Q_ASSERT(isIndexed(referenceType));
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_valid) {
+        rebuild(rootGroup);
+    }
+
+    // Changes that bypass the modified signals are caught here, a miss is trusted though
+    Entry* entry = lookup(term, referenceType);
+    bool stale = entry && entry->database() != rootGroup->database();
+    if (entry && !stale) {
+        stale = referenceType == EntryReferenceType::QUuid
+                    ? entry->uuid() != QUuid::fromRfc4122(QByteArray::fromHex(term.toLatin1()))
+                    : entry->referenceFieldValue(referenceType) != term;
+    }
+    if (stale) {
+        rebuild(rootGroup);
+        entry = lookup(term, referenceType);
+    }
+    return entry;
+}
+
+/**
+ * Find the entries with a reference to an entry, like Group::referencesRecursive() without the index.
+ *
+ * @param rootGroup root group of the database this index belongs to
+ * @param uuid uuid of the referenced entry
+ * @return entries outside of the history that refer to the uuid, in tree order
+ */
+QList<Entry*> EntryReferenceIndex::referrers(const Group* rootGroup, const QUuid& uuid)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_valid) {
+        rebuild(rootGroup);
+    }
+
+    QList<Entry*> result;
+    for (const auto& entry : m_referrers.value(uuid)) {
+        // Entries changed without a modified signal are only dropped, a miss is trusted
+        if (entry && entry->database() == rootGroup->database() && entry->hasReferencesTo(uuid)) {
+            result.append(entry);
+        }
+    }
+    return result;
+}
+
+void EntryReferenceIndex::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+    m_valid = false;
+}
+
+/**
+ * Release the memory of the index, it is built again on the next lookup.
+ */
+void EntryReferenceIndex::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_uuids.clear();
+    m_titles.clear();
+    m_usernames.clear();
+    m_referrers.clear();
+    m_valid = false;
+}
+
+/**
+ * @return estimated size of the lookup tables, titles and usernames share their data with the entries
+ */
+qint64 EntryReferenceIndex::memoryUsage()
+{
+    QMutexLocker locker(&m_mutex);
+    const auto nodeSize = static_cast<qint64>(sizeof(QPointer<Entry>) + 3 * sizeof(void*));
+    qint64 referrers = 0;
+    for (const auto& entries : asConst(m_referrers)) {
+        referrers += entries.size();
+    }
+    return m_uuids.size() * (nodeSize + static_cast<qint64>(sizeof(QUuid)))
+           + (m_titles.size() + m_usernames.size()) * (nodeSize + static_cast<qint64>(sizeof(QString)))
+           + m_referrers.size() * (nodeSize + static_cast<qint64>(sizeof(QUuid)))
+           + referrers * static_cast<qint64>(sizeof(QPointer<Entry>));
+}
+
+void EntryReferenceIndex::rebuild(const Group* rootGroup)
+{
+    m_uuids.clear();
+    m_titles.clear();
+    m_usernames.clear();
+    m_referrers.clear();
+
+    for (const Group* group : rootGroup->groupsRecursive(true)) {
+        for (Entry* entry : group->entries()) {
+            // The first entry in tree order wins, like in a linear search
+            if (!m_uuids.contains(entry->uuid())) {
+                m_uuids.insert(entry->uuid(), entry);
+            }
+            if (!m_titles.contains(entry->title())) {
+                m_titles.insert(entry->title(), entry);
+            }
+            if (!m_usernames.contains(entry->username())) {
+                m_usernames.insert(entry->username(), entry);
+            }
+            if (entry->hasReferences()) {
+                addReferrer(entry);
+            }
+        }
+    }
+    m_valid = true;
+}
+
+void EntryReferenceIndex::addReferrer(Entry* entry)
+{
+    QSet<QUuid> uuids;
+    for (const QString& key : EntryAttributes::DefaultAttributes) {
+        if (entry->isAttributeReference(key)) {
+            collectUuids(entry->attribute(key), uuids);
+        }
+    }
+    for (const auto& uuid : asConst(uuids)) {
+        m_referrers[uuid].append(entry);
+    }
+}
+
+Entry* EntryReferenceIndex::lookup(const QString& term, EntryReferenceType referenceType) const
+{
+    switch (referenceType) {
+    case EntryReferenceType::QUuid:
+        return m_uuids.value(QUuid::fromRfc4122(QByteArray::fromHex(term.toLatin1())));
+    case EntryReferenceType::Title:
+        return m_titles.value(term);
+    case EntryReferenceType::UserName:
+        return m_usernames.value(term);
+    default:
+        return nullptr;
+    }
+}
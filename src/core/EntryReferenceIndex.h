@@ -0,0 +1,68 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYREFERENCEINDEX_H
+#define KEEPASSXC_ENTRYREFERENCEINDEX_H
+
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+#include <QUuid>
+
+#include "core/Entry.h"
+
+class Group;
+
+/**
+ * Lookup of the entries targeted by {REF:...} placeholders.
+ *
+ * Maps uuids, titles and usernames to the first entry in tree order that
+ * carries them, which is the entry a linear search through
+ * Group::findEntryBySearchTerm() would find. The index is rebuilt on the
+ * first lookup after it was invalidated by a change to the database, so
+ * rendering many references between changes costs one scan in total.
+ * Lookups are serialized so references can be resolved from several threads.
+ *
+ * The same scan records which entries refer to a uuid, so the references to
+ * an entry are found without matching the attributes of every entry.
+ */
+class EntryReferenceIndex
+{
+public:
+    static bool isIndexed(EntryReferenceType referenceType);
+
+    Entry* find(Group* rootGroup, const QString& term, EntryReferenceType referenceType);
+    QList<Entry*> referrers(const Group* rootGroup, const QUuid& uuid);
+    void invalidate();
+    void clear();
+    qint64 memoryUsage();
+
+private:
+    void rebuild(const Group* rootGroup);
+    void addReferrer(Entry* entry);
+    Entry* lookup(const QString& term, EntryReferenceType referenceType) const;
+
+    QMutex m_mutex;
+    bool m_valid = false;
+    QHash<QUuid, QPointer<Entry>> m_uuids;
+    QHash<QString, QPointer<Entry>> m_titles;
+    QHash<QString, QPointer<Entry>> m_usernames;
+    // Entries whose reference attributes contain a uuid, in tree order
+    QHash<QUuid, QList<QPointer<Entry>>> m_referrers;
+};
+
+#endif // KEEPASSXC_ENTRYREFERENCEINDEX_H
@@ -0,0 +1,298 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntrySearchIndex.h"
+
+#include <algorithm>
+
+#include "core/Database.h"
+#include "core/Group.h"
+
+namespace
+{
+    /**
+     * Fold a character the way a case insensitive match would, characters
+     * that do not fold to ASCII are mapped to 0 and never part of a trigram.
+     */
+    inline uint foldChar(QChar ch)
+    {
+        ushort code = ch.unicode();
+        if (code < 0x80) {
+            return (code >= 'A' && code <= 'Z') ? code + ('a' - 'A') : code;
+        }
+        // e.g. KELVIN SIGN matches 'k' in a case insensitive search
+        ushort folded = ch.toCaseFolded().unicode();
+        if (folded < 0x80) {
+            return folded;
+        }
+        ushort lower = ch.toLower().unicode();
+        return lower < 0x80 ? lower : 0;
+    }
+
+    /**
+     * @return estimated size of a record, strings share their data with the entry
+     */
+    qint64 recordSize(const EntrySearchIndex::Record& record)
+    {
+        return static_cast<qint64>(sizeof(EntrySearchIndex::Record) + 3 * sizeof(void*))
+               + record.trigrams.size() * static_cast<qint64>(sizeof(quint32))
+               + (record.attributes.size() + record.attachments.size() + record.tags.size())
+                     * static_cast<qint64>(sizeof(void*));
+    }
+
+    // A set node with the entry pointer and its hash
+    const qint64 PostingSize = 3 * sizeof(void*);
+
+    void appendTrigrams(const QString& text, QVector<quint32>& trigrams)
+    {
+        uint a = 0;
+        uint b = 0;
+        for (int i = 0; i < text.size(); ++i) {
+            uint c = foldChar(text.at(i));
+            if (a && b && c) {
+                trigrams.append((a << 14) | (b << 7) | c);
+            }
+            a = b;
+            b = c;
+        }
+    }
+
+    void sortTrigrams(QVector<quint32>& trigrams)
+    {
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    }
+} // namespace
+
+EntrySearchIndex::EntrySearchIndex(Database* db)
+    : QObject(db)
+{
+    connect(db, &Database::groupDataChanged, this, &EntrySearchIndex::invalidateGroups);
+    connect(db, &Database::groupAdded, this, &EntrySearchIndex::invalidateGroups);
+    connect(db, &Database::groupRemoved, this, &EntrySearchIndex::invalidateGroups);
+    connect(db, &Database::groupMoved, this, &EntrySearchIndex::invalidateGroups);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &EntrySearchIndex::clear);
+    connect(db, &Database::databaseDiscarded, this, &EntrySearchIndex::clear);
+}
+
+/**
+ * Get the cached search fields of an entry, indexing it if necessary.
+ *
+ * @param entry entry of the database this index belongs to
+ * @return record that stays valid until the next call that modifies the index
+ */
+const EntrySearchIndex::Record& EntrySearchIndex::record(const Entry* entry)
+{
+    auto it = m_records.find(entry);
+    if (it != m_records.end()) {
+        return it.value();
+    }
+
+    it = m_records.insert(entry, makeRecord(entry));
+    m_recordBytes += recordSize(it.value());
+    for (const auto& tag : asConst(it->tags)) {
+        ++m_tagCounts[tag];
+    }
+    if (it->resolveLive) {
+        m_liveEntries.insert(entry);
+    } else {
+        for (quint32 trigram : asConst(it->trigrams)) {
+            m_postings[trigram].insert(entry);
+        }
+        m_postingCount += it->trigrams.size();
+    }
+
+    connect(entry, &Entry::modified, this, &EntrySearchIndex::invalidateEntry, Qt::UniqueConnection);
+    connect(entry, &QObject::destroyed, this, &EntrySearchIndex::removeEntry, Qt::UniqueConnection);
+    return it.value();
+}
+
+/**
+ * Find the indexed entries that may contain the given trigrams.
+ *
+ * @param trigrams trigrams as returned by wordTrigrams(), must not be empty
+ * @return entries containing all trigrams and entries whose fields contain placeholders
+ */
+QSet<const Entry*> EntrySearchIndex::candidates(const QVector<quint32>& trigrams) const
+{
+    Q_ASSERT(!trigrams.isEmpty());
+
+    // Start with the rarest trigram to keep the intersection small
+    QVector<const QSet<const Entry*>*> postings;
+    for (quint32 trigram : trigrams) {
+        auto it = m_postings.constFind(trigram);
+        if (it == m_postings.constEnd()) {
+            return m_liveEntries;
+        }
+        postings.append(&it.value());
+    }
+    std::sort(postings.begin(), postings.end(), [](const QSet<const Entry*>* lhs, const QSet<const Entry*>* rhs) {
+        return lhs->size() < rhs->size();
+    });
+
+    QSet<const Entry*> result = *postings.first();
+    for (int i = 1; i < postings.size() && !result.isEmpty(); ++i) {
+        result.intersect(*postings.at(i));
+    }
+    return result.unite(m_liveEntries);
+}
+
+/**
+ * @return distinct tags of all indexed entries
+ */
+QStringList EntrySearchIndex::tags() const
+{
+    return m_tagCounts.keys();
+}
+
+/**
+ * @return estimated size of the records and the trigram index
+ */
+qint64 EntrySearchIndex::memoryUsage() const
+{
+    return m_recordBytes + m_postingCount * PostingSize
+           + m_postings.size() * static_cast<qint64>(sizeof(QSet<const Entry*>) + 3 * sizeof(void*));
+}
+
+/**
+ * @return counter that changes whenever indexed entries or groups changed
+ */
+quint64 EntrySearchIndex::generation() const
+{
+    return m_generation;
+}
+
+void EntrySearchIndex::clear()
+{
+    ++m_generation;
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    m_records.clear();
+    m_postings.clear();
+    m_recordBytes = 0;
+    m_postingCount = 0;
+    m_liveEntries.clear();
+    m_tagCounts.clear();
+}
+
+/**
+ * Prepare the search fields of an entry without adding it to an index.
+ *
+ * @param entry entry to prepare
+ * @return search fields of the entry
+ */
+EntrySearchIndex::Record EntrySearchIndex::makeRecord(const Entry* entry)
+{
+    Record record;
+
+    const auto attributeKeys = entry->attributes()->customKeys();
+    record.attributes = attributeKeys + entry->attributes()->values(attributeKeys);
+    record.attachments = entry->attachments()->keys();
+    record.tags = entry->tagList();
+
+    // Placeholders may refer to other entries, which would not invalidate this one
+    record.resolveLive = entry->title().contains('{') || entry->username().contains('{')
+                         || entry->url().contains('{');
+    if (record.resolveLive) {
+        return record;
+    }
+
+    record.title = entry->title();
+    record.username = entry->username();
+    record.url = entry->url();
+
+    appendTrigrams(record.title, record.trigrams);
+    appendTrigrams(record.username, record.trigrams);
+    appendTrigrams(record.url, record.trigrams);
+    appendTrigrams(entry->notes(), record.trigrams);
+    for (const auto& tag : asConst(record.tags)) {
+        appendTrigrams(tag, record.trigrams);
+    }
+    sortTrigrams(record.trigrams);
+
+    return record;
+}
+
+/**
+ * Get the trigrams a field has to contain to match a plain word.
+ *
+ * @param word search word without wildcards
+ * @return trigrams of the word, empty if the word cannot be looked up in the index
+ */
+QVector<quint32> EntrySearchIndex::wordTrigrams(const QString& word)
+{
+    QVector<quint32> trigrams;
+    for (const QChar ch : word) {
+        // Non-ASCII characters may match several folded forms
+        if (ch.unicode() >= 0x80 || ch.unicode() == 0) {
+            return {};
+        }
+    }
+    appendTrigrams(word, trigrams);
+    sortTrigrams(trigrams);
+    return trigrams;
+}
+
+void EntrySearchIndex::invalidateEntry()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry) {
+        drop(entry);
+    }
+}
+
+void EntrySearchIndex::removeEntry(QObject* entry)
+{
+    // The entry is already destroyed at this point, only its address is used
+    drop(static_cast<const Entry*>(entry));
+}
+
+void EntrySearchIndex::invalidateGroups()
+{
+    // Group paths and properties are resolved by the groups themselves, but change search results
+    ++m_generation;
+}
+
+void EntrySearchIndex::drop(const Entry* entry)
+{
+    auto it = m_records.find(entry);
+    if (it == m_records.end()) {
+        return;
+    }
+
+    ++m_generation;
+    m_recordBytes -= recordSize(it.value());
+    for (quint32 trigram : asConst(it->trigrams)) {
+        auto posting = m_postings.find(trigram);
+        if (posting != m_postings.end() && posting->remove(entry)) {
+            --m_postingCount;
+            if (posting->isEmpty()) {
+                m_postings.erase(posting);
+            }
+        }
+    }
+    for (const auto& tag : asConst(it->tags)) {
+        auto count = m_tagCounts.find(tag);
+        if (count != m_tagCounts.end() && --count.value() == 0) {
+            m_tagCounts.erase(count);
+        }
+    }
+    m_liveEntries.remove(entry);
+    m_records.erase(it);
+}
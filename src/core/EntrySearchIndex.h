@@ -0,0 +1,87 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYSEARCHINDEX_H
+#define KEEPASSXC_ENTRYSEARCHINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+class Database;
+class Entry;
+
+/**
+ * Per database cache of the entry fields used by EntrySearcher.
+ *
+ * Entries are indexed lazily on their first search and dropped again as soon
+ * as they are modified. Besides the prepared field values, the index keeps a
+ * trigram index over the case folded title, username, url, notes and tags so
+ * that plain word terms only have to be matched against entries that contain
+ * all trigrams of the word.
+ */
+class EntrySearchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Record
+    {
+        // Only valid if resolveLive is false, placeholders have to be resolved on every search otherwise
+        QString title;
+        QString username;
+        QString url;
+        QStringList attributes;
+        QStringList attachments;
+        QStringList tags;
+        QVector<quint32> trigrams;
+        bool resolveLive = false;
+    };
+
+    explicit EntrySearchIndex(Database* db);
+
+    const Record& record(const Entry* entry);
+    QSet<const Entry*> candidates(const QVector<quint32>& trigrams) const;
+    QStringList tags() const;
+    quint64 generation() const;
+    qint64 memoryUsage() const;
+    void clear();
+
+    static Record makeRecord(const Entry* entry);
+    static QVector<quint32> wordTrigrams(const QString& word);
+
+private slots:
+    void invalidateEntry();
+    void removeEntry(QObject* entry);
+    void invalidateGroups();
+
+private:
+    void drop(const Entry* entry);
+
+    QHash<const Entry*, Record> m_records;
+    QHash<quint32, QSet<const Entry*>> m_postings;
+    QSet<const Entry*> m_liveEntries;
+    QHash<QString, int> m_tagCounts;
+    quint64 m_generation = 0;
+    // Estimated sizes, kept up to date as records are added and dropped
+    qint64 m_recordBytes = 0;
+    qint64 m_postingCount = 0;
+};
+
+#endif // KEEPASSXC_ENTRYSEARCHINDEX_H
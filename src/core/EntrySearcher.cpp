@@ -20,8 +20,13 @@
 
 #include "PasswordHealth.h"
 #include "core/Group.h"
+#include "core/PerformanceStats.h"
 #include "core/Tools.h"
 
+#include <QtConcurrent>
+
+#include <algorithm>
+
 EntrySearcher::EntrySearcher(bool caseSensitive, bool skipProtected)
     : m_caseSensitive(caseSensitive)
     , m_skipProtected(skipProtected)
@@ -68,17 +73,36 @@ QList<Entry*> EntrySearcher::search(const QString& searchString, const Group* ba
 QList<Entry*> EntrySearcher::repeat(const Group* baseGroup, bool forceSearch)
 {
     Q_ASSERT(baseGroup);
+    PerformanceStats::ScopedTimer timer("search");
 
-    QList<Entry*> results;
-    for (const auto group : baseGroup->groupsRecursive(true)) {
+    QList<Entry*> entries;
+    baseGroup->forEachGroupRecursive([&](const Group* group) {
         if (forceSearch || group->resolveSearchingEnabled()) {
-            for (const auto entry : group->entries()) {
-                if (searchEntryImpl(entry)) {
-                    results.append(entry);
-                }
-            }
+            entries.append(group->entries());
         }
+        return true;
+    });
+
+    // A narrower query only has to look at the results of the last one, as long as
+    // the searched entries did not change in between
+    auto db = baseGroup->database();
+    auto index = db ? db->searchIndex() : nullptr;
+    QList<SearchTerm> refinement;
+    QList<Entry*> results;
+    if (index && m_lastIndex == index && m_lastGeneration == index->generation() && m_lastBaseGroup == baseGroup
+        && m_lastForceSearch == forceSearch && m_lastEntries == entries && refines(index, refinement)) {
+        results = refinement.isEmpty() ? m_lastResults : filterEntries(m_lastResults, refinement);
+    } else {
+        results = filterEntries(entries, m_searchTerms);
     }
+
+    m_lastIndex = index;
+    m_lastGeneration = index ? index->generation() : 0;
+    m_lastBaseGroup = baseGroup;
+    m_lastForceSearch = forceSearch;
+    m_lastEntries = entries;
+    m_lastTerms = m_searchTerms;
+    m_lastResults = results;
     return results;
 }
 
@@ -117,13 +141,20 @@ QList<Entry*> EntrySearcher::searchEntries(const QString& searchString, const QL
  */
 QList<Entry*> EntrySearcher::repeatEntries(const QList<Entry*>& entries)
 {
-    QList<Entry*> results;
-    for (auto* entry : entries) {
-        if (searchEntryImpl(entry)) {
-            results.append(entry);
-        }
-    }
-    return results;
+    return filterEntries(entries, m_searchTerms);
+}
+
+/**
+ * Evaluate large searches on the global thread pool.
+ *
+ * The calling thread waits for the result, entries must not be modified by
+ * other threads while a search is running.
+ *
+ * @param state whether to split the evaluation across threads
+ */
+void EntrySearcher::setParallel(bool state)
+{
+    m_parallel = state;
 }
 
 /**
@@ -141,46 +172,232 @@ bool EntrySearcher::isCaseSensitive() const
     return m_caseSensitive;
 }
 
-bool EntrySearcher::searchEntryImpl(const Entry* entry)
+/**
+ * @return true if the result of the last search terms can change with the
+ *         current time, such as terms matching expired entries
+ */
+bool EntrySearcher::isTimeDependent() const
 {
-    // Pre-load in case they are needed
-    auto attributes_keys = entry->attributes()->customKeys();
-    auto attributes = QStringList(attributes_keys + entry->attributes()->values(attributes_keys));
-    auto attachments = QStringList(entry->attachments()->keys());
-    // Build a group hierarchy to allow searching for e.g. /group1/subgroup*
-    QString hierarchy;
-    if (entry->group()) {
-        hierarchy = entry->group()->hierarchy().join('/').prepend("/");
+    for (const auto& term : m_searchTerms) {
+        if (term.field == Field::Is) {
+            return true;
+        }
     }
+    return false;
+}
+
+QList<Entry*> EntrySearcher::filterEntries(const QList<Entry*>& entries, const QList<SearchTerm>& terms) const
+{
+    const auto plan = compile(terms);
+
+    // Plain words can only match entries that contain all of their trigrams
+    QVector<quint32> trigrams;
+    bool needsHierarchy = false;
+    for (const auto& term : terms) {
+        trigrams += term.trigrams;
+        needsHierarchy |= term.field == Field::Group && term.word.contains('/');
+    }
+
+    // Index the entries first so the candidates cover all of them
+    QHash<EntrySearchIndex*, QSet<const Entry*>> candidates;
+    int unindexed = 0;
+    for (const auto* entry : entries) {
+        auto db = entry->database();
+        if (!db) {
+            ++unindexed;
+            continue;
+        }
+        db->searchIndex()->record(entry);
+        if (!trigrams.isEmpty()) {
+            candidates.insert(db->searchIndex(), {});
+        }
+    }
+    for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+        it.value() = it.key()->candidates(trigrams);
+    }
+
+    // Collect everything the evaluation needs, so it does not touch the index anymore
+    QVector<Candidate> items;
+    items.reserve(entries.size());
+    QVector<EntrySearchIndex::Record> records;
+    records.reserve(unindexed);
+    for (auto* entry : entries) {
+        auto db = entry->database();
+        auto index = db ? db->searchIndex() : nullptr;
+        if (index && !trigrams.isEmpty() && !candidates.value(index).contains(entry)) {
+            continue;
+        }
+
+        Candidate item{entry, nullptr, {}};
+        if (index) {
+            item.record = &index->record(entry);
+        } else {
+            records.append(EntrySearchIndex::makeRecord(entry));
+            item.record = &records.last();
+        }
+        if (needsHierarchy && entry->group()) {
+            item.hierarchy = entry->group()->fullPath();
+        }
+        items.append(item);
+    }
+
+    if (m_parallel && items.size() >= ParallelThreshold) {
+        // The filter keeps the order of the entries. This thread is blocked meanwhile,
+        // so the entries cannot change while the workers read them.
+        const bool hasIsTerm =
+            std::any_of(terms.begin(), terms.end(), [](const SearchTerm& term) { return term.field == Field::Is; });
+        if (hasIsTerm) {
+            // Resolve the cached recycled state of the groups up front, so the workers only read it
+            for (const auto& item : asConst(items)) {
+                item.entry->isRecycled();
+            }
+        }
+        items = QtConcurrent::blockingFiltered(items, [this, &plan](const Candidate& item) {
+            return searchEntryImpl(item.entry, *item.record, item.hierarchy, plan);
+        });
+    } else {
+        auto matches = std::remove_if(items.begin(), items.end(), [this, &plan](const Candidate& item) {
+            return !searchEntryImpl(item.entry, *item.record, item.hierarchy, plan);
+        });
+        items.erase(matches, items.end());
+    }
+
+    QList<Entry*> results;
+    results.reserve(items.size());
+    for (const auto& item : asConst(items)) {
+        results.append(item.entry);
+    }
+    return results;
+}
+
+/**
+ * Turn search terms into the order and form they are evaluated in.
+ *
+ * Plain words are matched as substrings instead of through the regex engine,
+ * the remaining regexes are compiled once for the whole search. Unless skipping
+ * protected fields, where the result depends on the previous terms, cheap terms
+ * are evaluated first so most entries are rejected before the expensive ones.
+ *
+ * @param terms search terms
+ * @return terms in evaluation order
+ */
+QVector<EntrySearcher::CompiledTerm> EntrySearcher::compile(const QList<SearchTerm>& terms) const
+{
+    QVector<CompiledTerm> plan;
+    plan.reserve(terms.size());
+    for (const auto& term : terms) {
+        CompiledTerm compiled{&term, false, Qt::CaseSensitive, 0};
+
+        switch (term.field) {
+        case Field::Uuid:
+            compiled.cost = 0;
+            break;
+        case Field::Is:
+            // Checking the password health is expensive, expiry is not
+            compiled.cost = term.word.compare("weak", Qt::CaseInsensitive) == 0 ? 7 : 1;
+            break;
+        case Field::Tag:
+        case Field::Group:
+            compiled.cost = 1;
+            break;
+        case Field::Title:
+        case Field::Username:
+        case Field::Url:
+        case Field::AttributeKV:
+        case Field::Attachment:
+        case Field::AttributeValue:
+            compiled.cost = 2;
+            break;
+        case Field::Notes:
+            compiled.cost = 3;
+            break;
+        case Field::Password:
+            compiled.cost = 5;
+            break;
+        default:
+            compiled.cost = 4;
+            break;
+        }
+
+        // The value of an attribute is matched against the regex only, the word is the attribute key
+        if (term.field != Field::AttributeValue && term.field != Field::Group
+            && term.regex.pattern() == Tools::escapeRegex(term.word)) {
+            compiled.literal = true;
+            compiled.caseSensitivity = term.regex.patternOptions().testFlag(QRegularExpression::CaseInsensitiveOption)
+                                           ? Qt::CaseInsensitive
+                                           : Qt::CaseSensitive;
+        } else {
+            // Compile once up front instead of on first use, possibly by one of the worker threads
+            term.regex.optimize();
+        }
+
+        plan.append(compiled);
+    }
+
+    if (!m_skipProtected) {
+        std::stable_sort(plan.begin(), plan.end(), [](const CompiledTerm& lhs, const CompiledTerm& rhs) {
+            return lhs.cost < rhs.cost;
+        });
+    }
+    return plan;
+}
+
+bool EntrySearcher::searchEntryImpl(const Entry* entry,
+                                    const EntrySearchIndex::Record& record,
+                                    const QString& hierarchy,
+                                    const QVector<CompiledTerm>& plan) const
+{
+    auto title = [&] { return record.resolveLive ? entry->resolvePlaceholder(entry->title()) : record.title; };
+    auto username = [&] { return record.resolveLive ? entry->resolvePlaceholder(entry->username()) : record.username; };
+    auto url = [&] { return record.resolveLive ? entry->resolvePlaceholder(entry->url()) : record.url; };
 
     // By default, empty term matches every entry.
     // However when skipping protected fields, we will reject everything instead
     bool found = !m_skipProtected;
-    for (const auto& term : m_searchTerms) {
+    for (const auto& compiled : plan) {
+        const auto& term = *compiled.term;
+
+        auto matches = [&](const QString& text) {
+            return compiled.literal ? text.contains(term.word, compiled.caseSensitivity)
+                                    : term.regex.match(text).hasMatch();
+        };
+        auto matchesAny = [&](const QStringList& list) {
+            return std::any_of(list.begin(), list.end(), matches);
+        };
+        // Tags have to match entirely
+        auto matchesTag = [&]() {
+            if (compiled.literal) {
+                return std::any_of(record.tags.begin(), record.tags.end(), [&](const QString& tag) {
+                    return tag.compare(term.word, compiled.caseSensitivity) == 0;
+                });
+            }
+            return record.tags.indexOf(term.regex) != -1;
+        };
+
         switch (term.field) {
         case Field::Title:
-            found = term.regex.match(entry->resolvePlaceholder(entry->title())).hasMatch();
+            found = matches(title());
             break;
         case Field::Username:
-            found = term.regex.match(entry->resolvePlaceholder(entry->username())).hasMatch();
+            found = matches(username());
             break;
         case Field::Password:
             if (m_skipProtected) {
                 continue;
             }
-            found = term.regex.match(entry->resolvePlaceholder(entry->password())).hasMatch();
+            found = matches(entry->resolvePlaceholder(entry->password()));
             break;
         case Field::Url:
-            found = term.regex.match(entry->resolvePlaceholder(entry->url())).hasMatch();
+            found = matches(url());
             break;
         case Field::Notes:
-            found = term.regex.match(entry->notes()).hasMatch();
+            found = matches(entry->notes());
             break;
         case Field::AttributeKV:
-            found = !attributes.filter(term.regex).empty();
+            found = matchesAny(record.attributes);
             break;
         case Field::Attachment:
-            found = !attachments.filter(term.regex).empty();
+            found = matchesAny(record.attachments);
             break;
         case Field::AttributeValue:
             if (m_skipProtected && entry->attributes()->isProtected(term.word)) {
@@ -190,7 +407,8 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
                     && term.regex.match(entry->attributes()->value(term.word)).hasMatch();
             break;
         case Field::Group:
-            // Match against the full hierarchy if the word contains a '/' otherwise just the group name
+            // Match against the full hierarchy (e.g. /group1/subgroup*) if the word contains a '/'
+            // otherwise just the group name
             if (term.word.contains('/')) {
                 found = term.regex.match(hierarchy).hasMatch();
             } else if (entry->group()) {
@@ -198,7 +416,7 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
             }
             break;
         case Field::Tag:
-            found = entry->tagList().indexOf(term.regex) != -1;
+            found = matchesTag();
             break;
         case Field::Is:
             if (term.word.startsWith("expired", Qt::CaseInsensitive)) {
@@ -222,14 +440,12 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
             found = false;
             break;
         case Field::Uuid:
-            found = term.regex.match(entry->uuidToHex()).hasMatch();
+            found = matches(entry->uuidToHex());
             break;
         default:
             // Terms without a specific field try to match title, username, url, and notes
-            found = term.regex.match(entry->resolvePlaceholder(entry->title())).hasMatch()
-                    || term.regex.match(entry->resolvePlaceholder(entry->username())).hasMatch()
-                    || term.regex.match(entry->resolvePlaceholder(entry->url())).hasMatch()
-                    || entry->tagList().indexOf(term.regex) != -1 || term.regex.match(entry->notes()).hasMatch();
+            found = matches(title()) || matches(username()) || matches(url()) || matchesTag()
+                    || matches(entry->notes());
         }
 
         // negate the result if exclude:
@@ -246,6 +462,69 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
     return found;
 }
 
+/**
+ * Check whether the current search terms can only match a subset of the last results.
+ *
+ * This is the case if every previous term is either kept unchanged or narrowed to a plain
+ * word containing the previous word, with optional terms appended.
+ *
+ * @param index search index of the searched entries
+ * @param changed terms that still have to be matched against the last results
+ * @return true if the last results can be refined instead of searching again
+ */
+bool EntrySearcher::refines(const EntrySearchIndex* index, QList<SearchTerm>& changed) const
+{
+    // When skipping protected fields the result of a term depends on the previous ones
+    if (m_skipProtected || m_lastTerms.isEmpty() || m_searchTerms.size() < m_lastTerms.size()) {
+        return false;
+    }
+
+    auto isPlain = [](const SearchTerm& term) {
+        return !term.exclude && term.regex.pattern() == Tools::escapeRegex(term.word);
+    };
+
+    changed.clear();
+    for (int i = 0; i < m_searchTerms.size(); ++i) {
+        const auto& term = m_searchTerms.at(i);
+        if (i >= m_lastTerms.size()) {
+            changed.append(term);
+            continue;
+        }
+
+        const auto& last = m_lastTerms.at(i);
+        if (term.field == last.field && term.word == last.word && term.exclude == last.exclude
+            && term.regex == last.regex) {
+            continue;
+        }
+        if (term.field != last.field || !isPlain(term) || !isPlain(last) || !term.word.contains(last.word)
+            || term.regex.patternOptions() != last.regex.patternOptions()) {
+            return false;
+        }
+
+        switch (term.field) {
+        case Field::Undefined:
+        case Field::Tag:
+            // Tags have to match entirely, so a longer word may match a tag the shorter one did not
+            if (index->tags().indexOf(term.regex) != -1) {
+                return false;
+            }
+            break;
+        case Field::Title:
+        case Field::Username:
+        case Field::Url:
+        case Field::Notes:
+        case Field::AttributeKV:
+        case Field::Attachment:
+        case Field::Uuid:
+            break;
+        default:
+            return false;
+        }
+        changed.append(term);
+    }
+    return true;
+}
+
 void EntrySearcher::parseSearchTerms(const QString& searchString)
 {
     static const QList<QPair<QString, Field>> fieldnames{
@@ -322,6 +601,23 @@ void EntrySearcher::parseSearchTerms(const QString& searchString)
             }
         }
 
+        // Plain words in the indexed fields can be looked up in the search index
+        if (!term.exclude && !mods.contains("*") && !term.word.contains('*') && !term.word.contains('?')
+            && !term.word.contains('|')) {
+            switch (term.field) {
+            case Field::Undefined:
+            case Field::Title:
+            case Field::Username:
+            case Field::Url:
+            case Field::Notes:
+            case Field::Tag:
+                term.trigrams = EntrySearchIndex::wordTrigrams(term.word);
+                break;
+            default:
+                break;
+            }
+        }
+
         m_searchTerms.append(term);
     }
 }
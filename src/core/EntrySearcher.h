@@ -19,7 +19,11 @@
 #ifndef KEEPASSX_ENTRYSEARCHER_H
 #define KEEPASSX_ENTRYSEARCHER_H
 
+#include <QPointer>
 #include <QRegularExpression>
+#include <QVector>
+
+#include "core/EntrySearchIndex.h"
 
 class Group;
 class Entry;
@@ -51,6 +55,8 @@ public:
         QString word;
         QRegularExpression regex;
         bool exclude;
+        // trigrams of a plain word, used to skip entries through the search index
+        QVector<quint32> trigrams;
     };
 
     explicit EntrySearcher(bool caseSensitive = false, bool skipProtected = false);
@@ -65,15 +71,54 @@ public:
 
     void setCaseSensitive(bool state);
     bool isCaseSensitive() const;
+    bool isTimeDependent() const;
+    void setParallel(bool state);
+
+    // Minimum number of entries to evaluate in a parallel search
+    static const int ParallelThreshold = 2048;
 
 private:
-    bool searchEntryImpl(const Entry* entry);
+    struct Candidate
+    {
+        Entry* entry;
+        const EntrySearchIndex::Record* record;
+        // only set if a term matches the group hierarchy
+        QString hierarchy;
+    };
+
+    struct CompiledTerm
+    {
+        const SearchTerm* term;
+        // plain words are matched as substrings instead of through the regex engine
+        bool literal;
+        Qt::CaseSensitivity caseSensitivity;
+        // relative evaluation cost, cheap terms reject entries first
+        int cost;
+    };
+
+    QList<Entry*> filterEntries(const QList<Entry*>& entries, const QList<SearchTerm>& terms) const;
+    QVector<CompiledTerm> compile(const QList<SearchTerm>& terms) const;
+    bool searchEntryImpl(const Entry* entry,
+                         const EntrySearchIndex::Record& record,
+                         const QString& hierarchy,
+                         const QVector<CompiledTerm>& plan) const;
+    bool refines(const EntrySearchIndex* index, QList<SearchTerm>& changed) const;
     void parseSearchTerms(const QString& searchString);
 
     bool m_caseSensitive;
     bool m_skipProtected;
+    bool m_parallel = false;
     QList<SearchTerm> m_searchTerms;
 
+    // State of the last search through repeat(), to refine it if the query only got narrower
+    QList<SearchTerm> m_lastTerms;
+    QList<Entry*> m_lastEntries;
+    QList<Entry*> m_lastResults;
+    QPointer<EntrySearchIndex> m_lastIndex;
+    quint64 m_lastGeneration = 0;
+    QPointer<const Group> m_lastBaseGroup;
+    bool m_lastForceSearch = false;
+
     friend class TestEntrySearcher;
 };
 
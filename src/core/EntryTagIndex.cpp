@@ -0,0 +1,319 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntryTagIndex.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+#include "core/Database.h"
+#include "core/DatabaseMemoryIndex.h"
+#include "core/Group.h"
+
+EntryTagIndex::EntryTagIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+{
+    // Entries of an added, moved or removed group do not emit entryAdded or entryRemoved
+    connect(db, &Database::groupAdded, this, &EntryTagIndex::sweep);
+    connect(db, &Database::groupRemoved, this, &EntryTagIndex::sweep);
+    connect(db, &Database::groupMoved, this, &EntryTagIndex::sweep);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &EntryTagIndex::clear);
+    connect(db, &Database::databaseDiscarded, this, &EntryTagIndex::clear);
+}
+
+/**
+ * @return sorted tags of all entries outside the recycle bin
+ */
+const QStringList& EntryTagIndex::tags()
+{
+    build();
+    return m_tags;
+}
+
+/**
+ * @return sorted usernames of all entries, usernames that are references are left out
+ */
+const QStringList& EntryTagIndex::usernames()
+{
+    build();
+    return m_usernames;
+}
+
+/**
+ * @return estimated size of the records and counters, usernames share their data with the entries
+ */
+qint64 EntryTagIndex::memoryUsage() const
+{
+    // Usernames are held by the counters and the sorted list
+    qint64 size =
+        m_records.size() * static_cast<qint64>(sizeof(Record) + 3 * sizeof(void*))
+        + m_usernameCounts.size() * static_cast<qint64>(2 * sizeof(QString) + sizeof(int) + 3 * sizeof(void*));
+    for (const auto& tag : m_tags) {
+        // Every tag is held by the sorted list, the counters and the records
+        size += DatabaseMemoryIndex::stringSize(tag) + 2 * static_cast<qint64>(sizeof(QString) + 3 * sizeof(void*));
+    }
+    return size;
+}
+
+/**
+ * Get the most frequently used usernames, the same as Group::usernamesRecursive()
+ * for the root group.
+ *
+ * @param topN maximum number of usernames, all usernames if negative
+ * @return usernames sorted by frequency and name
+ */
+QStringList EntryTagIndex::commonUsernames(int topN)
+{
+    build();
+    if (m_commonUsernamesValid && m_commonUsernamesTopN == topN) {
+        return m_commonUsernames;
+    }
+
+    QVector<QPair<QString, int>> sortedUsernames;
+    sortedUsernames.reserve(m_usernameCounts.size());
+    for (auto it = m_usernameCounts.constBegin(); it != m_usernameCounts.constEnd(); ++it) {
+        sortedUsernames.append({it.key(), it.value()});
+    }
+
+    // Only the top usernames have to be ordered
+    const int actualUsernames = topN < 0 ? sortedUsernames.size() : std::min(topN, sortedUsernames.size());
+    std::partial_sort(sortedUsernames.begin(),
+                      sortedUsernames.begin() + actualUsernames,
+                      sortedUsernames.end(),
+                      [](const QPair<QString, int>& arg1, const QPair<QString, int>& arg2) {
+                          if (arg1.second == arg2.second) {
+                              return arg1.first < arg2.first;
+                          }
+                          return arg1.second > arg2.second;
+                      });
+
+    QStringList usernames;
+    usernames.reserve(actualUsernames);
+    for (int i = 0; i < actualUsernames; ++i) {
+        usernames.append(sortedUsernames.at(i).first);
+    }
+
+    m_commonUsernames = usernames;
+    m_commonUsernamesTopN = topN;
+    m_commonUsernamesValid = true;
+    return usernames;
+}
+
+/**
+ * Forget all entries, the registry is built again on the next request.
+ */
+void EntryTagIndex::clear()
+{
+    for (auto it = m_records.constBegin(); it != m_records.constEnd(); ++it) {
+        disconnect(it.key(), nullptr, this, nullptr);
+    }
+    if (m_rootGroup) {
+        m_rootGroup->forEachGroupRecursive([this](const Group* group) {
+            disconnect(group, nullptr, this, nullptr);
+            return true;
+        });
+    }
+    m_records.clear();
+    m_tags.clear();
+    m_tagCounts.clear();
+    m_usernameCounts.clear();
+    m_usernames.clear();
+    m_commonUsernames.clear();
+    m_commonUsernamesValid = false;
+    m_rootGroup.clear();
+    m_built = false;
+    emit tagsReset();
+}
+
+void EntryTagIndex::addEntry(Entry* entry)
+{
+    if (entry->database() != m_db) {
+        removeEntry(entry);
+        return;
+    }
+
+    connect(entry, &Entry::modified, this, &EntryTagIndex::invalidateEntry, Qt::UniqueConnection);
+    connect(entry, &QObject::destroyed, this, &EntryTagIndex::removeDestroyedEntry, Qt::UniqueConnection);
+    setRecord(entry, makeRecord(entry));
+}
+
+void EntryTagIndex::invalidateEntry()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry) {
+        addEntry(entry);
+    }
+}
+
+void EntryTagIndex::removeEntry(Entry* entry)
+{
+    drop(entry);
+    disconnect(entry, nullptr, this, nullptr);
+}
+
+void EntryTagIndex::removeDestroyedEntry(QObject* entry)
+{
+    // The entry is already destroyed at this point, only its address is used
+    drop(static_cast<const Entry*>(entry));
+}
+
+/**
+ * Index the entries that are not indexed yet and drop the ones that left the
+ * database, entries that entered or left the recycle bin are indexed again.
+ */
+void EntryTagIndex::sweep()
+{
+    if (!m_built) {
+        return;
+    }
+    if (m_rootGroup != m_db->rootGroup()) {
+        clear();
+        build();
+        return;
+    }
+
+    QSet<const Entry*> entries;
+    m_rootGroup->forEachGroupRecursive([&](Group* group) {
+        connect(group, &Group::entryAdded, this, &EntryTagIndex::addEntry, Qt::UniqueConnection);
+        connect(group, &Group::entryRemoved, this, &EntryTagIndex::removeEntry, Qt::UniqueConnection);
+
+        const bool recycled = group->isRecycled();
+        for (auto* entry : group->entries()) {
+            entries.insert(entry);
+            auto it = m_records.constFind(entry);
+            if (it == m_records.constEnd() || it->recycled != recycled) {
+                addEntry(entry);
+            }
+        }
+        return true;
+    });
+
+    const auto indexed = m_records.keys();
+    for (const auto* entry : indexed) {
+        if (!entries.contains(entry)) {
+            drop(entry);
+            disconnect(entry, nullptr, this, nullptr);
+        }
+    }
+}
+
+void EntryTagIndex::build()
+{
+    if (m_built && m_rootGroup == m_db->rootGroup()) {
+        return;
+    }
+    if (m_built) {
+        clear();
+    }
+
+    // Whoever listens for changes got reset and asks for the complete list
+    m_rootGroup = m_db->rootGroup();
+    m_built = !m_rootGroup.isNull();
+    m_announceChanges = false;
+    sweep();
+    m_announceChanges = true;
+}
+
+void EntryTagIndex::setRecord(const Entry* entry, const Record& record)
+{
+    auto it = m_records.find(entry);
+    if (it == m_records.end()) {
+        m_records.insert(entry, record);
+        count(record, 1);
+        return;
+    }
+
+    // Count the new record first, so tags the entry keeps are never removed in between
+    const auto oldRecord = it.value();
+    it.value() = record;
+    count(record, 1);
+    count(oldRecord, -1);
+}
+
+void EntryTagIndex::drop(const Entry* entry)
+{
+    auto it = m_records.find(entry);
+    if (it == m_records.end()) {
+        return;
+    }
+
+    const auto record = it.value();
+    m_records.erase(it);
+    count(record, -1);
+}
+
+void EntryTagIndex::count(const Record& record, int delta)
+{
+    if (!record.username.isEmpty()) {
+        m_commonUsernamesValid = false;
+        auto& uses = m_usernameCounts[record.username];
+        uses += delta;
+        if (delta > 0 && uses == delta) {
+            auto pos = std::lower_bound(m_usernames.begin(), m_usernames.end(), record.username);
+            m_usernames.insert(static_cast<int>(pos - m_usernames.begin()), record.username);
+        } else if (uses <= 0) {
+            m_usernameCounts.remove(record.username);
+            auto pos = std::lower_bound(m_usernames.begin(), m_usernames.end(), record.username);
+            if (pos != m_usernames.end() && *pos == record.username) {
+                m_usernames.erase(pos);
+            }
+        }
+    }
+
+    for (const auto& tag : record.tags) {
+        auto& uses = m_tagCounts[tag];
+        uses += delta;
+        if (delta > 0 && uses == delta) {
+            auto pos = std::lower_bound(m_tags.begin(), m_tags.end(), tag);
+            const int index = static_cast<int>(pos - m_tags.begin());
+            m_tags.insert(index, tag);
+            if (m_announceChanges) {
+                emit tagAdded(tag, index);
+            }
+        } else if (uses <= 0) {
+            m_tagCounts.remove(tag);
+            auto pos = std::lower_bound(m_tags.begin(), m_tags.end(), tag);
+            if (pos != m_tags.end() && *pos == tag) {
+                const int index = static_cast<int>(pos - m_tags.begin());
+                m_tags.removeAt(index);
+                if (m_announceChanges) {
+                    emit tagRemoved(tag, index);
+                }
+            }
+        }
+    }
+}
+
+EntryTagIndex::Record EntryTagIndex::makeRecord(const Entry* entry)
+{
+    Record record;
+    record.recycled = entry->isRecycled();
+    if (!record.recycled) {
+        record.tags = entry->tagList();
+        std::sort(record.tags.begin(), record.tags.end());
+        record.tags.erase(std::unique(record.tags.begin(), record.tags.end()), record.tags.end());
+    }
+
+    const auto username = entry->username();
+    if (!username.isEmpty() && !entry->isAttributeReference(EntryAttributes::UserNameKey)) {
+        record.username = username;
+    }
+    return record;
+}
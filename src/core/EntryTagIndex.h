@@ -0,0 +1,100 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ENTRYTAGINDEX_H
+#define KEEPASSXC_ENTRYTAGINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Per database registry of the entry tags and usernames.
+ *
+ * Tags of entries outside the recycle bin and usernames of all entries are
+ * reference counted. The registry is built on the first request and updated
+ * as entries are added, modified, moved or deleted, so that changing the tags
+ * of one entry only touches the tags of that entry. Tags that appear or
+ * disappear are announced with their position in the sorted tag list.
+ * Usernames are kept in a sorted list for prefix completion, the ranking of
+ * the most frequent usernames is kept until a username changes.
+ */
+class EntryTagIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EntryTagIndex(Database* db);
+
+    const QStringList& tags();
+    const QStringList& usernames();
+    QStringList commonUsernames(int topN);
+    qint64 memoryUsage() const;
+
+public slots:
+    void clear();
+
+signals:
+    void tagAdded(const QString& tag, int index);
+    void tagRemoved(const QString& tag, int index);
+    void tagsReset();
+
+private slots:
+    void addEntry(Entry* entry);
+    void invalidateEntry();
+    void removeEntry(Entry* entry);
+    void removeDestroyedEntry(QObject* entry);
+    void sweep();
+
+private:
+    struct Record
+    {
+        bool recycled = false;
+        // Sorted and without duplicates, empty for recycled entries
+        QStringList tags;
+        // Empty if the username is a reference
+        QString username;
+    };
+
+    void build();
+    void setRecord(const Entry* entry, const Record& record);
+    void drop(const Entry* entry);
+    void count(const Record& record, int delta);
+
+    static Record makeRecord(const Entry* entry);
+
+    Database* m_db;
+    QPointer<Group> m_rootGroup;
+    bool m_built = false;
+    bool m_announceChanges = true;
+    QHash<const Entry*, Record> m_records;
+    QStringList m_tags;
+    QHash<QString, int> m_tagCounts;
+    QHash<QString, int> m_usernameCounts;
+    QStringList m_usernames;
+    // Result of the last commonUsernames() call, cleared when a username count changes
+    QStringList m_commonUsernames;
+    int m_commonUsernamesTopN = 0;
+    bool m_commonUsernamesValid = false;
+};
+
+#endif // KEEPASSXC_ENTRYTAGINDEX_H
@@ -18,19 +18,43 @@
 #include "FileWatcher.h"
 
 #include "core/AsyncTask.h"
+#include "crypto/CryptoHash.h"
+
+#include <QFileInfo>
 
 #ifdef Q_OS_LINUX
 #include <sys/statfs.h>
 #endif
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    // Saving a file usually causes several events in a row
+    const int FileEventDelayMs = 250;
+    // Unchanged files on network shares are polled up to this many times less often
+    const int MaxPollingBackoff = 8;
+} // namespace
 
 FileWatcher::FileWatcher(QObject* parent)
     : QObject(parent)
+    // Children follow the watcher when its database is handed over to another thread
+    , m_fileWatcher(this)
+    , m_fileChangeDelayTimer(this)
+    , m_fileIgnoreDelayTimer(this)
+    , m_fileChecksumTimer(this)
+    , m_fileEventDelayTimer(this)
 {
-    connect(&m_fileWatcher, SIGNAL(fileChanged(QString)), SLOT(checkFileChanged()));
+    connect(&m_fileWatcher, SIGNAL(fileChanged(QString)), SLOT(handleFileSystemEvent()));
+    connect(&m_fileWatcher, SIGNAL(directoryChanged(QString)), SLOT(handleFileSystemEvent()));
+    connect(&m_fileEventDelayTimer, SIGNAL(timeout()), SLOT(checkFileChanged()));
     connect(&m_fileChecksumTimer, SIGNAL(timeout()), SLOT(checkFileChanged()));
     connect(&m_fileChangeDelayTimer, &QTimer::timeout, this, [this] { emit fileChanged(m_filePath); });
     m_fileChangeDelayTimer.setSingleShot(true);
     m_fileIgnoreDelayTimer.setSingleShot(true);
+    m_fileEventDelayTimer.setSingleShot(true);
+    m_fileEventDelayTimer.setInterval(FileEventDelayMs);
 }
 
 FileWatcher::~FileWatcher()
@@ -39,32 +63,78 @@ FileWatcher::~FileWatcher()
 }
 
 void FileWatcher::start(const QString& filePath, int checksumIntervalSeconds, int checksumSizeKibibytes)
+{
+    watch(filePath, checksumIntervalSeconds, checksumSizeKibibytes);
+    m_fileState = readFileState();
+}
+
+/**
+ * Start watching a file that was just written without reading it again.
+ *
+ * Falls back to reading the file if it does not match what was written.
+ *
+ * @param writtenFile start and end of the file as it was written
+ */
+void FileWatcher::start(const QString& filePath,
+                        int checksumIntervalSeconds,
+                        int checksumSizeKibibytes,
+                        const WrittenFile& writtenFile)
+{
+    watch(filePath, checksumIntervalSeconds, checksumSizeKibibytes);
+    auto state = readFileState(false);
+    const bool coversChecksum = m_fileChecksumSizeBytes > 0 && m_fileChecksumSizeBytes <= EdgeSize;
+    if (state.size < 0 || state.size != writtenFile.size || !coversChecksum) {
+        m_fileState = readFileState();
+        return;
+    }
+
+    // The same parts readFileState() and calculateChecksum() read from the file
+    CryptoHash hash(CryptoHash::Sha256);
+    hash.addData(writtenFile.head);
+    if (state.size > EdgeSize) {
+        hash.addData(writtenFile.tail.right(static_cast<int>(qMin(state.size - EdgeSize, EdgeSize))));
+    }
+    state.edgeChecksum = hash.result();
+    state.checksum = CryptoHash::hash(writtenFile.head.left(m_fileChecksumSizeBytes), CryptoHash::Sha256);
+    m_fileState = state;
+}
+
+void FileWatcher::watch(const QString& filePath, int checksumIntervalSeconds, int checksumSizeKibibytes)
 {
     stop();
 
 #if defined(Q_OS_LINUX)
     struct statfs statfsBuf;
     bool forcePolling = false;
-    const auto NFS_SUPER_MAGIC = 0x6969;
+    const quint32 NFS_SUPER_MAGIC = 0x6969;
+    const quint32 SMB_SUPER_MAGIC = 0x517B;
+    const quint32 CIFS_SUPER_MAGIC = 0xFF534D42;
+    const quint32 SMB2_SUPER_MAGIC = 0xFE534D42;
 
     if (!statfs(filePath.toLocal8Bit().constData(), &statfsBuf)) {
-        forcePolling = (statfsBuf.f_type == NFS_SUPER_MAGIC);
+        // Changes made by other clients of a network share do not cause native events
+        const auto type = static_cast<quint32>(statfsBuf.f_type);
+        forcePolling = type == NFS_SUPER_MAGIC || type == SMB_SUPER_MAGIC || type == CIFS_SUPER_MAGIC
+                       || type == SMB2_SUPER_MAGIC;
     } else {
         // if we can't get the fs type let's fall back to polling
         forcePolling = true;
     }
     auto objectName = forcePolling ? QLatin1String("_qt_autotest_force_engine_poller") : QLatin1String("");
     m_fileWatcher.setObjectName(objectName);
+    m_networkFilesystem = forcePolling;
 #endif
 
     m_fileWatcher.addPath(filePath);
+    // Saving by renaming a new file over the old one is only noticed in the directory
+    m_fileWatcher.addPath(QFileInfo(filePath).absolutePath());
     m_filePath = filePath;
 
     // Handle file checksum
     m_fileChecksumSizeBytes = checksumSizeKibibytes * 1024;
-    m_fileChecksum = calculateChecksum();
-    if (checksumIntervalSeconds > 0) {
-        m_fileChecksumTimer.start(checksumIntervalSeconds * 1000);
+    m_fileChecksumIntervalMs = checksumIntervalSeconds * 1000;
+    if (m_fileChecksumIntervalMs > 0) {
+        m_fileChecksumTimer.start(m_fileChecksumIntervalMs);
     }
 
     m_ignoreFileChange = false;
@@ -72,13 +142,15 @@ void FileWatcher::start(const QString& filePath, int checksumIntervalSeconds, in
 
 void FileWatcher::stop()
 {
-    if (!m_filePath.isEmpty()) {
-        m_fileWatcher.removePath(m_filePath);
+    const auto paths = m_fileWatcher.files() + m_fileWatcher.directories();
+    if (!paths.isEmpty()) {
+        m_fileWatcher.removePaths(paths);
     }
     m_filePath.clear();
-    m_fileChecksum.clear();
+    m_fileState = {};
     m_fileChecksumTimer.stop();
     m_fileChangeDelayTimer.stop();
+    m_fileEventDelayTimer.stop();
 }
 
 void FileWatcher::pause()
@@ -104,7 +176,18 @@ bool FileWatcher::shouldIgnoreChanges()
 
 bool FileWatcher::hasSameFileChecksum()
 {
-    return calculateChecksum() == m_fileChecksum;
+    FileState state;
+    return !probeFile(state);
+}
+
+void FileWatcher::handleFileSystemEvent()
+{
+    // A file replaced by a rename is no longer watched
+    if (!m_filePath.isEmpty() && !m_fileWatcher.files().contains(m_filePath) && QFile::exists(m_filePath)) {
+        m_fileWatcher.addPath(m_filePath);
+    }
+    // Restarting the timer handles a burst of events at once
+    m_fileEventDelayTimer.start();
 }
 
 void FileWatcher::checkFileChanged()
@@ -116,23 +199,120 @@ void FileWatcher::checkFileChanged()
     // Prevent reentrance
     m_ignoreFileChange = true;
 
-    AsyncTask::runThenCallback([this] { return calculateChecksum(); },
-                               this,
-                               [this](QByteArray checksum) {
-                                   if (checksum != m_fileChecksum) {
-                                       m_fileChecksum = checksum;
-                                       m_fileChangeDelayTimer.start(0);
-                                   }
+    AsyncTask::runThenCallback(
+        [this] {
+            FileState state;
+            bool changed = probeFile(state);
+            return qMakePair(changed, state);
+        },
+        this,
+        [this](QPair<bool, FileState> result) {
+            m_fileState = result.second;
+            if (result.first) {
+                m_fileChangeDelayTimer.start(0);
+            }
+            updatePollingInterval(result.first);
+
+            m_ignoreFileChange = false;
+        });
+}
+
+/**
+ * Poll files on network shares less often for as long as they stay unchanged.
+ *
+ * @param changed whether the last check found a change
+ */
+void FileWatcher::updatePollingInterval(bool changed)
+{
+    if (!m_networkFilesystem || m_fileChecksumIntervalMs <= 0) {
+        return;
+    }
+
+    int interval = m_fileChecksumIntervalMs;
+    if (!changed) {
+        interval = qMin(m_fileChecksumTimer.interval() * 2, m_fileChecksumIntervalMs * MaxPollingBackoff);
+    }
+    if (interval != m_fileChecksumTimer.interval()) {
+        m_fileChecksumTimer.setInterval(interval);
+    }
+}
+
+/**
+ * Get the cheap to obtain properties of the watched file.
+ *
+ * @param readEdges whether to read the start and the end of the file for the edge checksum
+ * @return state without the configured checksum, size is negative if the file cannot be read
+ */
+FileWatcher::FileState FileWatcher::readFileState(bool readEdges) const
+{
+    FileState state;
+    QFile file(m_filePath);
+    if (m_filePath.isEmpty() || !file.open(QFile::ReadOnly)) {
+        return state;
+    }
+
+    state.size = file.size();
+    state.lastModified = QFileInfo(file).lastModified().toMSecsSinceEpoch();
+#ifdef Q_OS_UNIX
+    struct stat statBuf;
+    if (!fstat(file.handle(), &statBuf)) {
+        state.fileId = static_cast<quint64>(statBuf.st_ino);
+    }
+#endif
+    if (!readEdges) {
+        return state;
+    }
+
+    CryptoHash hash(CryptoHash::Sha256);
+    hash.addData(file.read(EdgeSize));
+    if (state.size > EdgeSize && file.seek(qMax(EdgeSize, state.size - EdgeSize))) {
+        hash.addData(file.read(EdgeSize));
+    }
+    state.edgeChecksum = hash.result();
+    return state;
+}
+
+/**
+ * Check whether the file changed since the last check.
+ *
+ * Every save writes new random seeds into the KDBX header, so a changed file
+ * is recognized by its size, start or end already. The configured checksum is
+ * only calculated if the file was touched or replaced without changing those,
+ * and once while the file is unchanged to compare against later. A file that
+ * is touched before that is reported as changed.
+ *
+ * @param state receives the current state of the file
+ * @return true if the file changed
+ */
+bool FileWatcher::probeFile(FileState& state) const
+{
+    state = readFileState();
+    if (state.size < 0) {
+        // If we fail to open the file keep the last known state, this
+        // prevents unnecessary merge requests on intermittent network shares
+        state = m_fileState;
+        return false;
+    }
+
+    if (state.size != m_fileState.size || state.edgeChecksum != m_fileState.edgeChecksum) {
+        return true;
+    }
+    if (state.lastModified == m_fileState.lastModified && state.fileId == m_fileState.fileId) {
+        // Calculated off the GUI thread by the first periodic check instead of in start()
+        state.checksum = m_fileState.checksum.isEmpty() ? calculateChecksum() : m_fileState.checksum;
+        return false;
+    }
 
-                                   m_ignoreFileChange = false;
-                               });
+    // The checksum is not known after a change that was recognized without it
+    state.checksum = calculateChecksum();
+    return m_fileState.checksum.isEmpty() || state.checksum != m_fileState.checksum;
 }
 
-QByteArray FileWatcher::calculateChecksum()
+QByteArray FileWatcher::calculateChecksum() const
 {
     QFile file(m_filePath);
     if (!m_filePath.isEmpty() && file.open(QFile::ReadOnly)) {
-        QCryptographicHash hash(QCryptographicHash::Sha256);
+        CryptoHash hash(CryptoHash::Sha256);
         if (m_fileChecksumSizeBytes > 0) {
             hash.addData(file.read(m_fileChecksumSizeBytes));
         } else {
@@ -142,5 +322,5 @@ QByteArray FileWatcher::calculateChecksum()
     }
     // If we fail to open the file return the last known checksum, this
     // prevents unnecessary merge requests on intermittent network shares
-    return m_fileChecksum;
+    return m_fileState.checksum;
 }
@@ -21,15 +21,32 @@
 #include <QFileSystemWatcher>
 #include <QTimer>
 
+/**
+ * Start and end of a file as it was just written, see EdgeRecordingStream.
+ */
+struct WrittenFile
+{
+    qint64 size = -1;
+    QByteArray head;
+    QByteArray tail;
+};
+
 class FileWatcher : public QObject
 {
     Q_OBJECT
 
 public:
+    // Covers the KDBX header with its random seeds and the HMAC of the final block
+    static constexpr qint64 EdgeSize = 4096;
+
     explicit FileWatcher(QObject* parent = nullptr);
     ~FileWatcher() override;
 
     void start(const QString& path, int checksumIntervalSeconds = 0, int checksumSizeKibibytes = -1);
+    void start(const QString& path,
+               int checksumIntervalSeconds,
+               int checksumSizeKibibytes,
+               const WrittenFile& writtenFile);
     void stop();
 
     bool hasSameFileChecksum();
@@ -42,18 +59,37 @@ public slots:
     void resume();
 
 private slots:
+    void handleFileSystemEvent();
     void checkFileChanged();
 
 private:
-    QByteArray calculateChecksum();
+    struct FileState
+    {
+        qint64 size = -1;
+        qint64 lastModified = -1;
+        quint64 fileId = 0;
+        // Checksum of the start and the end of the file
+        QByteArray edgeChecksum;
+        // Checksum as configured in start(), calculated by the first check that finds the file unchanged
+        QByteArray checksum;
+    };
+
+    void watch(const QString& path, int checksumIntervalSeconds, int checksumSizeKibibytes);
+    FileState readFileState(bool readEdges = true) const;
+    bool probeFile(FileState& state) const;
+    QByteArray calculateChecksum() const;
     bool shouldIgnoreChanges();
+    void updatePollingInterval(bool changed);
 
     QString m_filePath;
     QFileSystemWatcher m_fileWatcher;
-    QByteArray m_fileChecksum;
+    FileState m_fileState;
     QTimer m_fileChangeDelayTimer;
     QTimer m_fileIgnoreDelayTimer;
     QTimer m_fileChecksumTimer;
+    QTimer m_fileEventDelayTimer;
+    int m_fileChecksumIntervalMs = 0;
+    bool m_networkFilesystem = false;
     int m_fileChecksumSizeBytes = -1;
     bool m_ignoreFileChange = false;
 };
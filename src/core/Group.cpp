@@ -25,18 +25,75 @@
 #include "keeshare/KeeShare.h"
 #endif
 
+#include "core/EntryReferenceIndex.h"
 #include "core/Global.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 
+#include <QRegularExpression>
 #include <QtConcurrent>
 #include <QtConcurrentFilter>
 
+#include <atomic>
+
 const int Group::DefaultIconNumber = 48;
 const int Group::OpenFolderIconNumber = 49;
 const int Group::RecycleBinIconNumber = 43;
 const QString Group::RootAutoTypeSequence = "{USERNAME}{TAB}{PASSWORD}{ENTER}";
 
+namespace
+{
+    // Changed whenever a group property changes that child groups may inherit
+    std::atomic<quint64> s_inheritedRevision(1);
+
+    /**
+     * Point the uuid references of a clone at the clones of their targets.
+     *
+     * @param clone clone that is not part of a group yet
+     * @param cloneUuids uuids of the clones keyed by the uuids of their originals
+     * @param flags flags the clone was made with, references to the original it adds are kept
+     */
+    void rewriteCloneReferences(Entry* clone, const QHash<QUuid, QUuid>& cloneUuids, Entry::CloneFlags flags)
+    {
+        static const QRegularExpression uuidReference(R"(\{REF:[TUPANI]@I:([0-9a-f]{32})\})",
+                                                      QRegularExpression::CaseInsensitiveOption);
+
+        auto attributes = clone->attributes();
+        for (const auto& key : attributes->keys()) {
+            if ((key == EntryAttributes::UserNameKey && flags.testFlag(Entry::CloneUserAsRef))
+                || (key == EntryAttributes::PasswordKey && flags.testFlag(Entry::ClonePassAsRef))) {
+                continue;
+            }
+            QString value = attributes->value(key);
+            if (!value.contains(QLatin1String("{REF:"), Qt::CaseInsensitive)) {
+                continue;
+            }
+
+            QVector<QRegularExpressionMatch> found;
+            auto matches = uuidReference.globalMatch(value);
+            while (matches.hasNext()) {
+                found.append(matches.next());
+            }
+
+            // Replace from the back so the positions of earlier matches stay valid
+            bool rewritten = false;
+            for (int i = found.size() - 1; i >= 0; --i) {
+                const auto& match = found.at(i);
+                const auto target = QUuid::fromRfc4122(QByteArray::fromHex(match.captured(1).toLatin1()));
+                const auto cloneUuid = cloneUuids.constFind(target);
+                if (cloneUuid != cloneUuids.constEnd()) {
+                    value.replace(
+                        match.capturedStart(1), match.capturedLength(1), Tools::uuidToHex(*cloneUuid).toUpper());
+                    rewritten = true;
+                }
+            }
+            if (rewritten) {
+                attributes->set(key, value, attributes->isProtected(key));
+            }
+        }
+    }
+} // namespace
+
 Group::Group()
     : m_customData(new CustomData(this))
     , m_updateTimeinfo(true)
@@ -48,23 +105,30 @@ Group::Group()
     m_data.mergeMode = Default;
 
     connect(m_customData, &CustomData::modified, this, &Group::modified);
-    connect(this, &Group::modified, this, &Group::updateTimeinfo);
-    connect(this, &Group::groupNonDataChange, this, &Group::updateTimeinfo);
+    // Unlike modified, these are also emitted while a database is read
+    connect(m_customData, &CustomData::added, this, &Group::invalidateInheritedProperties);
+    connect(m_customData, &CustomData::valueChanged, this, &Group::invalidateInheritedProperties);
+    connect(m_customData, &CustomData::removed, this, &Group::invalidateInheritedProperties);
+    connect(m_customData, &CustomData::renamed, this, &Group::invalidateInheritedProperties);
+    connect(m_customData, &CustomData::reset, this, &Group::invalidateInheritedProperties);
+    connect(this, &Group::modified, this, &Group::handleModified);
+    connect(this, &Group::groupNonDataChange, this, &Group::handleNonDataChange);
 }
 
 Group::~Group()
 {
     setUpdateTimeinfo(false);
     // Destroy entries and children manually so DeletedObjects can be added
-    // to database.
+    // to database. Outside of a database they are destroyed from the end,
+    // which keeps removing them from the lists cheap.
     const QList<Entry*> entries = m_entries;
-    for (Entry* entry : entries) {
-        delete entry;
+    for (int i = 0; i < entries.size(); ++i) {
+        delete entries.at(m_db ? i : entries.size() - 1 - i);
     }
 
     const QList<Group*> children = m_children;
-    for (Group* group : children) {
-        delete group;
+    for (int i = 0; i < children.size(); ++i) {
+        delete children.at(m_db ? i : children.size() - 1 - i);
     }
 
     if (m_db && m_parent) {
@@ -101,6 +165,26 @@ void Group::updateTimeinfo()
     }
 }
 
+/**
+ * Update the group after it was modified and notify its database, which does not
+ * connect to every group.
+ */
+void Group::handleModified()
+{
+    updateTimeinfo();
+    if (m_db) {
+        m_db->notifyObjectModified();
+    }
+}
+
+void Group::handleNonDataChange()
+{
+    updateTimeinfo();
+    if (m_db) {
+        m_db->markNonDataChange();
+    }
+}
+
 void Group::setUpdateTimeinfo(bool value)
 {
     m_updateTimeinfo = value;
@@ -133,15 +217,7 @@ QString Group::tags() const
 
 QString Group::fullPath() const
 {
-    QString fullPath;
-    auto group = this;
-
-    do {
-        fullPath.insert(0, "/" + group->name());
-        group = group->parentGroup();
-    } while (group);
-
-    return fullPath;
+    return resolvedPath().fullPath;
 }
 
 int Group::iconNumber() const
@@ -175,23 +251,7 @@ QString Group::defaultAutoTypeSequence() const
  */
 QString Group::effectiveAutoTypeSequence() const
 {
-    QString sequence;
-
-    const Group* group = this;
-    do {
-        if (group->autoTypeEnabled() == Group::Disable) {
-            return {};
-        }
-
-        sequence = group->defaultAutoTypeSequence();
-        group = group->parentGroup();
-    } while (group && sequence.isEmpty());
-
-    if (sequence.isEmpty()) {
-        sequence = RootAutoTypeSequence;
-    }
-
-    return sequence;
+    return inheritedProperties().autoTypeSequence;
 }
 
 Group::TriState Group::autoTypeEnabled() const
@@ -222,19 +282,19 @@ Entry* Group::lastTopVisibleEntry() const
 
 bool Group::isRecycled() const
 {
-    auto group = this;
-    auto db = group->database();
-    if (db) {
-        auto recycleBin = db->metadata()->recycleBin();
-        do {
-            if (group == recycleBin) {
-                return true;
-            }
-            group = group->m_parent;
-        } while (group);
+    auto db = database();
+    if (!db) {
+        return false;
     }
 
-    return false;
+    const Group* recycleBin = db->metadata()->recycleBin();
+    auto& inherited = inheritedProperties();
+    if (!inherited.recycledResolved || inherited.recycleBin != recycleBin) {
+        inherited.recycled = recycleBin && (this == recycleBin || (m_parent && m_parent->isRecycled()));
+        inherited.recycleBin = recycleBin;
+        inherited.recycledResolved = true;
+    }
+    return inherited.recycled;
 }
 
 bool Group::isExpired() const
@@ -274,15 +334,17 @@ const CustomData* Group::customData() const
 Group::TriState Group::resolveCustomDataTriState(const QString& key, bool checkParent) const
 {
     // If not defined, check our parent up to the root group
-    if (!m_customData->contains(key)) {
-        if (!m_parent || !checkParent) {
-            return Inherit;
-        } else {
-            return m_parent->resolveCustomDataTriState(key);
-        }
+    InheritedProperties::Value resolved;
+    if (checkParent) {
+        resolved = resolveCustomDataValue(key);
+    } else if (m_customData->contains(key)) {
+        resolved = {true, m_customData->value(key)};
+    }
+    if (!resolved.defined) {
+        return Inherit;
     }
 
-    return m_customData->value(key) == TRUE_STR ? Enable : Disable;
+    return resolved.value == TRUE_STR ? Enable : Disable;
 }
 
 void Group::setCustomDataTriState(const QString& key, const Group::TriState& value)
@@ -304,15 +366,35 @@ void Group::setCustomDataTriState(const QString& key, const Group::TriState& val
 QString Group::resolveCustomDataString(const QString& key, bool checkParent) const
 {
     // If not defined, check our parent up to the root group
-    if (!m_customData->contains(key)) {
-        if (!m_parent || !checkParent) {
-            return QString();
-        } else {
-            return m_parent->resolveCustomDataString(key);
-        }
+    if (!checkParent) {
+        return m_customData->value(key);
+    }
+    return resolveCustomDataValue(key).value;
+}
+
+/**
+ * Resolve a custom data value through the parent groups, using the cached
+ * result of earlier lookups while no inherited property changed.
+ *
+ * @param key custom data key
+ * @return value of the closest group defining the key
+ */
+Group::InheritedProperties::Value Group::resolveCustomDataValue(const QString& key) const
+{
+    auto& inherited = inheritedProperties();
+    auto it = inherited.customData.constFind(key);
+    if (it != inherited.customData.constEnd()) {
+        return it.value();
     }
 
-    return m_customData->value(key);
+    InheritedProperties::Value resolved;
+    if (m_customData->contains(key)) {
+        resolved = {true, m_customData->value(key)};
+    } else if (m_parent) {
+        resolved = m_parent->resolveCustomDataValue(key);
+    }
+    inherited.customData.insert(key, resolved);
+    return resolved;
 }
 
 bool Group::equals(const Group* other, CompareItemOptions options) const
@@ -356,7 +438,9 @@ void Group::setUuid(const QUuid& uuid)
 void Group::setName(const QString& name)
 {
     if (set(m_data.name, name)) {
-        emit groupDataChanged(this);
+        // The name is part of the paths of all child groups
+        invalidateInheritedProperties();
+        emitGroupDataChanged();
     }
 }
 
@@ -376,7 +460,7 @@ void Group::setIcon(int iconNumber)
         m_data.iconNumber = iconNumber;
         m_data.customIcon = QUuid();
         emitModified();
-        emit groupDataChanged(this);
+        emitGroupDataChanged();
     }
 }
 
@@ -386,7 +470,7 @@ void Group::setIcon(const QUuid& uuid)
         m_data.customIcon = uuid;
         m_data.iconNumber = 0;
         emitModified();
-        emit groupDataChanged(this);
+        emitGroupDataChanged();
     }
 }
 
@@ -405,17 +489,23 @@ void Group::setExpanded(bool expanded)
 
 void Group::setDefaultAutoTypeSequence(const QString& sequence)
 {
-    set(m_data.defaultAutoTypeSequence, sequence);
+    if (set(m_data.defaultAutoTypeSequence, sequence)) {
+        invalidateInheritedProperties();
+    }
 }
 
 void Group::setAutoTypeEnabled(TriState enable)
 {
-    set(m_data.autoTypeEnabled, enable);
+    if (set(m_data.autoTypeEnabled, enable)) {
+        invalidateInheritedProperties();
+    }
 }
 
 void Group::setSearchingEnabled(TriState enable)
 {
-    set(m_data.searchingEnabled, enable);
+    if (set(m_data.searchingEnabled, enable)) {
+        invalidateInheritedProperties();
+    }
 }
 
 void Group::setLastTopVisibleEntry(Entry* entry)
@@ -475,6 +565,8 @@ void Group::setParent(Group* parent, int index, bool trackPrevious)
         return;
     }
 
+    invalidateInheritedProperties();
+
     if (!moveWithinDatabase) {
         cleanupParent();
         m_parent = parent;
@@ -489,14 +581,20 @@ void Group::setParent(Group* parent, int index, bool trackPrevious)
             }
         }
         if (m_db != parent->m_db) {
-            connectDatabaseSignalsRecursive(parent->m_db);
+            setDatabaseRecursive(parent->m_db);
         }
         QObject::setParent(parent);
         emit groupAboutToAdd(this, index);
+        if (m_db) {
+            emit m_db->groupAboutToAdd(this, index);
+        }
         Q_ASSERT(index <= parent->m_children.size());
         parent->m_children.insert(index, this);
     } else {
         emit aboutToMove(this, parent, index);
+        if (m_db) {
+            emit m_db->groupAboutToMove(this, parent, index);
+        }
         if (trackPrevious && m_parent != parent) {
             setPreviousParentGroup(m_parent);
         }
@@ -515,8 +613,14 @@ void Group::setParent(Group* parent, int index, bool trackPrevious)
 
     if (!moveWithinDatabase) {
         emit groupAdded();
+        if (m_db) {
+            emit m_db->groupAdded();
+        }
     } else {
         emit groupMoved();
+        if (m_db) {
+            emit m_db->groupMoved();
+        }
     }
 }
 
@@ -528,13 +632,18 @@ void Group::setParent(Database* db)
     cleanupParent();
 
     m_parent = nullptr;
-    connectDatabaseSignalsRecursive(db);
+    invalidateInheritedProperties();
+    setDatabaseRecursive(db);
 
     QObject::setParent(db);
 }
 
 QStringList Group::hierarchy(int height) const
 {
+    if (height < 0) {
+        return resolvedPath().hierarchy;
+    }
+
     QStringList hierarchy;
     const Group* group = this;
     const Group* parent = m_parent;
@@ -597,47 +706,92 @@ const QList<Entry*>& Group::entries() const
 QList<Entry*> Group::entriesRecursive(bool includeHistoryItems) const
 {
     QList<Entry*> entryList;
-
-    entryList.append(m_entries);
-
-    if (includeHistoryItems) {
-        for (Entry* entry : m_entries) {
-            entryList.append(entry->historyItems());
-        }
-    }
-
-    for (Group* group : m_children) {
-        entryList.append(group->entriesRecursive(includeHistoryItems));
-    }
-
+    forEachEntryRecursive(
+        [&entryList](Entry* entry) {
+            entryList.append(entry);
+            return true;
+        },
+        includeHistoryItems);
     return entryList;
 }
 
 QList<Entry*> Group::referencesRecursive(const Entry* entry) const
 {
+    if (m_db && m_db->rootGroup() == this) {
+        return m_db->referenceIndex()->referrers(this, entry->uuid());
+    }
+
     auto entries = entriesRecursive();
     return QtConcurrent::blockingFiltered(entries,
                                           [entry](const Entry* e) { return e->hasReferencesTo(entry->uuid()); });
 }
 
+/**
+ * Clone a selection of entries in one bulk update of their database.
+ *
+ * Every clone is added to the group of its original. References between the
+ * selected entries are pointed at the clones, the references to the originals
+ * added by Entry::CloneUserAsRef and Entry::ClonePassAsRef are kept. Attachment
+ * data is shared between the originals and the clones.
+ *
+ * @param entries entries to clone, all of them in one database
+ * @param flags flags to clone the entries with
+ * @return clones in the order of the entries
+ */
+QList<Entry*> Group::cloneEntries(const QList<Entry*>& entries, Entry::CloneFlags flags)
+{
+    QList<Entry*> clones;
+    if (entries.isEmpty()) {
+        return clones;
+    }
+
+    QHash<QUuid, QUuid> cloneUuids;
+    clones.reserve(entries.size());
+    for (const auto* entry : entries) {
+        auto clone = entry->clone(flags);
+        cloneUuids.insert(entry->uuid(), clone->uuid());
+        clones.append(clone);
+    }
+
+    // Clones are rewritten before they are added, so no signals reach the database
+    if (flags.testFlag(Entry::CloneNewUuid)) {
+        for (auto* clone : asConst(clones)) {
+            clone->setUpdateTimeinfo(false);
+            rewriteCloneReferences(clone, cloneUuids, flags);
+            clone->setUpdateTimeinfo(true);
+        }
+    }
+
+    DatabaseBulkUpdate bulkUpdate(entries.first()->database());
+    for (int i = 0; i < entries.size(); ++i) {
+        clones.at(i)->setGroup(entries.at(i)->group());
+    }
+    return clones;
+}
+
 Entry* Group::findEntryByUuid(const QUuid& uuid, bool recursive) const
 {
     if (uuid.isNull()) {
         return nullptr;
     }
 
-    auto entries = m_entries;
-    if (recursive) {
-        entries = entriesRecursive(false);
+    if (!recursive) {
+        for (auto entry : m_entries) {
+            if (entry->uuid() == uuid) {
+                return entry;
+            }
+        }
+        return nullptr;
     }
 
-    for (auto entry : entries) {
+    Entry* found = nullptr;
+    forEachEntryRecursive([&](Entry* entry) {
         if (entry->uuid() == uuid) {
-            return entry;
+            found = entry;
         }
-    }
-
-    return nullptr;
+        return !found;
+    });
+    return found;
 }
 
 Entry* Group::findEntryByPath(const QString& entryPath) const
@@ -661,6 +815,13 @@ Entry* Group::findEntryBySearchTerm(const QString& term, EntryReferenceType refe
                "Database::findEntryRecursive",
                "Can't search entry with \"referenceType\" parameter equal to \"Unknown\"");
 
+    // References are always resolved from the root group, which the database keeps an index for
+    if (m_db && m_db->rootGroup() == this && EntryReferenceIndex::isIndexed(referenceType)) {
+        return m_db->referenceIndex()->find(this, term, referenceType);
+    }
+
+    const QUuid uuid =
+        referenceType == EntryReferenceType::QUuid ? QUuid::fromRfc4122(QByteArray::fromHex(term.toLatin1())) : QUuid();
     const QList<Group*> groups = groupsRecursive(true);
 
     for (const Group* group : groups) {
@@ -686,7 +847,7 @@ Entry* Group::findEntryBySearchTerm(const QString& term, EntryReferenceType refe
                 found = entry->notes() == term;
                 break;
             case EntryReferenceType::QUuid:
-                found = entry->uuid() == QUuid::fromRfc4122(QByteArray::fromHex(term.toLatin1()));
+                found = entry->uuid() == uuid;
                 break;
             case EntryReferenceType::CustomAttributes:
                 found = entry->attributes()->containsValue(term);
@@ -800,50 +961,46 @@ QString Group::print(bool recursive, bool flatten, int depth)
 QList<const Group*> Group::groupsRecursive(bool includeSelf) const
 {
     QList<const Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
-
-    for (const Group* group : asConst(m_children)) {
-        groupList.append(group->groupsRecursive(true));
-    }
-
+    forEachGroupRecursive(
+        [&groupList](const Group* group) {
+            groupList.append(group);
+            return true;
+        },
+        includeSelf);
     return groupList;
 }
 
 QList<Group*> Group::groupsRecursive(bool includeSelf)
 {
     QList<Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
-
-    for (Group* group : asConst(m_children)) {
-        groupList.append(group->groupsRecursive(true));
-    }
-
+    forEachGroupRecursive(
+        [&groupList](Group* group) {
+            groupList.append(group);
+            return true;
+        },
+        includeSelf);
     return groupList;
 }
 
 QSet<QUuid> Group::customIconsRecursive() const
 {
     QSet<QUuid> result;
-
-    if (!iconUuid().isNull()) {
-        result.insert(iconUuid());
-    }
-
-    const QList<Entry*> entryList = entriesRecursive(true);
-    for (Entry* entry : entryList) {
-        if (!entry->iconUuid().isNull()) {
-            result.insert(entry->iconUuid());
+    auto addIcon = [&result](const QUuid& uuid) {
+        if (!uuid.isNull()) {
+            result.insert(uuid);
         }
-    }
-
-    for (Group* group : m_children) {
-        result.unite(group->customIconsRecursive());
-    }
+    };
 
+    forEachGroupRecursive([&](const Group* group) {
+        addIcon(group->iconUuid());
+        return true;
+    });
+    forEachEntryRecursive(
+        [&](const Entry* entry) {
+            addIcon(entry->iconUuid());
+            return true;
+        },
+        true);
     return result;
 }
 
@@ -851,12 +1008,13 @@ QList<QString> Group::usernamesRecursive(int topN) const
 {
     // Collect all usernames and sort for easy counting
     QHash<QString, int> countedUsernames;
-    for (const auto* entry : entriesRecursive()) {
+    forEachEntryRecursive([&countedUsernames](const Entry* entry) {
         const auto username = entry->username();
         if (!username.isEmpty() && !entry->isAttributeReference(EntryAttributes::UserNameKey)) {
             countedUsernames.insert(username, ++countedUsernames[username]);
         }
-    }
+        return true;
+    });
 
     // Sort username/frequency pairs by frequency and name
     QList<QPair<QString, int>> sortedUsernames;
@@ -889,13 +1047,14 @@ Group* Group::findGroupByUuid(const QUuid& uuid)
         return nullptr;
     }
 
-    for (Group* group : groupsRecursive(true)) {
+    Group* found = nullptr;
+    forEachGroupRecursive([&](Group* group) {
         if (group->uuid() == uuid) {
-            return group;
+            found = group;
         }
-    }
-
-    return nullptr;
+        return !found;
+    });
+    return found;
 }
 
 const Group* Group::findGroupByUuid(const QUuid& uuid) const
@@ -904,13 +1063,14 @@ const Group* Group::findGroupByUuid(const QUuid& uuid) const
         return nullptr;
     }
 
-    for (const Group* group : groupsRecursive(true)) {
+    const Group* found = nullptr;
+    forEachGroupRecursive([&](const Group* group) {
         if (group->uuid() == uuid) {
-            return group;
+            found = group;
         }
-    }
-
-    return nullptr;
+        return !found;
+    });
+    return found;
 }
 
 Group* Group::findChildByName(const QString& name)
@@ -978,7 +1138,8 @@ Group* Group::clone(Entry::CloneFlags entryFlags, Group::CloneFlags groupFlags)
 void Group::copyDataFrom(const Group* other)
 {
     if (set(m_data, other->m_data)) {
-        emit groupDataChanged(this);
+        invalidateInheritedProperties();
+        emitGroupDataChanged();
     }
     m_customData->copyDataFrom(other->m_customData);
     m_lastTopVisibleEntry = other->m_lastTopVisibleEntry;
@@ -992,10 +1153,6 @@ void Group::addEntry(Entry* entry)
     emit entryAboutToAdd(entry);
 
     m_entries << entry;
-    connect(entry, &Entry::entryDataChanged, this, &Group::entryDataChanged);
-    if (m_db) {
-        connect(entry, &Entry::modified, m_db, &Database::markAsModified);
-    }
 
     emitModified();
     emit entryAdded(entry);
@@ -1009,11 +1166,11 @@ void Group::removeEntry(Entry* entry)
 
     emit entryAboutToRemove(entry);
 
-    entry->disconnect(this);
-    if (m_db) {
-        entry->disconnect(m_db);
+    // Bulk deletions remove entries from the end
+    const int index = m_entries.lastIndexOf(entry);
+    if (index >= 0) {
+        m_entries.removeAt(index);
     }
-    m_entries.removeAll(entry);
     emitModified();
     emit entryRemoved(entry);
 }
@@ -1044,39 +1201,26 @@ void Group::moveEntryDown(Entry* entry)
     emit groupNonDataChange();
 }
 
-void Group::connectDatabaseSignalsRecursive(Database* db)
+/**
+ * Set the database of the group and all its children and entries.
+ *
+ * Groups and entries notify their database directly, so moving a tree into
+ * another database does not connect any of its objects.
+ */
+void Group::setDatabaseRecursive(Database* db)
 {
-    if (m_db) {
-        disconnect(m_db);
-    }
-
-    for (Entry* entry : asConst(m_entries)) {
-        if (m_db) {
-            entry->disconnect(m_db);
-        }
-        if (db) {
-            connect(entry, &Entry::modified, db, &Database::markAsModified);
-        }
-    }
-
-    if (db) {
-        // clang-format off
-        connect(this, &Group::groupDataChanged, db, &Database::groupDataChanged);
-        connect(this, &Group::groupAboutToRemove, db, &Database::groupAboutToRemove);
-        connect(this, &Group::groupRemoved, db, &Database::groupRemoved);
-        connect(this, &Group::groupAboutToAdd, db, &Database::groupAboutToAdd);
-        connect(this, &Group::groupAdded, db, &Database::groupAdded);
-        connect(this, &Group::aboutToMove, db, &Database::groupAboutToMove);
-        connect(this, &Group::groupMoved, db, &Database::groupMoved);
-        connect(this, &Group::groupNonDataChange, db, &Database::markNonDataChange);
-        connect(this, &Group::modified, db, &Database::markAsModified);
-        // clang-format on
-    }
-
     m_db = db;
 
     for (Group* group : asConst(m_children)) {
-        group->connectDatabaseSignalsRecursive(db);
+        group->setDatabaseRecursive(db);
+    }
+}
+
+void Group::emitGroupDataChanged()
+{
+    emit groupDataChanged(this);
+    if (m_db) {
+        emit m_db->groupDataChanged(this);
     }
 }
 
@@ -1084,9 +1228,18 @@ void Group::cleanupParent()
 {
     if (m_parent) {
         emit groupAboutToRemove(this);
-        m_parent->m_children.removeAll(this);
+        if (m_db) {
+            emit m_db->groupAboutToRemove(this);
+        }
+        const int index = m_parent->m_children.lastIndexOf(this);
+        if (index >= 0) {
+            m_parent->m_children.removeAt(index);
+        }
         emitModified();
         emit groupRemoved();
+        if (m_db) {
+            emit m_db->groupRemoved();
+        }
     }
 }
 
@@ -1106,40 +1259,83 @@ void Group::recCreateDelObjects()
 
 bool Group::resolveSearchingEnabled() const
 {
-    switch (m_data.searchingEnabled) {
-    case Inherit:
-        if (!m_parent) {
+    return inheritedProperties().searchingEnabled;
+}
+
+bool Group::resolveAutoTypeEnabled() const
+{
+    return inheritedProperties().autoTypeEnabled;
+}
+
+/**
+ * Get the cached inherited properties, resolving them again if any group
+ * property that is inherited by child groups changed.
+ *
+ * @return properties that stay valid until the next change to any group
+ */
+Group::InheritedProperties& Group::inheritedProperties() const
+{
+    const quint64 revision = s_inheritedRevision;
+    if (m_inherited.revision == revision) {
+        return m_inherited;
+    }
+
+    const auto resolve = [this](TriState value, bool (Group::*resolveParent)() const) {
+        switch (value) {
+        case Inherit:
+            return !m_parent || (m_parent->*resolveParent)();
+        case Enable:
             return true;
-        } else {
-            return m_parent->resolveSearchingEnabled();
+        case Disable:
+            return false;
+        default:
+            Q_ASSERT(false);
+            return false;
         }
-    case Enable:
-        return true;
-    case Disable:
-        return false;
-    default:
-        Q_ASSERT(false);
-        return false;
+    };
+
+    m_inherited.customData.clear();
+    m_inherited.pathResolved = false;
+    m_inherited.recycledResolved = false;
+    m_inherited.searchingEnabled = resolve(m_data.searchingEnabled, &Group::resolveSearchingEnabled);
+    m_inherited.autoTypeEnabled = resolve(m_data.autoTypeEnabled, &Group::resolveAutoTypeEnabled);
+    // The first sequence defined on the way to the root, unless a group on the way disables Auto-Type
+    if (m_data.autoTypeEnabled == Disable) {
+        m_inherited.autoTypeSequence.clear();
+    } else if (!m_data.defaultAutoTypeSequence.isEmpty()) {
+        m_inherited.autoTypeSequence = m_data.defaultAutoTypeSequence;
+    } else {
+        m_inherited.autoTypeSequence = m_parent ? m_parent->effectiveAutoTypeSequence() : RootAutoTypeSequence;
     }
+    m_inherited.revision = revision;
+    return m_inherited;
 }
 
-bool Group::resolveAutoTypeEnabled() const
+/**
+ * @return cached properties with the names of the groups from the root group down to this group
+ */
+Group::InheritedProperties& Group::resolvedPath() const
 {
-    switch (m_data.autoTypeEnabled) {
-    case Inherit:
-        if (!m_parent) {
-            return true;
+    auto& inherited = inheritedProperties();
+    if (!inherited.pathResolved) {
+        if (m_parent) {
+            const auto& parent = m_parent->resolvedPath();
+            inherited.hierarchy = parent.hierarchy;
+            inherited.fullPath = parent.fullPath;
         } else {
-            return m_parent->resolveAutoTypeEnabled();
+            inherited.hierarchy.clear();
+            inherited.fullPath.clear();
         }
-    case Enable:
-        return true;
-    case Disable:
-        return false;
-    default:
-        Q_ASSERT(false);
-        return false;
+        inherited.hierarchy.append(m_data.name);
+        inherited.fullPath.append("/").append(m_data.name);
+        inherited.pathResolved = true;
     }
+    return inherited;
+}
+
+void Group::invalidateInheritedProperties()
+{
+    ++s_inheritedRevision;
 }
 
 Entry* Group::addEntryWithPath(const QString& entryPath)
@@ -1217,26 +1413,39 @@ void Group::applyGroupIconToChildEntries()
     }
 }
 
+/**
+ * Sort the subgroups by name in place, without moving groups one by one.
+ *
+ * Only groups whose children changed their order are modified, the database
+ * is marked as modified once for the whole tree. The recycle bin stays last.
+ *
+ * @param reverse sort in descending order
+ */
 void Group::sortChildrenRecursively(bool reverse)
 {
+    // The bulk updates of the subgroups are nested into this one
+    DatabaseBulkUpdate bulkUpdate(database());
+
     Group* recycleBin = nullptr;
     if (database()) {
         recycleBin = database()->metadata()->recycleBin();
     }
-    std::sort(m_children.begin(), m_children.end(), [=](const Group* childGroup1, const Group* childGroup2) -> bool {
-        if (childGroup1 == recycleBin) {
-            return false;
+    auto lessThan = [=](const Group* childGroup1, const Group* childGroup2) -> bool {
+        if (childGroup1 == recycleBin || childGroup2 == recycleBin) {
+            return childGroup2 == recycleBin && childGroup1 != recycleBin;
         }
-        QString name1 = childGroup1->name();
-        QString name2 = childGroup2->name();
-        return reverse ? name1.compare(name2, Qt::CaseInsensitive) > 0 : name1.compare(name2, Qt::CaseInsensitive) < 0;
-    });
+        const int result = childGroup1->name().compare(childGroup2->name(), Qt::CaseInsensitive);
+        return reverse ? result > 0 : result < 0;
+    };
 
-    for (auto child : m_children) {
-        child->sortChildrenRecursively(reverse);
+    if (!std::is_sorted(m_children.cbegin(), m_children.cend(), lessThan)) {
+        std::stable_sort(m_children.begin(), m_children.end(), lessThan);
+        emitModified();
     }
 
-    emitModified();
+    for (auto child : asConst(m_children)) {
+        child->sortChildrenRecursively(reverse);
+    }
 }
 
 const Group* Group::previousParentGroup() const
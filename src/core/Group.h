@@ -159,11 +159,15 @@ public:
     QList<Entry*> entriesRecursive(bool includeHistoryItems = false) const;
     QList<const Group*> groupsRecursive(bool includeSelf) const;
     QList<Group*> groupsRecursive(bool includeSelf);
+    template <typename Visitor> bool forEachEntryRecursive(Visitor&& visitor, bool includeHistoryItems = false) const;
+    template <typename Visitor> bool forEachGroupRecursive(Visitor&& visitor, bool includeSelf = true) const;
+    template <typename Visitor> bool forEachGroupRecursive(Visitor&& visitor, bool includeSelf = true);
     QSet<QUuid> customIconsRecursive() const;
     QList<QString> usernamesRecursive(int topN = -1) const;
 
     Group* clone(Entry::CloneFlags entryFlags = Entry::CloneDefault,
                  Group::CloneFlags groupFlags = Group::CloneDefault) const;
+    static QList<Entry*> cloneEntries(const QList<Entry*>& entries, Entry::CloneFlags flags = Entry::CloneDefault);
 
     void copyDataFrom(const Group* other);
     QString print(bool recursive = false, bool flatten = false, int depth = 0);
@@ -202,13 +206,44 @@ signals:
 
 private slots:
     void updateTimeinfo();
+    void handleModified();
+    void handleNonDataChange();
 
 private:
+    // Properties resolved through the parent groups, valid while revision matches the global inheritance revision
+    struct InheritedProperties
+    {
+        struct Value
+        {
+            bool defined = false;
+            QString value;
+        };
+
+        quint64 revision = 0;
+        bool searchingEnabled = true;
+        bool autoTypeEnabled = true;
+        QString autoTypeSequence;
+        QHash<QString, Value> customData;
+        // Resolved on first use, the recycled flag only for the recycle bin it was resolved against
+        bool pathResolved = false;
+        QStringList hierarchy;
+        QString fullPath;
+        bool recycledResolved = false;
+        const Group* recycleBin = nullptr;
+        bool recycled = false;
+    };
+
     template <class P, class V> bool set(P& property, const V& value);
 
     void setParent(Database* db);
 
-    void connectDatabaseSignalsRecursive(Database* db);
+    InheritedProperties& inheritedProperties() const;
+    InheritedProperties::Value resolveCustomDataValue(const QString& key) const;
+    InheritedProperties& resolvedPath() const;
+    static void invalidateInheritedProperties();
+
+    void setDatabaseRecursive(Database* db);
+    void emitGroupDataChanged();
     void cleanupParent();
     void recCreateDelObjects();
 
@@ -228,9 +263,81 @@ private:
 
     bool m_updateTimeinfo;
 
+    mutable InheritedProperties m_inherited;
+
     friend Group* Database::setRootGroup(Group* group);
+    friend void Database::releaseData(bool teardownInBackground);
 };
 
+/**
+ * Visit the entries of the group and all of its subgroups in the order of entriesRecursive(),
+ * without building a list.
+ *
+ * @param visitor called with every Entry*, returning false stops the traversal
+ * @param includeHistoryItems also visit the history items of the entries
+ * @return false if the visitor stopped the traversal
+ */
+template <typename Visitor> bool Group::forEachEntryRecursive(Visitor&& visitor, bool includeHistoryItems) const
+{
+    for (Entry* entry : m_entries) {
+        if (!visitor(entry)) {
+            return false;
+        }
+    }
+
+    if (includeHistoryItems) {
+        for (const Entry* entry : m_entries) {
+            for (Entry* historyItem : entry->historyItems()) {
+                if (!visitor(historyItem)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (const Group* group : m_children) {
+        if (!group->forEachEntryRecursive(visitor, includeHistoryItems)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Visit the group and all of its subgroups in the order of groupsRecursive(), without building a list.
+ *
+ * @param visitor called with every const Group*, returning false stops the traversal
+ * @param includeSelf also visit this group
+ * @return false if the visitor stopped the traversal
+ */
+template <typename Visitor> bool Group::forEachGroupRecursive(Visitor&& visitor, bool includeSelf) const
+{
+    if (includeSelf && !visitor(this)) {
+        return false;
+    }
+
+    for (const Group* group : m_children) {
+        if (!group->forEachGroupRecursive(visitor, true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Visitor> bool Group::forEachGroupRecursive(Visitor&& visitor, bool includeSelf)
+{
+    if (includeSelf && !visitor(this)) {
+        return false;
+    }
+
+    for (Group* group : asConst(m_children)) {
+        if (!group->forEachGroupRecursive(visitor, true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Q_DECLARE_OPERATORS_FOR_FLAGS(Group::CloneFlags)
 
 #endif // KEEPASSX_GROUP_H
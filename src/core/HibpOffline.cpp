@@ -17,93 +17,552 @@
 
 #include "HibpOffline.h"
 
+#include "core/Global.h"
 #include "core/Group.h"
 
+#include <QBitArray>
 #include <QCryptographicHash>
+#include <QFile>
+#include <QMutex>
 #include <QProcess>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
 namespace HibpOffline
 {
     const std::size_t SHA1_BYTES = 20;
 
-    enum class ParseResult
+    // Binary format: header followed by records of a SHA-1 and a big endian
+    // 32 bit count, sorted by SHA-1 so that hashes can be binary searched
+    const char BINARY_MAGIC[] = "KPXCHIBP";
+    const int BINARY_MAGIC_SIZE = 8;
+    const quint32 BINARY_VERSION = 1;
+    const int BINARY_HEADER_SIZE = BINARY_MAGIC_SIZE + 4;
+    const int BINARY_RECORD_SIZE = SHA1_BYTES + 4;
+
+    // Generously sized for "<40 hex digits>:<count>\r\n"
+    const int MAX_LINE_SIZE = 128;
+    const int READ_BLOCK_SIZE = 4 * 1024 * 1024;
+    // Blocks read ahead while the parser is busy
+    const int READ_AHEAD_BLOCKS = 4;
+
+    class HexTable
     {
-        Ok,
-        Eof,
-        Error
+    public:
+        HexTable()
+        {
+            memset(m_values, -1, sizeof(m_values));
+            for (int i = 0; i < 10; ++i) {
+                m_values['0' + i] = static_cast<signed char>(i);
+            }
+            for (int i = 0; i < 6; ++i) {
+                m_values['a' + i] = static_cast<signed char>(10 + i);
+                m_values['A' + i] = static_cast<signed char>(10 + i);
+            }
+        }
+
+        inline int value(char c) const
+        {
+            return m_values[static_cast<uchar>(c)];
+        }
+
+    private:
+        signed char m_values[256];
     };
 
-    ParseResult parseHibpLine(QIODevice& input, QByteArray& sha1, int& count)
+    const HexTable HEX_TABLE;
+
+    /**
+     * Parse a line like "<40 hex digits>:<count>" without its line ending.
+     *
+     * @param line start of the line
+     * @param size size of the line
+     * @param sha1 buffer of SHA1_BYTES bytes the decoded hash is written to
+     * @param count set to the count of the line
+     * @return false if the line is malformed
+     */
+    bool parseHibpLine(const char* line, int size, char* sha1, int& count)
     {
-        QByteArray hexSha1(SHA1_BYTES * 2, '\0');
-        const qint64 rc = input.read(hexSha1.data(), hexSha1.size());
-        if (rc == 0) {
-            return ParseResult::Eof;
-        } else if (rc != hexSha1.size()) {
-            return ParseResult::Error;
+        const int hexSize = SHA1_BYTES * 2;
+        if (size < hexSize + 1 || line[hexSize] != ':') {
+            return false;
         }
 
-        sha1 = QByteArray::fromHex(hexSha1);
-
-        char c;
-        if (!input.getChar(&c) || c != ':') {
-            return ParseResult::Error;
+        for (std::size_t i = 0; i < SHA1_BYTES; ++i) {
+            const int high = HEX_TABLE.value(line[2 * i]);
+            const int low = HEX_TABLE.value(line[2 * i + 1]);
+            if ((high | low) < 0) {
+                return false;
+            }
+            sha1[i] = static_cast<char>((high << 4) | low);
         }
 
         count = 0;
-        while (true) {
-            if (!input.getChar(&c)) {
-                return ParseResult::Error;
+        for (int i = hexSize + 1; i < size; ++i) {
+            const char c = line[i];
+            if (!('0' <= c && c <= '9')) {
+                return false;
             }
+            count *= 10;
+            count += (c - '0');
+        }
 
-            if (c == '\n' || c == '\r') {
-                break;
+        return true;
+    }
+
+    /**
+     * Reads a device in large blocks on its own thread, so the next blocks are
+     * read while the current one is parsed.
+     *
+     * A dedicated thread is used since the global thread pool may be busy
+     * with the callers of report().
+     */
+    class BlockReader
+    {
+    public:
+        explicit BlockReader(QIODevice& input)
+            : m_input(input)
+        {
+            m_thread.reset(QThread::create([this] { run(); }));
+            m_thread->start();
+        }
+
+        ~BlockReader()
+        {
+            {
+                QMutexLocker locker(&m_mutex);
+                m_stopped = true;
+                m_notFull.wakeAll();
             }
+            m_thread->wait();
+        }
 
-            if (!('0' <= c && c <= '9')) {
-                return ParseResult::Error;
+        /**
+         * @param block set to the next block, empty at the end of the device
+         * @return false on a read error
+         */
+        bool next(QByteArray& block)
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_blocks.isEmpty() && !m_failed) {
+                m_notEmpty.wait(&m_mutex);
             }
+            if (m_blocks.isEmpty()) {
+                return false;
+            }
+            block = m_blocks.dequeue();
+            m_notFull.wakeAll();
+            return true;
+        }
 
-            count *= 10;
-            count += (c - '0');
+    private:
+        void run()
+        {
+            forever {
+                QByteArray block(READ_BLOCK_SIZE, Qt::Uninitialized);
+                const qint64 read = m_input.read(block.data(), READ_BLOCK_SIZE);
+
+                QMutexLocker locker(&m_mutex);
+                if (read < 0) {
+                    m_failed = true;
+                    m_notEmpty.wakeAll();
+                    return;
+                }
+                block.resize(static_cast<int>(read));
+                while (m_blocks.size() >= READ_AHEAD_BLOCKS && !m_stopped) {
+                    m_notFull.wait(&m_mutex);
+                }
+                if (m_stopped) {
+                    return;
+                }
+                m_blocks.enqueue(block);
+                m_notEmpty.wakeAll();
+                if (read == 0) {
+                    return;
+                }
+            }
+        }
+
+        QIODevice& m_input;
+        QMutex m_mutex;
+        QWaitCondition m_notEmpty;
+        QWaitCondition m_notFull;
+        QQueue<QByteArray> m_blocks;
+        bool m_failed = false;
+        bool m_stopped = false;
+        QScopedPointer<QThread> m_thread;
+    };
+
+    /**
+     * Stream a HIBP text file in large blocks and hand each record to a callback.
+     *
+     * @param input HIBP text file
+     * @param callback called with the decoded SHA-1 and count of each record, returns false to abort
+     * @param error set to the reason of a failure
+     * @param progress called after every block, may be empty
+     * @return true if the whole file was parsed and the callback never aborted
+     */
+    template <typename Callback>
+    bool readHibpText(QIODevice& input, Callback callback, QString* error, const ProgressCallback& progress = {})
+    {
+        if (!input.isReadable()) {
+            *error = QObject::tr("HIBP file: read error");
+            return false;
         }
 
-        while (1 == input.peek(&c, 1) && (c == '\n' || c == '\r')) {
-            input.getChar(&c);
+        const qint64 total = input.isSequential() ? 0 : input.size();
+        char sha1[SHA1_BYTES];
+        quint64 lineNum = 0;
+        qint64 processed = 0;
+
+        auto parseLine = [&](const char* line, int size) {
+            if (size > 0 && line[size - 1] == '\r') {
+                --size;
+            }
+            // Blank lines are skipped and not counted
+            if (size == 0) {
+                return true;
+            }
+            int count = 0;
+            if (!parseHibpLine(line, size, sha1, count)) {
+                *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum + 1);
+                return false;
+            }
+            ++lineNum;
+            return callback(sha1, count, lineNum);
+        };
+        auto keepPending = [&](QByteArray& pending, const char* data, int size) {
+            pending.append(data, size);
+            if (pending.size() > MAX_LINE_SIZE) {
+                *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum + 1);
+                return false;
+            }
+            return true;
+        };
+
+        BlockReader reader(input);
+        QByteArray block;
+        // Incomplete line at the end of the previous block
+        QByteArray pending;
+        while (true) {
+            if (!reader.next(block)) {
+                *error = QObject::tr("HIBP file: read error");
+                return false;
+            }
+            if (block.isEmpty()) {
+                return parseLine(pending.constData(), pending.size());
+            }
+
+            const char* data = block.constData();
+            const int end = block.size();
+            int pos = 0;
+            while (pos < end) {
+                auto newline = static_cast<const char*>(memchr(data + pos, '\n', end - pos));
+                if (!newline) {
+                    break;
+                }
+                const int lineEnd = static_cast<int>(newline - data);
+                if (pending.isEmpty()) {
+                    if (!parseLine(data + pos, lineEnd - pos)) {
+                        return false;
+                    }
+                } else {
+                    if (!keepPending(pending, data + pos, lineEnd - pos)
+                        || !parseLine(pending.constData(), pending.size())) {
+                        return false;
+                    }
+                    pending.clear();
+                }
+                pos = lineEnd + 1;
+            }
+            if (pos < end && !keepPending(pending, data + pos, end - pos)) {
+                return false;
+            }
+
+            processed += end;
+            if (progress) {
+                progress(processed, total);
+            }
         }
+    }
 
-        return ParseResult::Ok;
+    inline int sha1Prefix(const char* sha1)
+    {
+        return (static_cast<uchar>(sha1[0]) << 8) | static_cast<uchar>(sha1[1]);
+    }
+
+    // Passwords hashed by one task, a single SHA-1 is too small to be worth a task of its own
+    const int HASH_BATCH_SIZE = 1024;
+
+    QVector<QByteArray> passwordSha1s(const QStringList& passwords)
+    {
+        QVector<QByteArray> hashes;
+        hashes.reserve(passwords.size());
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        for (const auto& password : passwords) {
+            hash.reset();
+            hash.addData(password.toUtf8());
+            hashes.append(hash.result());
+        }
+        return hashes;
     }
 
-    bool
-    report(QSharedPointer<Database> db, QIODevice& hibpInput, QList<QPair<const Entry*, int>>& findings, QString* error)
+    /**
+     * SHA-1 of the passwords of a database, sorted once for all lookups.
+     */
+    struct PasswordTable
     {
-        QMultiHash<QByteArray, const Entry*> entriesBySha1;
-        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
+        // Unique hashes in ascending order
+        QVector<QByteArray> hashes;
+        // Entries using the password of the hash at the same index
+        QVector<QVector<const Entry*>> entries;
+
+        const QVector<const Entry*>* find(const char* sha1) const
+        {
+            auto it = std::lower_bound(
+                hashes.constBegin(), hashes.constEnd(), sha1, [](const QByteArray& hash, const char* key) {
+                    return memcmp(hash.constData(), key, SHA1_BYTES) < 0;
+                });
+            if (it == hashes.constEnd() || memcmp(it->constData(), sha1, SHA1_BYTES) != 0) {
+                return nullptr;
+            }
+            return &entries.at(static_cast<int>(it - hashes.constBegin()));
+        }
+    };
+
+    PasswordTable hashPasswords(const QSharedPointer<Database>& db)
+    {
+        // Passwords are collected on this thread, each distinct password is hashed once on the thread pool
+        QHash<QString, int> passwordIndex;
+        QStringList passwords;
+        QVector<QVector<const Entry*>> entries;
+        db->rootGroup()->forEachEntryRecursive([&](const Entry* entry) {
             if (!entry->isRecycled()) {
-                const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
-                entriesBySha1.insert(sha1, entry);
+                auto index = passwordIndex.constFind(entry->password());
+                if (index == passwordIndex.constEnd()) {
+                    index = passwordIndex.insert(entry->password(), passwords.size());
+                    passwords.append(entry->password());
+                    entries.append({});
+                }
+                entries[index.value()].append(entry);
             }
+            return true;
+        });
+
+        QList<QStringList> batches;
+        for (int i = 0; i < passwords.size(); i += HASH_BATCH_SIZE) {
+            batches.append(passwords.mid(i, HASH_BATCH_SIZE));
+        }
+        const auto hashBatches = QtConcurrent::blockingMapped<QList<QVector<QByteArray>>>(batches, passwordSha1s);
+        QVector<QByteArray> hashes;
+        hashes.reserve(passwords.size());
+        for (const auto& batch : hashBatches) {
+            hashes += batch;
         }
 
-        QByteArray sha1;
-        for (quint64 lineNum = 1;; ++lineNum) {
-            int count = 0;
+        QVector<int> order(hashes.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&hashes](int a, int b) { return hashes.at(a) < hashes.at(b); });
 
-            switch (parseHibpLine(hibpInput, sha1, count)) {
-            case ParseResult::Eof:
-                return true;
-            case ParseResult::Error:
-                *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum);
-                return false;
-            default:
-                break;
+        PasswordTable table;
+        table.hashes.reserve(hashes.size());
+        table.entries.reserve(hashes.size());
+        for (int i : asConst(order)) {
+            table.hashes.append(hashes.at(i));
+            table.entries.append(entries.at(i));
+        }
+        return table;
+    }
+
+    bool isBinaryFormat(QIODevice& hibpInput)
+    {
+        const auto magic = QByteArray::fromRawData(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+        return hibpInput.isReadable() && hibpInput.peek(BINARY_MAGIC_SIZE) == magic;
+    }
+
+    bool binaryReport(QSharedPointer<Database> db,
+                      QIODevice& hibpInput,
+                      QList<QPair<const Entry*, int>>& findings,
+                      QString* error)
+    {
+        const qint64 size = hibpInput.size();
+        const QByteArray header = hibpInput.read(BINARY_HEADER_SIZE);
+        if (header.size() != BINARY_HEADER_SIZE
+            || qFromBigEndian<quint32>(header.constData() + BINARY_MAGIC_SIZE) != BINARY_VERSION
+            || (size - BINARY_HEADER_SIZE) % BINARY_RECORD_SIZE != 0) {
+            *error = QObject::tr("HIBP file: unsupported binary format");
+            return false;
+        }
+        const qint64 records = (size - BINARY_HEADER_SIZE) / BINARY_RECORD_SIZE;
+
+        // Files are mapped if possible, other devices have to support seeking
+        auto file = qobject_cast<QFile*>(&hibpInput);
+        const uchar* mapped = file ? file->map(0, size) : nullptr;
+        char buffer[BINARY_RECORD_SIZE];
+        auto record = [&](qint64 index) -> const char* {
+            const qint64 offset = BINARY_HEADER_SIZE + index * BINARY_RECORD_SIZE;
+            if (mapped) {
+                return reinterpret_cast<const char*>(mapped) + offset;
+            }
+            if (!hibpInput.seek(offset) || hibpInput.read(buffer, BINARY_RECORD_SIZE) != BINARY_RECORD_SIZE) {
+                return nullptr;
             }
+            return buffer;
+        };
 
-            for (const auto* entry : entriesBySha1.values(sha1)) {
-                findings.append({entry, count});
+        // Report in file order like the text format does
+        const auto passwords = hashPasswords(db);
+
+        bool ok = true;
+        for (int i = 0; i < passwords.hashes.size(); ++i) {
+            const auto& sha1 = passwords.hashes.at(i);
+            qint64 first = 0;
+            qint64 last = records;
+            const char* found = nullptr;
+            while (first < last) {
+                const qint64 middle = first + (last - first) / 2;
+                const char* data = record(middle);
+                if (!data) {
+                    ok = false;
+                    break;
+                }
+                const int cmp = memcmp(data, sha1.constData(), SHA1_BYTES);
+                if (cmp == 0) {
+                    found = data;
+                    break;
+                } else if (cmp < 0) {
+                    first = middle + 1;
+                } else {
+                    last = middle;
+                }
+            }
+            if (!ok) {
+                *error = QObject::tr("HIBP file: read error");
+                break;
+            }
+            if (found) {
+                const auto count = static_cast<int>(qFromBigEndian<quint32>(found + SHA1_BYTES));
+                for (const auto* entry : passwords.entries.at(i)) {
+                    findings.append({entry, count});
+                }
             }
         }
+
+        if (mapped) {
+            file->unmap(const_cast<uchar*>(mapped));
+        }
+        return ok;
+    }
+
+    /**
+     * Check the passwords of a database against an offline HIBP file.
+     *
+     * @param db database to check
+     * @param hibpInput HIBP file, either a text file as downloaded or a file converted with convert()
+     * @param findings leaked entries and how often their password has been seen
+     * @param error set to the reason of a failure
+     * @param progress called after every block read from a text file
+     * @return true if the file could be checked
+     */
+    bool report(QSharedPointer<Database> db,
+                QIODevice& hibpInput,
+                QList<QPair<const Entry*, int>>& findings,
+                QString* error,
+                const ProgressCallback& progress)
+    {
+        if (!hibpInput.isReadable()) {
+            *error = QObject::tr("HIBP file: read error");
+            return false;
+        }
+        if (isBinaryFormat(hibpInput)) {
+            return binaryReport(db, hibpInput, findings, error);
+        }
+
+        const auto passwords = hashPasswords(db);
+
+        // Most records do not match, rule them out by their first two bytes before looking them up
+        QBitArray prefixes(1 << 16);
+        for (const auto& sha1 : passwords.hashes) {
+            prefixes.setBit(sha1Prefix(sha1.constData()));
+        }
+
+        return readHibpText(
+            hibpInput,
+            [&](const char* sha1, int count, quint64) {
+                if (prefixes.testBit(sha1Prefix(sha1))) {
+                    if (const auto* entries = passwords.find(sha1)) {
+                        for (const auto* entry : *entries) {
+                            findings.append({entry, count});
+                        }
+                    }
+                }
+                return true;
+            },
+            error,
+            progress);
+    }
+
+    /**
+     * Convert a HIBP text file ordered by hash into the binary format read by report().
+     *
+     * @param hibpInput HIBP text file ordered by hash
+     * @param output device the binary file is written to
+     * @param error set to the reason of a failure
+     * @return true on success
+     */
+    bool convert(QIODevice& hibpInput, QIODevice& output, QString* error)
+    {
+        if (!hibpInput.isReadable()) {
+            *error = QObject::tr("HIBP file: read error");
+            return false;
+        }
+
+        QByteArray buffer;
+        const int bufferSize = BINARY_RECORD_SIZE * 64 * 1024;
+        buffer.reserve(bufferSize);
+        buffer.append(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+        char version[4];
+        qToBigEndian<quint32>(BINARY_VERSION, version);
+        buffer.append(version, sizeof(version));
+
+        auto flush = [&]() {
+            if (output.write(buffer) != buffer.size()) {
+                *error = QObject::tr("Failed to write converted HIBP file: %1").arg(output.errorString());
+                return false;
+            }
+            buffer.resize(0);
+            return true;
+        };
+
+        char previous[SHA1_BYTES];
+        bool first = true;
+        bool ok = readHibpText(
+            hibpInput,
+            [&](const char* sha1, int count, quint64 lineNum) {
+                if (!first && memcmp(sha1, previous, SHA1_BYTES) <= 0) {
+                    *error = QObject::tr("HIBP file, line %1: hashes must be in ascending order, "
+                                         "download the file ordered by hash")
+                                 .arg(lineNum);
+                    return false;
+                }
+                memcpy(previous, sha1, SHA1_BYTES);
+                first = false;
+
+                char countData[4];
+                qToBigEndian<quint32>(static_cast<quint32>(count), countData);
+                buffer.append(sha1, SHA1_BYTES);
+                buffer.append(countData, sizeof(countData));
+                return buffer.size() < bufferSize || flush();
+            },
+            error);
+        return ok && flush();
     }
 
     bool okonReport(QSharedPointer<Database> db,
@@ -117,33 +576,33 @@ namespace HibpOffline
             return false;
         }
 
+        // Entries sharing a password are looked up with a single okon run
+        const auto passwords = hashPasswords(db);
         QProcess okonProcess;
+        for (int i = 0; i < passwords.hashes.size(); ++i) {
+            const auto sha1Hex = QString::fromLatin1(passwords.hashes.at(i).toHex());
+            okonProcess.start(okon, {"--path", okonDatabase, "--hash", sha1Hex});
+            if (!okonProcess.waitForStarted()) {
+                *error = QObject::tr("Could not start okon process: %1").arg(okon);
+                return false;
+            }
 
-        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
-            if (!entry->isRecycled()) {
-                const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
-                okonProcess.start(okon, {"--path", okonDatabase, "--hash", QString::fromLatin1(sha1.toHex())});
-                if (!okonProcess.waitForStarted()) {
-                    *error = QObject::tr("Could not start okon process: %1").arg(okon);
-                    return false;
-                }
-
-                if (!okonProcess.waitForFinished()) {
-                    *error = QObject::tr("Error: okon process did not finish");
-                    return false;
-                }
+            if (!okonProcess.waitForFinished()) {
+                *error = QObject::tr("Error: okon process did not finish");
+                return false;
+            }
 
-                switch (okonProcess.exitCode()) {
-                case 1:
+            switch (okonProcess.exitCode()) {
+            case 1:
+                for (const auto* entry : passwords.entries.at(i)) {
                     findings.append({entry, -1});
-                    break;
-                case 2:
-                    *error = QObject::tr("Failed to load okon processed database: %1").arg(okonDatabase);
-                    return false;
                 }
+                break;
+            case 2:
+                *error = QObject::tr("Failed to load okon processed database: %1").arg(okonDatabase);
+                return false;
             }
         }
-
         return true;
     }
 } // namespace HibpOffline
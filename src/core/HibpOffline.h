@@ -20,6 +20,8 @@
 
 #include <QSharedPointer>
 
+#include <functional>
+
 class QIODevice;
 
 class Database;
@@ -27,10 +29,17 @@ class Entry;
 
 namespace HibpOffline
 {
+    // Called with the bytes read so far and the size of the file, which is 0 if unknown
+    using ProgressCallback = std::function<void(qint64, qint64)>;
+
     bool report(QSharedPointer<Database> db,
                 QIODevice& hibpInput,
                 QList<QPair<const Entry*, int>>& findings,
-                QString* error);
+                QString* error,
+                const ProgressCallback& progress = {});
+
+    bool convert(QIODevice& hibpInput, QIODevice& output, QString* error);
+    bool isBinaryFormat(QIODevice& hibpInput);
 
     bool okonReport(QSharedPointer<Database> db,
                     const QString& okon,
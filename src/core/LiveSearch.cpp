@@ -0,0 +1,250 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LiveSearch.h"
+
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/Group.h"
+
+namespace
+{
+    // Queries of a database whose results are kept, the oldest one is dropped first
+    const int MaxLiveSearches = 32;
+} // namespace
+
+LiveSearch::LiveSearch(Database* db, const QString& query)
+    : QObject(db)
+    , m_db(db)
+    , m_query(query)
+{
+    setObjectName(query);
+
+    connect(db, &Database::groupAdded, this, &LiveSearch::invalidate);
+    connect(db, &Database::groupRemoved, this, &LiveSearch::invalidate);
+    connect(db, &Database::groupMoved, this, &LiveSearch::invalidate);
+    connect(db, &Database::groupDataChanged, this, &LiveSearch::invalidate);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &LiveSearch::invalidate);
+    connect(db, &Database::databaseDiscarded, this, &LiveSearch::invalidate);
+}
+
+/**
+ * Get the live results of a query, creating them on first use.
+ *
+ * @param db database to search
+ * @param query search string
+ * @return live search owned by the database
+ */
+LiveSearch* LiveSearch::forQuery(Database* db, const QString& query)
+{
+    auto search = db->findChild<LiveSearch*>(query, Qt::FindDirectChildrenOnly);
+    if (search) {
+        return search;
+    }
+
+    const auto searches = db->findChildren<LiveSearch*>(QString(), Qt::FindDirectChildrenOnly);
+    if (searches.size() >= MaxLiveSearches) {
+        delete searches.first();
+    }
+    return new LiveSearch(db, query);
+}
+
+QString LiveSearch::query() const
+{
+    return m_query;
+}
+
+/**
+ * Get the entries of the database matching the query.
+ *
+ * @param caseSensitive whether to match case sensitive, changing it evaluates the query again
+ * @return matching entries in the order of the group tree
+ */
+QList<Entry*> LiveSearch::results(bool caseSensitive)
+{
+    if (caseSensitive != m_searcher.isCaseSensitive()) {
+        m_searcher.setCaseSensitive(caseSensitive);
+        m_valid = false;
+    }
+    if (m_timeDependent && Clock::currentMilliSecondsSinceEpoch() - m_evaluatedAt >= RefreshInterval) {
+        m_valid = false;
+    }
+
+    if (m_rootGroup != m_db->rootGroup()) {
+        m_valid = false;
+    }
+    // Removed groups invalidate the results before they are destroyed
+    if (m_groupsChanged && m_valid) {
+        m_groupsChanged = false;
+        for (auto it = m_searchSettings.constBegin(); it != m_searchSettings.constEnd(); ++it) {
+            if (it.key()->searchingEnabled() != it.value()) {
+                m_valid = false;
+                break;
+            }
+        }
+    }
+
+    if (!m_valid) {
+        evaluate();
+    } else if (!m_dirty.isEmpty()) {
+        update();
+    }
+
+    if (!m_orderValid) {
+        m_orderValid = true;
+        m_results.clear();
+        if (m_rootGroup && !m_matches.isEmpty()) {
+            m_rootGroup->forEachEntryRecursive([this](Entry* entry) {
+                if (m_matches.contains(entry)) {
+                    m_results.append(entry);
+                }
+                return true;
+            });
+        }
+    }
+    return m_results;
+}
+
+void LiveSearch::addEntry(Entry* entry)
+{
+    if (entry->database() == m_db) {
+        watch(entry);
+        m_dirty.insert(entry);
+    }
+}
+
+void LiveSearch::invalidateEntry()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry) {
+        m_dirty.insert(entry);
+    }
+}
+
+void LiveSearch::removeEntry(Entry* entry)
+{
+    // The entry may be added to another group of the database right after
+    m_dirty.insert(entry);
+}
+
+void LiveSearch::removeDestroyedEntry(QObject* entry)
+{
+    // The entry is already destroyed at this point, only its address is used
+    auto destroyed = static_cast<const Entry*>(entry);
+    m_watched.remove(destroyed);
+    m_dirty.remove(destroyed);
+    if (m_matches.remove(destroyed)) {
+        m_orderValid = false;
+    }
+}
+
+void LiveSearch::invalidate()
+{
+    m_valid = false;
+}
+
+void LiveSearch::checkGroups()
+{
+    m_groupsChanged = true;
+}
+
+/**
+ * Match the query against all entries of the database.
+ */
+void LiveSearch::evaluate()
+{
+    disconnectAll();
+    m_valid = true;
+    m_orderValid = false;
+    m_matches.clear();
+    m_dirty.clear();
+    m_evaluatedAt = Clock::currentMilliSecondsSinceEpoch();
+    m_rootGroup = m_db->rootGroup();
+    if (!m_rootGroup) {
+        return;
+    }
+
+    m_rootGroup->forEachGroupRecursive([this](Group* group) {
+        connect(group, &Group::entryAdded, this, &LiveSearch::addEntry, Qt::UniqueConnection);
+        connect(group, &Group::entryRemoved, this, &LiveSearch::removeEntry, Qt::UniqueConnection);
+        // Groups are also modified by their entries, their search setting is compared before the next request
+        connect(group, &Group::modified, this, &LiveSearch::checkGroups, Qt::UniqueConnection);
+        m_searchSettings.insert(group, group->searchingEnabled());
+        for (auto* entry : group->entries()) {
+            watch(entry);
+        }
+        return true;
+    });
+
+    for (auto* entry : m_searcher.search(m_query, m_rootGroup)) {
+        m_matches.insert(entry);
+    }
+    m_timeDependent = m_searcher.isTimeDependent();
+}
+
+/**
+ * Match the query against the entries that changed since the last request.
+ */
+void LiveSearch::update()
+{
+    QList<Entry*> candidates;
+    for (const auto* entry : asConst(m_dirty)) {
+        m_matches.remove(entry);
+        // Entries that left the database are not connected anymore
+        auto changed = const_cast<Entry*>(entry);
+        if (changed->database() != m_db) {
+            m_watched.remove(entry);
+            disconnect(changed, nullptr, this, nullptr);
+            continue;
+        }
+        if (changed->group() && changed->group()->resolveSearchingEnabled()) {
+            candidates.append(changed);
+        }
+    }
+    m_dirty.clear();
+    m_orderValid = false;
+
+    if (!candidates.isEmpty()) {
+        for (auto* entry : m_searcher.searchEntries(m_query, candidates)) {
+            m_matches.insert(entry);
+        }
+    }
+}
+
+void LiveSearch::watch(Entry* entry)
+{
+    m_watched.insert(entry);
+    connect(entry, &Entry::modified, this, &LiveSearch::invalidateEntry, Qt::UniqueConnection);
+    connect(entry, &QObject::destroyed, this, &LiveSearch::removeDestroyedEntry, Qt::UniqueConnection);
+}
+
+void LiveSearch::disconnectAll()
+{
+    for (const auto* entry : asConst(m_watched)) {
+        disconnect(entry, nullptr, this, nullptr);
+    }
+    if (m_rootGroup) {
+        m_rootGroup->forEachGroupRecursive([this](const Group* group) {
+            disconnect(group, nullptr, this, nullptr);
+            return true;
+        });
+    }
+    m_watched.clear();
+    m_searchSettings.clear();
+    m_groupsChanged = false;
+}
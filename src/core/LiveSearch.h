@@ -0,0 +1,88 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_LIVESEARCH_H
+#define KEEPASSXC_LIVESEARCH_H
+
+#include "core/EntrySearcher.h"
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Results of a search over a whole database that are kept up to date.
+ *
+ * The query is evaluated once against all entries, afterwards only entries
+ * that were added, modified, moved or deleted are matched again when the
+ * results are requested. Changes to groups, which may change the hierarchy,
+ * the recycle bin or the search settings of many entries, evaluate the query
+ * again. Queries depending on the current time, such as is:expired, are
+ * evaluated again once RefreshInterval passed since their last evaluation.
+ */
+class LiveSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    static LiveSearch* forQuery(Database* db, const QString& query);
+
+    QList<Entry*> results(bool caseSensitive = false);
+    QString query() const;
+
+    // Time after which queries depending on the current time are evaluated again
+    static const qint64 RefreshInterval = 60 * 1000;
+
+private slots:
+    void addEntry(Entry* entry);
+    void invalidateEntry();
+    void removeEntry(Entry* entry);
+    void removeDestroyedEntry(QObject* entry);
+    void invalidate();
+    void checkGroups();
+
+private:
+    LiveSearch(Database* db, const QString& query);
+
+    void evaluate();
+    void update();
+    void watch(Entry* entry);
+    void disconnectAll();
+
+    Database* m_db;
+    QString m_query;
+    EntrySearcher m_searcher;
+    QPointer<Group> m_rootGroup;
+    bool m_valid = false;
+    bool m_timeDependent = false;
+    qint64 m_evaluatedAt = 0;
+    QSet<const Entry*> m_watched;
+    QHash<const Group*, int> m_searchSettings;
+    bool m_groupsChanged = false;
+    QSet<const Entry*> m_dirty;
+    QSet<const Entry*> m_matches;
+    // Matching entries in the order of the group tree, rebuilt after changes
+    QList<Entry*> m_results;
+    bool m_orderValid = false;
+};
+
+#endif // KEEPASSXC_LIVESEARCH_H
@@ -17,10 +17,71 @@
 
 #include "Merger.h"
 
+#include "core/AsyncTask.h"
+#include "core/DatabaseDiff.h"
 #include "core/Global.h"
 #include "core/Metadata.h"
+#include "core/PerformanceStats.h"
 #include "core/Tools.h"
 
+#include <QSet>
+#include <QThread>
+
+namespace
+{
+    /**
+     * Replace the contents of a database with the result of a merge.
+     *
+     * @param merged merged copy of the database, its tree is taken over
+     * @param targetDb database to update
+     */
+    void applyMergedDatabase(Database* merged, Database* targetDb)
+    {
+        // The metadata refers to groups of the tree that is about to be replaced
+        auto* metadata = targetDb->metadata();
+        const QUuid recycleBin = metadata->recycleBin() ? metadata->recycleBin()->uuid() : QUuid();
+        const QUuid entryTemplatesGroup =
+            metadata->entryTemplatesGroup() ? metadata->entryTemplatesGroup()->uuid() : QUuid();
+        const QUuid lastSelectedGroup = metadata->lastSelectedGroup() ? metadata->lastSelectedGroup()->uuid() : QUuid();
+        const QUuid lastTopVisibleGroup =
+            metadata->lastTopVisibleGroup() ? metadata->lastTopVisibleGroup()->uuid() : QUuid();
+        const QDateTime recycleBinChanged = metadata->recycleBinChanged();
+        const QDateTime entryTemplatesGroupChanged = metadata->entryTemplatesGroupChanged();
+
+        auto root = merged->setRootGroup(new Group());
+        delete targetDb->setRootGroup(root);
+
+        metadata->setRecycleBin(root->findGroupByUuid(recycleBin));
+        metadata->setRecycleBinChanged(recycleBinChanged);
+        metadata->setEntryTemplatesGroup(root->findGroupByUuid(entryTemplatesGroup));
+        metadata->setEntryTemplatesGroupChanged(entryTemplatesGroupChanged);
+        metadata->setLastSelectedGroup(root->findGroupByUuid(lastSelectedGroup));
+        metadata->setLastTopVisibleGroup(root->findGroupByUuid(lastTopVisibleGroup));
+
+        metadata->customData()->copyDataFrom(merged->metadata()->customData());
+        for (const QUuid& uuid : merged->metadata()->customIconsOrder()) {
+            if (!metadata->hasCustomIcon(uuid)) {
+                metadata->addCustomIcon(uuid, merged->metadata()->customIcon(uuid));
+            }
+        }
+        targetDb->setDeletedObjects(merged->deletedObjects());
+        targetDb->markAsModified();
+    }
+
+    /**
+     * Check whether two versions of an entry with the same modification time are the same.
+     *
+     * Gives the same result as Entry::equals() ignoring milliseconds and the history, except that
+     * attachments of the same name and size are regarded as equal without comparing their data.
+     */
+    bool isSameVersion(const Entry* item, const Entry* other)
+    {
+        return item == other
+               || (item->contentHash() == other->contentHash()
+                   && item->timeInfo().equals(other->timeInfo(), CompareItemIgnoreMilliseconds));
+    }
+} // namespace
+
 Merger::Merger(const Database* sourceDb, Database* targetDb)
     : m_mode(Group::Default)
 {
@@ -66,10 +127,20 @@ void Merger::setSkipDatabaseCustomData(bool state)
 
 QStringList Merger::merge()
 {
+    PerformanceStats::ScopedTimer timer("database.merge");
+
     // Order of merge steps is important - it is possible that we
     // create some items before deleting them afterwards
     ChangeList changes;
+    DatabaseBulkUpdate bulkUpdate(m_context.m_targetDb);
+    indexTarget(m_context);
+    m_sourceHashes.clear();
+    m_targetHashes.clear();
+    DatabaseDiff::hashSubtree(m_context.m_sourceRootGroup, m_sourceHashes);
+    DatabaseDiff::hashSubtree(m_context.m_targetRootGroup, m_targetHashes);
     changes << mergeGroup(m_context);
+    m_sourceHashes.clear();
+    m_targetHashes.clear();
     changes << mergeDeletions(m_context);
     changes << mergeMetadata(m_context);
 
@@ -80,13 +151,127 @@ QStringList Merger::merge()
     return changes;
 }
 
+/**
+ * Merge a database into another one without blocking the event loop.
+ *
+ * The source database is copied and the copy is merged into a copy of the target
+ * database on a worker thread, so the source may still be used meanwhile. The result
+ * replaces the contents of the target database at once, which must neither be shown
+ * nor used by anyone else until this returns. Both databases are kept alive while
+ * the event loop runs, callers have to hold off locking or closing them meanwhile.
+ *
+ * @param sourceDb database to merge
+ * @param targetDb database to merge into
+ * @return changes made to the target database
+ */
+QStringList Merger::mergeInBackground(QSharedPointer<const Database> sourceDb, QSharedPointer<Database> targetDb)
+{
+    if (!sourceDb || !targetDb) {
+        Q_ASSERT(sourceDb && targetDb);
+        return {};
+    }
+
+    // Both databases may change while the event loop runs, the worker only reads snapshots
+    const quint64 sourceRevision = sourceDb->dataRevision();
+    const quint64 targetRevision = targetDb->dataRevision();
+    auto sourceCopy = sourceDb->snapshot();
+    auto merged = targetDb->snapshot();
+
+    // Groups and entries created on the worker thread are parented to the merged copy,
+    // which therefore has to live there while merging
+    auto* thread = QThread::currentThread();
+    auto changes = AsyncTask::runAndWaitForFuture([&] {
+        merged->moveWithHistoryToThread(QThread::currentThread());
+        Merger merger(sourceCopy.data(), merged.data());
+        auto result = merger.merge();
+        merged->moveWithHistoryToThread(thread);
+        return result;
+    });
+
+    // The merged copy would discard changes made to the target in the meantime
+    if (targetDb->dataRevision() != targetRevision) {
+        Merger merger(sourceDb.data(), targetDb.data());
+        return merger.merge();
+    }
+
+    // Catch up with changes made to the source while the event loop was running
+    if (sourceDb->dataRevision() != sourceRevision) {
+        Merger merger(sourceDb.data(), merged.data());
+        changes << merger.merge();
+    }
+
+    if (!changes.isEmpty()) {
+        applyMergedDatabase(merged.data(), targetDb.data());
+    }
+    return changes;
+}
+
+/**
+ * Index the target database by uuid, so that counterparts of source items
+ * are found without scanning the whole target tree every time.
+ */
+void Merger::indexTarget(const MergeContext& context)
+{
+    m_targetEntries.clear();
+    m_targetGroups.clear();
+
+    // Like findEntryByUuid and findGroupByUuid, the first item in tree order wins for duplicate uuids
+    context.m_targetRootGroup->forEachGroupRecursive([this](Group* group) {
+        if (!m_targetGroups.contains(group->uuid())) {
+            m_targetGroups.insert(group->uuid(), group);
+        }
+        return true;
+    });
+    context.m_targetRootGroup->forEachEntryRecursive([this](Entry* entry) {
+        if (!m_targetEntries.contains(entry->uuid())) {
+            m_targetEntries.insert(entry->uuid(), entry);
+        }
+        return true;
+    });
+}
+
+Entry* Merger::findTargetEntry(const QUuid& uuid) const
+{
+    if (uuid.isNull()) {
+        return nullptr;
+    }
+    return m_targetEntries.value(uuid);
+}
+
+Group* Merger::findTargetGroup(const QUuid& uuid) const
+{
+    if (uuid.isNull()) {
+        return nullptr;
+    }
+    return m_targetGroups.value(uuid);
+}
+
+/**
+ * Hash the uuids, modification and location times of a group, its entries
+ * including their history and all subgroups.
+ *
+ * Subtrees with equal hashes contain the same items at the same locations,
+ * merging them does not change anything.
+ *
+ * @param group root of the subtree
+ * @param hashes receives the hashes of the group and all subgroups
+ * @return hash of the subtree
+ */
 Merger::ChangeList Merger::mergeGroup(const MergeContext& context)
 {
     ChangeList changes;
+    // An identical subtree stays identical while the rest is merged, as all its items are in place already
+    const auto sourceHash = m_sourceHashes.constFind(context.m_sourceGroup);
+    const auto targetHash = m_targetHashes.constFind(context.m_targetGroup);
+    if (sourceHash != m_sourceHashes.constEnd() && targetHash != m_targetHashes.constEnd()
+        && sourceHash.value() == targetHash.value()) {
+        return changes;
+    }
+
     // merge entries
     const QList<Entry*> sourceEntries = context.m_sourceGroup->entries();
     for (Entry* sourceEntry : sourceEntries) {
-        Entry* targetEntry = context.m_targetRootGroup->findEntryByUuid(sourceEntry->uuid());
+        Entry* targetEntry = findTargetEntry(sourceEntry->uuid());
         if (!targetEntry) {
             changes << tr("Creating missing %1 [%2]").arg(sourceEntry->title(), sourceEntry->uuidToHex());
             // This entry does not exist at all. Create it.
@@ -107,7 +292,7 @@ Merger::ChangeList Merger::mergeGroup(const MergeContext& context)
     // merge groups recursively
     const QList<Group*> sourceChildGroups = context.m_sourceGroup->children();
     for (Group* sourceChildGroup : sourceChildGroups) {
-        Group* targetChildGroup = context.m_targetRootGroup->findGroupByUuid(sourceChildGroup->uuid());
+        Group* targetChildGroup = findTargetGroup(sourceChildGroup->uuid());
         if (!targetChildGroup) {
             changes << tr("Creating missing %1 [%2]").arg(sourceChildGroup->name(), sourceChildGroup->uuidToHex());
             targetChildGroup = sourceChildGroup->clone(Entry::CloneNoFlags, Group::CloneNoFlags);
@@ -184,6 +369,9 @@ void Merger::moveEntry(Entry* entry, Group* targetGroup)
     entry->setUpdateTimeinfo(false);
 
     entry->setGroup(targetGroup);
+    if (!m_targetEntries.value(entry->uuid())) {
+        m_targetEntries.insert(entry->uuid(), entry);
+    }
 
     entry->setUpdateTimeinfo(entryUpdateTimeInfo);
     if (targetGroup) {
@@ -213,6 +401,9 @@ void Merger::moveGroup(Group* group, Group* targetGroup)
     group->setUpdateTimeinfo(false);
 
     group->setParent(targetGroup);
+    if (!m_targetGroups.value(group->uuid())) {
+        m_targetGroups.insert(group->uuid(), group);
+    }
 
     group->setUpdateTimeinfo(groupUpdateTimeInfo);
     if (targetGroup) {
@@ -233,6 +424,9 @@ void Merger::eraseEntry(Entry* entry)
     if (parentGroup) {
         parentGroup->setUpdateTimeinfo(false);
     }
+    if (m_targetEntries.value(entry->uuid()) == entry) {
+        m_targetEntries.remove(entry->uuid());
+    }
     delete entry;
     if (parentGroup) {
         parentGroup->setUpdateTimeinfo(groupUpdateTimeInfo);
@@ -250,6 +444,9 @@ void Merger::eraseGroup(Group* group)
     if (parentGroup) {
         parentGroup->setUpdateTimeinfo(false);
     }
+    if (m_targetGroups.value(group->uuid()) == group) {
+        m_targetGroups.remove(group->uuid());
+    }
     delete group;
     if (parentGroup) {
         parentGroup->setUpdateTimeinfo(groupUpdateTimeInfo);
@@ -319,36 +516,38 @@ bool Merger::mergeHistory(const Entry* sourceEntry,
     const bool preferLocal = comparison < 0;
     const bool preferRemote = comparison > 0;
 
-    QMap<QDateTime, Entry*> merged;
-    for (Entry* historyItem : targetHistoryItems) {
+    // Items are only cloned once the merged history turns out to differ from the target history
+    QMap<QDateTime, const Entry*> merged;
+    for (const Entry* historyItem : targetHistoryItems) {
         const QDateTime modificationTime = Clock::serialized(historyItem->timeInfo().lastModificationTime());
-        if (merged.contains(modificationTime)
-            && !merged[modificationTime]->equals(historyItem, CompareItemIgnoreMilliseconds)) {
+        auto existing = merged.constFind(modificationTime);
+        if (existing != merged.constEnd() && !isSameVersion(existing.value(), historyItem)) {
             ::qWarning("Inconsistent history entry of %s[%s] at %s contains conflicting changes - conflict resolution "
                        "may lose data!",
                        qPrintable(sourceEntry->title()),
                        qPrintable(sourceEntry->uuidToHex()),
                        qPrintable(modificationTime.toString("yyyy-MM-dd HH-mm-ss-zzz")));
         }
-        merged[modificationTime] = historyItem->clone(Entry::CloneNoFlags);
+        merged[modificationTime] = historyItem;
     }
-    for (Entry* historyItem : sourceHistoryItems) {
+    for (const Entry* historyItem : sourceHistoryItems) {
         // Items with same modification-time changes will be regarded as same (like KeePass2)
         const QDateTime modificationTime = Clock::serialized(historyItem->timeInfo().lastModificationTime());
-        if (merged.contains(modificationTime)
-            && !merged[modificationTime]->equals(historyItem, CompareItemIgnoreMilliseconds)) {
+        auto existing = merged.constFind(modificationTime);
+        if (existing == merged.constEnd()) {
+            merged.insert(modificationTime, historyItem);
+            continue;
+        }
+        if (!isSameVersion(existing.value(), historyItem)) {
             ::qWarning(
                 "History entry of %s[%s] at %s contains conflicting changes - conflict resolution may lose data!",
                 qPrintable(sourceEntry->title()),
                 qPrintable(sourceEntry->uuidToHex()),
                 qPrintable(modificationTime.toString("yyyy-MM-dd HH-mm-ss-zzz")));
-        }
-        if (preferRemote && merged.contains(modificationTime)) {
-            // forcefully apply the remote history item
-            delete merged.take(modificationTime);
-        }
-        if (!merged.contains(modificationTime)) {
-            merged[modificationTime] = historyItem->clone(Entry::CloneNoFlags);
+            if (preferRemote) {
+                // forcefully apply the remote history item
+                merged[modificationTime] = historyItem;
+            }
         }
     }
 
@@ -363,20 +562,13 @@ bool Merger::mergeHistory(const Entry* sourceEntry,
     }
 
     if (targetModificationTime < sourceModificationTime) {
-        if (preferLocal && merged.contains(targetModificationTime)) {
+        if (preferLocal || !merged.contains(targetModificationTime)) {
             // forcefully apply the local history item
-            delete merged.take(targetModificationTime);
-        }
-        if (!merged.contains(targetModificationTime)) {
-            merged[targetModificationTime] = targetEntry->clone(Entry::CloneNoFlags);
+            merged[targetModificationTime] = targetEntry;
         }
     } else if (targetModificationTime > sourceModificationTime) {
-        if (preferRemote && !merged.contains(sourceModificationTime)) {
-            // forcefully apply the remote history item
-            delete merged.take(sourceModificationTime);
-        }
         if (!merged.contains(sourceModificationTime)) {
-            merged[sourceModificationTime] = sourceEntry->clone(Entry::CloneNoFlags);
+            merged[sourceModificationTime] = sourceEntry;
         }
     }
 
@@ -388,26 +580,42 @@ bool Merger::mergeHistory(const Entry* sourceEntry,
         if (!oldEntry && !newEntry) {
             continue;
         }
-        if (oldEntry && newEntry && oldEntry->equals(newEntry, CompareItemIgnoreMilliseconds)) {
+        if (oldEntry && newEntry && isSameVersion(oldEntry, newEntry)) {
             continue;
         }
         changed = true;
         break;
     }
     if (!changed) {
-        qDeleteAll(updatedHistoryItems);
         return false;
     }
+
+    // Items of the target history that are kept are moved over instead of cloned
+    QSet<const Entry*> keptItems;
+    QList<Entry*> removedItems;
+    for (Entry* historyItem : targetHistoryItems) {
+        const QDateTime modificationTime = Clock::serialized(historyItem->timeInfo().lastModificationTime());
+        if (merged.value(modificationTime) == historyItem) {
+            keptItems.insert(historyItem);
+        } else {
+            removedItems.append(historyItem);
+        }
+    }
+
     // We need to prevent any modification to the database since every change should be tracked either
     // in a clone history item or in the Entry itself
     const TimeInfo timeInfo = targetEntry->timeInfo();
     const bool blockedSignals = targetEntry->blockSignals(true);
     bool updateTimeInfo = targetEntry->canUpdateTimeinfo();
     targetEntry->setUpdateTimeinfo(false);
-    targetEntry->removeHistoryItems(targetHistoryItems);
-    for (Entry* historyItem : merged) {
-        Q_ASSERT(!historyItem->parent());
-        targetEntry->addHistoryItem(historyItem);
+    targetEntry->removeHistoryItems(removedItems);
+    targetEntry->takeHistoryItems();
+    for (const Entry* historyItem : asConst(merged)) {
+        if (keptItems.contains(historyItem)) {
+            targetEntry->addHistoryItem(const_cast<Entry*>(historyItem));
+        } else {
+            targetEntry->addHistoryItem(historyItem->clone(Entry::CloneNoFlags));
+        }
     }
     targetEntry->truncateHistory();
     targetEntry->blockSignals(blockedSignals);
@@ -438,12 +646,12 @@ Merger::ChangeList Merger::mergeDeletions(const MergeContext& context)
         if (!mergedDeletions.contains(object.uuid)) {
             mergedDeletions[object.uuid] = object;
 
-            auto* entry = context.m_targetRootGroup->findEntryByUuid(object.uuid);
+            auto* entry = findTargetEntry(object.uuid);
             if (entry) {
                 entries << entry;
                 continue;
             }
-            auto* group = context.m_targetRootGroup->findGroupByUuid(object.uuid);
+            auto* group = findTargetGroup(object.uuid);
             if (group) {
                 groups << group;
                 continue;
@@ -485,7 +693,7 @@ Merger::ChangeList Merger::mergeDeletions(const MergeContext& context)
             // keep deleted group since it was changed after deletion date
             continue;
         }
-        if (!group->entriesRecursive(false).isEmpty() || !group->groupsRecursive(false).isEmpty()) {
+        if (group->hasChildren() || !group->entries().isEmpty()) {
             // keep deleted group since it contains undeleted content
             continue;
         }
@@ -20,6 +20,8 @@
 
 #include "core/Group.h"
 
+#include <QSharedPointer>
+
 class Database;
 class Entry;
 
@@ -34,6 +36,8 @@ public:
     void setSkipDatabaseCustomData(bool state);
     QStringList merge();
 
+    static QStringList mergeInBackground(QSharedPointer<const Database> sourceDb, QSharedPointer<Database> targetDb);
+
 private:
     typedef QString Change;
     typedef QStringList ChangeList;
@@ -63,11 +67,20 @@ private:
                                                            const Entry* sourceEntry,
                                                            Entry* targetEntry,
                                                            Group::MergeMode mergeMethod);
+    void indexTarget(const MergeContext& context);
+    Entry* findTargetEntry(const QUuid& uuid) const;
+    Group* findTargetGroup(const QUuid& uuid) const;
 
 private:
     MergeContext m_context;
     Group::MergeMode m_mode;
     bool m_skipCustomData = false;
+    // Entries and groups of the target database, kept current while merging
+    QHash<QUuid, QPointer<Entry>> m_targetEntries;
+    QHash<QUuid, QPointer<Group>> m_targetGroups;
+    // Subtree hashes of both databases as they were when the merge started
+    QHash<const Group*, QByteArray> m_sourceHashes;
+    QHash<const Group*, QByteArray> m_targetHashes;
 };
 
 #endif // KEEPASSXC_MERGER_H
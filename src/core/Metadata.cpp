@@ -26,9 +26,12 @@
 #include <QCryptographicHash>
 #include <QJsonDocument>
 
+#include <algorithm>
+
 const int Metadata::DefaultHistoryMaxItems = 10;
 const int Metadata::DefaultHistoryMaxSize = 6 * 1024 * 1024;
 const int Metadata::DefaultAutosaveDelayMin = 0;
+const int Metadata::AutoCompressionLevel = -1;
 
 // Fallback icon for return by reference
 static const Metadata::CustomIconData NULL_ICON{};
@@ -37,6 +40,7 @@ namespace customDataKeys
 {
     static const QString savedSearch = QStringLiteral("KPXC_SavedSearch");
     static const QString autosaveDelay = QStringLiteral("KPXC_autosaveDelayMin");
+    static const QString compressionLevel = QStringLiteral("KPXC_compressionLevel");
 }; // namespace customDataKeys
 
 Metadata::Metadata(QObject* parent)
@@ -79,6 +83,7 @@ void Metadata::clear()
     m_customIcons.clear();
     m_customIconsOrder.clear();
     m_customIconsHashes.clear();
+    m_customIconsSize = 0;
     m_customData->clear();
 }
 
@@ -202,6 +207,14 @@ bool Metadata::hasCustomIcon(const QUuid& uuid) const
     return m_customIcons.contains(uuid);
 }
 
+/**
+ * @return total size of the image data of all custom icons
+ */
+qint64 Metadata::customIconsSize() const
+{
+    return m_customIconsSize;
+}
+
 QList<QUuid> Metadata::customIconsOrder() const
 {
     return m_customIconsOrder;
@@ -285,6 +298,20 @@ int Metadata::autosaveDelayMin() const
     return autosaveDelayMin;
 }
 
+/**
+ * @return zlib level the payload is compressed with, AutoCompressionLevel
+ *         selects it from the compressed data
+ */
+int Metadata::compressionLevel() const
+{
+    bool ok;
+    int level = m_customData->value(customDataKeys::compressionLevel).toInt(&ok);
+    if (!ok || level < 0 || level > 9) {
+        return Metadata::AutoCompressionLevel;
+    }
+    return level;
+}
+
 CustomData* Metadata::customData()
 {
     return m_customData;
@@ -375,6 +402,7 @@ void Metadata::addCustomIcon(const QUuid& uuid, const CustomIconData& iconData)
     Q_ASSERT(!m_customIcons.contains(uuid));
 
     // remove all uuids to prevent duplicates in release mode
+    m_customIconsSize += iconData.data.size() - m_customIcons.value(uuid).data.size();
     m_customIcons[uuid] = iconData;
     m_customIconsOrder.removeAll(uuid);
     m_customIconsOrder.append(uuid);
@@ -406,7 +434,7 @@ void Metadata::removeCustomIcon(const QUuid& uuid)
         m_customIconsHashes.remove(hash);
     }
 
-    m_customIcons.remove(uuid);
+    m_customIconsSize -= m_customIcons.take(uuid).data.size();
     m_customIconsOrder.removeAll(uuid);
     Q_ASSERT(m_customIcons.count() == m_customIconsOrder.count());
     dynamic_cast<Database*>(parent())->addDeletedObject(uuid);
@@ -419,6 +447,32 @@ QUuid Metadata::findCustomIcon(const QByteArray& candidate)
     return m_customIconsHashes.value(hash, QUuid());
 }
 
+/**
+ * Find icons with the same data as an earlier icon. Only uses its arguments,
+ * so it may run on any thread.
+ *
+ * @param icons uuids and data of the icons in their order
+ * @return uuids of the duplicate icons mapped to the uuid of the first icon with the same data
+ */
+QHash<QUuid, QUuid> Metadata::findDuplicateIcons(const QList<QPair<QUuid, QByteArray>>& icons)
+{
+    QHash<QUuid, QUuid> duplicates;
+    QHash<QByteArray, QList<int>> iconsByHash;
+    for (int i = 0; i < icons.size(); ++i) {
+        const auto& icon = icons.at(i);
+        auto& candidates = iconsByHash[hashIcon(icon.second)];
+        auto original = std::find_if(candidates.constBegin(), candidates.constEnd(), [&](int candidate) {
+            return icons.at(candidate).second == icon.second;
+        });
+        if (original != candidates.constEnd()) {
+            duplicates.insert(icon.first, icons.at(*original).first);
+        } else {
+            candidates.append(i);
+        }
+    }
+    return duplicates;
+}
+
 void Metadata::copyCustomIcons(const QSet<QUuid>& iconList, const Metadata* otherMetadata)
 {
     for (const QUuid& uuid : iconList) {
@@ -504,6 +558,18 @@ void Metadata::setAutosaveDelayMin(int value)
     m_customData->set(customDataKeys::autosaveDelay, QString::number(value));
 }
 
+void Metadata::setCompressionLevel(int value)
+{
+    Q_ASSERT(value >= AutoCompressionLevel && value <= 9);
+    if (value == AutoCompressionLevel) {
+        if (m_customData->contains(customDataKeys::compressionLevel)) {
+            m_customData->remove(customDataKeys::compressionLevel);
+        }
+    } else {
+        m_customData->set(customDataKeys::compressionLevel, QString::number(value));
+    }
+}
+
 QDateTime Metadata::settingsChanged() const
 {
     return m_settingsChanged;
@@ -96,6 +96,7 @@ public:
     const CustomIconData& customIcon(const QUuid& uuid) const;
     bool hasCustomIcon(const QUuid& uuid) const;
     QList<QUuid> customIconsOrder() const;
+    qint64 customIconsSize() const;
     bool recycleBinEnabled() const;
     Group* recycleBin();
     const Group* recycleBin() const;
@@ -110,12 +111,14 @@ public:
     int historyMaxItems() const;
     int historyMaxSize() const;
     int autosaveDelayMin() const;
+    int compressionLevel() const;
     CustomData* customData();
     const CustomData* customData() const;
 
     static const int DefaultHistoryMaxItems;
     static const int DefaultHistoryMaxSize;
     static const int DefaultAutosaveDelayMin;
+    static const int AutoCompressionLevel;
 
     void setGenerator(const QString& value);
     void setName(const QString& value);
@@ -140,6 +143,7 @@ public:
     void removeCustomIcon(const QUuid& uuid);
     void copyCustomIcons(const QSet<QUuid>& iconList, const Metadata* otherMetadata);
     QUuid findCustomIcon(const QByteArray& candidate);
+    static QHash<QUuid, QUuid> findDuplicateIcons(const QList<QPair<QUuid, QByteArray>>& icons);
     void setRecycleBinEnabled(bool value);
     void setRecycleBin(Group* group);
     void setRecycleBinChanged(const QDateTime& value);
@@ -153,6 +157,7 @@ public:
     void setHistoryMaxItems(int value);
     void setHistoryMaxSize(int value);
     void setAutosaveDelayMin(int value);
+    void setCompressionLevel(int value);
     void setUpdateDatetime(bool value);
     void addSavedSearch(const QString& name, const QString& searchtext);
     void deleteSavedSearch(const QString& name);
@@ -171,13 +176,14 @@ private:
     template <class P, class V> bool set(P& property, const V& value);
     template <class P, class V> bool set(P& property, const V& value, QDateTime& dateTime);
 
-    QByteArray hashIcon(const QByteArray& iconData);
+    static QByteArray hashIcon(const QByteArray& iconData);
 
     MetadataData m_data;
 
     QList<QUuid> m_customIconsOrder;
     QHash<QUuid, CustomIconData> m_customIcons;
     QHash<QByteArray, QUuid> m_customIconsHashes;
+    qint64 m_customIconsSize = 0;
 
     QPointer<Group> m_recycleBin;
     QDateTime m_recycleBinChanged;
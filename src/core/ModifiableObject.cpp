@@ -49,6 +49,11 @@ bool ModifiableObject::modifiedSignalEnabled() const
     return true;
 }
 
+quint64 ModifiableObject::modificationCount() const
+{
+    return m_modificationCount;
+}
+
 void ModifiableObject::setEmitModified(bool value)
 {
     if (m_emitModified != value) {
@@ -59,6 +64,7 @@ void ModifiableObject::setEmitModified(bool value)
 
 void ModifiableObject::emitModified()
 {
+    ++m_modificationCount;
     if (modifiedSignalEnabled()) {
         emit modified();
     }
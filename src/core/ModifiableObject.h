@@ -34,6 +34,12 @@ public:
      */
     bool modifiedSignalEnabled() const;
 
+    /**
+     * @brief number of modifications of this object.
+     * Unlike the modified signal, modifications are counted when the signal is disabled as well.
+     */
+    quint64 modificationCount() const;
+
 public slots:
     /**
      * @brief set whether the modified signal should be emitted from this object and all its children.
@@ -54,6 +60,7 @@ signals:
 
 private:
     bool m_emitModified{true};
+    quint64 m_modificationCount{0};
 };
 
 #endif // KEEPASSXC_MODIFIABLEOBJECT_H
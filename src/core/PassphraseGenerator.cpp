@@ -17,7 +17,11 @@
 
 #include "PassphraseGenerator.h"
 
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 #include <QSet>
 #include <QTextStream>
 #include <cmath>
@@ -25,6 +29,70 @@
 #include "core/Resources.h"
 #include "crypto/Random.h"
 
+namespace
+{
+    const int MaxCachedWordLists = 8;
+
+    struct CachedWordList
+    {
+        QDateTime lastModified;
+        qint64 size;
+        QStringList words;
+    };
+
+    /**
+     * Parsed word lists shared by all generators, the GUI recreates and
+     * reconfigures its generator on every change of the settings.
+     */
+    struct WordListCache
+    {
+        QMutex mutex;
+        QHash<QString, CachedWordList> lists;
+    };
+
+    Q_GLOBAL_STATIC(WordListCache, wordListCache)
+
+    QStringList readWordList(const QString& path, bool* ok)
+    {
+        // Initially load wordlist into a set to avoid duplicates
+        QSet<QString> wordset;
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            *ok = false;
+            return {};
+        }
+
+        QTextStream in(&file);
+        QString line = in.readLine();
+        bool isSigned = line.startsWith("-----BEGIN PGP SIGNED MESSAGE-----");
+        if (isSigned) {
+            while (!line.isNull() && !line.trimmed().isEmpty()) {
+                line = in.readLine();
+            }
+        }
+        QRegExp rx("^[0-9]+(-[0-9]+)*\\s+([^\\s]+)$");
+        while (!line.isNull()) {
+            if (isSigned && line.startsWith("-----BEGIN PGP SIGNATURE-----")) {
+                break;
+            }
+            // Handle dash-escaped lines (if the wordlist is signed)
+            if (isSigned && line.startsWith("- ")) {
+                line.remove(0, 2);
+            }
+            line = line.trimmed();
+            line.replace(rx, "\\2");
+            if (!line.isEmpty()) {
+                wordset.insert(line);
+            }
+            line = in.readLine();
+        }
+
+        *ok = true;
+        return wordset.toList();
+    }
+} // namespace
+
 const int PassphraseGenerator::DefaultWordCount = 7;
 const char* PassphraseGenerator::DefaultSeparator = " ";
 const char* PassphraseGenerator::DefaultWordList = "eff_large.wordlist";
@@ -62,42 +130,37 @@ void PassphraseGenerator::setWordCase(PassphraseWordCase wordCase)
 void PassphraseGenerator::setWordList(const QString& path)
 {
     m_wordlist.clear();
-    // Initially load wordlist into a set to avoid duplicates
-    QSet<QString> wordset;
-
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning("Couldn't load passphrase wordlist: %s", qPrintable(path));
-        return;
-    }
 
-    QTextStream in(&file);
-    QString line = in.readLine();
-    bool isSigned = line.startsWith("-----BEGIN PGP SIGNED MESSAGE-----");
-    if (isSigned) {
-        while (!line.isNull() && !line.trimmed().isEmpty()) {
-            line = in.readLine();
+    const QFileInfo info(path);
+    const auto key = info.absoluteFilePath();
+    const auto lastModified = info.lastModified();
+    const auto size = info.size();
+    bool cached = false;
+    {
+        QMutexLocker locker(&wordListCache()->mutex);
+        auto it = wordListCache()->lists.constFind(key);
+        if (it != wordListCache()->lists.constEnd() && it->size == size && it->lastModified == lastModified) {
+            m_wordlist = it->words;
+            cached = true;
         }
     }
-    QRegExp rx("^[0-9]+(-[0-9]+)*\\s+([^\\s]+)$");
-    while (!line.isNull()) {
-        if (isSigned && line.startsWith("-----BEGIN PGP SIGNATURE-----")) {
-            break;
-        }
-        // Handle dash-escaped lines (if the wordlist is signed)
-        if (isSigned && line.startsWith("- ")) {
-            line.remove(0, 2);
+
+    if (!cached) {
+        bool ok = false;
+        m_wordlist = readWordList(path, &ok);
+        if (!ok) {
+            qWarning("Couldn't load passphrase wordlist: %s", qPrintable(path));
+            return;
         }
-        line = line.trimmed();
-        line.replace(rx, "\\2");
-        if (!line.isEmpty()) {
-            wordset.insert(line);
+
+        QMutexLocker locker(&wordListCache()->mutex);
+        auto& lists = wordListCache()->lists;
+        if (lists.size() >= MaxCachedWordLists && !lists.contains(key)) {
+            lists.clear();
         }
-        line = in.readLine();
+        lists.insert(key, {lastModified, size, m_wordlist});
     }
 
-    m_wordlist = wordset.toList();
-
     if (m_wordlist.size() < m_minimum_wordlist_length) {
         qWarning("Wordlist is less than minimum acceptable size: %s", qPrintable(path));
     }
@@ -115,33 +178,54 @@ void PassphraseGenerator::setWordSeparator(const QString& separator)
 }
 
 QString PassphraseGenerator::generatePassphrase() const
+{
+    const auto passphrases = generatePassphrases(1);
+    return passphrases.isEmpty() ? QString() : passphrases.first();
+}
+
+/**
+ * Generate several passphrases with the same settings, drawing the random
+ * word indices from the RNG in blocks.
+ *
+ * @param count number of passphrases to generate
+ * @return generated passphrases, empty if the generator is not valid
+ */
+QStringList PassphraseGenerator::generatePassphrases(int count) const
 {
     // In case there was an error loading the wordlist
     if (!isValid() || m_wordlist.empty()) {
         return {};
     }
 
-    QStringList words;
-    for (int i = 0; i < m_wordCount; ++i) {
-        int wordIndex = randomGen()->randomUInt(static_cast<quint32>(m_wordlist.size()));
-        auto tmpWord = m_wordlist.at(wordIndex);
-
-        // convert case
-        switch (m_wordCase) {
-        case UPPERCASE:
-            tmpWord = tmpWord.toUpper();
-            break;
-        case TITLECASE:
-            tmpWord = tmpWord.replace(0, 1, tmpWord.left(1).toUpper());
-            break;
-        case LOWERCASE:
-            tmpWord = tmpWord.toLower();
-            break;
+    const qint64 blockSize = qint64(count) * m_wordCount * 4;
+    RandomBuffer random(static_cast<int>(qBound<qint64>(64, blockSize, 64 * 1024)));
+
+    QStringList passphrases;
+    passphrases.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QStringList words;
+        for (int j = 0; j < m_wordCount; ++j) {
+            int wordIndex = random.randomUInt(static_cast<quint32>(m_wordlist.size()));
+            auto tmpWord = m_wordlist.at(wordIndex);
+
+            // convert case
+            switch (m_wordCase) {
+            case UPPERCASE:
+                tmpWord = tmpWord.toUpper();
+                break;
+            case TITLECASE:
+                tmpWord = tmpWord.replace(0, 1, tmpWord.left(1).toUpper());
+                break;
+            case LOWERCASE:
+                tmpWord = tmpWord.toLower();
+                break;
+            }
+            words.append(tmpWord);
         }
-        words.append(tmpWord);
+        passphrases.append(words.join(m_separator));
     }
 
-    return words.join(m_separator);
+    return passphrases;
 }
 
 bool PassphraseGenerator::isValid() const
@@ -19,6 +19,7 @@
 #define KEEPASSX_PASSPHRASEGENERATOR_H
 
 #include <QList>
+#include <QStringList>
 
 class PassphraseGenerator
 {
@@ -42,6 +43,7 @@ public:
     bool isValid() const;
 
     QString generatePassphrase() const;
+    QStringList generatePassphrases(int count) const;
 
     static const int DefaultWordCount;
     static const char* DefaultSeparator;
@@ -58,6 +58,21 @@ void PasswordGenerator::setFlags(const GeneratorFlags& flags)
 }
 
 QString PasswordGenerator::generatePassword() const
+{
+    return generatePasswords(1).first();
+}
+
+/**
+ * Generate several passwords with the same settings.
+ *
+ * The character groups are only built once and random numbers are drawn from
+ * the RNG in blocks, so generating many passwords at once is much faster than
+ * calling generatePassword() for each of them.
+ *
+ * @param count number of passwords to generate
+ * @return generated passwords
+ */
+QStringList PasswordGenerator::generatePasswords(int count) const
 {
     Q_ASSERT(isValid());
 
@@ -70,24 +85,41 @@ QString PasswordGenerator::generatePassword() const
         }
     }
 
+    // About two random numbers per character including the shuffle, a single password only uses a small block
+    const qint64 blockSize = qint64(count) * m_length * 8;
+    RandomBuffer random(static_cast<int>(qBound<qint64>(64, blockSize, 64 * 1024)));
+
+    QStringList passwords;
+    passwords.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        passwords.append(generatePassword(groups, passwordChars, random));
+    }
+    return passwords;
+}
+
+QString PasswordGenerator::generatePassword(const QVector<PasswordGroup>& groups,
+                                            const QVector<QChar>& passwordChars,
+                                            RandomBuffer& random) const
+{
     QString password;
+    password.reserve(m_length);
 
     if (m_flags & CharFromEveryGroup) {
         for (const auto& group : groups) {
-            int pos = randomGen()->randomUInt(static_cast<quint32>(group.size()));
+            int pos = random.randomUInt(static_cast<quint32>(group.size()));
 
             password.append(group[pos]);
         }
 
         for (int i = groups.size(); i < m_length; i++) {
-            int pos = randomGen()->randomUInt(static_cast<quint32>(passwordChars.size()));
+            int pos = random.randomUInt(static_cast<quint32>(passwordChars.size()));
 
             password.append(passwordChars[pos]);
         }
 
         // shuffle chars
         for (int i = (password.size() - 1); i >= 1; i--) {
-            int j = randomGen()->randomUInt(static_cast<quint32>(i + 1));
+            int j = random.randomUInt(static_cast<quint32>(i + 1));
 
             QChar tmp = password[i];
             password[i] = password[j];
@@ -95,7 +127,7 @@ QString PasswordGenerator::generatePassword() const
         }
     } else {
         for (int i = 0; i < m_length; i++) {
-            int pos = randomGen()->randomUInt(static_cast<quint32>(passwordChars.size()));
+            int pos = random.randomUInt(static_cast<quint32>(passwordChars.size()));
 
             password.append(passwordChars[pos]);
         }
@@ -20,10 +20,13 @@
 #define KEEPASSX_PASSWORDGENERATOR_H
 
 #include <QObject>
+#include <QStringList>
 #include <QVector>
 
 typedef QVector<QChar> PasswordGroup;
 
+class RandomBuffer;
+
 class PasswordGenerator
 {
 public:
@@ -75,12 +78,16 @@ public:
     const QString& getExcludedCharacterSet() const;
 
     QString generatePassword() const;
+    QStringList generatePasswords(int count) const;
 
     static const int DefaultLength;
     static const char* DefaultCustomCharacterSet;
     static const char* DefaultExcludedChars;
 
 private:
+    QString generatePassword(const QVector<PasswordGroup>& groups,
+                             const QVector<QChar>& passwordChars,
+                             RandomBuffer& random) const;
     QVector<PasswordGroup> passwordGroups() const;
     int numCharClasses() const;
 
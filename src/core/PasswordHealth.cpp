@@ -20,11 +20,14 @@
 #include "Clock.h"
 #include "Group.h"
 #include "PasswordHealth.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
 #include "zxcvbn.h"
 
 namespace
 {
-    const static int ZXCVBN_ESTIMATE_THRESHOLD = 256;
+    // The zxcvbn matcher is super-linear in the password length, it only sees this many characters
+    const static int ZXCVBN_ESTIMATE_THRESHOLD = 64;
 } // namespace
 
 PasswordHealth::PasswordHealth(double entropy)
@@ -33,6 +36,21 @@ PasswordHealth::PasswordHealth(double entropy)
 }
 
 PasswordHealth::PasswordHealth(const QString& pwd)
+{
+    init(estimateEntropy(pwd));
+}
+
+/**
+ * Estimate the entropy of a password with zxcvbn.
+ *
+ * Longer passwords are matched on a prefix window and the average entropy per
+ * character of the window is extrapolated to the full length, which bounds the
+ * cost of generated secrets and pasted keys.
+ *
+ * @param pwd password
+ * @return entropy in bits
+ */
+double PasswordHealth::estimateEntropy(const QString& pwd)
 {
     auto entropy = 0.0;
     entropy += ZxcvbnMatch(pwd.left(ZXCVBN_ESTIMATE_THRESHOLD).toUtf8(), nullptr, nullptr);
@@ -41,7 +59,7 @@ PasswordHealth::PasswordHealth(const QString& pwd)
         auto average = entropy / ZXCVBN_ESTIMATE_THRESHOLD;
         entropy += average * (pwd.length() - ZXCVBN_ESTIMATE_THRESHOLD);
     }
-    init(entropy);
+    return entropy;
 }
 
 void PasswordHealth::init(double entropy)
@@ -110,19 +128,116 @@ PasswordHealth::Quality PasswordHealth::quality() const
     return Quality::Excellent;
 }
 
+/**
+ * Get the entropy of a password, estimating it only on the first request.
+ *
+ * @param pwd password
+ * @return entropy in bits as returned by PasswordHealth::estimateEntropy()
+ */
+double PasswordEntropyCache::entropy(const QString& pwd)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_key.isEmpty()) {
+        m_key = randomGen()->randomArray(32);
+    }
+    const auto id = CryptoHash::hmac(pwd.toUtf8(), m_key, CryptoHash::Sha256);
+    auto it = m_entropies.constFind(id);
+    if (it != m_entropies.constEnd()) {
+        return it.value();
+    }
+    const auto generation = m_generation;
+    locker.unlock();
+
+    // Estimate without holding the lock, so passwords are scored in parallel
+    const auto entropy = PasswordHealth::estimateEntropy(pwd);
+    locker.relock();
+    if (generation == m_generation) {
+        m_entropies.insert(id, entropy);
+    }
+    return entropy;
+}
+
+/**
+ * Estimate the entropies of passwords that are not cached yet.
+ *
+ * Meant to be run in the background after a database was unlocked, so the
+ * first health report or weak password search finds the entropies cached.
+ * Stops early once the cache is cleared.
+ *
+ * @param passwords passwords to estimate
+ */
+void PasswordEntropyCache::prewarm(const QStringList& passwords)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_key.isEmpty()) {
+        m_key = randomGen()->randomArray(32);
+    }
+    const auto key = m_key;
+    const auto generation = m_generation;
+    locker.unlock();
+
+    for (const auto& pwd : passwords) {
+        const auto id = CryptoHash::hmac(pwd.toUtf8(), key, CryptoHash::Sha256);
+        locker.relock();
+        if (generation != m_generation) {
+            return;
+        }
+        const bool cached = m_entropies.contains(id);
+        locker.unlock();
+        if (cached) {
+            continue;
+        }
+
+        const auto entropy = PasswordHealth::estimateEntropy(pwd);
+        locker.relock();
+        if (generation != m_generation) {
+            return;
+        }
+        m_entropies.insert(id, entropy);
+        locker.unlock();
+    }
+}
+
+void PasswordEntropyCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entropies.clear();
+    m_key.clear();
+    ++m_generation;
+}
+
+/**
+ * @return estimated size of the cached HMACs and entropies
+ */
+qint64 PasswordEntropyCache::memoryUsage()
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 hmacSize = 24 + 32 + 1;
+    return m_entropies.size()
+           * (static_cast<qint64>(sizeof(QByteArray) + sizeof(double) + 3 * sizeof(void*)) + hmacSize);
+}
+
 /**
  * This class provides additional information about password health
  * than can be derived from the password itself (re-use, expiry).
+ *
+ * Password entropies are shared with the database's PasswordEntropyCache, so
+ * unchanged passwords are only scored once. Evaluating entries is thread safe
+ * as long as the database is not modified.
+ *
+ * @param db database to check
  */
 HealthChecker::HealthChecker(QSharedPointer<Database> db)
+    : m_cache(db->passwordEntropyCache())
 {
     // Build the cache of re-used passwords
-    for (const auto* entry : db->rootGroup()->entriesRecursive()) {
+    db->rootGroup()->forEachEntryRecursive([this](const Entry* entry) {
         if (!entry->isRecycled() && !entry->isAttributeReference("Password")) {
             m_reuse[entry->password()]
                 << QObject::tr("Used in %1/%2").arg(entry->group()->hierarchy().join('/'), entry->title());
         }
-    }
+        return true;
+    });
 }
 
 /**
@@ -140,7 +255,7 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
 
     // First analyse the password itself
     const auto pwd = entry->password();
-    auto health = QSharedPointer<PasswordHealth>(new PasswordHealth(pwd));
+    auto health = QSharedPointer<PasswordHealth>(new PasswordHealth(m_cache->entropy(pwd)));
 
     // Second, if the password is in the database more than once,
     // reduce the score accordingly
@@ -19,6 +19,7 @@
 #define KEEPASSX_PASSWORDHEALTH_H
 
 #include <QHash>
+#include <QMutex>
 #include <QSharedPointer>
 
 class Database;
@@ -37,6 +38,8 @@ public:
 
     void init(double entropy);
 
+    static double estimateEntropy(const QString& pwd);
+
     /*
      * The password score is defined to be the greater the better
      * (more secure) the password is. It doesn't have a dimension,
@@ -97,6 +100,28 @@ private:
     QStringList m_scoreDetails;
 };
 
+/**
+ * Thread safe cache of password entropies.
+ *
+ * Passwords are keyed by their HMAC under a random key of the cache, so the
+ * cache neither keeps copies of the passwords nor plain hashes of them.
+ */
+class PasswordEntropyCache
+{
+public:
+    double entropy(const QString& pwd);
+    void prewarm(const QStringList& passwords);
+    void clear();
+    qint64 memoryUsage();
+
+private:
+    QMutex m_mutex;
+    QByteArray m_key;
+    // Incremented by clear(), so estimates started before are not stored
+    quint64 m_generation = 0;
+    QHash<QByteArray, double> m_entropies;
+};
+
 /**
  * Password health check for all entries of a database.
  *
@@ -113,6 +138,7 @@ public:
 private:
     // To determine password re-use: first = password, second = entries that use it
     QHash<QString, QStringList> m_reuse;
+    PasswordEntropyCache* m_cache;
 };
 
 #endif // KEEPASSX_PASSWORDHEALTH_H
@@ -0,0 +1,170 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PerformanceStats.h"
+
+#include "core/Global.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace
+{
+    // Bucket i holds durations of less than 2^(i + 1) microseconds
+    const int BucketCount = 32;
+
+    struct Histogram
+    {
+        qint64 count = 0;
+        qint64 total = 0;
+        qint64 min = 0;
+        qint64 max = 0;
+        qint64 buckets[BucketCount] = {};
+    };
+
+    struct Stats
+    {
+        QMutex mutex;
+        // Keys point to the string literals of the operation names
+        QHash<QByteArray, Histogram> histograms;
+    };
+
+    std::atomic<bool> s_enabled{qEnvironmentVariable("KEEPASSXC_PERFORMANCE_STATS", "1") != "0"};
+
+    Stats& stats()
+    {
+        static Stats s_stats;
+        return s_stats;
+    }
+
+    int bucket(qint64 nsecs)
+    {
+        int index = 0;
+        for (qint64 usecs = nsecs / 2000; usecs > 0 && index < BucketCount - 1; usecs >>= 1) {
+            ++index;
+        }
+        return index;
+    }
+
+    /**
+     * @return upper bound of the duration below which the given fraction of the calls finished
+     */
+    qint64 percentile(const Histogram& histogram, double fraction)
+    {
+        const auto target = static_cast<qint64>(histogram.count * fraction + 0.5);
+        qint64 seen = 0;
+        for (int i = 0; i < BucketCount; ++i) {
+            seen += histogram.buckets[i];
+            if (seen >= qMax<qint64>(target, 1)) {
+                return qBound(histogram.min, (Q_INT64_C(2000) << i), histogram.max);
+            }
+        }
+        return histogram.max;
+    }
+
+    QString duration(qint64 nsecs)
+    {
+        if (nsecs >= Q_INT64_C(10000000000)) {
+            return QObject::tr("%1 s").arg(nsecs / 1e9, 0, 'f', 1);
+        }
+        return QObject::tr("%1 ms").arg(nsecs / 1e6, 0, 'f', 2);
+    }
+} // namespace
+
+namespace PerformanceStats
+{
+    bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool enabled)
+    {
+        s_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * Add the duration of a call to the histogram of its operation.
+     *
+     * @param operation name of the operation, must be a string literal
+     * @param nsecs duration of the call
+     */
+    void record(const char* operation, qint64 nsecs)
+    {
+        auto& s = stats();
+        QMutexLocker locker(&s.mutex);
+        auto& histogram = s.histograms[QByteArray::fromRawData(operation, qstrlen(operation))];
+        if (histogram.count == 0 || nsecs < histogram.min) {
+            histogram.min = nsecs;
+        }
+        histogram.max = qMax(histogram.max, nsecs);
+        histogram.total += nsecs;
+        ++histogram.count;
+        ++histogram.buckets[bucket(nsecs)];
+    }
+
+    void reset()
+    {
+        auto& s = stats();
+        QMutexLocker locker(&s.mutex);
+        s.histograms.clear();
+    }
+
+    /**
+     * @return one line per recorded operation with the number of calls and
+     *         their mean, median, 90th and 99th percentile and longest durations
+     */
+    QString report()
+    {
+        QHash<QByteArray, Histogram> histograms;
+        {
+            auto& s = stats();
+            QMutexLocker locker(&s.mutex);
+            histograms = s.histograms;
+        }
+
+        QString report = QObject::tr("Performance:").append("\n");
+        if (!isEnabled()) {
+            report.append(QObject::tr("- Recording is disabled")).append("\n");
+        } else if (histograms.isEmpty()) {
+            report.append(QObject::tr("- Nothing recorded yet")).append("\n");
+        }
+
+        auto operations = histograms.keys();
+        std::sort(operations.begin(), operations.end());
+        for (const auto& operation : asConst(operations)) {
+            const auto& histogram = histograms[operation];
+            report.append(QObject::tr("- %1: %n call(s), mean %2, median %3, p90 %4, p99 %5, max %6",
+                                      nullptr,
+                                      static_cast<int>(qMin<qint64>(histogram.count, std::numeric_limits<int>::max())))
+                              .arg(QString::fromLatin1(operation),
+                                   duration(histogram.total / histogram.count),
+                                   duration(percentile(histogram, 0.5)),
+                                   duration(percentile(histogram, 0.9)),
+                                   duration(percentile(histogram, 0.99)),
+                                   duration(histogram.max)))
+                .append("\n");
+        }
+        return report;
+    }
+} // namespace PerformanceStats
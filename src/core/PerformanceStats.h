@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_PERFORMANCESTATS_H
+#define KEEPASSXC_PERFORMANCESTATS_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+/**
+ * Timing histograms of the hot paths, for attaching real numbers to bug reports.
+ *
+ * Operations are timed with a ScopedTimer and collected per operation name in
+ * histograms with power of two buckets of microseconds. Recording is enabled in
+ * the application unless the KEEPASSXC_PERFORMANCE_STATS environment variable
+ * is set to 0, a disabled timer costs a single atomic load.
+ */
+namespace PerformanceStats
+{
+    bool isEnabled();
+    void setEnabled(bool enabled);
+    void record(const char* operation, qint64 nsecs);
+    void reset();
+    QString report();
+
+    class ScopedTimer
+    {
+    public:
+        /**
+         * @param operation name of the timed operation, must be a string literal
+         */
+        explicit ScopedTimer(const char* operation)
+            : m_operation(operation)
+        {
+            if (isEnabled()) {
+                m_timer.start();
+            }
+        }
+
+        ~ScopedTimer()
+        {
+            if (m_timer.isValid()) {
+                record(m_operation, m_timer.nsecsElapsed());
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(ScopedTimer)
+
+        const char* m_operation;
+        QElapsedTimer m_timer;
+    };
+} // namespace PerformanceStats
+
+#endif // KEEPASSXC_PERFORMANCESTATS_H
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StartupTrace.h"
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+namespace
+{
+    struct Trace
+    {
+        Trace()
+            : enabled(qEnvironmentVariableIsSet("KEEPASSXC_STARTUP_TRACE"))
+        {
+            timer.start();
+        }
+
+        const bool enabled;
+        QElapsedTimer timer;
+        qint64 last = 0;
+    };
+
+    Trace& trace()
+    {
+        // Started by the first mark, which is the beginning of main()
+        static Trace s_trace;
+        return s_trace;
+    }
+} // namespace
+
+namespace StartupTrace
+{
+    bool isEnabled()
+    {
+        return trace().enabled;
+    }
+
+    /**
+     * Record the end of a startup phase.
+     *
+     * @param phase name of the phase that just finished
+     */
+    void mark(const char* phase)
+    {
+        auto& t = trace();
+        if (!t.enabled) {
+            return;
+        }
+
+        qint64 elapsed = t.timer.elapsed();
+        qInfo("Startup: %-20s %6lld ms (+%lld ms)", phase, elapsed, elapsed - t.last);
+        t.last = elapsed;
+    }
+} // namespace StartupTrace
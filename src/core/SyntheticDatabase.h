@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_SYNTHETICDATABASE_H
+#define KEEPASSXC_SYNTHETICDATABASE_H
+
+#include <QList>
+#include <QString>
+#include <QUuid>
+
+#include <random>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Generator of large databases with realistic contents and no real secrets.
+ *
+ * All contents including UUIDs and timestamps are derived from the seed, the
+ * same options always give the same database. Used to reproduce performance
+ * problems and by the benchmarks.
+ */
+class SyntheticDatabase
+{
+public:
+    struct Options
+    {
+        int entries = 1000;
+        int groups = 10;
+        // Groups are spread over this many levels below the root group
+        int depth = 1;
+        int historyItems = 0;
+        // Percentages of the entries with an attachment, a reference, TOTP or a passkey
+        int attachmentPercent = 0;
+        int referencePercent = 0;
+        int totpPercent = 0;
+        int passkeyPercent = 0;
+        // Attachment sizes are spread logarithmically between 1 KiB and this size
+        int maxAttachmentSize = 64 * 1024;
+        int customIcons = 0;
+        quint32 seed = 0;
+    };
+
+    explicit SyntheticDatabase(const Options& options);
+
+    void populate(Database* db);
+
+    static QString password(int index);
+    static QString url(int index);
+
+private:
+    QUuid createUuid();
+    QByteArray randomBytes(int size);
+    bool chance(int percent);
+    QDateTime timestamp(int index) const;
+
+    void createGroups(Group* root);
+    void createIcons(Database* db);
+    Entry* createEntry(int index);
+    void addHistory(Entry* entry, int index);
+
+    Options m_options;
+    std::mt19937 m_random;
+    QList<Group*> m_groups;
+    QList<Entry*> m_entries;
+    QList<QUuid> m_icons;
+};
+
+#endif // KEEPASSXC_SYNTHETICDATABASE_H
@@ -17,11 +17,47 @@
 
 #include "TimeInfo.h"
 
+#include <limits>
+
+namespace
+{
+    // Stands for a null QDateTime
+    const qint64 InvalidTime = std::numeric_limits<qint64>::min();
+
+    qint64 toMSecs(const QDateTime& dateTime)
+    {
+        Q_ASSERT(dateTime.timeSpec() == Qt::UTC || !dateTime.isValid());
+        return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : InvalidTime;
+    }
+
+    QDateTime toDateTime(qint64 msecs)
+    {
+        return msecs == InvalidTime ? QDateTime() : QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC);
+    }
+
+    /**
+     * Compare two times the way compare() compares QDateTime values.
+     */
+    short compareTimes(qint64 lhs, qint64 rhs, CompareItemOptions options)
+    {
+        if (options.testFlag(CompareItemIgnoreMilliseconds)) {
+            // Same as Clock::serialized(), which drops the milliseconds of the time of day
+            if (lhs != InvalidTime) {
+                lhs -= (lhs % 1000 + 1000) % 1000;
+            }
+            if (rhs != InvalidTime) {
+                rhs -= (rhs % 1000 + 1000) % 1000;
+            }
+        }
+        return compareGeneric(lhs, rhs, options);
+    }
+} // namespace
+
 TimeInfo::TimeInfo()
-    : m_expires(false)
-    , m_usageCount(0)
+    : m_usageCount(0)
+    , m_expires(false)
 {
-    QDateTime now = Clock::currentDateTimeUtc();
+    const qint64 now = Clock::currentDateTimeUtc().toMSecsSinceEpoch();
     m_lastModificationTime = now;
     m_creationTime = now;
     m_lastAccessTime = now;
@@ -31,22 +67,22 @@ TimeInfo::TimeInfo()
 
 QDateTime TimeInfo::lastModificationTime() const
 {
-    return m_lastModificationTime;
+    return toDateTime(m_lastModificationTime);
 }
 
 QDateTime TimeInfo::creationTime() const
 {
-    return m_creationTime;
+    return toDateTime(m_creationTime);
 }
 
 QDateTime TimeInfo::lastAccessTime() const
 {
-    return m_lastAccessTime;
+    return toDateTime(m_lastAccessTime);
 }
 
 QDateTime TimeInfo::expiryTime() const
 {
-    return m_expiryTime;
+    return toDateTime(m_expiryTime);
 }
 
 bool TimeInfo::expires() const
@@ -61,31 +97,27 @@ int TimeInfo::usageCount() const
 
 QDateTime TimeInfo::locationChanged() const
 {
-    return m_locationChanged;
+    return toDateTime(m_locationChanged);
 }
 
 void TimeInfo::setLastModificationTime(const QDateTime& dateTime)
 {
-    Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_lastModificationTime = dateTime;
+    m_lastModificationTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setCreationTime(const QDateTime& dateTime)
 {
-    Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_creationTime = dateTime;
+    m_creationTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setLastAccessTime(const QDateTime& dateTime)
 {
-    Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_lastAccessTime = dateTime;
+    m_lastAccessTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setExpiryTime(const QDateTime& dateTime)
 {
-    Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_expiryTime = dateTime;
+    m_expiryTime = toMSecs(dateTime);
 }
 
 void TimeInfo::setExpires(bool expires)
@@ -100,8 +132,7 @@ void TimeInfo::setUsageCount(int count)
 
 void TimeInfo::setLocationChanged(const QDateTime& dateTime)
 {
-    Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
-    m_locationChanged = dateTime;
+    m_locationChanged = toMSecs(dateTime);
 }
 
 bool TimeInfo::operator==(const TimeInfo& other) const
@@ -116,25 +147,29 @@ bool TimeInfo::operator!=(const TimeInfo& other) const
 
 bool TimeInfo::equals(const TimeInfo& other, CompareItemOptions options) const
 {
-    // clang-format off
-    if (::compare(m_lastModificationTime, other.m_lastModificationTime, options) != 0) {
+    if (compareTimes(m_lastModificationTime, other.m_lastModificationTime, options) != 0) {
+        return false;
+    }
+    if (compareTimes(m_creationTime, other.m_creationTime, options) != 0) {
         return false;
     }
-    if (::compare(m_creationTime, other.m_creationTime, options) != 0) {
+    if (!options.testFlag(CompareItemIgnoreStatistics)
+        && compareTimes(m_lastAccessTime, other.m_lastAccessTime, options) != 0) {
         return false;
     }
-    if (::compare(!options.testFlag(CompareItemIgnoreStatistics), m_lastAccessTime, other.m_lastAccessTime, options) != 0) {
+    if (m_expires != other.m_expires) {
         return false;
     }
-    if (::compare(m_expires, m_expiryTime, other.m_expires, other.expiryTime(), options) != 0) {
+    if ((m_expires || !options.testFlag(CompareItemIgnoreDisabled))
+        && compareTimes(m_expiryTime, other.m_expiryTime, options) != 0) {
         return false;
     }
-    if (::compare(!options.testFlag(CompareItemIgnoreStatistics), m_usageCount, other.m_usageCount, options) != 0) {
+    if (!options.testFlag(CompareItemIgnoreStatistics) && m_usageCount != other.m_usageCount) {
         return false;
     }
-    if (::compare(!options.testFlag(CompareItemIgnoreLocation), m_locationChanged, other.m_locationChanged, options) != 0) {
+    if (!options.testFlag(CompareItemIgnoreLocation)
+        && compareTimes(m_locationChanged, other.m_locationChanged, options) != 0) {
         return false;
     }
     return true;
-    // clang-format on
 }
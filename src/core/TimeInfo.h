@@ -22,6 +22,13 @@
 
 #include "core/Compare.h"
 
+/**
+ * Timestamps and statistics of an entry or group.
+ *
+ * Times are kept as UTC milliseconds since the epoch and only converted to
+ * QDateTime by the accessors, so every entry, group and history item holds
+ * plain integers that are cheap to copy and compare.
+ */
 class TimeInfo
 {
 public:
@@ -48,13 +55,13 @@ public:
     void setLocationChanged(const QDateTime& dateTime);
 
 private:
-    QDateTime m_lastModificationTime;
-    QDateTime m_creationTime;
-    QDateTime m_lastAccessTime;
-    QDateTime m_expiryTime;
-    bool m_expires;
+    qint64 m_lastModificationTime;
+    qint64 m_creationTime;
+    qint64 m_lastAccessTime;
+    qint64 m_expiryTime;
+    qint64 m_locationChanged;
     int m_usageCount;
-    QDateTime m_locationChanged;
+    bool m_expires;
 };
 
 #endif // KEEPASSX_TIMEINFO_H
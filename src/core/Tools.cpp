@@ -29,8 +29,10 @@
 #include "core/Clock.h"
 
 #include <QCoreApplication>
+#include <QDir>
 #include <QElapsedTimer>
 #include <QEventLoop>
+#include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
 #include <QLocale>
@@ -39,12 +41,20 @@
 #include <QStringList>
 #include <QUrl>
 #include <QUuid>
+#include <cerrno>
 #include <cmath>
 
 #ifdef Q_OS_WIN
 #include <windows.h> // for Sleep()
 #endif
 
+#if defined(Q_OS_UNIX)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
 namespace Tools
 {
     QString debugInfo()
@@ -219,12 +229,25 @@ namespace Tools
 
     bool isBase64(const QByteArray& ba)
     {
-        constexpr auto pattern = R"(^(?:[a-z0-9+/]{4})*(?:[a-z0-9+/]{3}=|[a-z0-9+/]{2}==)?$)";
-        QRegExp regexp(pattern, Qt::CaseInsensitive, QRegExp::RegExp2);
-
-        QString base64 = QString::fromLatin1(ba.constData(), ba.size());
-
-        return regexp.exactMatch(base64);
+        // Same as matching ^(?:[a-z0-9+/]{4})*(?:[a-z0-9+/]{3}=|[a-z0-9+/]{2}==)?$ case insensitively,
+        // without compiling an expression for every timestamp of a database
+        if (ba.size() % 4 != 0) {
+            return false;
+        }
+        int length = ba.size();
+        if (ba.endsWith("==")) {
+            length -= 2;
+        } else if (ba.endsWith('=')) {
+            length -= 1;
+        }
+        for (int i = 0; i < length; ++i) {
+            const char c = ba.at(i);
+            if (!(c >= 'a' && c <= 'z') && !(c >= 'A' && c <= 'Z') && !(c >= '0' && c <= '9') && c != '+'
+                && c != '/') {
+                return false;
+            }
+        }
+        return true;
     }
 
     bool isAsciiString(const QString& str)
@@ -388,6 +411,69 @@ namespace Tools
         return true;
     }
 
+    /**
+     * Check that the peer of a local socket runs as the current user, the
+     * permissions of the socket file are not enforced on every platform.
+     *
+     * @param socketDescriptor native descriptor of a connected local socket
+     * @return true if the peer runs as the current user
+     */
+    bool isSocketPeerSameUser(qintptr socketDescriptor)
+    {
+#if defined(Q_OS_LINUX)
+        struct ucred credentials;
+        socklen_t length = sizeof(credentials);
+        if (getsockopt(static_cast<int>(socketDescriptor), SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) {
+            return false;
+        }
+        return credentials.uid == getuid();
+#elif defined(Q_OS_UNIX)
+        uid_t uid;
+        gid_t gid;
+        if (getpeereid(static_cast<int>(socketDescriptor), &uid, &gid) != 0) {
+            return false;
+        }
+        return uid == getuid();
+#else
+        // The pipe is only accessible to the current user
+        Q_UNUSED(socketDescriptor)
+        return true;
+#endif
+    }
+
+    /**
+     * Remove a socket file left behind at the path a local server is about to listen on.
+     *
+     * Unlike QLocalServer::removeServer(), nothing is removed unless it is a socket
+     * owned by the current user. Names without a path are resolved like QLocalServer does.
+     *
+     * @param socketPath path or name the server listens on
+     * @return true if there is nothing in the way of listening, or only such a socket was
+     */
+    bool removeStaleSocket(const QString& socketPath)
+    {
+#if defined(Q_OS_UNIX)
+        auto path = socketPath;
+        if (!path.startsWith('/')) {
+            path = QDir::tempPath() + '/' + path;
+        }
+        const auto encodedPath = QFile::encodeName(path);
+
+        struct stat status;
+        if (lstat(encodedPath.constData(), &status) != 0) {
+            return errno == ENOENT;
+        }
+        if (!S_ISSOCK(status.st_mode) || status.st_uid != getuid()) {
+            return false;
+        }
+        return unlink(encodedPath.constData()) == 0;
+#else
+        // Named pipes vanish with the process that created them
+        Q_UNUSED(socketPath)
+        return true;
+#endif
+    }
+
     QString envSubstitute(const QString& filepath, QProcessEnvironment environment)
     {
         QString subbed = filepath;
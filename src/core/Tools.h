@@ -47,6 +47,8 @@ namespace Tools
     QString envSubstitute(const QString& filepath,
                           QProcessEnvironment environment = QProcessEnvironment::systemEnvironment());
     QString cleanFilename(QString filename);
+    bool isSocketPeerSameUser(qintptr socketDescriptor);
+    bool removeStaleSocket(const QString& socketPath);
 
     template <class T> QSet<T> asSet(const QList<T>& a)
     {
@@ -25,12 +25,83 @@
 #include <QRegularExpression>
 #include <QTranslator>
 
+#include <mutex>
+
 #include "core/Resources.h"
 
+namespace
+{
+    /**
+     * Translator that searches and loads its catalog on the first lookup.
+     *
+     * Short lived processes such as CLI commands often never translate a
+     * string, so the catalog search over all preferred languages is deferred
+     * until it is needed. QTranslator maps the catalog file instead of reading it.
+     */
+    class LazyTranslator : public QTranslator
+    {
+    public:
+        LazyTranslator(const QStringList& languages, const QString& prefix, const QString& path, QObject* parent)
+            : QTranslator(parent)
+            , m_languages(languages)
+            , m_prefix(prefix)
+            , m_path(path)
+        {
+        }
+
+        QString translate(const char* context,
+                          const char* sourceText,
+                          const char* disambiguation = nullptr,
+                          int n = -1) const override
+        {
+            // Strings may be translated from worker threads
+            std::call_once(m_loadOnce, [this] { load(); });
+            return m_translator.translate(context, sourceText, disambiguation, n);
+        }
+
+        bool isEmpty() const override
+        {
+            // Not known before the first lookup, installing the translator must not load it
+            return false;
+        }
+
+    private:
+        /**
+         * Load the catalog from the local search path or the default system path
+         * if it was not found at the local path.
+         */
+        void load() const
+        {
+            const auto systemPath = QLibraryInfo::location(QLibraryInfo::TranslationsPath);
+            for (const auto& language : m_languages) {
+                QLocale locale(language);
+                if (m_translator.load(locale, m_prefix, "", m_path)
+                    || m_translator.load(locale, m_prefix, "", systemPath)) {
+                    return;
+                }
+            }
+            if (m_prefix == "keepassxc_") {
+                // couldn't load configured language or fallback
+                qWarning("Couldn't load translations.");
+            }
+        }
+
+        const QStringList m_languages;
+        const QString m_prefix;
+        const QString m_path;
+        mutable QTranslator m_translator;
+        mutable std::once_flag m_loadOnce;
+    };
+} // namespace
+
 /**
- * Install all KeePassXC and Qt translators.
+ * Install all KeePassXC and Qt translators, their catalogs are loaded on first use.
+ *
+ * @param uiLanguage language code or "system" for the languages of the system locale
+ * @param installQtTranslator whether to install the Qt base translator, the CLI
+ *                            does not show any of the widgets it translates
  */
-void Translator::installTranslators(const QString& uiLanguage)
+void Translator::installTranslators(const QString& uiLanguage, bool installQtTranslator)
 {
     QStringList languages;
     if (uiLanguage.isEmpty() || uiLanguage == "system") {
@@ -47,55 +118,11 @@ void Translator::installTranslators(const QString& uiLanguage)
     languages << "en_US";
 
     const auto path = resources()->dataPath("translations");
-    installQtTranslator(languages, path);
-    if (!installTranslator(languages, path)) {
-        // couldn't load configured language or fallback
-        qWarning("Couldn't load translations.");
-    }
-}
-
-/**
- * Install KeePassXC translator.
- *
- * @param languages priority-ordered list of languages
- * @param path absolute search path
- * @return true on success
- */
-bool Translator::installTranslator(const QStringList& languages, const QString& path)
-{
-    for (const auto& language : languages) {
-        QLocale locale(language);
-        QScopedPointer<QTranslator> translator(new QTranslator(qApp));
-        if (translator->load(locale, "keepassxc_", "", path)) {
-            return QCoreApplication::installTranslator(translator.take());
-        } else if (translator->load(locale, "keepassxc_", "", QLibraryInfo::location(QLibraryInfo::TranslationsPath))) {
-            return QCoreApplication::installTranslator(translator.take());
-        }
-    }
-
-    return false;
-}
-
-/**
- * Install Qt5 base translator from the specified local search path or the default system path
- * if no qtbase_* translations were found at the local path.
- *
- * @param languages priority-ordered list of languages
- * @param path absolute search path
- * @return true on success
- */
-bool Translator::installQtTranslator(const QStringList& languages, const QString& path)
-{
-    for (const auto& language : languages) {
-        QLocale locale(language);
-        QScopedPointer<QTranslator> qtTranslator(new QTranslator(qApp));
-        if (qtTranslator->load(locale, "qtbase_", "", path)) {
-            return QCoreApplication::installTranslator(qtTranslator.take());
-        } else if (qtTranslator->load(locale, "qtbase_", "", QLibraryInfo::location(QLibraryInfo::TranslationsPath))) {
-            return QCoreApplication::installTranslator(qtTranslator.take());
-        }
+    // Translators installed last are asked first
+    if (installQtTranslator) {
+        QCoreApplication::installTranslator(new LazyTranslator(languages, "qtbase_", path, qApp));
     }
-    return false;
+    QCoreApplication::installTranslator(new LazyTranslator(languages, "keepassxc_", path, qApp));
 }
 
 /**
@@ -24,12 +24,8 @@
 class Translator
 {
 public:
-    static void installTranslators(const QString& uiLanguage = "system");
+    static void installTranslators(const QString& uiLanguage = "system", bool installQtTranslator = true);
     static QList<QPair<QString, QString>> availableLanguages();
-
-private:
-    static bool installTranslator(const QStringList& languages, const QString& path);
-    static bool installQtTranslator(const QStringList& languages, const QString& path);
 };
 
 #endif // KEEPASSX_TRANSLATOR_H
@@ -271,6 +271,9 @@ namespace Crypto
                              .arg(Botan::version_major())
                              .arg(Botan::version_minor())
                              .arg(Botan::version_patch()));
+        debugInfo.append(QString("- SHA-256 %1, SHA-512 %2\n")
+                             .arg(CryptoHash::implementation(CryptoHash::Sha256),
+                                  CryptoHash::implementation(CryptoHash::Sha512)));
         return debugInfo;
     }
 } // namespace Crypto
@@ -18,11 +18,26 @@
 
 #include "CryptoHash.h"
 
+#include <QIODevice>
 #include <QScopedPointer>
+#include <QtConcurrent>
 
 #include <botan/hash.h>
 #include <botan/mac.h>
 
+namespace
+{
+    // Large reads keep the accelerated compression function busy instead of the read calls
+    const qint64 DeviceChunkSize = 1024 * 1024;
+    // Independent inputs below this total size are hashed in turn on the calling thread
+    const qint64 ParallelHashSize = 4 * 1024 * 1024;
+
+    const char* algorithmName(CryptoHash::Algorithm algo)
+    {
+        return algo == CryptoHash::Sha512 ? "SHA-512" : "SHA-256";
+    }
+} // namespace
+
 class CryptoHashPrivate
 {
 public:
@@ -82,6 +97,28 @@ void CryptoHash::addData(const QByteArray& data)
     }
 }
 
+/**
+ * Add the remaining data of a device to the hash.
+ *
+ * @param device readable device
+ * @return true if the device was read to its end
+ */
+bool CryptoHash::addData(QIODevice* device)
+{
+    QByteArray buffer;
+    buffer.resize(DeviceChunkSize);
+    while (true) {
+        qint64 bytesRead = device->read(buffer.data(), buffer.size());
+        if (bytesRead < 0) {
+            return false;
+        }
+        if (bytesRead == 0) {
+            return device->atEnd();
+        }
+        addData(QByteArray::fromRawData(buffer.constData(), static_cast<int>(bytesRead)));
+    }
+}
+
 void CryptoHash::setKey(const QByteArray& data)
 {
     Q_D(CryptoHash);
@@ -123,3 +160,50 @@ QByteArray CryptoHash::hmac(const QByteArray& data, const QByteArray& key, Algor
     cryptoHash.addData(data);
     return cryptoHash.result();
 }
+
+/**
+ * Hash many independent inputs at once.
+ *
+ * Large batches are spread over the global thread pool, small ones share a
+ * single hash function since result() resets it for the next input.
+ *
+ * @param inputs data to hash
+ * @param algo hash algorithm
+ * @return hash of every input, in the order of the inputs
+ */
+QVector<QByteArray> CryptoHash::hashAll(const QVector<QByteArray>& inputs, Algorithm algo)
+{
+    qint64 totalSize = 0;
+    for (const auto& input : inputs) {
+        totalSize += input.size();
+    }
+
+    if (inputs.size() < 2 || totalSize < ParallelHashSize) {
+        QVector<QByteArray> results;
+        results.reserve(inputs.size());
+        CryptoHash cryptoHash(algo);
+        for (const auto& input : inputs) {
+            cryptoHash.addData(input);
+            results.append(cryptoHash.result());
+        }
+        return results;
+    }
+
+    std::function<QByteArray(const QByteArray&)> hashInput = [algo](const QByteArray& input) {
+        return hash(input, algo);
+    };
+    return QtConcurrent::blockingMapped<QVector<QByteArray>>(inputs, hashInput);
+}
+
+/**
+ * Get the implementation Botan selected for the CPU, e.g. SHA-NI or the ARMv8
+ * cryptography extensions instead of the portable code.
+ *
+ * @param algo hash algorithm
+ * @return name of the implementation
+ */
+QString CryptoHash::implementation(Algorithm algo)
+{
+    auto hashFunction = Botan::HashFunction::create(algorithmName(algo));
+    return hashFunction ? QString::fromStdString(hashFunction->provider()) : QString();
+}
@@ -20,8 +20,10 @@
 #define KEEPASSX_CRYPTOHASH_H
 
 #include <QByteArray>
+#include <QVector>
 
 class CryptoHashPrivate;
+class QIODevice;
 
 class CryptoHash
 {
@@ -35,11 +37,14 @@ public:
     explicit CryptoHash(Algorithm algo, bool hmac = false);
     ~CryptoHash();
     void addData(const QByteArray& data);
+    bool addData(QIODevice* device);
     QByteArray result() const;
     void setKey(const QByteArray& data);
 
     static QByteArray hash(const QByteArray& data, Algorithm algo);
     static QByteArray hmac(const QByteArray& data, const QByteArray& key, Algorithm algo);
+    static QVector<QByteArray> hashAll(const QVector<QByteArray>& inputs, Algorithm algo);
+    static QString implementation(Algorithm algo);
 
 private:
     CryptoHashPrivate* const d_ptr;
@@ -21,8 +21,16 @@
 
 #include <QSharedPointer>
 
+#include <cstring>
+
+#include <botan/mem_ops.h>
 #include <botan/system_rng.h>
 
+namespace
+{
+    const int ThreadBufferSize = 4096;
+} // namespace
+
 QSharedPointer<Random> Random::m_instance;
 
 QSharedPointer<Random> Random::instance()
@@ -62,6 +70,33 @@ QByteArray Random::randomArray(int len)
 quint32 Random::randomUInt(quint32 limit)
 {
     Q_ASSERT(limit <= QUINT32_MAX);
+
+    // Small draws are served from a block of RNG output per thread, so threads never share unused bytes
+    thread_local RandomBuffer buffer(ThreadBufferSize);
+    return buffer.randomUInt(limit);
+}
+
+quint32 Random::randomUIntRange(quint32 min, quint32 max)
+{
+    return min + randomUInt(max - min);
+}
+
+/**
+ * @param blockSize number of random bytes drawn from the RNG at once
+ */
+RandomBuffer::RandomBuffer(int blockSize)
+    : m_block(qMax(blockSize, 4), '\0')
+    , m_pos(m_block.size())
+{
+}
+
+RandomBuffer::~RandomBuffer()
+{
+    Botan::secure_scrub_memory(m_block.data(), static_cast<size_t>(m_block.size()));
+}
+
+quint32 RandomBuffer::randomUInt(quint32 limit)
+{
     if (limit == 0) {
         return 0;
     }
@@ -71,13 +106,16 @@ quint32 Random::randomUInt(quint32 limit)
 
     // To avoid modulo bias make sure rand is below the largest number where rand%limit==0
     do {
-        m_rng->randomize(reinterpret_cast<uint8_t*>(&rand), 4);
+        if (m_pos + 4 > m_block.size()) {
+            randomGen()->randomize(m_block);
+            m_pos = 0;
+        }
+        // Wipe the bytes handed out, the block never holds values that were already used
+        auto data = m_block.data() + m_pos;
+        memcpy(&rand, data, 4);
+        Botan::secure_scrub_memory(data, 4);
+        m_pos += 4;
     } while (rand > ceil);
 
     return (rand % limit);
 }
-
-quint32 Random::randomUIntRange(quint32 min, quint32 max)
-{
-    return min + randomUInt(max - min);
-}
@@ -32,6 +32,9 @@ public:
 
     /**
      * Generate a random quint32 in the range [0, @p limit)
+     *
+     * Drawn from a buffer of RNG output of the calling thread, which is
+     * scrubbed when the thread exits.
      */
     quint32 randomUInt(quint32 limit);
 
@@ -50,6 +53,32 @@ private:
     QSharedPointer<Botan::RandomNumberGenerator> m_rng;
 };
 
+/**
+ * Random numbers drawn from the RNG in blocks.
+ *
+ * Used to generate many random numbers at once, e.g. for bulk password
+ * generation, without calling into the RNG for each of them. Bytes are wiped
+ * as soon as they are used and the rest of the block is scrubbed when the
+ * buffer is destroyed. A buffer must only be used by a single thread.
+ */
+class RandomBuffer
+{
+public:
+    explicit RandomBuffer(int blockSize);
+    ~RandomBuffer();
+
+    /**
+     * Generate a random quint32 in the range [0, @p limit)
+     */
+    quint32 randomUInt(quint32 limit);
+
+private:
+    Q_DISABLE_COPY(RandomBuffer);
+
+    QByteArray m_block;
+    int m_pos;
+};
+
 static inline QSharedPointer<Random> randomGen()
 {
     return Random::instance();
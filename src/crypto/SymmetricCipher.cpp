@@ -20,9 +20,34 @@
 #include "config-keepassx.h"
 #include "format/KeePass2.h"
 
+#include <QtConcurrent>
+
 #include <botan/block_cipher.h>
 #include <botan/cipher_mode.h>
 
+namespace
+{
+    // Fewer rounds are done faster than a thread is started
+    constexpr int MinParallelRounds = 10000;
+
+    bool aesKdfRounds(const QByteArray& key, int rounds, Botan::secure_vector<uint8_t>& blocks)
+    {
+        try {
+            std::unique_ptr<Botan::BlockCipher> cipher(Botan::BlockCipher::create("AES-256"));
+            cipher->set_key(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+
+            const size_t count = blocks.size() / cipher->block_size();
+            for (int i = 0; i < rounds; ++i) {
+                cipher->encrypt_n(blocks.data(), blocks.data(), count);
+            }
+            return true;
+        } catch (std::exception& e) {
+            qWarning("SymmetricCipher::aesKdf: Could not process: %s", e.what());
+            return false;
+        }
+    }
+} // namespace
+
 bool SymmetricCipher::init(Mode mode, Direction direction, const QByteArray& key, const QByteArray& iv)
 {
     m_mode = mode;
@@ -63,6 +88,29 @@ bool SymmetricCipher::init(Mode mode, Direction direction, const QByteArray& key
     return true;
 }
 
+/**
+ * Start a new message with the same key, without repeating the key schedule.
+ *
+ * @param iv initialization vector of the new message
+ * @return false if the cipher is not initialized or the IV is invalid
+ */
+bool SymmetricCipher::restart(const QByteArray& iv)
+{
+    Q_ASSERT(isInitialized());
+    if (!isInitialized()) {
+        m_error = QObject::tr("Cipher not initialized prior to use.");
+        return false;
+    }
+
+    try {
+        m_cipher->start(reinterpret_cast<const uint8_t*>(iv.data()), iv.size());
+        return true;
+    } catch (std::exception& e) {
+        m_error = e.what();
+        return false;
+    }
+}
+
 bool SymmetricCipher::isInitialized() const
 {
     return m_cipher;
@@ -131,22 +179,40 @@ SymmetricCipher::Mode SymmetricCipher::mode()
     return m_mode;
 }
 
+/**
+ * Encrypt data with AES-256 in ECB mode for a number of rounds.
+ *
+ * The rounds of a block only depend on that block, so the two halves of
+ * a key are transformed on two threads.
+ *
+ * @param key AES-256 key
+ * @param rounds number of rounds
+ * @param data data to transform in place, a multiple of the block size
+ * @return true on success
+ */
 bool SymmetricCipher::aesKdf(const QByteArray& key, int rounds, QByteArray& data)
 {
-    try {
-        std::unique_ptr<Botan::BlockCipher> cipher(Botan::BlockCipher::create("AES-256"));
-        cipher->set_key(reinterpret_cast<const uint8_t*>(key.data()), key.size());
-
+    const int half = data.size() / 2;
+    if (half != 16 || rounds < MinParallelRounds || QThreadPool::globalInstance()->maxThreadCount() < 2) {
         Botan::secure_vector<uint8_t> out(data.begin(), data.end());
-        for (int i = 0; i < rounds; ++i) {
-            cipher->encrypt(out);
+        if (!aesKdfRounds(key, rounds, out)) {
+            return false;
         }
         std::copy(out.begin(), out.end(), data.begin());
         return true;
-    } catch (std::exception& e) {
-        qWarning("SymmetricCipher::aesKdf: Could not process: %s", e.what());
+    }
+
+    Botan::secure_vector<uint8_t> first(data.begin(), data.begin() + half);
+    Botan::secure_vector<uint8_t> second(data.begin() + half, data.end());
+    // The waiting thread runs the second half itself if the pool is busy
+    auto future = QtConcurrent::run([&] { return aesKdfRounds(key, rounds, second); });
+    const bool firstOk = aesKdfRounds(key, rounds, first);
+    if (!future.result() || !firstOk) {
         return false;
     }
+    std::copy(first.begin(), first.end(), data.begin());
+    std::copy(second.begin(), second.end(), data.begin() + half);
+    return true;
 }
 
 QString SymmetricCipher::errorString() const
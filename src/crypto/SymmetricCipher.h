@@ -54,6 +54,7 @@ public:
 
     bool isInitialized() const;
     Q_REQUIRED_RESULT bool init(Mode mode, Direction direction, const QByteArray& key, const QByteArray& iv);
+    Q_REQUIRED_RESULT bool restart(const QByteArray& iv);
     Q_REQUIRED_RESULT bool process(char* data, int len);
     Q_REQUIRED_RESULT bool process(QByteArray& data);
     Q_REQUIRED_RESULT bool finish(QByteArray& data);
@@ -84,22 +84,22 @@ QSharedPointer<Kdf> AesKdf::clone() const
 
 int AesKdf::benchmark(int msec) const
 {
-    QByteArray key(16, '\x7E');
-    QByteArray seed(32, '\x4B');
-
-    int trials = 3;
-    int rounds = 1000000;
-
-    QElapsedTimer timer;
-    timer.start();
-    for (int i = 0; i < trials; ++i) {
-        QByteArray result;
-        if (!transformKeyRaw(key, seed, rounds, &result)) {
-            return rounds;
-        }
+    // Composite keys are 32 bytes, both halves are transformed like on unlock
+    const QByteArray key(32, '\x7E');
+    const QByteArray seed(32, '\x4B');
+
+    const int rounds = 1000000;
+
+    const qint64 runTime = benchmarkRunTime(
+        [&] {
+            QByteArray result;
+            return transformKeyRaw(key, seed, rounds, &result);
+        },
+        msec);
+    if (runTime < 0) {
+        return rounds;
     }
-
-    return static_cast<int>(rounds * trials * static_cast<float>(msec) / timer.elapsed());
+    return scaleRounds(rounds, runTime, msec);
 }
 
 QString AesKdf::toString() const
@@ -17,13 +17,79 @@
 
 #include "Argon2Kdf.h"
 
-#include <QElapsedTimer>
 #include <QThread>
 
 #include <argon2.h>
 
 #include "format/KeePass2.h"
 
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef Q_OS_LINUX
+    // Transparent huge pages are only used for memory on 2 MiB boundaries
+    constexpr size_t HugePageSize = 2 * 1024 * 1024;
+
+    bool useMappedMemory()
+    {
+        // Falls back to the allocator of the Argon2 library, e.g. to compare unlock times
+        static const bool mapped = !qEnvironmentVariableIsSet("KEEPASSXC_ARGON2_HEAP");
+        return mapped;
+    }
+
+    /**
+     * Map the Argon2 memory on huge page boundaries and fault it in up front.
+     *
+     * Huge pages are requested before the memory is touched, so the memory is
+     * populated by mlock() or MADV_POPULATE_WRITE instead of MAP_POPULATE. The
+     * library scrubs the memory before it is released.
+     */
+    int allocateMemory(uint8_t** memory, size_t size)
+    {
+        const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t mappedSize = size + HugePageSize;
+        void* mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            *memory = nullptr;
+            return ARGON2_MEMORY_ALLOCATION_ERROR;
+        }
+
+        // Release what lies outside of the aligned range
+        const auto start = reinterpret_cast<uintptr_t>(mapped);
+        const auto aligned = (start + HugePageSize - 1) & ~(HugePageSize - 1);
+        const auto end = (aligned + size + pageSize - 1) & ~(pageSize - 1);
+        if (aligned > start) {
+            munmap(mapped, aligned - start);
+        }
+        if (start + mappedSize > end) {
+            munmap(reinterpret_cast<void*>(end), start + mappedSize - end);
+        }
+
+        auto* data = reinterpret_cast<void*>(aligned);
+        madvise(data, size, MADV_HUGEPAGE);
+        madvise(data, size, MADV_DONTDUMP);
+        // Locking fails for memory above RLIMIT_MEMLOCK, the pages are faulted in anyway
+        if (mlock(data, size) != 0) {
+#ifdef MADV_POPULATE_WRITE
+            madvise(data, size, MADV_POPULATE_WRITE);
+#endif
+        }
+
+        *memory = reinterpret_cast<uint8_t*>(data);
+        return ARGON2_OK;
+    }
+
+    void freeMemory(uint8_t* memory, size_t size)
+    {
+        munmap(memory, size);
+    }
+#endif
+} // namespace
+
 /**
  * KeePass' Argon2 implementation supports all parameters that are defined in the official specification,
  * but only the number of iterations, the memory size and the degree of parallelism can be configured by
@@ -165,21 +231,29 @@ bool Argon2Kdf::transform(const QByteArray& raw, QByteArray& result) const
 {
     result.clear();
     result.resize(32);
-    // Time Cost, Mem Cost, Threads/Lanes, Password, length, Salt, length, out, length
-
-    int rc = argon2_hash(rounds(),
-                         memory(),
-                         parallelism(),
-                         raw.data(),
-                         raw.size(),
-                         seed().data(),
-                         seed().size(),
-                         result.data(),
-                         result.size(),
-                         nullptr,
-                         0,
-                         type() == Type::Argon2d ? Argon2_d : Argon2_id,
-                         version());
+    const QByteArray salt = seed();
+
+    argon2_context context{};
+    context.out = reinterpret_cast<uint8_t*>(result.data());
+    context.outlen = static_cast<uint32_t>(result.size());
+    context.pwd = reinterpret_cast<uint8_t*>(const_cast<char*>(raw.data()));
+    context.pwdlen = static_cast<uint32_t>(raw.size());
+    context.salt = reinterpret_cast<uint8_t*>(const_cast<char*>(salt.data()));
+    context.saltlen = static_cast<uint32_t>(salt.size());
+    context.t_cost = static_cast<uint32_t>(rounds());
+    context.m_cost = static_cast<uint32_t>(memory());
+    context.lanes = parallelism();
+    context.threads = parallelism();
+    context.version = version();
+    context.flags = ARGON2_DEFAULT_FLAGS;
+#ifdef Q_OS_LINUX
+    if (useMappedMemory()) {
+        context.allocate_cbk = allocateMemory;
+        context.free_cbk = freeMemory;
+    }
+#endif
+
+    int rc = argon2_ctx(&context, type() == Type::Argon2d ? Argon2_d : Argon2_id);
     if (rc != ARGON2_OK) {
         qWarning("Argon2 error: %s", argon2_error_message(rc));
         return false;
@@ -193,18 +267,27 @@ QSharedPointer<Kdf> Argon2Kdf::clone() const
     return QSharedPointer<Argon2Kdf>::create(*this);
 }
 
+/**
+ * Time a transform with the same memory placement as an unlock, page faults of
+ * the Argon2 memory are part of the measured time.
+ *
+ * @param msec target transform time
+ * @return rounds that take about the target time
+ */
 int Argon2Kdf::benchmark(int msec) const
 {
-    QByteArray key = QByteArray(16, '\x7E');
-
-    QElapsedTimer timer;
-    timer.start();
-
-    if (transform(key, key)) {
-        return static_cast<int>(rounds() * (static_cast<float>(msec) / timer.elapsed()));
+    const QByteArray key = QByteArray(16, '\x7E');
+
+    const qint64 runTime = benchmarkRunTime(
+        [&] {
+            QByteArray result;
+            return transform(key, result);
+        },
+        msec);
+    if (runTime < 0) {
+        return 1;
     }
-
-    return 1;
+    return scaleRounds(rounds(), runTime, msec);
 }
 
 QString Argon2Kdf::toString() const
@@ -19,6 +19,17 @@
 
 #include "crypto/Random.h"
 
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <algorithm>
+
+namespace
+{
+    // Single runs are easily skewed by other load and frequency scaling
+    const int BenchmarkTrials = 5;
+} // namespace
+
 Kdf::Kdf(const QUuid& uuid)
     : m_rounds(KDF_DEFAULT_ROUNDS)
     , m_seed(QByteArray(KDF_MAX_SEED_SIZE, 0))
@@ -65,3 +76,43 @@ void Kdf::randomizeSeed()
 {
     setSeed(randomGen()->randomArray(m_seed.size()));
 }
+
+/**
+ * Measure the time of a transformation over several runs.
+ *
+ * Runs are only repeated while their total time stays within the target
+ * time, so slow parameters are measured fewer times.
+ *
+ * @param run transformation to measure, returns false on failure
+ * @param msec target time of a single transformation
+ * @return median time of the runs in ms, at least 1, or -1 if a run failed
+ */
+qint64 Kdf::benchmarkRunTime(const std::function<bool()>& run, int msec)
+{
+    QVector<qint64> runTimes;
+    qint64 totalTime = 0;
+    QElapsedTimer timer;
+    do {
+        timer.start();
+        if (!run()) {
+            return -1;
+        }
+        runTimes.append(qMax<qint64>(1, timer.elapsed()));
+        totalTime += runTimes.last();
+    } while (runTimes.size() < BenchmarkTrials && totalTime < msec);
+
+    std::sort(runTimes.begin(), runTimes.end());
+    return runTimes.at(runTimes.size() / 2);
+}
+
+/**
+ * @param rounds rounds of a measured run
+ * @param runTime time of the run in ms
+ * @param msec target time
+ * @return rounds needed for the target time, at least 1
+ */
+int Kdf::scaleRounds(qint64 rounds, qint64 runTime, int msec)
+{
+    const double scaled = static_cast<double>(rounds) * msec / qMax<qint64>(1, runTime);
+    return static_cast<int>(qBound(1.0, scaled, static_cast<double>(INT_MAX - 1)));
+}
@@ -21,6 +21,8 @@
 #include <QUuid>
 #include <QVariant>
 
+#include <functional>
+
 #define KDF_MIN_SEED_SIZE 8
 #define KDF_MAX_SEED_SIZE 32
 #define KDF_DEFAULT_ROUNDS 1000000ull
@@ -62,6 +64,9 @@ public:
     static const int MAX_ENCRYPTION_TIME = 5000;
 
 protected:
+    static qint64 benchmarkRunTime(const std::function<bool()>& run, int msec);
+    static int scaleRounds(qint64 rounds, qint64 runTime, int msec);
+
     int m_rounds;
     QByteArray m_seed;
 
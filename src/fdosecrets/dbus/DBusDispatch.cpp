@@ -17,6 +17,8 @@
 
 #include "fdosecrets/dbus/DBusObject.h"
 
+#include "core/PerformanceStats.h"
+
 #include <QDBusMetaType>
 #include <QThread>
 #include <QtDBus>
@@ -164,6 +166,8 @@ namespace FdoSecrets
 
     bool DBusMgr::handleMessage(const QDBusMessage& message, const QDBusConnection&)
     {
+        PerformanceStats::ScopedTimer timer("fdosecrets.request");
+
         // save a mutable copy of the message, as we may modify it to unify property access
         // and method call
         RequestedMethod req{
@@ -239,7 +243,7 @@ namespace FdoSecrets
                                  const RequestedMethod& req,
                                  const QDBusMessage& msg)
     {
-        auto obj = m_objects.value(path, nullptr);
+        auto obj = findObject(path);
         if (!obj) {
             qDebug() << "DBusMgr::handleMessage with unknown path" << msg;
             return false;
@@ -277,23 +281,77 @@ namespace FdoSecrets
             return false;
         }
 
+        // methods may run nested event loops that deliver other calls
+        auto outerCall = m_deliveredCall;
+        m_deliveredCall = {&msg, &it.value(), req.type, false};
+
         DBusResult ret;
         QVariantList outputArgs;
-        if (!deliverMethod(client, obj, *it, req.args, ret, outputArgs)) {
+        bool delivered = deliverMethod(client, obj, *it, req.args, ret, outputArgs);
+
+        bool deferred = m_deliveredCall.deferred;
+        m_deliveredCall = outerCall;
+
+        if (!delivered) {
             qDebug() << "Failed to deliver method" << msg;
+            if (deferred) {
+                // the method must not return an error after taking over its reply
+                return true;
+            }
             return sendDBus(msg.createErrorReply(QDBusError::InternalError, tr("Failed to deliver message")));
         }
+        if (deferred) {
+            return true;
+        }
+        return sendReply(msg, req.type, ret, outputArgs);
+    }
 
+    bool DBusMgr::sendReply(const QDBusMessage& msg, RequestType type, const DBusResult& ret, QVariantList outputArgs)
+    {
         if (!ret.ok()) {
             return sendDBus(msg.createErrorReply(ret, ""));
         }
-        if (req.type == RequestType::PropertyGet) {
+        if (type == RequestType::PropertyGet) {
             // property get need the reply wrapped in QDBusVariant
             outputArgs[0] = QVariant::fromValue(QDBusVariant(outputArgs.first()));
         }
         return sendDBus(msg.createReply(outputArgs));
     }
 
+    DBusMgr::DeferredReply DBusMgr::deferReply()
+    {
+        DeferredReply reply;
+        if (!m_deliveredCall.msg) {
+            return reply;
+        }
+
+        m_deliveredCall.deferred = true;
+        reply.m_mgr = this;
+        reply.m_msg = *m_deliveredCall.msg;
+        reply.m_outputTargetTypes = m_deliveredCall.method->outputTargetTypes;
+        reply.m_type = m_deliveredCall.type;
+        return reply;
+    }
+
+    bool DBusMgr::DeferredReply::isValid() const
+    {
+        return m_mgr;
+    }
+
+    void DBusMgr::DeferredReply::send(const DBusResult& ret, QVariantList outputArgs) const
+    {
+        if (!m_mgr) {
+            // the service stopped in the meantime
+            return;
+        }
+        if (ret.ok() && !convertOutputArgs(m_outputTargetTypes, outputArgs)) {
+            m_mgr->sendDBus(
+                m_msg.createErrorReply(QDBusError::InternalError, DBusMgr::tr("Failed to deliver message")));
+            return;
+        }
+        m_mgr->sendReply(m_msg, m_type, ret, outputArgs);
+    }
+
     bool DBusMgr::objectPropertyGetAll(const DBusClientPtr& client,
                                        DBusObject* obj,
                                        const QString& interface,
@@ -374,12 +432,21 @@ namespace FdoSecrets
             return true;
         }
 
+        return convertOutputArgs(method.outputTargetTypes, outputArgs);
+    }
+
+    bool DBusMgr::convertOutputArgs(const QVector<int>& targetTypes, QVariantList& outputArgs)
+    {
+        if (outputArgs.size() != targetTypes.size()) {
+            qWarning() << "Internal error: Unexpected number of message outputs" << outputArgs.size();
+            return false;
+        }
+
         // output args need to be converted before they can be directly sent out:
         for (int i = 0; i != outputArgs.size(); ++i) {
             auto& outputArg = outputArgs[i];
-            if (!outputArg.convert(method.outputTargetTypes.at(i))) {
-                qWarning() << "Internal error: Failed to convert message output to type"
-                           << method.outputTargetTypes.at(i);
+            if (!outputArg.convert(targetTypes.at(i))) {
+                qWarning() << "Internal error: Failed to convert message output to type" << targetTypes.at(i);
                 return false;
             }
         }
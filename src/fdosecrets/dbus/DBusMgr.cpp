@@ -407,7 +407,10 @@ namespace FdoSecrets
 
     bool DBusMgr::registerObject(const QString& path, DBusObject* obj, bool primary)
     {
-        if (!m_conn.registerVirtualObject(path, this)) {
+        // the items of a collection are not registered on their own, but dispatched from the collection subtree
+        auto option =
+            parsePath(path).type == PathType::Collection ? QDBusConnection::SubPath : QDBusConnection::SingleNode;
+        if (!m_conn.registerVirtualObject(path, this, option)) {
             qDebug() << "failed to register" << obj << "at" << path;
             return false;
         }
@@ -478,11 +481,15 @@ namespace FdoSecrets
 
     bool DBusMgr::registerObject(Item* item)
     {
-        auto path = DBUS_PATH_TEMPLATE_ITEM.arg(item->collection()->objectPath().path(), item->backend()->uuidToHex());
-        if (!registerObject(path, item)) {
+        auto path = item->collection()->itemPath(item->backend());
+        if (m_objects.contains(path)) {
             emit error(tr("Failed to register item on DBus at path '%1'").arg(path));
             return false;
         }
+        // the path is already part of the subtree registered for the collection
+        connect(item, &DBusObject::destroyed, this, &DBusMgr::unregisterObject);
+        m_objects.insert(path, item);
+        item->setObjectPath(path);
         return true;
     }
 
@@ -501,13 +508,41 @@ namespace FdoSecrets
 
     void DBusMgr::unregisterObject(DBusObject* obj)
     {
-        auto count = m_objects.remove(obj->objectPath().path());
+        auto path = obj->objectPath().path();
+        auto count = m_objects.remove(path);
         if (count > 0) {
-            m_conn.unregisterObject(obj->objectPath().path());
+            if (parsePath(path).type != PathType::Item) {
+                m_conn.unregisterObject(path);
+            }
             obj->setObjectPath("/");
         }
     }
 
+    /**
+     * Find the object registered at a path.
+     * Items are created by their collection when their path is resolved for the first time.
+     * @param path
+     * @return the object, or nullptr if there is no object at the path
+     */
+    DBusObject* DBusMgr::findObject(const QString& path) const
+    {
+        auto obj = m_objects.value(path, nullptr);
+        if (obj) {
+            return obj;
+        }
+
+        auto parsed = parsePath(path);
+        if (parsed.type != PathType::Item) {
+            return nullptr;
+        }
+        auto collPath = DBUS_PATH_TEMPLATE_COLLECTION.arg(DBUS_PATH_SECRETS, parsed.parentId);
+        auto coll = qobject_cast<Collection*>(m_objects.value(collPath, nullptr));
+        if (!coll) {
+            return nullptr;
+        }
+        return coll->itemForId(parsed.id);
+    }
+
     bool DBusMgr::registerAlias(Collection* coll, const QString& alias)
     {
         auto path = DBUS_PATH_TEMPLATE_ALIAS.arg(DBUS_PATH_SECRETS, alias);
@@ -551,11 +586,15 @@ namespace FdoSecrets
         sendDBusSignal(DBUS_PATH_SECRETS, DBUS_INTERFACE_SECRET_SERVICE, QStringLiteral("CollectionDeleted"), args);
     }
 
-    void DBusMgr::emitItemCreated(Item* item)
+    void DBusMgr::emitItemCreated(const QDBusObjectPath& item)
     {
-        auto coll = item->collection();
+        auto coll = qobject_cast<Collection*>(sender());
+        if (!coll) {
+            qDebug() << "Wrong sender in emitItemCreated";
+            return;
+        }
         QVariantList args;
-        args += QVariant::fromValue(item->objectPath());
+        args += QVariant::fromValue(item);
         // send on primary path
         sendDBusSignal(
             coll->objectPath().path(), DBUS_INTERFACE_SECRET_COLLECTION, QStringLiteral("ItemCreated"), args);
@@ -566,11 +605,15 @@ namespace FdoSecrets
         }
     }
 
-    void DBusMgr::emitItemChanged(Item* item)
+    void DBusMgr::emitItemChanged(const QDBusObjectPath& item)
     {
-        auto coll = item->collection();
+        auto coll = qobject_cast<Collection*>(sender());
+        if (!coll) {
+            qDebug() << "Wrong sender in emitItemChanged";
+            return;
+        }
         QVariantList args;
-        args += QVariant::fromValue(item->objectPath());
+        args += QVariant::fromValue(item);
         // send on primary path
         sendDBusSignal(
             coll->objectPath().path(), DBUS_INTERFACE_SECRET_COLLECTION, QStringLiteral("ItemChanged"), args);
@@ -581,11 +624,15 @@ namespace FdoSecrets
         }
     }
 
-    void DBusMgr::emitItemDeleted(Item* item)
+    void DBusMgr::emitItemDeleted(const QDBusObjectPath& item)
     {
-        auto coll = item->collection();
+        auto coll = qobject_cast<Collection*>(sender());
+        if (!coll) {
+            qDebug() << "Wrong sender in emitItemDeleted";
+            return;
+        }
         QVariantList args;
-        args += QVariant::fromValue(item->objectPath());
+        args += QVariant::fromValue(item);
         // send on primary path
         sendDBusSignal(
             coll->objectPath().path(), DBUS_INTERFACE_SECRET_COLLECTION, QStringLiteral("ItemDeleted"), args);
@@ -74,11 +74,45 @@ namespace FdoSecrets
      *                                   Z& output1,
      *                                   ZZ& output2)
      * Note that the first parameter of client is optional.
+     *
+     * A method that has to wait for the user, e.g. for an unlock dialog, takes the reply with deferReply() and
+     * returns right away, so other calls are served in the meantime instead of being stuck in a nested event loop.
      */
     class DBusMgr : public QDBusVirtualObject
     {
         Q_OBJECT
+
+        enum class RequestType
+        {
+            Method,
+            PropertyGet,
+            PropertyGetAll,
+        };
+
     public:
+        /**
+         * Reply to a method call that is sent after the method returned
+         */
+        class DeferredReply
+        {
+        public:
+            bool isValid() const;
+            /**
+             * Send the reply, like the method would have returned it
+             * @param ret result of the method
+             * @param outputArgs output parameters in the types used by the method
+             */
+            void send(const DBusResult& ret, QVariantList outputArgs) const;
+
+        private:
+            friend class DBusMgr;
+
+            QPointer<DBusMgr> m_mgr;
+            QDBusMessage m_msg;
+            QVector<int> m_outputTargetTypes;
+            RequestType m_type{RequestType::Method};
+        };
+
         explicit DBusMgr();
 
         /**
@@ -169,7 +203,7 @@ namespace FdoSecrets
             if (path.path() == QStringLiteral("/")) {
                 return nullptr;
             }
-            auto obj = qobject_cast<T*>(m_objects.value(path.path(), nullptr));
+            auto obj = qobject_cast<T*>(findObject(path.path()));
             if (!obj) {
                 qDebug() << "object not found at path" << path.path();
                 qDebug() << m_objects;
@@ -200,6 +234,13 @@ namespace FdoSecrets
         // Force client to be a specific object, used for testing
         void overrideClient(const DBusClientPtr& fake);
 
+        /**
+         * Take over the reply of the method call that is currently delivered.
+         * The result the method returns is not sent, DeferredReply::send has to be called later on instead.
+         * @return the reply, or an invalid one if no method call is being delivered
+         */
+        DeferredReply deferReply();
+
     signals:
         void clientConnected(const DBusClientPtr& client);
         void clientDisconnected(const DBusClientPtr& client);
@@ -209,9 +250,9 @@ namespace FdoSecrets
         void emitCollectionCreated(Collection* coll);
         void emitCollectionChanged(Collection* coll);
         void emitCollectionDeleted(Collection* coll);
-        void emitItemCreated(Item* item);
-        void emitItemChanged(Item* item);
-        void emitItemDeleted(Item* item);
+        void emitItemCreated(const QDBusObjectPath& item);
+        void emitItemChanged(const QDBusObjectPath& item);
+        void emitItemDeleted(const QDBusObjectPath& item);
         void emitPromptCompleted(bool dismissed, QVariant result);
 
         void dbusServiceUnregistered(const QString& service);
@@ -254,6 +295,7 @@ namespace FdoSecrets
         };
         static ParsedPath parsePath(const QString& path);
         bool registerObject(const QString& path, DBusObject* obj, bool primary = true);
+        DBusObject* findObject(const QString& path) const;
 
         // method dispatching
         struct MethodData
@@ -269,12 +311,6 @@ namespace FdoSecrets
         QHash<QString, MethodData> m_cachedMethods{};
         void populateMethodCache(const QMetaObject& mo);
 
-        enum class RequestType
-        {
-            Method,
-            PropertyGet,
-            PropertyGetAll,
-        };
         struct RequestedMethod
         {
             QString interface;
@@ -298,6 +334,18 @@ namespace FdoSecrets
                                   const QVariantList& args,
                                   DBusResult& ret,
                                   QVariantList& outputArgs);
+        static bool convertOutputArgs(const QVector<int>& targetTypes, QVariantList& outputArgs);
+        bool sendReply(const QDBusMessage& msg, RequestType type, const DBusResult& ret, QVariantList outputArgs);
+
+        // the method call being delivered, for deferReply
+        struct DeliveredCall
+        {
+            const QDBusMessage* msg{nullptr};
+            const MethodData* method{nullptr};
+            RequestType type{RequestType::Method};
+            bool deferred{false};
+        };
+        DeliveredCall m_deliveredCall{};
 
         // client management
         friend class DBusClient;
@@ -29,6 +29,8 @@
 #include <QEventLoop>
 #include <QFileInfo>
 
+#include <algorithm>
+
 namespace FdoSecrets
 {
     Collection* Collection::Create(Service* parent, DatabaseWidget* backend)
@@ -56,6 +58,10 @@ namespace FdoSecrets
             }
             emit doneUnlockCollection(accepted);
         });
+
+        m_itemSignalTimer.setSingleShot(true);
+        m_itemSignalTimer.setInterval(0);
+        connect(&m_itemSignalTimer, &QTimer::timeout, this, &Collection::emitItemSignals);
     }
 
     bool Collection::reloadBackend()
@@ -69,6 +75,8 @@ namespace FdoSecrets
             m_items.first()->removeFromDBus();
         }
         cleanupConnections();
+        // the queued signals refer to the current path
+        emitItemSignals();
         dbus()->unregisterObject(this);
 
         // make sure we have updated copy of the filepath, which is used to identify the database.
@@ -113,13 +121,24 @@ namespace FdoSecrets
         return {};
     }
 
-    DBusResult Collection::items(QList<Item*>& items) const
+    DBusResult Collection::items(QList<QDBusObjectPath>& items) const
     {
         auto ret = ensureBackend();
         if (ret.err()) {
             return ret;
         }
-        items = m_items;
+
+        // Only the paths are listed, the items are created once they are used
+        auto entries = m_indexedEntries.keys();
+        std::sort(entries.begin(), entries.end(), [this](Entry* lhs, Entry* rhs) {
+            return m_indexedEntries.value(lhs).order < m_indexedEntries.value(rhs).order;
+        });
+
+        items.clear();
+        items.reserve(entries.size());
+        for (const auto entry : asConst(entries)) {
+            items << QDBusObjectPath(itemPath(entry));
+        }
         return {};
     }
 
@@ -228,38 +247,41 @@ namespace FdoSecrets
 
         // shortcut logic for Uuid/Path attributes, as they can uniquely identify an item.
         if (attributes.contains(ItemAttributes::UuidKey)) {
-            auto uuid = QUuid::fromRfc4122(QByteArray::fromHex(attributes.value(ItemAttributes::UuidKey).toLatin1()));
-            auto entry = m_exposedGroup->findEntryByUuid(uuid);
-            if (entry) {
-                items += m_entryToItem.value(entry);
+            auto item = itemForId(attributes.value(ItemAttributes::UuidKey));
+            if (item) {
+                items += item;
             }
             return {};
         }
 
         if (attributes.contains(ItemAttributes::PathKey)) {
             auto path = attributes.value(ItemAttributes::PathKey);
-            auto entry = m_exposedGroup->findEntryByPath(path);
-            if (entry) {
-                items += m_entryToItem.value(entry);
+            auto item = itemForEntry(m_exposedGroup->findEntryByPath(path));
+            if (item) {
+                items += item;
             }
             return {};
         }
 
+        if (attributes.isEmpty()) {
+            // searching using empty terms returns nothing
+            return {};
+        }
+
         QList<EntrySearcher::SearchTerm> terms;
         for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
             terms << attributeToTerm(it.key(), it.value());
         }
 
+        // Only the entries the attribute index found are matched against the terms
+        const auto candidates = findCandidates(attributes);
+
         constexpr auto caseSensitive = false;
         constexpr auto skipProtected = true;
-        constexpr auto forceSearch = true;
-        const auto foundEntries =
-            EntrySearcher(caseSensitive, skipProtected).search(terms, m_exposedGroup, forceSearch);
+        const auto foundEntries = EntrySearcher(caseSensitive, skipProtected).filterEntries(candidates, terms);
         items.reserve(foundEntries.size());
         for (const auto& entry : foundEntries) {
-            const auto item = m_entryToItem.value(entry);
-            // it's possible that we don't have a corresponding item for the entry
-            // this can happen when the recycle bin is below the exposed group.
+            const auto item = itemForEntry(entry);
             if (item) {
                 items << item;
             }
@@ -267,6 +289,96 @@ namespace FdoSecrets
         return {};
     }
 
+    /**
+     * Find the exposed entries that may match all attributes exactly.
+     *
+     * @param attributes attributes to search for
+     * @return entries in the order they were added, that still have to be matched
+     *         against the attributes because of placeholders and protected values
+     */
+    QList<Entry*> Collection::findCandidates(const StringStringMap& attributes)
+    {
+        for (auto entry : asConst(m_staleEntries)) {
+            indexEntry(entry);
+        }
+        m_staleEntries.clear();
+
+        // Start with the rarest attribute to keep the intersection small
+        QList<QSet<Entry*>> matches;
+        for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
+            auto match = m_attributeIndex.value({it.key(), it.value()});
+            match.unite(m_unresolvedAttributes.value(it.key()));
+            if (match.isEmpty()) {
+                return {};
+            }
+            matches << match;
+        }
+        std::sort(matches.begin(), matches.end(), [](const QSet<Entry*>& lhs, const QSet<Entry*>& rhs) {
+            return lhs.size() < rhs.size();
+        });
+
+        auto result = matches.takeFirst();
+        for (const auto& match : asConst(matches)) {
+            result.intersect(match);
+        }
+
+        auto candidates = result.values();
+        std::sort(candidates.begin(), candidates.end(), [this](Entry* lhs, Entry* rhs) {
+            return m_indexedEntries.value(lhs).order < m_indexedEntries.value(rhs).order;
+        });
+        return candidates;
+    }
+
+    void Collection::indexEntry(Entry* entry)
+    {
+        unindexEntry(entry);
+
+        auto& indexed = m_indexedEntries[entry];
+        const auto entryAttrs = entry->attributes();
+        for (const auto& key : entryAttrs->keys()) {
+            const auto value = entryAttrs->value(key);
+            // Default attributes are searched with resolved placeholders, protected ones are skipped
+            bool resolved = EntryAttributes::isDefaultAttribute(key) && key != EntryAttributes::NotesKey
+                            && value.contains('{');
+            if (entryAttrs->isProtected(key) || resolved) {
+                indexed.unresolved << key;
+                m_unresolvedAttributes[key].insert(entry);
+            } else {
+                indexed.values << qMakePair(key, value);
+                m_attributeIndex[{key, value}].insert(entry);
+            }
+        }
+    }
+
+    void Collection::unindexEntry(Entry* entry)
+    {
+        auto it = m_indexedEntries.find(entry);
+        if (it == m_indexedEntries.end()) {
+            return;
+        }
+
+        for (const auto& value : asConst(it->values)) {
+            auto match = m_attributeIndex.find(value);
+            if (match != m_attributeIndex.end()) {
+                match->remove(entry);
+                if (match->isEmpty()) {
+                    m_attributeIndex.erase(match);
+                }
+            }
+        }
+        for (const auto& key : asConst(it->unresolved)) {
+            auto match = m_unresolvedAttributes.find(key);
+            if (match != m_unresolvedAttributes.end()) {
+                match->remove(entry);
+                if (match->isEmpty()) {
+                    m_unresolvedAttributes.erase(match);
+                }
+            }
+        }
+        it->values.clear();
+        it->unresolved.clear();
+    }
+
     EntrySearcher::SearchTerm Collection::attributeToTerm(const QString& key, const QString& value)
     {
         static QMap<QString, EntrySearcher::Field> attrKeyToField{
@@ -469,7 +581,12 @@ namespace FdoSecrets
         }
 
         // Do not connect to Database::modified signal because we only want signals for the subset under m_exposedGroup
-        connect(m_backend->database()->metadata(), &Metadata::modified, this, &Collection::collectionChanged);
+        connect(m_backend->database()->metadata(), &Metadata::modified, this, &Collection::onContentsModified);
+        connect(m_backend->database().data(),
+                &Database::bulkUpdateFinished,
+                this,
+                &Collection::onBulkUpdateFinished,
+                Qt::UniqueConnection);
         connectGroupSignalRecursive(m_exposedGroup);
     }
 
@@ -478,8 +595,11 @@ namespace FdoSecrets
         // delete all items
         // this has to be done because the backend is actually still there
         // just we don't expose them
-        for (const auto& item : asConst(m_items)) {
-            item->removeFromDBus();
+        while (!m_items.isEmpty()) {
+            m_items.first()->removeFromDBus();
+        }
+        for (auto it = m_indexedEntries.constBegin(); it != m_indexedEntries.constEnd(); ++it) {
+            queueItemSignal(itemPath(it.key()), ItemDeletedSignal);
         }
 
         // repopulate
@@ -494,31 +614,163 @@ namespace FdoSecrets
             return;
         }
 
-        auto item = Item::Create(this, entry);
-        if (!item) {
+        // Indexed on the next search, the item is created on first use
+        m_indexedEntries[entry].order = m_nextEntryOrder++;
+        m_uuidToEntry.insert(entry->uuid(), entry);
+        m_staleEntries.insert(entry);
+
+        connect(entry, &Entry::modified, this, &Collection::onEntryModified, Qt::UniqueConnection);
+
+        if (emitSignal) {
+            queueItemSignal(itemPath(entry), ItemCreatedSignal);
+        }
+    }
+
+    void Collection::onEntryModified()
+    {
+        auto entry = qobject_cast<Entry*>(sender());
+        if (!entry || !m_indexedEntries.contains(entry)) {
             return;
         }
 
+        m_staleEntries.insert(entry);
+        queueItemSignal(itemPath(entry), ItemChangedSignal);
+    }
+
+    void Collection::onEntryAboutToRemove(Entry* entry)
+    {
+        if (!m_indexedEntries.contains(entry)) {
+            return;
+        }
+
+        auto item = m_entryToItem.value(entry, nullptr);
+        if (item) {
+            item->removeFromDBus();
+        }
+        queueItemSignal(itemPath(entry), ItemDeletedSignal);
+
+        unindexEntry(entry);
+        m_indexedEntries.remove(entry);
+        m_uuidToEntry.remove(entry->uuid());
+        m_staleEntries.remove(entry);
+        entry->disconnect(this);
+    }
+
+    /**
+     * Get the item of an exposed entry, creating it on first use.
+     *
+     * @param entry entry of the exposed group
+     * @return the item, or nullptr if the entry is not exposed
+     */
+    Item* Collection::itemForEntry(Entry* entry)
+    {
+        if (!entry || !m_indexedEntries.contains(entry)) {
+            return nullptr;
+        }
+
+        auto item = m_entryToItem.value(entry, nullptr);
+        if (item) {
+            return item;
+        }
+
+        item = Item::Create(this, entry);
+        if (!item) {
+            return nullptr;
+        }
+
         m_items << item;
         m_entryToItem[entry] = item;
 
-        // forward delete signals
-        connect(entry->group(), &Group::entryAboutToRemove, item, [item](Entry* toBeRemoved) {
-            if (item->backend() == toBeRemoved) {
-                item->removeFromDBus();
-            }
-        });
-
-        // relay signals
-        connect(item, &Item::itemChanged, this, [this, item]() { emit itemChanged(item); });
         connect(item, &Item::itemAboutToDelete, this, [this, item]() {
             m_items.removeAll(item);
             m_entryToItem.remove(item->backend());
-            emit itemDeleted(item);
+            queueItemSignal(item->objectPath().path(), ItemDeletedSignal);
         });
 
-        if (emitSignal) {
-            emit itemCreated(item);
+        return item;
+    }
+
+    /**
+     * @param id the last component of the item path, the hex encoded entry uuid
+     * @return the item, or nullptr if there is no such exposed entry
+     */
+    Item* Collection::itemForId(const QString& id)
+    {
+        auto uuid = QUuid::fromRfc4122(QByteArray::fromHex(id.toLatin1()));
+        return itemForEntry(m_uuidToEntry.value(uuid, nullptr));
+    }
+
+    QString Collection::itemPath(const Entry* entry) const
+    {
+        return DBUS_PATH_TEMPLATE_ITEM.arg(objectPath().path(), entry->uuidToHex());
+    }
+
+    void Collection::queueItemSignal(const QString& path, ItemSignal signal)
+    {
+        auto it = m_pendingItemSignals.find(path);
+        if (it == m_pendingItemSignals.end()) {
+            m_pendingItemPaths << path;
+            it = m_pendingItemSignals.insert(path, 0);
+        }
+
+        switch (signal) {
+        case ItemCreatedSignal:
+            it.value() |= ItemCreatedSignal;
+            break;
+        case ItemChangedSignal:
+            if (it.value() != ItemDeletedSignal) {
+                it.value() |= ItemChangedSignal;
+            }
+            break;
+        case ItemDeletedSignal:
+            // nothing is sent for an item that is created and deleted in the same batch
+            it.value() = (it.value() & ItemCreatedSignal) ? (it.value() & ItemDeletedSignal) : ItemDeletedSignal;
+            break;
+        }
+
+        if (!m_itemSignalTimer.isActive()) {
+            m_itemSignalTimer.start();
+        }
+    }
+
+    void Collection::emitItemSignals()
+    {
+        m_itemSignalTimer.stop();
+
+        const auto paths = m_pendingItemPaths;
+        const auto pending = m_pendingItemSignals;
+        m_pendingItemPaths.clear();
+        m_pendingItemSignals.clear();
+
+        // repeated changes of an item are only sent once per batch
+        for (const auto& path : paths) {
+            auto signal = pending.value(path);
+            if (signal & ItemDeletedSignal) {
+                emit itemDeleted(QDBusObjectPath(path));
+            }
+            if (signal & ItemCreatedSignal) {
+                emit itemCreated(QDBusObjectPath(path));
+            }
+            if (signal & ItemChangedSignal) {
+                emit itemChanged(QDBusObjectPath(path));
+            }
+        }
+    }
+
+    void Collection::onContentsModified()
+    {
+        if (!backendLocked() && m_backend->database()->isBulkUpdating()) {
+            m_collectionChangePending = true;
+            return;
+        }
+        emit collectionChanged();
+    }
+
+    void Collection::onBulkUpdateFinished()
+    {
+        if (m_collectionChangePending) {
+            m_collectionChangePending = false;
+            emit collectionChanged();
         }
     }
 
@@ -528,8 +780,9 @@ namespace FdoSecrets
             return;
         }
 
-        connect(group, &Group::modified, this, &Collection::collectionChanged);
+        connect(group, &Group::modified, this, &Collection::onContentsModified);
         connect(group, &Group::entryAdded, this, [this](Entry* entry) { onEntryAdded(entry, true); });
+        connect(group, &Group::entryAboutToRemove, this, &Collection::onEntryAboutToRemove);
 
         const auto children = group->children();
         for (const auto& cg : children) {
@@ -573,6 +826,7 @@ namespace FdoSecrets
         }
 
         emit collectionAboutToDelete();
+        emitItemSignals();
 
         // remove from dbus early
         dbus()->unregisterObject(this);
@@ -600,13 +854,24 @@ namespace FdoSecrets
     void Collection::cleanupConnections()
     {
         m_backend->database()->metadata()->customData()->disconnect(this);
+        disconnect(m_backend->database().data(), &Database::bulkUpdateFinished, this, nullptr);
+        m_collectionChangePending = false;
         if (m_exposedGroup) {
             for (const auto group : m_exposedGroup->groupsRecursive(true)) {
                 group->disconnect(this);
+                for (const auto entry : group->entries()) {
+                    entry->disconnect(this);
+                }
             }
         }
 
         m_items.clear();
+        m_entryToItem.clear();
+        m_indexedEntries.clear();
+        m_uuidToEntry.clear();
+        m_attributeIndex.clear();
+        m_unresolvedAttributes.clear();
+        m_staleEntries.clear();
     }
 
     QString Collection::backendFilePath() const
@@ -690,10 +955,8 @@ namespace FdoSecrets
         // the item was just created so there is no point in having it not authorized
         client->setItemAuthorized(entry->uuid(), AuthDecision::Allowed);
 
-        // when creation finishes in backend, we will already have item
-        auto created = m_entryToItem.value(entry, nullptr);
-
-        return created;
+        // when creation finishes in backend, the entry is already exposed
+        return itemForEntry(entry);
     }
 
 } // namespace FdoSecrets
@@ -23,6 +23,11 @@
 
 #include "core/EntrySearcher.h"
 
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QUuid>
+
 class Database;
 class DatabaseWidget;
 class Entry;
@@ -52,7 +57,7 @@ namespace FdoSecrets
          */
         static Collection* Create(Service* parent, DatabaseWidget* backend);
 
-        Q_INVOKABLE DBUS_PROPERTY DBusResult items(QList<Item*>& items) const;
+        Q_INVOKABLE DBUS_PROPERTY DBusResult items(QList<QDBusObjectPath>& items) const;
 
         Q_INVOKABLE DBUS_PROPERTY DBusResult label(QString& label) const;
         Q_INVOKABLE DBusResult setLabel(const QString& label);
@@ -71,9 +76,10 @@ namespace FdoSecrets
         createItem(const QVariantMap& properties, const Secret& secret, bool replace, Item*& item, PromptBase*& prompt);
 
     signals:
-        void itemCreated(Item* item);
-        void itemDeleted(Item* item);
-        void itemChanged(Item* item);
+        // Sent in batches, see emitItemSignals
+        void itemCreated(const QDBusObjectPath& item);
+        void itemDeleted(const QDBusObjectPath& item);
+        void itemChanged(const QDBusObjectPath& item);
 
         void collectionChanged();
         void collectionAboutToDelete();
@@ -108,6 +114,10 @@ namespace FdoSecrets
         QString backendFilePath() const;
         Service* service() const;
 
+        Item* itemForEntry(Entry* entry);
+        Item* itemForId(const QString& id);
+        QString itemPath(const Entry* entry) const;
+
         static EntrySearcher::SearchTerm attributeToTerm(const QString& key, const QString& value);
 
     public slots:
@@ -131,6 +141,13 @@ namespace FdoSecrets
     private slots:
         void onDatabaseLockChanged();
         void onDatabaseExposedGroupChanged();
+        void onEntryModified();
+        void onEntryAboutToRemove(Entry* entry);
+        void onContentsModified();
+        void onBulkUpdateFinished();
+
+        // send the item signals queued since the last batch
+        void emitItemSignals();
 
         // calls reloadBackend, delete self when error
         void reloadBackendOrDelete();
@@ -139,7 +156,18 @@ namespace FdoSecrets
         friend class DeleteCollectionPrompt;
         friend class CreateCollectionPrompt;
 
+        enum ItemSignal
+        {
+            ItemCreatedSignal = 0x1,
+            ItemChangedSignal = 0x2,
+            ItemDeletedSignal = 0x4,
+        };
+
         void onEntryAdded(Entry* entry, bool emitSignal);
+        QList<Entry*> findCandidates(const StringStringMap& attributes);
+        void indexEntry(Entry* entry);
+        void unindexEntry(Entry* entry);
+        void queueItemSignal(const QString& path, ItemSignal signal);
         void populateContents();
         void connectGroupSignalRecursive(Group* group);
         void cleanupConnections();
@@ -171,8 +199,32 @@ namespace FdoSecrets
         QPointer<Group> m_exposedGroup;
 
         QSet<QString> m_aliases;
+        // Items are only created for the exposed entries that are used on DBus
         QList<Item*> m_items;
         QMap<const Entry*, Item*> m_entryToItem;
+
+        struct IndexedEntry
+        {
+            quint64 order = 0;
+            QList<QPair<QString, QString>> values;
+            QStringList unresolved;
+        };
+        // All exposed entries, by entry and by uuid
+        QHash<Entry*, IndexedEntry> m_indexedEntries;
+        QHash<QUuid, Entry*> m_uuidToEntry;
+        // Exact attribute values of the entries, for SearchItems
+        QHash<QPair<QString, QString>, QSet<Entry*>> m_attributeIndex;
+        // Attributes that have to be matched on every search, by key
+        QHash<QString, QSet<Entry*>> m_unresolvedAttributes;
+        QSet<Entry*> m_staleEntries;
+        quint64 m_nextEntryOrder = 0;
+
+        // ItemSignal flags by item path, and the paths in the order they were queued
+        QHash<QString, int> m_pendingItemSignals;
+        QStringList m_pendingItemPaths;
+        QTimer m_itemSignalTimer;
+        // collectionChanged is sent once at the end of a bulk update of the database
+        bool m_collectionChangePending = false;
     };
 
 } // namespace FdoSecrets
@@ -73,6 +73,7 @@ namespace FdoSecrets
         : DBusObject(parent)
         , m_backend(backend)
     {
+        connect(m_backend, &Entry::modified, this, [this] { m_attributesCached = false; });
         connect(m_backend, &Entry::modified, this, &Item::itemChanged);
     }
 
@@ -101,29 +102,40 @@ namespace FdoSecrets
             return ret;
         }
 
-        // add default attributes except password
+        // The attributes stored in the entry are cached until it is modified
         auto entryAttrs = m_backend->attributes();
-        for (const auto& attr : EntryAttributes::DefaultAttributes) {
-            if (entryAttrs->isProtected(attr) || attr == EntryAttributes::PasswordKey) {
-                continue;
+        if (!m_attributesCached) {
+            m_attributes.clear();
+            m_referenceAttributes.clear();
+
+            // add default attributes except password
+            for (const auto& attr : EntryAttributes::DefaultAttributes) {
+                if (entryAttrs->isProtected(attr) || attr == EntryAttributes::PasswordKey) {
+                    continue;
+                }
+                if (entryAttrs->isReference(attr)) {
+                    m_referenceAttributes << attr;
+                    continue;
+                }
+                m_attributes[attr] = entryAttrs->value(attr);
             }
 
-            auto value = entryAttrs->value(attr);
-            if (entryAttrs->isReference(attr)) {
-                value = m_backend->maskPasswordPlaceholders(value);
-                value = m_backend->resolveMultiplePlaceholders(value);
+            // add custom attributes
+            const auto customKeys = entryAttrs->customKeys();
+            for (const auto& attr : customKeys) {
+                m_attributes[attr] = entryAttrs->value(attr);
             }
-            attrs[attr] = value;
-        }
 
-        // add custom attributes
-        const auto customKeys = entryAttrs->customKeys();
-        for (const auto& attr : customKeys) {
-            attrs[attr] = entryAttrs->value(attr);
+            m_attributes[ItemAttributes::UuidKey] = m_backend->uuidToHex();
+            m_attributesCached = true;
         }
+        attrs = m_attributes;
 
-        // add some informative and readonly attributes
-        attrs[ItemAttributes::UuidKey] = m_backend->uuidToHex();
+        // References, the path and the TOTP depend on other objects or the time
+        for (const auto& attr : asConst(m_referenceAttributes)) {
+            auto value = m_backend->maskPasswordPlaceholders(entryAttrs->value(attr));
+            attrs[attr] = m_backend->resolveMultiplePlaceholders(value);
+        }
         attrs[ItemAttributes::PathKey] = path();
         if (m_backend->hasTotp()) {
             attrs[ItemAttributes::TotpKey] = m_backend->totp();
@@ -257,6 +269,29 @@ namespace FdoSecrets
     }
 
     DBusResult Item::getSecretNoNotification(const DBusClientPtr& client, Session* session, Secret& secret) const
+    {
+        auto ret = getPlainSecretNoNotification(client, secret);
+        if (ret.err()) {
+            return ret;
+        }
+
+        if (!session) {
+            return DBusResult(DBUS_ERROR_SECRET_NO_SESSION);
+        }
+
+        // encode using session
+        secret = session->encode(secret);
+
+        return {};
+    }
+
+    /**
+     * Get the secret without encoding it, so several secrets can be encoded at once.
+     *
+     * @param client client requesting the secret
+     * @param secret unencoded secret of the entry
+     */
+    DBusResult Item::getPlainSecretNoNotification(const DBusClientPtr& client, Secret& secret) const
     {
         auto ret = ensureBackend();
         if (ret.err()) {
@@ -270,15 +305,7 @@ namespace FdoSecrets
             return DBusResult(DBUS_ERROR_SECRET_IS_LOCKED);
         }
 
-        if (!session) {
-            return DBusResult(DBUS_ERROR_SECRET_NO_SESSION);
-        }
-
         secret = getEntrySecret(m_backend);
-
-        // encode using session
-        secret = session->encode(secret);
-
         return {};
     }
 
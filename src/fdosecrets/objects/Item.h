@@ -79,6 +79,7 @@ namespace FdoSecrets
         static const QSet<QString> ReadOnlyAttributes;
 
         DBusResult getSecretNoNotification(const DBusClientPtr& client, Session* session, Secret& secret) const;
+        DBusResult getPlainSecretNoNotification(const DBusClientPtr& client, Secret& secret) const;
         DBusResult setProperties(const QVariantMap& properties);
 
         Entry* backend() const;
@@ -113,6 +114,10 @@ namespace FdoSecrets
 
     private:
         QPointer<Entry> m_backend;
+
+        mutable StringStringMap m_attributes;
+        mutable QStringList m_referenceAttributes;
+        mutable bool m_attributesCached = false;
     };
 
 } // namespace FdoSecrets
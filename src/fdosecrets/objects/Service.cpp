@@ -27,6 +27,8 @@
 #include "gui/DatabaseTabWidget.h"
 #include "gui/DatabaseWidget.h"
 
+#include <QTimer>
+
 namespace
 {
     constexpr auto DEFAULT_ALIAS = "default";
@@ -275,34 +277,68 @@ namespace FdoSecrets
             return ret;
         }
 
-        while (unlockedColls.isEmpty() && settings()->unlockBeforeSearch()) {
+        if (unlockedColls.isEmpty() && settings()->unlockBeforeSearch()) {
             // enable compatibility mode by making sure at least one database is unlocked
-            QEventLoop loop;
-            bool wasAccepted = false;
-            connect(this, &Service::doneUnlockDatabaseInDialog, &loop, [&](bool accepted) {
-                wasAccepted = accepted;
-                loop.quit();
-            });
+            auto reply = dbus()->deferReply();
+            if (reply.isValid()) {
+                searchItemsAfterUnlock(client, attributes, reply);
+                return {};
+            }
+        }
 
-            doUnlockAnyDatabaseInDialog();
+        return searchUnlockedItems(client, unlockedColls, attributes, unlocked, locked);
+    }
 
-            // blocking wait
-            loop.exec();
+    /**
+     * Reply to a search once the user unlocked a database.
+     *
+     * Shows the unlock dialog again until there is at least one unlocked collection,
+     * without blocking the calls of other clients in the meantime.
+     */
+    void Service::searchItemsAfterUnlock(const DBusClientPtr& client,
+                                         const StringStringMap& attributes,
+                                         const DBusMgr::DeferredReply& reply)
+    {
+        auto connection = QSharedPointer<QMetaObject::Connection>::create();
+        *connection = connect(this, &Service::doneUnlockDatabaseInDialog, this, [=](bool accepted) {
+            disconnect(*connection);
+
+            // continue once the dialog is finished, so another one can be shown
+            QTimer::singleShot(0, this, [=]() {
+                QList<Item*> unlocked;
+                QList<Item*> locked;
+                if (!accepted) {
+                    // user cancelled, do not proceed
+                    qWarning() << "user cancelled";
+                    reply.send({}, {QVariant::fromValue(unlocked), QVariant::fromValue(locked)});
+                    return;
+                }
 
-            if (!wasAccepted) {
-                // user cancelled, do not proceed
-                qWarning() << "user cancelled";
-                return {};
-            }
+                // need to recompute this because collections may disappear while waiting
+                QList<Collection*> unlockedColls;
+                auto ret = unlockedCollections(unlockedColls);
+                if (ret.ok() && unlockedColls.isEmpty() && settings()->unlockBeforeSearch()) {
+                    searchItemsAfterUnlock(client, attributes, reply);
+                    return;
+                }
+                if (ret.ok()) {
+                    ret = searchUnlockedItems(client, unlockedColls, attributes, unlocked, locked);
+                }
+                reply.send(ret, {QVariant::fromValue(unlocked), QVariant::fromValue(locked)});
+            });
+        });
 
-            // need to recompute this because collections may disappear while in event loop
-            ret = unlockedCollections(unlockedColls);
-            if (ret.err()) {
-                return ret;
-            }
-        }
+        doUnlockAnyDatabaseInDialog();
+    }
 
-        for (const auto& coll : asConst(unlockedColls)) {
+    DBusResult Service::searchUnlockedItems(const DBusClientPtr& client,
+                                            const QList<Collection*>& unlockedColls,
+                                            const StringStringMap& attributes,
+                                            QList<Item*>& unlocked,
+                                            QList<Item*>& locked) const
+    {
+        DBusResult ret;
+        for (const auto& coll : unlockedColls) {
             QList<Item*> items;
             ret = coll->searchItems(client, attributes, items);
             if (ret.err()) {
@@ -432,11 +468,20 @@ namespace FdoSecrets
             return DBusResult(DBUS_ERROR_SECRET_NO_SESSION);
         }
 
+        // Encode all secrets in one pass with the same cipher context
+        QList<Secret> plainSecrets;
+        plainSecrets.reserve(items.size());
         for (const auto& item : asConst(items)) {
-            auto ret = item->getSecretNoNotification(client, session, secrets[item]);
+            Secret secret{};
+            auto ret = item->getPlainSecretNoNotification(client, secret);
             if (ret.err()) {
                 return ret;
             }
+            plainSecrets << secret;
+        }
+        const auto encoded = session->encode(plainSecrets);
+        for (int i = 0; i < items.size(); ++i) {
+            secrets[items.at(i)] = encoded.at(i);
         }
         plugin()->emitRequestShowNotification(
             tr(R"(%n Entry(s) was used by %1)", "%1 is the name of an application", secrets.size())
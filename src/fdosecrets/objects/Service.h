@@ -162,6 +162,15 @@ namespace FdoSecrets
 
         DBusResult unlockedCollections(QList<Collection*>& unlocked) const;
 
+        void searchItemsAfterUnlock(const DBusClientPtr& client,
+                                    const StringStringMap& attributes,
+                                    const DBusMgr::DeferredReply& reply);
+        DBusResult searchUnlockedItems(const DBusClientPtr& client,
+                                       const QList<Collection*>& unlockedColls,
+                                       const StringStringMap& attributes,
+                                       QList<Item*>& unlocked,
+                                       QList<Item*>& locked) const;
+
     private:
         FdoSecretsPlugin* m_plugin{nullptr};
         QPointer<DatabaseTabWidget> m_databases{};
@@ -72,6 +72,21 @@ namespace FdoSecrets
         return output;
     }
 
+    /**
+     * Encode several secrets with the same cipher context.
+     *
+     * @param inputs secrets to encode
+     * @return encoded secrets in the same order
+     */
+    QList<Secret> Session::encode(const QList<Secret>& inputs) const
+    {
+        auto outputs = m_cipher->encrypt(inputs);
+        for (auto& output : outputs) {
+            output.session = this;
+        }
+        return outputs;
+    }
+
     Secret Session::decode(const Secret& input) const
     {
         Q_ASSERT(input.session == this);
@@ -50,6 +50,7 @@ namespace FdoSecrets
          * @return
          */
         Secret encode(const Secret& input) const;
+        QList<Secret> encode(const QList<Secret>& inputs) const;
 
         /**
          * Decode the secret struct.
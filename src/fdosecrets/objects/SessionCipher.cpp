@@ -38,6 +38,22 @@ namespace FdoSecrets
     constexpr char PlainCipher::Algorithm[];
     constexpr char DhIetf1024Sha256Aes128CbcPkcs7::Algorithm[];
 
+    /**
+     * Encrypt several secrets at once.
+     *
+     * @param inputs secrets to encrypt
+     * @return encrypted secrets in the same order
+     */
+    QList<Secret> CipherPair::encrypt(const QList<Secret>& inputs)
+    {
+        QList<Secret> outputs;
+        outputs.reserve(inputs.size());
+        for (const auto& input : inputs) {
+            outputs << encrypt(input);
+        }
+        return outputs;
+    }
+
     DhIetf1024Sha256Aes128CbcPkcs7::DhIetf1024Sha256Aes128CbcPkcs7(const QByteArray& clientPublicKey)
     {
         try {
@@ -50,11 +66,14 @@ namespace FdoSecrets
         }
     }
 
+    DhIetf1024Sha256Aes128CbcPkcs7::~DhIetf1024Sha256Aes128CbcPkcs7() = default;
+
     bool DhIetf1024Sha256Aes128CbcPkcs7::updateClientPublicKey(const QByteArray& clientPublicKey)
     {
         if (!m_privateKey) {
             return false;
         }
+        m_encrypter.reset();
 
         try {
             Botan::secure_vector<uint8_t> salt(32, '\0');
@@ -84,25 +103,49 @@ namespace FdoSecrets
 
     Secret DhIetf1024Sha256Aes128CbcPkcs7::encrypt(const Secret& input)
     {
-        Secret output = input;
-        output.parameters.clear();
-        output.value.clear();
-
-        SymmetricCipher encrypter;
-        auto IV = randomGen()->randomArray(SymmetricCipher::defaultIvSize(SymmetricCipher::Aes128_CBC));
-        if (!encrypter.init(SymmetricCipher::Aes128_CBC, SymmetricCipher::Encrypt, m_aesKey, IV)) {
-            qWarning() << "Error encrypt: " << encrypter.errorString();
-            return output;
-        }
+        return encrypt(QList<Secret>{input}).first();
+    }
 
-        output.parameters = IV;
-        output.value = input.value;
-        if (!encrypter.finish(output.value)) {
-            qWarning() << "Error encrypt: " << encrypter.errorString();
-            return output;
+    QList<Secret> DhIetf1024Sha256Aes128CbcPkcs7::encrypt(const QList<Secret>& inputs)
+    {
+        QList<Secret> outputs;
+        outputs.reserve(inputs.size());
+
+        // One random read for the IVs of all secrets
+        const int ivSize = SymmetricCipher::defaultIvSize(SymmetricCipher::Aes128_CBC);
+        const auto IVs = randomGen()->randomArray(ivSize * inputs.size());
+
+        for (int i = 0; i < inputs.size(); ++i) {
+            const auto& input = inputs.at(i);
+            auto IV = IVs.mid(i * ivSize, ivSize);
+
+            Secret output = input;
+            output.parameters.clear();
+            output.value.clear();
+
+            bool started;
+            if (!m_encrypter) {
+                m_encrypter.reset(new SymmetricCipher());
+                started = m_encrypter->init(SymmetricCipher::Aes128_CBC, SymmetricCipher::Encrypt, m_aesKey, IV);
+            } else {
+                started = m_encrypter->restart(IV);
+            }
+            if (!started) {
+                qWarning() << "Error encrypt: " << m_encrypter->errorString();
+                m_encrypter.reset();
+                outputs << output;
+                continue;
+            }
+
+            output.parameters = IV;
+            output.value = input.value;
+            if (!m_encrypter->finish(output.value)) {
+                qWarning() << "Error encrypt: " << m_encrypter->errorString();
+            }
+            outputs << output;
         }
 
-        return output;
+        return outputs;
     }
 
     Secret DhIetf1024Sha256Aes128CbcPkcs7::decrypt(const Secret& input)
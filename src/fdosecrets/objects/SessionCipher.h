@@ -20,8 +20,11 @@
 
 #include "fdosecrets/dbus/DBusTypes.h"
 
+#include <QScopedPointer>
 #include <QSharedPointer>
 
+class SymmetricCipher;
+
 namespace Botan
 {
     class DH_PrivateKey;
@@ -36,6 +39,7 @@ namespace FdoSecrets
         CipherPair() = default;
         virtual ~CipherPair() = default;
         virtual Secret encrypt(const Secret& input) = 0;
+        virtual QList<Secret> encrypt(const QList<Secret>& inputs);
         virtual Secret decrypt(const Secret& input) = 0;
         virtual bool isValid() const = 0;
         virtual QVariant negotiationOutput() const = 0;
@@ -48,6 +52,7 @@ namespace FdoSecrets
         static constexpr const char Algorithm[] = "plain";
 
         PlainCipher() = default;
+        using CipherPair::encrypt;
         Secret encrypt(const Secret& input) override
         {
             return input;
@@ -75,8 +80,10 @@ namespace FdoSecrets
         static constexpr const char Algorithm[] = "dh-ietf1024-sha256-aes128-cbc-pkcs7";
 
         explicit DhIetf1024Sha256Aes128CbcPkcs7(const QByteArray& clientPublicKey);
+        ~DhIetf1024Sha256Aes128CbcPkcs7() override;
 
         Secret encrypt(const Secret& input) override;
+        QList<Secret> encrypt(const QList<Secret>& inputs) override;
         Secret decrypt(const Secret& input) override;
         bool isValid() const override;
         QVariant negotiationOutput() const override;
@@ -89,6 +96,8 @@ namespace FdoSecrets
         bool m_valid = false;
         QSharedPointer<Botan::DH_PrivateKey> m_privateKey;
         QByteArray m_aesKey;
+        // Keeps the expanded key between secrets
+        QScopedPointer<SymmetricCipher> m_encrypter;
     };
 
 } // namespace FdoSecrets
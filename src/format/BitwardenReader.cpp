@@ -30,11 +30,9 @@
 #include <botan/kdf.h>
 #include <botan/pwdhash.h>
 
+#include <QBuffer>
 #include <QFileInfo>
-#include <QJsonArray>
-#include <QJsonDocument>
 #include <QJsonObject>
-#include <QJsonParseError>
 #include <QMap>
 #include <QScopedPointer>
 #include <QUrl>
@@ -211,38 +209,86 @@ namespace
         return entry.take();
     }
 
-    void writeVaultToDatabase(const QJsonObject& vault, QSharedPointer<Database> db)
+    /**
+     * Read a vault object, creating the groups and entries as the items are read.
+     *
+     * @param reader reader positioned in front of the vault
+     * @param db database the groups are added to
+     * @param header set to all other members of the vault
+     * @return false on a parse error
+     */
+    bool writeVaultToDatabase(JsonStreamReader& reader, QSharedPointer<Database> db, QJsonObject& header)
     {
-        auto folderField = QString("folders");
-        if (!vault.contains(folderField)) {
-            // Handle Bitwarden organization vaults
-            folderField = "collections";
+        // Folders and collections are kept apart until it is known which ones the vault uses
+        QList<Group*> folders;
+        QList<Group*> collections;
+        QMap<QString, Group*> folderMap;
+        QMap<QString, Group*> collectionMap;
+        QList<QPair<Entry*, QString>> entries;
+        bool hasFolders = false;
+        bool hasCollections = false;
+        bool hasItems = false;
+
+        auto readGroups = [&reader](QList<Group*>& groups, QMap<QString, Group*>& groupMap) {
+            if (!reader.enterArray()) {
+                return;
+            }
+            while (reader.nextElement()) {
+                const auto folder = reader.readValue().toObject();
+                auto group = new Group();
+                group->setUuid(QUuid::createUuid());
+                group->setName(folder.value("name").toString());
+                groups.append(group);
+                groupMap.insert(folder.value("id").toString(), group);
+            }
+        };
+
+        QString key;
+        if (reader.enterObject()) {
+            while (reader.nextMember(key)) {
+                if (key == "folders") {
+                    hasFolders = true;
+                    readGroups(folders, folderMap);
+                } else if (key == "collections") {
+                    hasCollections = true;
+                    readGroups(collections, collectionMap);
+                } else if (key == "items") {
+                    hasItems = true;
+                    if (!reader.enterArray()) {
+                        break;
+                    }
+                    while (reader.nextElement()) {
+                        QString folderId;
+                        auto entry = readItem(reader.readValue().toObject(), folderId);
+                        entries.append({entry, folderId});
+                    }
+                } else {
+                    header.insert(key, reader.readValue());
+                }
+            }
         }
 
-        if (!vault.contains(folderField) || !vault.contains("items")) {
-            // Early out if the vault is missing critical items
-            return;
+        // Early out if the vault is missing critical items
+        if (!reader.finish() || (!hasFolders && !hasCollections) || !hasItems) {
+            for (const auto& entry : asConst(entries)) {
+                delete entry.first;
+            }
+            qDeleteAll(folders);
+            qDeleteAll(collections);
+            return !reader.hasError();
         }
 
-        // Create groups from folders and store a temporary map of id -> uuid
-        QMap<QString, Group*> folderMap;
-        for (const auto& folder : vault.value(folderField).toArray()) {
-            auto group = new Group();
-            group->setUuid(QUuid::createUuid());
-            group->setName(folder.toObject().value("name").toString());
+        // Bitwarden organization vaults use collections instead of folders
+        const auto& groups = hasFolders ? folders : collections;
+        const auto& groupMap = hasFolders ? folderMap : collectionMap;
+        qDeleteAll(hasFolders ? collections : folders);
+        for (auto group : groups) {
             group->setParent(db->rootGroup());
-
-            folderMap.insert(folder.toObject().value("id").toString(), group);
         }
-
-        QString folderId;
-        const auto items = vault.value("items").toArray();
-        for (const auto& item : items) {
-            auto entry = readItem(item.toObject(), folderId);
-            if (entry) {
-                entry->setGroup(folderMap.value(folderId, db->rootGroup()), false);
-            }
+        for (const auto& entry : asConst(entries)) {
+            entry.first->setGroup(groupMap.value(entry.second, db->rootGroup()), false);
         }
+        return true;
     }
 } // namespace
 
@@ -273,11 +319,15 @@ QSharedPointer<Database> BitwardenReader::convert(const QString& path, const QSt
         return {};
     }
 
-    QJsonParseError error;
-    auto json = QJsonDocument::fromJson(file.readAll(), &error).object();
-    if (error.error != QJsonParseError::NoError) {
-        m_error =
-            QObject::tr("Cannot parse file: %1 at position %2").arg(error.errorString(), QString::number(error.offset));
+    auto db = QSharedPointer<Database>::create();
+    db->rootGroup()->setName(QObject::tr("Bitwarden Import"));
+
+    QJsonObject json;
+    JsonStreamReader reader(&file);
+    reader.setProgressCallback(m_progress, file.size());
+    if (!writeVaultToDatabase(reader, db, json)) {
+        m_error = QObject::tr("Cannot parse file: %1 at position %2")
+                      .arg(reader.errorString(), QString::number(reader.errorOffset()));
         return {};
     }
 
@@ -387,17 +437,28 @@ QSharedPointer<Database> BitwardenReader::convert(const QString& path, const QSt
             return {};
         }
 
-        json = QJsonDocument::fromJson(data, &error).object();
-        if (error.error != QJsonParseError::NoError) {
-            m_error = buildError(error.errorString());
+        // The decrypted vault replaces the empty one of the encrypted export
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        JsonStreamReader decryptedReader(&buffer);
+        decryptedReader.setProgressCallback(m_progress, data.size());
+
+        db = QSharedPointer<Database>::create();
+        db->rootGroup()->setName(QObject::tr("Bitwarden Import"));
+        QJsonObject decryptedHeader;
+        if (!writeVaultToDatabase(decryptedReader, db, decryptedHeader)) {
+            m_error = buildError(decryptedReader.errorString());
             return {};
         }
     }
 
-    auto db = QSharedPointer<Database>::create();
-    db->rootGroup()->setName(QObject::tr("Bitwarden Import"));
-
-    writeVaultToDatabase(json, db);
-
     return db;
 }
+
+/**
+ * @param callback called with the percentage of the file read while converting
+ */
+void BitwardenReader::setProgressCallback(const JsonStreamReader::ProgressCallback& callback)
+{
+    m_progress = callback;
+}
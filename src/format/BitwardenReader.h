@@ -18,6 +18,8 @@
 #ifndef BITWARDEN_READER_H
 #define BITWARDEN_READER_H
 
+#include "format/JsonStreamReader.h"
+
 #include <QSharedPointer>
 
 class Database;
@@ -36,8 +38,11 @@ public:
     bool hasError();
     QString errorString();
 
+    void setProgressCallback(const JsonStreamReader::ProgressCallback& callback);
+
 private:
     QString m_error;
+    JsonStreamReader::ProgressCallback m_progress;
 };
 
 #endif // BITWARDEN_READER_H
@@ -18,10 +18,17 @@
 
 #include "CsvExporter.h"
 
+#include <QBuffer>
 #include <QFile>
 
 #include "core/Group.h"
 
+namespace
+{
+    // Lines are collected up to this size before they are written to the device
+    const int ChunkSize = 64 * 1024;
+} // namespace
+
 bool CsvExporter::exportDatabase(const QString& filename, const QSharedPointer<const Database>& db)
 {
     QFile file(filename);
@@ -34,22 +41,23 @@ bool CsvExporter::exportDatabase(const QString& filename, const QSharedPointer<c
 
 bool CsvExporter::exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db)
 {
-    if (device->write(exportHeader().toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
+    m_device = device;
+    m_chunk.clear();
 
-    if (device->write(exportGroup(db->rootGroup()).toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
+    const bool ok = write(exportHeader()) && writeGroup(db->rootGroup()) && flush();
 
-    return true;
+    m_device = nullptr;
+    m_chunk.clear();
+    return ok;
 }
 
 QString CsvExporter::exportDatabase(const QSharedPointer<const Database>& db)
 {
-    return exportHeader() + exportGroup(db->rootGroup());
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    exportDatabase(&buffer, db);
+    return QString::fromUtf8(data);
 }
 
 QString CsvExporter::errorString() const
@@ -73,9 +81,8 @@ QString CsvExporter::exportHeader()
     return header + QString("\n");
 }
 
-QString CsvExporter::exportGroup(const Group* group, QString groupPath)
+bool CsvExporter::writeGroup(const Group* group, QString groupPath)
 {
-    QString response;
     if (!groupPath.isEmpty()) {
         groupPath.append("/");
     }
@@ -97,15 +104,35 @@ QString CsvExporter::exportGroup(const Group* group, QString groupPath)
         addColumn(line, entry->timeInfo().creationTime().toString(Qt::ISODate));
 
         line.append("\n");
-        response.append(line);
+        if (!write(line)) {
+            return false;
+        }
     }
 
     const QList<Group*>& children = group->children();
     for (const Group* child : children) {
-        response.append(exportGroup(child, groupPath));
+        if (!writeGroup(child, groupPath)) {
+            return false;
+        }
     }
 
-    return response;
+    return true;
+}
+
+bool CsvExporter::write(const QString& text)
+{
+    m_chunk.append(text.toUtf8());
+    return m_chunk.size() < ChunkSize || flush();
+}
+
+bool CsvExporter::flush()
+{
+    if (!m_chunk.isEmpty() && m_device->write(m_chunk) == -1) {
+        m_error = m_device->errorString();
+        return false;
+    }
+    m_chunk.clear();
+    return true;
 }
 
 void CsvExporter::addColumn(QString& str, const QString& column)
@@ -35,11 +35,15 @@ public:
     QString errorString() const;
 
 private:
-    QString exportGroup(const Group* group, QString groupPath = QString());
+    bool writeGroup(const Group* group, QString groupPath = QString());
     QString exportHeader();
     void addColumn(QString& str, const QString& column);
+    bool write(const QString& text);
+    bool flush();
 
     QString m_error;
+    QIODevice* m_device = nullptr;
+    QByteArray m_chunk;
 };
 
 #endif // KEEPASSX_CSVEXPORTER_H
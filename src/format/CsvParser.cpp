@@ -21,26 +21,24 @@
 #include <QFile>
 #include <QTextCodec>
 
-#include "core/Tools.h"
+namespace
+{
+    // Bytes read from the device at a time, the rows are parsed as the blocks come in
+    const int READ_BLOCK_SIZE = 64 * 1024;
+} // namespace
 
 CsvParser::CsvParser()
-    : m_comment('#')
+    : m_codec(QTextCodec::codecForName("UTF-8"))
+    , m_comment('#')
     , m_isBackslashSyntax(false)
     , m_isFileLoaded(false)
     , m_qualifier('"')
     , m_separator(',')
 {
     reset();
-    m_csv.setBuffer(&m_array);
-    m_ts.setDevice(&m_csv);
-    m_csv.open(QIODevice::ReadOnly);
-    m_ts.setCodec("UTF-8");
 }
 
-CsvParser::~CsvParser()
-{
-    m_csv.close();
-}
+CsvParser::~CsvParser() = default;
 
 bool CsvParser::isFileLoaded()
 {
@@ -50,43 +48,60 @@ bool CsvParser::isFileLoaded()
 bool CsvParser::reparse()
 {
     reset();
-    return parseFile();
+    if (m_fileName.isEmpty()) {
+        return parseFile();
+    }
+    QFile device(m_fileName);
+    return openFile(&device) && parseFile();
 }
 
 bool CsvParser::parse(QFile* device)
+{
+    return parse(device, {});
+}
+
+/**
+ * Parse a device row by row.
+ *
+ * Rows handed to a callback are not kept in the table and are not filled up
+ * to the same number of columns, so files of any size can be processed.
+ *
+ * @param device file to parse
+ * @param callback called with every row, returns false to stop parsing; rows are stored in the table if empty
+ * @return false if the file could not be read or is malformed
+ */
+bool CsvParser::parse(QFile* device, const RowCallback& callback)
 {
     clear();
     if (!device) {
         appendStatusMsg(QObject::tr("NULL device"), true);
         return false;
     }
-    if (!readFile(device)) {
-        return false;
-    }
-    return parseFile();
+    m_fileName = device->fileName();
+    m_callback = callback;
+    const bool result = openFile(device) && parseFile();
+    m_callback = {};
+    return result;
 }
 
-bool CsvParser::readFile(QFile* device)
+bool CsvParser::openFile(QFile* device)
 {
     if (device->isOpen()) {
         device->close();
     }
 
-    device->open(QIODevice::ReadOnly);
-    if (!Tools::readAllFromDevice(device, m_array)) {
+    if (!device->open(QIODevice::ReadOnly)) {
         appendStatusMsg(QObject::tr("error reading from device"), true);
         m_isFileLoaded = false;
-    } else {
-        device->close();
-
-        m_array.replace("\r\n", "\n");
-        m_array.replace("\r", "\n");
-        if (m_array.isEmpty()) {
-            appendStatusMsg(QObject::tr("file empty").append("\n"));
-        }
-        m_isFileLoaded = true;
+        return false;
     }
-    return m_isFileLoaded;
+    m_device = device;
+    m_fileSize = device->size();
+    if (m_fileSize == 0) {
+        appendStatusMsg(QObject::tr("file empty").append("\n"));
+    }
+    m_isFileLoaded = true;
+    return true;
 }
 
 void CsvParser::reset()
@@ -96,11 +111,18 @@ void CsvParser::reset()
     m_currRow = 1;
     m_isEof = false;
     m_isGood = true;
-    m_lastPos = -1;
+    m_isTruncated = false;
     m_maxCols = 0;
+    m_rowCount = 0;
     m_statusMsg.clear();
-    m_ts.seek(0);
     m_table.clear();
+    m_device = nullptr;
+    m_decoder.reset();
+    m_buffer.clear();
+    m_pos = 0;
+    m_lastPos = -1;
+    m_mark = -1;
+    m_pendingCR = false;
     // the following can be overridden by the user
     // m_comment = '#';
     // m_backslashSyntax = false;
@@ -113,7 +135,8 @@ void CsvParser::clear()
 {
     reset();
     m_isFileLoaded = false;
-    m_array.clear();
+    m_fileName.clear();
+    m_fileSize = 0;
 }
 
 bool CsvParser::parseFile()
@@ -127,6 +150,10 @@ bool CsvParser::parseFile()
         m_currCol = 1;
         parseRecord();
     }
+    if (m_device) {
+        m_device->close();
+        m_device = nullptr;
+    }
     fillColumns();
     return m_isGood;
 }
@@ -150,11 +177,22 @@ void CsvParser::parseRecord()
         row.clear();
         return;
     }
-    m_table.push_back(row);
+    if (!m_callback && m_maxRows > 0 && m_table.size() >= m_maxRows) {
+        // Stop as if the end of the file was reached, the rest of the file is not read
+        m_isTruncated = true;
+        m_isEof = true;
+        return;
+    }
+    ++m_rowCount;
     if (m_maxCols < row.size()) {
         m_maxCols = row.size();
     }
     m_currCol++;
+    if (!m_callback) {
+        m_table.push_back(row);
+    } else if (!m_callback(row)) {
+        m_isEof = true;
+    }
 }
 
 void CsvParser::parseField(CsvRow& row)
@@ -173,15 +211,23 @@ void CsvParser::parseField(CsvRow& row)
 
 void CsvParser::parseSimple(QString& s)
 {
-    QChar c;
-    getChar(c);
-    while (c != '\n' && c != m_separator && !m_isEof) {
-        s.append(c);
-        getChar(c);
-    }
-    if (!m_isEof) {
-        ungetChar();
+    // Copy runs of plain characters at once instead of one character at a time
+    while (fetch()) {
+        const QChar* data = m_buffer.constData();
+        const int end = m_buffer.size();
+        const int start = m_pos;
+        while (m_pos < end && data[m_pos] != '\n' && data[m_pos] != m_separator) {
+            ++m_pos;
+        }
+        s.append(data + start, m_pos - start);
+        m_lastPos = m_pos - 1;
+        if (m_pos < end) {
+            // The separator or line end is left for the record, like after ungetChar()
+            m_lastPos = m_pos;
+            return;
+        }
     }
+    m_isEof = true;
 }
 
 void CsvParser::parseQuoted(QString& s)
@@ -207,11 +253,25 @@ void CsvParser::parseEscaped(QString& s)
 
 void CsvParser::parseEscapedText(QString& s)
 {
-    getChar(m_ch);
-    while (!isQualifier(m_ch) && !m_isEof) {
-        s.append(m_ch);
-        getChar(m_ch);
+    // Consumes the text up to and including the next qualifier, which is left in m_ch
+    while (fetch()) {
+        const QChar* data = m_buffer.constData();
+        const int end = m_buffer.size();
+        const int start = m_pos;
+        while (m_pos < end && !isQualifier(data[m_pos])) {
+            ++m_pos;
+        }
+        s.append(data + start, m_pos - start);
+        if (m_pos < end) {
+            m_lastPos = m_pos;
+            m_ch = data[m_pos++];
+            m_isEof = false;
+            return;
+        }
+        m_lastPos = end - 1;
+        m_ch = data[end - 1];
     }
+    m_isEof = true;
 }
 
 bool CsvParser::processEscapeMark(QString& s, QChar c)
@@ -266,8 +326,17 @@ void CsvParser::fillColumns()
 
 void CsvParser::skipLine()
 {
-    m_ts.readLine();
-    m_ts.seek(m_ts.pos() - 1);
+    // The line end is left for skipEndline()
+    while (fetch()) {
+        const int newline = m_buffer.indexOf('\n', m_pos);
+        if (newline >= 0) {
+            m_pos = newline;
+            m_lastPos = newline;
+            return;
+        }
+        m_pos = m_buffer.size();
+    }
+    m_isEof = true;
 }
 
 bool CsvParser::skipEndline()
@@ -276,21 +345,90 @@ bool CsvParser::skipEndline()
     return m_ch == '\n';
 }
 
+/**
+ * Make sure there is at least one character left in the buffer.
+ *
+ * The device is decoded block by block and line ends are converted to LF.
+ * Characters in front of the current position are dropped except for the last
+ * read one, which may be pushed back, and the ones behind a position saved in m_mark.
+ *
+ * @return false at the end of the device
+ */
+bool CsvParser::fetch()
+{
+    while (m_pos >= m_buffer.size()) {
+        if (!m_device) {
+            return false;
+        }
+
+        int keep = qMax(0, m_pos - 1);
+        if (m_lastPos >= 0) {
+            keep = qMin(keep, m_lastPos);
+        }
+        if (m_mark >= 0) {
+            keep = qMin(keep, m_mark);
+            m_mark -= keep;
+        }
+        m_buffer.remove(0, keep);
+        m_pos -= keep;
+        if (m_lastPos >= 0) {
+            m_lastPos -= keep;
+        }
+
+        const QByteArray block = m_device->read(READ_BLOCK_SIZE);
+        if (block.isEmpty()) {
+            if (m_device->error() != QFileDevice::NoError) {
+                appendStatusMsg(QObject::tr("error reading from device"), true);
+            }
+            m_device->close();
+            m_device = nullptr;
+            if (!m_pendingCR) {
+                return false;
+            }
+            m_pendingCR = false;
+            m_buffer.append('\n');
+            continue;
+        }
+
+        if (!m_decoder) {
+            // Byte order marks select the codec like in QTextStream
+            m_decoder.reset(QTextCodec::codecForUtfText(block, m_codec)->makeDecoder());
+        }
+        QString text = m_decoder->toUnicode(block);
+        if (m_pendingCR) {
+            text.prepend('\r');
+            m_pendingCR = false;
+        }
+        // A CR at the end of a block may be followed by a LF in the next one
+        if (text.endsWith('\r')) {
+            text.chop(1);
+            m_pendingCR = true;
+        }
+        text.replace("\r\n", "\n");
+        text.replace('\r', '\n');
+        m_buffer.append(text);
+    }
+    return true;
+}
+
 void CsvParser::getChar(QChar& c)
 {
-    m_isEof = m_ts.atEnd();
+    m_isEof = !fetch();
     if (!m_isEof) {
-        m_lastPos = m_ts.pos();
-        m_ts >> c;
+        m_lastPos = m_pos;
+        c = m_buffer.at(m_pos++);
     }
 }
 
 void CsvParser::ungetChar()
 {
-    if (!m_ts.seek(m_lastPos)) {
+    if (m_lastPos < 0) {
         qWarning("CSV Parser: unget lower bound exceeded");
         m_isGood = false;
+        return;
     }
+    // Goes back to the last read character, so ungetting twice has no further effect
+    m_pos = m_lastPos;
 }
 
 void CsvParser::peek(QChar& c)
@@ -313,7 +451,7 @@ bool CsvParser::isComment()
 {
     bool result = false;
     QChar c2;
-    qint64 pos = m_ts.pos();
+    m_mark = m_pos;
 
     do {
         getChar(c2);
@@ -322,7 +460,8 @@ bool CsvParser::isComment()
     if (c2 == m_comment) {
         result = true;
     }
-    m_ts.seek(pos);
+    m_pos = m_mark;
+    m_mark = -1;
     return result;
 }
 
@@ -341,6 +480,16 @@ void CsvParser::setBackslashSyntax(bool set)
     m_isBackslashSyntax = set;
 }
 
+void CsvParser::setMaxRows(int rows)
+{
+    m_maxRows = rows;
+}
+
+bool CsvParser::isTruncated() const
+{
+    return m_isTruncated;
+}
+
 void CsvParser::setComment(const QChar& c)
 {
     m_comment = c.unicode();
@@ -348,7 +497,10 @@ void CsvParser::setComment(const QChar& c)
 
 void CsvParser::setCodec(const QString& s)
 {
-    m_ts.setCodec(QTextCodec::codecForName(s.toLocal8Bit()));
+    auto codec = QTextCodec::codecForName(s.toLocal8Bit());
+    if (codec) {
+        m_codec = codec;
+    }
 }
 
 void CsvParser::setFieldSeparator(const QChar& c)
@@ -363,7 +515,7 @@ void CsvParser::setTextQualifier(const QChar& c)
 
 int CsvParser::getFileSize() const
 {
-    return m_csv.size();
+    return static_cast<int>(m_fileSize);
 }
 
 CsvTable CsvParser::getCsvTable() const
@@ -386,7 +538,7 @@ int CsvParser::getCsvCols() const
 
 int CsvParser::getCsvRows() const
 {
-    return m_table.size();
+    return m_rowCount;
 }
 
 void CsvParser::appendStatusMsg(const QString& s, bool isCritical)
@@ -19,8 +19,11 @@
 #ifndef KEEPASSX_CSVPARSER_H
 #define KEEPASSX_CSVPARSER_H
 
-#include <QBuffer>
-#include <QTextStream>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTextCodec>
+
+#include <functional>
 
 class QFile;
 
@@ -31,13 +34,21 @@ class CsvParser
 {
 
 public:
+    using RowCallback = std::function<bool(const CsvRow&)>;
+
     CsvParser();
     ~CsvParser();
     // read data from device and parse it
     bool parse(QFile* device);
+    // parse the device one row at a time without keeping the rows
+    bool parse(QFile* device, const RowCallback& callback);
     bool isFileLoaded();
-    // reparse the same buffer (device is not opened again)
+    // reparse the same file (the file is read again)
     bool reparse();
+    // stop parsing the table after this many rows
+    void setMaxRows(int rows);
+    // true if rows were left out of the table
+    bool isTruncated() const;
     void setCodec(const QString& s);
     void setComment(const QChar& c);
     void setFieldSeparator(const QChar& c);
@@ -53,8 +64,20 @@ protected:
     CsvTable m_table;
 
 private:
-    QByteArray m_array;
-    QBuffer m_csv;
+    QString m_fileName;
+    qint64 m_fileSize = 0;
+    QFile* m_device = nullptr;
+    QTextCodec* m_codec;
+    QScopedPointer<QTextDecoder> m_decoder;
+    // Decoded text with LF line ends, read ahead of m_pos
+    QString m_buffer;
+    int m_pos;
+    int m_lastPos;
+    int m_mark;
+    bool m_pendingCR;
+    RowCallback m_callback;
+    int m_maxRows = 0;
+    int m_rowCount;
     QChar m_ch;
     QChar m_comment;
     unsigned int m_currCol;
@@ -63,13 +86,13 @@ private:
     bool m_isEof;
     bool m_isFileLoaded;
     bool m_isGood;
-    qint64 m_lastPos;
+    bool m_isTruncated;
     int m_maxCols;
     QChar m_qualifier;
     QChar m_separator;
     QString m_statusMsg;
-    QTextStream m_ts;
 
+    bool fetch();
     void getChar(QChar& c);
     void ungetChar();
     void peek(QChar& c);
@@ -85,7 +108,7 @@ private:
     void parseQuoted(QString& s);
     void parseEscaped(QString& s);
     void parseEscapedText(QString& s);
-    bool readFile(QFile* device);
+    bool openFile(QFile* device);
     void reset();
     void clear();
     bool skipEndline();
@@ -0,0 +1,571 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "JsonStreamReader.h"
+
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+
+namespace
+{
+    // Nesting limit of QJsonDocument, deeper documents would exhaust the stack
+    const int MaxDepth = 1024;
+
+    void appendUtf8(QByteArray& utf8, uint code)
+    {
+        if (code < 0x80) {
+            utf8.append(static_cast<char>(code));
+        } else if (code < 0x800) {
+            utf8.append(static_cast<char>(0xC0 | (code >> 6)));
+            utf8.append(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            utf8.append(static_cast<char>(0xE0 | (code >> 12)));
+            utf8.append(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            utf8.append(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            utf8.append(static_cast<char>(0xF0 | (code >> 18)));
+            utf8.append(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            utf8.append(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            utf8.append(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    inline bool isHighSurrogate(uint code)
+    {
+        return code >= 0xD800 && code < 0xDC00;
+    }
+
+    inline bool isLowSurrogate(uint code)
+    {
+        return code >= 0xDC00 && code < 0xE000;
+    }
+} // namespace
+
+JsonStreamReader::JsonStreamReader(QIODevice* device)
+    : m_device(device)
+{
+}
+
+/**
+ * @param callback called whenever the read percentage changes
+ * @param totalSize size of the document in bytes
+ */
+void JsonStreamReader::setProgressCallback(const ProgressCallback& callback, qint64 totalSize)
+{
+    m_progress = callback;
+    m_totalSize = totalSize;
+}
+
+/**
+ * Enter the object at the current position, its members are read with nextMember().
+ *
+ * @return false if there is no object
+ */
+bool JsonStreamReader::enterObject()
+{
+    if (hasError() || !expect('{')) {
+        return false;
+    }
+    m_containers.append(false);
+    return true;
+}
+
+/**
+ * Move to the value of the next member of the entered object.
+ *
+ * @param key set to the key of the member
+ * @return false at the end of the object, which is left, or on an error
+ */
+bool JsonStreamReader::nextMember(QString& key)
+{
+    if (hasError() || m_containers.isEmpty()) {
+        return false;
+    }
+
+    char c;
+    if (!peek(c)) {
+        return setError(QObject::tr("unterminated object"));
+    }
+    if (c == '}') {
+        ++m_pos;
+        m_containers.removeLast();
+        return false;
+    }
+    if (m_containers.last()) {
+        if (c != ',' || !(++m_pos, peek(c))) {
+            return setError(QObject::tr("missing value separator"));
+        }
+    }
+    if (c != '"') {
+        return setError(QObject::tr("missing object key"));
+    }
+    if (!readString(&key) || !expect(':')) {
+        return false;
+    }
+    m_containers.last() = true;
+    return true;
+}
+
+/**
+ * Enter the array at the current position, its elements are read with nextElement().
+ *
+ * @return false if there is no array
+ */
+bool JsonStreamReader::enterArray()
+{
+    if (hasError() || !expect('[')) {
+        return false;
+    }
+    m_containers.append(false);
+    return true;
+}
+
+/**
+ * Move to the next element of the entered array.
+ *
+ * @return false at the end of the array, which is left, or on an error
+ */
+bool JsonStreamReader::nextElement()
+{
+    if (hasError() || m_containers.isEmpty()) {
+        return false;
+    }
+
+    char c;
+    if (!peek(c)) {
+        return setError(QObject::tr("unterminated array"));
+    }
+    if (c == ']') {
+        ++m_pos;
+        m_containers.removeLast();
+        return false;
+    }
+    if (m_containers.last()) {
+        if (c != ',') {
+            return setError(QObject::tr("missing value separator"));
+        }
+        ++m_pos;
+    }
+    m_containers.last() = true;
+    return true;
+}
+
+/**
+ * Read the value at the current position as a whole.
+ *
+ * @return value, undefined on an error
+ */
+QJsonValue JsonStreamReader::readValue()
+{
+    QJsonValue value;
+    if (hasError() || !readValue(0, &value)) {
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    return value;
+}
+
+/**
+ * Skip the value at the current position without building it.
+ *
+ * @return false on an error
+ */
+bool JsonStreamReader::skipValue()
+{
+    return !hasError() && readValue(0, nullptr);
+}
+
+/**
+ * Check that only whitespace follows the document.
+ *
+ * @return false on an error or trailing garbage
+ */
+bool JsonStreamReader::finish()
+{
+    char c;
+    if (hasError()) {
+        return false;
+    }
+    if (peek(c)) {
+        return setError(QObject::tr("garbage at the end of the document"));
+    }
+    return true;
+}
+
+bool JsonStreamReader::hasError() const
+{
+    return !m_error.isEmpty();
+}
+
+QString JsonStreamReader::errorString() const
+{
+    return m_error;
+}
+
+/**
+ * @return byte offset of the error in the document
+ */
+qint64 JsonStreamReader::errorOffset() const
+{
+    return m_errorOffset;
+}
+
+bool JsonStreamReader::fill()
+{
+    if (m_pos < m_buffer.size()) {
+        return true;
+    }
+
+    m_offset += m_buffer.size();
+    m_buffer = m_device->read(BlockSize);
+    m_pos = 0;
+    if (!m_started) {
+        m_started = true;
+        if (m_buffer.startsWith("\xEF\xBB\xBF")) {
+            m_pos = 3;
+        }
+    }
+
+    if (m_progress && m_totalSize > 0) {
+        const auto percent = static_cast<int>(qMin<qint64>(100, (m_offset + m_buffer.size()) * 100 / m_totalSize));
+        if (percent != m_lastPercent) {
+            m_lastPercent = percent;
+            m_progress(percent);
+        }
+    }
+    return m_pos < m_buffer.size();
+}
+
+/**
+ * @param c set to the next character that is not whitespace, which is not consumed
+ * @return false at the end of the document
+ */
+bool JsonStreamReader::peek(char& c)
+{
+    while (fill()) {
+        const char next = m_buffer.at(m_pos);
+        if (next != ' ' && next != '\t' && next != '\n' && next != '\r') {
+            c = next;
+            return true;
+        }
+        ++m_pos;
+    }
+    return false;
+}
+
+bool JsonStreamReader::expect(char c)
+{
+    char next;
+    if (!peek(next)) {
+        return setError(QObject::tr("unexpected end of document"));
+    }
+    if (next != c) {
+        return setError(QObject::tr("'%1' expected").arg(QLatin1Char(c)));
+    }
+    ++m_pos;
+    return true;
+}
+
+bool JsonStreamReader::readValue(int depth, QJsonValue* value)
+{
+    if (depth > MaxDepth) {
+        return setError(QObject::tr("too deeply nested document"));
+    }
+
+    char c;
+    if (!peek(c)) {
+        return setError(QObject::tr("unexpected end of document"));
+    }
+
+    switch (c) {
+    case '{': {
+        ++m_pos;
+        QJsonObject object;
+        bool first = true;
+        forever {
+            if (!peek(c)) {
+                return setError(QObject::tr("unterminated object"));
+            }
+            if (c == '}') {
+                ++m_pos;
+                break;
+            }
+            if (!first && (c != ',' || !(++m_pos, peek(c)))) {
+                return setError(QObject::tr("missing value separator"));
+            }
+            if (c != '"') {
+                return setError(QObject::tr("missing object key"));
+            }
+            QString key;
+            QJsonValue member;
+            if (!readString(value ? &key : nullptr) || !expect(':')
+                || !readValue(depth + 1, value ? &member : nullptr)) {
+                return false;
+            }
+            if (value) {
+                object.insert(key, member);
+            }
+            first = false;
+        }
+        if (value) {
+            *value = object;
+        }
+        return true;
+    }
+    case '[': {
+        ++m_pos;
+        QJsonArray array;
+        bool first = true;
+        forever {
+            if (!peek(c)) {
+                return setError(QObject::tr("unterminated array"));
+            }
+            if (c == ']') {
+                ++m_pos;
+                break;
+            }
+            if (!first) {
+                if (c != ',') {
+                    return setError(QObject::tr("missing value separator"));
+                }
+                ++m_pos;
+            }
+            QJsonValue element;
+            if (!readValue(depth + 1, value ? &element : nullptr)) {
+                return false;
+            }
+            if (value) {
+                array.append(element);
+            }
+            first = false;
+        }
+        if (value) {
+            *value = array;
+        }
+        return true;
+    }
+    case '"': {
+        QString string;
+        if (!readString(value ? &string : nullptr)) {
+            return false;
+        }
+        if (value) {
+            *value = string;
+        }
+        return true;
+    }
+    case 't':
+        if (value) {
+            *value = true;
+        }
+        return readLiteral("true");
+    case 'f':
+        if (value) {
+            *value = false;
+        }
+        return readLiteral("false");
+    case 'n':
+        if (value) {
+            *value = QJsonValue(QJsonValue::Null);
+        }
+        return readLiteral("null");
+    default:
+        return readNumber(value);
+    }
+}
+
+/**
+ * Read the string at the current position, which starts with a quote.
+ *
+ * @param string set to the string, nullptr to skip it
+ */
+bool JsonStreamReader::readString(QString* string)
+{
+    // Skip the opening quote
+    ++m_pos;
+
+    // Runs of unescaped characters are copied at once and decoded at the end,
+    // so multibyte sequences may be split across blocks
+    QByteArray utf8;
+    forever {
+        if (!fill()) {
+            return setError(QObject::tr("unterminated string"));
+        }
+        const char* data = m_buffer.constData();
+        const int end = m_buffer.size();
+        int pos = m_pos;
+        while (pos < end && data[pos] != '"' && data[pos] != '\\') {
+            ++pos;
+        }
+        if (string) {
+            utf8.append(data + m_pos, pos - m_pos);
+        }
+        m_pos = pos;
+        if (pos == end) {
+            continue;
+        }
+
+        ++m_pos;
+        if (data[pos] == '"') {
+            break;
+        }
+        if (!readEscape(utf8)) {
+            return false;
+        }
+    }
+
+    if (string) {
+        *string = QString::fromUtf8(utf8);
+    }
+    return true;
+}
+
+bool JsonStreamReader::readEscape(QByteArray& utf8)
+{
+    if (!fill()) {
+        return setError(QObject::tr("unterminated string"));
+    }
+
+    const char c = m_buffer.at(m_pos++);
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+        utf8.append(c);
+        return true;
+    case 'b':
+        utf8.append('\b');
+        return true;
+    case 'f':
+        utf8.append('\f');
+        return true;
+    case 'n':
+        utf8.append('\n');
+        return true;
+    case 'r':
+        utf8.append('\r');
+        return true;
+    case 't':
+        utf8.append('\t');
+        return true;
+    case 'u':
+        break;
+    default:
+        return setError(QObject::tr("invalid escape sequence"));
+    }
+
+    uint code;
+    if (!readHex(code)) {
+        return false;
+    }
+    if (isHighSurrogate(code)) {
+        // Characters outside of the BMP are escaped as surrogate pairs
+        if (!fill() || m_buffer.at(m_pos) != '\\') {
+            appendUtf8(utf8, 0xFFFD);
+            return true;
+        }
+        ++m_pos;
+        if (!fill()) {
+            return setError(QObject::tr("unterminated string"));
+        }
+        if (m_buffer.at(m_pos) != 'u') {
+            appendUtf8(utf8, 0xFFFD);
+            return readEscape(utf8);
+        }
+        ++m_pos;
+        uint low;
+        if (!readHex(low)) {
+            return false;
+        }
+        if (isLowSurrogate(low)) {
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        } else {
+            appendUtf8(utf8, 0xFFFD);
+            code = isHighSurrogate(low) ? 0xFFFD : low;
+        }
+    } else if (isLowSurrogate(code)) {
+        code = 0xFFFD;
+    }
+    appendUtf8(utf8, code);
+    return true;
+}
+
+bool JsonStreamReader::readHex(uint& code)
+{
+    code = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (!fill()) {
+            return setError(QObject::tr("unterminated string"));
+        }
+        const char c = m_buffer.at(m_pos++);
+        code <<= 4;
+        if (c >= '0' && c <= '9') {
+            code |= static_cast<uint>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            code |= static_cast<uint>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            code |= static_cast<uint>(c - 'A' + 10);
+        } else {
+            return setError(QObject::tr("invalid escape sequence"));
+        }
+    }
+    return true;
+}
+
+bool JsonStreamReader::readNumber(QJsonValue* value)
+{
+    QByteArray number;
+    while (fill()) {
+        const char c = m_buffer.at(m_pos);
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+            break;
+        }
+        number.append(c);
+        ++m_pos;
+    }
+
+    bool ok = false;
+    const double parsed = number.toDouble(&ok);
+    if (!ok) {
+        return setError(QObject::tr("illegal value"));
+    }
+    if (value) {
+        *value = parsed;
+    }
+    return true;
+}
+
+bool JsonStreamReader::readLiteral(const char* literal)
+{
+    for (const char* c = literal; *c; ++c) {
+        if (!fill() || m_buffer.at(m_pos) != *c) {
+            return setError(QObject::tr("illegal value"));
+        }
+        ++m_pos;
+    }
+    return true;
+}
+
+bool JsonStreamReader::setError(const QString& error)
+{
+    if (m_error.isEmpty()) {
+        m_error = error;
+        m_errorOffset = m_offset + m_pos;
+    }
+    return false;
+}
@@ -0,0 +1,95 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_JSONSTREAMREADER_H
+#define KEEPASSXC_JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+class QIODevice;
+
+/**
+ * Pull parser reading a JSON document from a device in blocks.
+ *
+ * Objects and arrays are entered and walked one member or element at a time,
+ * and only the values asked for with readValue() are built as QJsonValue, so
+ * large exports are never held in memory as a whole document.
+ *
+ *     reader.enterObject();
+ *     while (reader.nextMember(key)) {
+ *         // every member value has to be consumed
+ *         auto value = reader.readValue();
+ *     }
+ *     if (reader.hasError()) ...
+ */
+class JsonStreamReader
+{
+public:
+    // Called with the percentage of the document read so far
+    using ProgressCallback = std::function<void(int)>;
+
+    static const int BlockSize = 64 * 1024;
+
+    explicit JsonStreamReader(QIODevice* device);
+
+    void setProgressCallback(const ProgressCallback& callback, qint64 totalSize);
+
+    bool enterObject();
+    bool nextMember(QString& key);
+    bool enterArray();
+    bool nextElement();
+    QJsonValue readValue();
+    bool skipValue();
+    bool finish();
+
+    bool hasError() const;
+    QString errorString() const;
+    qint64 errorOffset() const;
+
+private:
+    bool fill();
+    bool peek(char& c);
+    bool expect(char c);
+    bool readValue(int depth, QJsonValue* value);
+    bool readString(QString* string);
+    bool readEscape(QByteArray& utf8);
+    bool readHex(uint& code);
+    bool readNumber(QJsonValue* value);
+    bool readLiteral(const char* literal);
+    bool setError(const QString& error);
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    int m_pos = 0;
+    // Bytes of the document in front of the buffer
+    qint64 m_offset = 0;
+    bool m_started = false;
+    // Whether a member or element was read per entered object or array
+    QVector<bool> m_containers;
+    QString m_error;
+    qint64 m_errorOffset = -1;
+    ProgressCallback m_progress;
+    qint64 m_totalSize = 0;
+    int m_lastPercent = -1;
+};
+
+#endif // KEEPASSXC_JSONSTREAMREADER_H
@@ -113,6 +113,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
     Q_ASSERT(xmlDevice);
 
     KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_3_1);
+    xmlReader.setSkipHistory(m_skipHistory);
     xmlReader.readDatabase(xmlDevice, db, &randomStream);
 
     if (xmlReader.hasError()) {
@@ -20,18 +20,20 @@
 
 #include <QBuffer>
 
+#include "core/Metadata.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/Random.h"
 #include "format/KdbxXmlWriter.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/HashedBlockStream.h"
+#include "streams/ParallelGzipStream.h"
 #include "streams/SymmetricCipherStream.h"
-#include "streams/qtiocompressor.h"
 
-bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
+bool Kdbx3Writer::snapshotDatabase(Database* db)
 {
     m_error = false;
     m_errorStr.clear();
+    clearSnapshot();
 
     auto mode = SymmetricCipher::cipherUuidToMode(db->cipher());
     int ivSize = SymmetricCipher::defaultIvSize(mode);
@@ -40,30 +42,21 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
         return false;
     }
 
-    QByteArray masterSeed = randomGen()->randomArray(32);
-    QByteArray encryptionIV = randomGen()->randomArray(ivSize);
+    m_cipher = db->cipher();
+    m_compressed = db->compressionAlgorithm() != Database::CompressionNone;
+    m_compressionLevel = db->metadata()->compressionLevel();
+    m_masterSeed = randomGen()->randomArray(32);
+    m_encryptionIV = randomGen()->randomArray(ivSize);
+    m_startBytes = randomGen()->randomArray(32);
     QByteArray protectedStreamKey = randomGen()->randomArray(32);
-    QByteArray startBytes = randomGen()->randomArray(32);
     QByteArray endOfHeader = "\r\n\r\n";
 
-    if (!db->challengeMasterSeed(masterSeed)) {
-        raiseError(tr("Unable to issue challenge-response: %1").arg(db->keyError()));
-        return false;
-    }
-
-    if (!db->setKey(db->key(), false, true)) {
-        raiseError(tr("Unable to calculate database key"));
-        return false;
+    // The key is derived from the new seed when the snapshot is written
+    auto kdf = db->kdf();
+    if (!m_keepKdfSeed) {
+        kdf->randomizeSeed();
     }
 
-    // generate transformed database key
-    CryptoHash hash(CryptoHash::Sha256);
-    hash.addData(masterSeed);
-    hash.addData(db->challengeResponseKey());
-    Q_ASSERT(!db->transformedDatabaseKey().isEmpty());
-    hash.addData(db->transformedDatabaseKey());
-    QByteArray finalKey = hash.result();
-
     // write header
     QBuffer header;
     header.open(QIODevice::WriteOnly);
@@ -75,16 +68,15 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
         writeHeaderField<quint16>(&header,
                                   KeePass2::HeaderFieldID::CompressionFlags,
                                   Endian::sizedIntToBytes<qint32>(db->compressionAlgorithm(), KeePass2::BYTEORDER)));
-    auto kdf = db->kdf();
-    CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::MasterSeed, masterSeed));
+    CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::MasterSeed, m_masterSeed));
     CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::TransformSeed, kdf->seed()));
     CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header,
                                                  KeePass2::HeaderFieldID::TransformRounds,
                                                  Endian::sizedIntToBytes<qint64>(kdf->rounds(), KeePass2::BYTEORDER)));
-    CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::EncryptionIV, encryptionIV));
+    CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::EncryptionIV, m_encryptionIV));
     CHECK_RETURN_FALSE(
         writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::ProtectedStreamKey, protectedStreamKey));
-    CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::StreamStartBytes, startBytes));
+    CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::StreamStartBytes, m_startBytes));
     CHECK_RETURN_FALSE(writeHeaderField<quint16>(
         &header,
         KeePass2::HeaderFieldID::InnerRandomStreamID,
@@ -92,36 +84,78 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
                                         KeePass2::BYTEORDER)));
     CHECK_RETURN_FALSE(writeHeaderField<quint16>(&header, KeePass2::HeaderFieldID::EndOfHeader, endOfHeader));
     header.close();
-
-    // write header data
-    CHECK_RETURN_FALSE(writeData(device, header.data()));
+    m_header = header.data();
 
     // hash header
-    const QByteArray headerHash = CryptoHash::hash(header.data(), CryptoHash::Sha256);
+    const QByteArray headerHash = CryptoHash::hash(m_header, CryptoHash::Sha256);
+
+    // write XML payload
+    QBuffer payload(&m_payload);
+    payload.open(QIODevice::WriteOnly);
+
+    KeePass2RandomStream randomStream;
+    if (!randomStream.init(SymmetricCipher::Salsa20, protectedStreamKey)) {
+        raiseError(randomStream.errorString());
+        return false;
+    }
+
+    KdbxXmlWriter xmlWriter(db->formatVersion());
+    xmlWriter.writeDatabase(&payload, db, &randomStream, headerHash);
+    if (xmlWriter.hasError()) {
+        raiseError(xmlWriter.errorString());
+        return false;
+    }
+
+    m_hasSnapshot = true;
+    return true;
+}
+
+bool Kdbx3Writer::writeSnapshot(QIODevice* device, Database* db)
+{
+    if (!db->challengeMasterSeed(m_masterSeed)) {
+        raiseError(tr("Unable to issue challenge-response: %1").arg(db->keyError()));
+        return false;
+    }
+
+    if (!db->setKey(db->key(), false, false)) {
+        raiseError(tr("Unable to calculate database key"));
+        return false;
+    }
+
+    // generate transformed database key
+    CryptoHash hash(CryptoHash::Sha256);
+    hash.addData(m_masterSeed);
+    hash.addData(db->challengeResponseKey());
+    Q_ASSERT(!db->transformedDatabaseKey().isEmpty());
+    hash.addData(db->transformedDatabaseKey());
+    QByteArray finalKey = hash.result();
+
+    // write header data
+    CHECK_RETURN_FALSE(writeData(device, m_header));
 
     // write cipher stream
     SymmetricCipherStream cipherStream(device);
-    cipherStream.init(mode, SymmetricCipher::Encrypt, finalKey, encryptionIV);
+    cipherStream.init(SymmetricCipher::cipherUuidToMode(m_cipher), SymmetricCipher::Encrypt, finalKey, m_encryptionIV);
     if (!cipherStream.open(QIODevice::WriteOnly)) {
         raiseError(cipherStream.errorString());
         return false;
     }
-    CHECK_RETURN_FALSE(writeData(&cipherStream, startBytes));
+    CHECK_RETURN_FALSE(writeData(&cipherStream, m_startBytes));
 
-    HashedBlockStream hashedStream(&cipherStream);
+    HashedBlockStream hashedStream(&cipherStream,
+                                   m_blockSize > 0 ? m_blockSize : HashedBlockStream::DefaultBlockSize);
     if (!hashedStream.open(QIODevice::WriteOnly)) {
         raiseError(hashedStream.errorString());
         return false;
     }
 
     QIODevice* outputDevice = nullptr;
-    QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<ParallelGzipStream> ioCompressor;
 
-    if (db->compressionAlgorithm() == Database::CompressionNone) {
+    if (!m_compressed) {
         outputDevice = &hashedStream;
     } else {
-        ioCompressor.reset(new QtIOCompressor(&hashedStream));
-        ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+        ioCompressor.reset(new ParallelGzipStream(&hashedStream, m_compressionLevel));
         if (!ioCompressor->open(QIODevice::WriteOnly)) {
             raiseError(ioCompressor->errorString());
             return false;
@@ -131,14 +165,7 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
 
     Q_ASSERT(outputDevice);
 
-    KeePass2RandomStream randomStream;
-    if (!randomStream.init(SymmetricCipher::Salsa20, protectedStreamKey)) {
-        raiseError(randomStream.errorString());
-        return false;
-    }
-
-    KdbxXmlWriter xmlWriter(db->formatVersion());
-    xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
+    CHECK_RETURN_FALSE(writePayload(outputDevice));
 
     // Explicitly close/reset streams so they are flushed and we can detect
     // errors. QIODevice::close() resets errorString() etc.
@@ -154,10 +181,5 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
         return false;
     }
 
-    if (xmlWriter.hasError()) {
-        raiseError(xmlWriter.errorString());
-        return false;
-    }
-
     return true;
 }
@@ -28,7 +28,13 @@ class Kdbx3Writer : public KdbxWriter
     Q_DECLARE_TR_FUNCTIONS(Kdbx3Writer)
 
 public:
-    bool writeDatabase(QIODevice* device, Database* db) override;
+    bool snapshotDatabase(Database* db) override;
+
+protected:
+    bool writeSnapshot(QIODevice* device, Database* db) override;
+
+private:
+    QByteArray m_startBytes;
 };
 
 #endif // KEEPASSX_KDBX3WRITER_H
@@ -17,20 +17,171 @@
 
 #include "Kdbx4Reader.h"
 
+#include <algorithm>
+
 #include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
 #include <QJsonObject>
+#include <QThread>
 
 #include "core/AsyncTask.h"
 #include "core/Endian.h"
+#include "core/EntryAttachments.h"
+#include "core/Global.h"
 #include "core/Group.h"
+#include "core/PerformanceStats.h"
 #include "crypto/CryptoHash.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/HmacBlockStream.h"
+#include "streams/ReadAheadStream.h"
 #include "streams/StoreDataStream.h"
 #include "streams/SymmetricCipherStream.h"
 #include "streams/qtiocompressor.h"
 
+namespace
+{
+    // HMAC blocks verified concurrently, each one holds up to 1 MiB of the payload
+    const int MaxVerifyAheadBlocks = 8;
+
+    bool skipData(QIODevice* device, qint64 length)
+    {
+        QByteArray scratch;
+        while (length > 0) {
+            scratch.resize(static_cast<int>(qMin<qint64>(length, 64 * 1024)));
+            qint64 bytesRead = device->read(scratch.data(), scratch.size());
+            if (bytesRead <= 0) {
+                return false;
+            }
+            length -= bytesRead;
+        }
+        return true;
+    }
+
+    /**
+     * Re-reads inner header binaries from the database file on demand.
+     *
+     * The payload is a single encrypted and compressed stream, so every load
+     * decrypts the file up to the requested binary. Use prefetchAll() to read
+     * all binaries in one pass before serializing the whole database.
+     */
+    class Kdbx4AttachmentLoader : public AttachmentLoader
+    {
+    public:
+        QString filePath;
+        qint64 fileSize = 0;
+        QDateTime lastModified;
+        qint64 payloadOffset = 0;
+        QByteArray hmacKey;
+        QByteArray finalKey;
+        QByteArray encryptionIV;
+        SymmetricCipher::Mode mode = SymmetricCipher::InvalidMode;
+        bool compressed = false;
+        QVector<QPair<qint64, int>> binaries;
+
+        QByteArray load(int index) override
+        {
+            if (m_prefetched.contains(index)) {
+                return m_prefetched.value(index);
+            }
+            return read({index}).value(index);
+        }
+
+        void prefetchAll() override
+        {
+            QList<int> indexes;
+            for (int i = 0; i < binaries.size(); ++i) {
+                if (!m_prefetched.contains(i)) {
+                    indexes.append(i);
+                }
+            }
+            const auto data = read(indexes);
+            for (auto it = data.constBegin(); it != data.constEnd(); ++it) {
+                m_prefetched.insert(it.key(), it.value());
+            }
+        }
+
+        void releasePrefetched() override
+        {
+            m_prefetched.clear();
+        }
+
+        QString errorString() const override
+        {
+            return m_errorString;
+        }
+
+    private:
+        QHash<int, QByteArray> read(const QList<int>& indexes) const
+        {
+            QHash<int, QByteArray> result;
+            m_errorString.clear();
+
+            QFileInfo fileInfo(filePath);
+            if (fileInfo.size() != fileSize || fileInfo.lastModified() != lastModified) {
+                m_errorString = Kdbx4Reader::tr("The database file was changed on disk since it was opened.");
+                return result;
+            }
+
+            QFile file(filePath);
+            if (!file.open(QIODevice::ReadOnly) || !file.seek(payloadOffset)) {
+                m_errorString = Kdbx4Reader::tr("Unable to reopen the database file: %1").arg(file.errorString());
+                return result;
+            }
+
+            HmacBlockStream hmacStream(&file, hmacKey);
+            SymmetricCipherStream cipherStream(&hmacStream);
+            if (!hmacStream.open(QIODevice::ReadOnly)
+                || !cipherStream.init(mode, SymmetricCipher::Decrypt, finalKey, encryptionIV)
+                || !cipherStream.open(QIODevice::ReadOnly)) {
+                m_errorString =
+                    Kdbx4Reader::tr("Unable to decrypt the database file: %1").arg(cipherStream.errorString());
+                return result;
+            }
+
+            QIODevice* device = &cipherStream;
+            QScopedPointer<QtIOCompressor> ioCompressor;
+            if (compressed) {
+                ioCompressor.reset(new QtIOCompressor(&cipherStream));
+                ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+                if (!ioCompressor->open(QIODevice::ReadOnly)) {
+                    m_errorString = ioCompressor->errorString();
+                    return result;
+                }
+                device = ioCompressor.data();
+            }
+
+            // Binaries are stored in index order, so a single forward pass reads all of them
+            QList<int> sortedIndexes = indexes;
+            std::sort(sortedIndexes.begin(), sortedIndexes.end());
+
+            qint64 position = 0;
+            for (int index : asConst(sortedIndexes)) {
+                const auto& binary = binaries.at(index);
+                QByteArray data;
+                if (skipData(device, binary.first - position)) {
+                    data = device->read(binary.second);
+                }
+                if (data.size() != binary.second) {
+                    m_errorString = device->errorString().isEmpty()
+                                        ? Kdbx4Reader::tr("The database file ends before the attachment data.")
+                                        : device->errorString();
+                    break;
+                }
+                position = binary.first + binary.second;
+                result.insert(index, data);
+            }
+
+            return result;
+        }
+
+        QHash<int, QByteArray> m_prefetched;
+        mutable QString m_errorString;
+    };
+} // namespace
+
 bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
                                    const QByteArray& headerData,
                                    QSharedPointer<const CompositeKey> key,
@@ -39,6 +190,10 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     Q_ASSERT((db->formatVersion() & KeePass2::FILE_VERSION_CRITICAL_MASK) == KeePass2::FILE_VERSION_4);
 
     m_binaryPool.clear();
+    m_innerHeaderOffset = 0;
+    m_deferredBinaries.clear();
+    // Deferring requires a regular file that can be re-read later
+    m_deferringBinaries = m_deferAttachments && qobject_cast<QFile*>(device);
 
     if (hasError()) {
         return false;
@@ -56,6 +211,9 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         return false;
     }
 
+    // Decryption, decompression and parsing run as one pipeline and are timed together
+    PerformanceStats::ScopedTimer timer("kdbx4.read-payload");
+
     CryptoHash hash(CryptoHash::Sha256);
     hash.addData(m_masterSeed);
     hash.addData(db->transformedDatabaseKey());
@@ -79,6 +237,7 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
                       "If this reoccurs, then your database file may be corrupt.") + " " + tr("(HMAC mismatch)"));
         return false;
     }
+    const qint64 payloadOffset = device->pos();
     HmacBlockStream hmacStream(device, hmacKey);
     if (!hmacStream.open(QIODevice::ReadOnly)) {
         raiseError(hmacStream.errorString());
@@ -90,7 +249,25 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         raiseError(tr("Unknown cipher"));
         return false;
     }
-    SymmetricCipherStream cipherStream(&hmacStream);
+
+    // For payloads spanning multiple HMAC blocks, verify and decrypt on worker threads
+    // ahead of the decompressor and XML parser instead of running all stages in series
+    bool pipelined =
+        !device->isSequential() && device->size() - device->pos() > 2 * ReadAheadStream::DefaultBlockSize;
+
+    QIODevice* cipherSource = &hmacStream;
+    QScopedPointer<ReadAheadStream> hmacReadAhead;
+    if (pipelined) {
+        hmacStream.setVerifyAhead(qBound(2, QThread::idealThreadCount(), MaxVerifyAheadBlocks));
+        hmacReadAhead.reset(new ReadAheadStream(&hmacStream));
+        if (!hmacReadAhead->open(QIODevice::ReadOnly)) {
+            raiseError(hmacReadAhead->errorString());
+            return false;
+        }
+        cipherSource = hmacReadAhead.data();
+    }
+
+    SymmetricCipherStream cipherStream(cipherSource);
     if (!cipherStream.init(mode, SymmetricCipher::Decrypt, finalKey, m_encryptionIV)) {
         raiseError(cipherStream.errorString());
         return false;
@@ -101,13 +278,24 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     }
     // clang-format on
 
+    QIODevice* plainDevice = &cipherStream;
+    QScopedPointer<ReadAheadStream> cipherReadAhead;
+    if (pipelined) {
+        cipherReadAhead.reset(new ReadAheadStream(&cipherStream));
+        if (!cipherReadAhead->open(QIODevice::ReadOnly)) {
+            raiseError(cipherReadAhead->errorString());
+            return false;
+        }
+        plainDevice = cipherReadAhead.data();
+    }
+
     QIODevice* xmlDevice = nullptr;
     QScopedPointer<QtIOCompressor> ioCompressor;
 
     if (db->compressionAlgorithm() == Database::CompressionNone) {
-        xmlDevice = &cipherStream;
+        xmlDevice = plainDevice;
     } else {
-        ioCompressor.reset(new QtIOCompressor(&cipherStream));
+        ioCompressor.reset(new QtIOCompressor(plainDevice));
         ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
         if (!ioCompressor->open(QIODevice::ReadOnly)) {
             raiseError(ioCompressor->errorString());
@@ -144,6 +332,30 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     Q_ASSERT(xmlDevice);
 
     KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_4, binaryPool());
+    xmlReader.setSkipHistory(m_skipHistory);
+
+    auto file = qobject_cast<QFile*>(device);
+    if (m_deferringBinaries && file && !m_deferredBinaries.isEmpty()) {
+        QFileInfo fileInfo(file->fileName());
+        auto loader = QSharedPointer<Kdbx4AttachmentLoader>::create();
+        loader->filePath = fileInfo.absoluteFilePath();
+        loader->fileSize = fileInfo.size();
+        loader->lastModified = fileInfo.lastModified();
+        loader->payloadOffset = payloadOffset;
+        loader->hmacKey = hmacKey;
+        loader->finalKey = finalKey;
+        loader->encryptionIV = m_encryptionIV;
+        loader->mode = SymmetricCipher::cipherUuidToMode(db->cipher());
+        loader->compressed = db->compressionAlgorithm() != Database::CompressionNone;
+        loader->binaries = m_deferredBinaries;
+
+        QHash<QString, DeferredAttachment> deferredBinaries;
+        for (int i = 0; i < m_deferredBinaries.size(); ++i) {
+            deferredBinaries.insert(QString::number(i), {loader, i, m_deferredBinaries.at(i).second});
+        }
+        xmlReader.setDeferredBinaries(deferredBinaries);
+        db->setAttachmentLoader(loader);
+    }
     xmlReader.readDatabase(xmlDevice, db, &randomStream);
 
     if (xmlReader.hasError()) {
@@ -265,6 +477,21 @@ bool Kdbx4Reader::readInnerHeaderField(QIODevice* device)
         return false;
     }
 
+    // Offset of the field payload within the decrypted stream
+    const qint64 fieldOffset = m_innerHeaderOffset + 5;
+    m_innerHeaderOffset = fieldOffset + fieldLen;
+
+    // Only remember where deferred binaries are located instead of keeping them in memory
+    if (fieldID == KeePass2::InnerHeaderFieldID::Binary && fieldLen > 0 && m_deferringBinaries) {
+        if (device->read(1).size() != 1 || !skipData(device, fieldLen - 1)) {
+            raiseError(tr("Invalid inner header binary size"));
+            return false;
+        }
+        m_deferredBinaries.append(qMakePair(fieldOffset + 1, static_cast<int>(fieldLen - 1)));
+        m_binaryPool.insert(QString::number(m_binaryPool.size()), QByteArray());
+        return true;
+    }
+
     QByteArray fieldData;
     if (fieldLen != 0) {
         fieldData = device->read(fieldLen);
@@ -309,6 +536,55 @@ bool Kdbx4Reader::readInnerHeaderField(QIODevice* device)
  * @param device input device
  * @return de-serialized variant map
  */
+/**
+ * Read the public custom data of the outer header without reading the rest of the header.
+ *
+ * @param device input device positioned behind the magic numbers
+ * @param publicCustomData public custom data, empty if the header has none
+ * @return true if the header fields up to the public custom data are valid
+ */
+bool Kdbx4Reader::readPublicCustomData(QIODevice* device, QVariantMap& publicCustomData)
+{
+    publicCustomData.clear();
+    forever {
+        QByteArray fieldIDArray = device->read(1);
+        if (fieldIDArray.size() != 1) {
+            raiseError(tr("Invalid header id size"));
+            return false;
+        }
+        const auto fieldID = static_cast<KeePass2::HeaderFieldID>(fieldIDArray.at(0));
+
+        bool ok;
+        auto fieldLen = Endian::readSizedInt<quint32>(device, KeePass2::BYTEORDER, &ok);
+        if (!ok) {
+            raiseError(tr("Invalid header field length: field %1").arg(fieldIDArray.at(0)));
+            return false;
+        }
+
+        if (fieldID == KeePass2::HeaderFieldID::EndOfHeader) {
+            return true;
+        }
+
+        if (fieldID != KeePass2::HeaderFieldID::PublicCustomData) {
+            if (device->skip(fieldLen) != static_cast<qint64>(fieldLen)) {
+                raiseError(tr("Invalid header data length: field %1").arg(fieldIDArray.at(0)));
+                return false;
+            }
+            continue;
+        }
+
+        QByteArray fieldData = device->read(fieldLen);
+        if (static_cast<quint32>(fieldData.size()) != fieldLen) {
+            raiseError(tr("Invalid header data length: field %1").arg(fieldIDArray.at(0)));
+            return false;
+        }
+        QBuffer variantBuffer(&fieldData);
+        variantBuffer.open(QBuffer::ReadOnly);
+        publicCustomData = readVariantMap(&variantBuffer);
+        return !hasError();
+    }
+}
+
 QVariantMap Kdbx4Reader::readVariantMap(QIODevice* device)
 {
     bool ok;
@@ -442,3 +718,14 @@ QHash<QString, QByteArray> Kdbx4Reader::binaryPool() const
 {
     return m_binaryPool;
 }
+
+/**
+ * Defer reading inner header binaries until their attachment is accessed.
+ * Only applies when reading from a file.
+ *
+ * @param defer whether to defer loading attachments
+ */
+void Kdbx4Reader::setDeferAttachments(bool defer)
+{
+    m_deferAttachments = defer;
+}
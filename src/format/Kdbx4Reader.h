@@ -20,6 +20,8 @@
 
 #include "format/KdbxReader.h"
 
+#include <QVector>
+
 /**
  * KDBX4 reader implementation.
  */
@@ -33,6 +35,9 @@ public:
                           QSharedPointer<const CompositeKey> key,
                           Database* db) override;
     QHash<QString, QByteArray> binaryPool() const;
+    bool readPublicCustomData(QIODevice* device, QVariantMap& publicCustomData);
+
+    void setDeferAttachments(bool defer);
 
 protected:
     bool readHeaderField(StoreDataStream& headerStream, Database* db) override;
@@ -42,6 +47,11 @@ private:
     QVariantMap readVariantMap(QIODevice* device);
 
     QHash<QString, QByteArray> m_binaryPool;
+
+    bool m_deferAttachments = false;
+    bool m_deferringBinaries = false;
+    qint64 m_innerHeaderOffset = 0;
+    QVector<QPair<qint64, int>> m_deferredBinaries;
 };
 
 #endif // KEEPASSX_KDBX4READER_H
@@ -20,17 +20,19 @@
 #include <QBuffer>
 
 #include "config-keepassx.h"
+#include "core/Metadata.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/Random.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/HmacBlockStream.h"
+#include "streams/ParallelGzipStream.h"
 #include "streams/SymmetricCipherStream.h"
-#include "streams/qtiocompressor.h"
 
-bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
+bool Kdbx4Writer::snapshotDatabase(Database* db)
 {
     m_error = false;
     m_errorStr.clear();
+    clearSnapshot();
 
     auto mode = SymmetricCipher::cipherUuidToMode(db->cipher());
     if (mode == SymmetricCipher::InvalidMode) {
@@ -43,25 +45,22 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
         return false;
     }
 
-    QByteArray masterSeed = randomGen()->randomArray(32);
-    QByteArray encryptionIV = randomGen()->randomArray(ivSize);
+    m_cipher = db->cipher();
+    m_compressed = db->compressionAlgorithm() != Database::CompressionNone;
+    m_compressionLevel = db->metadata()->compressionLevel();
+    m_masterSeed = randomGen()->randomArray(32);
+    m_encryptionIV = randomGen()->randomArray(ivSize);
     QByteArray protectedStreamKey = randomGen()->randomArray(64);
     QByteArray endOfHeader = "\r\n\r\n";
 
-    if (!db->setKey(db->key(), false, true)) {
-        raiseError(tr("Unable to calculate database key: %1").arg(db->keyError()));
-        return false;
+    // The key is derived from the new seed when the snapshot is written. A seed the
+    // challenge-response keys answered already is kept, since a new one would have
+    // to be answered on every save, e.g. with another touch of a YubiKey.
+    if (!m_keepKdfSeed && (!db->key() || !db->key()->isChallengeAnswered(db->kdf()->seed()))) {
+        db->kdf()->randomizeSeed();
     }
 
-    // generate transformed database key
-    CryptoHash hash(CryptoHash::Sha256);
-    hash.addData(masterSeed);
-    Q_ASSERT(!db->transformedDatabaseKey().isEmpty());
-    hash.addData(db->transformedDatabaseKey());
-    QByteArray finalKey = hash.result();
-
     // write header
-    QByteArray headerData;
     {
         QBuffer header;
         header.open(QIODevice::WriteOnly);
@@ -74,8 +73,9 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
             &header,
             KeePass2::HeaderFieldID::CompressionFlags,
             Endian::sizedIntToBytes(static_cast<int>(db->compressionAlgorithm()), KeePass2::BYTEORDER)));
-        CHECK_RETURN_FALSE(writeHeaderField<quint32>(&header, KeePass2::HeaderFieldID::MasterSeed, masterSeed));
-        CHECK_RETURN_FALSE(writeHeaderField<quint32>(&header, KeePass2::HeaderFieldID::EncryptionIV, encryptionIV));
+        CHECK_RETURN_FALSE(writeHeaderField<quint32>(&header, KeePass2::HeaderFieldID::MasterSeed, m_masterSeed));
+        CHECK_RETURN_FALSE(
+            writeHeaderField<quint32>(&header, KeePass2::HeaderFieldID::EncryptionIV, m_encryptionIV));
 
         // convert current Kdf to basic parameters
         QVariantMap kdfParams = KeePass2::kdfToParameters(db->kdf());
@@ -97,24 +97,73 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
 
         CHECK_RETURN_FALSE(writeHeaderField<quint32>(&header, KeePass2::HeaderFieldID::EndOfHeader, endOfHeader));
         header.close();
-        headerData = header.data();
+        m_header = header.data();
+    }
+
+    // write inner header and XML payload
+    QBuffer payload(&m_payload);
+    payload.open(QIODevice::WriteOnly);
+
+    CHECK_RETURN_FALSE(writeInnerHeaderField(
+        &payload,
+        KeePass2::InnerHeaderFieldID::InnerRandomStreamID,
+        Endian::sizedIntToBytes(static_cast<int>(KeePass2::ProtectedStreamAlgo::ChaCha20), KeePass2::BYTEORDER)));
+    CHECK_RETURN_FALSE(
+        writeInnerHeaderField(&payload, KeePass2::InnerHeaderFieldID::InnerRandomStreamKey, protectedStreamKey));
+
+    // Write attachments to the inner header
+    auto idxMap = writeAttachments(&payload, db);
+
+    CHECK_RETURN_FALSE(writeInnerHeaderField(&payload, KeePass2::InnerHeaderFieldID::End, QByteArray()));
+
+    KeePass2RandomStream randomStream;
+    if (!randomStream.init(SymmetricCipher::ChaCha20, protectedStreamKey)) {
+        raiseError(randomStream.errorString());
+        return false;
+    }
+
+    KdbxXmlWriter xmlWriter(db->formatVersion(), idxMap);
+    xmlWriter.writeDatabase(&payload, db, &randomStream, CryptoHash::hash(m_header, CryptoHash::Sha256));
+    if (xmlWriter.hasError()) {
+        raiseError(xmlWriter.errorString());
+        return false;
+    }
+
+    m_hasSnapshot = true;
+    return true;
+}
+
+bool Kdbx4Writer::writeSnapshot(QIODevice* device, Database* db)
+{
+    if (!db->setKey(db->key(), false, false)) {
+        raiseError(tr("Unable to calculate database key: %1").arg(db->keyError()));
+        return false;
     }
-    CHECK_RETURN_FALSE(writeData(device, headerData));
+
+    // generate transformed database key
+    CryptoHash hash(CryptoHash::Sha256);
+    hash.addData(m_masterSeed);
+    Q_ASSERT(!db->transformedDatabaseKey().isEmpty());
+    hash.addData(db->transformedDatabaseKey());
+    QByteArray finalKey = hash.result();
+
+    CHECK_RETURN_FALSE(writeData(device, m_header));
 
     // hash header
-    QByteArray headerHash = CryptoHash::hash(headerData, CryptoHash::Sha256);
+    QByteArray headerHash = CryptoHash::hash(m_header, CryptoHash::Sha256);
 
     // write HMAC-authenticated cipher stream
-    QByteArray hmacKey = KeePass2::hmacKey(masterSeed, db->transformedDatabaseKey());
+    QByteArray hmacKey = KeePass2::hmacKey(m_masterSeed, db->transformedDatabaseKey());
     QByteArray headerHmac =
-        CryptoHash::hmac(headerData, HmacBlockStream::getHmacKey(UINT64_MAX, hmacKey), CryptoHash::Sha256);
+        CryptoHash::hmac(m_header, HmacBlockStream::getHmacKey(UINT64_MAX, hmacKey), CryptoHash::Sha256);
     CHECK_RETURN_FALSE(writeData(device, headerHash));
     CHECK_RETURN_FALSE(writeData(device, headerHmac));
 
     QScopedPointer<HmacBlockStream> hmacBlockStream;
     QScopedPointer<SymmetricCipherStream> cipherStream;
 
-    hmacBlockStream.reset(new HmacBlockStream(device, hmacKey));
+    hmacBlockStream.reset(
+        new HmacBlockStream(device, hmacKey, m_blockSize > 0 ? m_blockSize : HmacBlockStream::DefaultBlockSize));
     if (!hmacBlockStream->open(QIODevice::WriteOnly)) {
         raiseError(hmacBlockStream->errorString());
         return false;
@@ -122,7 +171,8 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
 
     cipherStream.reset(new SymmetricCipherStream(hmacBlockStream.data()));
 
-    if (!cipherStream->init(mode, SymmetricCipher::Encrypt, finalKey, encryptionIV)) {
+    auto mode = SymmetricCipher::cipherUuidToMode(m_cipher);
+    if (!cipherStream->init(mode, SymmetricCipher::Encrypt, finalKey, m_encryptionIV)) {
         raiseError(cipherStream->errorString());
         return false;
     }
@@ -132,13 +182,12 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     QIODevice* outputDevice = nullptr;
-    QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<ParallelGzipStream> ioCompressor;
 
-    if (db->compressionAlgorithm() == Database::CompressionNone) {
+    if (!m_compressed) {
         outputDevice = cipherStream.data();
     } else {
-        ioCompressor.reset(new QtIOCompressor(cipherStream.data()));
-        ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+        ioCompressor.reset(new ParallelGzipStream(cipherStream.data(), m_compressionLevel));
         if (!ioCompressor->open(QIODevice::WriteOnly)) {
             raiseError(ioCompressor->errorString());
             return false;
@@ -148,26 +197,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
 
     Q_ASSERT(outputDevice);
 
-    CHECK_RETURN_FALSE(writeInnerHeaderField(
-        outputDevice,
-        KeePass2::InnerHeaderFieldID::InnerRandomStreamID,
-        Endian::sizedIntToBytes(static_cast<int>(KeePass2::ProtectedStreamAlgo::ChaCha20), KeePass2::BYTEORDER)));
-    CHECK_RETURN_FALSE(
-        writeInnerHeaderField(outputDevice, KeePass2::InnerHeaderFieldID::InnerRandomStreamKey, protectedStreamKey));
-
-    // Write attachments to the inner header
-    auto idxMap = writeAttachments(outputDevice, db);
-
-    CHECK_RETURN_FALSE(writeInnerHeaderField(outputDevice, KeePass2::InnerHeaderFieldID::End, QByteArray()));
-
-    KeePass2RandomStream randomStream;
-    if (!randomStream.init(SymmetricCipher::ChaCha20, protectedStreamKey)) {
-        raiseError(randomStream.errorString());
-        return false;
-    }
-
-    KdbxXmlWriter xmlWriter(db->formatVersion(), idxMap);
-    xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
+    CHECK_RETURN_FALSE(writePayload(outputDevice));
 
     // Explicitly close/reset streams so they are flushed and we can detect
     // errors. QIODevice::close() resets errorString() etc.
@@ -183,11 +213,6 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
         return false;
     }
 
-    if (xmlWriter.hasError()) {
-        raiseError(xmlWriter.errorString());
-        return false;
-    }
-
     return true;
 }
 
@@ -213,40 +238,16 @@ bool Kdbx4Writer::writeInnerHeaderField(QIODevice* device, KeePass2::InnerHeader
 
 KdbxXmlWriter::BinaryIdxMap Kdbx4Writer::writeAttachments(QIODevice* device, Database* db)
 {
-    const QList<Entry*> allEntries = db->rootGroup()->entriesRecursive(true);
-    QHash<QByteArray, qint64> writtenAttachments;
-    KdbxXmlWriter::BinaryIdxMap idxMap;
-    qint64 nextIdx = 0;
-
-    for (const Entry* entry : allEntries) {
-        const QList<QString> attachmentKeys = entry->attachments()->keys();
-        for (const QString& key : attachmentKeys) {
-            QByteArray data("\x01");
-            data.append(entry->attachments()->value(key));
-
-            CryptoHash hash(CryptoHash::Sha256);
-#ifdef WITH_XC_KEESHARE
-            // Namespace KeeShare attachments so they don't get deduplicated together with attachments
-            // from other databases. Prevents potential filesize side channels.
-            auto group = entry->group();
-            if (!group && entry->historyOwner()) {
-                group = entry->historyOwner()->group();
-            }
-            if (group && group->isShared()) {
-                hash.addData(group->uuid().toByteArray());
-            } else {
-                hash.addData(db->uuid().toByteArray());
-            }
-#endif
-            hash.addData(data);
-
-            // Deduplicate attachments with the same hash
-            const auto hashResult = hash.result();
-            if (!writtenAttachments.contains(hashResult)) {
-                writeInnerHeaderField(device, KeePass2::InnerHeaderFieldID::Binary, data);
-                writtenAttachments.insert(hashResult, nextIdx++);
-            }
-            idxMap.insert(qMakePair(entry, key), writtenAttachments[hashResult]);
+    QList<QByteArray> attachments;
+    auto idxMap = KdbxXmlWriter::indexAttachments(db, attachments);
+    for (const auto& attachment : asConst(attachments)) {
+        // Written behind the protection flag without copying the attachment into a single field
+        QByteArray fieldHeader;
+        fieldHeader.append(static_cast<char>(KeePass2::InnerHeaderFieldID::Binary));
+        fieldHeader.append(Endian::sizedIntToBytes(static_cast<quint32>(attachment.size() + 1), KeePass2::BYTEORDER));
+        fieldHeader.append('\x01');
+        if (!writeData(device, fieldHeader) || !writeData(device, attachment)) {
+            break;
         }
     }
 
@@ -29,7 +29,10 @@ class Kdbx4Writer : public KdbxWriter
     Q_DECLARE_TR_FUNCTIONS(Kdbx4Writer)
 
 public:
-    bool writeDatabase(QIODevice* device, Database* db) override;
+    bool snapshotDatabase(Database* db) override;
+
+protected:
+    bool writeSnapshot(QIODevice* device, Database* db) override;
 
 private:
     bool writeInnerHeaderField(QIODevice* device, KeePass2::InnerHeaderFieldID fieldId, const QByteArray& data);
@@ -0,0 +1,625 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KdbxJournal.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/Endian.h"
+#include "core/Group.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+#include "crypto/SymmetricCipher.h"
+#include "format/KdbxXmlReader.h"
+#include "format/KdbxXmlWriter.h"
+#include "format/KeePass2.h"
+
+namespace
+{
+    const quint32 JournalSignature = 0x4C4E524A; // "JRNL"
+    const quint32 JournalVersion = 0x00010000;
+    const int SeedSize = 32;
+    const int HmacSize = 32;
+    // The base file is hashed in blocks of this size
+    const qint64 FingerprintBlockSize = 1024 * 1024;
+    // Signature, version, base file fingerprint, seed and cipher UUID
+    const int HeaderSize = 4 + 4 + 32 + SeedSize + 16;
+
+    Group* cloneGroupTree(const Group* group)
+    {
+        auto clone = group->clone(Entry::CloneNoFlags, Group::CloneNoFlags);
+        for (const Group* child : group->children()) {
+            auto childClone = cloneGroupTree(child);
+            childClone->setUpdateTimeinfo(false);
+            childClone->setParent(clone, -1, false);
+            childClone->setUpdateTimeinfo(true);
+        }
+        return clone;
+    }
+
+    /**
+     * Bring the children of target in line with the journaled group source.
+     * Records are strictly ordered, so unlike a merge the journaled state always wins.
+     */
+    void applyGroup(const Group* source, Group* target, Group* targetRoot)
+    {
+        for (const Group* sourceChild : source->children()) {
+            Group* targetChild = targetRoot->findGroupByUuid(sourceChild->uuid());
+            if (!targetChild) {
+                targetChild = sourceChild->clone(Entry::CloneNoFlags, Group::CloneNoFlags);
+            }
+            targetChild->setUpdateTimeinfo(false);
+            targetChild->copyDataFrom(sourceChild);
+            if (targetChild->parentGroup() != target) {
+                targetChild->setParent(target, -1, false);
+            }
+            targetChild->setUpdateTimeinfo(true);
+
+            applyGroup(sourceChild, targetChild, targetRoot);
+        }
+
+        for (const Entry* sourceEntry : source->entries()) {
+            Entry* targetEntry = targetRoot->findEntryByUuid(sourceEntry->uuid());
+            if (!targetEntry) {
+                targetEntry = sourceEntry->clone(Entry::CloneIncludeHistory);
+            } else {
+                targetEntry->copyDataFrom(sourceEntry);
+                targetEntry->removeHistoryItems(targetEntry->historyItems());
+                for (const Entry* historyItem : sourceEntry->historyItems()) {
+                    targetEntry->addHistoryItem(historyItem->clone(Entry::CloneNoFlags));
+                }
+            }
+            if (targetEntry->group() != target) {
+                targetEntry->setUpdateTimeinfo(false);
+                targetEntry->setGroup(target, false);
+                targetEntry->setUpdateTimeinfo(true);
+            }
+        }
+    }
+
+    bool isChangedSince(const TimeInfo& timeInfo, const QDateTime& since)
+    {
+        return timeInfo.lastModificationTime() >= since || timeInfo.locationChanged() >= since;
+    }
+} // namespace
+
+QString KdbxJournal::journalFilePath(const QString& databaseFilePath)
+{
+    return databaseFilePath + QStringLiteral(".journal");
+}
+
+/**
+ * Replay the journal of a freshly read database file and continue it.
+ * Journals that belong to a different version of the file or fail
+ * authentication are not replayed, they are kept next to the journal
+ * under another name, see keptJournalFilePath().
+ *
+ * @param databaseFilePath canonical path of the database file that was read
+ * @param db database read from that file
+ * @return true if any journaled changes were applied to the database
+ */
+bool KdbxJournal::replay(const QString& databaseFilePath, Database* db)
+{
+    start(databaseFilePath, db);
+
+    QFile file(journalFilePath(databaseFilePath));
+    if (!file.exists() || !m_valid) {
+        return false;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("KdbxJournal: Unable to open %s: %s", qPrintable(file.fileName()), qPrintable(file.errorString()));
+        return false;
+    }
+
+    QByteArray journal = file.readAll();
+    file.close();
+
+    QBuffer buffer(&journal);
+    buffer.open(QIODevice::ReadOnly);
+
+    QByteArray header = buffer.read(HeaderSize);
+    QByteArray headerHmac = buffer.read(HmacSize);
+    if (header.size() != HeaderSize || headerHmac.size() != HmacSize
+        || Endian::bytesToSizedInt<quint32>(header.left(4), KeePass2::BYTEORDER) != JournalSignature
+        || Endian::bytesToSizedInt<quint32>(header.mid(4, 4), KeePass2::BYTEORDER) != JournalVersion) {
+        qWarning("KdbxJournal: Not replaying unsupported journal %s", qPrintable(file.fileName()));
+        keepJournal(file.fileName());
+        return false;
+    }
+    if (!isBaseFileUnchanged() || header.mid(8, 32) != m_baseFingerprint) {
+        // The database file was saved elsewhere after the journal was written, its changes may be lost otherwise
+        qWarning("KdbxJournal: Not replaying journal %s of another version of the database file",
+                 qPrintable(file.fileName()));
+        keepJournal(file.fileName());
+        return false;
+    }
+
+    initKeys(db, header.mid(40, SeedSize));
+    m_cipher = QUuid::fromRfc4122(header.mid(40 + SeedSize, 16));
+    if (CryptoHash::hmac(header, m_hmacKey, CryptoHash::Sha256) != headerHmac) {
+        qWarning("KdbxJournal: Not replaying journal %s with invalid header HMAC", qPrintable(file.fileName()));
+        initKeys(db, randomGen()->randomArray(SeedSize));
+        keepJournal(file.fileName());
+        return false;
+    }
+    m_lastHmac = headerHmac;
+    m_journalSize = buffer.pos();
+
+    auto mode = SymmetricCipher::cipherUuidToMode(m_cipher);
+    int ivSize = SymmetricCipher::defaultIvSize(mode);
+
+    while (!buffer.atEnd()) {
+        bool ok;
+        auto size = Endian::readSizedInt<quint32>(&buffer, KeePass2::BYTEORDER, &ok);
+        QByteArray data = buffer.read(size);
+        QByteArray hmac = buffer.read(HmacSize);
+        if (!ok || data.size() != static_cast<int>(size) || hmac.size() != HmacSize) {
+            // Incomplete record from an interrupted append, dropped on the next append
+            break;
+        }
+        if (recordHmac(m_lastHmac, m_recordCount, data) != hmac) {
+            qWarning("KdbxJournal: Record %llu of %s failed verification, ignoring the rest of the journal",
+                     m_recordCount,
+                     qPrintable(file.fileName()));
+            break;
+        }
+
+        SymmetricCipher cipher;
+        QByteArray record = data.mid(ivSize);
+        if (data.size() < ivSize || !cipher.init(mode, SymmetricCipher::Decrypt, m_encryptionKey, data.left(ivSize))
+            || !cipher.finish(record) || !applyRecord(record, db)) {
+            qWarning("KdbxJournal: Unable to replay record %llu of %s", m_recordCount, qPrintable(file.fileName()));
+            break;
+        }
+
+        m_lastHmac = hmac;
+        ++m_recordCount;
+        m_journalSize = buffer.pos();
+    }
+
+    // Replaying the records marked the database modified, don't treat that as an unjournaled change
+    m_since = Clock::currentDateTimeUtc();
+    m_journaledDeletions.clear();
+    for (const auto& object : db->deletedObjects()) {
+        m_journaledDeletions.insert(object.uuid);
+    }
+    m_valid = true;
+
+    return m_recordCount > 0;
+}
+
+/**
+ * Start over with an empty journal for a database file that was just
+ * written in full, deleting any previous journal of that file.
+ *
+ * @param databaseFilePath canonical path of the database file
+ * @param db database that matches the file contents
+ */
+void KdbxJournal::reset(const QString& databaseFilePath, const Database* db)
+{
+    QFile::remove(journalFilePath(databaseFilePath));
+    start(databaseFilePath, db);
+}
+
+/**
+ * Append all entry and group changes made since the previous append.
+ *
+ * @param db database to journal
+ * @param error error message in case of failure
+ * @return true on success, false if the database has to be saved in full
+ */
+bool KdbxJournal::append(const Database* db, QString* error)
+{
+    // The database may have been saved as a copy somewhere else in the meantime
+    if (!m_valid || db->canonicalFilePath() != m_databaseFilePath) {
+        if (error) {
+            *error = tr("The changes cannot be written to the save journal.");
+        }
+        return false;
+    }
+    if (!isBaseFileUnchanged()) {
+        if (error) {
+            *error = tr("Database file has unmerged changes.");
+        }
+        return false;
+    }
+
+    auto since = Clock::currentDateTimeUtc();
+    QByteArray record;
+    if (!serializeChanges(db, record)) {
+        if (error) {
+            *error = tr("Unable to serialize the changes for the save journal.");
+        }
+        return false;
+    }
+    if (record.isEmpty()) {
+        return true;
+    }
+
+    auto mode = SymmetricCipher::cipherUuidToMode(m_cipher);
+    QByteArray data = randomGen()->randomArray(SymmetricCipher::defaultIvSize(mode));
+    SymmetricCipher cipher;
+    if (!cipher.init(mode, SymmetricCipher::Encrypt, m_encryptionKey, data) || !cipher.finish(record)) {
+        if (error) {
+            *error = cipher.errorString();
+        }
+        return false;
+    }
+    data.append(record);
+
+    QFile file(journalFilePath(m_databaseFilePath));
+    bool newJournal = m_journalSize == 0;
+    QIODevice::OpenMode openMode = QIODevice::ReadWrite;
+    if (newJournal) {
+        openMode = QIODevice::WriteOnly | QIODevice::Truncate;
+    }
+    if (!file.open(openMode)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    QByteArray output;
+    QByteArray previousHmac = m_lastHmac;
+    if (newJournal) {
+        QByteArray header;
+        header.append(Endian::sizedIntToBytes<quint32>(JournalSignature, KeePass2::BYTEORDER));
+        header.append(Endian::sizedIntToBytes<quint32>(JournalVersion, KeePass2::BYTEORDER));
+        header.append(m_baseFingerprint);
+        header.append(m_seed);
+        header.append(m_cipher.toRfc4122());
+        previousHmac = CryptoHash::hmac(header, m_hmacKey, CryptoHash::Sha256);
+        output.append(header);
+        output.append(previousHmac);
+    } else if (!file.resize(m_journalSize) || !file.seek(m_journalSize)) {
+        // Drops an incomplete record left behind by an interrupted append
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    QByteArray hmac = recordHmac(previousHmac, m_recordCount, data);
+    output.append(Endian::sizedIntToBytes<quint32>(static_cast<quint32>(data.size()), KeePass2::BYTEORDER));
+    output.append(data);
+    output.append(hmac);
+
+    if (file.write(output) != output.size() || !file.flush()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    file.close();
+
+    m_journalSize += output.size();
+    m_lastHmac = hmac;
+    ++m_recordCount;
+    m_since = since;
+    for (const auto& object : db->deletedObjects()) {
+        m_journaledDeletions.insert(object.uuid);
+    }
+
+    return true;
+}
+
+/**
+ * Delete the journal file, e.g. when the journaled changes were discarded.
+ */
+void KdbxJournal::discard()
+{
+    if (!m_databaseFilePath.isEmpty()) {
+        QFile::remove(journalFilePath(m_databaseFilePath));
+    }
+    clear();
+}
+
+/**
+ * Forget the journal state without touching the journal file.
+ */
+void KdbxJournal::clear()
+{
+    m_databaseFilePath.clear();
+    m_baseFingerprint.clear();
+    m_baseSize = -1;
+    m_baseLastModified = QDateTime();
+    m_keptJournalFilePath.clear();
+    m_seed.clear();
+    m_cipher = QUuid();
+    m_encryptionKey.clear();
+    m_hmacKey.clear();
+    m_lastHmac.clear();
+    m_recordCount = 0;
+    m_journalSize = 0;
+    m_since = QDateTime();
+    m_journaledDeletions.clear();
+    m_valid = false;
+}
+
+/**
+ * Mark the in-memory database as containing changes the journal cannot
+ * represent, further appends fail until the next full save.
+ */
+void KdbxJournal::invalidate()
+{
+    m_valid = false;
+}
+
+bool KdbxJournal::isValid() const
+{
+    return m_valid;
+}
+
+/**
+ * @return path a journal that could not be replayed was moved to, empty if there was none
+ */
+QString KdbxJournal::keptJournalFilePath() const
+{
+    return m_keptJournalFilePath;
+}
+
+void KdbxJournal::start(const QString& databaseFilePath, const Database* db)
+{
+    m_databaseFilePath = databaseFilePath;
+    // Hashing the whole file is left until a journal is read or written
+    const QFileInfo info(databaseFilePath);
+    m_baseFingerprint.clear();
+    m_baseSize = info.size();
+    m_baseLastModified = info.lastModified();
+    m_keptJournalFilePath.clear();
+    initKeys(db, randomGen()->randomArray(SeedSize));
+    m_lastHmac.clear();
+    m_recordCount = 0;
+    m_journalSize = 0;
+    m_since = Clock::currentDateTimeUtc();
+    m_journaledDeletions.clear();
+    for (const auto& object : db->deletedObjects()) {
+        m_journaledDeletions.insert(object.uuid);
+    }
+    m_valid = info.exists() && !db->transformedDatabaseKey().isEmpty();
+}
+
+/**
+ * Check that the database file still has the contents the journal extends.
+ *
+ * The contents are hashed when the journal first needs them and again whenever the
+ * size or the modification time of the file changed, so a file that was only touched
+ * keeps its journal, while one that was rewritten with other contents does not.
+ *
+ * @return true if the file contents match the base of the journal
+ */
+bool KdbxJournal::isBaseFileUnchanged()
+{
+    const QFileInfo info(m_databaseFilePath);
+    const bool sameStat = info.size() == m_baseSize && info.lastModified() == m_baseLastModified;
+    if (m_baseFingerprint.isEmpty()) {
+        // The file is hashed in the state it had when the journal was started
+        if (!sameStat) {
+            return false;
+        }
+        m_baseFingerprint = fileFingerprint(m_databaseFilePath);
+        return !m_baseFingerprint.isEmpty();
+    }
+    if (sameStat) {
+        return true;
+    }
+    if (fileFingerprint(m_databaseFilePath) != m_baseFingerprint) {
+        return false;
+    }
+    m_baseSize = info.size();
+    m_baseLastModified = info.lastModified();
+    return true;
+}
+
+/**
+ * Move a journal that cannot be replayed out of the way instead of replacing it on the next
+ * append, it may hold the only copy of changes that were never saved in full.
+ *
+ * @param journalPath path of the journal file
+ */
+void KdbxJournal::keepJournal(const QString& journalPath)
+{
+    QString keptPath = journalPath + QStringLiteral(".unmerged");
+    for (int i = 2; QFile::exists(keptPath); ++i) {
+        keptPath = QStringLiteral("%1.unmerged%2").arg(journalPath).arg(i);
+    }
+    if (!QFile::rename(journalPath, keptPath)) {
+        qWarning("KdbxJournal: Unable to move %s out of the way", qPrintable(journalPath));
+        // Don't append to the journal to keep it intact
+        keptPath = journalPath;
+        m_valid = false;
+    }
+    m_keptJournalFilePath = keptPath;
+}
+
+void KdbxJournal::initKeys(const Database* db, const QByteArray& seed)
+{
+    m_seed = seed;
+    m_cipher = db->cipher();
+
+    CryptoHash hash(CryptoHash::Sha256);
+    hash.addData(seed);
+    hash.addData(db->transformedDatabaseKey());
+    m_encryptionKey = hash.result();
+    m_hmacKey = KeePass2::hmacKey(seed, db->transformedDatabaseKey());
+}
+
+/**
+ * Apply a decrypted journal record to the database.
+ *
+ * @param record attachment pool followed by the XML of the changes
+ * @param db target database
+ * @return true on success
+ */
+bool KdbxJournal::applyRecord(const QByteArray& record, Database* db)
+{
+    QBuffer buffer;
+    buffer.setData(record);
+    buffer.open(QIODevice::ReadOnly);
+
+    bool ok;
+    auto binaryCount = Endian::readSizedInt<quint32>(&buffer, KeePass2::BYTEORDER, &ok);
+    if (!ok) {
+        return false;
+    }
+
+    QHash<QString, QByteArray> binaryPool;
+    for (quint32 i = 0; i < binaryCount; ++i) {
+        auto size = Endian::readSizedInt<quint32>(&buffer, KeePass2::BYTEORDER, &ok);
+        QByteArray data = buffer.read(size);
+        if (!ok || data.size() != static_cast<int>(size)) {
+            return false;
+        }
+        binaryPool.insert(QString::number(i), data);
+    }
+
+    Database changes;
+    KdbxXmlReader reader(KeePass2::FILE_VERSION_4, binaryPool);
+    reader.readDatabase(&buffer, &changes);
+    if (reader.hasError()) {
+        return false;
+    }
+
+    db->rootGroup()->setUpdateTimeinfo(false);
+    db->rootGroup()->copyDataFrom(changes.rootGroup());
+    db->rootGroup()->setUpdateTimeinfo(true);
+    applyGroup(changes.rootGroup(), db->rootGroup(), db->rootGroup());
+
+    // Deleting an object records a new deletion time, keep the journaled one instead
+    auto deletions = db->deletedObjects();
+    for (const auto& object : changes.deletedObjects()) {
+        Entry* entry = db->rootGroup()->findEntryByUuid(object.uuid);
+        Group* group = entry ? nullptr : db->rootGroup()->findGroupByUuid(object.uuid);
+        delete entry;
+        if (group != db->rootGroup()) {
+            delete group;
+        }
+        deletions.append(object);
+    }
+    db->setDeletedObjects(deletions);
+
+    return true;
+}
+
+/**
+ * Serialize the entries and groups changed since the previous append as a
+ * partial database. All groups are included without their entries so merging
+ * the record can restore the location of every changed entry.
+ *
+ * @param db source database
+ * @param record serialized changes, empty if nothing changed
+ * @return true on success
+ */
+bool KdbxJournal::serializeChanges(const Database* db, QByteArray& record) const
+{
+    record.clear();
+
+    Database changes;
+    auto root = cloneGroupTree(db->rootGroup());
+    delete changes.setRootGroup(root);
+
+    bool changed = false;
+    for (const Group* group : db->rootGroup()->groupsRecursive(true)) {
+        changed |= isChangedSince(group->timeInfo(), m_since);
+    }
+
+    for (const Entry* entry : db->rootGroup()->entriesRecursive()) {
+        if (!isChangedSince(entry->timeInfo(), m_since)) {
+            continue;
+        }
+        auto clone = entry->clone(Entry::CloneIncludeHistory);
+        clone->setUpdateTimeinfo(false);
+        clone->setGroup(root->findGroupByUuid(entry->group()->uuid()), false);
+        clone->setUpdateTimeinfo(true);
+        changed = true;
+    }
+
+    QList<DeletedObject> deletions;
+    for (const auto& object : db->deletedObjects()) {
+        if (!m_journaledDeletions.contains(object.uuid)) {
+            deletions.append(object);
+        }
+    }
+    if (!deletions.isEmpty()) {
+        changes.setDeletedObjects(deletions);
+        changed = true;
+    }
+
+    if (!changed) {
+        return true;
+    }
+
+    // Attachments precede the XML the same way the KDBX 4 inner header does
+    KdbxXmlWriter::BinaryIdxMap idxMap;
+    QByteArray binaries;
+    quint32 binaryCount = 0;
+    for (const Entry* entry : root->entriesRecursive(true)) {
+        // Attachments that cannot be read must not be journaled as empty
+        if (!entry->attachments()->loadDeferred()) {
+            return false;
+        }
+        for (const QString& key : entry->attachments()->keys()) {
+            QByteArray data = entry->attachments()->value(key);
+            binaries.append(Endian::sizedIntToBytes<quint32>(static_cast<quint32>(data.size()), KeePass2::BYTEORDER));
+            binaries.append(data);
+            idxMap.insert(qMakePair(entry, key), binaryCount++);
+        }
+    }
+
+    record = Endian::sizedIntToBytes<quint32>(binaryCount, KeePass2::BYTEORDER);
+    record.append(binaries);
+
+    QBuffer buffer(&record);
+    buffer.open(QIODevice::WriteOnly | QIODevice::Append);
+    KdbxXmlWriter writer(KeePass2::FILE_VERSION_MAX, idxMap);
+    writer.disableInnerStreamProtection(true);
+    writer.writeDatabase(&buffer, &changes);
+    return !writer.hasError();
+}
+
+QByteArray KdbxJournal::recordHmac(const QByteArray& previousHmac, quint64 index, const QByteArray& data) const
+{
+    CryptoHash hmac(CryptoHash::Sha256, true);
+    hmac.setKey(m_hmacKey);
+    hmac.addData(previousHmac);
+    hmac.addData(Endian::sizedIntToBytes<quint64>(index, KeePass2::BYTEORDER));
+    hmac.addData(data);
+    return hmac.result();
+}
+
+QByteArray KdbxJournal::fileFingerprint(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    CryptoHash hash(CryptoHash::Sha256);
+    while (!file.atEnd()) {
+        const QByteArray block = file.read(FingerprintBlockSize);
+        if (block.isEmpty()) {
+            return {};
+        }
+        hash.addData(block);
+    }
+    return hash.result();
+}
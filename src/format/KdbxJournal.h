@@ -0,0 +1,87 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_KDBXJOURNAL_H
+#define KEEPASSXC_KDBXJOURNAL_H
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QSet>
+#include <QUuid>
+
+class Database;
+
+/**
+ * Append-only save journal kept next to a KDBX file.
+ *
+ * Every record holds the entries and groups changed since the previous
+ * record as a small encrypted database which is applied to the loaded
+ * database on replay. Records are chained by HMAC to the journal header,
+ * which in turn is bound to the content hash of the database file it
+ * extends. The keys are derived from the already transformed database key,
+ * so appending a record does not run the KDF nor rewrite the database file.
+ *
+ * Changes that cannot be expressed as entry or group updates invalidate
+ * the journal until the next full save.
+ */
+class KdbxJournal
+{
+    Q_DECLARE_TR_FUNCTIONS(KdbxJournal)
+
+public:
+    static QString journalFilePath(const QString& databaseFilePath);
+
+    bool replay(const QString& databaseFilePath, Database* db);
+    void reset(const QString& databaseFilePath, const Database* db);
+    bool append(const Database* db, QString* error = nullptr);
+    void discard();
+    void clear();
+
+    void invalidate();
+    bool isValid() const;
+    QString keptJournalFilePath() const;
+
+private:
+    void start(const QString& databaseFilePath, const Database* db);
+    void initKeys(const Database* db, const QByteArray& seed);
+    bool isBaseFileUnchanged();
+    void keepJournal(const QString& journalPath);
+    bool applyRecord(const QByteArray& record, Database* db);
+    bool serializeChanges(const Database* db, QByteArray& record) const;
+    QByteArray recordHmac(const QByteArray& previousHmac, quint64 index, const QByteArray& data) const;
+
+    static QByteArray fileFingerprint(const QString& filePath);
+
+    QString m_databaseFilePath;
+    // Hash of the whole database file, computed when it is first needed
+    QByteArray m_baseFingerprint;
+    qint64 m_baseSize = -1;
+    QDateTime m_baseLastModified;
+    QString m_keptJournalFilePath;
+    QByteArray m_seed;
+    QUuid m_cipher;
+    QByteArray m_encryptionKey;
+    QByteArray m_hmacKey;
+    QByteArray m_lastHmac;
+    quint64 m_recordCount = 0;
+    qint64 m_journalSize = 0;
+    QDateTime m_since;
+    QSet<QUuid> m_journaledDeletions;
+    bool m_valid = false;
+};
+
+#endif // KEEPASSXC_KDBXJOURNAL_H
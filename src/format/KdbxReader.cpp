@@ -119,6 +119,16 @@ KeePass2::ProtectedStreamAlgo KdbxReader::protectedStreamAlgo() const
     return m_irsAlgo;
 }
 
+/**
+ * Leave out the history items of all entries.
+ *
+ * @param skip whether to skip history items
+ */
+void KdbxReader::setSkipHistory(bool skip)
+{
+    m_skipHistory = skip;
+}
+
 /**
  * @param data stream cipher UUID as bytes
  */
@@ -47,6 +47,8 @@ public:
 
     KeePass2::ProtectedStreamAlgo protectedStreamAlgo() const;
 
+    void setSkipHistory(bool skip);
+
 protected:
     /**
      * Concrete reader implementation for reading database from device.
@@ -88,6 +90,7 @@ protected:
     QByteArray m_streamStartBytes;
     QByteArray m_protectedStreamKey;
     KeePass2::ProtectedStreamAlgo m_irsAlgo = KeePass2::ProtectedStreamAlgo::InvalidProtectedStreamAlgo;
+    bool m_skipHistory = false;
 
 private:
     QPair<quint32, quint32> m_kdbxSignature;
@@ -17,10 +17,97 @@
 
 #include "KdbxWriter.h"
 
-#include <QBuffer>
 
 #include "format/KdbxXmlWriter.h"
 
+/**
+ * Set the size of the HMAC or hash protected blocks the payload is split into.
+ *
+ * Every block records its own size, so readers accept any block size.
+ * Larger blocks mean fewer reads and hash computations when opening the
+ * file, at the cost of buffering more data at once.
+ *
+ * @param blockSize block size in bytes, zero for the default
+ */
+void KdbxWriter::setBlockSize(qint32 blockSize)
+{
+    m_blockSize = qMax(blockSize, 0);
+}
+
+/**
+ * Keep the KDF seed of the database instead of drawing a new one for the write.
+ *
+ * The key derived for the seed can then be taken from the transformed key
+ * cache. Only used for exports that are written again on every save.
+ *
+ * @param keep true to keep the current seed
+ */
+void KdbxWriter::setKeepKdfSeed(bool keep)
+{
+    m_keepKdfSeed = keep;
+}
+
+/**
+ * @return true if snapshotDatabase() was called and the snapshot has not been written yet
+ */
+bool KdbxWriter::hasSnapshot() const
+{
+    return m_hasSnapshot;
+}
+
+/**
+ * Write a database to a device in KDBX format.
+ *
+ * Writes the snapshot taken with snapshotDatabase() if there is one, the
+ * current state of the database otherwise.
+ *
+ * @param device output device
+ * @param db source database
+ * @return true on success
+ */
+bool KdbxWriter::writeDatabase(QIODevice* device, Database* db)
+{
+    if (!m_hasSnapshot && !snapshotDatabase(db)) {
+        clearSnapshot();
+        return false;
+    }
+
+    bool ok = writeSnapshot(device, db);
+    clearSnapshot();
+    return ok;
+}
+
+/**
+ * Write the serialized payload of the snapshot.
+ *
+ * @param device compression or cipher stream
+ * @return true on success
+ */
+bool KdbxWriter::writePayload(QIODevice* device)
+{
+    // Hand the payload to the streams in blocks instead of copying it at once
+    const int blockSize = 1024 * 1024;
+    for (int pos = 0; pos < m_payload.size(); pos += blockSize) {
+        auto block = QByteArray::fromRawData(m_payload.constData() + pos, qMin(blockSize, m_payload.size() - pos));
+        CHECK_RETURN_FALSE(writeData(device, block));
+    }
+    return true;
+}
+
+void KdbxWriter::clearSnapshot()
+{
+    // The payload holds the unencrypted database
+    m_payload.fill('\0');
+    m_payload.clear();
+    m_header.clear();
+    m_masterSeed.clear();
+    m_encryptionIV.clear();
+    m_cipher = QUuid();
+    m_compressed = false;
+    m_compressionLevel = -1;
+    m_hasSnapshot = false;
+}
+
 bool KdbxWriter::hasError() const
 {
     return m_error;
@@ -66,15 +153,21 @@ bool KdbxWriter::writeData(QIODevice* device, const QByteArray& data)
     return true;
 }
 
-void KdbxWriter::extractDatabase(QByteArray& xmlOutput, Database* db)
+/**
+ * Write the unprotected XML of a database to a device while the database is traversed.
+ *
+ * @param device output device, the XML is never held in memory as a whole
+ * @param db database to extract
+ */
+void KdbxWriter::extractDatabase(QIODevice* device, Database* db)
 {
-    QBuffer buffer;
-    buffer.setBuffer(&xmlOutput);
-    buffer.open(QIODevice::WriteOnly);
     KdbxXmlWriter::BinaryIdxMap idxMap;
     KdbxXmlWriter writer(db->formatVersion(), idxMap);
     writer.disableInnerStreamProtection(true);
-    writer.writeDatabase(&buffer, db);
+    writer.writeDatabase(device, db);
+    if (writer.hasError()) {
+        raiseError(writer.errorString());
+    }
 }
 
 /**
@@ -22,6 +22,7 @@
 #include "core/Endian.h"
 
 #include <QCoreApplication>
+#include <QUuid>
 
 // clang-format off
 #define CHECK_RETURN_FALSE(x) if (!(x)) return false;
@@ -44,15 +45,24 @@ public:
     bool writeMagicNumbers(QIODevice* device, quint32 sig1, quint32 sig2, quint32 version);
 
     /**
-     * Write a database to a device in KDBX format.
+     * Serialize the database into memory for the next writeDatabase() call.
+     *
+     * Everything is read from the database here, so it may be modified while
+     * writeDatabase() derives the key, compresses, encrypts and writes the
+     * snapshot, e.g. on another thread.
      *
-     * @param device output device
      * @param db source database
      * @return true on success
      */
-    virtual bool writeDatabase(QIODevice* device, Database* db) = 0;
+    virtual bool snapshotDatabase(Database* db) = 0;
+    bool hasSnapshot() const;
+
+    bool writeDatabase(QIODevice* device, Database* db);
 
-    void extractDatabase(QByteArray& xmlOutput, Database* db);
+    void extractDatabase(QIODevice* device, Database* db);
+
+    void setBlockSize(qint32 blockSize);
+    void setKeepKdfSeed(bool keep);
 
     bool hasError() const;
     QString errorString() const;
@@ -81,9 +91,35 @@ protected:
         return true;
     }
 
+    /**
+     * Write the snapshot of the database in KDBX format.
+     *
+     * @param device output device
+     * @param db database the snapshot was taken of, only its key is used
+     * @return true on success
+     */
+    virtual bool writeSnapshot(QIODevice* device, Database* db) = 0;
+    bool writePayload(QIODevice* device);
+    void clearSnapshot();
+
     bool writeData(QIODevice* device, const QByteArray& data);
     void raiseError(const QString& errorMessage);
 
+    // State of the database at the time of snapshotDatabase()
+    bool m_hasSnapshot = false;
+    QUuid m_cipher;
+    bool m_compressed = false;
+    int m_compressionLevel = -1;
+    QByteArray m_masterSeed;
+    QByteArray m_encryptionIV;
+    QByteArray m_header;
+    QByteArray m_payload;
+
+    /** Size of the integrity protected payload blocks, zero selects the stream default */
+    qint32 m_blockSize = 0;
+    /** Whether the KDF seed of the database is written unchanged */
+    bool m_keepKdfSeed = false;
+
     bool m_error = false;
     QString m_errorStr = "";
 };
@@ -17,6 +17,7 @@
 
 #include "KdbxXmlReader.h"
 #include "KeePass2RandomStream.h"
+#include "core/Base64.h"
 #include "core/Clock.h"
 #include "core/Endian.h"
 #include "core/Global.h"
@@ -29,6 +30,120 @@
 
 #define UUID_LENGTH 16
 
+namespace
+{
+    // Elements of groups and entries, the bulk of every payload
+    enum class Element
+    {
+        Unknown,
+        Key,
+        Value,
+        String,
+        Entry,
+        Group,
+        UUID,
+        Name,
+        Notes,
+        Tags,
+        IconID,
+        CustomIconUUID,
+        Times,
+        IsExpanded,
+        DefaultAutoTypeSequence,
+        EnableAutoType,
+        EnableSearching,
+        LastTopVisibleEntry,
+        CustomData,
+        PreviousParentGroup,
+        ForegroundColor,
+        BackgroundColor,
+        OverrideURL,
+        QualityCheck,
+        Binary,
+        AutoType,
+        History,
+        Enabled,
+        DataTransferObfuscation,
+        DefaultSequence,
+        Association,
+        Window,
+        KeystrokeSequence,
+        LastModificationTime,
+        CreationTime,
+        LastAccessTime,
+        ExpiryTime,
+        Expires,
+        UsageCount,
+        LocationChanged
+    };
+
+    struct ElementName
+    {
+        QLatin1String name;
+        Element element;
+    };
+
+    // Ordered by how often the elements appear in a typical payload
+    const ElementName ElementNames[] = {
+        {QLatin1String("Key"), Element::Key},
+        {QLatin1String("Value"), Element::Value},
+        {QLatin1String("String"), Element::String},
+        {QLatin1String("LastModificationTime"), Element::LastModificationTime},
+        {QLatin1String("CreationTime"), Element::CreationTime},
+        {QLatin1String("LastAccessTime"), Element::LastAccessTime},
+        {QLatin1String("ExpiryTime"), Element::ExpiryTime},
+        {QLatin1String("Expires"), Element::Expires},
+        {QLatin1String("UsageCount"), Element::UsageCount},
+        {QLatin1String("LocationChanged"), Element::LocationChanged},
+        {QLatin1String("UUID"), Element::UUID},
+        {QLatin1String("IconID"), Element::IconID},
+        {QLatin1String("ForegroundColor"), Element::ForegroundColor},
+        {QLatin1String("BackgroundColor"), Element::BackgroundColor},
+        {QLatin1String("OverrideURL"), Element::OverrideURL},
+        {QLatin1String("Tags"), Element::Tags},
+        {QLatin1String("Times"), Element::Times},
+        {QLatin1String("AutoType"), Element::AutoType},
+        {QLatin1String("Enabled"), Element::Enabled},
+        {QLatin1String("DataTransferObfuscation"), Element::DataTransferObfuscation},
+        {QLatin1String("DefaultSequence"), Element::DefaultSequence},
+        {QLatin1String("Association"), Element::Association},
+        {QLatin1String("Window"), Element::Window},
+        {QLatin1String("KeystrokeSequence"), Element::KeystrokeSequence},
+        {QLatin1String("History"), Element::History},
+        {QLatin1String("Entry"), Element::Entry},
+        {QLatin1String("QualityCheck"), Element::QualityCheck},
+        {QLatin1String("Binary"), Element::Binary},
+        {QLatin1String("CustomIconUUID"), Element::CustomIconUUID},
+        {QLatin1String("CustomData"), Element::CustomData},
+        {QLatin1String("PreviousParentGroup"), Element::PreviousParentGroup},
+        {QLatin1String("Group"), Element::Group},
+        {QLatin1String("Name"), Element::Name},
+        {QLatin1String("Notes"), Element::Notes},
+        {QLatin1String("IsExpanded"), Element::IsExpanded},
+        {QLatin1String("DefaultAutoTypeSequence"), Element::DefaultAutoTypeSequence},
+        {QLatin1String("EnableAutoType"), Element::EnableAutoType},
+        {QLatin1String("EnableSearching"), Element::EnableSearching},
+        {QLatin1String("LastTopVisibleEntry"), Element::LastTopVisibleEntry},
+    };
+
+    /**
+     * Look up an element name without converting it, comparing a QStringRef
+     * with a C string literal allocates a temporary QString.
+     *
+     * @param name name of the current element
+     * @return element, or Element::Unknown for elements outside of groups and entries
+     */
+    Element element(const QStringRef& name)
+    {
+        for (const auto& elementName : ElementNames) {
+            if (elementName.name.size() == name.size() && elementName.name == name) {
+                return elementName.element;
+            }
+        }
+        return Element::Unknown;
+    }
+} // namespace
+
 /**
  * @param version KDBX version
  */
@@ -137,9 +252,21 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     QMultiHash<QString, QPair<Entry*, QString>>::const_iterator i;
     for (i = m_binaryMap.constBegin(); i != m_binaryMap.constEnd(); ++i) {
         const QPair<Entry*, QString>& target = i.value();
-        target.first->attachments()->set(target.second, m_binaryPool[i.key()]);
+        auto deferred = m_deferredBinaries.constFind(i.key());
+        if (deferred != m_deferredBinaries.constEnd()) {
+            target.first->attachments()->setDeferred(target.second, deferred.value());
+        } else {
+            target.first->attachments()->set(target.second, m_binaryPool[i.key()]);
+        }
     }
 
+    // Attachments now hold the only references to the binary data
+    m_binaryMap.clear();
+    m_binaryPool.clear();
+    m_uniqueBinaries.clear();
+    m_uniqueStrings.clear();
+    m_deferredBinaries.clear();
+
     m_meta->setUpdateDatetime(true);
 
     QHash<QUuid, Group*>::const_iterator iGroup;
@@ -168,6 +295,26 @@ void KdbxXmlReader::setStrictMode(bool strictMode)
     m_strictMode = strictMode;
 }
 
+/**
+ * Pool binaries that are assigned to attachments without loading their data.
+ *
+ * @param binaries deferred attachment data keyed by binary pool id
+ */
+void KdbxXmlReader::setDeferredBinaries(const QHash<QString, DeferredAttachment>& binaries)
+{
+    m_deferredBinaries = binaries;
+}
+
+/**
+ * Leave out the history items of all entries.
+ *
+ * @param skip whether to skip history items
+ */
+void KdbxXmlReader::setSkipHistory(bool skip)
+{
+    m_skipHistory = skip;
+}
+
 bool KdbxXmlReader::hasError() const
 {
     return m_error || m_xml.hasError();
@@ -399,7 +546,7 @@ void KdbxXmlReader::parseBinaries()
             qWarning("KdbxXmlReader::parseBinaries: overwriting binary item \"%s\"", qPrintable(id));
         }
 
-        m_binaryPool.insert(id, data);
+        m_binaryPool.insert(id, shareBinary(data));
     }
 }
 
@@ -489,7 +636,8 @@ Group* KdbxXmlReader::parseGroup()
     QList<Group*> children;
     QList<Entry*> entries;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        switch (element(m_xml.name())) {
+        case Element::UUID: {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -500,21 +648,18 @@ Group* KdbxXmlReader::parseGroup()
             } else {
                 group->setUuid(uuid);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "Name") {
+        case Element::Name:
             group->setName(readString());
-            continue;
-        }
-        if (m_xml.name() == "Notes") {
+            break;
+        case Element::Notes:
             group->setNotes(readString());
-            continue;
-        }
-        if (m_xml.name() == "Tags") {
+            break;
+        case Element::Tags:
             group->setTags(readString());
-            continue;
-        }
-        if (m_xml.name() == "IconID") {
+            break;
+        case Element::IconID: {
             int iconId = readNumber();
             if (iconId < 0) {
                 if (m_strictMode) {
@@ -524,28 +669,25 @@ Group* KdbxXmlReader::parseGroup()
             }
 
             group->setIcon(iconId);
-            continue;
+            break;
         }
-        if (m_xml.name() == "CustomIconUUID") {
+        case Element::CustomIconUUID: {
             QUuid uuid = readUuid();
             if (!uuid.isNull()) {
                 group->setIcon(uuid);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "Times") {
+        case Element::Times:
             group->setTimeInfo(parseTimes());
-            continue;
-        }
-        if (m_xml.name() == "IsExpanded") {
+            break;
+        case Element::IsExpanded:
             group->setExpanded(readBool());
-            continue;
-        }
-        if (m_xml.name() == "DefaultAutoTypeSequence") {
+            break;
+        case Element::DefaultAutoTypeSequence:
             group->setDefaultAutoTypeSequence(readString());
-            continue;
-        }
-        if (m_xml.name() == "EnableAutoType") {
+            break;
+        case Element::EnableAutoType: {
             QString str = readString();
 
             if (str.compare("null", Qt::CaseInsensitive) == 0) {
@@ -557,9 +699,9 @@ Group* KdbxXmlReader::parseGroup()
             } else {
                 raiseError(tr("Invalid EnableAutoType value"));
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "EnableSearching") {
+        case Element::EnableSearching: {
             QString str = readString();
 
             if (str.compare("null", Qt::CaseInsensitive) == 0) {
@@ -571,36 +713,35 @@ Group* KdbxXmlReader::parseGroup()
             } else {
                 raiseError(tr("Invalid EnableSearching value"));
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "LastTopVisibleEntry") {
+        case Element::LastTopVisibleEntry:
             group->setLastTopVisibleEntry(getEntry(readUuid()));
-            continue;
-        }
-        if (m_xml.name() == "Group") {
+            break;
+        case Element::Group: {
             Group* newGroup = parseGroup();
             if (newGroup) {
                 children.append(newGroup);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "Entry") {
+        case Element::Entry: {
             Entry* newEntry = parseEntry(false);
             if (newEntry) {
                 entries.append(newEntry);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "CustomData") {
+        case Element::CustomData:
             parseCustomData(group->customData());
-            continue;
-        }
-        if (m_xml.name() == "PreviousParentGroup") {
+            break;
+        case Element::PreviousParentGroup:
             group->setPreviousParentGroupUuid(readUuid());
-            continue;
+            break;
+        default:
+            skipCurrentElement();
+            break;
         }
-
-        skipCurrentElement();
     }
 
     if (group->uuid().isNull() && !m_strictMode) {
@@ -687,7 +828,8 @@ Entry* KdbxXmlReader::parseEntry(bool history)
     QList<StringPair> binaryRefs;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        switch (element(m_xml.name())) {
+        case Element::UUID: {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -698,9 +840,9 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             } else {
                 entry->setUuid(uuid);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "IconID") {
+        case Element::IconID: {
             int iconId = readNumber();
             if (iconId < 0) {
                 if (m_strictMode) {
@@ -709,63 +851,56 @@ Entry* KdbxXmlReader::parseEntry(bool history)
                 iconId = 0;
             }
             entry->setIcon(iconId);
-            continue;
+            break;
         }
-        if (m_xml.name() == "CustomIconUUID") {
+        case Element::CustomIconUUID: {
             QUuid uuid = readUuid();
             if (!uuid.isNull()) {
                 entry->setIcon(uuid);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "ForegroundColor") {
+        case Element::ForegroundColor:
             entry->setForegroundColor(readColor());
-            continue;
-        }
-        if (m_xml.name() == "BackgroundColor") {
+            break;
+        case Element::BackgroundColor:
             entry->setBackgroundColor(readColor());
-            continue;
-        }
-        if (m_xml.name() == "OverrideURL") {
+            break;
+        case Element::OverrideURL:
             entry->setOverrideUrl(readString());
-            continue;
-        }
-        if (m_xml.name() == "Tags") {
-            entry->setTags(readString());
-            continue;
-        }
-        if (m_xml.name() == "Times") {
+            break;
+        case Element::Tags:
+            entry->setTags(shareString(readString()));
+            break;
+        case Element::Times:
             entry->setTimeInfo(parseTimes());
-            continue;
-        }
-        if (m_xml.name() == "String") {
+            break;
+        case Element::String:
             parseEntryString(entry);
-            continue;
-        }
-        if (m_xml.name() == "QualityCheck") {
+            break;
+        case Element::QualityCheck:
             entry->setExcludeFromReports(!readBool());
-            continue;
-        }
-        if (m_xml.name() == "Binary") {
+            break;
+        case Element::Binary: {
             QPair<QString, QString> ref = parseEntryBinary(entry);
             if (!ref.first.isEmpty() && !ref.second.isEmpty()) {
                 binaryRefs.append(ref);
             }
-            continue;
+            break;
         }
-        if (m_xml.name() == "AutoType") {
+        case Element::AutoType:
             parseAutoType(entry);
-            continue;
-        }
-        if (m_xml.name() == "History") {
+            break;
+        case Element::History:
             if (history) {
                 raiseError(tr("History element in history entry"));
+            } else if (m_skipHistory) {
+                m_xml.skipCurrentElement();
             } else {
                 historyItems = parseEntryHistory();
             }
-            continue;
-        }
-        if (m_xml.name() == "CustomData") {
+            break;
+        case Element::CustomData:
             parseCustomData(entry->customData());
 
             // Upgrade pre-KDBX-4.1 password report exclude flag
@@ -774,13 +909,14 @@ Entry* KdbxXmlReader::parseEntry(bool history)
                                              == TRUE_STR);
                 entry->customData()->remove(CustomData::ExcludeFromReportsLegacy);
             }
-            continue;
-        }
-        if (m_xml.name() == "PreviousParentGroup") {
+            break;
+        case Element::PreviousParentGroup:
             entry->setPreviousParentGroupUuid(readUuid());
-            continue;
+            break;
+        default:
+            skipCurrentElement();
+            break;
         }
-        skipCurrentElement();
     }
 
     if (entry->uuid().isNull() && !m_strictMode) {
@@ -832,17 +968,17 @@ void KdbxXmlReader::parseEntryString(Entry* entry)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        const auto name = element(m_xml.name());
+        if (name == Element::Key) {
             key = readString();
             keySet = true;
             continue;
         }
 
-        if (m_xml.name() == "Value") {
-            QXmlStreamAttributes attr = m_xml.attributes();
+        if (name == Element::Value) {
             bool isProtected;
             bool protectInMemory;
-            value = readString(isProtected, protectInMemory);
+            value = shareString(readString(isProtected, protectInMemory));
             protect = isProtected || protectInMemory;
             valueSet = true;
             continue;
@@ -876,12 +1012,13 @@ QPair<QString, QString> KdbxXmlReader::parseEntryBinary(Entry* entry)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        const auto name = element(m_xml.name());
+        if (name == Element::Key) {
             key = readString();
             keySet = true;
             continue;
         }
-        if (m_xml.name() == "Value") {
+        if (name == Element::Value) {
             QXmlStreamAttributes attr = m_xml.attributes();
 
             if (attr.hasAttribute("Ref")) {
@@ -889,7 +1026,7 @@ QPair<QString, QString> KdbxXmlReader::parseEntryBinary(Entry* entry)
                 m_xml.skipCurrentElement();
             } else {
                 // format compatibility
-                value = readBinary();
+                value = shareBinary(readBinary());
             }
 
             valueSet = true;
@@ -918,16 +1055,22 @@ void KdbxXmlReader::parseAutoType(Entry* entry)
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "AutoType");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Enabled") {
+        switch (element(m_xml.name())) {
+        case Element::Enabled:
             entry->setAutoTypeEnabled(readBool());
-        } else if (m_xml.name() == "DataTransferObfuscation") {
+            break;
+        case Element::DataTransferObfuscation:
             entry->setAutoTypeObfuscation(readNumber());
-        } else if (m_xml.name() == "DefaultSequence") {
-            entry->setDefaultAutoTypeSequence(readString());
-        } else if (m_xml.name() == "Association") {
+            break;
+        case Element::DefaultSequence:
+            entry->setDefaultAutoTypeSequence(shareString(readString()));
+            break;
+        case Element::Association:
             parseAutoTypeAssoc(entry);
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 }
@@ -941,11 +1084,12 @@ void KdbxXmlReader::parseAutoTypeAssoc(Entry* entry)
     bool sequenceSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Window") {
-            assoc.window = readString();
+        const auto name = element(m_xml.name());
+        if (name == Element::Window) {
+            assoc.window = shareString(readString());
             windowSet = true;
-        } else if (m_xml.name() == "KeystrokeSequence") {
-            assoc.sequence = readString();
+        } else if (name == Element::KeystrokeSequence) {
+            assoc.sequence = shareString(readString());
             sequenceSet = true;
         } else {
             skipCurrentElement();
@@ -966,7 +1110,7 @@ QList<Entry*> KdbxXmlReader::parseEntryHistory()
     QList<Entry*> historyItems;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Entry") {
+        if (element(m_xml.name()) == Element::Entry) {
             historyItems.append(parseEntry(true));
         } else {
             skipCurrentElement();
@@ -982,22 +1126,31 @@ TimeInfo KdbxXmlReader::parseTimes()
 
     TimeInfo timeInfo;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "LastModificationTime") {
+        switch (element(m_xml.name())) {
+        case Element::LastModificationTime:
             timeInfo.setLastModificationTime(readDateTime());
-        } else if (m_xml.name() == "CreationTime") {
+            break;
+        case Element::CreationTime:
             timeInfo.setCreationTime(readDateTime());
-        } else if (m_xml.name() == "LastAccessTime") {
+            break;
+        case Element::LastAccessTime:
             timeInfo.setLastAccessTime(readDateTime());
-        } else if (m_xml.name() == "ExpiryTime") {
+            break;
+        case Element::ExpiryTime:
             timeInfo.setExpiryTime(readDateTime());
-        } else if (m_xml.name() == "Expires") {
+            break;
+        case Element::Expires:
             timeInfo.setExpires(readBool());
-        } else if (m_xml.name() == "UsageCount") {
+            break;
+        case Element::UsageCount:
             timeInfo.setUsageCount(readNumber());
-        } else if (m_xml.name() == "LocationChanged") {
+            break;
+        case Element::LocationChanged:
             timeInfo.setLocationChanged(readDateTime());
-        } else {
+            break;
+        default:
             skipCurrentElement();
+            break;
         }
     }
 
@@ -1014,13 +1167,13 @@ QString KdbxXmlReader::readString()
 
 QString KdbxXmlReader::readString(bool& isProtected, bool& protectInMemory)
 {
-    QXmlStreamAttributes attr = m_xml.attributes();
-    isProtected = isTrueValue(attr.value("Protected"));
-    protectInMemory = isTrueValue(attr.value("ProtectInMemory"));
+    const QXmlStreamAttributes attr = m_xml.attributes();
+    isProtected = isTrueValue(attr.value(QLatin1String("Protected")));
+    protectInMemory = isTrueValue(attr.value(QLatin1String("ProtectInMemory")));
     QString value = m_xml.readElementText();
 
     if (isProtected && !value.isEmpty()) {
-        QByteArray ciphertext = QByteArray::fromBase64(value.toLatin1());
+        QByteArray ciphertext = Base64::decode(value);
         bool ok;
         QByteArray plaintext = m_randomStream->process(ciphertext, &ok);
         if (!ok) {
@@ -1056,9 +1209,10 @@ QDateTime KdbxXmlReader::readDateTime()
 {
     QString str = readString();
     if (Tools::isBase64(str.toLatin1())) {
-        QByteArray secsBytes = QByteArray::fromBase64(str.toUtf8()).leftJustified(8, '\0', true).left(8);
+        QByteArray secsBytes = Base64::decode(str).leftJustified(8, '\0', true).left(8);
         qint64 secs = Endian::bytesToSizedInt<quint64>(secsBytes, KeePass2::BYTEORDER);
-        return QDateTime(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC).addSecs(secs);
+        static const QDateTime yearOne(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC);
+        return yearOne.addSecs(secs);
     }
 
     QDateTime dt = Clock::parse(str, Qt::ISODate);
@@ -1132,24 +1286,73 @@ QByteArray KdbxXmlReader::readBinary()
 {
     QXmlStreamAttributes attr = m_xml.attributes();
     bool isProtected = isTrueValue(attr.value("Protected"));
-    QString value = m_xml.readElementText();
-    QByteArray data = QByteArray::fromBase64(value.toLatin1());
 
-    if (isProtected && !data.isEmpty()) {
-        bool ok;
-        QByteArray plaintext = m_randomStream->process(data, &ok);
-        if (!ok) {
-            data.clear();
-            raiseError(m_randomStream->errorString());
-            return data;
+    // Decode the element text as it is tokenized instead of copying it into
+    // an intermediate QString and Latin-1 QByteArray first
+    QByteArray data;
+    Base64::Decoder decoder(data);
+    while (!m_xml.atEnd()) {
+        auto token = m_xml.readNext();
+        if (token == QXmlStreamReader::Characters || token == QXmlStreamReader::EntityReference) {
+            decoder.decode(m_xml.text());
+        } else if (token == QXmlStreamReader::StartElement) {
+            m_xml.raiseError(tr("Expected character data."));
+            break;
+        } else if (token == QXmlStreamReader::EndElement || token == QXmlStreamReader::Invalid) {
+            break;
         }
+    }
 
-        data = plaintext;
+    if (isProtected && !data.isEmpty() && !m_randomStream->processInPlace(data)) {
+        data.clear();
+        raiseError(m_randomStream->errorString());
     }
 
     return data;
 }
 
+/**
+ * Return a copy of data that shares its buffer with an identical binary read earlier.
+ *
+ * @param data binary data
+ * @return implicitly shared binary data
+ */
+QByteArray KdbxXmlReader::shareBinary(const QByteArray& data)
+{
+    if (data.isEmpty()) {
+        return data;
+    }
+
+    auto existing = m_uniqueBinaries.constFind(data);
+    if (existing != m_uniqueBinaries.constEnd()) {
+        return *existing;
+    }
+    m_uniqueBinaries.insert(data);
+    return data;
+}
+
+/**
+ * Share the data of repeated strings, such as the attribute values history
+ * items have in common with their entry, so they are allocated, and scrubbed
+ * when the database is released, only once.
+ *
+ * @param str string read from the XML stream
+ * @return string sharing its data with an identical string read before
+ */
+QString KdbxXmlReader::shareString(const QString& str)
+{
+    if (str.isEmpty()) {
+        return str;
+    }
+
+    auto existing = m_uniqueStrings.constFind(str);
+    if (existing != m_uniqueStrings.constEnd()) {
+        return *existing;
+    }
+    m_uniqueStrings.insert(str);
+    return str;
+}
+
 QByteArray KdbxXmlReader::readCompressedBinary()
 {
     QByteArray rawData = readBinary();
@@ -19,10 +19,12 @@
 #define KEEPASSXC_KDBXXMLREADER_H
 
 #include "core/Database.h"
+#include "core/EntryAttachments.h"
 #include "core/Metadata.h"
 
 #include <QCoreApplication>
 #include <QMultiHash>
+#include <QSet>
 #include <QXmlStreamReader>
 
 class QIODevice;
@@ -55,6 +57,9 @@ public:
     bool strictMode() const;
     void setStrictMode(bool strictMode);
 
+    void setDeferredBinaries(const QHash<QString, DeferredAttachment>& binaries);
+    void setSkipHistory(bool skip);
+
 protected:
     typedef QPair<QString, QString> StringPair;
 
@@ -87,6 +92,8 @@ protected:
     virtual QUuid readUuid();
     virtual QByteArray readBinary();
     virtual QByteArray readCompressedBinary();
+    QByteArray shareBinary(const QByteArray& data);
+    QString shareString(const QString& str);
 
     virtual void skipCurrentElement();
 
@@ -99,6 +106,7 @@ protected:
     const quint32 m_kdbxVersion;
 
     bool m_strictMode = false;
+    bool m_skipHistory = false;
 
     QPointer<Database> m_db;
     QPointer<Metadata> m_meta;
@@ -111,6 +119,9 @@ protected:
 
     QHash<QString, QByteArray> m_binaryPool;
     QMultiHash<QString, QPair<Entry*, QString>> m_binaryMap;
+    QSet<QByteArray> m_uniqueBinaries;
+    QSet<QString> m_uniqueStrings;
+    QHash<QString, DeferredAttachment> m_deferredBinaries;
     QByteArray m_headerHash;
 
     bool m_error = false;
@@ -20,8 +20,9 @@
 #include <QBuffer>
 #include <QFile>
 #include <QMap>
+#include <QtEndian>
 
-#include "core/Endian.h"
+#include "config-keepassx.h"
 #include "crypto/CryptoHash.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/qtiocompressor.h"
@@ -53,16 +54,12 @@ void KdbxXmlWriter::writeDatabase(QIODevice* device,
     m_randomStream = randomStream;
     m_headerHash = headerHash;
 
-    m_xml.setAutoFormatting(true);
-    m_xml.setAutoFormattingIndent(-1); // 1 tab
-    m_xml.setCodec("UTF-8");
-
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4) {
         fillBinaryIdxMap();
     }
 
     m_xml.setDevice(device);
-    m_xml.writeStartDocument("1.0", true);
+    m_xml.writeStartDocument();
     m_xml.writeStartElement("KeePassFile");
 
     writeMetadata();
@@ -95,42 +92,73 @@ QString KdbxXmlWriter::errorString()
 
 /**
  * Generate a map of entry attachments to deduplicated attachment index IDs.
- * This is basically duplicated code from Kdbx4Writer.cpp for KDBX 3 compatibility.
- * I don't have a good solution for getting rid of this duplication without getting rid of KDBX 3.
  */
 void KdbxXmlWriter::fillBinaryIdxMap()
 {
-    const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(true);
-    QHash<QByteArray, qint64> writtenAttachments;
-    qint64 nextIdx = 0;
+    QList<QByteArray> attachments;
+    m_binaryIdxMap = indexAttachments(m_db, attachments);
+}
 
-    for (Entry* entry : allEntries) {
-        const QList<QString> attachmentKeys = entry->attachments()->keys();
-        for (const QString& key : attachmentKeys) {
-            QByteArray data = entry->attachments()->value(key);
-            CryptoHash hash(CryptoHash::Sha256);
+/**
+ * Deduplicate the attachments of all entries and history items by content.
+ *
+ * Entries, their history items and the attachments read from a file share the data
+ * of identical attachments, such shared data is recognized without hashing it again.
+ *
+ * @param db database to index
+ * @param attachments receives the data of every index, in index order
+ * @return map of entry attachments to their index
+ */
+KdbxXmlWriter::BinaryIdxMap KdbxXmlWriter::indexAttachments(const Database* db, QList<QByteArray>& attachments)
+{
+    BinaryIdxMap idxMap;
+    QHash<QByteArray, qint64> writtenAttachments;
+    QHash<QPair<QByteArray, const char*>, qint64> sharedAttachments;
+
+    db->rootGroup()->forEachEntryRecursive(
+        [&](const Entry* entry) {
+            const QList<QString> attachmentKeys = entry->attachments()->keys();
+            for (const QString& key : attachmentKeys) {
+                const QByteArray data = entry->attachments()->value(key);
+                QByteArray dedupNamespace;
 #ifdef WITH_XC_KEESHARE
-            // Namespace KeeShare attachments so they don't get deduplicated together with attachments
-            // from other databases. Prevents potential filesize side channels.
-            auto group = entry->group();
-            if (!group && entry->historyOwner()) {
-                group = entry->historyOwner()->group();
-            }
-            if (group && group->isShared()) {
-                hash.addData(group->uuid().toByteArray());
-            } else {
-                hash.addData(m_db->uuid().toByteArray());
-            }
+                // Namespace KeeShare attachments so they don't get deduplicated together with attachments
+                // from other databases. Prevents potential filesize side channels.
+                auto group = entry->group();
+                if (!group && entry->historyOwner()) {
+                    group = entry->historyOwner()->group();
+                }
+                if (group && group->isShared()) {
+                    dedupNamespace = group->uuid().toByteArray();
+                } else {
+                    dedupNamespace = db->uuid().toByteArray();
+                }
 #endif
-            hash.addData(data);
+                // The data stays alive and unchanged while indexing, so its address identifies it
+                const auto shareKey = qMakePair(dedupNamespace, data.constData());
+                auto shared = sharedAttachments.constFind(shareKey);
+                if (shared != sharedAttachments.constEnd()) {
+                    idxMap.insert(qMakePair(entry, key), shared.value());
+                    continue;
+                }
 
-            const auto hashResult = hash.result();
-            if (!writtenAttachments.contains(hashResult)) {
-                writtenAttachments.insert(hashResult, nextIdx++);
+                CryptoHash hash(CryptoHash::Sha256);
+                hash.addData(dedupNamespace);
+                hash.addData(data);
+                const auto hashResult = hash.result();
+                auto written = writtenAttachments.constFind(hashResult);
+                if (written == writtenAttachments.constEnd()) {
+                    written = writtenAttachments.insert(hashResult, attachments.size());
+                    attachments.append(data);
+                }
+                sharedAttachments.insert(shareKey, written.value());
+                idxMap.insert(qMakePair(entry, key), written.value());
             }
-            m_binaryIdxMap.insert(qMakePair(entry, key), writtenAttachments.value(hashResult));
-        }
-    }
+            return true;
+        },
+        true);
+
+    return idxMap;
 }
 
 void KdbxXmlWriter::writeMetadata()
@@ -230,7 +258,7 @@ void KdbxXmlWriter::writeBinaries()
 
     for (auto i = binaries.constBegin(); i != binaries.constEnd(); ++i) {
         m_xml.writeStartElement("Binary");
-        m_xml.writeAttribute("ID", QString::number(i.key()));
+        m_xml.writeAttribute("ID", i.key());
 
         QByteArray data;
         if (m_db->compressionAlgorithm() == Database::CompressionGZip) {
@@ -255,7 +283,7 @@ void KdbxXmlWriter::writeBinaries()
         }
 
         if (!data.isEmpty()) {
-            m_xml.writeCharacters(QString::fromLatin1(data.toBase64()));
+            m_xml.writeBase64(data);
         }
         m_xml.writeEndElement();
     }
@@ -431,27 +459,24 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
         writeString("Key", key);
 
         m_xml.writeStartElement("Value");
-        QString value;
-
-        if (protect) {
-            if (!m_innerStreamProtectionDisabled && m_randomStream) {
-                m_xml.writeAttribute("Protected", "True");
-                bool ok;
-                QByteArray rawData = m_randomStream->process(entry->attributes()->value(key).toUtf8(), &ok);
-                if (!ok) {
-                    raiseError(m_randomStream->errorString());
-                }
-                value = QString::fromLatin1(rawData.toBase64());
-            } else {
-                m_xml.writeAttribute("ProtectInMemory", "True");
-                value = entry->attributes()->value(key);
+        const QString value = entry->attributes()->value(key);
+
+        if (protect && !m_innerStreamProtectionDisabled && m_randomStream) {
+            m_xml.writeAttribute("Protected", "True");
+            QByteArray rawData = value.toUtf8();
+            if (!m_randomStream->processInPlace(rawData)) {
+                raiseError(m_randomStream->errorString());
+            }
+            if (!rawData.isEmpty()) {
+                m_xml.writeBase64(rawData);
             }
         } else {
-            value = entry->attributes()->value(key);
-        }
-
-        if (!value.isEmpty()) {
-            m_xml.writeCharacters(stripInvalidXml10Chars(value));
+            if (protect) {
+                m_xml.writeAttribute("ProtectInMemory", "True");
+            }
+            if (!value.isEmpty()) {
+                m_xml.writeCharacters(stripInvalidXml10Chars(value));
+            }
         }
         m_xml.writeEndElement();
 
@@ -465,7 +490,7 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
         writeString("Key", key);
 
         m_xml.writeStartElement("Value");
-        m_xml.writeAttribute("Ref", QString::number(m_binaryIdxMap[qMakePair(entry, key)]));
+        m_xml.writeAttribute("Ref", m_binaryIdxMap[qMakePair(entry, key)]);
         m_xml.writeEndElement();
 
         m_xml.writeEndElement();
@@ -523,56 +548,71 @@ void KdbxXmlWriter::writeEntryHistory(const Entry* entry)
     m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeString(const QString& qualifiedName, const QString& string)
+void KdbxXmlWriter::writeString(const char* qualifiedName, const QString& string)
 {
     if (string.isEmpty()) {
         m_xml.writeEmptyElement(qualifiedName);
     } else {
-        m_xml.writeTextElement(qualifiedName, stripInvalidXml10Chars(string));
+        m_xml.writeStartElement(qualifiedName);
+        m_xml.writeCharacters(stripInvalidXml10Chars(string));
+        m_xml.writeEndElement();
     }
 }
 
-void KdbxXmlWriter::writeNumber(const QString& qualifiedName, int number)
+void KdbxXmlWriter::writeNumber(const char* qualifiedName, int number)
 {
-    writeString(qualifiedName, QString::number(number));
+    m_xml.writeStartElement(qualifiedName);
+    m_xml.writeNumber(number);
+    m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeBool(const QString& qualifiedName, bool b)
+void KdbxXmlWriter::writeBool(const char* qualifiedName, bool b)
 {
-    if (b) {
-        writeString(qualifiedName, "True");
-    } else {
-        writeString(qualifiedName, "False");
-    }
+    m_xml.writeStartElement(qualifiedName);
+    m_xml.writeCharacters(b ? "True" : "False");
+    m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeDateTime(const QString& qualifiedName, const QDateTime& dateTime)
+void KdbxXmlWriter::writeDateTime(const char* qualifiedName, const QDateTime& dateTime)
 {
     Q_ASSERT(dateTime.isValid());
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
 
-    QString dateTimeStr;
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4) {
-        dateTimeStr = dateTime.toString(Qt::ISODate);
+        QString dateTimeStr = dateTime.toString(Qt::ISODate);
 
         // Qt < 4.8 doesn't append a 'Z' at the end
         if (!dateTimeStr.isEmpty() && dateTimeStr[dateTimeStr.size() - 1] != 'Z') {
             dateTimeStr.append('Z');
         }
+        writeString(qualifiedName, dateTimeStr);
     } else {
         qint64 secs = QDateTime(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC).secsTo(dateTime);
-        QByteArray secsBytes = Endian::sizedIntToBytes(secs, KeePass2::BYTEORDER);
-        dateTimeStr = QString::fromLatin1(secsBytes.toBase64());
+        char secsBytes[sizeof(qint64)];
+        Q_STATIC_ASSERT(KeePass2::BYTEORDER == QSysInfo::LittleEndian);
+        qToLittleEndian(secs, secsBytes);
+
+        m_xml.writeStartElement(qualifiedName);
+        m_xml.writeBase64(secsBytes, sizeof(secsBytes));
+        m_xml.writeEndElement();
     }
-    writeString(qualifiedName, dateTimeStr);
 }
 
-void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const QUuid& uuid)
+void KdbxXmlWriter::writeUuid(const char* qualifiedName, const QUuid& uuid)
 {
-    writeString(qualifiedName, uuid.toRfc4122().toBase64());
+    // Same layout as QUuid::toRfc4122() without the temporary byte array
+    char bytes[16];
+    qToBigEndian(uuid.data1, bytes);
+    qToBigEndian(uuid.data2, bytes + 4);
+    qToBigEndian(uuid.data3, bytes + 6);
+    memcpy(bytes + 8, uuid.data4, sizeof(uuid.data4));
+
+    m_xml.writeStartElement(qualifiedName);
+    m_xml.writeBase64(bytes, sizeof(bytes));
+    m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Group* group)
+void KdbxXmlWriter::writeUuid(const char* qualifiedName, const Group* group)
 {
     if (group) {
         writeUuid(qualifiedName, group->uuid());
@@ -581,7 +621,7 @@ void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Group* group)
     }
 }
 
-void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Entry* entry)
+void KdbxXmlWriter::writeUuid(const char* qualifiedName, const Entry* entry)
 {
     if (entry) {
         writeUuid(qualifiedName, entry->uuid());
@@ -590,24 +630,28 @@ void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Entry* entry)
     }
 }
 
-void KdbxXmlWriter::writeBinary(const QString& qualifiedName, const QByteArray& ba)
+void KdbxXmlWriter::writeBinary(const char* qualifiedName, const QByteArray& ba)
 {
-    writeString(qualifiedName, QString::fromLatin1(ba.toBase64()));
+    if (ba.isEmpty()) {
+        m_xml.writeEmptyElement(qualifiedName);
+    } else {
+        m_xml.writeStartElement(qualifiedName);
+        m_xml.writeBase64(ba);
+        m_xml.writeEndElement();
+    }
 }
 
-void KdbxXmlWriter::writeTriState(const QString& qualifiedName, Group::TriState triState)
+void KdbxXmlWriter::writeTriState(const char* qualifiedName, Group::TriState triState)
 {
-    QString value;
-
+    m_xml.writeStartElement(qualifiedName);
     if (triState == Group::Inherit) {
-        value = "null";
+        m_xml.writeCharacters("null");
     } else if (triState == Group::Enable) {
-        value = "true";
+        m_xml.writeCharacters("true");
     } else {
-        value = "false";
+        m_xml.writeCharacters("false");
     }
-
-    writeString(qualifiedName, value);
+    m_xml.writeEndElement();
 }
 
 QString KdbxXmlWriter::colorPartToString(int value)
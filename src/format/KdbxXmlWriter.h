@@ -19,11 +19,11 @@
 #define KEEPASSX_KDBXXMLWRITER_H
 
 #include <QDateTime>
-#include <QXmlStreamWriter>
 
 #include "core/CustomData.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "format/XmlStreamWriter.h"
 
 class KeePass2RandomStream;
 
@@ -48,6 +48,8 @@ public:
     bool hasError();
     QString errorString();
 
+    static BinaryIdxMap indexAttachments(const Database* db, QList<QByteArray>& attachments);
+
 private:
     void fillBinaryIdxMap();
 
@@ -69,15 +71,15 @@ private:
     void writeAutoTypeAssoc(const AutoTypeAssociations::Association& assoc);
     void writeEntryHistory(const Entry* entry);
 
-    void writeString(const QString& qualifiedName, const QString& string);
-    void writeNumber(const QString& qualifiedName, int number);
-    void writeBool(const QString& qualifiedName, bool b);
-    void writeDateTime(const QString& qualifiedName, const QDateTime& dateTime);
-    void writeUuid(const QString& qualifiedName, const QUuid& uuid);
-    void writeUuid(const QString& qualifiedName, const Group* group);
-    void writeUuid(const QString& qualifiedName, const Entry* entry);
-    void writeBinary(const QString& qualifiedName, const QByteArray& ba);
-    void writeTriState(const QString& qualifiedName, Group::TriState triState);
+    void writeString(const char* qualifiedName, const QString& string);
+    void writeNumber(const char* qualifiedName, int number);
+    void writeBool(const char* qualifiedName, bool b);
+    void writeDateTime(const char* qualifiedName, const QDateTime& dateTime);
+    void writeUuid(const char* qualifiedName, const QUuid& uuid);
+    void writeUuid(const char* qualifiedName, const Group* group);
+    void writeUuid(const char* qualifiedName, const Entry* entry);
+    void writeBinary(const char* qualifiedName, const QByteArray& ba);
+    void writeTriState(const char* qualifiedName, Group::TriState triState);
     QString colorPartToString(int value);
     QString stripInvalidXml10Chars(QString str);
 
@@ -87,7 +89,7 @@ private:
 
     bool m_innerStreamProtectionDisabled = false;
 
-    QXmlStreamWriter m_xml;
+    XmlStreamWriter m_xml;
     QPointer<const Database> m_db;
     QPointer<const Metadata> m_meta;
     KeePass2RandomStream* m_randomStream = nullptr;
@@ -26,9 +26,47 @@
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "crypto/CryptoHash.h"
+#include "crypto/SymmetricCipher.h"
 #include "format/KeePass1.h"
 #include "keys/FileKey.h"
-#include "streams/SymmetricCipherStream.h"
+
+namespace
+{
+    /**
+     * Read an integer of the decrypted content in place.
+     */
+    template <typename SizedQInt> bool readInt(const QByteArray& content, int& pos, SizedQInt& value)
+    {
+        if (content.size() - pos < static_cast<int>(sizeof(SizedQInt))) {
+            return false;
+        }
+        value = Endian::bytesToSizedInt<SizedQInt>(QByteArray::fromRawData(content.constData() + pos, sizeof(SizedQInt)),
+                                                   KeePass1::BYTEORDER);
+        pos += sizeof(SizedQInt);
+        return true;
+    }
+
+    /**
+     * Get a field of the decrypted content as a view that shares its data.
+     */
+    bool readFieldData(const QByteArray& content, int& pos, int size, QByteArray& data)
+    {
+        if (size < 0 || content.size() - pos < size) {
+            return false;
+        }
+        data = QByteArray::fromRawData(content.constData() + pos, size);
+        pos += size;
+        return true;
+    }
+
+    /**
+     * @return text of a zero terminated field, views are not terminated behind the field
+     */
+    QString fieldString(const QByteArray& data)
+    {
+        return QString::fromUtf8(data.constData(), static_cast<int>(qstrnlen(data.constData(), data.size())));
+    }
+} // namespace
 
 class KeePass1Key : public CompositeKey
 {
@@ -159,17 +197,16 @@ KeePass1Reader::readDatabase(QIODevice* device, const QString& password, QIODevi
     kdf->setSeed(m_transformSeed);
     db->setKdf(kdf);
 
-    qint64 contentPos = m_device->pos();
-
-    QScopedPointer<SymmetricCipherStream> cipherStream(testKeys(password, keyfileData, contentPos));
-
-    if (!cipherStream) {
+    // Groups and entries are read from a single decrypted buffer
+    QByteArray content;
+    if (!testKeys(password, keyfileData, content)) {
         return {};
     }
 
+    int pos = 0;
     QList<Group*> groups;
     for (quint32 i = 0; i < numGroups; i++) {
-        Group* group = readGroup(cipherStream.data());
+        Group* group = readGroup(content, pos);
         if (!group) {
             return {};
         }
@@ -178,12 +215,13 @@ KeePass1Reader::readDatabase(QIODevice* device, const QString& password, QIODevi
 
     QList<Entry*> entries;
     for (quint32 i = 0; i < numEntries; i++) {
-        Entry* entry = readEntry(cipherStream.data());
+        Entry* entry = readEntry(content, pos);
         if (!entry) {
             return {};
         }
         entries.append(entry);
     }
+    content.fill('\0');
 
     if (!constructGroupTree(groups)) {
         raiseError(tr("Unable to construct group tree"));
@@ -293,12 +331,18 @@ QString KeePass1Reader::errorString()
     return m_errorStr;
 }
 
-SymmetricCipherStream*
-KeePass1Reader::testKeys(const QString& password, const QByteArray& keyfileData, qint64 contentPos)
+/**
+ * Decrypt the content with the password in each of the encodings used by KeePass and KeePassX.
+ *
+ * @param content set to the decrypted content
+ * @return true if the decrypted content matches the content hash of the header
+ */
+bool KeePass1Reader::testKeys(const QString& password, const QByteArray& keyfileData, QByteArray& content)
 {
     const QList<PasswordEncoding> encodings = {Windows1252, Latin1, UTF8};
 
-    QScopedPointer<SymmetricCipherStream> cipherStream;
+    // The content is read once and decrypted as a whole for every encoding
+    const QByteArray encryptedContent = m_device->readAll();
     QByteArray passwordData;
     QTextCodec* codec = QTextCodec::codecForName("Windows-1252");
     QByteArray passwordDataCorrect = codec->fromUnicode(password);
@@ -330,56 +374,30 @@ KeePass1Reader::testKeys(const QString& password, const QByteArray& keyfileData,
 
         QByteArray finalKey = key(passwordData, keyfileData);
         if (finalKey.isEmpty()) {
-            return nullptr;
+            return false;
         }
 
-        cipherStream.reset(new SymmetricCipherStream(m_device));
-
         auto mode = SymmetricCipher::Aes256_CBC;
         if (m_encryptionFlags & KeePass1::Twofish) {
             mode = SymmetricCipher::Twofish_CBC;
         }
-        if (!cipherStream->init(mode, SymmetricCipher::Decrypt, finalKey, m_encryptionIV)) {
-            raiseError(cipherStream->errorString());
-            return nullptr;
-        }
-        if (!cipherStream->open(QIODevice::ReadOnly)) {
-            raiseError(cipherStream->errorString());
-            return nullptr;
-        }
-
-        bool success = verifyKey(cipherStream.data());
-
-        cipherStream->reset();
-        cipherStream->close();
-        if (!m_device->seek(contentPos)) {
-            QString msg = tr("unable to seek to content position");
-            if (!m_device->errorString().isEmpty()) {
-                msg.append("\n").append(m_device->errorString());
-            }
-            raiseError(msg);
-
-            return nullptr;
+        SymmetricCipher cipher;
+        if (!cipher.init(mode, SymmetricCipher::Decrypt, finalKey, m_encryptionIV)) {
+            raiseError(cipher.errorString());
+            return false;
         }
 
-        if (success) {
-            if (!cipherStream->init(mode, SymmetricCipher::Decrypt, finalKey, m_encryptionIV)) {
-                raiseError(cipherStream->errorString());
-                return nullptr;
-            }
-            cipherStream->open(QIODevice::ReadOnly);
-            break;
-        } else {
-            cipherStream.reset();
+        // Wrong keys usually fail to remove the padding already
+        content = encryptedContent;
+        if (cipher.finish(content) && verifyKey(content)) {
+            return true;
         }
     }
 
-    if (!cipherStream) {
-        raiseError(tr("Invalid credentials were provided, please try again.\n"
-                      "If this reoccurs, then your database file may be corrupt."));
-    }
-
-    return cipherStream.take();
+    content.clear();
+    raiseError(tr("Invalid credentials were provided, please try again.\n"
+                  "If this reoccurs, then your database file may be corrupt."));
+    return false;
 }
 
 QByteArray KeePass1Reader::key(const QByteArray& password, const QByteArray& keyfileData)
@@ -405,22 +423,12 @@ QByteArray KeePass1Reader::key(const QByteArray& password, const QByteArray& key
     return hash.result();
 }
 
-bool KeePass1Reader::verifyKey(SymmetricCipherStream* cipherStream)
+bool KeePass1Reader::verifyKey(const QByteArray& content)
 {
-    CryptoHash contentHash(CryptoHash::Sha256);
-    QByteArray buffer;
-
-    do {
-        if (!Tools::readFromDevice(cipherStream, buffer)) {
-            return false;
-        }
-        contentHash.addData(buffer);
-    } while (!buffer.isEmpty());
-
-    return contentHash.result() == m_contentHashHeader;
+    return CryptoHash::hash(content, CryptoHash::Sha256) == m_contentHashHeader;
 }
 
-Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
+Group* KeePass1Reader::readGroup(const QByteArray& content, int& pos)
 {
     QScopedPointer<Group> group(new Group());
     group->setUpdateTimeinfo(false);
@@ -433,24 +441,23 @@ Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
     bool groupIdSet = false;
     bool groupLevelSet = false;
 
-    bool ok;
     bool reachedEnd = false;
 
     do {
-        auto fieldType = Endian::readSizedInt<quint16>(cipherStream, KeePass1::BYTEORDER, &ok);
-        if (!ok) {
+        quint16 fieldType;
+        if (!readInt(content, pos, fieldType)) {
             raiseError(tr("Invalid group field type number"));
             return nullptr;
         }
 
-        auto fieldSize = static_cast<int>(Endian::readSizedInt<quint32>(cipherStream, KeePass1::BYTEORDER, &ok));
-        if (!ok) {
+        quint32 fieldSize;
+        if (!readInt(content, pos, fieldSize)) {
             raiseError(tr("Invalid group field size"));
             return nullptr;
         }
 
-        QByteArray fieldData = cipherStream->read(fieldSize);
-        if (fieldData.size() != fieldSize) {
+        QByteArray fieldData;
+        if (!readFieldData(content, pos, static_cast<int>(fieldSize), fieldData)) {
             raiseError(tr("Read group field data doesn't match size"));
             return nullptr;
         }
@@ -468,7 +475,7 @@ Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
             groupIdSet = true;
             break;
         case 0x0002:
-            group->setName(QString::fromUtf8(fieldData.constData()));
+            group->setName(fieldString(fieldData));
             break;
         case 0x0003: {
             if (fieldSize != 5) {
@@ -557,7 +564,7 @@ Group* KeePass1Reader::readGroup(QIODevice* cipherStream)
     return group.take();
 }
 
-Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
+Entry* KeePass1Reader::readEntry(const QByteArray& content, int& pos)
 {
     QScopedPointer<Entry> entry(new Entry());
     entry->setUpdateTimeinfo(false);
@@ -565,24 +572,23 @@ Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
 
     TimeInfo timeInfo;
     QString binaryName;
-    bool ok;
     bool reachedEnd = false;
 
     do {
-        auto fieldType = Endian::readSizedInt<quint16>(cipherStream, KeePass1::BYTEORDER, &ok);
-        if (!ok) {
+        quint16 fieldType;
+        if (!readInt(content, pos, fieldType)) {
             raiseError(tr("Missing entry field type number"));
             return nullptr;
         }
 
-        auto fieldSize = static_cast<int>(Endian::readSizedInt<quint32>(cipherStream, KeePass1::BYTEORDER, &ok));
-        if (!ok) {
+        quint32 fieldSize;
+        if (!readInt(content, pos, fieldSize)) {
             raiseError(tr("Invalid entry field size"));
             return nullptr;
         }
 
-        QByteArray fieldData = cipherStream->read(fieldSize);
-        if (fieldData.size() != fieldSize) {
+        QByteArray fieldData;
+        if (!readFieldData(content, pos, static_cast<int>(fieldSize), fieldData)) {
             raiseError(tr("Read entry field data doesn't match size"));
             return nullptr;
         }
@@ -617,19 +623,19 @@ Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
             break;
         }
         case 0x0004:
-            entry->setTitle(QString::fromUtf8(fieldData.constData()));
+            entry->setTitle(fieldString(fieldData));
             break;
         case 0x0005:
-            entry->setUrl(QString::fromUtf8(fieldData.constData()));
+            entry->setUrl(fieldString(fieldData));
             break;
         case 0x0006:
-            entry->setUsername(QString::fromUtf8(fieldData.constData()));
+            entry->setUsername(fieldString(fieldData));
             break;
         case 0x0007:
-            entry->setPassword(QString::fromUtf8(fieldData.constData()));
+            entry->setPassword(fieldString(fieldData));
             break;
         case 0x0008:
-            parseNotes(QString::fromUtf8(fieldData.constData()), entry.data());
+            parseNotes(fieldString(fieldData), entry.data());
             break;
         case 0x0009: {
             if (fieldSize != 5) {
@@ -677,11 +683,12 @@ Entry* KeePass1Reader::readEntry(QIODevice* cipherStream)
             break;
         }
         case 0x000D:
-            binaryName = QString::fromUtf8(fieldData.constData());
+            binaryName = fieldString(fieldData);
             break;
         case 0x000E:
             if (fieldSize != 0) {
-                entry->attachments()->set(binaryName, fieldData);
+                // Copy the attachment out of the decrypted content
+                entry->attachments()->set(binaryName, QByteArray(fieldData.constData(), fieldData.size()));
             }
             break;
         case 0xFFFF:
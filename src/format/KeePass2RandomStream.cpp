@@ -42,62 +42,27 @@ bool KeePass2RandomStream::init(SymmetricCipher::Mode mode, const QByteArray& ke
 
 QByteArray KeePass2RandomStream::randomBytes(int size, bool* ok)
 {
-    QByteArray result;
-
-    int bytesRemaining = size;
-
-    while (bytesRemaining > 0) {
-        if (m_buffer.size() == m_offset) {
-            if (!loadBlock()) {
-                *ok = false;
-                return {};
-            }
-        }
-
-        int bytesToCopy = qMin(bytesRemaining, m_buffer.size() - m_offset);
-        result.append(m_buffer.mid(m_offset, bytesToCopy));
-        m_offset += bytesToCopy;
-        bytesRemaining -= bytesToCopy;
+    QByteArray result(size, '\0');
+    *ok = applyKeystream(result.data(), size);
+    if (!*ok) {
+        return {};
     }
-
-    *ok = true;
     return result;
 }
 
 QByteArray KeePass2RandomStream::process(const QByteArray& data, bool* ok)
 {
-    bool randomBytesOk;
-
-    QByteArray randomData = randomBytes(data.size(), &randomBytesOk);
-    if (!randomBytesOk) {
-        *ok = false;
+    QByteArray result = data;
+    *ok = processInPlace(result);
+    if (!*ok) {
         return {};
     }
-
-    QByteArray result;
-    result.resize(data.size());
-
-    for (int i = 0; i < data.size(); i++) {
-        result[i] = data[i] ^ randomData[i];
-    }
-
-    *ok = true;
     return result;
 }
 
 bool KeePass2RandomStream::processInPlace(QByteArray& data)
 {
-    bool ok;
-    QByteArray randomData = randomBytes(data.size(), &ok);
-    if (!ok) {
-        return false;
-    }
-
-    for (int i = 0; i < data.size(); i++) {
-        data[i] = data[i] ^ randomData[i];
-    }
-
-    return true;
+    return applyKeystream(data.data(), data.size());
 }
 
 QString KeePass2RandomStream::errorString() const
@@ -105,11 +70,45 @@ QString KeePass2RandomStream::errorString() const
     return m_cipher.errorString();
 }
 
+/**
+ * XOR data with the next bytes of the keystream.
+ *
+ * Protected values are usually only a few bytes long, so the keystream is
+ * generated ahead in large chunks instead of one cipher call per value.
+ *
+ * @param data buffer to process in place
+ * @param size number of bytes
+ * @return true on success
+ */
+bool KeePass2RandomStream::applyKeystream(char* data, int size)
+{
+    int offset = 0;
+    while (offset < size) {
+        if (m_buffer.size() == m_offset && !loadBlock()) {
+            return false;
+        }
+
+        int bytesToProcess = qMin(size - offset, m_buffer.size() - m_offset);
+        auto out = reinterpret_cast<uchar*>(data + offset);
+        auto keystream = reinterpret_cast<const uchar*>(m_buffer.constData() + m_offset);
+        // Plain loop over raw pointers, the compiler vectorizes this
+        for (int i = 0; i < bytesToProcess; ++i) {
+            out[i] ^= keystream[i];
+        }
+
+        m_offset += bytesToProcess;
+        offset += bytesToProcess;
+    }
+
+    return true;
+}
+
 bool KeePass2RandomStream::loadBlock()
 {
     Q_ASSERT(m_offset == m_buffer.size());
 
-    m_buffer.fill('\0', m_cipher.blockSize(m_cipher.mode()));
+    // The cipher blocks are small, generate many of them at once
+    m_buffer.fill('\0', KeystreamBufferSize);
     if (!m_cipher.process(m_buffer)) {
         return false;
     }
@@ -32,6 +32,9 @@ public:
     QString errorString() const;
 
 private:
+    static const int KeystreamBufferSize = 64 * 1024;
+
+    bool applyKeystream(char* data, int size);
     bool loadBlock();
 
     SymmetricCipher m_cipher;
@@ -22,6 +22,29 @@
 #include "keys/CompositeKey.h"
 
 #include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+
+namespace
+{
+    // Files whose public custom data is kept, recent databases are far fewer
+    const int MaxPeekedFiles = 256;
+
+    struct PeekedFile
+    {
+        qint64 size = 0;
+        QDateTime lastModified;
+        QVariantMap publicCustomData;
+    };
+
+    struct PeekCache
+    {
+        QMutex mutex;
+        QHash<QString, PeekedFile> files;
+    };
+
+    Q_GLOBAL_STATIC(PeekCache, s_peekCache)
+} // namespace
 
 /**
  * Read database from file and detect correct file format.
@@ -62,6 +85,85 @@ bool KeePass2Reader::readDatabase(QIODevice* device, QSharedPointer<const Compos
     m_error = false;
     m_errorStr.clear();
 
+    if (!readSignature(device)) {
+        return false;
+    }
+
+    // determine file format (KDBX 2/3 or 4)
+    if (m_version < KeePass2::FILE_VERSION_4) {
+        m_reader.reset(new Kdbx3Reader());
+    } else {
+        auto reader = QSharedPointer<Kdbx4Reader>::create();
+        reader->setDeferAttachments(m_deferAttachments);
+        m_reader = reader;
+    }
+    m_reader->setSkipHistory(m_skipHistory);
+
+    return m_reader->readDatabase(device, std::move(key), db);
+}
+
+/**
+ * Read the public name, color and icon of a database without unlocking it.
+ *
+ * Only the outer header is read up to its public custom data, which is
+ * cached until the size or modification time of the file changes.
+ *
+ * @param filename database file
+ * @param publicCustomData public custom data, empty for KDBX 3 databases
+ * @return true if the file is a supported KeePass 2 database
+ */
+bool KeePass2Reader::readPublicCustomData(const QString& filename, QVariantMap& publicCustomData)
+{
+    m_error = false;
+    m_errorStr.clear();
+    m_reader.reset();
+
+    QFileInfo fileInfo(filename);
+    const auto path = fileInfo.absoluteFilePath();
+    {
+        QMutexLocker locker(&s_peekCache->mutex);
+        auto peeked = s_peekCache->files.constFind(path);
+        if (peeked != s_peekCache->files.constEnd() && peeked->size == fileInfo.size()
+            && peeked->lastModified == fileInfo.lastModified()) {
+            publicCustomData = peeked->publicCustomData;
+            return true;
+        }
+    }
+
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) {
+        raiseError(file.errorString());
+        return false;
+    }
+    if (!readSignature(&file)) {
+        return false;
+    }
+
+    publicCustomData.clear();
+    if (m_version >= KeePass2::FILE_VERSION_4) {
+        auto reader = QSharedPointer<Kdbx4Reader>::create();
+        m_reader = reader;
+        if (!reader->readPublicCustomData(&file, publicCustomData)) {
+            return false;
+        }
+    }
+
+    QMutexLocker locker(&s_peekCache->mutex);
+    if (s_peekCache->files.size() >= MaxPeekedFiles) {
+        s_peekCache->files.clear();
+    }
+    s_peekCache->files.insert(path, {fileInfo.size(), fileInfo.lastModified(), publicCustomData});
+    return true;
+}
+
+/**
+ * Read and check the magic numbers and the version of a KeePass 2 database.
+ *
+ * @param device input device
+ * @return true if the version is supported
+ */
+bool KeePass2Reader::readSignature(QIODevice* device)
+{
     quint32 signature1, signature2;
     bool ok = KdbxReader::readMagicNumbers(device, signature1, signature2, m_version);
 
@@ -87,14 +189,7 @@ bool KeePass2Reader::readDatabase(QIODevice* device, QSharedPointer<const Compos
         return false;
     }
 
-    // determine file format (KDBX 2/3 or 4)
-    if (m_version < KeePass2::FILE_VERSION_4) {
-        m_reader.reset(new Kdbx3Reader());
-    } else {
-        m_reader.reset(new Kdbx4Reader());
-    }
-
-    return m_reader->readDatabase(device, std::move(key), db);
+    return true;
 }
 
 bool KeePass2Reader::hasError() const
@@ -123,6 +218,26 @@ QSharedPointer<KdbxReader> KeePass2Reader::reader() const
     return m_reader;
 }
 
+/**
+ * Defer loading KDBX4 attachment data until it is accessed.
+ *
+ * @param defer whether to defer loading attachments
+ */
+void KeePass2Reader::setDeferAttachments(bool defer)
+{
+    m_deferAttachments = defer;
+}
+
+/**
+ * Leave out the history items of all entries, for databases that are only looked up.
+ *
+ * @param skip whether to skip history items
+ */
+void KeePass2Reader::setSkipHistory(bool skip)
+{
+    m_skipHistory = skip;
+}
+
 /**
  * Raise an error. Use in case of an unexpected read error.
  *
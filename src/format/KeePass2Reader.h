@@ -29,6 +29,7 @@ class KeePass2Reader
 public:
     bool readDatabase(const QString& filename, QSharedPointer<const CompositeKey> key, Database* db);
     bool readDatabase(QIODevice* device, QSharedPointer<const CompositeKey> key, Database* db);
+    bool readPublicCustomData(const QString& filename, QVariantMap& publicCustomData);
 
     bool hasError() const;
     QString errorString() const;
@@ -36,7 +37,11 @@ public:
     QSharedPointer<KdbxReader> reader() const;
     quint32 version() const;
 
+    void setDeferAttachments(bool defer);
+    void setSkipHistory(bool skip);
+
 private:
+    bool readSignature(QIODevice* device);
     void raiseError(const QString& errorMessage);
 
     bool m_error = false;
@@ -44,6 +49,8 @@ private:
 
     QSharedPointer<KdbxReader> m_reader;
     quint32 m_version = 0;
+    bool m_deferAttachments = false;
+    bool m_skipHistory = false;
 };
 
 #endif // KEEPASSX_KEEPASS2READER_H
@@ -108,13 +108,16 @@ quint32 KeePass2Writer::kdbxVersionRequired(Database const* db, bool ignoreCurre
 }
 
 /**
- * Write a database to a device in KDBX format.
+ * Serialize a database into memory for the next writeDatabase() call.
+ *
+ * The database may be modified once this returns, the key derivation,
+ * compression, encryption and writing can then run on another thread.
  *
- * @param device output device
  * @param db source database
  * @return true on success
+ * @see KdbxWriter::snapshotDatabase()
  */
-bool KeePass2Writer::writeDatabase(QIODevice* device, Database* db)
+bool KeePass2Writer::snapshotDatabase(Database* db)
 {
     m_error = false;
     m_errorStr.clear();
@@ -137,10 +140,35 @@ bool KeePass2Writer::writeDatabase(QIODevice* device, Database* db)
         m_writer.reset(new Kdbx4Writer());
     }
 
+    m_writer->setBlockSize(m_blockSize);
+    m_writer->setKeepKdfSeed(m_keepKdfSeed);
+    return m_writer->snapshotDatabase(db);
+}
+
+/**
+ * Write a database to a device in KDBX format.
+ *
+ * Writes the snapshot of a previous snapshotDatabase() call if there is one.
+ *
+ * @param device output device
+ * @param db source database
+ * @return true on success
+ */
+bool KeePass2Writer::writeDatabase(QIODevice* device, Database* db)
+{
+    if ((!m_writer || !m_writer->hasSnapshot()) && !snapshotDatabase(db)) {
+        return false;
+    }
     return m_writer->writeDatabase(device, db);
 }
 
-void KeePass2Writer::extractDatabase(Database* db, QByteArray& xmlOutput)
+/**
+ * Write the unprotected XML of a database to a device as it is generated.
+ *
+ * @param db database to extract
+ * @param device output device
+ */
+void KeePass2Writer::extractDatabase(Database* db, QIODevice* device)
 {
     m_error = false;
     m_errorStr.clear();
@@ -155,7 +183,29 @@ void KeePass2Writer::extractDatabase(Database* db, QByteArray& xmlOutput)
         m_writer.reset(new Kdbx4Writer());
     }
 
-    m_writer->extractDatabase(xmlOutput, db);
+    m_writer->extractDatabase(device, db);
+}
+
+/**
+ * Set the payload block size used by subsequent writes.
+ *
+ * @param blockSize block size in bytes, zero for the default of 1 MiB
+ * @see KdbxWriter::setBlockSize()
+ */
+void KeePass2Writer::setBlockSize(qint32 blockSize)
+{
+    m_blockSize = blockSize;
+}
+
+/**
+ * Keep the KDF seed of the database for subsequent writes.
+ *
+ * @param keep true to keep the current seed
+ * @see KdbxWriter::setKeepKdfSeed()
+ */
+void KeePass2Writer::setKeepKdfSeed(bool keep)
+{
+    m_keepKdfSeed = keep;
 }
 
 bool KeePass2Writer::hasError() const
@@ -32,8 +32,11 @@ class KeePass2Writer
 public:
     bool writeDatabase(const QString& filename, Database* db);
     bool writeDatabase(QIODevice* device, Database* db);
-    void extractDatabase(Database* db, QByteArray& xmlOutput);
+    bool snapshotDatabase(Database* db);
+    void extractDatabase(Database* db, QIODevice* device);
     static quint32 kdbxVersionRequired(Database const* db, bool ignoreCurrent = false, bool ignoreKdf = false);
+    void setBlockSize(qint32 blockSize);
+    void setKeepKdfSeed(bool keep);
 
     QSharedPointer<KdbxWriter> writer() const;
     quint32 version() const;
@@ -49,6 +52,8 @@ private:
 
     QScopedPointer<KdbxWriter> m_writer;
     quint32 m_version = 0;
+    qint32 m_blockSize = 0;
+    bool m_keepKdfSeed = false;
 };
 
 #endif // KEEPASSX_KEEPASS2READER_H
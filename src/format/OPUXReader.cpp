@@ -24,8 +24,7 @@
 #include "core/Totp.h"
 
 #include <QFileInfo>
-#include <QJsonArray>
-#include <QJsonDocument>
+#include <QIODevice>
 #include <QJsonObject>
 #include <QScopedPointer>
 #include <QUrl>
@@ -34,31 +33,62 @@
 
 namespace
 {
+    /**
+     * Sequential device reading the current file of a zip archive.
+     */
+    class UnzipDevice : public QIODevice
+    {
+    public:
+        explicit UnzipDevice(unzFile uf)
+            : m_uf(uf)
+        {
+        }
+
+        bool isSequential() const override
+        {
+            return true;
+        }
+
+    protected:
+        qint64 readData(char* data, qint64 maxSize) override
+        {
+            const int bytes = unzReadCurrentFile(m_uf, data, static_cast<unsigned>(qMin<qint64>(maxSize, INT_MAX)));
+            return bytes < 0 ? -1 : bytes;
+        }
+
+        qint64 writeData(const char*, qint64) override
+        {
+            return -1;
+        }
+
+    private:
+        unzFile m_uf;
+    };
+
     QByteArray extractFile(unzFile uf, QString filename)
     {
-        if (unzLocateFile(uf, filename.toLatin1(), 2) != UNZ_OK) {
+        unz_file_info64 info;
+        if (unzLocateFile(uf, filename.toLatin1(), 2) != UNZ_OK
+            || unzGetCurrentFileInfo64(uf, &info, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK
+            || info.uncompressed_size > static_cast<ZPOS64_T>(INT_MAX) || unzOpenCurrentFile(uf) != UNZ_OK) {
             qWarning("Failed to extract 1PUX document: %s", qPrintable(filename));
             return {};
         }
 
-        // Read export.data into memory
+        // Decompress straight into a buffer of the final size
+        QByteArray data(static_cast<int>(info.uncompressed_size), '\0');
         int bytes, bytesRead = 0;
-        QByteArray data;
-        unzOpenCurrentFile(uf);
-        do {
-            data.resize(data.size() + 8192);
-            bytes = unzReadCurrentFile(uf, data.data() + bytesRead, 8192);
-            if (bytes > 0) {
-                bytesRead += bytes;
-            }
-        } while (bytes > 0);
+        while (bytesRead < data.size()
+               && (bytes = unzReadCurrentFile(uf, data.data() + bytesRead, data.size() - bytesRead)) > 0) {
+            bytesRead += bytes;
+        }
         unzCloseCurrentFile(uf);
         data.truncate(bytesRead);
 
         return data;
     }
 
-    Entry* readItem(const QJsonObject& item, unzFile uf = nullptr)
+    Entry* readItem(const QJsonObject& item, unzFile uf)
     {
         const auto itemMap = item.toVariantMap();
         const auto overviewMap = itemMap.value("overview").toMap();
@@ -210,29 +240,52 @@ namespace
         return entry.take();
     }
 
-    void writeVaultToDatabase(const QJsonObject& vault, QSharedPointer<Database> db, unzFile uf = nullptr)
+    /**
+     * Read a vault object, creating the entries as the items are read.
+     *
+     * @param reader reader positioned in front of the vault
+     * @param db database the vault group is added to
+     * @param uf archive the attachments are extracted from
+     * @return false on a parse error
+     */
+    bool writeVaultToDatabase(JsonStreamReader& reader, QSharedPointer<Database> db, unzFile uf)
     {
-        if (!vault.contains("attrs") || !vault.contains("items")) {
-            // Early out if the vault is missing critical items
-            return;
-        }
-
-        const auto attr = vault.value("attrs").toObject().toVariantMap();
-
         // Create group and assign basic values
-        auto group = new Group();
+        QScopedPointer<Group> group(new Group());
         group->setUuid(QUuid::createUuid());
-        group->setName(attr.value("name").toString());
-        group->setParent(db->rootGroup());
 
-        const auto items = vault.value("items").toArray();
-        for (const auto& item : items) {
-            auto entry = readItem(item.toObject(), uf);
-            if (entry) {
-                entry->setGroup(group, false);
+        QVariantMap attr;
+        bool hasAttrs = false;
+        bool hasItems = false;
+        QString key;
+        if (reader.enterObject()) {
+            while (reader.nextMember(key)) {
+                if (key == "attrs") {
+                    hasAttrs = true;
+                    attr = reader.readValue().toObject().toVariantMap();
+                } else if (key == "items") {
+                    hasItems = true;
+                    if (!reader.enterArray()) {
+                        break;
+                    }
+                    while (reader.nextElement()) {
+                        auto entry = readItem(reader.readValue().toObject(), uf);
+                        entry->setGroup(group.data(), false);
+                    }
+                } else {
+                    reader.skipValue();
+                }
             }
         }
 
+        if (reader.hasError() || !hasAttrs || !hasItems) {
+            // Early out if the vault is missing critical items
+            return !reader.hasError();
+        }
+
+        group->setName(attr.value("name").toString());
+        group->setParent(db->rootGroup());
+
         // Add the group icon if present
         const auto icon = attr.value("avatar").toString();
         if (!icon.isEmpty()) {
@@ -243,6 +296,52 @@ namespace
                 group->setIcon(uuid);
             }
         }
+
+        group.take();
+        return true;
+    }
+
+    /**
+     * Read the vaults of the first account of an export.
+     *
+     * @return false on a parse error
+     */
+    bool writeAccountsToDatabase(JsonStreamReader& reader, QSharedPointer<Database> db, unzFile uf)
+    {
+        QString key;
+        if (!reader.enterObject()) {
+            return false;
+        }
+        while (reader.nextMember(key)) {
+            if (key != "accounts") {
+                reader.skipValue();
+                continue;
+            }
+
+            if (!reader.enterArray()) {
+                return false;
+            }
+            bool first = true;
+            while (reader.nextElement()) {
+                if (!first || !reader.enterObject()) {
+                    reader.skipValue();
+                    continue;
+                }
+                first = false;
+                while (reader.nextMember(key)) {
+                    if (key != "vaults") {
+                        reader.skipValue();
+                        continue;
+                    }
+                    if (reader.enterArray()) {
+                        while (reader.nextElement()) {
+                            writeVaultToDatabase(reader, db, uf);
+                        }
+                    }
+                }
+            }
+        }
+        return reader.finish();
     }
 } // namespace
 
@@ -274,24 +373,43 @@ QSharedPointer<Database> OPUXReader::convert(const QString& path)
     }
 
     // Find the export.data file, if not found this isn't a 1PUX file
-    auto data = extractFile(uf, "export.data");
-    if (data.isNull()) {
+    unz_file_info64 info;
+    if (unzLocateFile(uf, "export.data", 2) != UNZ_OK
+        || unzGetCurrentFileInfo64(uf, &info, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK
+        || unzOpenCurrentFile(uf) != UNZ_OK) {
         m_error = QObject::tr("Invalid 1PUX file format: Missing export.data");
         unzClose(uf);
         return {};
     }
 
+    // Attachments are extracted through a second handle while export.data is read
+    auto files = unzOpen64(fileinfo.absoluteFilePath().toLatin1().constData());
+
     auto db = QSharedPointer<Database>::create();
     db->rootGroup()->setName(QObject::tr("1Password Import"));
-    const auto json = QJsonDocument::fromJson(data);
 
-    const auto account = json.object().value("accounts").toArray().first().toObject();
-    const auto vaults = account.value("vaults").toArray();
-
-    for (const auto& vault : vaults) {
-        writeVaultToDatabase(vault.toObject(), db, uf);
+    UnzipDevice device(uf);
+    device.open(QIODevice::ReadOnly);
+    JsonStreamReader reader(&device);
+    reader.setProgressCallback(m_progress, static_cast<qint64>(info.uncompressed_size));
+    if (!writeAccountsToDatabase(reader, db, files)) {
+        m_error = QObject::tr("Cannot parse file: %1 at position %2")
+                      .arg(reader.errorString(), QString::number(reader.errorOffset()));
+        db.reset();
     }
 
+    unzCloseCurrentFile(uf);
     unzClose(uf);
+    if (files) {
+        unzClose(files);
+    }
     return db;
 }
+
+/**
+ * @param callback called with the percentage of export.data read while converting
+ */
+void OPUXReader::setProgressCallback(const JsonStreamReader::ProgressCallback& callback)
+{
+    m_progress = callback;
+}
@@ -26,6 +26,7 @@
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QtConcurrent>
 
 #include <botan/pwdhash.h>
 
@@ -85,15 +86,27 @@ QSharedPointer<Database> OpVaultReader::convert(QDir& opdataDir, const QString&
         }
     }
 
+    // https://support.1password.com/opvault-design/#band-files
     const QString bandChars("0123456789ABCDEF");
     QString bandPattern("band_%1.js");
+    QStringList bandPaths;
     for (QChar ch : bandChars) {
-        QFile bandFile(defaultDir.filePath(bandPattern.arg(ch)));
-        if (!bandFile.exists()) {
-            continue;
+        const auto bandPath = defaultDir.filePath(bandPattern.arg(ch));
+        if (QFile::exists(bandPath)) {
+            bandPaths << bandPath;
         }
-        // https://support.1password.com/opvault-design/#band-files
-        QJsonObject bandJs = readAndAssertJsonFile(bandFile, "ld(", ");");
+    }
+
+    // Band files are read and item payloads decrypted on the thread pool, the entries
+    // are put into their groups in a final pass in the order of the band files
+    const std::function<QJsonObject(const QString&)> readBand = [this](const QString& bandPath) {
+        QFile bandFile(bandPath);
+        return readAndAssertJsonFile(bandFile, "ld(", ");");
+    };
+    const auto bands = QtConcurrent::blockingMapped<QList<QJsonObject>>(bandPaths, readBand);
+
+    QList<QJsonObject> bandEntries;
+    for (const auto& bandJs : bands) {
         const QStringList keys = bandJs.keys();
         for (const QString& entryKey : keys) {
             const QJsonObject bandEnt = bandJs[entryKey].toObject();
@@ -112,17 +125,31 @@ QSharedPointer<Database> OpVaultReader::convert(QDir& opdataDir, const QString&
                     break;
                 }
             }
-            if (!ok) {
-                continue;
-            }
-            // https://support.1password.com/opvault-design/#items
-            auto entry = processBandEntry(bandEnt, defaultDir, rootGroup);
-            if (!entry) {
-                qWarning() << "Unable to process Band Entry " << uuid;
+            if (ok) {
+                bandEntries << bandEnt;
             }
         }
     }
 
+    // https://support.1password.com/opvault-design/#items
+    auto thread = rootGroup->thread();
+    const std::function<Entry*(const QJsonObject&)> decryptEntry = [&](const QJsonObject& bandEntry) {
+        auto entry = processBandEntry(bandEntry, defaultDir);
+        if (entry) {
+            entry->moveToThread(thread);
+        }
+        return entry;
+    };
+    const auto entries = QtConcurrent::blockingMapped<QList<Entry*>>(bandEntries, decryptEntry);
+
+    for (int i = 0; i < entries.size(); ++i) {
+        if (!entries.at(i)) {
+            qWarning() << "Unable to process Band Entry " << bandEntries.at(i).value("uuid").toString();
+            continue;
+        }
+        placeBandEntry(entries.at(i), bandEntries.at(i), rootGroup);
+    }
+
     // Remove empty categories (groups)
     for (auto group : rootGroup->children()) {
         if (group->isEmpty()) {
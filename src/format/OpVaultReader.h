@@ -79,7 +79,8 @@ private:
      * @returns \c nullptr if unable to do the decryption, otherwise the interior object and its keys
      */
     bool decryptBandEntry(const QJsonObject& bandEntry, QJsonObject& data, QByteArray& key, QByteArray& hmacKey);
-    Entry* processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup);
+    Entry* processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir);
+    void placeBandEntry(Entry* entry, const QJsonObject& bandEntry, Group* rootGroup);
 
     bool readAttachment(const QString& filePath,
                         const QByteArray& itemKey,
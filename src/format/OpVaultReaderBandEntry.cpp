@@ -103,7 +103,12 @@ bool OpVaultReader::decryptBandEntry(const QJsonObject& bandEntry,
     return true;
 }
 
-Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup)
+/*!
+ * Decrypts a band entry into an entry that does not belong to a group yet.
+ * Only reads the keys of the reader, so band entries may be processed in parallel.
+ * @returns \c nullptr if unable to do the decryption, otherwise the entry owned by the caller
+ */
+Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir)
 {
     const QString uuid = bandEntry.value("uuid").toString();
     if (!(uuid.size() == 32 || uuid.size() == 36)) {
@@ -113,38 +118,6 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
 
     QScopedPointer<Entry> entry(new Entry());
 
-    if (bandEntry.contains("trashed") && bandEntry["trashed"].toBool()) {
-        // Send this entry to the recycle bin
-        rootGroup->database()->recycleEntry(entry.data());
-    } else if (bandEntry.contains("category")) {
-        const QJsonValue& categoryValue = bandEntry["category"];
-        if (categoryValue.isString()) {
-            bool found = false;
-            const QString category = categoryValue.toString();
-            for (Group* group : rootGroup->children()) {
-                const QVariant& groupCode = group->property("code");
-                if (category == groupCode.toString()) {
-                    entry->setGroup(group);
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                qWarning() << QString("Unable to place Entry.Category \"%1\" so using the Root instead").arg(category);
-                entry->setGroup(rootGroup);
-            }
-        } else {
-            qWarning() << QString(R"(Skipping non-String Category type "%1" in UUID "%2")")
-                              .arg(categoryValue.type())
-                              .arg(uuid);
-            entry->setGroup(rootGroup);
-        }
-    } else {
-        qWarning() << "Using the root group because the entry is category-less: <<\n"
-                   << bandEntry << "\n>> in UUID " << uuid;
-        entry->setGroup(rootGroup);
-    }
-
     entry->setUpdateTimeinfo(false);
     TimeInfo ti;
     bool timeInfoOk = false;
@@ -216,6 +189,46 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
     return entry.take();
 }
 
+/*!
+ * Puts a decrypted entry into the group of its category, or into the recycle bin if it was trashed.
+ */
+void OpVaultReader::placeBandEntry(Entry* entry, const QJsonObject& bandEntry, Group* rootGroup)
+{
+    const QString uuid = bandEntry.value("uuid").toString();
+
+    if (bandEntry.contains("trashed") && bandEntry["trashed"].toBool()) {
+        // Send this entry to the recycle bin
+        rootGroup->database()->recycleEntry(entry);
+    } else if (bandEntry.contains("category")) {
+        const QJsonValue& categoryValue = bandEntry["category"];
+        if (categoryValue.isString()) {
+            bool found = false;
+            const QString category = categoryValue.toString();
+            for (Group* group : rootGroup->children()) {
+                const QVariant& groupCode = group->property("code");
+                if (category == groupCode.toString()) {
+                    entry->setGroup(group);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                qWarning() << QString("Unable to place Entry.Category \"%1\" so using the Root instead").arg(category);
+                entry->setGroup(rootGroup);
+            }
+        } else {
+            qWarning() << QString(R"(Skipping non-String Category type "%1" in UUID "%2")")
+                              .arg(categoryValue.type())
+                              .arg(uuid);
+            entry->setGroup(rootGroup);
+        }
+    } else {
+        qWarning() << "Using the root group because the entry is category-less: <<\n"
+                   << bandEntry << "\n>> in UUID " << uuid;
+        entry->setGroup(rootGroup);
+    }
+}
+
 bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry)
 {
     const QString overviewStr = bandEntry.value("o").toString();
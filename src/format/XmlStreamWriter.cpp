@@ -0,0 +1,369 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "XmlStreamWriter.h"
+
+#include <QIODevice>
+
+#include <cstring>
+
+#include "core/Base64.h"
+
+namespace
+{
+    // Characters escaped or encoded per reserved chunk, "&quot;" is the longest expansion
+    const int TextChunkSize = 1024;
+    const int MaxEscapedCharSize = 6;
+
+    // Input bytes base64 encoded per reserved chunk, must be a multiple of 3
+    const int Base64ChunkSize = 3 * 1024;
+
+    inline char* appendLiteral(char* out, const char* literal, int size)
+    {
+        memcpy(out, literal, static_cast<size_t>(size));
+        return out + size;
+    }
+} // namespace
+
+XmlStreamWriter::XmlStreamWriter()
+{
+    m_buffer.reserve(BufferSize);
+}
+
+void XmlStreamWriter::setDevice(QIODevice* device)
+{
+    m_device = device;
+    m_buffer.resize(0);
+    m_tags.clear();
+    m_inStartElement = false;
+    m_inEmptyElement = false;
+    m_lastWasStartElement = false;
+    m_wroteSomething = false;
+    m_error = false;
+}
+
+/**
+ * @return true if writing to the device failed
+ */
+bool XmlStreamWriter::hasError() const
+{
+    return m_error;
+}
+
+void XmlStreamWriter::writeStartDocument()
+{
+    finishStartElement(false);
+    writeLatin1("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>");
+}
+
+/**
+ * Close all open elements and flush the output buffer to the device.
+ */
+void XmlStreamWriter::writeEndDocument()
+{
+    while (!m_tags.isEmpty()) {
+        writeEndElement();
+    }
+    writeRaw("\n", 1);
+    flush();
+}
+
+/**
+ * @param name element name, must stay valid until the element is closed
+ */
+void XmlStreamWriter::writeStartElement(const char* name)
+{
+    if (!finishStartElement(false)) {
+        indent(m_tags.size());
+    }
+    m_tags.append(name);
+    writeRaw("<", 1);
+    writeLatin1(name);
+    m_inStartElement = true;
+    m_lastWasStartElement = true;
+}
+
+void XmlStreamWriter::writeEmptyElement(const char* name)
+{
+    writeStartElement(name);
+    m_inEmptyElement = true;
+}
+
+void XmlStreamWriter::writeEndElement()
+{
+    if (m_tags.isEmpty()) {
+        return;
+    }
+
+    // Nothing was written since the start tag, close it as an empty element
+    if (m_inStartElement && !m_inEmptyElement) {
+        writeRaw("/>", 2);
+        m_lastWasStartElement = false;
+        m_inStartElement = false;
+        m_tags.removeLast();
+        return;
+    }
+
+    if (!finishStartElement(false) && !m_lastWasStartElement) {
+        indent(m_tags.size() - 1);
+    }
+    if (m_tags.isEmpty()) {
+        return;
+    }
+    m_lastWasStartElement = false;
+    writeRaw("</", 2);
+    writeLatin1(m_tags.takeLast());
+    writeRaw(">", 1);
+}
+
+/**
+ * Write an attribute of the current start element.
+ *
+ * @param name attribute name
+ * @param value attribute value, written as is and must not require escaping
+ */
+void XmlStreamWriter::writeAttribute(const char* name, const char* value)
+{
+    Q_ASSERT(m_inStartElement);
+    writeRaw(" ", 1);
+    writeLatin1(name);
+    writeRaw("=\"", 2);
+    writeLatin1(value);
+    writeRaw("\"", 1);
+}
+
+void XmlStreamWriter::writeAttribute(const char* name, qint64 value)
+{
+    Q_ASSERT(m_inStartElement);
+    writeRaw(" ", 1);
+    writeLatin1(name);
+    writeRaw("=\"", 2);
+    writeDecimal(value);
+    writeRaw("\"", 1);
+}
+
+/**
+ * Write escaped character data encoded as UTF-8.
+ *
+ * @param text character data
+ */
+void XmlStreamWriter::writeCharacters(const QString& text)
+{
+    finishStartElement(true);
+    writeEscaped(text.constData(), text.size());
+}
+
+/**
+ * @param text ASCII character data, written as is and must not require escaping
+ */
+void XmlStreamWriter::writeCharacters(const char* text)
+{
+    finishStartElement(true);
+    writeLatin1(text);
+}
+
+/**
+ * Write a decimal number as character data.
+ *
+ * @param value number
+ */
+void XmlStreamWriter::writeNumber(qint64 value)
+{
+    finishStartElement(true);
+    writeDecimal(value);
+}
+
+/**
+ * Write data as base64 character data.
+ *
+ * @param data binary data
+ * @param size size of data
+ */
+void XmlStreamWriter::writeBase64(const char* data, int size)
+{
+    finishStartElement(true);
+
+    for (int offset = 0; offset < size; offset += Base64ChunkSize) {
+        int chunkSize = qMin(size - offset, Base64ChunkSize);
+        int encodedSize = Base64::encodedSize(chunkSize);
+        char* out = reserve(encodedSize);
+        Base64::encode(data + offset, chunkSize, out);
+        commit(out + encodedSize);
+    }
+}
+
+void XmlStreamWriter::writeBase64(const QByteArray& data)
+{
+    writeBase64(data.constData(), data.size());
+}
+
+/**
+ * Hand the buffered output to the device.
+ *
+ * @return false if the device did not accept all data
+ */
+bool XmlStreamWriter::flush()
+{
+    if (!m_buffer.isEmpty() && m_device && !m_error) {
+        if (m_device->write(m_buffer.constData(), m_buffer.size()) != m_buffer.size()) {
+            m_error = true;
+        }
+    }
+    // Keeps the reserved capacity, so the buffer is allocated only once
+    m_buffer.resize(0);
+    return !m_error;
+}
+
+/**
+ * Close a pending start tag.
+ *
+ * Mirrors QXmlStreamWriter so that auto formatting produces identical output.
+ *
+ * @param contents whether character data follows
+ * @return whether character data was written since the last tag
+ */
+bool XmlStreamWriter::finishStartElement(bool contents)
+{
+    bool hadSomethingWritten = m_wroteSomething;
+    m_wroteSomething = contents;
+    if (!m_inStartElement) {
+        return hadSomethingWritten;
+    }
+
+    if (m_inEmptyElement) {
+        writeRaw("/>", 2);
+        m_tags.removeLast();
+        m_lastWasStartElement = false;
+    } else {
+        writeRaw(">", 1);
+    }
+    m_inStartElement = false;
+    m_inEmptyElement = false;
+    return hadSomethingWritten;
+}
+
+void XmlStreamWriter::indent(int level)
+{
+    char* out = reserve(level + 1);
+    *out++ = '\n';
+    memset(out, '\t', static_cast<size_t>(level));
+    commit(out + level);
+}
+
+void XmlStreamWriter::writeRaw(const char* data, int size)
+{
+    char* out = reserve(size);
+    commit(appendLiteral(out, data, size));
+}
+
+void XmlStreamWriter::writeDecimal(qint64 value)
+{
+    char digits[24];
+    int pos = sizeof(digits);
+    quint64 magnitude = value < 0 ? 0 - static_cast<quint64>(value) : static_cast<quint64>(value);
+    do {
+        digits[--pos] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        digits[--pos] = '-';
+    }
+
+    writeRaw(digits + pos, static_cast<int>(sizeof(digits)) - pos);
+}
+
+void XmlStreamWriter::writeLatin1(const char* text)
+{
+    writeRaw(text, static_cast<int>(strlen(text)));
+}
+
+void XmlStreamWriter::writeEscaped(const QChar* text, int size)
+{
+    auto in = reinterpret_cast<const ushort*>(text);
+
+    int i = 0;
+    while (i < size) {
+        // One extra character in case the chunk ends within a surrogate pair
+        int chunkEnd = qMin(size, i + TextChunkSize);
+        char* out = reserve((chunkEnd - i + 1) * MaxEscapedCharSize);
+
+        for (; i < chunkEnd; ++i) {
+            ushort ch = in[i];
+            if (ch < 0x80) {
+                // Whitespace, including carriage returns, is written as is like QXmlStreamWriter does for text
+                switch (ch) {
+                case '<':
+                    out = appendLiteral(out, "&lt;", 4);
+                    break;
+                case '>':
+                    out = appendLiteral(out, "&gt;", 4);
+                    break;
+                case '&':
+                    out = appendLiteral(out, "&amp;", 5);
+                    break;
+                case '"':
+                    out = appendLiteral(out, "&quot;", 6);
+                    break;
+                default:
+                    *out++ = static_cast<char>(ch);
+                    break;
+                }
+            } else if (ch < 0x800) {
+                *out++ = static_cast<char>(0xC0 | (ch >> 6));
+                *out++ = static_cast<char>(0x80 | (ch & 0x3F));
+            } else if (QChar::isHighSurrogate(ch) && i + 1 < size && QChar::isLowSurrogate(in[i + 1])) {
+                uint ucs4 = QChar::surrogateToUcs4(ch, in[++i]);
+                *out++ = static_cast<char>(0xF0 | (ucs4 >> 18));
+                *out++ = static_cast<char>(0x80 | ((ucs4 >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((ucs4 >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (ucs4 & 0x3F));
+            } else if (QChar::isSurrogate(ch)) {
+                // Same replacement as the UTF-8 codec used by QXmlStreamWriter
+                *out++ = '?';
+            } else {
+                *out++ = static_cast<char>(0xE0 | (ch >> 12));
+                *out++ = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (ch & 0x3F));
+            }
+        }
+
+        commit(out);
+    }
+}
+
+/**
+ * @param size number of bytes about to be written
+ * @return pointer to at least size bytes of free space at the end of the buffer
+ */
+char* XmlStreamWriter::reserve(int size)
+{
+    if (m_buffer.capacity() - m_buffer.size() < size) {
+        flush();
+        if (m_buffer.capacity() < size) {
+            m_buffer.reserve(size);
+        }
+    }
+    return m_buffer.data() + m_buffer.size();
+}
+
+/**
+ * @param end end of the data written after reserve()
+ */
+void XmlStreamWriter::commit(const char* end)
+{
+    m_buffer.resize(static_cast<int>(end - m_buffer.constData()));
+}
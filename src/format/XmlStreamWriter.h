@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_XMLSTREAMWRITER_H
+#define KEEPASSXC_XMLSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+/**
+ * Minimal UTF-8 XML writer for the KDBX XML payload.
+ *
+ * Produces the same output as QXmlStreamWriter with auto formatting and a
+ * tab indent, but encodes straight into a reusable output buffer which is
+ * handed to the device in large chunks. Element names are Latin-1 string
+ * literals, and numbers and base64 data are formatted in place, so writing
+ * an entry does not allocate temporary strings or byte arrays.
+ */
+class XmlStreamWriter
+{
+public:
+    static const int BufferSize = 64 * 1024;
+
+    XmlStreamWriter();
+
+    void setDevice(QIODevice* device);
+    bool hasError() const;
+
+    void writeStartDocument();
+    void writeEndDocument();
+
+    void writeStartElement(const char* name);
+    void writeEmptyElement(const char* name);
+    void writeEndElement();
+
+    void writeAttribute(const char* name, const char* value);
+    void writeAttribute(const char* name, qint64 value);
+
+    void writeCharacters(const QString& text);
+    void writeCharacters(const char* text);
+    void writeNumber(qint64 value);
+    void writeBase64(const char* data, int size);
+    void writeBase64(const QByteArray& data);
+
+    bool flush();
+
+private:
+    bool finishStartElement(bool contents);
+    void indent(int level);
+    void writeRaw(const char* data, int size);
+    void writeDecimal(qint64 value);
+    void writeLatin1(const char* text);
+    void writeEscaped(const QChar* text, int size);
+    char* reserve(int size);
+    void commit(const char* end);
+
+    QIODevice* m_device = nullptr;
+    QByteArray m_buffer;
+    QVector<const char*> m_tags;
+    bool m_inStartElement = false;
+    bool m_inEmptyElement = false;
+    bool m_lastWasStartElement = false;
+    bool m_wroteSomething = false;
+    bool m_error = false;
+};
+
+#endif // KEEPASSXC_XMLSTREAMWRITER_H
@@ -20,9 +20,13 @@
 #include "ui_AboutDialog.h"
 
 #include "config-keepassx.h"
+#include "core/DatabaseMemoryIndex.h"
+#include "core/PerformanceStats.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
+#include "gui/DatabaseWidget.h"
 #include "gui/Icons.h"
+#include "gui/MainWindow.h"
 
 #include <QClipboard>
 
@@ -315,6 +319,8 @@ AboutDialog::AboutDialog(QWidget* parent)
     m_ui->iconLabel->setPixmap(icons()->applicationIcon().pixmap(48));
 
     QString debugInfo = Tools::debugInfo().append("\n").append(Crypto::debugInfo());
+    debugInfo.append("\n").append(PerformanceStats::report());
+    debugInfo.append(memoryUsageInfo());
     m_ui->debugInfo->setPlainText(debugInfo);
 
     m_ui->maintainers->setText(aboutMaintainers);
@@ -329,6 +335,31 @@ AboutDialog::AboutDialog(QWidget* parent)
 
 AboutDialog::~AboutDialog() = default;
 
+/**
+ * @return estimated memory usage of each unlocked database, without their names
+ */
+QString AboutDialog::memoryUsageInfo()
+{
+    QString info;
+    if (!getMainWindow()) {
+        return info;
+    }
+
+    int number = 0;
+    for (auto* dbWidget : getMainWindow()->getOpenDatabases()) {
+        ++number;
+        if (!dbWidget || dbWidget->isLocked()) {
+            continue;
+        }
+        const auto usage = DatabaseMemoryIndex::forDatabase(dbWidget->database().data())->usage();
+        info.append(tr("Memory of database %1:").arg(number)).append("\n");
+        for (const auto& line : usage.toStringList()) {
+            info.append("- ").append(line).append("\n");
+        }
+    }
+    return info;
+}
+
 void AboutDialog::copyToClipboard()
 {
     QClipboard* clipboard = QApplication::clipboard();
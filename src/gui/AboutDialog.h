@@ -38,6 +38,8 @@ protected slots:
     void copyToClipboard();
 
 private:
+    static QString memoryUsageInfo();
+
     QScopedPointer<Ui::AboutDialog> m_ui;
 };
 
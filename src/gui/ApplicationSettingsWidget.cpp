@@ -30,6 +30,7 @@
 #include "gui/Icons.h"
 #include "gui/MainWindow.h"
 #include "gui/osutils/OSUtils.h"
+#include "keys/TransformedKeyCache.h"
 #include "quickunlock/QuickUnlockInterface.h"
 
 #include "FileDialog.h"
@@ -104,10 +105,6 @@ ApplicationSettingsWidget::ApplicationSettingsWidget(QWidget* parent)
     addSettingsPage(new BrowserSettingsPage());
 #endif
 
-    if (!autoType()->isAvailable()) {
-        m_generalUi->generalSettingsTabWidget->removeTab(1);
-    }
-
     connect(this, SIGNAL(accepted()), SLOT(saveSettings()));
     connect(this, SIGNAL(rejected()), SLOT(reject()));
 
@@ -138,6 +135,8 @@ ApplicationSettingsWidget::ApplicationSettingsWidget(QWidget* parent)
             m_secUi->lockDatabaseIdleSpinBox, SLOT(setEnabled(bool)));
     // clang-format on
 
+    connect(m_secUi->quickUnlockCheckBox, &QCheckBox::toggled, m_secUi->quickUnlockKeepTransformedKeyCheckBox,
+            &QCheckBox::setEnabled);
     connect(m_generalUi->minimizeAfterUnlockCheckBox, &QCheckBox::toggled, this, [this](bool state) {
         if (state) {
             m_secUi->lockDatabaseMinimizeCheckBox->setChecked(false);
@@ -202,6 +201,14 @@ void ApplicationSettingsWidget::loadSettings()
         showMessage(tr("Access error for config file %1").arg(config()->getFileName()), MessageWidget::Error);
     }
 
+    // Checked here rather than on construction to not load the auto-type plugin during startup
+    if (!autoType()->isAvailable()) {
+        int autoTypeTab = m_generalUi->generalSettingsTabWidget->indexOf(m_generalUi->tabAutotype);
+        if (autoTypeTab >= 0) {
+            m_generalUi->generalSettingsTabWidget->removeTab(autoTypeTab);
+        }
+    }
+
 #ifdef QT_DEBUG
     m_generalUi->singleInstanceCheckBox->setEnabled(false);
     m_generalUi->launchAtStartup->setEnabled(false);
@@ -214,6 +221,8 @@ void ApplicationSettingsWidget::loadSettings()
     m_generalUi->openPreviousDatabasesOnStartupCheckBox->setChecked(
         config()->get(Config::OpenPreviousDatabasesOnStartup).toBool());
     m_generalUi->autoSaveAfterEveryChangeCheckBox->setChecked(config()->get(Config::AutoSaveAfterEveryChange).toBool());
+    m_generalUi->autoSaveJournalCheckBox->setChecked(config()->get(Config::AutoSaveJournal).toBool());
+    m_generalUi->autoSaveJournalCheckBox->setEnabled(m_generalUi->autoSaveAfterEveryChangeCheckBox->isChecked());
     m_generalUi->autoSaveOnExitCheckBox->setChecked(config()->get(Config::AutoSaveOnExit).toBool());
     m_generalUi->autoSaveNonDataChangesCheckBox->setChecked(config()->get(Config::AutoSaveNonDataChanges).toBool());
     m_generalUi->backupBeforeSaveCheckBox->setChecked(config()->get(Config::BackupBeforeSave).toBool());
@@ -344,6 +353,10 @@ void ApplicationSettingsWidget::loadSettings()
 
     m_secUi->quickUnlockCheckBox->setEnabled(getQuickUnlock()->isAvailable());
     m_secUi->quickUnlockCheckBox->setChecked(config()->get(Config::Security_QuickUnlock).toBool());
+    m_secUi->quickUnlockKeepTransformedKeyCheckBox->setEnabled(m_secUi->quickUnlockCheckBox->isEnabled()
+                                                               && m_secUi->quickUnlockCheckBox->isChecked());
+    m_secUi->quickUnlockKeepTransformedKeyCheckBox->setChecked(
+        config()->get(Config::Security_QuickUnlockKeepTransformedKey).toBool());
 
     for (const ExtraPage& page : asConst(m_extraPages)) {
         page.loadSettings();
@@ -372,6 +385,7 @@ void ApplicationSettingsWidget::saveSettings()
     config()->set(Config::OpenPreviousDatabasesOnStartup,
                   m_generalUi->openPreviousDatabasesOnStartupCheckBox->isChecked());
     config()->set(Config::AutoSaveAfterEveryChange, m_generalUi->autoSaveAfterEveryChangeCheckBox->isChecked());
+    config()->set(Config::AutoSaveJournal, m_generalUi->autoSaveJournalCheckBox->isChecked());
     config()->set(Config::AutoSaveOnExit, m_generalUi->autoSaveOnExitCheckBox->isChecked());
     config()->set(Config::AutoSaveNonDataChanges, m_generalUi->autoSaveNonDataChangesCheckBox->isChecked());
     config()->set(Config::BackupBeforeSave, m_generalUi->backupBeforeSaveCheckBox->isChecked());
@@ -460,6 +474,12 @@ void ApplicationSettingsWidget::saveSettings()
 
     if (m_secUi->quickUnlockCheckBox->isEnabled()) {
         config()->set(Config::Security_QuickUnlock, m_secUi->quickUnlockCheckBox->isChecked());
+        config()->set(Config::Security_QuickUnlockKeepTransformedKey,
+                      m_secUi->quickUnlockKeepTransformedKeyCheckBox->isChecked());
+        if (!m_secUi->quickUnlockCheckBox->isChecked()
+            || !m_secUi->quickUnlockKeepTransformedKeyCheckBox->isChecked()) {
+            transformedKeyCache()->clear();
+        }
     }
 
     // Security: clear storage if related settings are disabled
@@ -564,6 +584,7 @@ void ApplicationSettingsWidget::autoSaveToggled(bool checked)
     }
     m_generalUi->autoSaveOnExitCheckBox->setEnabled(!checked);
     m_generalUi->autoSaveNonDataChangesCheckBox->setEnabled(!checked);
+    m_generalUi->autoSaveJournalCheckBox->setEnabled(checked);
 }
 
 void ApplicationSettingsWidget::hideWindowOnCopyCheckBoxToggled(bool checked)
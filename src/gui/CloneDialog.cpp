@@ -18,12 +18,14 @@
 #include "CloneDialog.h"
 #include "ui_CloneDialog.h"
 
-CloneDialog::CloneDialog(DatabaseWidget* parent, Database* db, Entry* entry)
+#include "core/Group.h"
+
+CloneDialog::CloneDialog(DatabaseWidget* parent, Database* db, QList<Entry*> entries)
     : QDialog(parent)
     , m_ui(new Ui::CloneDialog())
 {
     m_db = db;
-    m_entry = entry;
+    m_entries = std::move(entries);
     m_parent = parent;
 
     m_ui->setupUi(this);
@@ -53,10 +55,9 @@ void CloneDialog::cloneEntry()
         flags |= Entry::CloneIncludeHistory;
     }
 
-    auto entry = m_entry->clone(flags);
-    entry->setGroup(m_entry->group());
+    auto clones = Group::cloneEntries(m_entries, flags);
 
-    emit entryCloned(entry);
+    emit entriesCloned(clones);
     close();
 }
 
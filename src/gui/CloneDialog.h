@@ -33,11 +33,11 @@ class CloneDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit CloneDialog(DatabaseWidget* parent = nullptr, Database* db = nullptr, Entry* entry = nullptr);
+    explicit CloneDialog(DatabaseWidget* parent = nullptr, Database* db = nullptr, QList<Entry*> entries = {});
     ~CloneDialog() override;
 
 signals:
-    void entryCloned(Entry* clone);
+    void entriesCloned(const QList<Entry*>& clones);
 
 private:
     QScopedPointer<Ui::CloneDialog> m_ui;
@@ -47,7 +47,7 @@ private slots:
 
 protected:
     Database* m_db;
-    Entry* m_entry;
+    QList<Entry*> m_entries;
     DatabaseWidget* m_parent;
 };
 
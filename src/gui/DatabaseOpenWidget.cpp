@@ -19,12 +19,15 @@
 #include "DatabaseOpenWidget.h"
 #include "ui_DatabaseOpenWidget.h"
 
+#include "core/AsyncTask.h"
+#include "crypto/kdf/Argon2Kdf.h"
 #include "gui/FileDialog.h"
 #include "gui/Icons.h"
 #include "gui/MainWindow.h"
 #include "gui/MessageBox.h"
 #include "keys/ChallengeResponseKey.h"
 #include "keys/FileKey.h"
+#include "keys/TransformedKeyCache.h"
 #ifdef WITH_XC_YUBIKEY
 #include "keys/drivers/YubiKeyInterfaceUSB.h"
 #endif
@@ -34,11 +37,17 @@
 #include <QCloseEvent>
 #include <QDesktopServices>
 #include <QFont>
+#include <QtConcurrent>
+
+#include <functional>
 
 namespace
 {
     constexpr int clearFormsDelay = 30000;
 
+    // Larger files are read at unlock, after the key derivation claimed its memory
+    constexpr qint64 MaxPrefetchSize = 128 * 1024 * 1024;
+
     bool isQuickUnlockAvailable()
     {
         if (config()->get(Config::Security_QuickUnlock).toBool()) {
@@ -46,6 +55,77 @@ namespace
         }
         return false;
     }
+
+    bool isTransformedKeyCacheEnabled()
+    {
+        return isQuickUnlockAvailable() && config()->get(Config::Security_QuickUnlockKeepTransformedKey).toBool();
+    }
+
+    // Argon2 memory in KiB that databases unlocked at the same time may use together
+    const quint64 MaxConcurrentKdfMemory = 1024 * 1024;
+
+    /**
+     * Runs the unlocks of several databases, e.g. auto-open databases, at the
+     * same time as long as their key derivations fit into the memory budget and
+     * there is a core for each. One unlock is always allowed to run.
+     */
+    class UnlockScheduler
+    {
+    public:
+        void schedule(QObject* context, quint64 kdfMemory, std::function<void()> start)
+        {
+            m_pending.append({context, kdfMemory, std::move(start)});
+            startPending();
+        }
+
+        void finish(quint64 kdfMemory)
+        {
+            --m_running;
+            m_memoryInUse -= kdfMemory;
+            startPending();
+        }
+
+    private:
+        struct Pending
+        {
+            QPointer<QObject> context;
+            quint64 kdfMemory;
+            std::function<void()> start;
+        };
+
+        void startPending()
+        {
+            while (!m_pending.isEmpty()) {
+                if (!m_pending.first().context) {
+                    m_pending.removeFirst();
+                    continue;
+                }
+                const auto kdfMemory = m_pending.first().kdfMemory;
+                if (m_running > 0
+                    && (m_running >= QThread::idealThreadCount()
+                        || m_memoryInUse + kdfMemory > MaxConcurrentKdfMemory)) {
+                    return;
+                }
+
+                auto pending = m_pending.takeFirst();
+                ++m_running;
+                m_memoryInUse += kdfMemory;
+                pending.start();
+            }
+        }
+
+        QList<Pending> m_pending;
+        quint64 m_memoryInUse = 0;
+        int m_running = 0;
+    };
+
+    Q_GLOBAL_STATIC(UnlockScheduler, unlockScheduler)
+
+    quint64 kdfMemory(const Database* db)
+    {
+        auto argon2 = db ? db->kdf().dynamicCast<Argon2Kdf>() : QSharedPointer<Argon2Kdf>();
+        return argon2 ? argon2->memory() : 0;
+    }
 } // namespace
 
 DatabaseOpenWidget::DatabaseOpenWidget(QWidget* parent)
@@ -226,6 +306,9 @@ void DatabaseOpenWidget::load(const QString& filename)
     m_db.reset(new Database());
     m_db->open(m_filename, nullptr, &error);
 
+    // The rest of the file is read from slow drives and network shares in the meantime
+    m_prefetchedFile = QtConcurrent::run(&DatabaseOpenWidget::prefetchFile, m_filename);
+
     m_ui->fileNameLabel->setRawText(m_filename);
 
     // Set the public name if defined
@@ -268,6 +351,34 @@ void DatabaseOpenWidget::load(const QString& filename)
 #endif
 }
 
+/**
+ * Read the contents of a database file.
+ *
+ * @param filename path to the database file
+ * @return contents of the file with its size and modification time,
+ *         empty contents if the file is too large or cannot be read
+ */
+DatabaseOpenWidget::PrefetchedFile DatabaseOpenWidget::prefetchFile(const QString& filename)
+{
+    PrefetchedFile prefetched;
+    QFileInfo fileInfo(filename);
+    if (!fileInfo.exists() || fileInfo.size() > MaxPrefetchSize) {
+        return prefetched;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return prefetched;
+    }
+    prefetched.size = fileInfo.size();
+    prefetched.lastModified = fileInfo.lastModified();
+    prefetched.data = file.readAll();
+    if (prefetched.data.size() != prefetched.size) {
+        prefetched.data.clear();
+    }
+    return prefetched;
+}
+
 void DatabaseOpenWidget::clearForms()
 {
     setUserInteractionLock(false);
@@ -303,6 +414,11 @@ void DatabaseOpenWidget::enterKey(const QString& pw, const QString& keyFile)
 
 void DatabaseOpenWidget::openDatabase()
 {
+    // Browser and Secret Service requests may ask for an unlock while one is running
+    if (m_unlockingDatabase) {
+        return;
+    }
+
     // Cache this variable for future use then reset
     bool blockQuickUnlock = m_blockQuickUnlock || isOnQuickUnlockScreen();
     m_blockQuickUnlock = false;
@@ -318,11 +434,56 @@ void DatabaseOpenWidget::openDatabase()
         return;
     }
 
-    QString error;
-    m_db.reset(new Database());
-    bool ok = m_db->open(m_filename, databaseKey, &error);
+    // Only keep the transformed key of credentials that quick unlock stores or just provided
+    if (!m_db.isNull() && (!blockQuickUnlock || isOnQuickUnlockScreen()) && isTransformedKeyCacheEnabled()) {
+        databaseKey->setTransformedKeyCache(m_db->publicUuid());
+    }
+
+    // Key transformation, decryption and parsing all happen in a worker thread, the database
+    // is handed over to this thread in one piece once it is completely read
+    const auto filename = m_filename;
+    const auto prefetchedFile = m_prefetchedFile;
+    const auto memory = kdfMemory(m_db.data());
+    auto mainThread = thread();
+    unlockScheduler()->schedule(this, memory, [=] {
+        AsyncTask::runThenCallback(
+            [filename, prefetchedFile, databaseKey, mainThread, memory] {
+                // Fall back to reading the file if it changed since it was prefetched
+                QByteArray fileData;
+                if (!prefetchedFile.isCanceled()) {
+                    const auto prefetched = prefetchedFile.result();
+                    QFileInfo fileInfo(filename);
+                    if (fileInfo.size() == prefetched.size && fileInfo.lastModified() == prefetched.lastModified) {
+                        fileData = prefetched.data;
+                    }
+                }
+
+                UnlockResult result;
+                result.db = QSharedPointer<Database>::create();
+                result.ok = result.db->open(filename, fileData, databaseKey, &result.error);
+                result.db->moveWithHistoryToThread(mainThread);
+                // Also release the slot if this widget is gone by now
+                QMetaObject::invokeMethod(
+                    QCoreApplication::instance(), [memory] { unlockScheduler()->finish(memory); }, Qt::QueuedConnection);
+                return result;
+            },
+            this,
+            [this, databaseKey, blockQuickUnlock](const UnlockResult& result) {
+                finishUnlock(result, databaseKey, blockQuickUnlock);
+            });
+    });
+}
+
+void DatabaseOpenWidget::finishUnlock(const UnlockResult& result,
+                                      QSharedPointer<CompositeKey> databaseKey,
+                                      bool blockQuickUnlock)
+{
+    QString error = result.error;
+    m_db = result.db;
+
+    if (result.ok) {
+        m_prefetchedFile = QFuture<PrefetchedFile>();
 
-    if (ok) {
         // Warn user about minor version mismatch to halt loading if necessary
         if (m_db->hasMinorVersionMismatch()) {
             QScopedPointer<QMessageBox> msgBox(new QMessageBox(this));
@@ -532,7 +693,8 @@ void DatabaseOpenWidget::pollHardwareKey(bool manualTrigger)
     // Add a delay, if this is an automatic trigger, to allow the USB device to settle as
     // the device may not report a valid serial number immediately after plugging in
     int delay = manualTrigger ? 0 : 500;
-    QTimer::singleShot(delay, this, [] { YubiKey::instance()->findValidKeysAsync(); });
+    // Automatic triggers only probe the keys that were plugged in since the last detection
+    QTimer::singleShot(delay, this, [manualTrigger] { YubiKey::instance()->findValidKeysAsync(manualTrigger); });
 }
 
 void DatabaseOpenWidget::hardwareKeyResponse(bool found)
@@ -638,6 +800,7 @@ void DatabaseOpenWidget::resetQuickUnlock()
     }
     if (!m_db.isNull()) {
         getQuickUnlock()->reset(m_db->publicUuid());
+        transformedKeyCache()->remove(m_db->publicUuid());
     }
     load(m_filename);
 }
@@ -19,6 +19,8 @@
 #ifndef KEEPASSX_DATABASEOPENWIDGET_H
 #define KEEPASSX_DATABASEOPENWIDGET_H
 
+#include <QDateTime>
+#include <QFuture>
 #include <QPointer>
 #include <QScopedPointer>
 #include <QTimer>
@@ -63,13 +65,32 @@ signals:
     void dialogFinished(bool accepted);
 
 protected:
+    struct UnlockResult
+    {
+        QSharedPointer<Database> db;
+        bool ok = false;
+        QString error;
+    };
+
+    struct PrefetchedFile
+    {
+        QByteArray data;
+        qint64 size = -1;
+        QDateTime lastModified;
+    };
+
+    static PrefetchedFile prefetchFile(const QString& filename);
+
     bool event(QEvent* event) override;
     QSharedPointer<CompositeKey> buildDatabaseKey();
     void setUserInteractionLock(bool state);
+    void finishUnlock(const UnlockResult& result, QSharedPointer<CompositeKey> databaseKey, bool blockQuickUnlock);
 
     const QScopedPointer<Ui::DatabaseOpenWidget> m_ui;
     QSharedPointer<Database> m_db;
     QString m_filename;
+    // Contents of the database file read while the credentials are entered
+    QFuture<PrefetchedFile> m_prefetchedFile;
     bool m_retryUnlockWithEmptyPassword = false;
 
 protected slots:
@@ -21,7 +21,8 @@
 #include <QTabBar>
 
 #include "autotype/AutoType.h"
-#include "core/Merger.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
 #include "core/Tools.h"
 #include "format/CsvExporter.h"
 #include "gui/Clipboard.h"
@@ -232,6 +233,8 @@ void DatabaseTabWidget::addDatabaseTab(DatabaseWidget* dbWidget, bool inBackgrou
     toggleTabbar();
     if (!inBackground) {
         setCurrentIndex(index);
+    } else {
+        dbWidget->setBackgroundTab(true);
     }
 
     connect(dbWidget,
@@ -281,6 +284,8 @@ void DatabaseTabWidget::importFile()
                     auto group = dbWidget->database()->rootGroup()->findGroupByUuid(importInto.second);
                     if (group) {
                         // Extract the root group from the import database
+                        group->database()->metadata()->copyCustomIcons(db->rootGroup()->customIconsRecursive(),
+                                                                       db->metadata());
                         auto importGroup = db->setRootGroup(new Group());
                         importGroup->setParent(group);
                         setCurrentIndex(i);
@@ -299,10 +304,18 @@ void DatabaseTabWidget::importFile()
             // Start the new database wizard with the imported database
             auto newDb = execNewDatabaseWizard();
             if (newDb) {
-                // Merge the imported db into the new one
-                Merger merger(db.data(), newDb.data());
-                merger.setSkipDatabaseCustomData(true);
-                merger.merge();
+                // Move the imported entries into the new database, nothing has to be merged into an empty one
+                auto importRoot = db->rootGroup();
+                newDb->metadata()->copyCustomIcons(importRoot->customIconsRecursive(), db->metadata());
+                {
+                    DatabaseBulkUpdate bulkUpdate(newDb.data());
+                    for (auto entry : QList<Entry*>(importRoot->entries())) {
+                        entry->setGroup(newDb->rootGroup());
+                    }
+                    for (auto child : QList<Group*>(importRoot->children())) {
+                        child->setParent(newDb->rootGroup());
+                    }
+                }
                 // Show the new database
                 auto dbWidget = new DatabaseWidget(newDb, this);
                 addDatabaseTab(dbWidget);
@@ -523,18 +536,18 @@ void DatabaseTabWidget::exportToXML()
 
     FileDialog::saveLastDir("xml", fileName, true);
 
-    QByteArray xmlData;
-    QString err;
-    if (!db->extract(xmlData, &err)) {
-        emit messageGlobal(tr("Writing the XML file failed").append("\n").append(err), MessageWidget::Error);
-    }
-
     QFile file(fileName);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
         emit messageGlobal(tr("Writing the XML file failed").append("\n").append(file.errorString()),
                            MessageWidget::Error);
+        return;
+    }
+
+    // The XML goes to the file as the database is traversed instead of being held in memory
+    QString err;
+    if (!db->extract(&file, &err)) {
+        emit messageGlobal(tr("Writing the XML file failed").append("\n").append(err), MessageWidget::Error);
     }
-    file.write(xmlData);
 }
 
 bool DatabaseTabWidget::warnOnExport()
@@ -875,6 +888,11 @@ void DatabaseTabWidget::updateLastDatabases()
 
 void DatabaseTabWidget::emitActiveDatabaseChanged()
 {
+    for (int i = 0; i < count(); ++i) {
+        if (auto* dbWidget = databaseWidgetFromIndex(i)) {
+            dbWidget->setBackgroundTab(i != currentIndex());
+        }
+    }
     emit activeDatabaseChanged(currentDatabaseWidget());
 }
 
@@ -891,6 +909,8 @@ void DatabaseTabWidget::emitDatabaseLockChanged()
     } else {
         emit databaseUnlocked(dbWidget);
         m_databaseOpenInProgress = false;
+        // A database unlocked in the background tab is released again after a while
+        dbWidget->setBackgroundTab(dbWidget != currentDatabaseWidget());
     }
 }
 
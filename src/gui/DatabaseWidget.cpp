@@ -33,8 +33,14 @@
 
 #include "autotype/AutoType.h"
 #include "core/AsyncTask.h"
+#include "core/Clock.h"
+#include "core/EntryExpiryIndex.h"
+#include "core/EntryReferenceIndex.h"
+#include "core/EntrySearchIndex.h"
 #include "core/EntrySearcher.h"
+#include "core/LiveSearch.h"
 #include "core/Merger.h"
+#include "core/PasswordHealth.h"
 #include "core/Tools.h"
 #include "gui/Clipboard.h"
 #include "gui/CloneDialog.h"
@@ -43,6 +49,7 @@
 #include "gui/EntryPreviewWidget.h"
 #include "gui/FileDialog.h"
 #include "gui/GuiTools.h"
+#include "gui/Icons.h"
 #include "gui/MainWindow.h"
 #include "gui/MessageBox.h"
 #include "gui/TotpDialog.h"
@@ -71,6 +78,24 @@
 #include "gui/passkeys/PasskeyImporter.h"
 #endif
 
+namespace
+{
+    // Journaled changes are written to the database file at least this often
+    const int JournalCompactIntervalMs = 5 * 60 * 1000;
+
+    // Background tabs release their caches after this much time without being shown
+    const int CacheReleaseDelayMs = 10 * 60 * 1000;
+
+    // Autosaves taking longer than this wait for a pause in a series of changes
+    const qint64 SlowAutosaveDurationMs = 250;
+    // Changes are never left unsaved for longer than this while they keep coming
+    const int MaxAdaptiveAutosaveDelayMs = 10 * 1000;
+
+    // Searches over more entries show the results of the first ones right away
+    // and match the rest in batches of this size between events
+    const int SearchBatchSize = 2048;
+} // namespace
+
 DatabaseWidget::DatabaseWidget(QSharedPointer<Database> db, QWidget* parent)
     : QStackedWidget(parent)
     , m_db(std::move(db))
@@ -96,6 +121,9 @@ DatabaseWidget::DatabaseWidget(QSharedPointer<Database> db, QWidget* parent)
 {
     Q_ASSERT(m_db);
 
+    // Search as you type has to keep up with large databases
+    m_entrySearcher->setParallel(true);
+
     m_messageWidget->setHidden(true);
 
     auto mainLayout = new QVBoxLayout();
@@ -227,6 +255,23 @@ DatabaseWidget::DatabaseWidget(QSharedPointer<Database> db, QWidget* parent)
     m_autosaveTimer->setSingleShot(true);
     connect(m_autosaveTimer, SIGNAL(timeout()), this, SLOT(onAutosaveDelayTimeout()));
 
+    m_searchBatchTimer = new QTimer(this);
+    m_searchBatchTimer->setSingleShot(true);
+    m_searchBatchTimer->setInterval(0);
+    connect(m_searchBatchTimer, SIGNAL(timeout()), this, SLOT(searchNextBatch()));
+
+    m_adaptiveAutosaveTimer = new QTimer(this);
+    m_adaptiveAutosaveTimer->setSingleShot(true);
+    connect(m_adaptiveAutosaveTimer, SIGNAL(timeout()), this, SLOT(onAdaptiveAutosaveTimeout()));
+
+    m_journalCompactTimer = new QTimer(this);
+    m_journalCompactTimer->setSingleShot(true);
+    connect(m_journalCompactTimer, SIGNAL(timeout()), this, SLOT(onJournalCompactTimeout()));
+
+    m_cacheReleaseTimer = new QTimer(this);
+    m_cacheReleaseTimer->setSingleShot(true);
+    connect(m_cacheReleaseTimer, SIGNAL(timeout()), this, SLOT(onCacheReleaseTimeout()));
+
     m_searchLimitGroup = config()->get(Config::SearchLimitGroup).toBool();
 
 #ifdef WITH_XC_KEESHARE
@@ -489,6 +534,16 @@ void DatabaseWidget::replaceDatabase(QSharedPointer<Database> db)
 
     emit databaseReplaced(oldDb, m_db);
 
+    const auto keptJournalFilePath = m_db->keptJournalFilePath();
+    if (!keptJournalFilePath.isEmpty()) {
+        showMessage(tr("The save journal belongs to another version of the database file, its changes were not "
+                       "applied. The journal was kept as %1.")
+                        .arg(keptJournalFilePath),
+                    MessageWidget::Warning,
+                    true,
+                    MessageWidget::DisableAutoHide);
+    }
+
 #if defined(WITH_XC_KEESHARE)
     KeeShare::instance()->connectDatabase(m_db, oldDb);
 #else
@@ -496,21 +551,23 @@ void DatabaseWidget::replaceDatabase(QSharedPointer<Database> db)
     Q_UNUSED(oldDb);
 #endif
 
-    oldDb->releaseData();
+    oldDb->releaseData(true);
 }
 
 void DatabaseWidget::cloneEntry()
 {
-    auto currentEntry = currentSelectedEntry();
-    Q_ASSERT(currentEntry);
-    if (!currentEntry) {
+    auto selectedEntries = m_entryView->selectedEntries();
+    Q_ASSERT(!selectedEntries.isEmpty());
+    if (selectedEntries.isEmpty()) {
         return;
     }
 
-    auto cloneDialog = new CloneDialog(this, m_db.data(), currentEntry);
-    connect(cloneDialog, &CloneDialog::entryCloned, this, [this](auto entry) {
+    auto cloneDialog = new CloneDialog(this, m_db.data(), selectedEntries);
+    connect(cloneDialog, &CloneDialog::entriesCloned, this, [this](const QList<Entry*>& clones) {
         refreshSearch();
-        m_entryView->setCurrentEntry(entry);
+        if (!clones.isEmpty()) {
+            m_entryView->setCurrentEntry(clones.first());
+        }
     });
 
     cloneDialog->show();
@@ -586,6 +643,7 @@ void DatabaseWidget::restoreSelectedEntries()
         selectedEntries.append(m_entryView->entryFromIndex(index));
     }
 
+    DatabaseBulkUpdate bulkUpdate(m_db.data());
     for (auto* entry : selectedEntries) {
         if (entry->previousParentGroup()) {
             entry->setGroup(entry->previousParentGroup());
@@ -599,9 +657,12 @@ void DatabaseWidget::deleteEntries(QList<Entry*> selectedEntries, bool confirm)
         return;
     }
 
-    // Find the index above the first entry for selection after deletion
-    auto index = m_entryView->indexFromEntry(selectedEntries.first());
-    index = m_entryView->indexAbove(index);
+    // Find the entry above the first entry for selection after deletion, the rows may be reset meanwhile
+    auto index = m_entryView->indexAbove(m_entryView->indexFromEntry(selectedEntries.first()));
+    QPointer<Entry> entryAbove = index.isValid() ? m_entryView->entryFromIndex(index) : nullptr;
+    if (selectedEntries.contains(entryAbove)) {
+        entryAbove = nullptr;
+    }
 
     // Confirm entry removal before moving forward
     auto recycleBin = m_db->metadata()->recycleBin();
@@ -615,6 +676,7 @@ void DatabaseWidget::deleteEntries(QList<Entry*> selectedEntries, bool confirm)
     GuiTools::deleteEntriesResolveReferences(this, selectedEntries, permanent);
 
     // Select the row above the deleted entries
+    index = entryAbove ? m_entryView->indexFromEntry(entryAbove) : QModelIndex();
     if (index.isValid()) {
         m_entryView->setCurrentIndex(index);
     } else {
@@ -1121,8 +1183,18 @@ void DatabaseWidget::syncWithRemote(const RemoteParams* params)
         // Start a download first then merge and upload in the callback
         result = remoteHandler->download(params);
         if (result.success) {
+            const auto state = m_remoteSyncStates.value(params->name);
+            if (!state.fileHash.isEmpty() && state.fileHash == result.fileHash && state.databaseUuid == m_db->uuid()
+                && state.dataRevision == m_db->dataRevision()) {
+                // Neither the remote nor this database changed since the last sync
+                finishSync(params, result);
+                return;
+            }
+
             QString error;
             QSharedPointer<Database> remoteDb = QSharedPointer<Database>::create();
+            // The remote usually keeps the KDF seed of this database, which spares running the KDF again
+            remoteDb->reuseTransformedKey(*m_db);
             if (!remoteDb->open(result.filePath, m_db->key(), &error)) {
                 // Failed to open downloaded remote database with same key
                 // Unlock downloaded remote database via dialog
@@ -1172,6 +1244,11 @@ void DatabaseWidget::finishSync(const RemoteParams* params, RemoteHandler::Remot
 {
     setDisabled(false);
     emit updateSyncProgress(-1, "");
+    if (result.success && !result.fileHash.isEmpty()) {
+        m_remoteSyncStates.insert(params->name, {m_db->uuid(), m_db->dataRevision(), result.fileHash});
+    } else {
+        m_remoteSyncStates.remove(params->name);
+    }
     if (result.success) {
         emit databaseSyncCompleted(params->name);
         showMessage(tr("Remote sync '%1' completed successfully!").arg(params->name), MessageWidget::Positive, false);
@@ -1273,6 +1350,10 @@ void DatabaseWidget::connectDatabaseSignals()
     connect(m_db.data(), &Database::databaseFileChanged, this, &DatabaseWidget::reloadDatabaseFile);
     connect(m_db.data(), &Database::databaseNonDataChanged, this, &DatabaseWidget::databaseNonDataChanged);
     connect(m_db.data(), &Database::databaseNonDataChanged, this, &DatabaseWidget::onDatabaseNonDataChanged);
+    connect(EntryExpiryIndex::forDatabase(m_db.data()),
+            &EntryExpiryIndex::entriesExpired,
+            this,
+            &DatabaseWidget::onEntriesExpired);
 }
 
 void DatabaseWidget::loadDatabase(bool accepted)
@@ -1293,18 +1374,24 @@ void DatabaseWidget::loadDatabase(bool accepted)
         // Only show expired entries if first unlock and option is enabled
         if (m_groupBeforeLock.isNull() && config()->get(Config::GUI_ShowExpiredEntriesOnDatabaseUnlock).toBool()) {
             int expirationOffset = config()->get(Config::GUI_ShowExpiredEntriesOnDatabaseUnlockOffsetDays).toInt();
-            if (expirationOffset <= 0) {
-                m_nextSearchLabelText = tr("Expired entries");
-            } else {
-                m_nextSearchLabelText =
-                    tr("Entries expiring within %1 day(s)", "", expirationOffset).arg(expirationOffset);
+            // Do not search the whole database just to show an empty list
+            auto expiring = EntryExpiryIndex::forDatabase(m_db.data())
+                                ->entriesExpiringBefore(Clock::currentDateTime().addDays(expirationOffset));
+            if (!expiring.isEmpty()) {
+                if (expirationOffset <= 0) {
+                    m_nextSearchLabelText = tr("Expired entries");
+                } else {
+                    m_nextSearchLabelText =
+                        tr("Entries expiring within %1 day(s)", "", expirationOffset).arg(expirationOffset);
+                }
+                requestSearch(QString("is:expired-%1").arg(expirationOffset));
             }
-            requestSearch(QString("is:expired-%1").arg(expirationOffset));
         }
 
         m_groupBeforeLock = QUuid();
         m_entryBeforeLock = QUuid();
         m_saveAttempts = 0;
+        prewarmPasswordHealth();
         emit databaseUnlocked();
 #ifdef WITH_XC_SSHAGENT
         sshAgent()->databaseUnlocked(m_db);
@@ -1454,6 +1541,7 @@ void DatabaseWidget::unlockDatabase(bool accepted)
 
     switchToMainView();
     processAutoOpen();
+    prewarmPasswordHealth();
     emit databaseUnlocked();
 
 #ifdef WITH_XC_SSHAGENT
@@ -1673,15 +1761,45 @@ void DatabaseWidget::search(const QString& searchtext)
         return;
     }
 
+    // Results of a previous query that are still being matched are abandoned
+    cancelSearchBatches();
+
     auto searchGroup = m_db->rootGroup();
     if (m_searchLimitGroup && m_nextSearchLabelText.isEmpty()) {
         searchGroup = currentGroup();
     }
 
-    auto results = m_entrySearcher->search(searchtext, searchGroup);
+    // Saved searches over the whole database are kept up to date instead of searching again
+    QList<Entry*> results;
+    if (searchGroup == m_db->rootGroup() && m_db->metadata()->savedSearches().values().contains(searchtext)) {
+        results = LiveSearch::forQuery(m_db.data(), searchtext)->results(m_entrySearcher->isCaseSensitive());
+    } else {
+        QList<Entry*> entries;
+        searchGroup->forEachGroupRecursive([&entries](const Group* group) {
+            if (group->resolveSearchingEnabled()) {
+                entries.append(group->entries());
+            }
+            return true;
+        });
+
+        // Custom searches need all results to decide whether they are shown at all
+        if (entries.size() <= SearchBatchSize || !m_nextSearchLabelText.isEmpty()) {
+            results = m_entrySearcher->search(searchtext, searchGroup);
+        } else {
+            results = m_entrySearcher->searchEntries(searchtext, entries.mid(0, SearchBatchSize));
+            for (int i = SearchBatchSize; i < entries.size(); ++i) {
+                m_pendingSearchEntries.append(entries.at(i));
+            }
+            m_searchResultCount = results.size();
+            m_searchBatchTimer->start();
+        }
+    }
 
     // Display a label detailing our search results
-    if (!m_nextSearchLabelText.isEmpty()) {
+    if (!m_pendingSearchEntries.isEmpty()) {
+        m_searchingLabel->setText(results.isEmpty() ? tr("Searching…")
+                                                    : tr("Search Results (%1)").arg(results.size()));
+    } else if (!m_nextSearchLabelText.isEmpty()) {
         // Custom searches don't display if there are no results
         if (results.isEmpty()) {
             endSearch();
@@ -1708,6 +1826,45 @@ void DatabaseWidget::search(const QString& searchtext)
     emit searchModeActivated();
 }
 
+/**
+ * Match the next batch of entries of a large search and add the matching ones to the results.
+ */
+void DatabaseWidget::searchNextBatch()
+{
+    QList<Entry*> batch;
+    while (!m_pendingSearchEntries.isEmpty() && batch.size() < SearchBatchSize) {
+        // Entries deleted or moved to another database since the search started are skipped
+        auto entry = m_pendingSearchEntries.takeFirst();
+        if (entry && entry->database() == m_db.data()) {
+            batch.append(entry);
+        }
+    }
+
+    const auto results = m_entrySearcher->repeatEntries(batch);
+    m_entryView->appendSearchResults(results);
+    m_searchResultCount += results.size();
+
+    if (!m_pendingSearchEntries.isEmpty()) {
+        m_searchBatchTimer->start();
+        if (m_searchResultCount > 0) {
+            m_searchingLabel->setText(tr("Search Results (%1)").arg(m_searchResultCount));
+        }
+    } else if (m_searchResultCount > 0) {
+        m_searchingLabel->setText(tr("Search Results (%1)").arg(m_searchResultCount));
+    } else {
+        m_searchingLabel->setText(tr("No Results"));
+    }
+}
+
+void DatabaseWidget::cancelSearchBatches()
+{
+    if (m_searchBatchTimer) {
+        m_searchBatchTimer->stop();
+    }
+    m_pendingSearchEntries.clear();
+    m_searchResultCount = 0;
+}
+
 void DatabaseWidget::saveSearch(const QString& searchtext)
 {
     if (!m_db->isInitialized()) {
@@ -1785,6 +1942,14 @@ void DatabaseWidget::onDatabaseModified()
 {
     refreshSearch();
     m_remoteSettings->loadSettings();
+    const qint64 sinceLastChange = m_lastModification.isValid() ? m_lastModification.restart() : -1;
+    if (!m_lastModification.isValid()) {
+        m_lastModification.start();
+    }
+    if (isSaving()) {
+        // Changes made during a save are announced again once it is done
+        return;
+    }
     int autosaveDelayMs = m_db->metadata()->autosaveDelayMin() * 60 * 1000; // min to msec for QTimer
     bool autosaveAfterEveryChangeConfig = config()->get(Config::AutoSaveAfterEveryChange).toBool();
     if (autosaveDelayMs > 0 && autosaveAfterEveryChangeConfig) {
@@ -1793,13 +1958,72 @@ void DatabaseWidget::onDatabaseModified()
         return;
     }
     if (!m_blockAutoSave && autosaveAfterEveryChangeConfig) {
-        save();
+        const int delay = adaptiveAutosaveDelay(sinceLastChange);
+        if (delay > 0) {
+            if (!m_adaptiveAutosaveTimer->isActive()) {
+                m_autosavePendingSince.start();
+                m_adaptiveAutosaveTimer->start(delay);
+            } else if (m_autosavePendingSince.elapsed() + delay <= MaxAdaptiveAutosaveDelayMs) {
+                // Keep waiting for the changes to pause, up to the maximum delay
+                m_adaptiveAutosaveTimer->start(delay);
+            }
+            return;
+        }
+        m_adaptiveAutosaveTimer->stop();
+        autosave();
     } else {
         // Only block once, then reset
         m_blockAutoSave = false;
     }
 }
 
+/**
+ * Delay of an autosave after a change, adapted to the duration of the previous autosave.
+ *
+ * @param sinceLastChange milliseconds since the previous change, negative if there was none
+ * @return delay in milliseconds, 0 to save right away
+ */
+int DatabaseWidget::adaptiveAutosaveDelay(qint64 sinceLastChange) const
+{
+    // Quick saves, such as appending to the save journal, follow every change
+    if (m_lastAutosaveDurationMs < SlowAutosaveDurationMs) {
+        return 0;
+    }
+    const qint64 delay = qMin<qint64>(m_lastAutosaveDurationMs * 4, MaxAdaptiveAutosaveDelayMs);
+    if (sinceLastChange < 0 || sinceLastChange >= delay) {
+        return 0;
+    }
+    return static_cast<int>(delay);
+}
+
+void DatabaseWidget::autosave()
+{
+    QElapsedTimer saveTimer;
+    saveTimer.start();
+    if (!saveToJournal()) {
+        m_coalesceSave = true;
+        save();
+        m_coalesceSave = false;
+    }
+    m_lastAutosaveDurationMs = saveTimer.elapsed();
+}
+
+void DatabaseWidget::onAdaptiveAutosaveTimeout()
+{
+    if (isLocked() || !config()->get(Config::AutoSaveAfterEveryChange).toBool()) {
+        return;
+    }
+    if (isSaving()) {
+        // The changes are either part of the save in progress or announced again once it is done
+        return;
+    }
+    // Nothing to save if the changes were undone or saved otherwise, or a merge changed nothing
+    if (!m_db->isModified()) {
+        return;
+    }
+    autosave();
+}
+
 void DatabaseWidget::onAutosaveDelayTimeout()
 {
     const bool isAutosaveDelayEnabled = m_db->metadata()->autosaveDelayMin() > 0;
@@ -1808,14 +2032,63 @@ void DatabaseWidget::onAutosaveDelayTimeout()
         // User might disable the delay/autosave while the timer is running
         return;
     }
+    if (isSaving()) {
+        // The changes are either part of the save in progress or announced again once it is done
+        return;
+    }
     if (!m_blockAutoSave) {
-        save();
+        autosave();
     } else {
         // Only block once, then reset
         m_blockAutoSave = false;
     }
 }
 
+void DatabaseWidget::onJournalCompactTimeout()
+{
+    if (!isLocked() && !isSaving() && m_db->isModified()) {
+        save();
+    }
+}
+
+void DatabaseWidget::onCacheReleaseTimeout()
+{
+    if (!isLocked()) {
+        releaseCaches();
+    }
+}
+
+/**
+ * Start or stop the countdown to releasing the caches of the database.
+ *
+ * @param background whether the widget is in a tab that is not shown
+ */
+void DatabaseWidget::setBackgroundTab(bool background)
+{
+    if (!background) {
+        m_cacheReleaseTimer->stop();
+    } else if (!m_cacheReleaseTimer->isActive()) {
+        m_cacheReleaseTimer->start(CacheReleaseDelayMs);
+    }
+}
+
+/**
+ * Release the display caches, decoded icons and search indexes of the database.
+ *
+ * Everything released is built again on demand, the entries, the view state
+ * and the current search stay in place.
+ */
+void DatabaseWidget::releaseCaches()
+{
+    m_entryView->releaseCaches();
+    m_groupView->releaseCaches();
+    Icons::releaseCustomIconPixmaps(m_db.data());
+
+    m_db->searchIndex()->clear();
+    m_db->referenceIndex()->clear();
+    m_db->passwordEntropyCache()->clear();
+}
+
 void DatabaseWidget::triggerAutosaveTimer()
 {
     m_autosaveTimer->stop();
@@ -1830,6 +2103,15 @@ void DatabaseWidget::onDatabaseNonDataChanged()
     }
 }
 
+void DatabaseWidget::onEntriesExpired()
+{
+    // Expired entries are shown differently and may have to show up in the search results
+    if (m_lastSearchText.contains("is:expired", Qt::CaseInsensitive)) {
+        refreshSearch();
+    }
+    m_entryView->viewport()->update();
+}
+
 QString DatabaseWidget::getCurrentSearch()
 {
     return m_lastSearchText;
@@ -1837,6 +2119,8 @@ QString DatabaseWidget::getCurrentSearch()
 
 void DatabaseWidget::endSearch()
 {
+    cancelSearchBatches();
+
     if (isSearchActive()) {
         // Show the normal entry view of the current group
         emit listModeAboutToActivate();
@@ -1959,8 +2243,9 @@ bool DatabaseWidget::lock()
         return isLocked();
     }
 
-    // Don't try to lock the database while saving, this will cause a deadlock
-    if (m_db->isSaving()) {
+    // Don't try to lock the database while saving, this will cause a deadlock,
+    // or while a reload merges into it in the background
+    if (m_db->isSaving() || m_mergingInBackground) {
         QTimer::singleShot(200, this, SLOT(lock()));
         return false;
     }
@@ -2024,6 +2309,9 @@ bool DatabaseWidget::lock()
             } else if (result == MessageBox::Cancel) {
                 m_attemptingLock = false;
                 return false;
+            } else {
+                // Don't bring back discarded changes when the database is opened again
+                m_db->discardJournal();
             }
         }
     } else if (m_db->hasNonDataChanges() && config()->get(Config::AutoSaveNonDataChanges).toBool()) {
@@ -2062,8 +2350,8 @@ bool DatabaseWidget::lock()
 
 void DatabaseWidget::reloadDatabaseFile()
 {
-    // Ignore reload if we are locked, saving, or currently editing an entry or group
-    if (!m_db || isLocked() || isEntryEditActive() || isGroupEditActive() || isSaving()) {
+    // Ignore reload if we are locked, saving, merging a reload, or currently editing an entry or group
+    if (!m_db || isLocked() || isEntryEditActive() || isGroupEditActive() || isSaving() || m_mergingInBackground) {
         return;
     }
 
@@ -2102,9 +2390,10 @@ void DatabaseWidget::reloadDatabaseFile()
                 MessageBox::Merge);
 
             if (result == MessageBox::Merge) {
-                // Merge the old database into the new one
-                Merger merger(m_db.data(), db.data());
-                merger.merge();
+                // Merge the old database into the new one, which is not shown yet
+                m_mergingInBackground = true;
+                Merger::mergeInBackground(m_db, db);
+                m_mergingInBackground = false;
             }
         }
 
@@ -2309,6 +2598,8 @@ bool DatabaseWidget::save()
         m_saveAttempts = 0;
         m_blockAutoSave = false;
         m_autosaveTimer->stop(); // stop autosave delay to avoid triggering another save
+        m_adaptiveAutosaveTimer->stop();
+        m_journalCompactTimer->stop();
         return true;
     }
 
@@ -2374,16 +2665,33 @@ bool DatabaseWidget::saveAs()
     return ok;
 }
 
-bool DatabaseWidget::performSave(QString& errorMessage, const QString& fileName)
+/**
+ * Append the latest changes to the save journal instead of saving the whole database
+ * if journaling is enabled. The full save follows on a timer, on lock, or on exit.
+ *
+ * @return true if the changes were journaled
+ */
+bool DatabaseWidget::saveToJournal()
 {
-    QPointer<QWidget> focusWidget(qApp->focusWidget());
+    if (!config()->get(Config::AutoSaveJournal).toBool() || isLocked() || m_db->filePath().isEmpty()) {
+        return false;
+    }
 
-    // Lock out interactions
-    m_entryView->setDisabled(true);
-    m_groupView->setDisabled(true);
-    m_tagView->setDisabled(true);
-    QApplication::processEvents();
+    QString errorMessage;
+    if (!m_db->saveToJournal(&errorMessage)) {
+        // Fall back to a full save which reports any persistent problem
+        return false;
+    }
 
+    if (!m_journalCompactTimer->isActive()) {
+        m_journalCompactTimer->start(JournalCompactIntervalMs);
+    }
+    return true;
+}
+
+bool DatabaseWidget::performSave(QString& errorMessage, const QString& fileName)
+{
+    // The database is serialized before the file is written, it may be edited in the meantime
     Database::SaveAction saveAction = Database::Atomic;
     if (!config()->get(Config::UseAtomicSaves).toBool()) {
         if (config()->get(Config::UseDirectWriteSaves).toBool()) {
@@ -2391,6 +2699,8 @@ bool DatabaseWidget::performSave(QString& errorMessage, const QString& fileName)
         } else {
             saveAction = Database::TempFile;
         }
+    } else if (m_coalesceSave) {
+        saveAction = Database::Coalesced;
     }
 
     QString backupFilePath;
@@ -2413,23 +2723,10 @@ bool DatabaseWidget::performSave(QString& errorMessage, const QString& fileName)
         }
     }
 
-    bool ok;
     if (fileName.isEmpty()) {
-        ok = m_db->save(saveAction, backupFilePath, &errorMessage);
-    } else {
-        ok = m_db->saveAs(fileName, saveAction, backupFilePath, &errorMessage);
+        return m_db->save(saveAction, backupFilePath, &errorMessage);
     }
-
-    // Return control
-    m_entryView->setDisabled(false);
-    m_groupView->setDisabled(false);
-    m_tagView->setDisabled(false);
-
-    if (focusWidget && focusWidget->isVisible()) {
-        focusWidget->setFocus();
-    }
-
-    return ok;
+    return m_db->saveAs(fileName, saveAction, backupFilePath, &errorMessage);
 }
 
 /**
@@ -2526,6 +2823,30 @@ void DatabaseWidget::emptyRecycleBin()
     }
 }
 
+/**
+ * Estimate the entropies of all passwords in the background, so the password
+ * health of the entries is cached before the first weak password search or report.
+ */
+void DatabaseWidget::prewarmPasswordHealth()
+{
+    QStringList passwords;
+    m_db->rootGroup()->forEachEntryRecursive([&passwords](const Entry* entry) {
+        // Placeholders are resolved in the GUI thread, the same way Entry::passwordHealth() does
+        const auto pwd = entry->resolvePlaceholder(entry->password());
+        if (!pwd.isEmpty()) {
+            passwords << pwd;
+        }
+        return true;
+    });
+    if (passwords.isEmpty()) {
+        return;
+    }
+
+    // Locking the database clears the cache, which ends the estimation early
+    auto db = m_db;
+    QtConcurrent::run([db, passwords] { db->passwordEntropyCache()->prewarm(passwords); });
+}
+
 void DatabaseWidget::processAutoOpen()
 {
     Q_ASSERT(m_db);
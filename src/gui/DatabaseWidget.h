@@ -19,6 +19,7 @@
 #ifndef KEEPASSX_DATABASEWIDGET_H
 #define KEEPASSX_DATABASEWIDGET_H
 
+#include <QElapsedTimer>
 #include <QStackedWidget>
 
 #include "core/Database.h"
@@ -127,6 +128,9 @@ public:
     void setSplitterSizes(const QHash<Config::ConfigKey, QList<int>>& sizes);
     void setSearchStringForAutoType(const QString& search);
 
+    void setBackgroundTab(bool background);
+    void releaseCaches();
+
     void syncWithRemote(const RemoteParams* params);
     void syncDatabaseWithLockedDatabase(const QString& filePath, const RemoteParams* params);
     QList<RemoteParams*> getRemoteParams() const;
@@ -262,6 +266,7 @@ protected:
     bool focusNextPrevChild(bool next) override;
 
 private slots:
+    void searchNextBatch();
     void entryActivationSignalReceived(Entry* entry, EntryModel::ModelColumn column);
     void switchBackToEntryEdit();
     void switchToHistoryView(Entry* entry);
@@ -274,7 +279,11 @@ private slots:
     void onGroupChanged();
     void onDatabaseModified();
     void onDatabaseNonDataChanged();
+    void onEntriesExpired();
     void onAutosaveDelayTimeout();
+    void onAdaptiveAutosaveTimeout();
+    void onJournalCompactTimeout();
+    void onCacheReleaseTimeout();
     void connectDatabaseSignals();
     void loadDatabase(bool accepted);
     void unlockDatabase(bool accepted);
@@ -291,9 +300,14 @@ private slots:
 private:
     int addChildWidget(QWidget* w);
     void processAutoOpen();
+    void prewarmPasswordHealth();
     void openDatabaseFromEntry(const Entry* entry, bool inBackground = true);
     void performIconDownloads(const QList<Entry*>& entries, bool force = false, bool downloadInBackground = false);
     bool performSave(QString& errorMessage, const QString& fileName = {});
+    bool saveToJournal();
+    void autosave();
+    int adaptiveAutosaveDelay(qint64 sinceLastChange) const;
+    void cancelSearchBatches();
 
     QSharedPointer<Database> m_db;
 
@@ -327,18 +341,47 @@ private:
 
     QScopedPointer<RemoteSettings> m_remoteSettings;
 
+    // State of the remote file and the database after the last successful sync of a remote
+    struct RemoteSyncState
+    {
+        QUuid databaseUuid;
+        quint64 dataRevision = 0;
+        QByteArray fileHash;
+    };
+    QHash<QString, RemoteSyncState> m_remoteSyncStates;
+
     // Search state
     QScopedPointer<EntrySearcher> m_entrySearcher;
     QString m_lastSearchText;
     QString m_nextSearchLabelText;
     bool m_searchLimitGroup;
+    // Entries of a large search that are not matched yet
+    QList<QPointer<Entry>> m_pendingSearchEntries;
+    int m_searchResultCount = 0;
+    QPointer<QTimer> m_searchBatchTimer;
 
     // Autoreload
     bool m_blockAutoSave;
+    // Locking and closing wait for the merge of a reload
+    bool m_mergingInBackground = false;
 
     // Autosave delay
     QPointer<QTimer> m_autosaveTimer;
 
+    // Autosaves after every change wait for a pause while changes come faster than they are saved
+    QPointer<QTimer> m_adaptiveAutosaveTimer;
+    QElapsedTimer m_lastModification;
+    QElapsedTimer m_autosavePendingSince;
+    qint64 m_lastAutosaveDurationMs = 0;
+    // Autosaves defer syncing the file to disk until no other save follows
+    bool m_coalesceSave = false;
+
+    // Full save after changes went to the save journal
+    QPointer<QTimer> m_journalCompactTimer;
+
+    // Caches of a tab in the background are released after a while
+    QPointer<QTimer> m_cacheReleaseTimer;
+
     // Auto-Type related
     QString m_searchStringForAutoType;
 };
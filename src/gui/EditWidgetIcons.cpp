@@ -133,8 +133,7 @@ void EditWidgetIcons::load(const QUuid& currentUuid,
     m_currentUuid = currentUuid;
     setUrl(url);
 
-    m_customIconModel->setIcons(Icons::customIconsPixmaps(database.data(), IconSize::Default),
-                                database->metadata()->customIconsOrder());
+    m_customIconModel->setIcons(database.data());
 
     QUuid iconUuid = iconStruct.uuid;
     if (iconUuid.isNull()) {
@@ -313,8 +312,7 @@ bool EditWidgetIcons::addCustomIcon(const QImage& icon, const QString& name)
         if (uuid.isNull()) {
             uuid = QUuid::createUuid();
             m_db->metadata()->addCustomIcon(uuid, serializedIcon, name, Clock::currentDateTimeUtc());
-            m_customIconModel->setIcons(Icons::customIconsPixmaps(m_db.data(), IconSize::Default),
-                                        m_db->metadata()->customIconsOrder());
+            m_customIconModel->setIcons(m_db.data());
             added = true;
         }
 
@@ -25,6 +25,7 @@
 #include "core/Totp.h"
 #include "gui/Font.h"
 #include "gui/Icons.h"
+#include "gui/TotpTicker.h"
 #if defined(WITH_XC_KEESHARE)
 #include "keeshare/KeeShare.h"
 #include "keeshare/KeeShareSettings.h"
@@ -35,7 +36,9 @@
 namespace
 {
     constexpr int GeneralTabIndex = 0;
-}
+    // Selections closer together than this only update the header until the selection settles
+    constexpr int SelectionCoalesceMSec = 50;
+} // namespace
 
 EntryPreviewWidget::EntryPreviewWidget(QWidget* parent)
     : QWidget(parent)
@@ -83,7 +86,11 @@ EntryPreviewWidget::EntryPreviewWidget(QWidget* parent)
         openEntryUrl();
         m_ui->entryTabWidget->setFocus();
     });
-    connect(&m_totpTimer, SIGNAL(timeout()), SLOT(updateTotpLabel()));
+    // Only the visible tab is filled, the others are filled when they are shown
+    m_entryTabTimer.setSingleShot(true);
+    m_entryTabTimer.setInterval(SelectionCoalesceMSec);
+    connect(&m_entryTabTimer, SIGNAL(timeout()), SLOT(updateCurrentEntryTab()));
+    connect(m_ui->entryTabWidget, SIGNAL(currentChanged(int)), SLOT(updateCurrentEntryTab()));
 
     connect(m_ui->entryAttributesTable, &QTableWidget::itemDoubleClicked, this, [this](QTableWidgetItem* item) {
         auto userData = item->data(Qt::UserRole);
@@ -192,9 +199,14 @@ void EntryPreviewWidget::refresh()
     if (m_currentEntry) {
         updateEntryHeaderLine();
         updateEntryTotp();
-        updateEntryGeneralTab();
-        updateEntryAdvancedTab();
-        updateEntryAutotypeTab();
+        updateEntryTabStates();
+        m_updatedEntryTabs.clear();
+
+        const bool coalesce =
+            m_lastEntryTabUpdate.isValid() && !m_lastEntryTabUpdate.hasExpired(SelectionCoalesceMSec);
+        if (coalesce) {
+            m_entryTabTimer.start();
+        }
 
         setVisible(!config()->get(Config::GUI_HidePreviewPanel).toBool());
 
@@ -203,6 +215,10 @@ void EntryPreviewWidget::refresh()
             m_ui->entryTabWidget->isTabEnabled(m_selectedTabEntry) ? m_selectedTabEntry : GeneralTabIndex;
         Q_ASSERT(m_ui->entryTabWidget->isTabEnabled(GeneralTabIndex));
         m_ui->entryTabWidget->setCurrentIndex(tabIndex);
+
+        if (!coalesce) {
+            updateCurrentEntryTab();
+        }
     } else if (m_currentGroup) {
         updateGroupHeaderLine();
         updateGroupGeneralTab();
@@ -255,8 +271,10 @@ void EntryPreviewWidget::updateEntryTotp()
     const bool hasTotp = m_currentEntry->hasTotp();
     m_ui->entryTotpButton->setVisible(hasTotp);
 
+    // The settings may have changed, generate the code again
+    m_totpCodeExpires = 0;
     if (hasTotp) {
-        m_totpTimer.start(1000);
+        setTotpTicking(true);
         m_ui->entryTotpProgress->setMaximum(m_currentEntry->totpSettings()->step);
         updateTotpLabel();
     } else {
@@ -264,10 +282,39 @@ void EntryPreviewWidget::updateEntryTotp()
         m_ui->entryTotpProgress->hide();
         m_ui->entryTotpButton->setChecked(false);
         m_ui->entryTotpLabel->clear();
-        m_totpTimer.stop();
+        setTotpTicking(false);
+    }
+}
+
+/**
+ * Follow the application wide TOTP clock while a code is shown.
+ *
+ * @param ticking whether the shown code and countdown are updated every second
+ */
+void EntryPreviewWidget::setTotpTicking(bool ticking)
+{
+    if (ticking) {
+        connect(totpTicker(), &TotpTicker::tick, this, &EntryPreviewWidget::updateTotpLabel, Qt::UniqueConnection);
+    } else {
+        disconnect(totpTicker(), &TotpTicker::tick, this, &EntryPreviewWidget::updateTotpLabel);
+    }
+}
+
+void EntryPreviewWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    if (!m_locked && m_currentEntry && m_currentEntry->hasTotp()) {
+        setTotpTicking(true);
+        updateTotpLabel();
     }
 }
 
+void EntryPreviewWidget::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    setTotpTicking(false);
+}
+
 void EntryPreviewWidget::setUsernameVisible(bool state)
 {
     if (state) {
@@ -413,11 +460,9 @@ void EntryPreviewWidget::updateEntryAdvancedTab()
     const EntryAttributes* attributes = m_currentEntry->attributes();
     const QStringList customAttributes = attributes->customKeys();
     const bool hasAttributes = !customAttributes.isEmpty();
-    const bool hasAttachments = !m_currentEntry->attachments()->isEmpty();
     m_ui->entryAttributesTable->setRowCount(customAttributes.size());
     m_ui->entryAttributesTable->setColumnCount(3);
 
-    setTabEnabled(m_ui->entryTabWidget, m_ui->entryAdvancedTab, hasAttributes || hasAttachments);
     if (hasAttributes) {
         auto i = 0;
         QFont font;
@@ -486,11 +531,45 @@ void EntryPreviewWidget::updateEntryAutotypeTab()
     }
 
     m_ui->entryAutotypeTree->addTopLevelItems(items);
+}
+
+void EntryPreviewWidget::updateEntryTabStates()
+{
+    Q_ASSERT(m_currentEntry);
+    const bool hasAttributes = !m_currentEntry->attributes()->customKeys().isEmpty();
+    const bool hasAttachments = !m_currentEntry->attachments()->isEmpty();
+    setTabEnabled(m_ui->entryTabWidget, m_ui->entryAdvancedTab, hasAttributes || hasAttachments);
     setTabEnabled(m_ui->entryTabWidget,
                   m_ui->entryAutotypeTab,
                   m_currentEntry->autoTypeEnabled() && m_currentEntry->groupAutoTypeEnabled());
 }
 
+/**
+ * Fill the visible entry tab if it does not show the current entry yet.
+ */
+void EntryPreviewWidget::updateCurrentEntryTab()
+{
+    // A pending update fills the tab once the selection settles
+    if (!m_currentEntry || (m_entryTabTimer.isActive() && sender() != &m_entryTabTimer)) {
+        return;
+    }
+
+    auto tab = m_ui->entryTabWidget->currentWidget();
+    if (!tab || m_updatedEntryTabs.contains(tab)) {
+        return;
+    }
+    m_updatedEntryTabs.insert(tab);
+    m_lastEntryTabUpdate.start();
+
+    if (tab == m_ui->entryAdvancedTab) {
+        updateEntryAdvancedTab();
+    } else if (tab == m_ui->entryAutotypeTab) {
+        updateEntryAutotypeTab();
+    } else if (tab == m_ui->entryGeneralTab) {
+        updateEntryGeneralTab();
+    }
+}
+
 void EntryPreviewWidget::updateGroupHeaderLine()
 {
     Q_ASSERT(m_currentGroup);
@@ -541,17 +620,19 @@ void EntryPreviewWidget::updateGroupSharingTab()
 void EntryPreviewWidget::updateTotpLabel()
 {
     if (!m_locked && m_currentEntry && m_currentEntry->hasTotp()) {
-        auto totpCode = m_currentEntry->totp();
-        totpCode.insert(totpCode.size() / 2, " ");
-        m_ui->entryTotpLabel->setText(totpCode);
-
+        // Within a period only the countdown changes, unchanged values do not repaint
         auto step = m_currentEntry->totpSettings()->step;
-        auto timeleft = step - (Clock::currentSecondsSinceEpoch() % step);
-        m_ui->entryTotpProgress->setValue(timeleft);
-        m_ui->entryTotpProgress->update();
+        auto now = Clock::currentSecondsSinceEpoch();
+        if (now >= m_totpCodeExpires) {
+            auto totpCode = m_currentEntry->totp();
+            totpCode.insert(totpCode.size() / 2, " ");
+            m_ui->entryTotpLabel->setText(totpCode);
+            m_totpCodeExpires = now - (now % step) + step;
+        }
+        m_ui->entryTotpProgress->setValue(static_cast<int>(m_totpCodeExpires - now));
     } else {
         m_ui->entryTotpLabel->clear();
-        m_totpTimer.stop();
+        setTotpTicking(false);
     }
 }
 
@@ -21,6 +21,9 @@
 #include "config-keepassx.h"
 #include "gui/DatabaseWidget.h"
 
+#include <QElapsedTimer>
+#include <QSet>
+
 namespace Ui
 {
     class EntryPreviewWidget;
@@ -50,6 +53,8 @@ signals:
 
 protected:
     bool eventFilter(QObject* object, QEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 
 private slots:
     void updateEntryHeaderLine();
@@ -57,6 +62,7 @@ private slots:
     void updateEntryGeneralTab();
     void updateEntryAdvancedTab();
     void updateEntryAutotypeTab();
+    void updateCurrentEntryTab();
     void setUsernameVisible(bool state);
     void setPasswordVisible(bool state);
     void setEntryNotesVisible(bool state);
@@ -76,6 +82,8 @@ private slots:
 private:
     void removeTab(QTabWidget* tabWidget, QWidget* widget);
     void setTabEnabled(QTabWidget* tabWidget, QWidget* widget, bool enabled);
+    void updateEntryTabStates();
+    void setTotpTicking(bool ticking);
 
     static QString hierarchy(const Group* group, const QString& title);
 
@@ -83,7 +91,11 @@ private:
     bool m_locked;
     QPointer<Entry> m_currentEntry;
     QPointer<Group> m_currentGroup;
-    QTimer m_totpTimer;
+    // End of the period of the shown TOTP code, in seconds since the epoch
+    uint m_totpCodeExpires = 0;
+    QTimer m_entryTabTimer;
+    QElapsedTimer m_lastEntryTabUpdate;
+    QSet<QWidget*> m_updatedEntryTabs;
     quint8 m_selectedTabEntry;
     quint8 m_selectedTabGroup;
 };
@@ -124,6 +124,7 @@ namespace GuiTools
             selectedEntries << entry;
         }
 
+        DatabaseBulkUpdate bulkUpdate(entries.first()->database());
         for (auto entry : asConst(selectedEntries)) {
             if (permanent) {
                 delete entry;
@@ -26,6 +26,9 @@
 
 namespace
 {
+    // Output is collected up to this size before it is written to the device
+    const int ChunkSize = 64 * 1024;
+
     QString PixmapToHTML(const QPixmap& pixmap)
     {
         if (pixmap.isNull()) {
@@ -174,26 +177,23 @@ bool HtmlExporter::exportDatabase(QIODevice* device,
     const auto footer = QString("</body>"
                                 "</html>");
 
-    if (device->write(header.toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
-
-    if (db->rootGroup()) {
-        if (!writeGroup(*device, *db->rootGroup(), QString(), sorted, ascending)) {
-            return false;
-        }
-    }
+    m_device = device;
+    m_chunk.clear();
+    m_entryIcons.clear();
 
-    if (device->write(footer.toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
+    bool ok = write(header);
+    if (ok && db->rootGroup()) {
+        ok = writeGroup(*db->rootGroup(), QString(), sorted, ascending);
     }
+    ok = ok && write(footer) && flush();
 
-    return true;
+    m_device = nullptr;
+    m_chunk.clear();
+    m_entryIcons.clear();
+    return ok;
 }
 
-bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString path, bool sorted, bool ascending)
+bool HtmlExporter::writeGroup(const Group& group, QString path, bool sorted, bool ascending)
 {
     // Don't output the recycle bin
     if (&group == group.database()->metadata()->recycleBin()) {
@@ -225,14 +225,15 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
         }
 
         // Output it
-        if (device.write(header.toUtf8()) == -1) {
-            m_error = device.errorString();
+        if (!write(header)) {
             return false;
         }
     }
 
     // Begin the table for the entries in this group
-    auto table = QString("<table width=\"95%\">");
+    if (!write("<table width=\"95%\">")) {
+        return false;
+    }
 
     auto entries = group.entries();
     if (sorted) {
@@ -251,20 +252,21 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
 
         // Output it into our table. First the left side with
         // icon and entry title ...
-        table += "<tr>";
-        table += "<td width=\"1%\">" + PixmapToHTML(Icons::entryIconPixmap(entry, IconSize::Medium)) + "</td>";
+        QString row = "<tr>";
+        row += "<td width=\"1%\">" + entryIconHtml(entry) + "</td>";
         auto caption = "<caption>" + entry->title().toHtmlEscaped() + "</caption>";
 
         // ... then the right side with the data fields
-        table +=
+        row +=
             "<td style=\"padding-bottom: 0.5em;\"><table width=\"100%\">" + caption + formatted_entry + "</table></td>";
-        table += "</tr>";
+        row += "</tr>";
+        if (!write(row)) {
+            return false;
+        }
     }
 
-    // Output the complete table of this group
-    table.append("</table>\n");
-    if (device.write(table.toUtf8()) == -1) {
-        m_error = device.errorString();
+    // Close the table of this group
+    if (!write("</table>\n")) {
         return false;
     }
 
@@ -278,10 +280,41 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
 
     // Recursively output the child groups
     for (const auto* child : children) {
-        if (child && !writeGroup(device, *child, path, sorted, ascending)) {
+        if (child && !writeGroup(*child, path, sorted, ascending)) {
             return false;
         }
     }
 
     return true;
 }
+
+/**
+ * @return image tag of the entry icon, each distinct icon is only encoded once per export
+ */
+QString HtmlExporter::entryIconHtml(const Entry* entry)
+{
+    const auto key = QString("%1:%2").arg(entry->iconUuid().isNull() ? QString::number(entry->iconNumber())
+                                                                     : entry->iconUuid().toString(),
+                                          entry->isExpired() ? "expired" : "");
+    auto icon = m_entryIcons.constFind(key);
+    if (icon == m_entryIcons.constEnd()) {
+        icon = m_entryIcons.insert(key, PixmapToHTML(Icons::entryIconPixmap(entry, IconSize::Medium)));
+    }
+    return icon.value();
+}
+
+bool HtmlExporter::write(const QString& html)
+{
+    m_chunk.append(html.toUtf8());
+    return m_chunk.size() < ChunkSize || flush();
+}
+
+bool HtmlExporter::flush()
+{
+    if (!m_chunk.isEmpty() && m_device->write(m_chunk) == -1) {
+        m_error = m_device->errorString();
+        return false;
+    }
+    m_chunk.clear();
+    return true;
+}
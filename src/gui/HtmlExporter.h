@@ -18,10 +18,12 @@
 #ifndef KEEPASSX_HTMLEXPORTER_H
 #define KEEPASSX_HTMLEXPORTER_H
 
+#include <QHash>
 #include <QSharedPointer>
 #include <QString>
 
 class Database;
+class Entry;
 class Group;
 class QIODevice;
 
@@ -39,13 +41,16 @@ private:
                         const QSharedPointer<const Database>& db,
                         bool sorted = true,
                         bool ascending = true);
-    bool writeGroup(QIODevice& device,
-                    const Group& group,
-                    QString path = QString(),
-                    bool sorted = true,
-                    bool ascending = true);
+    bool writeGroup(const Group& group, QString path = QString(), bool sorted = true, bool ascending = true);
+    QString entryIconHtml(const Entry* entry);
+    bool write(const QString& html);
+    bool flush();
 
     QString m_error;
+    QIODevice* m_device = nullptr;
+    QByteArray m_chunk;
+    // Encoded icons by icon and expiry
+    QHash<QString, QString> m_entryIcons;
 };
 
 #endif // KEEPASSX_HTMLEXPORTER_H
@@ -21,7 +21,7 @@
 #include "networking/NetworkManager.h"
 
 #include <QBuffer>
-#include <QHostInfo>
+#include <QHostAddress>
 #include <QImageReader>
 #include <QNetworkReply>
 
@@ -72,14 +72,8 @@ void IconDownloader::setUrl(const QString& entryUrl)
 
     QString fullyQualifiedDomain = url.host();
 
-    // Determine if host portion of URL is an IP address by resolving it and
-    // searching for a match with the returned address(es).
-    bool hostIsIp = false;
-    QList<QHostAddress> hostAddresses = QHostInfo::fromName(fullyQualifiedDomain).addresses();
-    hostIsIp =
-        std::any_of(hostAddresses.begin(), hostAddresses.end(), [&fullyQualifiedDomain](const QHostAddress& addr) {
-            return addr.toString() == fullyQualifiedDomain;
-        });
+    // Determine if host portion of URL is an IP address, without a blocking name lookup
+    bool hostIsIp = !QHostAddress(fullyQualifiedDomain).isNull();
 
     // Determine the second-level domain, if available
     QString secondLevelDomain;
@@ -129,6 +123,10 @@ void IconDownloader::setUrl(const QString& entryUrl)
 void IconDownloader::download()
 {
     if (m_urlsToTry.isEmpty()) {
+        // Nothing to fetch, finish after the caller returned
+        if (!m_reply) {
+            QTimer::singleShot(0, this, [this] { emit finished(m_url, {}); });
+        }
         return;
     }
 
@@ -154,8 +152,7 @@ void IconDownloader::fetchFavicon(const QUrl& url)
     m_bytesReceived.clear();
     m_fetchUrl = url;
 
-    QNetworkRequest request(url);
-    m_reply = getNetMgr()->get(request);
+    m_reply = getNetMgr()->get(networkRequest(url));
 
     connect(m_reply, &QNetworkReply::finished, this, &IconDownloader::fetchFinished);
     connect(m_reply, &QIODevice::readyRead, this, &IconDownloader::fetchReadyRead);
@@ -32,6 +32,29 @@
 #endif
 
 #include <QStandardItemModel>
+#include <QUrl>
+
+namespace
+{
+    // Hosts whose favicons are fetched at the same time
+    constexpr int MaxParallelDownloads = 16;
+    constexpr int MaxCachedIcons = 4096;
+
+    /**
+     * Icons fetched in this session by host. The cache is not written to disk,
+     * the hosts of a database should not be readable outside of it.
+     */
+    QHash<QString, QImage>& iconCache()
+    {
+        static QHash<QString, QImage> cache;
+        return cache;
+    }
+
+    QString urlHost(const QString& url)
+    {
+        return QUrl::fromUserInput(url).host().toLower();
+    }
+} // namespace
 
 IconDownloaderDialog::IconDownloaderDialog(QWidget* parent)
     : QDialog(parent)
@@ -64,8 +87,8 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
                                             bool force)
 {
     m_db = database;
-    m_urlToEntries.clear();
     abortDownloads();
+    clearQueue();
     for (const auto& e : entries) {
         // Only consider entries with a valid URL and without a custom icon
         auto webUrl = e->webUrl();
@@ -85,9 +108,10 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
         QApplication::processEvents();
 
         for (const auto& url : m_urlToEntries.uniqueKeys()) {
+            m_urlRows.insert(url, m_dataModel->rowCount());
             m_dataModel->appendRow(QList<QStandardItem*>()
                                    << new QStandardItem(url) << new QStandardItem(tr("Downloading…")));
-            m_activeDownloaders.append(createDownloader(url));
+            enqueue(url);
         }
 
         // Setup the dialog
@@ -95,28 +119,70 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
         updateCancelButton();
         QApplication::processEvents();
 
-        // Start the downloads
-        for (auto downloader : m_activeDownloaders) {
-            downloader->download();
-        }
+        startDownloads();
     }
 }
 
 void IconDownloaderDialog::downloadFaviconInBackground(const QSharedPointer<Database>& database, Entry* entry)
 {
     m_db = database;
-    m_urlToEntries.clear();
     abortDownloads();
+    clearQueue();
 
     auto webUrl = entry->webUrl();
     if (!webUrl.isEmpty()) {
         m_urlToEntries.insert(webUrl, entry);
+        enqueue(webUrl);
+        startDownloads();
     }
+}
 
-    if (m_urlToEntries.count() > 0) {
-        m_activeDownloaders.append(createDownloader(webUrl));
-        m_activeDownloaders.first()->download();
+/**
+ * Queue the host of an URL, entries on the same host share one download.
+ *
+ * @param url entry URL
+ */
+void IconDownloaderDialog::enqueue(const QString& url)
+{
+    const auto host = urlHost(url);
+    if (!m_hostToUrls.contains(host)) {
+        m_pendingHosts.append(host);
+        ++m_hostCount;
     }
+    m_hostToUrls.insert(host, url);
+}
+
+void IconDownloaderDialog::clearQueue()
+{
+    m_urlToEntries.clear();
+    m_urlRows.clear();
+    m_hostToUrls.clear();
+    m_pendingHosts.clear();
+    m_hostCount = 0;
+    m_finishedHosts = 0;
+}
+
+/**
+ * Start downloads for the queued hosts up to the limit of parallel downloads,
+ * hosts fetched before in this session are answered from the cache.
+ */
+void IconDownloaderDialog::startDownloads()
+{
+    while (m_activeDownloaders.size() < MaxParallelDownloads && !m_pendingHosts.isEmpty()) {
+        const auto host = m_pendingHosts.takeFirst();
+        const auto cached = iconCache().constFind(host);
+        if (!host.isEmpty() && cached != iconCache().constEnd()) {
+            applyIcon(host, cached.value());
+            continue;
+        }
+        // The first URL of the host decides the candidate favicon URLs
+        auto downloader = createDownloader(m_hostToUrls.values(host).last());
+        m_activeDownloaders.append(downloader);
+        downloader->download();
+    }
+
+    updateProgressBar();
+    updateCancelButton();
 }
 
 IconDownloader* IconDownloaderDialog::createDownloader(const QString& url)
@@ -140,11 +206,33 @@ void IconDownloaderDialog::downloadFinished(const QString& url, const QImage& ic
     auto downloader = qobject_cast<IconDownloader*>(sender());
     if (downloader) {
         downloader->deleteLater();
-        m_activeDownloaders.removeAll(downloader);
+        if (!m_activeDownloaders.removeOne(downloader)) {
+            // The downloads were aborted
+            return;
+        }
     }
 
-    updateProgressBar();
-    updateCancelButton();
+    const auto host = urlHost(url);
+    if (!icon.isNull() && !host.isEmpty()) {
+        if (iconCache().size() >= MaxCachedIcons) {
+            iconCache().clear();
+        }
+        iconCache().insert(host, icon);
+    }
+    applyIcon(host, icon);
+    startDownloads();
+}
+
+/**
+ * Set the icon of a host on all entries with an URL on that host.
+ *
+ * @param host host of the entry URLs
+ * @param icon fetched icon, null if the download failed
+ */
+void IconDownloaderDialog::applyIcon(const QString& host, const QImage& icon)
+{
+    ++m_finishedHosts;
+    const auto urls = m_hostToUrls.values(host);
 
     if (m_db && !icon.isNull()) {
         // Don't add an icon larger than 128x128, but retain original size if smaller
@@ -156,22 +244,25 @@ void IconDownloaderDialog::downloadFinished(const QString& url, const QImage& ic
 
         QByteArray serializedIcon = Icons::saveToBytes(scaledIcon);
         QUuid uuid = m_db->metadata()->findCustomIcon(serializedIcon);
+        QString status = tr("Already Exists");
         if (uuid.isNull()) {
             uuid = QUuid::createUuid();
             m_db->metadata()->addCustomIcon(uuid, serializedIcon);
-            updateTable(url, tr("Ok"));
-        } else {
-            updateTable(url, tr("Already Exists"));
+            status = tr("Ok");
         }
 
-        // Set the icon on all the entries associated with this url
-        for (const auto entry : m_urlToEntries.values(url)) {
-            entry->setIcon(uuid);
+        // Set the icon on all the entries associated with the urls of this host
+        for (const auto& url : urls) {
+            updateTable(url, status);
+            for (const auto entry : m_urlToEntries.values(url)) {
+                entry->setIcon(uuid);
+            }
         }
     } else {
         showFallbackMessage(true);
-        updateTable(url, tr("Download Failed"));
-        return;
+        for (const auto& url : urls) {
+            updateTable(url, tr("Download Failed"));
+        }
     }
 }
 
@@ -184,8 +275,8 @@ void IconDownloaderDialog::showFallbackMessage(bool state)
 
 void IconDownloaderDialog::updateProgressBar()
 {
-    int total = m_urlToEntries.uniqueKeys().count();
-    int value = total - m_activeDownloaders.count();
+    int total = m_hostCount;
+    int value = m_finishedHosts;
     m_ui->progressBar->setValue(value);
     m_ui->progressBar->setMaximum(total);
     m_ui->progressLabel->setText(
@@ -194,15 +285,14 @@ void IconDownloaderDialog::updateProgressBar()
 
 void IconDownloaderDialog::updateCancelButton()
 {
-    m_ui->cancelButton->setEnabled(!m_activeDownloaders.isEmpty());
+    m_ui->cancelButton->setEnabled(!m_activeDownloaders.isEmpty() || !m_pendingHosts.isEmpty());
 }
 
 void IconDownloaderDialog::updateTable(const QString& url, const QString& message)
 {
-    for (int i = 0; i < m_dataModel->rowCount(); ++i) {
-        if (m_dataModel->item(i, 0)->text() == url) {
-            m_dataModel->item(i, 1)->setText(message);
-        }
+    const auto row = m_urlRows.constFind(url);
+    if (row != m_urlRows.constEnd()) {
+        m_dataModel->item(row.value(), 1)->setText(message);
     }
 }
 
@@ -212,6 +302,7 @@ void IconDownloaderDialog::abortDownloads()
         downloader->deleteLater();
     }
     m_activeDownloaders.clear();
+    m_pendingHosts.clear();
     updateProgressBar();
     updateCancelButton();
 }
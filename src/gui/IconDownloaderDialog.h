@@ -19,6 +19,7 @@
 #define KEEPASSX_ICONDOWNLOADERDIALOG_H
 
 #include <QDialog>
+#include <QHash>
 #include <QMap>
 #include <QMutex>
 
@@ -50,6 +51,10 @@ private slots:
 
 private:
     IconDownloader* createDownloader(const QString& url);
+    void enqueue(const QString& url);
+    void clearQueue();
+    void startDownloads();
+    void applyIcon(const QString& host, const QImage& icon);
 
     void showFallbackMessage(bool state);
     void updateTable(const QString& url, const QString& message);
@@ -60,6 +65,11 @@ private:
     QStandardItemModel* m_dataModel;
     QSharedPointer<Database> m_db;
     QMultiMap<QString, Entry*> m_urlToEntries;
+    QHash<QString, int> m_urlRows;
+    QMultiHash<QString, QString> m_hostToUrls;
+    QStringList m_pendingHosts;
+    int m_hostCount = 0;
+    int m_finishedHosts = 0;
     QList<IconDownloader*> m_activeDownloaders;
     QMutex m_mutex;
 
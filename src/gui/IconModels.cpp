@@ -19,7 +19,10 @@
 
 #include <QUuid>
 
+#include "core/Database.h"
+#include "core/Metadata.h"
 #include "gui/DatabaseIcons.h"
+#include "gui/Icons.h"
 
 DefaultIconModel::DefaultIconModel(QObject* parent)
     : QAbstractListModel(parent)
@@ -61,15 +64,32 @@ void CustomIconModel::setIcons(const QHash<QUuid, QPixmap>& icons, const QList<Q
 
     m_icons = icons;
     m_iconsOrder = iconsOrder;
+    m_db.clear();
     Q_ASSERT(m_icons.count() == m_iconsOrder.count());
 
     endResetModel();
 }
 
+/**
+ * Show the custom icons of a database, each icon is decoded when it is shown first.
+ *
+ * @param db database containing the icons
+ */
+void CustomIconModel::setIcons(const Database* db)
+{
+    beginResetModel();
+
+    m_icons.clear();
+    m_iconsOrder = db->metadata()->customIconsOrder();
+    m_db = db;
+
+    endResetModel();
+}
+
 int CustomIconModel::rowCount(const QModelIndex& parent) const
 {
     if (!parent.isValid()) {
-        return m_icons.size();
+        return m_iconsOrder.size();
     } else {
         return 0;
     }
@@ -83,6 +103,9 @@ QVariant CustomIconModel::data(const QModelIndex& index, int role) const
 
     if (role == Qt::DecorationRole) {
         QUuid uuid = uuidFromIndex(index);
+        if (m_db) {
+            return Icons::customIconPixmap(m_db, uuid, IconSize::Default);
+        }
         return m_icons.value(uuid);
     }
 
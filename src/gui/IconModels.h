@@ -20,6 +20,9 @@
 
 #include <QAbstractListModel>
 #include <QPixmap>
+#include <QPointer>
+
+class Database;
 
 class DefaultIconModel : public QAbstractListModel
 {
@@ -42,12 +45,14 @@ public:
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     void setIcons(const QHash<QUuid, QPixmap>& icons, const QList<QUuid>& iconsOrder);
+    void setIcons(const Database* db);
     QUuid uuidFromIndex(const QModelIndex& index) const;
     QModelIndex indexFromUuid(const QUuid& uuid) const;
 
 private:
     QHash<QUuid, QPixmap> m_icons;
     QList<QUuid> m_iconsOrder;
+    QPointer<const Database> m_db;
 };
 
 #endif // KEEPASSX_ICONMODELS_H
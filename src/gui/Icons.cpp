@@ -19,14 +19,17 @@
 #include "Icons.h"
 
 #include <QBuffer>
+#include <QCache>
 #include <QIconEngine>
 #include <QImageReader>
 #include <QPaintDevice>
 #include <QPainter>
+#include <QSet>
 
 #include "config-keepassx.h"
 #include "core/Config.h"
 #include "core/Database.h"
+#include "crypto/CryptoHash.h"
 #include "gui/DatabaseIcons.h"
 #include "gui/MainWindow.h"
 #include "gui/osutils/OSUtils.h"
@@ -35,6 +38,20 @@
 #include "keeshare/KeeShare.h"
 #endif
 
+namespace
+{
+    // Decoded custom icons are shared by all databases, the cost of an icon is the size of its pixels in bytes
+    const int MaxCustomIconCacheCost = 16 * 1024 * 1024;
+
+    // Hash of the icon data and pixel size
+    typedef QPair<QByteArray, int> CustomIconKey;
+    typedef QCache<CustomIconKey, QPixmap> CustomIconCache;
+    Q_GLOBAL_STATIC_WITH_ARGS(CustomIconCache, customIconCache, (MaxCustomIconCacheCost))
+
+    // Icons with an override color are usually drawn in a few state colors only
+    const int MaxColoredIcons = 256;
+} // namespace
+
 class AdaptiveIconEngine : public QIconEngine
 {
 public:
@@ -52,6 +69,12 @@ Icons* Icons::m_instance(nullptr);
 
 Icons::Icons() = default;
 
+uint qHash(const Icons::IconKey& key, uint seed)
+{
+    // An override color is only set together with its flag, so the color alone tells the icons apart
+    return qHash(key.name, seed) ^ key.color ^ (key.recolor ? 0x80000000u : 0u);
+}
+
 QString Icons::applicationIconName()
 {
 #ifdef KEEPASSXC_DIST_FLATPAK
@@ -171,24 +194,42 @@ QIcon Icons::icon(const QString& name, bool recolor, const QColor& overrideColor
     //
     // See issue #4963: https://github.com/keepassxreboot/keepassxc/issues/4963
     // and qt5ct issue #80: https://sourceforge.net/p/qt5ct/tickets/80/
-    QIcon::setThemeName("application");
+    //
+    // Setting the theme name invalidates all themed icons, so it is only set once it changed.
+    if (QIcon::themeName() != QLatin1String("application")) {
+        QIcon::setThemeName("application");
+    }
 #endif
 
-    QString cacheName =
-        QString("%1:%2:%3").arg(recolor ? "1" : "0", overrideColor.isValid() ? overrideColor.name() : "#", name);
-    QIcon icon = m_iconCache.value(cacheName);
+    IconKey key;
+    key.name = name;
+    key.recolor = recolor;
+    key.overrideColor = overrideColor.isValid();
+    if (key.overrideColor) {
+        key.color = overrideColor.rgba();
+    }
 
-    if (!icon.isNull() && !overrideColor.isValid()) {
-        return icon;
+    const auto cached = m_iconCache.constFind(key);
+    if (cached != m_iconCache.constEnd()) {
+        return cached.value();
     }
 
-    icon = QIcon::fromTheme(name);
+    QIcon icon = QIcon::fromTheme(name);
     if (recolor) {
         icon = QIcon(new AdaptiveIconEngine(icon, overrideColor));
         icon.setIsMask(true);
     }
 
-    m_iconCache.insert(cacheName, icon);
+    if (key.overrideColor) {
+        if (m_coloredIconCount >= MaxColoredIcons) {
+            for (auto it = m_iconCache.begin(); it != m_iconCache.end();) {
+                it = it.key().overrideColor ? m_iconCache.erase(it) : std::next(it);
+            }
+            m_coloredIconCount = 0;
+        }
+        ++m_coloredIconCount;
+    }
+    m_iconCache.insert(key, icon);
     return icon;
 }
 
@@ -210,26 +251,59 @@ Icons* Icons::instance()
     return m_instance;
 }
 
+/**
+ * Get a custom icon of a database.
+ *
+ * Icons are decoded on the first request and kept in a cache shared by all
+ * databases, so databases with the same icons decode them only once.
+ *
+ * @param db database containing the icon
+ * @param uuid uuid of the icon
+ * @param size size of the pixmap
+ * @return pixmap of the icon, null if the database does not contain the icon
+ */
 QPixmap Icons::customIconPixmap(const Database* db, const QUuid& uuid, IconSize size)
 {
     if (!db->metadata()->hasCustomIcon(uuid)) {
         return {};
     }
+
+    const auto data = db->metadata()->customIcon(uuid).data;
+    const int pixelSize = databaseIcons()->iconSize(size);
+    const CustomIconKey key(CryptoHash::hash(data, CryptoHash::Sha256), pixelSize);
+    if (const auto* cached = customIconCache()->object(key)) {
+        return *cached;
+    }
+
     // Generate QIcon with pre-baked resolutions
-    auto icon = QImage::fromData(db->metadata()->customIcon(uuid).data);
+    auto icon = QImage::fromData(data);
     auto basePixmap = QPixmap::fromImage(icon.scaled(64, 64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-    return QIcon(basePixmap).pixmap(databaseIcons()->iconSize(size));
+    const auto pixmap = QIcon(basePixmap).pixmap(pixelSize);
+    customIconCache()->insert(key, new QPixmap(pixmap), qMax(1, pixmap.width() * pixmap.height() * 4));
+    return pixmap;
 }
 
-QHash<QUuid, QPixmap> Icons::customIconsPixmaps(const Database* db, IconSize size)
+/**
+ * Drop the decoded custom icons of a database, they are decoded again on their next use.
+ *
+ * @param db database whose custom icons are released
+ */
+void Icons::releaseCustomIconPixmaps(const Database* db)
 {
-    QHash<QUuid, QPixmap> result;
-
-    for (const QUuid& uuid : db->metadata()->customIconsOrder()) {
-        result.insert(uuid, Icons::customIconPixmap(db, uuid, size));
+    QSet<QByteArray> hashes;
+    const auto* metadata = db->metadata();
+    for (const auto& uuid : metadata->customIconsOrder()) {
+        hashes.insert(CryptoHash::hash(metadata->customIcon(uuid).data, CryptoHash::Sha256));
+    }
+    if (hashes.isEmpty()) {
+        return;
     }
 
-    return result;
+    for (const auto& key : customIconCache()->keys()) {
+        if (hashes.contains(key.first)) {
+            customIconCache()->remove(key);
+        }
+    }
 }
 
 QPixmap Icons::entryIconPixmap(const Entry* entry, IconSize size)
@@ -19,6 +19,7 @@
 #ifndef KEEPASSX_ICONS_H
 #define KEEPASSX_ICONS_H
 
+#include <QColor>
 #include <QIcon>
 
 #include <core/Database.h>
@@ -35,9 +36,9 @@ public:
     QIcon onOffIcon(const QString& name, bool on, bool recolor = true);
 
     static QPixmap customIconPixmap(const Database* db, const QUuid& uuid, IconSize size = IconSize::Default);
-    static QHash<QUuid, QPixmap> customIconsPixmaps(const Database* db, IconSize size = IconSize::Default);
     static QPixmap entryIconPixmap(const Entry* entry, IconSize size = IconSize::Default);
     static QPixmap groupIconPixmap(const Group* group, IconSize size = IconSize::Default);
+    static void releaseCustomIconPixmaps(const Database* db);
 
     static QByteArray saveToBytes(const QImage& image);
     static QString imageFormatsFilter();
@@ -45,11 +46,27 @@ public:
     static Icons* instance();
 
 private:
+    struct IconKey
+    {
+        QString name;
+        QRgb color = 0;
+        bool recolor = false;
+        bool overrideColor = false;
+
+        bool operator==(const IconKey& other) const
+        {
+            return color == other.color && recolor == other.recolor && overrideColor == other.overrideColor
+                   && name == other.name;
+        }
+    };
+    friend uint qHash(const IconKey& key, uint seed);
+
     Icons();
 
     static Icons* m_instance;
 
-    QHash<QString, QIcon> m_iconCache;
+    QHash<IconKey, QIcon> m_iconCache;
+    int m_coloredIconCount = 0;
 
     Q_DISABLE_COPY(Icons)
 };
@@ -38,6 +38,7 @@
 #include "autotype/AutoType.h"
 #include "core/InactivityTimer.h"
 #include "core/Resources.h"
+#include "core/StartupTrace.h"
 #include "gui/AboutDialog.h"
 #include "gui/ActionCollection.h"
 #include "gui/Icons.h"
@@ -64,6 +65,7 @@
 
 #ifdef WITH_XC_FDOSECRETS
 #include "fdosecrets/FdoSecretsPlugin.h"
+#include "fdosecrets/FdoSecretsSettings.h"
 #endif
 
 #ifdef WITH_XC_YUBIKEY
@@ -72,6 +74,7 @@
 
 #ifdef WITH_XC_BROWSER
 #include "browser/BrowserService.h"
+#include "browser/BrowserSettings.h"
 #endif
 
 #if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS) && !defined(QT_NO_DBUS)
@@ -198,14 +201,7 @@ MainWindow::MainWindow()
 
     m_ui->settingsWidget->addSettingsPage(new ShortcutSettingsPage());
 
-#ifdef WITH_XC_BROWSER
-    connect(
-        browserService(), &BrowserService::requestUnlock, m_ui->tabWidget, &DatabaseTabWidget::performBrowserUnlock);
-#endif
-
 #ifdef WITH_XC_SSHAGENT
-    connect(sshAgent(), SIGNAL(error(QString)), this, SLOT(showErrorMessage(QString)));
-    connect(sshAgent(), SIGNAL(enabledChanged(bool)), this, SLOT(agentEnabled(bool)));
     m_ui->settingsWidget->addSettingsPage(new AgentSettingsPage());
 #endif
 
@@ -222,7 +218,6 @@ MainWindow::MainWindow()
     connect(fdoSS, &FdoSecretsPlugin::error, this, &MainWindow::showErrorMessage);
     connect(fdoSS, &FdoSecretsPlugin::requestSwitchToDatabases, this, &MainWindow::switchToDatabases);
     connect(fdoSS, &FdoSecretsPlugin::requestShowNotification, this, &MainWindow::displayDesktopNotification);
-    fdoSS->updateServiceState();
     m_ui->settingsWidget->addSettingsPage(fdoSS);
 #endif
 
@@ -251,23 +246,18 @@ MainWindow::MainWindow()
     m_actionMultiplexer.connect(m_setTagsMenuActions, SIGNAL(triggered(QAction*)), SLOT(setTag(QAction*)));
     connect(m_ui->menuTags, &QMenu::aboutToShow, this, &MainWindow::updateSetTagsMenu);
 
-    Qt::Key globalAutoTypeKey = static_cast<Qt::Key>(config()->get(Config::GlobalAutoTypeKey).toInt());
-    Qt::KeyboardModifiers globalAutoTypeModifiers =
-        static_cast<Qt::KeyboardModifiers>(config()->get(Config::GlobalAutoTypeModifiers).toInt());
-    if (globalAutoTypeKey > 0 && globalAutoTypeModifiers > 0) {
-        autoType()->registerGlobalShortcut(globalAutoTypeKey, globalAutoTypeModifiers);
-    }
-
     m_ui->toolbarSeparator->setVisible(false);
     m_showToolbarSeparator = config()->get(Config::GUI_ApplicationTheme).toString() != "classic";
 
-    m_ui->actionEntryAutoType->setVisible(autoType()->isAvailable());
     m_ui->actionAllowScreenCapture->setVisible(osUtils->canPreventScreenCapture());
 
     m_inactivityTimer = new InactivityTimer(this);
     connect(m_inactivityTimer, SIGNAL(inactivityDetected()), this, SLOT(lockDatabasesAfterInactivity()));
     applySettingsChanges();
 
+    // Integrations are loaded once the window was shown, see initIntegrations()
+    QTimer::singleShot(0, this, &MainWindow::initIntegrations);
+
     // Qt 5.10 introduced a new "feature" to hide shortcuts in context menus
     // Unfortunately, Qt::AA_DontShowShortcutsInContextMenus is broken, have to manually enable them
     m_ui->actionEntryNew->setShortcutVisibleInContextMenu(true);
@@ -752,7 +742,7 @@ bool MainWindow::refreshHardwareKeys()
 #ifdef WITH_XC_YUBIKEY
     auto yk = YubiKey::instance();
     // find keys sync to allow returning if any key was found
-    bool found = yk->findValidKeys();
+    bool found = yk->findValidKeys(true);
     // emit signal so DatabaseOpenWidget can select last used key
     // emit here manually because sync findValidKeys() cannot do that properly
     emit yk->detectComplete(found);
@@ -903,7 +893,7 @@ void MainWindow::updateMenuActionState()
         (groupSelected && dbWidget->currentEntryIndex() == dbWidget->currentGroup()->entries().size() - 1);
 
     m_ui->actionEntryNew->setEnabled(inDatabase && !inRecycleBin);
-    m_ui->actionEntryClone->setEnabled(singleEntrySelected && !inRecycleBin);
+    m_ui->actionEntryClone->setEnabled(multiEntrySelected && !inRecycleBin);
     m_ui->actionEntryEdit->setEnabled(singleEntrySelected);
     m_ui->actionEntryDelete->setEnabled(multiEntrySelected);
     m_ui->actionEntryRestore->setVisible(multiEntrySelected && inRecycleBin);
@@ -1629,6 +1619,60 @@ void MainWindow::applySettingsChanges()
     }
 
     updateTrayIcon();
+
+    if (m_integrationsInitialized) {
+        initIntegrations();
+    }
+}
+
+/**
+ * Load the integrations that are enabled in the settings.
+ *
+ * Runs from the event loop after the main window was shown for the first time,
+ * and again whenever the settings change so that integrations enabled later on
+ * are picked up. Integrations that are disabled are never loaded.
+ */
+void MainWindow::initIntegrations()
+{
+    if (!m_integrationsInitialized) {
+        m_integrationsInitialized = true;
+
+        // Loads the auto-type plugin
+        m_ui->actionEntryAutoType->setVisible(autoType()->isAvailable());
+        Qt::Key globalAutoTypeKey = static_cast<Qt::Key>(config()->get(Config::GlobalAutoTypeKey).toInt());
+        Qt::KeyboardModifiers globalAutoTypeModifiers =
+            static_cast<Qt::KeyboardModifiers>(config()->get(Config::GlobalAutoTypeModifiers).toInt());
+        if (globalAutoTypeKey > 0 && globalAutoTypeModifiers > 0) {
+            autoType()->registerGlobalShortcut(globalAutoTypeKey, globalAutoTypeModifiers);
+        }
+        StartupTrace::mark("auto-type");
+    }
+
+#ifdef WITH_XC_BROWSER
+    if (browserSettings()->isEnabled()) {
+        connect(browserService(),
+                &BrowserService::requestUnlock,
+                m_ui->tabWidget,
+                &DatabaseTabWidget::performBrowserUnlock,
+                Qt::UniqueConnection);
+        StartupTrace::mark("browser integration");
+    }
+#endif
+
+#ifdef WITH_XC_SSHAGENT
+    if (sshAgent()->isEnabled()) {
+        connect(sshAgent(), SIGNAL(error(QString)), this, SLOT(showErrorMessage(QString)), Qt::UniqueConnection);
+        connect(sshAgent(), SIGNAL(enabledChanged(bool)), this, SLOT(agentEnabled(bool)), Qt::UniqueConnection);
+        StartupTrace::mark("ssh agent");
+    }
+#endif
+
+#ifdef WITH_XC_FDOSECRETS
+    if (FdoSecrets::settings()->isEnabled()) {
+        FdoSecretsPlugin::getPlugin()->updateServiceState();
+        StartupTrace::mark("secret service");
+    }
+#endif
 }
 
 void MainWindow::setAllowScreenCapture(bool state)
@@ -24,6 +24,7 @@
 #include <QShortcut>
 #include <QTimer>
 
+#include "core/AsyncTask.h"
 #include "core/Config.h"
 #include "core/PasswordHealth.h"
 #include "core/Resources.h"
@@ -55,6 +56,10 @@ PasswordGeneratorWidget::PasswordGeneratorWidget(QWidget* parent)
     shortcut = new QShortcut(Qt::CTRL + Qt::Key_S, this);
     connect(shortcut, &QShortcut::activated, this, [this] { applyPassword(); });
 
+    m_strengthTimer.setSingleShot(true);
+    m_strengthTimer.setInterval(100);
+    connect(&m_strengthTimer, &QTimer::timeout, this, &PasswordGeneratorWidget::estimatePasswordStrength);
+
     connect(m_ui->editNewPassword, SIGNAL(textChanged(QString)), SLOT(updateButtonsEnabled(QString)));
     connect(m_ui->editNewPassword, SIGNAL(textChanged(QString)), SLOT(updatePasswordStrength()));
     connect(m_ui->editNewPassword, SIGNAL(textChanged(QString)), SLOT(updatePasswordLengthLabel(QString)));
@@ -272,15 +277,35 @@ void PasswordGeneratorWidget::updateButtonsEnabled(const QString& password)
 
 void PasswordGeneratorWidget::updatePasswordStrength()
 {
-    // Calculate the password / passphrase health
-    PasswordHealth passwordHealth(0);
+    // The passphrase entropy follows from the generator settings, passwords are estimated with zxcvbn
     if (m_ui->tabWidget->currentIndex() == Diceware) {
-        passwordHealth.init(m_dicewareGenerator->estimateEntropy());
+        m_strengthTimer.stop();
+        ++m_strengthRequest;
         m_ui->charactersInPassphraseLabel->setText(QString::number(m_ui->editNewPassword->text().length()));
+        showPasswordStrength(PasswordHealth(m_dicewareGenerator->estimateEntropy()));
     } else {
-        passwordHealth = PasswordHealth(m_ui->editNewPassword->text());
+        m_strengthTimer.start();
     }
+}
 
+/**
+ * Estimate the entropy of the current password in the background.
+ */
+void PasswordGeneratorWidget::estimatePasswordStrength()
+{
+    const auto password = m_ui->editNewPassword->text();
+    const auto request = ++m_strengthRequest;
+    AsyncTask::runThenCallback([password] { return PasswordHealth::estimateEntropy(password); },
+                               this,
+                               [this, request](double entropy) {
+                                   if (request == m_strengthRequest) {
+                                       showPasswordStrength(PasswordHealth(entropy));
+                                   }
+                               });
+}
+
+void PasswordGeneratorWidget::showPasswordStrength(const PasswordHealth& passwordHealth)
+{
     // Update the entropy text labels
     m_ui->entropyLabel->setText(tr("Entropy: %1 bit").arg(QString::number(passwordHealth.entropy(), 'f', 2)));
     m_ui->entropyProgressBar->setValue(std::min(int(passwordHealth.entropy()), m_ui->entropyProgressBar->maximum()));
@@ -76,6 +76,7 @@ protected:
 private slots:
     void updateButtonsEnabled(const QString& password);
     void updatePasswordStrength();
+    void estimatePasswordStrength();
     void updatePasswordLengthLabel(const QString& password);
     void setAdvancedMode(bool advanced);
     void excludeHexChars();
@@ -90,12 +91,17 @@ private:
     bool m_passwordGenerated = false;
     int m_firstCustomWordlistIndex;
 
+    void showPasswordStrength(const PasswordHealth& passwordHealth);
     PasswordGenerator::CharClasses charClasses();
     PasswordGenerator::GeneratorFlags generatorFlags();
 
     const QScopedPointer<PasswordGenerator> m_passwordGenerator;
     const QScopedPointer<PassphraseGenerator> m_dicewareGenerator;
     const QScopedPointer<Ui::PasswordGeneratorWidget> m_ui;
+
+    // Debounces the estimates of typed passwords, stale results are dropped
+    QTimer m_strengthTimer;
+    quint64 m_strengthRequest = 0;
 };
 
 #endif // KEEPASSX_PASSWORDGENERATORWIDGET_H
@@ -19,6 +19,7 @@
 #include "PasswordWidget.h"
 #include "ui_PasswordWidget.h"
 
+#include "core/AsyncTask.h"
 #include "core/Config.h"
 #include "core/PasswordHealth.h"
 #include "gui/Font.h"
@@ -89,6 +90,10 @@ PasswordWidget::PasswordWidget(QWidget* parent)
     m_ui->passwordEdit->addAction(m_capslockAction, QLineEdit::LeadingPosition);
     m_capslockAction->setVisible(false);
 
+    m_strengthTimer.setSingleShot(true);
+    m_strengthTimer.setInterval(100);
+    connect(&m_strengthTimer, &QTimer::timeout, this, &PasswordWidget::estimatePasswordStrength);
+
     // Reset the password strength bar, hidden by default
     updatePasswordStrength("");
     m_ui->qualityProgressBar->setVisible(false);
@@ -106,6 +111,9 @@ PasswordWidget::~PasswordWidget()
 void PasswordWidget::setQualityVisible(bool state)
 {
     m_ui->qualityProgressBar->setVisible(state);
+    if (state) {
+        updatePasswordStrength(m_ui->passwordEdit->text());
+    }
 }
 
 QString PasswordWidget::text()
@@ -259,13 +267,37 @@ void PasswordWidget::checkCapslockState()
 void PasswordWidget::updatePasswordStrength(const QString& password)
 {
     if (password.isEmpty()) {
+        m_strengthTimer.stop();
+        ++m_strengthRequest;
         m_ui->qualityProgressBar->setValue(0);
         m_ui->qualityProgressBar->setToolTip((tr("")));
         return;
     }
 
-    PasswordHealth health(password);
+    // The estimate is only shown by the quality bar, which is hidden by default
+    if (!m_ui->qualityProgressBar->isHidden()) {
+        m_strengthTimer.start();
+    }
+}
 
+/**
+ * Estimate the entropy of the current password in the background.
+ */
+void PasswordWidget::estimatePasswordStrength()
+{
+    const auto password = m_ui->passwordEdit->text();
+    const auto request = ++m_strengthRequest;
+    AsyncTask::runThenCallback([password] { return PasswordHealth::estimateEntropy(password); },
+                               this,
+                               [this, request](double entropy) {
+                                   if (request == m_strengthRequest) {
+                                       showPasswordStrength(PasswordHealth(entropy));
+                                   }
+                               });
+}
+
+void PasswordWidget::showPasswordStrength(const PasswordHealth& health)
+{
     m_ui->qualityProgressBar->setValue(std::min(int(health.entropy()), m_ui->qualityProgressBar->maximum()));
 
     QString style = m_ui->qualityProgressBar->styleSheet();
@@ -22,8 +22,11 @@
 #include <QAction>
 #include <QLineEdit>
 #include <QPointer>
+#include <QTimer>
 #include <QWidget>
 
+class PasswordHealth;
+
 namespace Ui
 {
     class PasswordWidget;
@@ -64,10 +67,12 @@ private slots:
     void popupPasswordGenerator();
     void updateRepeatStatus();
     void updatePasswordStrength(const QString& password);
+    void estimatePasswordStrength();
 
 private:
     void checkCapslockState();
     void setParentPasswordEdit(PasswordWidget* parent);
+    void showPasswordStrength(const PasswordHealth& health);
 
     const QScopedPointer<Ui::PasswordWidget> m_ui;
 
@@ -80,6 +85,9 @@ private:
     QPointer<PasswordWidget> m_parentPasswordWidget;
 
     bool m_capslockState = false;
+    // Debounces the estimates of typed passwords, stale results are dropped
+    QTimer m_strengthTimer;
+    quint64 m_strengthRequest = 0;
 };
 
 #endif // KEEPASSX_PASSWORDWIDGET_H
@@ -48,8 +48,39 @@ bool SortFilterHideProxyModel::lessThan(const QModelIndex& left, const QModelInd
     auto leftData = sourceModel()->data(left, sortRole());
     auto rightData = sourceModel()->data(right, sortRole());
     if (leftData.type() == QVariant::String) {
-        return m_collator.compare(leftData.toString(), rightData.toString()) < 0;
+        if (left.parent().isValid() || right.parent().isValid()) {
+            return m_collator.compare(leftData.toString(), rightData.toString()) < 0;
+        }
+        return sortKey(left, leftData.toString()).compare(sortKey(right, rightData.toString())) < 0;
     }
 
     return QSortFilterProxyModel::lessThan(left, right);
 }
+
+/**
+ * Get the collation key of a sorted cell of a flat source model.
+ *
+ * Sorting compares every row many times, comparing keys is much cheaper than
+ * collating the strings on each comparison.
+ *
+ * @param index source index of the cell
+ * @param text sort text of the cell
+ * @return collation key of the text
+ */
+QCollatorSortKey SortFilterHideProxyModel::sortKey(const QModelIndex& index, const QString& text) const
+{
+    if (index.column() != m_sortKeyColumn) {
+        m_sortKeys.clear();
+        m_sortKeyColumn = index.column();
+    }
+
+    // Rows may have been moved or changed since the key was made
+    auto it = m_sortKeys.constFind(index.row());
+    if (it != m_sortKeys.constEnd() && it->text == text) {
+        return it->key;
+    }
+
+    const SortKey sortKey{text, m_collator.sortKey(text)};
+    m_sortKeys.insert(index.row(), sortKey);
+    return sortKey.key;
+}
@@ -20,6 +20,7 @@
 
 #include <QBitArray>
 #include <QCollator>
+#include <QHash>
 #include <QSortFilterProxyModel>
 
 class SortFilterHideProxyModel : public QSortFilterProxyModel
@@ -36,8 +37,19 @@ protected:
     bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
 
 private:
+    QCollatorSortKey sortKey(const QModelIndex& index, const QString& text) const;
+
     QBitArray m_hiddenColumns;
     QCollator m_collator;
+
+    struct SortKey
+    {
+        QString text;
+        QCollatorSortKey key;
+    };
+    // Collation keys of the sorted column by source row, checked against the text they were made of
+    mutable QHash<int, SortKey> m_sortKeys;
+    mutable int m_sortKeyColumn = -1;
 };
 
 #endif // KEEPASSX_SORTFILTERHIDEPROXYMODEL_H
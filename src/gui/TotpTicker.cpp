@@ -0,0 +1,59 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TotpTicker.h"
+
+#include "core/Clock.h"
+
+#include <QMetaMethod>
+
+Q_GLOBAL_STATIC(TotpTicker, s_totpTicker)
+
+TotpTicker::TotpTicker()
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &TotpTicker::emitTick);
+}
+
+TotpTicker* TotpTicker::instance()
+{
+    return s_totpTicker;
+}
+
+void TotpTicker::connectNotify(const QMetaMethod& signal)
+{
+    if (signal == QMetaMethod::fromSignal(&TotpTicker::tick) && !m_timer.isActive()) {
+        scheduleTick();
+    }
+}
+
+void TotpTicker::emitTick()
+{
+    // Displays disconnect once they no longer show a code
+    if (!isSignalConnected(QMetaMethod::fromSignal(&TotpTicker::tick))) {
+        return;
+    }
+    emit tick();
+    scheduleTick();
+}
+
+void TotpTicker::scheduleTick()
+{
+    // A millisecond late, so the current second is the new one when the tick is handled
+    m_timer.start(static_cast<int>(1000 - Clock::currentMilliSecondsSinceEpoch() % 1000) + 1);
+}
@@ -0,0 +1,59 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TOTPTICKER_H
+#define KEEPASSXC_TOTPTICKER_H
+
+#include <QObject>
+#include <QTimer>
+
+/**
+ * Application wide clock for the TOTP displays.
+ *
+ * Ticks at the start of every second, so every display changes its code at
+ * the same moment the period of the code ends. The timer only runs while a
+ * display is connected to tick().
+ */
+class TotpTicker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TotpTicker();
+    static TotpTicker* instance();
+
+signals:
+    void tick();
+
+protected:
+    void connectNotify(const QMetaMethod& signal) override;
+
+private slots:
+    void emitTick();
+
+private:
+    void scheduleTick();
+
+    QTimer m_timer;
+};
+
+static inline TotpTicker* totpTicker()
+{
+    return TotpTicker::instance();
+}
+
+#endif // KEEPASSXC_TOTPTICKER_H
@@ -18,10 +18,13 @@
 
 #include "WelcomeWidget.h"
 #include "ui_WelcomeWidget.h"
+#include <QFileInfo>
 #include <QKeyEvent>
 
 #include "config-keepassx.h"
 #include "core/Config.h"
+#include "format/KeePass2Reader.h"
+#include "gui/DatabaseIcons.h"
 #include "gui/Icons.h"
 
 WelcomeWidget::WelcomeWidget(QWidget* parent)
@@ -86,6 +89,17 @@ void WelcomeWidget::refreshLastDatabases()
     for (const QString& database : lastDatabases) {
         auto itm = new QListWidgetItem;
         itm->setText(database);
+
+        // Only the outer header of the file is read to show its public name and icon
+        QVariantMap publicCustomData;
+        if (QFileInfo::exists(database) && KeePass2Reader().readPublicCustomData(database, publicCustomData)) {
+            itm->setToolTip(publicCustomData.value("KPXC_PUBLIC_NAME").toString());
+            bool ok;
+            int iconIndex = publicCustomData.value("KPXC_PUBLIC_ICON").toInt(&ok);
+            if (ok && iconIndex >= 0 && iconIndex < databaseIcons()->count()) {
+                itm->setIcon(databaseIcons()->icon(iconIndex));
+            }
+        }
         m_ui->recentListWidget->addItem(itm);
     }
 
@@ -19,6 +19,7 @@
 #include "CsvImportWidget.h"
 #include "ui_CsvImportWidget.h"
 
+#include "core/AsyncTask.h"
 #include "core/Clock.h"
 #include "core/Database.h"
 #include "core/Group.h"
@@ -28,6 +29,7 @@
 #include "gui/MessageBox.h"
 #include "gui/csvImport/CsvParserModel.h"
 
+#include <QFile>
 #include <QStringListModel>
 
 namespace
@@ -60,6 +62,16 @@ namespace
         }
         return group;
     }
+
+    // Rows of the file are not filled up to the same number of columns like the ones of the preview
+    QVariant mappedValue(const QMap<int, int>& columnMap, const CsvRow& row, int column)
+    {
+        const auto csvColumn = columnMap.value(column, -1);
+        if (csvColumn < 0) {
+            return {};
+        }
+        return row.value(csvColumn, QString(""));
+    }
 } // namespace
 
 CsvImportWidget::CsvImportWidget(QWidget* parent)
@@ -114,9 +126,8 @@ void CsvImportWidget::skippedChanged(int rows)
 
 CsvImportWidget::~CsvImportWidget() = default;
 
-void CsvImportWidget::configParser()
+void CsvImportWidget::configParser(CsvParser* parser)
 {
-    auto parser = m_parserModel->parser();
     parser->setBackslashSyntax(m_ui->checkBoxBackslash->isChecked());
     parser->setComment(m_ui->comboBoxComment->currentText().at(0));
     parser->setTextQualifier(m_ui->comboBoxTextQualifier->currentText().at(0));
@@ -196,7 +207,7 @@ void CsvImportWidget::load(const QString& filename)
 
 void CsvImportWidget::parse()
 {
-    configParser();
+    configParser(m_parserModel->parser());
     QApplication::setOverrideCursor(Qt::WaitCursor);
     QApplication::processEvents();
     bool good = m_parserModel->parse();
@@ -221,82 +232,104 @@ QSharedPointer<Database> CsvImportWidget::buildDatabase()
         }
     }
 
-    auto db = QSharedPointer<Database>::create();
-    db->rootGroup()->setNotes(tr("Imported from CSV file: %1").arg(m_filename));
+    // The whole file is only parsed now, in the background and one row at a time
+    CsvParser parser;
+    configParser(&parser);
+    const auto columnMap = m_parserModel->columnMapping();
+    const int skippedRows = m_parserModel->skippedRows();
+    const auto filename = m_filename;
+    auto mainThread = thread();
 
-    auto rows = m_parserModel->rowCount() - m_parserModel->skippedRows();
-    for (int r = 0; r < rows; ++r) {
-        auto group = createGroupStructure(db.data(), m_parserModel->data(m_parserModel->index(r, 0)).toString());
-        if (!group) {
-            continue;
-        }
-
-        // Standard entry fields
-        auto entry = new Entry();
-        entry->setUuid(QUuid::createUuid());
-        entry->setGroup(group);
-        entry->setTitle(m_parserModel->data(m_parserModel->index(r, 1)).toString());
-        entry->setUsername(m_parserModel->data(m_parserModel->index(r, 2)).toString());
-        entry->setPassword(m_parserModel->data(m_parserModel->index(r, 3)).toString());
-        entry->setUrl(m_parserModel->data(m_parserModel->index(r, 4)).toString());
-        entry->setNotes(m_parserModel->data(m_parserModel->index(r, 5)).toString());
-
-        // TOTP
-        auto otpString = m_parserModel->data(m_parserModel->index(r, 6));
-        if (otpString.isValid() && !otpString.toString().isEmpty()) {
-            auto totp = Totp::parseSettings(otpString.toString());
-            if (!totp || totp->key.isEmpty()) {
-                // Bare secret, use default TOTP settings
-                totp = Totp::parseSettings({}, otpString.toString());
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    auto db = AsyncTask::runAndWaitForFuture([&parser, columnMap, skippedRows, filename, mainThread] {
+        auto db = QSharedPointer<Database>::create();
+        db->rootGroup()->setNotes(tr("Imported from CSV file: %1").arg(filename));
+
+        QFile csv(filename);
+        int row = 0;
+        parser.parse(&csv, [&](const CsvRow& csvRow) {
+            if (row++ < skippedRows) {
+                return true;
             }
-            entry->setTotp(totp);
-        }
+            auto field = [&](int column) { return mappedValue(columnMap, csvRow, column); };
 
-        // Icon
-        bool ok;
-        int icon = m_parserModel->data(m_parserModel->index(r, 7)).toInt(&ok);
-        if (ok) {
-            entry->setIcon(icon);
-        }
+            auto group = createGroupStructure(db.data(), field(0).toString());
+            if (!group) {
+                return true;
+            }
 
-        // Modified Time
-        TimeInfo timeInfo;
-        if (m_parserModel->data(m_parserModel->index(r, 8)).isValid()) {
-            auto datetime = m_parserModel->data(m_parserModel->index(r, 8)).toString();
-            if (datetime.contains(QRegularExpression("^\\d+$"))) {
-                auto t = datetime.toLongLong();
-                if (t <= INT32_MAX) {
-                    t *= 1000;
+            // Standard entry fields
+            auto entry = new Entry();
+            entry->setUuid(QUuid::createUuid());
+            entry->setGroup(group);
+            entry->setTitle(field(1).toString());
+            entry->setUsername(field(2).toString());
+            entry->setPassword(field(3).toString());
+            entry->setUrl(field(4).toString());
+            entry->setNotes(field(5).toString());
+
+            // TOTP
+            auto otpString = field(6);
+            if (otpString.isValid() && !otpString.toString().isEmpty()) {
+                auto totp = Totp::parseSettings(otpString.toString());
+                if (!totp || totp->key.isEmpty()) {
+                    // Bare secret, use default TOTP settings
+                    totp = Totp::parseSettings({}, otpString.toString());
                 }
-                auto lastModified = Clock::datetimeUtc(t);
-                timeInfo.setLastModificationTime(lastModified);
-                timeInfo.setLastAccessTime(lastModified);
-            } else {
-                auto lastModified = QDateTime::fromString(datetime, Qt::ISODate);
-                if (lastModified.isValid()) {
+                entry->setTotp(totp);
+            }
+
+            // Icon
+            bool ok;
+            int icon = field(7).toInt(&ok);
+            if (ok) {
+                entry->setIcon(icon);
+            }
+
+            // Modified Time
+            TimeInfo timeInfo;
+            if (field(8).isValid()) {
+                auto datetime = field(8).toString();
+                if (datetime.contains(QRegularExpression("^\\d+$"))) {
+                    auto t = datetime.toLongLong();
+                    if (t <= INT32_MAX) {
+                        t *= 1000;
+                    }
+                    auto lastModified = Clock::datetimeUtc(t);
                     timeInfo.setLastModificationTime(lastModified);
                     timeInfo.setLastAccessTime(lastModified);
+                } else {
+                    auto lastModified = QDateTime::fromString(datetime, Qt::ISODate);
+                    if (lastModified.isValid()) {
+                        timeInfo.setLastModificationTime(lastModified);
+                        timeInfo.setLastAccessTime(lastModified);
+                    }
                 }
             }
-        }
-        // Creation Time
-        if (m_parserModel->data(m_parserModel->index(r, 9)).isValid()) {
-            auto datetime = m_parserModel->data(m_parserModel->index(r, 9)).toString();
-            if (datetime.contains(QRegularExpression("^\\d+$"))) {
-                auto t = datetime.toLongLong();
-                if (t <= INT32_MAX) {
-                    t *= 1000;
-                }
-                timeInfo.setCreationTime(Clock::datetimeUtc(t));
-            } else {
-                auto created = QDateTime::fromString(datetime, Qt::ISODate);
-                if (created.isValid()) {
-                    timeInfo.setCreationTime(created);
+            // Creation Time
+            if (field(9).isValid()) {
+                auto datetime = field(9).toString();
+                if (datetime.contains(QRegularExpression("^\\d+$"))) {
+                    auto t = datetime.toLongLong();
+                    if (t <= INT32_MAX) {
+                        t *= 1000;
+                    }
+                    timeInfo.setCreationTime(Clock::datetimeUtc(t));
+                } else {
+                    auto created = QDateTime::fromString(datetime, Qt::ISODate);
+                    if (created.isValid()) {
+                        timeInfo.setCreationTime(created);
+                    }
                 }
             }
-        }
-        entry->setTimeInfo(timeInfo);
-    }
+            entry->setTimeInfo(timeInfo);
+            return true;
+        });
+
+        db->moveWithHistoryToThread(mainThread);
+        return db;
+    });
+    QApplication::restoreOverrideCursor();
 
     return db;
 }
@@ -22,6 +22,7 @@
 #include <QStringListModel>
 #include <QWidget>
 
+class CsvParser;
 class CsvParserModel;
 class Database;
 class Group;
@@ -53,7 +54,7 @@ private slots:
     void updatePreview();
 
 private:
-    void configParser();
+    void configParser(CsvParser* parser);
     void updateTableview();
     QString formatStatusText() const;
 
@@ -28,6 +28,7 @@ CsvParserModel::CsvParserModel(QObject* parent)
     , m_parser(new CsvParser())
     , m_skipped(0)
 {
+    m_parser->setMaxRows(PreviewRows);
 }
 
 CsvParserModel::~CsvParserModel() = default;
@@ -44,9 +45,12 @@ void CsvParserModel::setFilename(const QString& filename)
 
 QString CsvParserModel::getFileInfo()
 {
+    // Only the rows of the preview are parsed
+    const auto rows = m_parser->isTruncated() ? tr("more than %n row(s)", "CSV row count", m_parser->getCsvRows())
+                                              : tr("%n row(s)", "CSV row count", m_parser->getCsvRows());
     return QString("%1, %2, %3")
         .arg(Tools::humanReadableFileSize(m_parser->getFileSize()),
-             tr("%n row(s)", "CSV row count", m_parser->getCsvRows()),
+             rows,
              tr("%n column(s)", "CSV column count", qMax(0, m_parser->getCsvCols() - 1)));
 }
 
@@ -107,7 +111,7 @@ int CsvParserModel::rowCount(const QModelIndex& parent) const
     if (parent.isValid()) {
         return 0;
     }
-    return m_parser->getCsvRows();
+    return m_parser->getCsvTable().size();
 }
 
 int CsvParserModel::columnCount(const QModelIndex& parent) const
@@ -132,6 +136,14 @@ QVariant CsvParserModel::data(const QModelIndex& index, int role) const
     return {};
 }
 
+/**
+ * @return CSV column of every model column, -1 for columns that are not present in the file
+ */
+QMap<int, int> CsvParserModel::columnMapping() const
+{
+    return m_columnMap;
+}
+
 QVariant CsvParserModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (role == Qt::DisplayRole) {
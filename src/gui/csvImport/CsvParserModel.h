@@ -44,11 +44,15 @@ public:
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    QMap<int, int> columnMapping() const;
 
     void setSkippedRows(int skipped);
     int skippedRows() const;
 
 private:
+    // Rows parsed for the preview, the whole file is only parsed on import
+    static const int PreviewRows = 200;
+
     CsvParser* m_parser;
     int m_skipped;
     QString m_filename;
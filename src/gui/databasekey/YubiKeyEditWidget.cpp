@@ -123,7 +123,7 @@ void YubiKeyEditWidget::initComponentEditWidget(QWidget* widget)
     Q_ASSERT(m_compEditWidget);
     m_compUi->comboChallengeResponse->setFocus();
     m_compUi->refreshHardwareKeys->setIcon(icons()->icon("yubikey-refresh", true));
-    connect(m_compUi->refreshHardwareKeys, &QPushButton::clicked, this, &YubiKeyEditWidget::pollYubikey);
+    connect(m_compUi->refreshHardwareKeys, &QPushButton::clicked, this, [this] { pollYubikey(true); });
     pollYubikey();
 }
 
@@ -144,7 +144,7 @@ void YubiKeyEditWidget::initComponent()
            "Challenge-Response</a>.</p>"));
 }
 
-void YubiKeyEditWidget::pollYubikey()
+void YubiKeyEditWidget::pollYubikey(bool rescan)
 {
 #ifdef WITH_XC_YUBIKEY
     if (!m_compEditWidget) {
@@ -158,7 +158,9 @@ void YubiKeyEditWidget::pollYubikey()
     m_compUi->yubikeyProgress->setVisible(true);
     m_compUi->refreshHardwareKeys->setEnabled(false);
 
-    YubiKey::instance()->findValidKeysAsync();
+    YubiKey::instance()->findValidKeysAsync(rescan);
+#else
+    Q_UNUSED(rescan);
 #endif
 }
 
@@ -52,7 +52,7 @@ protected:
 
 private slots:
     void hardwareKeyResponse(bool found);
-    void pollYubikey();
+    void pollYubikey(bool rescan = false);
 
 private:
     const QScopedPointer<Ui::YubiKeyEditWidget> m_compUi;
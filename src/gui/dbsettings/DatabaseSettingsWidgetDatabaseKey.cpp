@@ -27,6 +27,7 @@
 #include "keys/ChallengeResponseKey.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
 #include "quickunlock/QuickUnlockInterface.h"
 
 #include <QLayout>
@@ -230,6 +231,7 @@ bool DatabaseSettingsWidgetDatabaseKey::saveSettings()
     m_db->setKey(newKey, true, false, false);
 
     getQuickUnlock()->reset(m_db->publicUuid());
+    transformedKeyCache()->remove(m_db->publicUuid());
 
     emit editFinished(true);
     if (m_isDirty) {
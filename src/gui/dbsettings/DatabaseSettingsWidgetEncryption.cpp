@@ -61,6 +61,10 @@ DatabaseSettingsWidgetEncryption::DatabaseSettingsWidgetEncryption(QWidget* pare
 
     m_ui->compatibilitySelection->addItem(tr("KDBX 4 (recommended)"), KeePass2::KDF_ARGON2D);
     m_ui->compatibilitySelection->addItem(tr("KDBX 3"), KeePass2::KDF_AES_KDBX3);
+    m_ui->compressionLevelComboBox->addItem(tr("Automatic (recommended)"), Metadata::AutoCompressionLevel);
+    m_ui->compressionLevelComboBox->addItem(tr("Fastest"), 1);
+    m_ui->compressionLevelComboBox->addItem(tr("Balanced"), 6);
+    m_ui->compressionLevelComboBox->addItem(tr("Smallest"), 9);
     m_ui->decryptionTimeSlider->setMinimum(Kdf::MIN_ENCRYPTION_TIME / 100);
     m_ui->decryptionTimeSlider->setMaximum(Kdf::MAX_ENCRYPTION_TIME / 100);
     m_ui->decryptionTimeSlider->setValue(Kdf::DEFAULT_ENCRYPTION_TIME / 100);
@@ -156,6 +160,15 @@ void DatabaseSettingsWidgetEncryption::initialize()
         m_ui->algorithmComboBox->setCurrentIndex(cipherIndex);
     }
 
+    // Set up the payload compression, levels set by other clients are kept
+    int compressionLevel = m_db->metadata()->compressionLevel();
+    int compressionIndex = m_ui->compressionLevelComboBox->findData(compressionLevel);
+    if (compressionIndex < 0) {
+        m_ui->compressionLevelComboBox->addItem(tr("Level %1").arg(compressionLevel), compressionLevel);
+        compressionIndex = m_ui->compressionLevelComboBox->count() - 1;
+    }
+    m_ui->compressionLevelComboBox->setCurrentIndex(compressionIndex);
+
     // Set up KDF algorithms
     loadKdfAlgorithms();
 
@@ -263,6 +276,9 @@ bool DatabaseSettingsWidgetEncryption::saveSettings()
         return false;
     }
 
+    // The compression does not change the key
+    m_db->metadata()->setCompressionLevel(m_ui->compressionLevelComboBox->currentData().toInt());
+
     if (m_initWithAdvanced != isAdvancedMode()) {
         // Switched from basic <-> advanced mode, need to recalculate everything
         m_isDirty = true;
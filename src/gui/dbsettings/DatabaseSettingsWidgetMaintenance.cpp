@@ -18,12 +18,18 @@
 #include "DatabaseSettingsWidgetMaintenance.h"
 #include "ui_DatabaseSettingsWidgetMaintenance.h"
 
+#include "core/AsyncTask.h"
+#include "core/Clock.h"
+#include "core/DatabaseMemoryIndex.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/Tools.h"
 #include "gui/IconModels.h"
 #include "gui/Icons.h"
 #include "gui/MessageBox.h"
 
+#include <QApplication>
+
 DatabaseSettingsWidgetMaintenance::DatabaseSettingsWidgetMaintenance(QWidget* parent)
     : DatabaseSettingsWidget(parent)
     , m_ui(new Ui::DatabaseSettingsWidgetMaintenance())
@@ -36,6 +42,8 @@ DatabaseSettingsWidgetMaintenance::DatabaseSettingsWidgetMaintenance(QWidget* pa
 
     connect(m_ui->deleteButton, SIGNAL(clicked()), SLOT(removeCustomIcon()));
     connect(m_ui->purgeButton, SIGNAL(clicked()), SLOT(purgeUnusedCustomIcons()));
+    connect(m_ui->mergeDuplicatesButton, SIGNAL(clicked()), SLOT(mergeDuplicateCustomIcons()));
+    connect(m_ui->pruneDeletedObjectsButton, SIGNAL(clicked()), SLOT(pruneDeletedObjects()));
     connect(m_ui->customIconsView->selectionModel(),
             SIGNAL(selectionChanged(QItemSelection, QItemSelection)),
             this,
@@ -46,11 +54,24 @@ DatabaseSettingsWidgetMaintenance::~DatabaseSettingsWidgetMaintenance() = defaul
 
 void DatabaseSettingsWidgetMaintenance::populateIcons(QSharedPointer<Database> db)
 {
-    m_customIconModel->setIcons(Icons::customIconsPixmaps(db.data(), IconSize::Default),
-                                db->metadata()->customIconsOrder());
+    m_customIconModel->setIcons(db.data());
     m_ui->deleteButton->setEnabled(false);
 }
 
+void DatabaseSettingsWidgetMaintenance::populateDeletedObjects(QSharedPointer<Database> db)
+{
+    const int count = db->deletedObjects().size();
+    m_ui->deletedObjectsLabel->setText(
+        tr("The database remembers %n deleted entries and groups to synchronize the deletions.", "", count));
+    m_ui->pruneDeletedObjectsButton->setEnabled(count > 0);
+}
+
+void DatabaseSettingsWidgetMaintenance::populateMemoryUsage(QSharedPointer<Database> db)
+{
+    const auto usage = DatabaseMemoryIndex::forDatabase(db.data())->usage();
+    m_ui->memoryUsageLabel->setText(usage.toStringList().join("\n"));
+}
+
 void DatabaseSettingsWidgetMaintenance::initialize()
 {
     auto database = DatabaseSettingsWidget::getDatabase();
@@ -58,6 +79,8 @@ void DatabaseSettingsWidgetMaintenance::initialize()
         return;
     }
     populateIcons(database);
+    populateDeletedObjects(database);
+    populateMemoryUsage(database);
 }
 
 void DatabaseSettingsWidgetMaintenance::selectionChanged()
@@ -85,6 +108,7 @@ void DatabaseSettingsWidgetMaintenance::removeCustomIcon()
     }
 
     populateIcons(database);
+    populateMemoryUsage(database);
 }
 
 void DatabaseSettingsWidgetMaintenance::removeSingleCustomIcon(QSharedPointer<Database> database, QModelIndex index)
@@ -215,7 +239,127 @@ void DatabaseSettingsWidgetMaintenance::purgeUnusedCustomIcons()
     }
 
     populateIcons(database);
+    populateMemoryUsage(database);
 
     MessageBox::information(
         this, tr("Purged Unused Icons"), tr("Purged %n icon(s) from the database.", "", purgeCounter), MessageBox::Ok);
 }
+
+void DatabaseSettingsWidgetMaintenance::mergeDuplicateCustomIcons()
+{
+    auto database = DatabaseSettingsWidget::getDatabase();
+    if (!database) {
+        return;
+    }
+
+    // The icon data is shared with the copies, which are compared on a worker thread
+    QList<QPair<QUuid, QByteArray>> icons;
+    const auto metadata = database->metadata();
+    for (const auto& uuid : metadata->customIconsOrder()) {
+        icons.append({uuid, metadata->customIcon(uuid).data});
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const auto duplicates = AsyncTask::runAndWaitForFuture([icons] { return Metadata::findDuplicateIcons(icons); });
+    QApplication::restoreOverrideCursor();
+
+    if (duplicates.isEmpty()) {
+        MessageBox::information(this,
+                                tr("No Duplicate Icons"),
+                                tr("All custom icons of the database are different."),
+                                MessageBox::Ok);
+        return;
+    }
+
+    qint64 duplicateSize = 0;
+    for (auto it = duplicates.constBegin(); it != duplicates.constEnd(); ++it) {
+        if (metadata->hasCustomIcon(it.key())) {
+            duplicateSize += metadata->customIcon(it.key()).data.size();
+        }
+    }
+
+    auto answer = MessageBox::question(
+        this,
+        tr("Merge Duplicate Icons"),
+        tr("Found %n duplicate icon(s), merging them saves about %1. "
+           "Entries and groups using a duplicate will use the first icon with the same image instead.",
+           "",
+           duplicates.size())
+            .arg(Tools::humanReadableFileSize(duplicateSize)),
+        MessageBox::Merge | MessageBox::Cancel,
+        MessageBox::Merge);
+    if (answer != MessageBox::Merge) {
+        return;
+    }
+
+    // The image does not change, neither do the modification times
+    database->rootGroup()->forEachEntryRecursive(
+        [&duplicates](Entry* entry) {
+            auto original = duplicates.constFind(entry->iconUuid());
+            if (original != duplicates.constEnd()) {
+                entry->setUpdateTimeinfo(false);
+                entry->setIcon(original.value());
+                entry->setUpdateTimeinfo(true);
+            }
+            return true;
+        },
+        true);
+    database->rootGroup()->forEachGroupRecursive([&duplicates](Group* group) {
+        auto original = duplicates.constFind(group->iconUuid());
+        if (original != duplicates.constEnd()) {
+            group->setUpdateTimeinfo(false);
+            group->setIcon(original.value());
+            group->setUpdateTimeinfo(true);
+        }
+        return true;
+    });
+
+    int mergeCounter = 0;
+    for (auto it = duplicates.constBegin(); it != duplicates.constEnd(); ++it) {
+        if (metadata->hasCustomIcon(it.key())) {
+            metadata->removeCustomIcon(it.key());
+            ++mergeCounter;
+        }
+    }
+
+    populateIcons(database);
+    populateMemoryUsage(database);
+
+    MessageBox::information(this,
+                            tr("Merged Duplicate Icons"),
+                            tr("Merged %n duplicate icon(s).", "", mergeCounter),
+                            MessageBox::Ok);
+}
+
+void DatabaseSettingsWidgetMaintenance::pruneDeletedObjects()
+{
+    auto database = DatabaseSettingsWidget::getDatabase();
+    if (!database) {
+        return;
+    }
+
+    const int days = m_ui->deletedObjectsAgeSpinBox->value();
+    auto answer = MessageBox::question(this,
+                                       tr("Remove Old Deletions"),
+                                       tr("Entries and groups deleted more than %n day(s) ago may be restored by "
+                                          "synchronizing with a database that still contains them. "
+                                          "Are you sure you want to remove these deletions?",
+                                          "",
+                                          days),
+                                       MessageBox::Delete | MessageBox::Cancel,
+                                       MessageBox::Cancel);
+    if (answer != MessageBox::Delete) {
+        return;
+    }
+
+    const int removed = database->pruneDeletedObjects(Clock::currentDateTimeUtc().addDays(-days));
+    if (removed > 0) {
+        database->markAsModified();
+    }
+    populateDeletedObjects(database);
+
+    MessageBox::information(this,
+                            tr("Removed Old Deletions"),
+                            tr("Removed %n deletion(s) from the database.", "", removed),
+                            MessageBox::Ok);
+}
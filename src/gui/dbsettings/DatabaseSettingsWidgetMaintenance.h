@@ -49,9 +49,13 @@ private slots:
     void selectionChanged();
     void removeCustomIcon();
     void purgeUnusedCustomIcons();
+    void mergeDuplicateCustomIcons();
+    void pruneDeletedObjects();
 
 private:
     void populateIcons(QSharedPointer<Database> db);
+    void populateDeletedObjects(QSharedPointer<Database> db);
+    void populateMemoryUsage(QSharedPointer<Database> db);
     void removeSingleCustomIcon(QSharedPointer<Database> database, QModelIndex index);
 
 protected:
@@ -58,6 +58,7 @@
 #include "gui/entry/AutoTypeAssociationsModel.h"
 #include "gui/entry/EntryAttributesModel.h"
 #include "gui/entry/EntryHistoryModel.h"
+#include "gui/tag/TagCompletionModel.h"
 
 EditEntryWidget::EditEntryWidget(QWidget* parent)
     : EditWidget(parent)
@@ -147,6 +148,8 @@ void EditEntryWidget::setupMain()
     m_mainUi->usernameComboBox->setEditable(true);
     m_usernameCompleter->setCompletionMode(QCompleter::InlineCompletion);
     m_usernameCompleter->setCaseSensitivity(Qt::CaseSensitive);
+    // All usernames of the database are completed, looked up with a binary search
+    m_usernameCompleter->setModelSorting(QCompleter::CaseSensitivelySortedModel);
     m_usernameCompleter->setModel(m_usernameCompleterModel);
     m_mainUi->usernameComboBox->setCompleter(m_usernameCompleter);
 
@@ -908,7 +911,7 @@ void EditEntryWidget::setForms(Entry* entry, bool restore)
     m_mainUi->urlEdit->setReadOnly(m_history);
     m_mainUi->passwordEdit->setReadOnly(m_history);
     m_mainUi->tagsList->tags(entry->tagList());
-    m_mainUi->tagsList->completion(m_db->tagList());
+    m_mainUi->tagsList->completionModel(TagCompletionModel::forDatabase(m_db.data()));
     m_mainUi->expireCheck->setEnabled(!m_history);
     m_mainUi->expireDatePicker->setReadOnly(m_history);
     m_mainUi->revealNotesButton->setIcon(icons()->onOffIcon("password-show", false));
@@ -956,7 +959,7 @@ void EditEntryWidget::setForms(Entry* entry, bool restore)
     m_mainUi->expirePresets->setEnabled(!m_history);
 
     QList<QString> commonUsernames = m_db->commonUsernames();
-    m_usernameCompleterModel->setStringList(commonUsernames);
+    m_usernameCompleterModel->setStringList(m_db->usernameList());
     QString usernameToRestore = m_mainUi->usernameComboBox->lineEdit()->text();
     m_mainUi->usernameComboBox->clear();
     m_mainUi->usernameComboBox->addItems(commonUsernames);
@@ -1093,9 +1096,38 @@ void EditEntryWidget::setForms(Entry* entry, bool restore)
 
     updateHistoryButtons(m_historyUi->historyView->currentIndex(), QModelIndex());
 
+    // A restored history item differs from the entry in every part
+    m_loadedRevisions.clear();
+    if (!restore) {
+        rememberLoadedRevisions();
+    }
+
     m_mainUi->titleEdit->setFocus();
 }
 
+/**
+ * Remember the modification counts of the edited copies while they match the entry.
+ */
+void EditEntryWidget::rememberLoadedRevisions()
+{
+    for (const ModifiableObject* object : {static_cast<const ModifiableObject*>(m_entryAttributes),
+                                           static_cast<const ModifiableObject*>(m_attachments.data()),
+                                           static_cast<const ModifiableObject*>(m_customData.data()),
+                                           static_cast<const ModifiableObject*>(m_autoTypeAssoc)}) {
+        m_loadedRevisions.insert(object, object->modificationCount());
+    }
+}
+
+/**
+ * @param object edited copy of a part of the entry
+ * @return true if the copy was modified since it was loaded from the entry
+ */
+bool EditEntryWidget::isEdited(const ModifiableObject* object) const
+{
+    auto revision = m_loadedRevisions.constFind(object);
+    return revision == m_loadedRevisions.constEnd() || revision.value() != object->modificationCount();
+}
+
 /**
  * Commit the form values to in-memory database representation
  *
@@ -1191,6 +1223,7 @@ bool EditEntryWidget::commitEntry()
     m_historyModel->setEntries(m_entry->historyItems(), m_entry);
     setPageHidden(m_historyWidget, m_history || m_entry->historyItems().count() < 1);
     m_advancedUi->attachmentsWidget->linkAttachments(m_entry->attachments());
+    rememberLoadedRevisions();
 
     showMessage(tr("Entry updated successfully."), MessageWidget::Positive);
     setModified(false);
@@ -1212,9 +1245,16 @@ void EditEntryWidget::updateEntryData(Entry* entry) const
 {
     QRegularExpression newLineRegex("(?:\r?\n|\r)");
 
-    entry->attributes()->copyCustomKeysFrom(m_entryAttributes);
-    entry->attachments()->copyDataFrom(m_attachments.data());
-    entry->customData()->copyDataFrom(m_customData.data());
+    // Parts that were not edited are left alone, so the entry and its new history item keep sharing their data
+    if (isEdited(m_entryAttributes)) {
+        entry->attributes()->copyCustomKeysFrom(m_entryAttributes);
+    }
+    if (isEdited(m_attachments.data())) {
+        entry->attachments()->copyDataFrom(m_attachments.data());
+    }
+    if (isEdited(m_customData.data())) {
+        entry->customData()->copyDataFrom(m_customData.data());
+    }
     entry->setTitle(m_mainUi->titleEdit->text().replace(newLineRegex, " "));
     entry->setUsername(m_mainUi->usernameComboBox->lineEdit()->text().replace(newLineRegex, " "));
     entry->setUrl(m_mainUi->urlEdit->text().replace(newLineRegex, " "));
@@ -1261,7 +1301,9 @@ void EditEntryWidget::updateEntryData(Entry* entry) const
         entry->setDefaultAutoTypeSequence(m_autoTypeUi->sequenceEdit->text());
     }
 
-    entry->autoTypeAssociations()->copyDataFrom(m_autoTypeAssoc);
+    if (isEdited(m_autoTypeAssoc)) {
+        entry->autoTypeAssociations()->copyDataFrom(m_autoTypeAssoc);
+    }
 
 #ifdef WITH_XC_SSHAGENT
     if (sshAgent()->isEnabled()) {
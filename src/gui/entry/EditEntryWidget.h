@@ -22,6 +22,7 @@
 #include <QButtonGroup>
 #include <QCheckBox>
 #include <QCompleter>
+#include <QHash>
 #include <QPointer>
 #include <QTimer>
 
@@ -39,6 +40,7 @@ class EntryAttributes;
 class EntryAttachments;
 class EntryAttributesModel;
 class EntryHistoryModel;
+class ModifiableObject;
 class QButtonGroup;
 class QMenu;
 class QScrollArea;
@@ -155,6 +157,8 @@ private:
     void setForms(Entry* entry, bool restore = false);
     QMenu* createPresetsMenu();
     void updateEntryData(Entry* entry) const;
+    void rememberLoadedRevisions();
+    bool isEdited(const ModifiableObject* object) const;
     void updateBrowserIntegrationCheckbox(QCheckBox* checkBox, bool enabled, bool value, const QString& option);
 #ifdef WITH_XC_SSHAGENT
     bool getOpenSSHKey(OpenSSHKey& key, bool decrypt = false);
@@ -206,6 +210,7 @@ private:
     QCompleter* const m_usernameCompleter;
     QStringListModel* const m_usernameCompleterModel;
     QTimer m_entryModifiedTimer;
+    QHash<const ModifiableObject*, quint64> m_loadedRevisions;
 
     Q_DISABLE_COPY(EditEntryWidget)
 };
@@ -27,7 +27,6 @@
 #include "EntryAttachmentsModel.h"
 #include "core/Config.h"
 #include "core/EntryAttachments.h"
-#include "core/Tools.h"
 #include "gui/FileDialog.h"
 #include "gui/MessageBox.h"
 
@@ -248,9 +247,8 @@ void EntryAttachmentsWidget::saveSelectedAttachments()
         }
 
         QFile file(attachmentPath);
-        const QByteArray attachmentData = m_entryAttachments->value(filename);
         const bool saveOk = file.open(QIODevice::WriteOnly) && file.setPermissions(QFile::ReadUser | QFile::WriteUser)
-                            && file.write(attachmentData) == attachmentData.size();
+                            && m_entryAttachments->writeTo(filename, &file);
         if (!saveOk) {
             errors.append(QString("%1 - %2").arg(filename, file.errorString()));
         }
@@ -323,13 +321,10 @@ bool EntryAttachmentsWidget::insertAttachments(const QStringList& filenames, QSt
 
     QStringList errors;
     for (const QString& filename : filenames) {
-        QByteArray data;
         QFile file(filename);
         const QFileInfo fInfo(filename);
-        const bool readOk = file.open(QIODevice::ReadOnly) && Tools::readAllFromDevice(&file, data);
-        if (readOk) {
-            m_entryAttachments->set(fInfo.fileName(), data);
-        } else {
+        const bool readOk = file.open(QIODevice::ReadOnly) && m_entryAttachments->readFrom(fInfo.fileName(), &file);
+        if (!readOk) {
             errors.append(QString("%1 - %2").arg(fInfo.fileName(), file.errorString()));
         }
     }
@@ -439,8 +434,7 @@ void EntryAttachmentsWidget::attachmentModifiedExternally(const QString& key, co
 
     if (result == MessageBox::Save) {
         QFile f(filePath);
-        if (f.open(QFile::ReadOnly)) {
-            m_entryAttachments->set(key, f.readAll());
+        if (f.open(QFile::ReadOnly) && m_entryAttachments->readFrom(key, &f)) {
             f.close();
             emit widgetUpdated();
         } else {
@@ -24,15 +24,22 @@
 
 #include <QFont>
 
+namespace
+{
+    constexpr int FetchBatchSize = 64;
+} // namespace
+
 EntryHistoryModel::EntryHistoryModel(QObject* parent)
     : QAbstractTableModel(parent)
     , m_systemLocale(QLocale::system())
+    , m_fetchedRows(0)
+    , m_parentEntry(nullptr)
 {
 }
 
 Entry* EntryHistoryModel::entryFromIndex(const QModelIndex& index) const
 {
-    if (!index.isValid() || index.row() >= m_historyEntries.size()) {
+    if (!index.isValid() || index.row() >= m_fetchedRows) {
         return nullptr;
     }
     auto entry = m_historyEntries.at(index.row());
@@ -48,7 +55,7 @@ int EntryHistoryModel::columnCount(const QModelIndex& parent) const
 int EntryHistoryModel::rowCount(const QModelIndex& parent) const
 {
     if (!parent.isValid()) {
-        return m_historyEntries.count();
+        return m_fetchedRows;
     } else {
         return 0;
     }
@@ -56,7 +63,7 @@ int EntryHistoryModel::rowCount(const QModelIndex& parent) const
 
 QVariant EntryHistoryModel::data(const QModelIndex& index, int role) const
 {
-    if (index.row() >= m_historyEntries.size()) {
+    if (index.row() >= m_fetchedRows) {
         return {};
     }
     const auto entry = m_historyEntries[index.row()];
@@ -83,10 +90,7 @@ QVariant EntryHistoryModel::data(const QModelIndex& index, int role) const
             return seconds;
         }
         case 2:
-            if (index.row() < m_historyModifications.size()) {
-                return m_historyModifications[index.row()];
-            }
-            return {};
+            return historyModifications(index.row());
         case 3:
             if (role == Qt::DisplayRole) {
                 return Tools::humanReadableFileSize(entry->size(), 0);
@@ -120,6 +124,23 @@ QVariant EntryHistoryModel::headerData(int section, Qt::Orientation orientation,
     return {};
 }
 
+bool EntryHistoryModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && m_fetchedRows < m_historyEntries.size();
+}
+
+void EntryHistoryModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    const int rows = qMin(FetchBatchSize, m_historyEntries.size() - m_fetchedRows);
+    beginInsertRows(QModelIndex(), m_fetchedRows, m_fetchedRows + rows - 1);
+    m_fetchedRows += rows;
+    endInsertRows();
+}
+
 void EntryHistoryModel::setEntries(const QList<Entry*>& entries, Entry* parentEntry)
 {
     beginResetModel();
@@ -131,7 +152,8 @@ void EntryHistoryModel::setEntries(const QList<Entry*>& entries, Entry* parentEn
         return lhs->timeInfo().lastModificationTime() > rhs->timeInfo().lastModificationTime();
     });
     m_deletedHistoryEntries.clear();
-    calculateHistoryModifications();
+    m_historyModifications.clear();
+    m_fetchedRows = qMin(FetchBatchSize, m_historyEntries.size());
     endResetModel();
 }
 
@@ -141,6 +163,8 @@ void EntryHistoryModel::clear()
 
     m_historyEntries.clear();
     m_deletedHistoryEntries.clear();
+    m_historyModifications.clear();
+    m_fetchedRows = 0;
 
     endResetModel();
 }
@@ -159,11 +183,19 @@ void EntryHistoryModel::deleteIndex(QModelIndex index)
 {
     auto entry = entryFromIndex(index);
     if (entry) {
-        beginRemoveRows(QModelIndex(), index.row(), index.row());
-        m_historyEntries.removeAt(index.row());
+        const int row = index.row();
+        beginRemoveRows(QModelIndex(), row, row);
+        m_historyEntries.removeAt(row);
         m_deletedHistoryEntries << entry;
-        calculateHistoryModifications();
+        m_historyModifications.remove(entry);
+        --m_fetchedRows;
         endRemoveRows();
+
+        // The newer row is now compared with the next older one
+        if (row > 0) {
+            m_historyModifications.remove(m_historyEntries.at(row - 1));
+            emit dataChanged(this->index(row - 1, 2), this->index(row - 1, 2));
+        }
     }
 }
 
@@ -171,7 +203,7 @@ void EntryHistoryModel::deleteAll()
 {
     Q_ASSERT(m_historyEntries.count() > 0);
 
-    beginRemoveRows(QModelIndex(), 0, m_historyEntries.size() - 1);
+    beginRemoveRows(QModelIndex(), 0, m_fetchedRows - 1);
 
     for (Entry* entry : asConst(m_historyEntries)) {
         if (entry != m_parentEntry) {
@@ -179,81 +211,86 @@ void EntryHistoryModel::deleteAll()
         }
     }
     m_historyEntries.clear();
+    m_historyModifications.clear();
+    m_fetchedRows = 0;
     endRemoveRows();
 }
 
-void EntryHistoryModel::calculateHistoryModifications()
+/**
+ * @param row row of a history item, rows are sorted from newest to oldest
+ * @return fields changed between the item and the next older one, cached per item
+ */
+QString EntryHistoryModel::historyModifications(int row) const
 {
-    m_historyModifications.clear();
-
-    Entry* compare = nullptr;
-    for (const auto curr : m_historyEntries) {
-        if (!compare) {
-            compare = curr;
-            continue;
-        }
+    if (row + 1 >= m_historyEntries.size()) {
+        return {};
+    }
 
-        QStringList modifiedFields;
+    const Entry* compare = m_historyEntries.at(row);
+    auto cached = m_historyModifications.constFind(compare);
+    if (cached != m_historyModifications.constEnd()) {
+        return cached.value();
+    }
 
-        if (*curr->attributes() != *compare->attributes()) {
-            bool foundAttribute = false;
+    const Entry* curr = m_historyEntries.at(row + 1);
+    QStringList modifiedFields;
 
-            if (curr->title() != compare->title()) {
-                modifiedFields << tr("Title");
-                foundAttribute = true;
-            }
-            if (curr->username() != compare->username()) {
-                modifiedFields << tr("Username");
-                foundAttribute = true;
-            }
-            if (curr->password() != compare->password()) {
-                modifiedFields << tr("Password");
-                foundAttribute = true;
-            }
-            if (curr->url() != compare->url()) {
-                modifiedFields << tr("URL");
-                foundAttribute = true;
-            }
-            if (curr->notes() != compare->notes()) {
-                modifiedFields << tr("Notes");
-                foundAttribute = true;
-            }
+    if (*curr->attributes() != *compare->attributes()) {
+        bool foundAttribute = false;
 
-            if (!foundAttribute) {
-                modifiedFields << tr("Custom Attributes");
-            }
-        }
-        if (curr->iconNumber() != compare->iconNumber() || curr->iconUuid() != compare->iconUuid()) {
-            modifiedFields << tr("Icon");
-        }
-        if (curr->foregroundColor() != compare->foregroundColor()
-            || curr->backgroundColor() != compare->backgroundColor()) {
-            modifiedFields << tr("Color");
-        }
-        if (curr->timeInfo().expires() != compare->timeInfo().expires()
-            || curr->timeInfo().expiryTime() != compare->timeInfo().expiryTime()) {
-            modifiedFields << tr("Expiration");
-        }
-        if (curr->totp() != compare->totp()) {
-            modifiedFields << tr("TOTP");
+        if (curr->title() != compare->title()) {
+            modifiedFields << tr("Title");
+            foundAttribute = true;
         }
-        if (*curr->customData() != *compare->customData()) {
-            modifiedFields << tr("Custom Data");
+        if (curr->username() != compare->username()) {
+            modifiedFields << tr("Username");
+            foundAttribute = true;
         }
-        if (*curr->attachments() != *compare->attachments()) {
-            modifiedFields << tr("Attachments");
+        if (curr->password() != compare->password()) {
+            modifiedFields << tr("Password");
+            foundAttribute = true;
         }
-        if (*curr->autoTypeAssociations() != *compare->autoTypeAssociations()
-            || curr->autoTypeEnabled() != compare->autoTypeEnabled()
-            || curr->defaultAutoTypeSequence() != compare->defaultAutoTypeSequence()) {
-            modifiedFields << tr("Auto-Type");
+        if (curr->url() != compare->url()) {
+            modifiedFields << tr("URL");
+            foundAttribute = true;
         }
-        if (curr->tags() != compare->tags()) {
-            modifiedFields << tr("Tags");
+        if (curr->notes() != compare->notes()) {
+            modifiedFields << tr("Notes");
+            foundAttribute = true;
         }
 
-        m_historyModifications << modifiedFields.join(", ");
-
-        compare = curr;
+        if (!foundAttribute) {
+            modifiedFields << tr("Custom Attributes");
+        }
+    }
+    if (curr->iconNumber() != compare->iconNumber() || curr->iconUuid() != compare->iconUuid()) {
+        modifiedFields << tr("Icon");
+    }
+    if (curr->foregroundColor() != compare->foregroundColor()
+        || curr->backgroundColor() != compare->backgroundColor()) {
+        modifiedFields << tr("Color");
+    }
+    if (curr->timeInfo().expires() != compare->timeInfo().expires()
+        || curr->timeInfo().expiryTime() != compare->timeInfo().expiryTime()) {
+        modifiedFields << tr("Expiration");
+    }
+    if (curr->totp() != compare->totp()) {
+        modifiedFields << tr("TOTP");
     }
+    if (*curr->customData() != *compare->customData()) {
+        modifiedFields << tr("Custom Data");
+    }
+    if (*curr->attachments() != *compare->attachments()) {
+        modifiedFields << tr("Attachments");
+    }
+    if (*curr->autoTypeAssociations() != *compare->autoTypeAssociations()
+        || curr->autoTypeEnabled() != compare->autoTypeEnabled()
+        || curr->defaultAutoTypeSequence() != compare->defaultAutoTypeSequence()) {
+        modifiedFields << tr("Auto-Type");
+    }
+    if (curr->tags() != compare->tags()) {
+        modifiedFields << tr("Tags");
+    }
+
+    return m_historyModifications.insert(compare, modifiedFields.join(", ")).value();
 }
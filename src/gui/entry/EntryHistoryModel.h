@@ -19,6 +19,7 @@
 #define KEEPASSX_ENTRYHISTORYMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QLocale>
 
 class Entry;
@@ -35,6 +36,8 @@ public:
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
 
     void setEntries(const QList<Entry*>& entries, Entry* parentEntry);
     void clear();
@@ -44,12 +47,14 @@ public:
     void deleteAll();
 
 private:
-    void calculateHistoryModifications();
+    QString historyModifications(int row) const;
 
     QLocale m_systemLocale;
     QList<Entry*> m_historyEntries;
     QList<Entry*> m_deletedHistoryEntries;
-    QStringList m_historyModifications;
+    // Rows are shown in batches, the differences are computed when a row is first displayed
+    int m_fetchedRows;
+    mutable QHash<const Entry*, QString> m_historyModifications;
     const Entry* m_parentEntry;
 };
 
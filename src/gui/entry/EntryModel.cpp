@@ -17,7 +17,10 @@
 
 #include "EntryModel.h"
 
+#include <algorithm>
+
 #include <QFont>
+#include <QHash>
 #include <QMimeData>
 #include <QPalette>
 
@@ -62,30 +65,28 @@ void EntryModel::setGroup(Group* group)
         return;
     }
 
-    beginResetModel();
-
+    endBulkReset();
     severConnections();
 
     m_group = group;
     m_allGroups.clear();
-    m_entries = group->entries();
     m_orgEntries.clear();
+    setDatabase(group->database());
+    updateEntries(group->entries());
 
     makeConnections(group);
-
-    endResetModel();
 }
 
 void EntryModel::setEntries(const QList<Entry*>& entries)
 {
-    beginResetModel();
-
+    endBulkReset();
     severConnections();
 
     m_group = nullptr;
     m_allGroups.clear();
-    m_entries = entries;
     m_orgEntries = entries;
+    setDatabase(entries.isEmpty() ? nullptr : entries.first()->database());
+    updateEntries(entries);
 
     for (const auto entry : asConst(m_entries)) {
         if (entry->group()) {
@@ -96,8 +97,113 @@ void EntryModel::setEntries(const QList<Entry*>& entries)
     for (const auto group : m_allGroups) {
         makeConnections(group);
     }
+}
 
-    endResetModel();
+/**
+ * Add entries to the end of a list set with setEntries().
+ *
+ * @param entries entries to add, not shown yet
+ */
+void EntryModel::appendEntries(const QList<Entry*>& entries)
+{
+    if (m_group || entries.isEmpty()) {
+        return;
+    }
+
+    endBulkReset();
+    if (!m_db) {
+        setDatabase(entries.first()->database());
+    }
+
+    beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size() + entries.size() - 1);
+    m_entries.append(entries);
+    m_orgEntries.append(entries);
+    endInsertRows();
+
+    for (const auto entry : entries) {
+        if (entry->group() && !m_allGroups.contains(entry->group())) {
+            m_allGroups.insert(entry->group());
+            makeConnections(entry->group());
+        }
+    }
+}
+
+/**
+ * Replace the displayed entries with as few changes to the rows as possible.
+ *
+ * Rows of entries that are no longer shown are removed and rows of new
+ * entries are inserted in contiguous runs, rows of entries shown before and
+ * after keep their selection and cached view state. A different order of the
+ * remaining entries is applied as a layout change.
+ *
+ * @param entries entries to show, in display order
+ */
+void EntryModel::updateEntries(const QList<Entry*>& entries)
+{
+    QHash<const Entry*, int> newRows;
+    newRows.reserve(entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        newRows.insert(entries.at(i), i);
+    }
+
+    // Remove runs of rows from the end, so the row numbers of the runs before stay valid
+    for (int end = m_entries.size() - 1; end >= 0;) {
+        if (newRows.contains(m_entries.at(end))) {
+            --end;
+            continue;
+        }
+        int start = end;
+        while (start > 0 && !newRows.contains(m_entries.at(start - 1))) {
+            --start;
+        }
+        beginRemoveRows(QModelIndex(), start, end);
+        for (int i = start; i <= end; ++i) {
+            m_rowCache.remove(m_entries.at(i));
+        }
+        m_entries.erase(m_entries.begin() + start, m_entries.begin() + end + 1);
+        endRemoveRows();
+        end = start - 1;
+    }
+
+    // Sort the remaining rows into their relative order in the new list
+    QList<Entry*> remaining = m_entries;
+    std::stable_sort(remaining.begin(), remaining.end(), [&newRows](const Entry* lhs, const Entry* rhs) {
+        return newRows.value(lhs) < newRows.value(rhs);
+    });
+    if (remaining != m_entries) {
+        emit layoutAboutToBeChanged();
+        QHash<const Entry*, int> remainingRows;
+        for (int i = 0; i < remaining.size(); ++i) {
+            remainingRows.insert(remaining.at(i), i);
+        }
+        const auto oldIndexes = persistentIndexList();
+        QModelIndexList newIndexes;
+        for (const auto& oldIndex : oldIndexes) {
+            newIndexes.append(index(remainingRows.value(m_entries.at(oldIndex.row())), oldIndex.column()));
+        }
+        m_entries = remaining;
+        changePersistentIndexList(oldIndexes, newIndexes);
+        emit layoutChanged();
+    }
+
+    // Insert runs of new entries in front of the next remaining row
+    for (int row = 0; row < entries.size();) {
+        const Entry* next = row < m_entries.size() ? m_entries.at(row) : nullptr;
+        if (entries.at(row) == next) {
+            ++row;
+            continue;
+        }
+        int end = row;
+        while (end + 1 < entries.size() && entries.at(end + 1) != next) {
+            ++end;
+        }
+        beginInsertRows(QModelIndex(), row, end);
+        for (int i = row; i <= end; ++i) {
+            m_entries.insert(i, entries.at(i));
+        }
+        endInsertRows();
+        row = end + 1;
+    }
 }
 
 int EntryModel::rowCount(const QModelIndex& parent) const
@@ -116,7 +222,7 @@ int EntryModel::columnCount(const QModelIndex& parent) const
         return 0;
     }
 
-    return 16;
+    return ColumnCount;
 }
 
 QVariant EntryModel::data(const QModelIndex& index, int role) const
@@ -125,6 +231,35 @@ QVariant EntryModel::data(const QModelIndex& index, int role) const
         return {};
     }
 
+    // Display texts and sort values are painted and compared many times, but only change with the entry
+    if ((role == Qt::DisplayRole || role == Qt::UserRole) && isCached(entryFromIndex(index), index.column())) {
+        const Entry* entry = entryFromIndex(index);
+        const int key = role == Qt::DisplayRole ? index.column() : index.column() + ColumnCount;
+        const auto modificationCount = entry->dataModificationCount();
+        auto row = m_rowCache.find(entry);
+        if (row != m_rowCache.end() && row->modificationCount == modificationCount) {
+            auto value = row->values.constFind(key);
+            if (value != row->values.constEnd()) {
+                return value.value();
+            }
+        }
+
+        const auto value = entryData(index, role);
+        // Computing the sort value may have cached the display text of the same row
+        auto& cached = m_rowCache[entry];
+        if (cached.modificationCount != modificationCount) {
+            cached.values.clear();
+            cached.modificationCount = modificationCount;
+        }
+        cached.values.insert(key, value);
+        return value;
+    }
+
+    return entryData(index, role);
+}
+
+QVariant EntryModel::entryData(const QModelIndex& index, int role) const
+{
     Entry* entry = entryFromIndex(index);
     EntryAttributes* attr = entry->attributes();
 
@@ -517,6 +652,13 @@ void EntryModel::entryAboutToAdd(Entry* entry)
         return;
     }
 
+    if (resetInBulkUpdate()) {
+        if (!m_group) {
+            m_entries.append(entry);
+        }
+        return;
+    }
+
     beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size());
     if (!m_group) {
         m_entries.append(entry);
@@ -529,6 +671,10 @@ void EntryModel::entryAdded(Entry* entry)
         return;
     }
 
+    if (m_bulkReset) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -537,6 +683,14 @@ void EntryModel::entryAdded(Entry* entry)
 
 void EntryModel::entryAboutToRemove(Entry* entry)
 {
+    m_rowCache.remove(entry);
+    if (resetInBulkUpdate()) {
+        if (!m_group) {
+            m_entries.removeAll(entry);
+        }
+        return;
+    }
+
     beginRemoveRows(QModelIndex(), m_entries.indexOf(entry), m_entries.indexOf(entry));
     if (!m_group) {
         m_entries.removeAll(entry);
@@ -545,6 +699,10 @@ void EntryModel::entryAboutToRemove(Entry* entry)
 
 void EntryModel::entryRemoved()
 {
+    if (m_bulkReset) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -553,6 +711,10 @@ void EntryModel::entryRemoved()
 
 void EntryModel::entryAboutToMoveUp(int row)
 {
+    if (resetInBulkUpdate()) {
+        return;
+    }
+
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), row - 1);
     if (m_group) {
         m_entries.move(row, row - 1);
@@ -561,6 +723,10 @@ void EntryModel::entryAboutToMoveUp(int row)
 
 void EntryModel::entryMovedUp()
 {
+    if (m_bulkReset) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -569,6 +735,10 @@ void EntryModel::entryMovedUp()
 
 void EntryModel::entryAboutToMoveDown(int row)
 {
+    if (resetInBulkUpdate()) {
+        return;
+    }
+
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), row + 2);
     if (m_group) {
         m_entries.move(row, row + 1);
@@ -577,6 +747,10 @@ void EntryModel::entryAboutToMoveDown(int row)
 
 void EntryModel::entryMovedDown()
 {
+    if (m_bulkReset) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -585,12 +759,74 @@ void EntryModel::entryMovedDown()
 
 void EntryModel::entryDataChanged(Entry* entry)
 {
+    m_rowCache.remove(entry);
+    if (resetInBulkUpdate()) {
+        return;
+    }
+
     int row = m_entries.indexOf(entry);
     emit dataChanged(index(row, 0), index(row, columnCount() - 1));
 }
 
+void EntryModel::setDatabase(Database* db)
+{
+    if (m_db == db) {
+        return;
+    }
+    if (m_db) {
+        disconnect(m_db, &Database::bulkUpdateFinished, this, &EntryModel::endBulkReset);
+    }
+    m_db = db;
+    if (m_db) {
+        connect(m_db, &Database::bulkUpdateFinished, this, &EntryModel::endBulkReset);
+    }
+}
+
+/**
+ * Start resetting the rows on the first change during a bulk update of the database.
+ *
+ * @return true if the change is part of a reset and must not be announced by itself
+ */
+bool EntryModel::resetInBulkUpdate()
+{
+    if (!m_bulkReset && m_db && m_db->isBulkUpdating()) {
+        beginResetModel();
+        m_bulkReset = true;
+    }
+    return m_bulkReset;
+}
+
+void EntryModel::endBulkReset()
+{
+    if (!m_bulkReset) {
+        return;
+    }
+
+    if (m_group) {
+        m_entries = m_group->entries();
+    } else if (m_orgEntries.isEmpty()) {
+        // The shown group was deleted
+        m_entries.clear();
+    }
+    // Addresses of deleted entries may have been reused meanwhile
+    m_rowCache.clear();
+    m_bulkReset = false;
+    endResetModel();
+}
+
+/**
+ * Drop the cached display texts, they are computed again when the rows are painted.
+ */
+void EntryModel::releaseCaches()
+{
+    m_rowCache.clear();
+}
+
 void EntryModel::onConfigChanged(Config::ConfigKey key)
 {
+    // Hidden and placeholder texts depend on several settings
+    m_rowCache.clear();
+
     switch (key) {
     case Config::GUI_HideUsernames:
         emit dataChanged(index(0, Username), index(rowCount() - 1, Username), {Qt::DisplayRole});
@@ -603,6 +839,29 @@ void EntryModel::onConfigChanged(Config::ConfigKey key)
     }
 }
 
+/**
+ * @return whether the display text and sort value of a cell only depend on the entry data
+ */
+bool EntryModel::isCached(const Entry* entry, int column)
+{
+    switch (column) {
+    case ParentGroup:
+        // Group names are not watched by the model
+        return false;
+    // Placeholders may refer to other entries or the current time
+    case Title:
+        return !entry->title().contains('{');
+    case Username:
+        return !entry->username().contains('{');
+    case Password:
+        return !entry->password().contains('{');
+    case Url:
+        return !entry->url().contains('{');
+    default:
+        return true;
+    }
+}
+
 void EntryModel::severConnections()
 {
     if (m_group) {
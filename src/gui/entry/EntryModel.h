@@ -19,11 +19,14 @@
 #define KEEPASSX_ENTRYMODEL_H
 
 #include <QAbstractTableModel>
+#include <QHash>
 #include <QPixmap>
+#include <QPointer>
 #include <QSet>
 
 #include "core/Config.h"
 
+class Database;
 class Entry;
 class Group;
 
@@ -49,7 +52,8 @@ public:
         Totp = 12,
         Size = 13,
         PasswordStrength = 14,
-        Color = 15
+        Color = 15,
+        ColumnCount = 16
     };
 
     explicit EntryModel(QObject* parent = nullptr);
@@ -68,7 +72,9 @@ public:
 
     void setGroup(Group* group);
     void setEntries(const QList<Entry*>& entries);
+    void appendEntries(const QList<Entry*>& entries);
     void setBackgroundColorVisible(bool visible);
+    void releaseCaches();
 
 private slots:
     void entryAboutToAdd(Entry* entry);
@@ -80,18 +86,35 @@ private slots:
     void entryAboutToMoveDown(int row);
     void entryMovedDown();
     void entryDataChanged(Entry* entry);
+    void endBulkReset();
 
     void onConfigChanged(Config::ConfigKey key);
 
 private:
+    struct CachedRow
+    {
+        quint64 modificationCount = 0;
+        // Display texts keyed by column, sort values by column + ColumnCount
+        QHash<int, QVariant> values;
+    };
+
+    QVariant entryData(const QModelIndex& index, int role) const;
+    static bool isCached(const Entry* entry, int column);
+    void updateEntries(const QList<Entry*>& entries);
+    void setDatabase(Database* db);
+    bool resetInBulkUpdate();
     void severConnections();
     void makeConnections(const Group* group);
 
     bool m_backgroundColorVisible = true;
-    Group* m_group;
+    QPointer<Group> m_group;
     QList<Entry*> m_entries;
     QList<Entry*> m_orgEntries;
     QSet<const Group*> m_allGroups;
+    QPointer<Database> m_db;
+    // Rows are reset at the end of a bulk update of the database instead of changed one by one
+    bool m_bulkReset = false;
+    mutable QHash<const Entry*, CachedRow> m_rowCache;
 
     const QString HiddenContentDisplay;
 };
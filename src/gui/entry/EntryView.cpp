@@ -21,6 +21,7 @@
 #include <QAccessible>
 #include <QDrag>
 #include <QGuiApplication>
+#include <QHash>
 #include <QHeaderView>
 #include <QListWidget>
 #include <QMenu>
@@ -52,14 +53,25 @@ public:
                 pen = option->widget->palette().color(QPalette::Shadow);
             }
             auto size = option->decorationSize;
-            QImage image(size.width(), size.height(), QImage::Format_ARGB32_Premultiplied);
-            QPainter p(&image);
-            p.setBrush(value.value<QColor>());
-            p.setPen(pen);
-            p.drawRect(0, 0, size.width() - 1, size.height() - 1);
-            option->icon = QIcon(QPixmap::fromImage(image));
+            // Only a handful of distinct icons exist, do not paint them again for every row
+            const auto key = qMakePair(qMakePair(value.value<QColor>().rgba(), pen.rgba()),
+                                       qMakePair(size.width(), size.height()));
+            auto icon = m_icons.constFind(key);
+            if (icon == m_icons.constEnd()) {
+                QImage image(size.width(), size.height(), QImage::Format_ARGB32_Premultiplied);
+                QPainter p(&image);
+                p.setBrush(value.value<QColor>());
+                p.setPen(pen);
+                p.drawRect(0, 0, size.width() - 1, size.height() - 1);
+                icon = m_icons.insert(key, QIcon(QPixmap::fromImage(image)));
+            }
+            option->icon = icon.value();
         }
     }
+
+private:
+    typedef QPair<QPair<QRgb, QRgb>, QPair<int, int>> IconKey;
+    mutable QHash<IconKey, QIcon> m_icons;
 };
 
 EntryView::EntryView(QWidget* parent)
@@ -123,6 +135,8 @@ EntryView::EntryView(QWidget* parent)
     m_headerMenu->addAction(tr("Reset to defaults"), this, SLOT(resetViewToDefaults()));
 
     header()->setDefaultSectionSize(100);
+    // Fit to contents only measures the visible rows, measuring every row of a large database stalls the view
+    header()->setResizeContentsPrecision(0);
     header()->setStretchLastSection(false);
     header()->setContextMenuPolicy(Qt::CustomContextMenu);
 
@@ -228,6 +242,24 @@ void EntryView::displaySearch(const QList<Entry*>& entries)
     m_inSearchMode = true;
 }
 
+/**
+ * Add further results to the displayed search results.
+ *
+ * @param entries matching entries, not shown yet
+ */
+void EntryView::appendSearchResults(const QList<Entry*>& entries)
+{
+    if (!m_inSearchMode || entries.isEmpty()) {
+        return;
+    }
+
+    const bool wasEmpty = m_model->rowCount() == 0;
+    m_model->appendEntries(entries);
+    if (wasEmpty) {
+        setFirstEntryActive();
+    }
+}
+
 void EntryView::setFirstEntryActive()
 {
     if (m_model->rowCount() > 0) {
@@ -340,6 +372,11 @@ bool EntryView::setViewState(const QByteArray& state)
     return status;
 }
 
+void EntryView::releaseCaches()
+{
+    m_model->releaseCaches();
+}
+
 /**
  * Sync checkable menu actions to current state and display header context
  * menu at specified position
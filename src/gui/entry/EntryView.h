@@ -48,9 +48,11 @@ public:
     void setFirstEntryActive();
     QByteArray viewState() const;
     bool setViewState(const QByteArray& state);
+    void releaseCaches();
 
     void displayGroup(Group* group);
     void displaySearch(const QList<Entry*>& entries);
+    void appendSearchResults(const QList<Entry*>& entries);
 
 signals:
     void entryActivated(Entry* entry, EntryModel::ModelColumn column);
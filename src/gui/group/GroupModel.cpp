@@ -31,6 +31,9 @@ GroupModel::GroupModel(Database* db, QObject* parent)
     : QAbstractItemModel(parent)
     , m_db(nullptr)
 {
+#if defined(WITH_XC_KEESHARE)
+    connect(KeeShare::instance(), SIGNAL(activeChanged()), SLOT(clearDisplayCache()));
+#endif
     changeDatabase(db);
 }
 
@@ -39,6 +42,8 @@ void GroupModel::changeDatabase(Database* newDb)
     beginResetModel();
 
     m_db = newDb;
+    m_rows.clear();
+    m_displayCache.clear();
 
     // clang-format off
     connect(m_db, SIGNAL(groupDataChanged(Group*)), SLOT(groupDataChanged(Group*)));
@@ -48,6 +53,8 @@ void GroupModel::changeDatabase(Database* newDb)
     connect(m_db, SIGNAL(groupRemoved()), SLOT(groupRemoved()));
     connect(m_db, SIGNAL(groupAboutToMove(Group*,Group*,int)), SLOT(groupAboutToMove(Group*,Group*,int)));
     connect(m_db, SIGNAL(groupMoved()), SLOT(groupMoved()));
+    // Custom icons may have been replaced
+    connect(m_db->metadata(), SIGNAL(modified()), SLOT(clearDisplayCache()));
     // clang-format on
 
     endResetModel();
@@ -110,7 +117,7 @@ QModelIndex GroupModel::parent(Group* group) const
             // parent is the root group
             return createIndex(0, 0, parentGroup);
         } else {
-            return createIndex(grandParentGroup->children().indexOf(parentGroup), 0, parentGroup);
+            return createIndex(groupRow(parentGroup), 0, parentGroup);
         }
     }
 }
@@ -124,13 +131,13 @@ QVariant GroupModel::data(const QModelIndex& index, int role) const
     Group* group = groupFromIndex(index);
 
     if (role == Qt::DisplayRole) {
-        QString nameTemplate = "%1";
-#if defined(WITH_XC_KEESHARE)
-        nameTemplate = KeeShare::indicatorSuffix(group, nameTemplate);
-#endif
-        return nameTemplate.arg(group->name());
+        return displayData(group).name;
     } else if (role == Qt::DecorationRole) {
-        return Icons::groupIconPixmap(group);
+        auto& display = displayData(group);
+        if (display.icon.isNull()) {
+            display.icon = Icons::groupIconPixmap(group);
+        }
+        return display.icon;
     } else if (role == Qt::FontRole) {
         QFont font;
         if (group->isExpired()) {
@@ -160,15 +167,58 @@ QVariant GroupModel::headerData(int section, Qt::Orientation orientation, int ro
 
 QModelIndex GroupModel::index(Group* group) const
 {
-    int row;
+    return createIndex(groupRow(group), 0, group);
+}
 
-    if (!group->parentGroup()) {
-        row = 0;
-    } else {
-        row = group->parentGroup()->children().indexOf(group);
+/**
+ * @param group group of the database
+ * @return position of the group among its siblings, 0 for the root group
+ */
+int GroupModel::groupRow(const Group* group) const
+{
+    const Group* parentGroup = group->parentGroup();
+    if (!parentGroup) {
+        return 0;
     }
 
-    return createIndex(row, 0, group);
+    // Cached rows are only a hint, they are checked against the current children
+    const auto& siblings = parentGroup->children();
+    auto it = m_rows.constFind(group);
+    if (it != m_rows.constEnd() && it.value() < siblings.size() && siblings.at(it.value()) == group) {
+        return it.value();
+    }
+
+    for (int i = 0; i < siblings.size(); ++i) {
+        m_rows.insert(siblings.at(i), i);
+    }
+    return m_rows.value(group, -1);
+}
+
+/**
+ * Get the name and icon of a group, building them only after the group changed.
+ *
+ * @param group group of the database
+ * @return cached display data that stays valid until the next call
+ */
+GroupModel::DisplayData& GroupModel::displayData(const Group* group) const
+{
+    // Both only ever increase, share references are stored in the custom data
+    const quint64 modificationCount = group->modificationCount() + group->customData()->modificationCount();
+    const bool expired = group->isExpired();
+    auto it = m_displayCache.find(group);
+    if (it != m_displayCache.end() && it->modificationCount == modificationCount && it->expired == expired) {
+        return it.value();
+    }
+
+    DisplayData data;
+    data.modificationCount = modificationCount;
+    data.expired = expired;
+    QString nameTemplate = "%1";
+#if defined(WITH_XC_KEESHARE)
+    nameTemplate = KeeShare::indicatorSuffix(group, nameTemplate);
+#endif
+    data.name = nameTemplate.arg(group->name());
+    return m_displayCache.insert(group, data).value();
 }
 
 Group* GroupModel::groupFromIndex(const QModelIndex& index) const
@@ -277,6 +327,7 @@ bool GroupModel::dropMimeData(const QMimeData* data,
             return false;
         }
 
+        DatabaseBulkUpdate bulkUpdate(parentGroup->database());
         while (!stream.atEnd()) {
             QUuid dbUuid;
             QUuid entryUuid;
@@ -364,6 +415,7 @@ QMimeData* GroupModel::mimeData(const QModelIndexList& indexes) const
 
 void GroupModel::groupDataChanged(Group* group)
 {
+    m_displayCache.remove(group);
     QModelIndex ix = index(group);
     emit dataChanged(ix, ix);
 }
@@ -374,10 +426,16 @@ void GroupModel::groupAboutToRemove(Group* group)
 
     QModelIndex parentIndex = parent(group);
     Q_ASSERT(parentIndex.isValid());
-    int pos = group->parentGroup()->children().indexOf(group);
+    int pos = groupRow(group);
     Q_ASSERT(pos != -1);
 
     beginRemoveRows(parentIndex, pos, pos);
+
+    // The groups may be deleted and their addresses reused
+    for (const auto* child : group->groupsRecursive(true)) {
+        m_rows.remove(child);
+        m_displayCache.remove(child);
+    }
 }
 
 void GroupModel::groupRemoved()
@@ -405,7 +463,7 @@ void GroupModel::groupAboutToMove(Group* group, Group* toGroup, int pos)
 
     QModelIndex oldParentIndex = parent(group);
     QModelIndex newParentIndex = index(toGroup);
-    int oldPos = group->parentGroup()->children().indexOf(group);
+    int oldPos = groupRow(group);
     if (group->parentGroup() == toGroup && pos > oldPos) {
         // beginMoveRows() has a bit different semantics than Group::setParent() and
         // QList::move() when the new position is greater than the old
@@ -422,29 +480,39 @@ void GroupModel::groupMoved()
     endMoveRows();
 }
 
-void GroupModel::sortChildren(Group* rootGroup, bool reverse)
+void GroupModel::clearDisplayCache()
+{
+    m_displayCache.clear();
+}
+
+/**
+ * Drop the cached names, icons and rows, they are looked up again when the groups are painted.
+ */
+void GroupModel::releaseCaches()
 {
-    emit layoutAboutToBeChanged();
+    m_displayCache.clear();
+    m_rows.clear();
+}
 
-    QList<QModelIndex> oldIndexes;
-    collectIndexesRecursively(oldIndexes, rootGroup->children());
+void GroupModel::sortChildren(Group* rootGroup, bool reverse)
+{
+    // One layout change for the whole tree, only the indexes kept by views have to follow their groups
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    const auto oldIndexes = persistentIndexList();
+    QList<Group*> groups;
+    groups.reserve(oldIndexes.size());
+    for (const auto& oldIndex : oldIndexes) {
+        groups.append(groupFromIndex(oldIndex));
+    }
 
     rootGroup->sortChildrenRecursively(reverse);
 
-    QList<QModelIndex> newIndexes;
-    collectIndexesRecursively(newIndexes, rootGroup->children());
-
-    for (int i = 0; i < oldIndexes.count(); i++) {
-        changePersistentIndex(oldIndexes[i], newIndexes[i]);
+    for (int i = 0; i < oldIndexes.size(); ++i) {
+        auto group = groups.at(i);
+        changePersistentIndex(oldIndexes.at(i), createIndex(groupRow(group), oldIndexes.at(i).column(), group));
     }
 
-    emit layoutChanged();
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
 }
 
-void GroupModel::collectIndexesRecursively(QList<QModelIndex>& indexes, QList<Group*> groups)
-{
-    for (auto group : groups) {
-        indexes.append(index(group));
-        collectIndexesRecursively(indexes, group->children());
-    }
-}
@@ -19,6 +19,7 @@
 #define KEEPASSX_GROUPMODEL_H
 
 #include <QAbstractItemModel>
+#include <QHash>
 
 class Database;
 class Group;
@@ -46,10 +47,21 @@ public:
     QStringList mimeTypes() const override;
     QMimeData* mimeData(const QModelIndexList& indexes) const override;
     void sortChildren(Group* rootGroup, bool reverse = false);
+    void releaseCaches();
 
 private:
+    struct DisplayData
+    {
+        quint64 modificationCount = 0;
+        bool expired = false;
+        QString name;
+        // Built on the first request only
+        QVariant icon;
+    };
+
     QModelIndex parent(Group* group) const;
-    void collectIndexesRecursively(QList<QModelIndex>& indexes, QList<Group*> groups);
+    int groupRow(const Group* group) const;
+    DisplayData& displayData(const Group* group) const;
 
 private slots:
     void groupDataChanged(Group* group);
@@ -59,9 +71,13 @@ private slots:
     void groupAdded();
     void groupAboutToMove(Group* group, Group* toGroup, int pos);
     void groupMoved();
+    void clearDisplayCache();
 
 private:
     Database* m_db;
+    // Rows are looked up for every parent index, indexOf() is slow for groups with many siblings
+    mutable QHash<const Group*, int> m_rows;
+    mutable QHash<const Group*, DisplayData> m_displayCache;
 };
 
 #endif // KEEPASSX_GROUPMODEL_H
@@ -165,6 +165,11 @@ void GroupView::sortGroups(bool reverse)
     }
 }
 
+void GroupView::releaseCaches()
+{
+    m_model->releaseCaches();
+}
+
 void GroupView::setModel(QAbstractItemModel* model)
 {
     Q_UNUSED(model);
@@ -36,6 +36,7 @@ public:
     void setCurrentGroup(Group* group);
     void expandGroup(Group* group, bool expand = true);
     void sortGroups(bool reverse = false);
+    void releaseCaches();
 
 signals:
     void groupSelectionChanged();
@@ -22,14 +22,36 @@
 
 #include "core/AsyncTask.h"
 #include "core/Database.h"
+#include "crypto/CryptoHash.h"
 
 namespace
 {
-    QString getTempFileLocation()
+    /**
+     * The download of a remote is kept in the same file between syncs, so that
+     * commands like rsync can use the previous copy as basis for a delta transfer
+     * or skip the transfer when the remote file did not change.
+     *
+     * @param params remote to get the download file of
+     * @return path of the download file of the remote
+     */
+    QString getTempFileLocation(const RemoteParams* params)
     {
-        QString uuid = QUuid::createUuid().toString().remove(0, 1);
-        uuid.chop(1);
-        return QDir::toNativeSeparators(QDir::temp().absoluteFilePath("RemoteDatabase-" + uuid + ".kdbx"));
+        auto id = CryptoHash::hash(params->downloadCommand.toUtf8(), CryptoHash::Sha256).toHex().left(32);
+        return QDir::toNativeSeparators(QDir::temp().absoluteFilePath("RemoteDatabase-" + id + ".kdbx"));
+    }
+
+    QByteArray hashFile(const QString& filePath)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+
+        CryptoHash hash(CryptoHash::Sha256);
+        while (!file.atEnd()) {
+            hash.addData(file.read(1024 * 1024));
+        }
+        return hash.result();
     }
 } // namespace
 
@@ -57,7 +79,7 @@ RemoteHandler::RemoteResult RemoteHandler::download(const RemoteParams* params)
             return result;
         }
 
-        auto filePath = getTempFileLocation();
+        auto filePath = getTempFileLocation(params);
         auto remoteProcess = m_createRemoteProcess(nullptr); // use nullptr parent, otherwise there is a warning
         remoteProcess->setTempFileLocation(filePath);
         remoteProcess->start(params->downloadCommand);
@@ -83,6 +105,7 @@ RemoteHandler::RemoteResult RemoteHandler::download(const RemoteParams* params)
             } else {
                 result.success = true;
                 result.filePath = filePath;
+                result.fileHash = hashFile(filePath);
             }
         } else if (finished) {
             result.success = false;
@@ -127,6 +150,8 @@ RemoteHandler::RemoteResult RemoteHandler::upload(const QString& filePath, const
 
         if (finished && statusCode == 0) {
             result.success = true;
+            result.filePath = filePath;
+            result.fileHash = hashFile(filePath);
         } else if (finished) {
             result.success = false;
             result.errorMessage = tr("Failed to upload merged database. Command `%1` exited with status code: %2")
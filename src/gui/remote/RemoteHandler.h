@@ -37,6 +37,8 @@ public:
         bool success;
         QString errorMessage;
         QString filePath;
+        // SHA-256 of the database file as it is on the remote after the transfer
+        QByteArray fileHash;
         QString stdOutput;
         QString stdError;
     };
@@ -0,0 +1,152 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReportsEntryModel.h"
+
+#include "core/Database.h"
+#include "core/Entry.h"
+
+/**
+ * @param builder builds the cells of an entry, called when a row is first shown
+ */
+ReportsEntryModel::ReportsEntryModel(RowBuilder builder, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_builder(std::move(builder))
+{
+}
+
+/**
+ * @param db database of the listed entries, rows are rebuilt once it is modified
+ */
+void ReportsEntryModel::setDatabase(Database* db)
+{
+    if (m_db) {
+        disconnect(m_db, nullptr, this, nullptr);
+    }
+    m_db = db;
+    if (m_db) {
+        connect(m_db, &Database::modified, this, &ReportsEntryModel::invalidateRows);
+    }
+}
+
+/**
+ * Show a list of entries.
+ *
+ * @param entries entries, one per row
+ * @param headers column headers
+ */
+void ReportsEntryModel::setEntries(const QList<Entry*>& entries, const QStringList& headers)
+{
+    beginResetModel();
+    m_entries.clear();
+    m_entries.reserve(entries.size());
+    for (auto* entry : entries) {
+        m_entries.append(entry);
+    }
+    m_headers = headers;
+    m_rows.clear();
+    endResetModel();
+}
+
+/**
+ * Show a message in the header instead of any entries.
+ */
+void ReportsEntryModel::setMessage(const QString& message)
+{
+    setEntries({}, {message});
+}
+
+/**
+ * @return entry of a row, nullptr if it was deleted in the meantime
+ */
+Entry* ReportsEntryModel::entry(int row) const
+{
+    return row >= 0 && row < m_entries.size() ? m_entries.at(row).data() : nullptr;
+}
+
+int ReportsEntryModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_entries.size();
+}
+
+int ReportsEntryModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_headers.size();
+}
+
+QVariant ReportsEntryModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_entries.size()) {
+        return {};
+    }
+
+    const auto entry = m_entries.at(index.row());
+    if (!entry) {
+        return {};
+    }
+    if (role == SortRole && index.column() == 0) {
+        return entry->title();
+    }
+
+    const auto& cells = row(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case SortRole:
+        return cells.texts.value(index.column());
+    case Qt::ToolTipRole: {
+        const auto toolTip = cells.toolTips.value(index.column());
+        return toolTip.isEmpty() ? QVariant() : toolTip;
+    }
+    case Qt::DecorationRole:
+        if (index.column() == 0) {
+            return cells.entryIcon;
+        }
+        if (index.column() == 1) {
+            return cells.groupIcon;
+        }
+        break;
+    default:
+        break;
+    }
+    return {};
+}
+
+QVariant ReportsEntryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return m_headers.value(section);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void ReportsEntryModel::invalidateRows()
+{
+    if (m_rows.isEmpty()) {
+        return;
+    }
+    m_rows.clear();
+    emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+}
+
+const ReportsEntryModel::Row& ReportsEntryModel::row(int row) const
+{
+    auto it = m_rows.find(row);
+    if (it == m_rows.end()) {
+        it = m_rows.insert(row, m_builder(m_entries.at(row).data()));
+    }
+    return it.value();
+}
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_REPORTSENTRYMODEL_H
+#define KEEPASSXC_REPORTSENTRYMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QPixmap>
+#include <QPointer>
+
+#include <functional>
+
+class Database;
+class Entry;
+
+/**
+ * Table of the entries listed by a report, whose cells are only built once they are shown.
+ *
+ * A row is built on its first access and kept until the database is modified.
+ * The sort role gives the entry title for the first column without building
+ * the row, so sorting by title does not build every row either.
+ */
+class ReportsEntryModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    static const int SortRole = Qt::UserRole;
+
+    struct Row
+    {
+        QStringList texts;
+        QStringList toolTips;
+        // Shown in the first and the second column
+        QPixmap entryIcon;
+        QPixmap groupIcon;
+    };
+    typedef std::function<Row(Entry*)> RowBuilder;
+
+    explicit ReportsEntryModel(RowBuilder builder, QObject* parent = nullptr);
+
+    void setDatabase(Database* db);
+    void setEntries(const QList<Entry*>& entries, const QStringList& headers);
+    void setMessage(const QString& message);
+    Entry* entry(int row) const;
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private slots:
+    void invalidateRows();
+
+private:
+    const Row& row(int row) const;
+
+    RowBuilder m_builder;
+    QPointer<Database> m_db;
+    QStringList m_headers;
+    QList<QPointer<Entry>> m_entries;
+    mutable QHash<int, Row> m_rows;
+};
+
+#endif // KEEPASSXC_REPORTSENTRYMODEL_H
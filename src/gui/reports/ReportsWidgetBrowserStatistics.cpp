@@ -18,92 +18,33 @@
 #include "ReportsWidgetBrowserStatistics.h"
 #include "ui_ReportsWidgetBrowserStatistics.h"
 
+#include "browser/BrowserEntryConfig.h"
+#include "browser/BrowserEntryIndex.h"
 #include "browser/BrowserService.h"
-#include "core/AsyncTask.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "gui/GuiTools.h"
 #include "gui/Icons.h"
-#include "gui/styles/StateColorPalette.h"
 
-#include <QJsonDocument>
 #include <QMenu>
 #include <QShortcut>
 #include <QSortFilterProxyModel>
-#include <QStandardItemModel>
-
-namespace
-{
-    class BrowserStatistics
-    {
-    public:
-        struct Item
-        {
-            QPointer<Group> group;
-            QPointer<Entry> entry;
-            bool hasUrls;
-            bool hasSettings;
-            bool exclude = false;
-
-            Item(Group* g, Entry* e, bool hU, bool hS)
-                : group(g)
-                , entry(e)
-                , hasUrls(hU)
-                , hasSettings(hS)
-                , exclude(e->excludeFromReports())
-            {
-            }
-        };
-
-        explicit BrowserStatistics(QSharedPointer<Database>);
-
-        const QList<QSharedPointer<Item>>& items() const
-        {
-            return m_items;
-        }
-
-    private:
-        QSharedPointer<Database> m_db;
-        QList<QSharedPointer<Item>> m_items;
-    };
-} // namespace
-
-BrowserStatistics::BrowserStatistics(QSharedPointer<Database> db)
-    : m_db(db)
-{
-    for (auto group : db->rootGroup()->groupsRecursive(true)) {
-        // Skip recycle bin
-        if (group->isRecycled()) {
-            continue;
-        }
-
-        for (auto entry : group->entries()) {
-            if (entry->isRecycled()) {
-                continue;
-            }
-
-            auto hasUrls = !entry->getAllUrls().isEmpty();
-            auto hasSettings = entry->customData()->contains(BrowserService::KEEPASSXCBROWSER_NAME);
-
-            const auto item = QSharedPointer<Item>(new Item(group, entry, hasUrls, hasSettings));
-            m_items.append(item);
-        }
-    }
-}
 
 ReportsWidgetBrowserStatistics::ReportsWidgetBrowserStatistics(QWidget* parent)
     : QWidget(parent)
     , m_ui(new Ui::ReportsWidgetBrowserStatistics())
-    , m_referencesModel(new QStandardItemModel(this))
+    , m_referencesModel(new ReportsEntryModel(&ReportsWidgetBrowserStatistics::buildRow, this))
     , m_modelProxy(new QSortFilterProxyModel(this))
 {
     m_ui->setupUi(this);
 
     m_modelProxy->setSourceModel(m_referencesModel.data());
     m_modelProxy->setSortLocaleAware(true);
+    m_modelProxy->setSortRole(ReportsEntryModel::SortRole);
     m_ui->browserStatisticsTableView->setModel(m_modelProxy.data());
     m_ui->browserStatisticsTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-    m_ui->browserStatisticsTableView->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    // Columns are fitted to the visible rows, the others are only built once they are scrolled to
+    m_ui->browserStatisticsTableView->horizontalHeader()->setResizeContentsPrecision(0);
 
     connect(m_ui->browserStatisticsTableView,
             SIGNAL(customContextMenuRequested(QPoint)),
@@ -121,24 +62,26 @@ ReportsWidgetBrowserStatistics::~ReportsWidgetBrowserStatistics()
 {
 }
 
-void ReportsWidgetBrowserStatistics::addStatisticsRow(bool hasUrls,
-                                                      bool hasSettings,
-                                                      Group* group,
-                                                      Entry* entry,
-                                                      bool excluded)
+/**
+ * Build the cells of an entry once its row is shown.
+ *
+ * Rows are a single line high, the full lists of URLs are shown as tooltips.
+ */
+ReportsEntryModel::Row ReportsWidgetBrowserStatistics::buildRow(Entry* entry)
 {
-    StateColorPalette statePalette;
-
-    auto urlList = entry->getAllUrls();
-    auto urlToolTip = hasUrls ? tr("List of entry URLs") : tr("Entry has no URLs set");
-
-    auto browserConfig = getBrowserConfigFromEntry(entry);
-    auto allowedUrlsList = browserConfig["Allow"];
-    auto deniedUrlsList = browserConfig["Deny"];
-
-    auto allowedUrlsToolTip = hasSettings ? tr("Allowed URLs") : tr("Entry has no Browser Integration settings");
-    auto deniedUrlsToolTip = hasSettings ? tr("Denied URLs") : tr("Entry has no Browser Integration settings");
-
+    const auto urlList = entry->getAllUrls();
+
+    // Parsed settings are shared with the browser integration
+    BrowserEntryConfig browserConfig;
+    const bool hasSettings = browserConfig.load(entry);
+    auto allowedUrlsList = browserConfig.allowedHosts();
+    auto deniedUrlsList = browserConfig.deniedHosts();
+    allowedUrlsList.removeAll({});
+    deniedUrlsList.removeAll({});
+    allowedUrlsList.sort();
+    deniedUrlsList.sort();
+
+    const bool excluded = entry->excludeFromReports();
     auto title = entry->title();
     if (excluded) {
         title.append(tr(" (Excluded)"));
@@ -147,36 +90,32 @@ void ReportsWidgetBrowserStatistics::addStatisticsRow(bool hasUrls,
         title.append(tr(" (Expired)"));
     }
 
-    auto row = QList<QStandardItem*>();
-    row << new QStandardItem(Icons::entryIconPixmap(entry), title);
-    row << new QStandardItem(Icons::groupIconPixmap(group), group->hierarchy().join("/"));
-    row << new QStandardItem(urlList.join('\n'));
-    row << new QStandardItem(allowedUrlsList.join('\n'));
-    row << new QStandardItem(deniedUrlsList.join('\n'));
-
-    // Set tooltips
-    row[2]->setToolTip(urlToolTip);
-    row[3]->setToolTip(allowedUrlsToolTip);
-    row[4]->setToolTip(deniedUrlsToolTip);
-    if (excluded) {
-        row[0]->setToolTip(tr("This entry is being excluded from reports"));
+    auto listToolTip = [](const QStringList& list, const QString& fallback) {
+        return list.isEmpty() ? fallback : list.join('\n');
+    };
+    const auto noSettings = tr("Entry has no Browser Integration settings");
+
+    ReportsEntryModel::Row row;
+    const auto group = entry->group();
+    row.texts << title << (group ? group->hierarchy().join("/") : QString()) << urlList.join(", ")
+              << allowedUrlsList.join(", ") << deniedUrlsList.join(", ");
+    row.toolTips << (excluded ? tr("This entry is being excluded from reports") : QString()) << QString()
+                 << listToolTip(urlList, tr("Entry has no URLs set"))
+                 << listToolTip(allowedUrlsList, hasSettings ? tr("Allowed URLs") : noSettings)
+                 << listToolTip(deniedUrlsList, hasSettings ? tr("Denied URLs") : noSettings);
+    row.entryIcon = Icons::entryIconPixmap(entry);
+    if (group) {
+        row.groupIcon = Icons::groupIconPixmap(group);
     }
-
-    // Store entry pointer per table row (used in double click handler)
-    m_referencesModel->appendRow(row);
-    m_rowToEntry.append({group, entry});
+    return row;
 }
 
 void ReportsWidgetBrowserStatistics::loadSettings(QSharedPointer<Database> db)
 {
     m_db = std::move(db);
     m_statisticsCalculated = false;
-    m_referencesModel->clear();
-    m_rowToEntry.clear();
-
-    auto row = QList<QStandardItem*>();
-    row << new QStandardItem(tr("Please wait, browser statistics is being calculated…"));
-    m_referencesModel->appendRow(row);
+    m_referencesModel->setDatabase(m_db.data());
+    m_referencesModel->setMessage(tr("Please wait, browser statistics is being calculated…"));
 }
 
 void ReportsWidgetBrowserStatistics::showEvent(QShowEvent* event)
@@ -192,46 +131,42 @@ void ReportsWidgetBrowserStatistics::showEvent(QShowEvent* event)
 
 void ReportsWidgetBrowserStatistics::calculateBrowserStatistics()
 {
-    m_referencesModel->clear();
-
-    // Perform the statistics check
-    const QScopedPointer<BrowserStatistics> browserStatistics(
-        AsyncTask::runAndWaitForFuture([this] { return new BrowserStatistics(m_db); }));
-
     const auto showExpired = m_ui->showExpired->isChecked();
     const auto showEntriesWithUrlOnly = m_ui->showEntriesWithUrlOnlyCheckBox->isChecked();
     const auto showOnlyEntriesWithSettings = m_ui->showAllowDenyCheckBox->isChecked();
 
-    // Display the entries
-    m_rowToEntry.clear();
-    for (const auto& item : browserStatistics->items()) {
+    // The index is kept up to date as entries change, the rows are only filled once shown
+    QList<Entry*> entries;
+    for (auto* entry : BrowserEntryIndex::forDatabase(m_db.data())->entries()) {
+        if (entry->isRecycled()) {
+            continue;
+        }
+
         // Check if the entry should be displayed
-        if (!showExpired && item->entry->isExpired()) {
+        if (!showExpired && entry->isExpired()) {
             continue;
         }
 
         // Exclude this entry if URL are not set
-        if (showEntriesWithUrlOnly && !item->hasUrls) {
+        if (showEntriesWithUrlOnly && entry->getAllUrls().isEmpty()) {
             continue;
         }
 
         // Exclude this entry if it doesn't have any Browser Integration settings
-        if (showOnlyEntriesWithSettings
-            && !item->entry->customData()->contains(BrowserService::KEEPASSXCBROWSER_NAME)) {
+        if (showOnlyEntriesWithSettings && !entry->customData()->contains(BrowserService::KEEPASSXCBROWSER_NAME)) {
             continue;
         }
 
-        // Show the entry in the report
-        addStatisticsRow(item->hasUrls, item->hasSettings, item->group, item->entry, item->exclude);
+        entries.append(entry);
     }
 
     // Set the table header
-    if (m_referencesModel->rowCount() == 0) {
-        m_referencesModel->setHorizontalHeaderLabels(
-            QStringList() << tr("No entries with a URL, or none has browser extension settings saved."));
+    if (entries.isEmpty()) {
+        m_referencesModel->setMessage(tr("No entries with a URL, or none has browser extension settings saved."));
     } else {
-        m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("Title") << tr("Path") << tr("URLs")
-                                                                   << tr("Allowed URLs") << tr("Denied URLs"));
+        m_referencesModel->setEntries(entries,
+                                      QStringList() << tr("Title") << tr("Path") << tr("URLs") << tr("Allowed URLs")
+                                                    << tr("Denied URLs"));
         m_ui->browserStatisticsTableView->sortByColumn(0, Qt::AscendingOrder);
     }
 
@@ -245,12 +180,9 @@ void ReportsWidgetBrowserStatistics::emitEntryActivated(const QModelIndex& index
     }
 
     auto mappedIndex = m_modelProxy->mapToSource(index);
-    const auto row = m_rowToEntry[mappedIndex.row()];
-    const auto group = row.first;
-    const auto entry = row.second;
-
-    if (group && entry) {
-        emit entryActivated(const_cast<Entry*>(entry));
+    auto entry = m_referencesModel->entry(mappedIndex.row());
+    if (entry && entry->group()) {
+        emit entryActivated(entry);
     }
 }
 
@@ -270,7 +202,7 @@ void ReportsWidgetBrowserStatistics::customMenuRequested(QPoint pos)
         menu->addAction(edit);
         connect(edit, &QAction::triggered, edit, [this, selected] {
             auto row = m_modelProxy->mapToSource(selected[0]).row();
-            auto entry = m_rowToEntry[row].second;
+            auto entry = m_referencesModel->entry(row);
             emit entryActivated(entry);
         });
     }
@@ -296,7 +228,7 @@ void ReportsWidgetBrowserStatistics::customMenuRequested(QPoint pos)
     bool isExcluded = false;
     for (auto index : selected) {
         auto row = m_modelProxy->mapToSource(index).row();
-        auto entry = m_rowToEntry[row].second;
+        auto entry = m_referencesModel->entry(row);
         if (entry && entry->excludeFromReports()) {
             // If at least one entry is excluded switch to inclusion
             isExcluded = true;
@@ -310,7 +242,7 @@ void ReportsWidgetBrowserStatistics::customMenuRequested(QPoint pos)
     connect(exclude, &QAction::toggled, exclude, [this, selected](bool state) {
         for (auto index : selected) {
             auto row = m_modelProxy->mapToSource(index).row();
-            auto entry = m_rowToEntry[row].second;
+            auto entry = m_referencesModel->entry(row);
             if (entry) {
                 entry->setExcludeFromReports(state);
             }
@@ -351,48 +283,12 @@ void ReportsWidgetBrowserStatistics::deletePluginDataFromSelectedEntries()
     calculateBrowserStatistics();
 }
 
-QMap<QString, QStringList> ReportsWidgetBrowserStatistics::getBrowserConfigFromEntry(Entry* entry) const
-{
-    QMap<QString, QStringList> configList;
-
-    auto config = entry->customData()->value(BrowserService::KEEPASSXCBROWSER_NAME);
-    if (!config.isEmpty()) {
-        QJsonDocument doc = QJsonDocument::fromJson(config.toUtf8());
-        if (!doc.isNull()) {
-            auto jsonObject = doc.object();
-            auto allowedSites = jsonObject["Allow"].toArray();
-            auto deniedSites = jsonObject["Deny"].toArray();
-
-            QStringList allowed;
-            foreach (const auto& value, allowedSites) {
-                auto url = value.toString();
-                if (!url.isEmpty()) {
-                    allowed << url;
-                }
-            }
-
-            QStringList denied;
-            foreach (const auto& value, deniedSites) {
-                auto url = value.toString();
-                if (!url.isEmpty()) {
-                    denied << url;
-                }
-            }
-
-            configList.insert("Allow", allowed);
-            configList.insert("Deny", denied);
-        }
-    }
-
-    return configList;
-}
-
 QList<Entry*> ReportsWidgetBrowserStatistics::getSelectedEntries() const
 {
     QList<Entry*> selectedEntries;
     for (auto index : m_ui->browserStatisticsTableView->selectionModel()->selectedRows()) {
         auto row = m_modelProxy->mapToSource(index).row();
-        auto entry = m_rowToEntry[row].second;
+        auto entry = m_referencesModel->entry(row);
         if (entry) {
             selectedEntries << entry;
         }
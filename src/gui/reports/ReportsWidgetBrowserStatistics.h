@@ -19,14 +19,12 @@
 #define KEEPASSXC_REPORTSWIDGETBROWSERSTATISTICS_H
 
 #include "gui/entry/EntryModel.h"
+#include "gui/reports/ReportsEntryModel.h"
 #include <QWidget>
 
 class Database;
 class Entry;
-class Group;
-class PasswordHealth;
 class QSortFilterProxyModel;
-class QStandardItemModel;
 
 namespace Ui
 {
@@ -57,17 +55,15 @@ public slots:
     void deletePluginDataFromSelectedEntries();
 
 private:
-    void addStatisticsRow(bool hasUrls, bool hasSettings, Group*, Entry*, bool);
+    static ReportsEntryModel::Row buildRow(Entry* entry);
     QList<Entry*> getSelectedEntries() const;
-    QMap<QString, QStringList> getBrowserConfigFromEntry(Entry* entry) const;
 
     QScopedPointer<Ui::ReportsWidgetBrowserStatistics> m_ui;
 
     bool m_statisticsCalculated = false;
-    QScopedPointer<QStandardItemModel> m_referencesModel;
+    QScopedPointer<ReportsEntryModel> m_referencesModel;
     QScopedPointer<QSortFilterProxyModel> m_modelProxy;
     QSharedPointer<Database> m_db;
-    QList<QPair<Group*, Entry*>> m_rowToEntry;
 };
 
 #endif // KEEPASSXC_REPORTSWIDGETBROWSERSTATISTICS_H
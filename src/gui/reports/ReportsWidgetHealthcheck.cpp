@@ -33,6 +33,9 @@
 
 namespace
 {
+    // Entries evaluated per step before the rows are shown
+    constexpr int healthBatchSize = 1000;
+
     class Health
     {
     public:
@@ -59,20 +62,24 @@ namespace
 
         explicit Health(QSharedPointer<Database>);
 
-        const QList<QSharedPointer<Item>>& items() const
+        int size() const
         {
-            return m_items;
+            return m_candidates.size();
         }
 
+        QList<QSharedPointer<Item>> evaluate(int from, int count) const;
+
         bool anyExcludedEntries() const
         {
             return m_anyExcludedEntries;
         }
 
     private:
+        typedef QPair<Group*, Entry*> Candidate;
+
         QSharedPointer<Database> m_db;
         HealthChecker m_checker;
-        QList<QSharedPointer<Item>> m_items;
+        QList<Candidate> m_candidates;
         bool m_anyExcludedEntries = false;
     };
 
@@ -118,22 +125,34 @@ Health::Health(QSharedPointer<Database> db)
                 continue;
             }
 
-            // Evaluate this entry
-            const auto item = QSharedPointer<Item>(new Item(group, entry, m_checker.evaluate(entry)));
-            if (item->exclude) {
+            if (entry->excludeFromReports()) {
                 m_anyExcludedEntries = true;
             }
-
-            // Add entry if its password isn't at least "good"
-            if (item->health->quality() < PasswordHealth::Quality::Good) {
-                m_items.append(item);
-            }
+            m_candidates.append({group, entry});
         }
     }
+}
 
-    // Sort the result so that the worst passwords (least score)
-    // are at the top
-    std::sort(m_items.begin(), m_items.end(), [](QSharedPointer<Item> x, QSharedPointer<Item> y) { return *x < *y; });
+/**
+ * Evaluate a range of entries in parallel.
+ *
+ * @return items of the range whose password isn't at least "good"
+ */
+QList<QSharedPointer<Health::Item>> Health::evaluate(int from, int count) const
+{
+    const std::function<QSharedPointer<Item>(const Candidate&)> evaluateCandidate = [this](const Candidate& candidate) {
+        return QSharedPointer<Item>::create(candidate.first, candidate.second, m_checker.evaluate(candidate.second));
+    };
+    const auto items = QtConcurrent::blockingMapped<QList<QSharedPointer<Item>>>(m_candidates.mid(from, count),
+                                                                                  evaluateCandidate);
+
+    QList<QSharedPointer<Item>> result;
+    for (const auto& item : items) {
+        if (item->health->quality() < PasswordHealth::Quality::Good) {
+            result.append(item);
+        }
+    }
+    return result;
 }
 
 ReportsWidgetHealthcheck::ReportsWidgetHealthcheck(QWidget* parent)
@@ -223,9 +242,14 @@ void ReportsWidgetHealthcheck::addHealthRow(QSharedPointer<PasswordHealth> healt
     }
     row[4]->setToolTip(health->scoreDetails());
 
+    // Keep the worst passwords (least score) at the top while rows are added batch by batch
+    const auto position = std::upper_bound(m_rowScores.begin(), m_rowScores.end(), health->score());
+    const auto index = static_cast<int>(position - m_rowScores.begin());
+    m_rowScores.insert(index, health->score());
+
     // Store entry pointer per table row (used in double click handler)
-    m_referencesModel->appendRow(row);
-    m_rowToEntry.append({group, entry});
+    m_referencesModel->insertRow(index, row);
+    m_rowToEntry.insert(index, {group, entry});
 }
 
 void ReportsWidgetHealthcheck::loadSettings(QSharedPointer<Database> db)
@@ -253,22 +277,34 @@ void ReportsWidgetHealthcheck::showEvent(QShowEvent* event)
 
 void ReportsWidgetHealthcheck::calculateHealth()
 {
+    // Events are processed while waiting, a newer calculation supersedes this one
+    const auto calculation = ++m_calculation;
+
     m_referencesModel->clear();
+    m_rowToEntry.clear();
+    m_rowScores.clear();
+    // Rows are inserted in sorted order, keep them in source order until all are added
+    m_modelProxy->sort(-1);
 
     // Perform the health check
-    const QScopedPointer<Health> health(AsyncTask::runAndWaitForFuture([this] { return new Health(m_db); }));
-
-    // Display the entries
-    m_rowToEntry.clear();
-    for (const auto& item : health->items()) {
-        // Check if the entry should be displayed
-        if ((!m_ui->showExcluded->isChecked() && item->exclude)
-            || (!m_ui->showExpired->isChecked() && item->entry->isExpired())) {
-            continue;
+    const Health health(m_db);
+    for (int i = 0; i < health.size(); i += healthBatchSize) {
+        const auto items = AsyncTask::runAndWaitForFuture([&health, i] { return health.evaluate(i, healthBatchSize); });
+        if (calculation != m_calculation) {
+            return;
         }
 
-        // Show the entry in the report
-        addHealthRow(item->health, item->group, item->entry, item->exclude);
+        // Display the entries
+        for (const auto& item : items) {
+            // Check if the entry should be displayed
+            if ((!m_ui->showExcluded->isChecked() && item->exclude)
+                || (!m_ui->showExpired->isChecked() && item->entry->isExpired())) {
+                continue;
+            }
+
+            // Show the entry in the report
+            addHealthRow(item->health, item->group, item->entry, item->exclude);
+        }
     }
 
     // Set the table header
@@ -284,7 +320,7 @@ void ReportsWidgetHealthcheck::calculateHealth()
     m_ui->healthcheckTableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Fixed);
 
     // Only show the "show excluded" checkbox if there are any excluded entries in the database
-    m_ui->showExcluded->setVisible(health->anyExcludedEntries());
+    m_ui->showExcluded->setVisible(health.anyExcludedEntries());
 }
 
 void ReportsWidgetHealthcheck::emitEntryActivated(const QModelIndex& index)
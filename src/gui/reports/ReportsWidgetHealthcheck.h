@@ -65,6 +65,8 @@ private:
     QScopedPointer<QSortFilterProxyModel> m_modelProxy;
     QSharedPointer<Database> m_db;
     QList<QPair<Group*, Entry*>> m_rowToEntry;
+    QList<int> m_rowScores;
+    quint64 m_calculation = 0;
 };
 
 #endif // KEEPASSXC_REPORTSWIDGETHEALTHCHECK_H
@@ -253,11 +253,13 @@ void ReportsWidgetHibp::startValidation()
     // Collect all passwords in the database (unless recycled, and
     // unless empty, and unless marked as "known bad") and submit them
     // to the downloader.
+    QStringList passwords;
     for (const auto* entry : m_db->rootGroup()->entriesRecursive()) {
         if (!entry->isRecycled() && !entry->password().isEmpty()) {
-            m_downloader.add(entry->password());
+            passwords.append(entry->password());
         }
     }
+    m_downloader.add(passwords);
 
     // Short circuit if we didn't actually add any passwords
     if (m_downloader.passwordsToValidate() == 0) {
@@ -18,9 +18,9 @@
 #include "ReportsWidgetPasskeys.h"
 #include "ui_ReportsWidgetPasskeys.h"
 
+#include "browser/BrowserEntryIndex.h"
 #include "browser/BrowserPasskeys.h"
 #include "browser/PasskeyUtils.h"
-#include "core/AsyncTask.h"
 #include "core/EntryAttributes.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
@@ -29,76 +29,26 @@
 #include "gui/MessageBox.h"
 #include "gui/passkeys/PasskeyExporter.h"
 #include "gui/passkeys/PasskeyImporter.h"
-#include "gui/styles/StateColorPalette.h"
 
 #include <QMenu>
 #include <QShortcut>
 #include <QSortFilterProxyModel>
-#include <QStandardItemModel>
-
-namespace
-{
-    class PasskeyList
-    {
-    public:
-        struct Item
-        {
-            QPointer<Group> group;
-            QPointer<Entry> entry;
-
-            Item(Group* g, Entry* e)
-                : group(g)
-                , entry(e)
-            {
-            }
-        };
-
-        explicit PasskeyList(const QSharedPointer<Database>&);
-
-        const QList<QSharedPointer<Item>>& items() const
-        {
-            return m_items;
-        }
-
-    private:
-        QSharedPointer<Database> m_db;
-        QList<QSharedPointer<Item>> m_items;
-    };
-} // namespace
-
-PasskeyList::PasskeyList(const QSharedPointer<Database>& db)
-    : m_db(db)
-{
-    for (auto group : db->rootGroup()->groupsRecursive(true)) {
-        // Skip recycle bin
-        if (group->isRecycled()) {
-            continue;
-        }
-
-        for (auto entry : group->entries()) {
-            if (entry->isRecycled() || !entry->attributes()->hasKey(EntryAttributes::KPEX_PASSKEY_PRIVATE_KEY_PEM)) {
-                continue;
-            }
-
-            const auto item = QSharedPointer<Item>(new Item(group, entry));
-            m_items.append(item);
-        }
-    }
-}
 
 ReportsWidgetPasskeys::ReportsWidgetPasskeys(QWidget* parent)
     : QWidget(parent)
     , m_ui(new Ui::ReportsWidgetPasskeys())
-    , m_referencesModel(new QStandardItemModel(this))
+    , m_referencesModel(new ReportsEntryModel(&ReportsWidgetPasskeys::buildRow, this))
     , m_modelProxy(new QSortFilterProxyModel(this))
 {
     m_ui->setupUi(this);
 
     m_modelProxy->setSourceModel(m_referencesModel.data());
     m_modelProxy->setSortLocaleAware(true);
+    m_modelProxy->setSortRole(ReportsEntryModel::SortRole);
     m_ui->passkeysTableView->setModel(m_modelProxy.data());
     m_ui->passkeysTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-    m_ui->passkeysTableView->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    // Columns are fitted to the visible rows, the others are only built once they are scrolled to
+    m_ui->passkeysTableView->horizontalHeader()->setResizeContentsPrecision(0);
 
     connect(m_ui->passkeysTableView, SIGNAL(customContextMenuRequested(QPoint)), SLOT(customMenuRequested(QPoint)));
     connect(m_ui->passkeysTableView, SIGNAL(doubleClicked(QModelIndex)), SLOT(emitEntryActivated(QModelIndex)));
@@ -119,43 +69,40 @@ ReportsWidgetPasskeys::~ReportsWidgetPasskeys()
 {
 }
 
-void ReportsWidgetPasskeys::addPasskeyRow(Group* group, Entry* entry)
+/**
+ * Build the cells of an entry once its row is shown.
+ *
+ * Rows are a single line high, the full list of URLs is shown as tooltip.
+ */
+ReportsEntryModel::Row ReportsWidgetPasskeys::buildRow(Entry* entry)
 {
-    StateColorPalette statePalette;
-
     auto urlList = entry->getAllUrls();
-    auto urlToolTip = tr("List of entry URLs");
 
     auto title = entry->title();
     if (entry->isExpired()) {
         title.append(tr(" (Expired)"));
     }
 
-    auto row = QList<QStandardItem*>();
-    row << new QStandardItem(Icons::entryIconPixmap(entry), title);
-    row << new QStandardItem(Icons::groupIconPixmap(group), group->hierarchy().join("/"));
-    row << new QStandardItem(passkeyUtils()->getUsernameFromEntry(entry));
-    row << new QStandardItem(entry->attributes()->value(EntryAttributes::KPEX_PASSKEY_RELYING_PARTY));
-    row << new QStandardItem(urlList.join('\n'));
-
-    // Set tooltips
-    row[2]->setToolTip(urlToolTip);
-
-    // Store entry pointer per table row (used in double click handler)
-    m_referencesModel->appendRow(row);
-    m_rowToEntry.append({group, entry});
+    ReportsEntryModel::Row row;
+    const auto group = entry->group();
+    row.texts << title << (group ? group->hierarchy().join("/") : QString())
+              << passkeyUtils()->getUsernameFromEntry(entry)
+              << entry->attributes()->value(EntryAttributes::KPEX_PASSKEY_RELYING_PARTY) << urlList.join(", ");
+    row.toolTips << QString() << QString() << QString() << QString()
+                 << urlList.join('\n');
+    row.entryIcon = Icons::entryIconPixmap(entry);
+    if (group) {
+        row.groupIcon = Icons::groupIconPixmap(group);
+    }
+    return row;
 }
 
 void ReportsWidgetPasskeys::loadSettings(QSharedPointer<Database> db)
 {
     m_db = std::move(db);
     m_entriesUpdated = false;
-    m_referencesModel->clear();
-    m_rowToEntry.clear();
-
-    auto row = QList<QStandardItem*>();
-    row << new QStandardItem(tr("Please wait, list of entries with passkeys is being updated…"));
-    m_referencesModel->appendRow(row);
+    m_referencesModel->setDatabase(m_db.data());
+    m_referencesModel->setMessage(tr("Please wait, list of entries with passkeys is being updated…"));
 }
 
 void ReportsWidgetPasskeys::showEvent(QShowEvent* event)
@@ -171,29 +118,23 @@ void ReportsWidgetPasskeys::showEvent(QShowEvent* event)
 
 void ReportsWidgetPasskeys::updateEntries()
 {
-    m_referencesModel->clear();
-
-    // Perform the statistics check
-    const QScopedPointer<PasskeyList> browserStatistics(
-        AsyncTask::runAndWaitForFuture([this] { return new PasskeyList(m_db); }));
-
-    // Display the entries
-    m_rowToEntry.clear();
-    for (const auto& item : browserStatistics->items()) {
+    // The index is kept up to date as entries change, the rows are only filled once shown
+    QList<Entry*> entries;
+    for (auto* entry : BrowserEntryIndex::forDatabase(m_db.data())->passkeyEntries()) {
         // Exclude expired entries from report if not requested
-        if (!m_ui->showExpired->isChecked() && item->entry->isExpired()) {
+        if (entry->isRecycled() || (!m_ui->showExpired->isChecked() && entry->isExpired())) {
             continue;
         }
-
-        addPasskeyRow(item->group, item->entry);
+        entries.append(entry);
     }
 
     // Set the table header
-    if (m_referencesModel->rowCount() == 0) {
-        m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("No entries with passkeys."));
+    if (entries.isEmpty()) {
+        m_referencesModel->setMessage(tr("No entries with passkeys."));
     } else {
-        m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("Title") << tr("Path") << tr("Username")
-                                                                   << tr("Relying Party") << tr("URLs"));
+        m_referencesModel->setEntries(entries,
+                                      QStringList() << tr("Title") << tr("Path") << tr("Username")
+                                                    << tr("Relying Party") << tr("URLs"));
         m_ui->passkeysTableView->sortByColumn(0, Qt::AscendingOrder);
     }
 
@@ -207,11 +148,8 @@ void ReportsWidgetPasskeys::emitEntryActivated(const QModelIndex& index)
     }
 
     auto mappedIndex = m_modelProxy->mapToSource(index);
-    const auto row = m_rowToEntry[mappedIndex.row()];
-    const auto group = row.first;
-    const auto entry = row.second;
-
-    if (group && entry) {
+    auto entry = m_referencesModel->entry(mappedIndex.row());
+    if (entry && entry->group()) {
         emit entryActivated(entry);
     }
 }
@@ -232,7 +170,7 @@ void ReportsWidgetPasskeys::customMenuRequested(QPoint pos)
         menu->addAction(edit);
         connect(edit, &QAction::triggered, edit, [this, selected] {
             auto row = m_modelProxy->mapToSource(selected[0]).row();
-            auto entry = m_rowToEntry[row].second;
+            auto entry = m_referencesModel->entry(row);
             emit entryActivated(entry);
         });
     }
@@ -268,7 +206,7 @@ QList<Entry*> ReportsWidgetPasskeys::getSelectedEntries()
     QList<Entry*> selectedEntries;
     for (auto index : m_ui->passkeysTableView->selectionModel()->selectedRows()) {
         auto row = m_modelProxy->mapToSource(index).row();
-        auto entry = m_rowToEntry[row].second;
+        auto entry = m_referencesModel->entry(row);
         if (entry) {
             selectedEntries << entry;
         }
@@ -19,14 +19,12 @@
 #define KEEPASSXC_REPORTSWIDGETPASSKEYS_H
 
 #include "gui/entry/EntryModel.h"
+#include "gui/reports/ReportsEntryModel.h"
 #include <QWidget>
 
 class Database;
 class Entry;
-class Group;
-class PasswordHealth;
 class QSortFilterProxyModel;
-class QStandardItemModel;
 
 namespace Ui
 {
@@ -61,16 +59,15 @@ private slots:
     void exportPasskey();
 
 private:
-    void addPasskeyRow(Group*, Entry*);
+    static ReportsEntryModel::Row buildRow(Entry* entry);
     QList<Entry*> getSelectedEntries();
 
     QScopedPointer<Ui::ReportsWidgetPasskeys> m_ui;
 
     bool m_entriesUpdated = false;
-    QScopedPointer<QStandardItemModel> m_referencesModel;
+    QScopedPointer<ReportsEntryModel> m_referencesModel;
     QScopedPointer<QSortFilterProxyModel> m_modelProxy;
     QSharedPointer<Database> m_db;
-    QList<QPair<Group*, Entry*>> m_rowToEntry;
 };
 
 #endif // KEEPASSXC_REPORTSWIDGETPASSKEYS_H
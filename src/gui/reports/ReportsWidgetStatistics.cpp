@@ -18,7 +18,6 @@
 #include "ReportsWidgetStatistics.h"
 #include "ui_ReportsWidgetStatistics.h"
 
-#include "core/AsyncTask.h"
 #include "core/Clock.h"
 #include "core/DatabaseStats.h"
 #include "core/Group.h"
@@ -80,8 +79,8 @@ void ReportsWidgetStatistics::showEvent(QShowEvent* event)
 
 void ReportsWidgetStatistics::calculateStats()
 {
-    const QScopedPointer<DatabaseStats> stats(
-        AsyncTask::runAndWaitForFuture([this] { return new DatabaseStats(m_db); }));
+    // The counters are maintained incrementally and have to be read in the thread of the database
+    const QScopedPointer<DatabaseStats> stats(new DatabaseStats(m_db));
 
     m_referencesModel->clear();
     addStatsRow(tr("Database name"), m_db->metadata()->name());
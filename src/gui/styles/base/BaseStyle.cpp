@@ -31,6 +31,7 @@
 #include <QListView>
 #include <QPainter>
 #include <QPainterPath>
+#include <QPixmapCache>
 #include <QPoint>
 #include <QString>
 #include <QTableView>
@@ -1319,6 +1320,61 @@ namespace Phantom
             }
             return r & rect;
         }
+        // Rounded rects larger than this many device pixels are painted directly,
+        // caching them would cost more memory than the antialiased path is worth.
+        const int MaxCachedRoundRectPixels = 128 * 1024;
+
+        // Rounded frames, focus rings, buttons and scrollbar sliders are drawn with
+        // antialiased paths, which is slow on software rendered or high DPI
+        // displays when many of them are repainted. Paints the rounded rect into a
+        // pixmap cached by its size, radius, device pixel ratio and colors instead,
+        // with the pen and brush of the painter, and draws that pixmap. Returns
+        // false if the painter cannot draw a cached pixmap without changing the
+        // result, so the caller has to paint directly.
+        template <typename PaintFn>
+        bool paintCachedRoundRect(QPainter* p,
+                                  QRect rect,
+                                  qreal radius,
+                                  const QColor& stroke,
+                                  const QColor& fill,
+                                  const char* kind,
+                                  PaintFn&& paintFn)
+        {
+            if (p->transform().type() > QTransform::TxTranslate
+                || p->compositionMode() != QPainter::CompositionMode_SourceOver) {
+                return false;
+            }
+            const qreal dpr = p->device() ? p->device()->devicePixelRatioF() : 1.0;
+            const QSize pixelSize = (QSizeF(rect.size()) * dpr).toSize();
+            if (pixelSize.isEmpty() || pixelSize.width() * pixelSize.height() > MaxCachedRoundRectPixels) {
+                return false;
+            }
+
+            const QString key = QStringLiteral("phantom_%1_%2x%3_%4_%5_%6_%7")
+                                    .arg(QLatin1String(kind))
+                                    .arg(rect.width())
+                                    .arg(rect.height())
+                                    .arg(radius)
+                                    .arg(dpr)
+                                    .arg(stroke.isValid() ? stroke.rgba() : 0u)
+                                    .arg(fill.isValid() ? fill.rgba() : 0u);
+            QPixmap pixmap;
+            if (!QPixmapCache::find(key, &pixmap)) {
+                pixmap = QPixmap(pixelSize);
+                pixmap.setDevicePixelRatio(dpr);
+                pixmap.fill(Qt::transparent);
+                QPainter pixmapPainter(&pixmap);
+                pixmapPainter.setRenderHint(QPainter::Antialiasing);
+                pixmapPainter.setPen(p->pen());
+                pixmapPainter.setBrush(p->brush());
+                paintFn(&pixmapPainter, QRect(QPoint(0, 0), rect.size()));
+                pixmapPainter.end();
+                QPixmapCache::insert(key, pixmap);
+            }
+            p->drawPixmap(rect.topLeft(), pixmap);
+            return true;
+        }
+
         Q_NEVER_INLINE void
         paintSolidRoundRect(QPainter* p, QRect rect, qreal radius, const PhSwatch& swatch, Swatchy fill)
         {
@@ -1330,7 +1386,9 @@ namespace Phantom
                     p->setRenderHint(QPainter::Antialiasing);
                 p->setPen(swatch.pen(SwatchColors::S_none));
                 p->setBrush(swatch.brush(fill));
-                p->drawRoundedRect(rect, radius, radius);
+                auto paint = [radius](QPainter* painter, QRect r) { painter->drawRoundedRect(r, radius, radius); };
+                if (!paintCachedRoundRect(p, rect, radius, QColor(), swatch.color(fill), "solid", paint))
+                    paint(p, rect);
             } else {
                 if (aa)
                     p->setRenderHint(QPainter::Antialiasing, false);
@@ -1354,8 +1412,14 @@ namespace Phantom
                     p->setRenderHint(QPainter::Antialiasing);
                 p->setPen(swatch.pen(stroke));
                 p->setBrush(swatch.brush(fill));
-                QRectF rf(rect.x() + 0.5, rect.y() + 0.5, rect.width() - 1.0, rect.height() - 1.0);
-                p->drawRoundedRect(rf, radius, radius);
+                auto paint = [radius](QPainter* painter, QRect r) {
+                    QRectF rf(r.x() + 0.5, r.y() + 0.5, r.width() - 1.0, r.height() - 1.0);
+                    painter->drawRoundedRect(rf, radius, radius);
+                };
+                const QColor strokeColor = stroke ? swatch.color(stroke) : QColor();
+                const QColor fillColor = fill ? swatch.color(fill) : QColor();
+                if (!paintCachedRoundRect(p, rect, radius, strokeColor, fillColor, "bordered", paint))
+                    paint(p, rect);
             } else {
                 if (aa)
                     p->setRenderHint(QPainter::Antialiasing, false);
@@ -1546,11 +1610,16 @@ void BaseStyle::drawPrimitive(PrimitiveElement elem,
     }
         // Called for the content area on tree view rows that are selected
     case PE_PanelItemViewItem: {
+        // Item backgrounds are plain rects, antialiasing them only costs time
+        Ph::PSave save(painter);
+        painter->setRenderHint(QPainter::Antialiasing, false);
         QCommonStyle::drawPrimitive(elem, option, painter, widget);
         break;
     }
         // Called for left-of-item-content-area on tree view rows that are selected
     case PE_PanelItemViewRow: {
+        Ph::PSave save(painter);
+        painter->setRenderHint(QPainter::Antialiasing, false);
         QCommonStyle::drawPrimitive(elem, option, painter, widget);
         break;
     }
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TagCompletionModel.h"
+
+#include "core/Database.h"
+
+#include <algorithm>
+
+TagCompletionModel::TagCompletionModel(Database* db)
+    : QAbstractListModel(db)
+    , m_db(db)
+{
+    connect(db, &Database::tagListUpdated, this, &TagCompletionModel::resetTags);
+    connect(db, &Database::tagAdded, this, &TagCompletionModel::addTag);
+    connect(db, &Database::tagRemoved, this, &TagCompletionModel::removeTag);
+    resetTags();
+}
+
+/**
+ * Get the completion model of a database, creating it on first use.
+ *
+ * @param db database whose tags are completed
+ * @return model owned by the database
+ */
+TagCompletionModel* TagCompletionModel::forDatabase(Database* db)
+{
+    auto model = db->findChild<TagCompletionModel*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!model) {
+        model = new TagCompletionModel(db);
+    }
+    return model;
+}
+
+int TagCompletionModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_tags.size();
+}
+
+QVariant TagCompletionModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_tags.size()) {
+        return {};
+    }
+    if (role == Qt::DisplayRole || role == Qt::EditRole) {
+        return m_tags.at(index.row());
+    }
+    return {};
+}
+
+void TagCompletionModel::resetTags()
+{
+    beginResetModel();
+    m_tags = m_db->tagList();
+    std::sort(m_tags.begin(), m_tags.end(), lessThan);
+    endResetModel();
+}
+
+void TagCompletionModel::addTag(const QString& tag)
+{
+    const int row = lowerBound(tag);
+    if (row < m_tags.size() && m_tags.at(row) == tag) {
+        return;
+    }
+    beginInsertRows({}, row, row);
+    m_tags.insert(row, tag);
+    endInsertRows();
+}
+
+void TagCompletionModel::removeTag(const QString& tag)
+{
+    const int row = lowerBound(tag);
+    if (row >= m_tags.size() || m_tags.at(row) != tag) {
+        return;
+    }
+    beginRemoveRows({}, row, row);
+    m_tags.removeAt(row);
+    endRemoveRows();
+}
+
+int TagCompletionModel::lowerBound(const QString& tag) const
+{
+    return static_cast<int>(std::lower_bound(m_tags.constBegin(), m_tags.constEnd(), tag, lessThan)
+                            - m_tags.constBegin());
+}
+
+bool TagCompletionModel::lessThan(const QString& tag1, const QString& tag2)
+{
+    // Tags differing in case only are ordered case sensitively, so the order is strict
+    const int result = tag1.compare(tag2, Qt::CaseInsensitive);
+    return result != 0 ? result < 0 : tag1 < tag2;
+}
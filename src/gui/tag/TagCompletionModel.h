@@ -0,0 +1,59 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TAGCOMPLETIONMODEL_H
+#define KEEPASSXC_TAGCOMPLETIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+class Database;
+
+/**
+ * Per database list of the entry tags for completing tags while editing.
+ *
+ * The model is shared by all editors of a database. It follows the tags
+ * announced by the database one by one and keeps them sorted case
+ * insensitively, so that a QCompleter set to QCompleter::CaseInsensitivelySortedModel
+ * finds the completions of a prefix with a binary search.
+ */
+class TagCompletionModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static TagCompletionModel* forDatabase(Database* db);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private slots:
+    void resetTags();
+    void addTag(const QString& tag);
+    void removeTag(const QString& tag);
+
+private:
+    explicit TagCompletionModel(Database* db);
+
+    int lowerBound(const QString& tag) const;
+    static bool lessThan(const QString& tag1, const QString& tag2);
+
+    Database* m_db;
+    QStringList m_tags;
+};
+
+#endif // KEEPASSXC_TAGCOMPLETIONMODEL_H
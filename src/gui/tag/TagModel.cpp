@@ -48,6 +48,8 @@ void TagModel::setDatabase(QSharedPointer<Database> db)
     }
 
     connect(m_db.data(), SIGNAL(tagListUpdated()), SLOT(updateTagList()));
+    connect(m_db.data(), SIGNAL(tagAdded(QString, int)), SLOT(addTag(QString, int)));
+    connect(m_db.data(), SIGNAL(tagRemoved(QString, int)), SLOT(removeTag(QString, int)));
     connect(m_db->metadata()->customData(), SIGNAL(modified()), SLOT(updateTagList()));
 
     updateTagList();
@@ -67,14 +69,43 @@ void TagModel::updateTagList()
 
     m_tagListStart = m_tagList.size();
     for (auto tag : m_db->tagList()) {
-        auto escapedTag = tag;
-        escapedTag.replace("\"", "\\\"");
-        m_tagList << qMakePair(tag, QString("tag:\"%1\"").arg(escapedTag));
+        m_tagList << tagSearch(tag);
     }
 
     endResetModel();
 }
 
+void TagModel::addTag(const QString& tag, int index)
+{
+    int row = m_tagListStart + index;
+    if (row > m_tagList.size()) {
+        updateTagList();
+        return;
+    }
+    beginInsertRows({}, row, row);
+    m_tagList.insert(row, tagSearch(tag));
+    endInsertRows();
+}
+
+void TagModel::removeTag(const QString& tag, int index)
+{
+    int row = m_tagListStart + index;
+    if (row >= m_tagList.size() || m_tagList.at(row).first != tag) {
+        updateTagList();
+        return;
+    }
+    beginRemoveRows({}, row, row);
+    m_tagList.removeAt(row);
+    endRemoveRows();
+}
+
+QPair<QString, QString> TagModel::tagSearch(const QString& tag)
+{
+    auto escapedTag = tag;
+    escapedTag.replace("\"", "\\\"");
+    return qMakePair(tag, QString("tag:\"%1\"").arg(escapedTag));
+}
+
 TagModel::TagType TagModel::itemType(const QModelIndex& index)
 {
     int row = index.row();
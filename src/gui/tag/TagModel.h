@@ -46,8 +46,12 @@ public:
 
 private slots:
     void updateTagList();
+    void addTag(const QString& tag, int index);
+    void removeTag(const QString& tag, int index);
 
 private:
+    static QPair<QString, QString> tagSearch(const QString& tag);
+
     QSharedPointer<Database> m_db;
     QList<QPair<QString, QString>> m_defaultSearches;
     QList<QPair<QString, QString>> m_tagList;
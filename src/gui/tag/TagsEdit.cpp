@@ -906,6 +906,18 @@ void TagsEdit::completion(QStringList const& completions)
     impl->setupCompleter();
 }
 
+void TagsEdit::completionModel(QAbstractItemModel* model)
+{
+    if (impl->completer->model() == model) {
+        return;
+    }
+    impl->completer = std::make_unique<QCompleter>();
+    impl->completer->setModel(model);
+    // Completions of a sorted model are looked up with a binary search
+    impl->completer->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
+    impl->setupCompleter();
+}
+
 void TagsEdit::tags(QStringList const& tags)
 {
     // Set to Default-state.
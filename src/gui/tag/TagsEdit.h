@@ -26,6 +26,8 @@
 
 #include <QAbstractScrollArea>
 
+class QAbstractItemModel;
+
 #include <memory>
 #include <vector>
 
@@ -47,6 +49,9 @@ public:
     /// Set completions
     void completion(QStringList const& completions);
 
+    /// Set a shared completion model, sorted case insensitively and not owned by the editor
+    void completionModel(QAbstractItemModel* model);
+
     /// Set tags
     void tags(QStringList const& tags);
 
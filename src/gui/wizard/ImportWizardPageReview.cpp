@@ -18,6 +18,7 @@
 #include "ImportWizardPageReview.h"
 #include "ui_ImportWizardPageReview.h"
 
+#include "core/AsyncTask.h"
 #include "core/Database.h"
 #include "core/Group.h"
 #include "format/BitwardenReader.h"
@@ -31,15 +32,139 @@
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
 
+#include <QAbstractTableModel>
 #include <QBoxLayout>
+#include <QCollator>
 #include <QDir>
 #include <QHeaderView>
-#include <QTableWidget>
+#include <QTableView>
+#include <QThread>
+
+#include <algorithm>
 
 #include "gui/remote/RemoteSettings.h"
 
 struct RemoteParams;
 
+namespace
+{
+    // Rows added to the preview whenever the view scrolls to its end
+    const int PreviewBatchSize = 256;
+
+    /**
+     * Preview of the imported entries that reads the fields of the shown rows only.
+     */
+    class ImportPreviewModel : public QAbstractTableModel
+    {
+    public:
+        ImportPreviewModel(QList<Entry*> entries, QObject* parent)
+            : QAbstractTableModel(parent)
+            , m_entries(std::move(entries))
+        {
+        }
+
+        int rowCount(const QModelIndex& parent = {}) const override
+        {
+            return parent.isValid() ? 0 : m_loadedRows;
+        }
+
+        int columnCount(const QModelIndex& parent = {}) const override
+        {
+            return parent.isValid() ? 0 : ColumnCount;
+        }
+
+        QVariant data(const QModelIndex& index, int role) const override
+        {
+            if (!index.isValid() || index.row() >= m_loadedRows || role != Qt::DisplayRole) {
+                return {};
+            }
+            return text(m_entries.at(index.row()), index.column());
+        }
+
+        QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+        {
+            if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+                return {};
+            }
+            switch (section) {
+            case Group:
+                return ImportWizardPageReview::tr("Group");
+            case Title:
+                return ImportWizardPageReview::tr("Title");
+            case Username:
+                return ImportWizardPageReview::tr("Username");
+            case Password:
+                return ImportWizardPageReview::tr("Password");
+            case Url:
+                return ImportWizardPageReview::tr("Url");
+            default:
+                return {};
+            }
+        }
+
+        bool canFetchMore(const QModelIndex& parent) const override
+        {
+            return !parent.isValid() && m_loadedRows < m_entries.size();
+        }
+
+        void fetchMore(const QModelIndex& parent) override
+        {
+            if (!canFetchMore(parent)) {
+                return;
+            }
+            const int rows = qMin(PreviewBatchSize, m_entries.size() - m_loadedRows);
+            beginInsertRows({}, m_loadedRows, m_loadedRows + rows - 1);
+            m_loadedRows += rows;
+            endInsertRows();
+        }
+
+        void sort(int column, Qt::SortOrder order) override
+        {
+            // All entries are sorted, rows that are not loaded yet appear in order as the view scrolls
+            emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+            QCollator collator;
+            collator.setNumericMode(true);
+            std::stable_sort(m_entries.begin(), m_entries.end(), [&](const Entry* entry1, const Entry* entry2) {
+                const int result = collator.compare(text(entry1, column), text(entry2, column));
+                return order == Qt::AscendingOrder ? result < 0 : result > 0;
+            });
+            emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+        }
+
+    private:
+        enum Column
+        {
+            Group,
+            Title,
+            Username,
+            Password,
+            Url,
+            ColumnCount
+        };
+
+        static QString text(const Entry* entry, int column)
+        {
+            switch (column) {
+            case Group:
+                return entry->group()->name();
+            case Title:
+                return entry->title();
+            case Username:
+                return entry->username();
+            case Password:
+                return entry->password();
+            case Url:
+                return entry->url();
+            default:
+                return {};
+            }
+        }
+
+        QList<Entry*> m_entries;
+        int m_loadedRows = 0;
+    };
+} // namespace
+
 ImportWizardPageReview::ImportWizardPageReview(QWidget* parent)
     : QWizardPage(parent)
     , m_ui(new Ui::ImportWizardPageReview)
@@ -140,26 +265,12 @@ void ImportWizardPageReview::setupDatabasePreview()
     auto entryList = m_db->rootGroup()->entriesRecursive();
     m_ui->previewLabel->setText(tr("Entry count: %1").arg(entryList.count()));
 
-    QStringList headerLabels({tr("Group"), tr("Title"), tr("Username"), tr("Password"), tr("Url")});
-
-    auto tableWidget = new QTableWidget(entryList.count(), headerLabels.count());
-    tableWidget->setHorizontalHeaderLabels(headerLabels);
-
-    int row = 0;
-    for (auto entry : entryList) {
-        QList items({new QTableWidgetItem(entry->group()->name()),
-                     new QTableWidgetItem(entry->title()),
-                     new QTableWidgetItem(entry->username()),
-                     new QTableWidgetItem(entry->password()),
-                     new QTableWidgetItem(entry->url())});
-        int column = 0;
-        for (auto item : items) {
-            tableWidget->setItem(row, column++, item);
-        }
-        ++row;
-    }
-
+    // Rows are loaded in batches as the preview is scrolled instead of creating items for every entry up front
+    auto tableWidget = new QTableView();
+    tableWidget->setModel(new ImportPreviewModel(entryList, tableWidget));
+    tableWidget->verticalHeader()->hide();
     tableWidget->setSortingEnabled(true);
+    tableWidget->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
     tableWidget->setSelectionMode(QTableWidget::NoSelection);
     tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
     tableWidget->setWordWrap(true);
@@ -170,10 +281,45 @@ void ImportWizardPageReview::setupDatabasePreview()
     m_ui->scrollAreaContents->layout()->addWidget(tableWidget);
 }
 
+/**
+ * Run a streaming import in a worker thread while showing its progress.
+ *
+ * @param import called in the worker with the callback reporting the percentage read
+ * @return imported database, owned by the main thread
+ */
+QSharedPointer<Database> ImportWizardPageReview::runImport(
+    const std::function<QSharedPointer<Database>(const JsonStreamReader::ProgressCallback&)>& import)
+{
+    auto progressBar = new QProgressBar();
+    progressBar->setRange(0, 100);
+    m_ui->scrollAreaContents->layout()->addWidget(progressBar);
+
+    auto progress = [progressBar](int percent) {
+        QMetaObject::invokeMethod(
+            progressBar, [progressBar, percent] { progressBar->setValue(percent); }, Qt::QueuedConnection);
+    };
+
+    auto mainThread = QThread::currentThread();
+    auto db = AsyncTask::runAndWaitForFuture([&] {
+        auto db = import(progress);
+        if (db) {
+            db->moveWithHistoryToThread(mainThread);
+        }
+        return db;
+    });
+
+    // Pending updates are discarded with the progress bar
+    delete progressBar;
+    return db;
+}
+
 QSharedPointer<Database> ImportWizardPageReview::importOPUX(const QString& filename)
 {
     OPUXReader reader;
-    auto db = reader.convert(filename);
+    auto db = runImport([&](const JsonStreamReader::ProgressCallback& progress) {
+        reader.setProgressCallback(progress);
+        return reader.convert(filename);
+    });
     if (reader.hasError()) {
         m_ui->messageWidget->showMessage(reader.errorString(), KMessageWidget::Error, -1);
     }
@@ -183,7 +329,10 @@ QSharedPointer<Database> ImportWizardPageReview::importOPUX(const QString& filen
 QSharedPointer<Database> ImportWizardPageReview::importBitwarden(const QString& filename, const QString& password)
 {
     BitwardenReader reader;
-    auto db = reader.convert(filename, password);
+    auto db = runImport([&](const JsonStreamReader::ProgressCallback& progress) {
+        reader.setProgressCallback(progress);
+        return reader.convert(filename, password);
+    });
     if (reader.hasError()) {
         m_ui->messageWidget->showMessage(reader.errorString(), KMessageWidget::Error, -1);
     }
@@ -26,6 +26,7 @@
 #include <QStatusBar>
 
 #include "../remote/RemoteHandler.h"
+#include "format/JsonStreamReader.h"
 
 class CsvImportWidget;
 class Database;
@@ -50,6 +51,8 @@ public:
 
 private:
     void setupCsvImport(const QString& filename);
+    QSharedPointer<Database>
+    runImport(const std::function<QSharedPointer<Database>(const JsonStreamReader::ProgressCallback&)>& import);
     QSharedPointer<Database> importOPUX(const QString& filename);
     QSharedPointer<Database> importBitwarden(const QString& filename, const QString& password);
     QSharedPointer<Database> importOPVault(const QString& filename, const QString& password);
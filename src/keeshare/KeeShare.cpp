@@ -23,9 +23,13 @@
 #include "gui/DatabaseIcons.h"
 #include "keeshare/ShareObserver.h"
 
+#include <QDir>
+
 namespace
 {
     static const QString KeeShare_Reference("KeeShare/Reference");
+    // Namespace of the transformed key cache slots of share containers
+    static const QUuid KeeShare_KeyCacheNamespace("{b5f0cf52-6a3e-4d0e-9a4b-7f2c1d8e3a61}");
 }
 
 KeeShare* KeeShare::m_instance = nullptr;
@@ -252,3 +256,17 @@ const QString KeeShare::containerFileName()
     static const QString fileName("container.share.kdbx");
     return fileName;
 }
+
+/**
+ * Get the slot of a share container in the TransformedKeyCache.
+ *
+ * Imports and exports of the same container share the slot, so importing a
+ * container right after it was exported does not run the KDF again.
+ *
+ * @param resolvedPath absolute path of the container
+ * @return uuid of the container in the cache
+ */
+QUuid KeeShare::keyCacheUuid(const QString& resolvedPath)
+{
+    return QUuid::createUuidV5(KeeShare_KeyCacheNamespace, QDir::cleanPath(resolvedPath));
+}
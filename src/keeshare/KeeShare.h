@@ -72,6 +72,8 @@ public:
 
     static const QString signatureFileName();
     static const QString containerFileName();
+
+    static QUuid keyCacheUuid(const QString& resolvedPath);
 signals:
     void activeChanged();
     void sharingMessage(QString, MessageWidget::MessageType);
@@ -26,6 +26,8 @@
 #include "keys/PasswordKey.h"
 
 #include <QBuffer>
+#include <QCryptographicHash>
+#include <QSaveFile>
 #include <botan/pubkey.h>
 #include <minizip/zip.h>
 
@@ -62,10 +64,16 @@ namespace
         }
     }
 
-    Database* extractIntoDatabase(const KeeShareSettings::Reference& reference, const Group* sourceRoot)
+    Database* extractIntoDatabase(const QString& resolvedPath,
+                                  const KeeShareSettings::Reference& reference,
+                                  const Group* sourceRoot,
+                                  const QSharedPointer<const Kdf>& kdf)
     {
         const auto* sourceDb = sourceRoot->database();
         auto* targetDb = new Database();
+        if (kdf) {
+            targetDb->setKdf(kdf->clone());
+        }
         auto* targetMetadata = targetDb->metadata();
         targetMetadata->setRecycleBinEnabled(false);
 
@@ -90,7 +98,10 @@ namespace
 
         auto key = QSharedPointer<CompositeKey>::create();
         key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
-        targetDb->setKey(key);
+        // The next import of the container and the next export find the derived key,
+        // it is derived when the export is written
+        key->setTransformedKeyCache(KeeShare::keyCacheUuid(resolvedPath));
+        targetDb->setKey(key, true, false, false);
 
         auto obsoleteRoot = targetDb->setRootGroup(targetRoot);
         delete obsoleteRoot;
@@ -157,11 +168,58 @@ namespace
     }
 } // namespace
 
-ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
-                                                 const KeeShareSettings::Reference& reference,
-                                                 const Group* group)
+/**
+ * Copy a shared group into its own export database.
+ *
+ * Runs on the thread of the source database, the snapshot can be written by
+ * intoContainer() on any thread afterwards.
+ *
+ * @param resolvedPath path of the export container
+ * @param reference export settings of the group
+ * @param group root of the exported subtree
+ * @param kdf KDF of the last export of the share, its seed is kept so the derived key is reused
+ * @return export database with the settings to write it
+ */
+ShareExport::Snapshot ShareExport::snapshot(const QString& resolvedPath,
+                                            const KeeShareSettings::Reference& reference,
+                                            const Group* group,
+                                            const QSharedPointer<const Kdf>& kdf)
+{
+    Snapshot snapshot;
+    snapshot.resolvedPath = resolvedPath;
+    snapshot.reference = reference;
+    snapshot.db.reset(extractIntoDatabase(resolvedPath, reference, group, kdf));
+    // Deferred attachments are read from the source database file, which is not done on worker threads
+    snapshot.db->rootGroup()->forEachEntryRecursive(
+        [&snapshot](const Entry* entry) { return entry->attachments()->loadDeferred(&snapshot.error); }, true);
+    if (resolvedPath.endsWith(".kdbx.share")) {
+        // Get Own Certificate for signing
+        snapshot.own = KeeShare::own();
+        Q_ASSERT(!snapshot.own.isNull());
+    }
+    return snapshot;
+}
+
+/**
+ * Serialize, sign and write an export container.
+ *
+ * The snapshot is not shared with anything else, so exports of different
+ * shares may be written concurrently in worker threads.
+ *
+ * @param snapshot result of snapshot()
+ * @return result of the export
+ */
+ShareObserver::Result ShareExport::intoContainer(const Snapshot& snapshot)
 {
-    QScopedPointer<Database> targetDb(extractIntoDatabase(reference, group));
+    const auto& resolvedPath = snapshot.resolvedPath;
+    const auto& reference = snapshot.reference;
+    if (!snapshot.error.isEmpty()) {
+        return {reference.path, ShareObserver::Result::Error, snapshot.error};
+    }
+
+    KeePass2Writer writer;
+    writer.setKeepKdfSeed(true);
+
     if (resolvedPath.endsWith(".kdbx.share")) {
         // Write database to memory and sign it
         QByteArray dbData, signatureData;
@@ -170,22 +228,17 @@ ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
         buffer.setBuffer(&dbData);
         buffer.open(QIODevice::WriteOnly);
 
-        KeePass2Writer writer;
-        if (!writer.writeDatabase(&buffer, targetDb.data())) {
+        if (!writer.writeDatabase(&buffer, snapshot.db.data())) {
             qWarning("Serializing export database failed: %s.", writer.errorString().toLatin1().data());
             return {reference.path, ShareObserver::Result::Error, writer.errorString()};
         }
 
         buffer.close();
 
-        // Get Own Certificate for signing
-        const auto own = KeeShare::own();
-        Q_ASSERT(!own.isNull());
-
         // Sign the database data
         KeeShareSettings::Sign sign;
-        sign.certificate = own.certificate;
-        signData(dbData, own.key, sign.signature);
+        sign.certificate = snapshot.own.certificate;
+        signData(dbData, snapshot.own.key, sign.signature);
 
         signatureData = KeeShareSettings::Sign::serialize(sign).toLatin1();
 
@@ -199,8 +252,10 @@ ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
 
         zipClose(zf, nullptr);
     } else {
-        QString error;
-        if (!targetDb->saveAs(resolvedPath, Database::Atomic, {}, &error)) {
+        // Written like an atomic save, the export database has no file, backup or journal of its own
+        QSaveFile file(resolvedPath);
+        if (!file.open(QIODevice::WriteOnly) || !writer.writeDatabase(&file, snapshot.db.data()) || !file.commit()) {
+            const auto error = writer.hasError() ? writer.errorString() : file.errorString();
             qWarning("Exporting database failed: %s.", error.toLatin1().data());
             return {resolvedPath, ShareObserver::Result::Error, error};
         }
@@ -208,3 +263,49 @@ ShareObserver::Result ShareExport::intoContainer(const QString& resolvedPath,
 
     return {resolvedPath};
 }
+
+/**
+ * Fingerprint the content an export of a group would write.
+ *
+ * Records the reference, the structure of the exported subtree together with
+ * the modification counters of its groups and entries, and the deletions of
+ * the source database. The counters also change while modified signals are
+ * blocked, so the fingerprint changes with every edit below the share.
+ *
+ * @param resolvedPath path of the export container
+ * @param reference export settings of the group
+ * @param group root of the exported subtree
+ * @return fingerprint, empty if the export has to be written on every save
+ */
+QByteArray ShareExport::fingerprint(const QString& resolvedPath,
+                                    const KeeShareSettings::Reference& reference,
+                                    const Group* group)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(resolvedPath.toUtf8());
+    hash.addData(KeeShareSettings::Reference::serialize(reference).toUtf8());
+    if (resolvedPath.endsWith(".kdbx.share")) {
+        hash.addData(KeeShare::own().certificate.fingerprint().toUtf8());
+    }
+
+    auto addObject = [&hash](const QUuid& uuid, quint64 count, const QDateTime& lastModified) {
+        hash.addData(uuid.toRfc4122());
+        hash.addData(QByteArray::number(count));
+        hash.addData(QByteArray::number(lastModified.toMSecsSinceEpoch()));
+    };
+
+    for (const auto* child : group->groupsRecursive(true)) {
+        addObject(child->uuid(), child->modificationCount(), child->timeInfo().lastModificationTime());
+        for (const auto* entry : child->entries()) {
+            // Resolved references depend on entries outside of the share
+            if (entry->hasReferences()) {
+                return {};
+            }
+            addObject(entry->uuid(), entry->dataModificationCount(), entry->timeInfo().lastModificationTime());
+        }
+    }
+
+    const auto* sourceDb = group->database();
+    hash.addData(QByteArray::number(sourceDb ? sourceDb->deletedObjects().size() : 0));
+    return hash.result();
+}
@@ -22,13 +22,30 @@
 #include "keeshare/ShareObserver.h"
 
 class Database;
+class Kdf;
 
 class ShareExport
 {
     Q_DECLARE_TR_FUNCTIONS(ShareExport)
 public:
-    static ShareObserver::Result
-    intoContainer(const QString& resolvedPath, const KeeShareSettings::Reference& reference, const Group* group);
+    // Export database of a share that no longer depends on the source database
+    struct Snapshot
+    {
+        QString resolvedPath;
+        KeeShareSettings::Reference reference;
+        QSharedPointer<Database> db;
+        KeeShareSettings::Own own;
+        // Reason the export database cannot be written, e.g. an attachment that could not be read
+        QString error;
+    };
+
+    static Snapshot snapshot(const QString& resolvedPath,
+                             const KeeShareSettings::Reference& reference,
+                             const Group* group,
+                             const QSharedPointer<const Kdf>& kdf = {});
+    static ShareObserver::Result intoContainer(const Snapshot& snapshot);
+    static QByteArray
+    fingerprint(const QString& resolvedPath, const KeeShareSettings::Reference& reference, const Group* group);
 
 private:
     ShareExport() = delete;
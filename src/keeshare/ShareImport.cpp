@@ -16,11 +16,13 @@
  */
 #include "ShareImport.h"
 #include "core/Merger.h"
+#include "crypto/CryptoHash.h"
 #include "format/KeePass2Reader.h"
 #include "keeshare/KeeShare.h"
 #include "keys/PasswordKey.h"
 
 #include <QBuffer>
+#include <QThread>
 #include <minizip/unzip.h>
 
 namespace
@@ -43,9 +45,22 @@ namespace
     }
 } // namespace
 
-ShareObserver::Result ShareImport::containerInto(const QString& resolvedPath,
-                                                 const KeeShareSettings::Reference& reference,
-                                                 Group* targetGroup)
+/**
+ * Read and decrypt a share container.
+ *
+ * Does not touch the target database and may run in a worker thread.
+ *
+ * @param resolvedPath path of the container
+ * @param reference import settings of the share
+ * @param thread thread the read database is handed over to
+ * @param importedHash content hash of the last container imported from the path
+ * @return read database, or the error of reading it,
+ *         neither of them if the container was not changed since its last import
+ */
+ShareImport::Source ShareImport::readContainer(const QString& resolvedPath,
+                                               const KeeShareSettings::Reference& reference,
+                                               QThread* thread,
+                                               const QByteArray& importedHash)
 {
     QByteArray dbData;
 
@@ -67,32 +82,59 @@ ShareObserver::Result ShareImport::containerInto(const QString& resolvedPath,
         QFile file(resolvedPath);
         if (!file.open(QIODevice::ReadOnly)) {
             qCritical("Unable to open file %s.", qPrintable(reference.path));
-            return {reference.path, ShareObserver::Result::Error, file.errorString()};
+            return {{}, {reference.path, ShareObserver::Result::Error, file.errorString()}};
         }
         dbData = file.readAll();
         file.close();
     }
 
+    // Sync clients often touch shares without changing them, these skip the key derivation and merge
+    const auto contentHash = CryptoHash::hash(dbData, CryptoHash::Sha256);
+    if (!importedHash.isEmpty() && contentHash == importedHash) {
+        return {{}, {}, contentHash};
+    }
+
     QBuffer buffer(&dbData);
     buffer.open(QIODevice::ReadOnly);
 
     KeePass2Reader reader;
     auto key = QSharedPointer<CompositeKey>::create();
     key->addKey(QSharedPointer<PasswordKey>::create(reference.password));
+    // Shares are imported again on every change, usually with the same password and seed
+    key->setTransformedKeyCache(KeeShare::keyCacheUuid(resolvedPath));
     auto sourceDb = QSharedPointer<Database>::create();
     sourceDb->setEmitModified(false);
     if (!reader.readDatabase(&buffer, key, sourceDb.data())) {
         qCritical("Error while parsing the database: %s", qPrintable(reader.errorString()));
-        return {reference.path, ShareObserver::Result::Error, reader.errorString()};
+        return {{}, {reference.path, ShareObserver::Result::Error, reader.errorString()}, contentHash};
     }
     sourceDb->setEmitModified(true);
+    sourceDb->moveWithHistoryToThread(thread);
+
+    return {sourceDb, {}, contentHash};
+}
+
+/**
+ * Synchronize a group with a read share container.
+ *
+ * @param source result of readContainer()
+ * @param reference import settings of the share
+ * @param targetGroup group the share is imported into
+ * @return result of the import
+ */
+ShareObserver::Result
+ShareImport::mergeInto(const Source& source, const KeeShareSettings::Reference& reference, Group* targetGroup)
+{
+    if (!source.db) {
+        return source.result;
+    }
 
     qDebug("Synchronize %s %s with %s",
            qPrintable(reference.path),
            qPrintable(targetGroup->name()),
-           qPrintable(sourceDb->rootGroup()->name()));
+           qPrintable(source.db->rootGroup()->name()));
 
-    Merger merger(sourceDb->rootGroup(), targetGroup);
+    Merger merger(source.db->rootGroup(), targetGroup);
     merger.setForcedMergeMode(Group::Synchronize);
     merger.setSkipDatabaseCustomData(true);
     auto changelist = merger.merge();
@@ -21,12 +21,27 @@
 
 #include "keeshare/ShareObserver.h"
 
+class QThread;
+
 class ShareImport
 {
     Q_DECLARE_TR_FUNCTIONS(ShareImport)
 public:
+    struct Source
+    {
+        QSharedPointer<Database> db;
+        // Error of reading the container, only valid without a database
+        ShareObserver::Result result;
+        // Hash of the embedded database, set whenever it could be read
+        QByteArray contentHash;
+    };
+
+    static Source readContainer(const QString& resolvedPath,
+                                const KeeShareSettings::Reference& reference,
+                                QThread* thread,
+                                const QByteArray& importedHash = QByteArray());
     static ShareObserver::Result
-    containerInto(const QString& resolvedPath, const KeeShareSettings::Reference& reference, Group* targetGroup);
+    mergeInto(const Source& source, const KeeShareSettings::Reference& reference, Group* targetGroup);
 
 public:
     ShareImport() = delete;
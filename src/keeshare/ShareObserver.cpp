@@ -16,6 +16,7 @@
  */
 
 #include "ShareObserver.h"
+#include "core/AsyncTask.h"
 #include "core/FileWatcher.h"
 #include "core/Group.h"
 #include "keeshare/KeeShare.h"
@@ -34,12 +35,18 @@ namespace
 
     constexpr int FileWatchPeriod = 30;
     constexpr int FileWatchSize = 5;
+    // Changes of share files within this time are imported together, in ms
+    constexpr int ImportDelay = 500;
 } // End Namespace
 
 ShareObserver::ShareObserver(QSharedPointer<Database> db, QObject* parent)
     : QObject(parent)
     , m_db(std::move(db))
 {
+    m_importTimer.setSingleShot(true);
+    m_importTimer.setInterval(ImportDelay);
+    connect(&m_importTimer, &QTimer::timeout, this, &ShareObserver::startImports);
+
     connect(KeeShare::instance(), &KeeShare::activeChanged, this, &ShareObserver::handleDatabaseChanged);
 
     connect(m_db.data(), &Database::groupDataChanged, this, &ShareObserver::handleDatabaseChanged);
@@ -48,6 +55,17 @@ ShareObserver::ShareObserver(QSharedPointer<Database> db, QObject* parent)
 
     connect(m_db.data(), &Database::modified, this, &ShareObserver::handleDatabaseChanged);
     connect(m_db.data(), &Database::databaseSaved, this, &ShareObserver::handleDatabaseSaved);
+    // Modification counters start over with the objects of a reloaded database
+    connect(m_db.data(), &Database::databaseOpened, this, [this] {
+        m_exportStates.clear();
+        m_exportKdfs.clear();
+        m_importHashes.clear();
+    });
+    connect(m_db.data(), &Database::databaseDiscarded, this, [this] {
+        m_exportStates.clear();
+        m_exportKdfs.clear();
+        m_importHashes.clear();
+    });
 
     handleDatabaseChanged();
 }
@@ -62,6 +80,9 @@ void ShareObserver::deinitialize()
     m_groupToReference.clear();
     m_shareToGroup.clear();
     m_fileWatchers.clear();
+    m_exportStates.clear();
+    m_exportKdfs.clear();
+    m_importHashes.clear();
 }
 
 void ShareObserver::reinitialize()
@@ -78,11 +99,15 @@ void ShareObserver::reinitialize()
         m_groupToReference.remove(group);
         m_shareToGroup.remove(oldResolvedPath);
         m_fileWatchers.remove(oldResolvedPath);
+        // A changed password or target group is imported again, exports draw a new seed
+        m_importHashes.remove(oldResolvedPath);
+        m_exportKdfs.remove(oldResolvedPath);
 
         if (newReference.isValid()) {
             m_groupToReference[group] = newReference;
             const auto newResolvedPath = resolvePath(newReference.path, m_db);
             m_shareToGroup[newResolvedPath] = group;
+            m_importHashes.remove(newResolvedPath);
         }
 
         shares.append({group, newReference});
@@ -186,29 +211,96 @@ void ShareObserver::handleDatabaseChanged()
 
 void ShareObserver::handleFileUpdated(const QString& path)
 {
-    if (!m_inFileUpdate) {
-        QTimer::singleShot(100, this, [this, path] {
-            const Result result = importShare(path);
-            m_inFileUpdate = false;
-            if (!result.isValid()) {
-                return;
-            }
-            QStringList success;
-            QStringList warning;
-            QStringList error;
-            if (result.isError()) {
-                error << tr("Import from %1 failed (%2)").arg(result.path, result.message);
-            } else if (result.isWarning()) {
-                warning << tr("Import from %1 failed (%2)").arg(result.path, result.message);
-            } else if (result.isInfo()) {
-                success << tr("Import from %1 successful (%2)").arg(result.path, result.message);
-            } else {
-                success << tr("Imported from %1").arg(result.path);
-            }
-            notifyAbout(success, warning, error);
-        });
-        m_inFileUpdate = true;
+    // Sync clients often replace several share files at once or write a file in steps
+    m_pendingImports.insert(path);
+    m_importTimer.start();
+}
+
+/**
+ * Import the changed share files.
+ *
+ * The containers are read and decrypted concurrently in worker threads, each
+ * one is merged on this thread as soon as it is read. The results of all
+ * imports are reported together once the last one finished.
+ */
+void ShareObserver::startImports()
+{
+    if (!KeeShare::active().in) {
+        m_pendingImports.clear();
+        return;
+    }
+
+    const auto paths = m_pendingImports;
+    for (const auto& path : paths) {
+        // A file changing again while it is read is imported after the running import
+        if (m_runningImports.contains(path)) {
+            continue;
+        }
+        m_pendingImports.remove(path);
+
+        const auto resolvedPath = resolvePath(path, m_db);
+        QPointer<Group> shareGroup = m_shareToGroup.value(resolvedPath);
+        if (!shareGroup) {
+            qWarning("Group for %s does not exist", qPrintable(path));
+            continue;
+        }
+        const auto reference = KeeShare::referenceOf(shareGroup);
+        if (!reference.isImporting()) {
+            // changes of inactive and export only references are ignored
+            continue;
+        }
+
+        m_runningImports.insert(path);
+        auto mainThread = thread();
+        const auto importedHash = m_importHashes.value(resolvedPath);
+        AsyncTask::runThenCallback(
+            [resolvedPath, reference, mainThread, importedHash] {
+                return ShareImport::readContainer(resolvedPath, reference, mainThread, importedHash);
+            },
+            this,
+            [this, path, resolvedPath, shareGroup, reference](const ShareImport::Source& source) {
+                Result result;
+                // The group may have been deleted or reconfigured while the container was read
+                if (shareGroup && KeeShare::referenceOf(shareGroup) == reference) {
+                    result = ShareImport::mergeInto(source, reference, shareGroup);
+                    if (source.db && !result.isError()) {
+                        m_importHashes.insert(resolvedPath, source.contentHash);
+                    }
+                }
+                finishImport(path, result);
+            });
+    }
+}
+
+void ShareObserver::finishImport(const QString& path, const Result& result)
+{
+    m_runningImports.remove(path);
+    if (result.isValid()) {
+        m_importResults << result;
+    }
+    if (m_pendingImports.contains(path)) {
+        m_importTimer.start();
+    }
+    if (!m_runningImports.isEmpty()) {
+        return;
+    }
+
+    QStringList success;
+    QStringList warning;
+    QStringList error;
+    for (const auto& importResult : asConst(m_importResults)) {
+        if (importResult.isError()) {
+            error << tr("Import from %1 failed (%2)").arg(importResult.path, importResult.message);
+        } else if (importResult.isWarning()) {
+            warning << tr("Import from %1 failed (%2)").arg(importResult.path, importResult.message);
+        } else if (importResult.isInfo()) {
+            success << tr("Import from %1 successful (%2)").arg(importResult.path, importResult.message);
+        } else {
+            success << tr("Imported from %1").arg(importResult.path);
+        }
     }
+    m_importResults.clear();
+    notifyAbout(success, warning, error);
 }
 
 ShareObserver::Result ShareObserver::importShare(const QString& path)
@@ -235,7 +327,13 @@ ShareObserver::Result ShareObserver::importShare(const QString& path)
     Q_ASSERT(shareGroup->database() == m_db);
     Q_ASSERT(shareGroup == m_db->rootGroup()->findGroupByUuid(shareGroup->uuid()));
     const auto resolvedPath = resolvePath(reference.path, m_db);
-    return ShareImport::containerInto(resolvedPath, reference, shareGroup);
+    const auto source =
+        ShareImport::readContainer(resolvedPath, reference, thread(), m_importHashes.value(resolvedPath));
+    const auto result = ShareImport::mergeInto(source, reference, shareGroup);
+    if (source.db && !result.isError()) {
+        m_importHashes.insert(resolvedPath, source.contentHash);
+    }
+    return result;
 }
 
 QSharedPointer<Database> ShareObserver::database()
@@ -278,35 +376,105 @@ QList<ShareObserver::Result> ShareObserver::exportShares()
         return results;
     }
 
+    QList<ShareExport::Snapshot> snapshots;
+    QList<QByteArray> fingerprints;
     for (auto it = references.cbegin(); it != references.cend(); ++it) {
         auto reference = it.value().first();
         const QString resolvedPath = resolvePath(reference.config.path, m_db);
-        auto watcher = m_fileWatchers.value(resolvedPath);
+        // Unchanged shares are not exported again
+        const auto fingerprint = ShareExport::fingerprint(resolvedPath, reference.config, reference.group);
+        if (isExported(resolvedPath, fingerprint)) {
+            continue;
+        }
+
+        // TODO: save new path into group settings if not saving to signed container anymore
+        snapshots << ShareExport::snapshot(
+            resolvedPath, reference.config, reference.group, m_exportKdfs.value(resolvedPath));
+        fingerprints << fingerprint;
+    }
+    if (snapshots.isEmpty()) {
+        return results;
+    }
+
+    for (const auto& snapshot : asConst(snapshots)) {
+        auto watcher = m_fileWatchers.value(snapshot.resolvedPath);
         if (watcher) {
             watcher->stop();
         }
+    }
 
-        // TODO: save new path into group settings if not saving to signed container anymore
-        results << ShareExport::intoContainer(resolvedPath, reference.config, reference.group);
+    // The containers are written concurrently, the snapshots are released on this thread afterwards
+    auto future = QtConcurrent::mapped(snapshots, &ShareExport::intoContainer);
+    AsyncTask::waitForFuture(future);
+    const auto exportResults = future.results();
+
+    for (int i = 0; i < snapshots.size(); ++i) {
+        const auto& snapshot = snapshots.at(i);
+        const auto& result = exportResults.at(i);
+        results << result;
 
+        const QFileInfo info(snapshot.resolvedPath);
+        if (result.isError() || fingerprints.at(i).isEmpty() || !info.exists()) {
+            m_exportStates.remove(snapshot.resolvedPath);
+        } else {
+            m_exportStates.insert(snapshot.resolvedPath, {fingerprints.at(i), info.lastModified(), info.size()});
+        }
+        if (result.isError()) {
+            m_exportKdfs.remove(snapshot.resolvedPath);
+        } else {
+            m_exportKdfs.insert(snapshot.resolvedPath, snapshot.db->kdf());
+        }
+
+        auto watcher = m_fileWatchers.value(snapshot.resolvedPath);
         if (watcher) {
-            watcher->start(resolvedPath, FileWatchPeriod, FileWatchSize);
+            watcher->start(snapshot.resolvedPath, FileWatchPeriod, FileWatchSize);
         }
     }
     return results;
 }
 
+/**
+ * @param resolvedPath path of the export container
+ * @param fingerprint current fingerprint of the share
+ * @return true if the container holds the last export of an unchanged share
+ */
+bool ShareObserver::isExported(const QString& resolvedPath, const QByteArray& fingerprint) const
+{
+    if (fingerprint.isEmpty()) {
+        return false;
+    }
+    const auto state = m_exportStates.constFind(resolvedPath);
+    if (state == m_exportStates.constEnd() || state->fingerprint != fingerprint) {
+        return false;
+    }
+    // The container may have been replaced or removed by someone else
+    const QFileInfo info(resolvedPath);
+    return info.exists() && info.lastModified() == state->lastModified && info.size() == state->size;
+}
+
 void ShareObserver::handleDatabaseSaved()
 {
     if (!KeeShare::active().out) {
         return;
     }
+    // Exports wait for a background thread, a save in the meantime is exported afterwards
+    if (m_inExport) {
+        m_exportPending = true;
+        return;
+    }
     QStringList error;
     QStringList warning;
     QStringList success;
 
-    const auto results = exportShares();
-    for (const Result& result : results) {
+    QList<Result> results;
+    m_inExport = true;
+    do {
+        m_exportPending = false;
+        results << exportShares();
+    } while (m_exportPending);
+    m_inExport = false;
+
+    for (const Result& result : asConst(results)) {
         if (!result.isValid()) {
             Q_ASSERT(result.isValid());
             continue;
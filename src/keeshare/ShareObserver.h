@@ -18,8 +18,12 @@
 #ifndef KEEPASSXC_SHAREOBSERVER_H
 #define KEEPASSXC_SHAREOBSERVER_H
 
+#include <QDateTime>
+#include <QHash>
 #include <QMap>
 #include <QObject>
+#include <QSet>
+#include <QTimer>
 
 #include "gui/MessageWidget.h"
 #include "keeshare/KeeShareSettings.h"
@@ -27,6 +31,7 @@
 class FileWatcher;
 class Group;
 class Database;
+class Kdf;
 
 class ShareObserver : public QObject
 {
@@ -67,21 +72,44 @@ private slots:
     void handleDatabaseChanged();
     void handleDatabaseSaved();
     void handleFileUpdated(const QString& path);
+    void startImports();
 
 private:
     Result importShare(const QString& path);
+    void finishImport(const QString& path, const Result& result);
     QList<Result> exportShares();
 
     void deinitialize();
     void reinitialize();
     void notifyAbout(const QStringList& success, const QStringList& warning, const QStringList& error);
 
+    bool isExported(const QString& resolvedPath, const QByteArray& fingerprint) const;
+
 private:
+    struct ExportState
+    {
+        QByteArray fingerprint;
+        QDateTime lastModified;
+        qint64 size = 0;
+    };
+
     QSharedPointer<Database> m_db;
     QMap<QPointer<Group>, KeeShareSettings::Reference> m_groupToReference;
     QMap<QString, QPointer<Group>> m_shareToGroup;
     QMap<QString, QSharedPointer<FileWatcher>> m_fileWatchers;
-    bool m_inFileUpdate = false;
+    // Fingerprints of the shares at their last successful export
+    QHash<QString, ExportState> m_exportStates;
+    // KDFs of the last exports, their seeds are kept to reuse the derived keys
+    QHash<QString, QSharedPointer<const Kdf>> m_exportKdfs;
+    // Content hashes of the containers at their last successful import
+    QHash<QString, QByteArray> m_importHashes;
+    // Changed share files waiting for the import timer and imports reading a container
+    QSet<QString> m_pendingImports;
+    QSet<QString> m_runningImports;
+    QTimer m_importTimer;
+    QList<Result> m_importResults;
+    bool m_inExport = false;
+    bool m_exportPending = false;
 };
 
 #endif // KEEPASSXC_SHAREOBSERVER_H
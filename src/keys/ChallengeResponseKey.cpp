@@ -48,19 +48,42 @@ QString ChallengeResponseKey::error() const
     return m_error;
 }
 
+/**
+ * Challenge the key, the response of the last challenge is kept and answered
+ * from memory when the same challenge is issued again.
+ *
+ * @param challenge challenge to send to the device
+ * @return true on success
+ */
 bool ChallengeResponseKey::challenge(const QByteArray& challenge)
 {
     m_error.clear();
+    if (hasResponse(challenge)) {
+        return true;
+    }
+
     auto result =
         AsyncTask::runAndWaitForFuture([&] { return YubiKey::instance()->challenge(m_keySlot, challenge, m_key); });
 
     if (result != YubiKey::ChallengeResult::YCR_SUCCESS) {
         // Record the error message
         m_key.clear();
+        m_challenge.clear();
         m_error = YubiKey::instance()->errorMessage();
+        return false;
     }
 
-    return result == YubiKey::ChallengeResult::YCR_SUCCESS;
+    m_challenge = challenge;
+    return true;
+}
+
+/**
+ * @param challenge challenge to look up
+ * @return true if the key answered this challenge last, so challenge() does not need the device
+ */
+bool ChallengeResponseKey::hasResponse(const QByteArray& challenge) const
+{
+    return !m_key.empty() && !challenge.isEmpty() && m_challenge == challenge;
 }
 
 QByteArray ChallengeResponseKey::serialize() const
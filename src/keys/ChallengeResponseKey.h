@@ -33,6 +33,7 @@ public:
     YubiKeySlot slotData() const;
 
     virtual bool challenge(const QByteArray& challenge);
+    virtual bool hasResponse(const QByteArray& challenge) const;
     QString error() const;
 
     QByteArray serialize() const override;
@@ -45,6 +46,7 @@ private:
 
     QString m_error;
     Botan::secure_vector<char> m_key;
+    QByteArray m_challenge;
     YubiKeySlot m_keySlot;
 };
 
@@ -18,12 +18,14 @@
 
 #include "CompositeKey.h"
 
+#include "core/PerformanceStats.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/kdf/Kdf.h"
 #include "format/KeePass2.h"
 #include "keys/ChallengeResponseKey.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
 
 #include <QDataStream>
 #include <QDebug>
@@ -122,13 +124,64 @@ bool CompositeKey::transform(const Kdf& kdf, QByteArray& result, QString* error)
 {
     if (kdf.uuid() == KeePass2::KDF_AES_KDBX3) {
         // legacy KDBX3 AES-KDF, challenge response is added later to the hash
-        return kdf.transform(rawKey(), result);
+        return transformRawKey(kdf, rawKey(), result);
     }
 
     QByteArray seed = kdf.seed();
     Q_ASSERT(!seed.isEmpty());
     bool ok = false;
-    return kdf.transform(rawKey(&seed, &ok, error), result) && ok;
+    QByteArray key = rawKey(&seed, &ok, error);
+    return ok && transformRawKey(kdf, key, result);
+}
+
+/**
+ * Whether all challenge-response keys can answer a seed without their device,
+ * because it is the seed they answered last.
+ *
+ * @param seed transform seed
+ * @return true if there are challenge-response keys and all of them answered the seed
+ */
+bool CompositeKey::isChallengeAnswered(const QByteArray& seed) const
+{
+    if (m_challengeResponseKeys.isEmpty()) {
+        return false;
+    }
+    for (const auto& key : m_challengeResponseKeys) {
+        if (!key->hasResponse(seed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Keep the transformed key in the in-memory TransformedKeyCache so that
+ * transforming the same key with the same KDF parameters again, e.g. when
+ * re-opening a database with quick unlock, does not run the KDF again.
+ *
+ * @param databaseUuid public uuid of the database this key belongs to, a null uuid disables the cache
+ */
+void CompositeKey::setTransformedKeyCache(const QUuid& databaseUuid)
+{
+    m_cacheDatabaseUuid = databaseUuid;
+}
+
+bool CompositeKey::transformRawKey(const Kdf& kdf, const QByteArray& key, QByteArray& result) const
+{
+    PerformanceStats::ScopedTimer timer("key.transform");
+
+    if (m_cacheDatabaseUuid.isNull()) {
+        return kdf.transform(key, result);
+    }
+
+    if (transformedKeyCache()->get(m_cacheDatabaseUuid, kdf, key, result)) {
+        return true;
+    }
+    if (!kdf.transform(key, result)) {
+        return false;
+    }
+    transformedKeyCache()->insert(m_cacheDatabaseUuid, kdf, key, result);
+    return true;
 }
 
 bool CompositeKey::challenge(const QByteArray& seed, QByteArray& result, QString* error) const
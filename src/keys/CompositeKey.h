@@ -41,6 +41,8 @@ public:
 
     Q_REQUIRED_RESULT bool transform(const Kdf& kdf, QByteArray& result, QString* error = nullptr) const;
     bool challenge(const QByteArray& seed, QByteArray& result, QString* error = nullptr) const;
+    bool isChallengeAnswered(const QByteArray& seed) const;
+    void setTransformedKeyCache(const QUuid& databaseUuid);
 
     void addKey(const QSharedPointer<Key>& key);
     QSharedPointer<Key> getKey(const QUuid keyType) const;
@@ -55,9 +57,11 @@ public:
 
 private:
     QByteArray rawKey(const QByteArray* transformSeed, bool* ok = nullptr, QString* error = nullptr) const;
+    bool transformRawKey(const Kdf& kdf, const QByteArray& key, QByteArray& result) const;
 
     QList<QSharedPointer<Key>> m_keys;
     QList<QSharedPointer<ChallengeResponseKey>> m_challengeResponseKeys;
+    QUuid m_cacheDatabaseUuid;
 };
 
 #endif // KEEPASSX_COMPOSITEKEY_H
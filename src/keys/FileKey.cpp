@@ -26,6 +26,20 @@
 #include <QFile>
 #include <QXmlStreamReader>
 
+namespace
+{
+    // Key files are hashed in blocks of this size
+    constexpr qint64 HashBlockSize = 1024 * 1024;
+    // XML key files are small, a larger file with a null byte in its head is binary
+    constexpr qint64 XmlSizeLimit = 64 * 1024;
+    constexpr qint64 BinaryProbeSize = 1024;
+
+    bool isLargeBinary(QIODevice* device)
+    {
+        return device->size() > XmlSizeLimit && device->peek(BinaryProbeSize).contains('\0');
+    }
+} // namespace
+
 QUuid FileKey::UUID("a584cbc4-c9b4-437e-81bb-362ca9709273");
 
 constexpr int FileKey::SHA256_SIZE;
@@ -69,6 +83,11 @@ bool FileKey::load(QIODevice* device, QString* errorMsg)
         return false;
     }
 
+    // Neither the XML nor the fixed size formats can match, hash it right away
+    if (isLargeBinary(device)) {
+        return loadHashed(device);
+    }
+
     // load XML key file v1 or v2
     QString xmlError;
     if (loadXml(device, &xmlError)) {
@@ -431,6 +450,9 @@ bool FileKey::loadHex(QIODevice* device)
 /**
  * Generate SHA-256 hash of arbitrary text or binary key file.
  *
+ * Files are hashed from a memory mapping where possible, other devices
+ * are read in large blocks into one buffer.
+ *
  * @param device input device
  * @return true on success
  */
@@ -438,15 +460,32 @@ bool FileKey::loadHashed(QIODevice* device)
 {
     CryptoHash cryptoHash(CryptoHash::Sha256);
 
-    QByteArray buffer;
-    do {
-        if (!Tools::readFromDevice(device, buffer)) {
-            return false;
+    auto file = qobject_cast<QFile*>(device);
+    const qint64 size = device->size();
+    uchar* mapped = file && device->pos() == 0 && size > 0 ? file->map(0, size) : nullptr;
+    if (mapped) {
+        for (qint64 offset = 0; offset < size; offset += HashBlockSize) {
+            const auto length = static_cast<int>(qMin(HashBlockSize, size - offset));
+            cryptoHash.addData(QByteArray::fromRawData(reinterpret_cast<const char*>(mapped + offset), length));
+        }
+        file->unmap(mapped);
+    } else {
+        QByteArray block(static_cast<int>(HashBlockSize), '\0');
+        forever {
+            const qint64 read = device->read(block.data(), block.size());
+            if (read < 0) {
+                Botan::secure_scrub_memory(block.data(), static_cast<std::size_t>(block.capacity()));
+                return false;
+            }
+            if (read == 0) {
+                break;
+            }
+            cryptoHash.addData(QByteArray::fromRawData(block.constData(), static_cast<int>(read)));
         }
-        cryptoHash.addData(buffer);
-    } while (!buffer.isEmpty());
+        Botan::secure_scrub_memory(block.data(), static_cast<std::size_t>(block.capacity()));
+    }
 
-    buffer = cryptoHash.result();
+    QByteArray buffer = cryptoHash.result();
     std::memcpy(m_key.data(), buffer.data(), std::min(SHA256_SIZE, buffer.size()));
     Botan::secure_scrub_memory(buffer.data(), static_cast<std::size_t>(buffer.capacity()));
 
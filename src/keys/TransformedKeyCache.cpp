@@ -0,0 +1,164 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TransformedKeyCache.h"
+
+#include <QDataStream>
+
+#include "core/Clock.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+#include "crypto/kdf/Kdf.h"
+
+#include <botan/mem_ops.h>
+
+Q_GLOBAL_STATIC(TransformedKeyCache, s_transformedKeyCache)
+
+// Quick unlock sessions rarely outlast a working day
+const qint64 TransformedKeyCache::MaxAge = 8 * 60 * 60 * 1000;
+
+TransformedKeyCache::TransformedKeyCache() = default;
+
+TransformedKeyCache::~TransformedKeyCache()
+{
+    clear();
+}
+
+TransformedKeyCache* TransformedKeyCache::instance()
+{
+    return s_transformedKeyCache;
+}
+
+/**
+ * Get the cached result of transforming a raw key with a KDF.
+ *
+ * @param databaseUuid public uuid of the database the key belongs to
+ * @param kdf key derivation function including its seed
+ * @param rawKey raw key that is about to be transformed
+ * @param transformedKey set to the cached transformed key on success
+ * @return true if the key was found in the cache
+ */
+bool TransformedKeyCache::get(const QUuid& databaseUuid,
+                              const Kdf& kdf,
+                              const QByteArray& rawKey,
+                              QByteArray& transformedKey)
+{
+    QMutexLocker locker(&m_mutex);
+    removeExpired();
+
+    auto it = m_items.constFind(databaseUuid);
+    if (it == m_items.constEnd()) {
+        return false;
+    }
+
+    const auto id = lookupId(kdf, rawKey);
+    if (id != it->lookupId) {
+        return false;
+    }
+
+    transformedKey = seal(id, it->sealedKey);
+    return true;
+}
+
+/**
+ * Remember the transformed key of a database, replacing any earlier one.
+ *
+ * @param databaseUuid public uuid of the database the key belongs to
+ * @param kdf key derivation function including its seed
+ * @param rawKey raw key that was transformed
+ * @param transformedKey result of the transformation
+ */
+void TransformedKeyCache::insert(const QUuid& databaseUuid,
+                                 const Kdf& kdf,
+                                 const QByteArray& rawKey,
+                                 const QByteArray& transformedKey)
+{
+    QMutexLocker locker(&m_mutex);
+    removeExpired();
+
+    if (m_sessionKey.isEmpty()) {
+        m_sessionKey = randomGen()->randomArray(32);
+    }
+
+    Item item;
+    item.lookupId = lookupId(kdf, rawKey);
+    item.sealedKey = seal(item.lookupId, transformedKey);
+    item.expires = Clock::currentMilliSecondsSinceEpoch() + MaxAge;
+    m_items.insert(databaseUuid, item);
+}
+
+void TransformedKeyCache::remove(const QUuid& databaseUuid)
+{
+    QMutexLocker locker(&m_mutex);
+    m_items.remove(databaseUuid);
+    if (m_items.isEmpty()) {
+        Botan::secure_scrub_memory(m_sessionKey.data(), static_cast<size_t>(m_sessionKey.size()));
+        m_sessionKey.clear();
+    }
+}
+
+void TransformedKeyCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_items.clear();
+    Botan::secure_scrub_memory(m_sessionKey.data(), static_cast<size_t>(m_sessionKey.size()));
+    m_sessionKey.clear();
+}
+
+QByteArray TransformedKeyCache::lookupId(const Kdf& kdf, const QByteArray& rawKey) const
+{
+    QByteArray parameters;
+    QDataStream stream(&parameters, QIODevice::WriteOnly);
+    stream << kdf.uuid() << kdf.clone()->writeParameters();
+
+    QByteArray message = parameters + rawKey;
+    auto id = CryptoHash::hmac(message, m_sessionKey, CryptoHash::Sha256);
+    Botan::secure_scrub_memory(message.data(), static_cast<size_t>(message.size()));
+    return id;
+}
+
+/**
+ * XOR data with a keystream derived from the session key, sealing and unsealing are the same operation.
+ *
+ * This only keeps the data from being stored verbatim, it is no protection against reading the session key.
+ */
+QByteArray TransformedKeyCache::seal(const QByteArray& lookupId, const QByteArray& data) const
+{
+    QByteArray result(data);
+    QByteArray block;
+    for (int i = 0; i < result.size(); ++i) {
+        if (i % 32 == 0) {
+            Botan::secure_scrub_memory(block.data(), static_cast<size_t>(block.size()));
+            block = CryptoHash::hmac(lookupId + QByteArray::number(i / 32), m_sessionKey, CryptoHash::Sha256);
+        }
+        result[i] = static_cast<char>(result.at(i) ^ block.at(i % 32));
+    }
+    Botan::secure_scrub_memory(block.data(), static_cast<size_t>(block.size()));
+    return result;
+}
+
+void TransformedKeyCache::removeExpired()
+{
+    const qint64 now = Clock::currentMilliSecondsSinceEpoch();
+    for (auto it = m_items.begin(); it != m_items.end();) {
+        if (it->expires < now) {
+            it = m_items.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
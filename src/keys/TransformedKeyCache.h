@@ -0,0 +1,76 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TRANSFORMEDKEYCACHE_H
+#define KEEPASSXC_TRANSFORMEDKEYCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QUuid>
+
+class Kdf;
+
+/**
+ * Process wide cache of transformed database keys used by quick unlock.
+ *
+ * Entries are looked up by a keyed hash of the KDF parameters and the raw key,
+ * so a cached key is only found again for the exact same credentials and KDF
+ * seed. The transformed keys are not stored verbatim but XORed with a keystream
+ * of a random session key, which is replaced whenever the cache runs empty.
+ * This does not protect them from anyone who can read the process memory, the
+ * session key is kept right next to them. Cached keys expire after MaxAge.
+ */
+class TransformedKeyCache
+{
+public:
+    TransformedKeyCache();
+    ~TransformedKeyCache();
+    static TransformedKeyCache* instance();
+
+    bool get(const QUuid& databaseUuid, const Kdf& kdf, const QByteArray& rawKey, QByteArray& transformedKey);
+    void insert(const QUuid& databaseUuid, const Kdf& kdf, const QByteArray& rawKey, const QByteArray& transformedKey);
+    void remove(const QUuid& databaseUuid);
+    void clear();
+
+    static const qint64 MaxAge;
+
+private:
+    struct Item
+    {
+        QByteArray lookupId;
+        QByteArray sealedKey;
+        qint64 expires = 0;
+    };
+
+    QByteArray lookupId(const Kdf& kdf, const QByteArray& rawKey) const;
+    QByteArray seal(const QByteArray& lookupId, const QByteArray& data) const;
+    void removeExpired();
+
+    QMutex m_mutex;
+    QByteArray m_sessionKey;
+    QHash<QUuid, Item> m_items;
+
+    Q_DISABLE_COPY(TransformedKeyCache)
+};
+
+static inline TransformedKeyCache* transformedKeyCache()
+{
+    return TransformedKeyCache::instance();
+}
+
+#endif // KEEPASSXC_TRANSFORMEDKEYCACHE_H
@@ -71,19 +71,28 @@ bool YubiKey::isInitialized()
     return m_initialized;
 }
 
-bool YubiKey::findValidKeys()
+/**
+ * Find the connected hardware keys and their challenge-response slots.
+ *
+ * The slots of keys that stayed connected since the last detection are not
+ * probed again, unplugging or plugging in a key only probes the changed ones.
+ *
+ * @param rescan probe the slots of all keys, e.g. after they were reconfigured
+ * @return true if a key was found
+ */
+bool YubiKey::findValidKeys(bool rescan)
 {
     QMutexLocker lock(&s_interfaceMutex);
 
-    m_usbKeys = YubiKeyInterfaceUSB::instance()->findValidKeys();
-    m_pcscKeys = YubiKeyInterfacePCSC::instance()->findValidKeys();
+    m_usbKeys = YubiKeyInterfaceUSB::instance()->findValidKeys(rescan);
+    m_pcscKeys = YubiKeyInterfacePCSC::instance()->findValidKeys(rescan);
 
     return !m_usbKeys.isEmpty() || !m_pcscKeys.isEmpty();
 }
 
-void YubiKey::findValidKeysAsync()
+void YubiKey::findValidKeysAsync(bool rescan)
 {
-    QtConcurrent::run([this] { emit detectComplete(findValidKeys()); });
+    QtConcurrent::run([this, rescan] { emit detectComplete(findValidKeys(rescan)); });
 }
 
 YubiKey::KeyMap YubiKey::foundKeys()
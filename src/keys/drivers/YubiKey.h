@@ -49,8 +49,8 @@ public:
     static YubiKey* instance();
     bool isInitialized();
 
-    bool findValidKeys();
-    void findValidKeysAsync();
+    bool findValidKeys(bool rescan = false);
+    void findValidKeysAsync(bool rescan = false);
 
     KeyMap foundKeys();
 
@@ -20,6 +20,8 @@
 #include "core/Tools.h"
 #include "crypto/Random.h"
 
+#include <QVector>
+
 // MSYS2 does not define these macros
 // So set them to the value used by pcsc-lite
 #ifndef MAX_ATR_SIZE
@@ -121,6 +123,49 @@ namespace
         return readers_list;
     }
 
+    /***
+     * @brief Read the card state of all readers without connecting to them
+     *
+     * Connecting to a card only changes the in-use flag, which is not part
+     * of the state, so the state only changes when a card is inserted or removed.
+     *
+     * @param context A pre-established smartcard API context
+     * @param readers Names of the readers
+     * @return card state and event counter by reader name, empty if the states could not be read
+     */
+    QHash<QString, quint32> getCardStates(SCARDCONTEXT& context, const QList<QString>& readers)
+    {
+        QHash<QString, quint32> states;
+        if (readers.isEmpty()) {
+            return states;
+        }
+
+        // The names have to outlive the reader states pointing to them
+        QList<QByteArray> names;
+        for (const auto& reader : readers) {
+            names.append(reader.toUtf8());
+        }
+        QVector<SCARD_READERSTATE> readerStates(names.size());
+        for (int i = 0; i < names.size(); ++i) {
+            memset(&readerStates[i], 0, sizeof(SCARD_READERSTATE));
+            readerStates[i].szReader = names.at(i).constData();
+            readerStates[i].dwCurrentState = SCARD_STATE_UNAWARE;
+        }
+
+        // An unaware current state returns the state at once
+        auto rv = SCardGetStatusChange(context, 0, readerStates.data(), static_cast<SCUINT>(readerStates.size()));
+        if (rv != SCARD_S_SUCCESS) {
+            return states;
+        }
+
+        // The upper 16 bits count the card events of the reader
+        const SCUINT mask = 0xFFFF0000 | SCARD_STATE_EMPTY | SCARD_STATE_PRESENT | SCARD_STATE_MUTE;
+        for (int i = 0; i < readers.size(); ++i) {
+            states.insert(readers.at(i), static_cast<quint32>(readerStates.at(i).dwEventState & mask));
+        }
+        return states;
+    }
+
     /***
      * @brief Reads the status of a smartcard handle
      *
@@ -542,17 +587,24 @@ YubiKeyInterfacePCSC* YubiKeyInterfacePCSC::instance()
     return m_instance;
 }
 
-YubiKey::KeyMap YubiKeyInterfacePCSC::findValidKeys()
+YubiKey::KeyMap YubiKeyInterfacePCSC::findValidKeys(bool rescan)
 {
     m_error.clear();
     if (!isInitialized()) {
         return {};
     }
 
+    // Probing every reader takes seconds, skip it while no reader or card was added or removed
+    const auto readers = getReaders(m_sc_context);
+    auto readerStates = getCardStates(m_sc_context, readers);
+    if (!rescan && !readerStates.isEmpty() && readerStates == m_readerStates) {
+        return m_foundKeys;
+    }
+
     YubiKey::KeyMap foundKeys;
 
     // Connect to each reader and look for cards
-    for (const auto& reader_name : getReaders(m_sc_context)) {
+    for (const auto& reader_name : readers) {
         /* Some Yubikeys present their PCSC interface via USB as well
            Although this would not be a problem in itself,
            we filter these connections because in USB mode,
@@ -636,6 +688,8 @@ YubiKey::KeyMap YubiKeyInterfacePCSC::findValidKeys()
         }
     }
 
+    m_readerStates = readerStates;
+    m_foundKeys = foundKeys;
     return foundKeys;
 }
 
@@ -52,7 +52,7 @@ class YubiKeyInterfacePCSC : public YubiKeyInterface
 public:
     static YubiKeyInterfacePCSC* instance();
 
-    YubiKey::KeyMap findValidKeys() override;
+    YubiKey::KeyMap findValidKeys(bool rescan) override;
 
     YubiKey::ChallengeResult
     challenge(YubiKeySlot slot, const QByteArray& challenge, Botan::secure_vector<char>& response) override;
@@ -73,6 +73,10 @@ private:
 
     SCARDCONTEXT m_sc_context{};
 
+    // Keys found with the card states of the readers they were found in
+    QHash<QString, quint32> m_readerStates;
+    YubiKey::KeyMap m_foundKeys;
+
     // This list contains all the AID (application identifier) codes for the Yubikey HMAC-SHA1 applet
     //  and also for compatible third-party ones. They will be tried one by one.
     const QList<QByteArray> m_aid_codes = {
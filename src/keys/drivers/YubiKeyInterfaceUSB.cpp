@@ -114,7 +114,7 @@ YubiKeyInterfaceUSB* YubiKeyInterfaceUSB::instance()
     return m_instance;
 }
 
-YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
+YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys(bool rescan)
 {
     m_error.clear();
     if (!isInitialized()) {
@@ -122,6 +122,7 @@ YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
     }
 
     YubiKey::KeyMap keyMap;
+    QHash<unsigned int, YubiKey::KeyMap> keySlots;
 
     // Try to detect up to 4 connected hardware keys
     for (int i = 0; i < MAX_KEYS; ++i) {
@@ -133,6 +134,18 @@ YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
                 continue;
             }
 
+            // Reading the serial number is cheap, a test challenge per slot is not
+            auto cached = m_keySlots.constFind(serial);
+            if (!rescan && cached != m_keySlots.constEnd()) {
+                for (auto it = cached->cbegin(); it != cached->cend(); ++it) {
+                    keyMap.insert(it.key(), it.value());
+                }
+                keySlots.insert(serial, cached.value());
+                closeKey(yk_key);
+                continue;
+            }
+
+            YubiKey::KeyMap slots;
             auto st = ykds_alloc();
             yk_get_status(yk_key, st);
             int vid, pid;
@@ -158,7 +171,7 @@ YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
                 if (pid <= NEO_OTP_U2F_CCID_PID) {
                     auto display = tr("%1 [%2] - Slot %3", "YubiKey NEO display fields")
                                        .arg(name, QString::number(serial), QString::number(slot));
-                    keyMap.insert({serial, slot}, display);
+                    slots.insert({serial, slot}, display);
                 } else if (performTestChallenge(yk_key, slot, &wouldBlock)) {
                     auto display =
                         tr("%1 [%2] - Slot %3, %4", "YubiKey display fields")
@@ -167,12 +180,17 @@ YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
                                  QString::number(slot),
                                  wouldBlock ? tr("Press", "USB Challenge-Response Key interaction request")
                                             : tr("Passive", "USB Challenge-Response Key no interaction required"));
-                    keyMap.insert({serial, slot}, display);
+                    slots.insert({serial, slot}, display);
                 }
             }
 
             ykds_free(st);
             closeKey(yk_key);
+
+            for (auto it = slots.cbegin(); it != slots.cend(); ++it) {
+                keyMap.insert(it.key(), it.value());
+            }
+            keySlots.insert(serial, slots);
         } else if (yk_errno == YK_ENOKEY) {
             // No more keys are connected
             break;
@@ -183,6 +201,8 @@ YubiKey::KeyMap YubiKeyInterfaceUSB::findValidKeys()
         }
     }
 
+    // Keys that were unplugged are probed again when they come back
+    m_keySlots = keySlots;
     return keyMap;
 }
 
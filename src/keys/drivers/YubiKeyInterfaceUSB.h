@@ -35,7 +35,7 @@ public:
     static constexpr int YUBICO_USB_VID = YUBICO_VID;
     static constexpr int ONLYKEY_USB_VID = ONLYKEY_VID;
 
-    YubiKey::KeyMap findValidKeys() override;
+    YubiKey::KeyMap findValidKeys(bool rescan) override;
 
     YubiKey::ChallengeResult
     challenge(YubiKeySlot slot, const QByteArray& challenge, Botan::secure_vector<char>& response) override;
@@ -54,6 +54,9 @@ private:
                                               Botan::secure_vector<char>& response) override;
     bool performTestChallenge(void* key, int slot, bool* wouldBlock) override;
 
+    // Slots found on the connected keys by serial number, probed once per connection
+    QHash<unsigned int, YubiKey::KeyMap> m_keySlots;
+
     // This map provides display names for the various USB PIDs of the Yubikeys
     const QHash<int, QString> m_pid_names = {{YUBIKEY_PID, "YubiKey %ver"},
                                              {NEO_OTP_PID, "YubiKey NEO - OTP"},
@@ -36,13 +36,15 @@ bool YubiKey::isInitialized()
     return false;
 }
 
-bool YubiKey::findValidKeys()
+bool YubiKey::findValidKeys(bool rescan)
 {
+    Q_UNUSED(rescan);
     return false;
 }
 
-void YubiKey::findValidKeysAsync()
+void YubiKey::findValidKeysAsync(bool rescan)
 {
+    Q_UNUSED(rescan);
 }
 
 YubiKey::KeyMap YubiKey::foundKeys()
@@ -24,6 +24,7 @@
 
 #include "cli/Utils.h"
 #include "config-keepassx.h"
+#include "core/StartupTrace.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
 #include "gui/Application.h"
@@ -52,6 +53,7 @@ Q_IMPORT_PLUGIN(QXcbIntegrationPlugin)
 int main(int argc, char** argv)
 {
     QT_REQUIRE_VERSION(argc, argv, QT_VERSION_STR)
+    StartupTrace::mark("start");
 
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QGuiApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
@@ -64,6 +66,7 @@ int main(int argc, char** argv)
     Application::setApplicationName("KeePassXC");
     Application::setApplicationVersion(KEEPASSXC_VERSION);
     app.setProperty("KPXC_QUALIFIED_APPNAME", "org.keepassxc.KeePassXC");
+    StartupTrace::mark("application");
 
     // HACK: Prevent long-running threads from deadlocking the program with only 1 CPU
     // See https://github.com/keepassxreboot/keepassxc/issues/10391
@@ -138,6 +141,7 @@ int main(int argc, char** argv)
         }
     }
 #endif
+    StartupTrace::mark("command line");
 
     // Process single instance and early exit if already running
     if (app.isAlreadyRunning()) {
@@ -173,13 +177,16 @@ int main(int argc, char** argv)
         MessageBox::critical(nullptr, QObject::tr("KeePassXC - Error"), error);
         return EXIT_FAILURE;
     }
+    StartupTrace::mark("crypto");
 
     // Apply the configured theme before creating any GUI elements
     app.applyTheme();
+    StartupTrace::mark("theme");
 
     QGuiApplication::setDesktopFileName(app.property("KPXC_QUALIFIED_APPNAME").toString() + QStringLiteral(".desktop"));
 
     Application::bootstrap(config()->get(Config::GUI_Language).toString());
+    StartupTrace::mark("bootstrap");
 
     MainWindow mainWindow;
 #ifdef Q_OS_WIN
@@ -190,6 +197,7 @@ int main(int argc, char** argv)
     // Disable screen capture if not explicitly allowed
     // This ensures any top-level windows (Main Window, Modal Dialogs, etc.) are excluded from screenshots
     mainWindow.setAllowScreenCapture(parser.isSet(allowScreenCaptureOption));
+    StartupTrace::mark("main window");
 
     const bool pwstdin = parser.isSet(pwstdinOption);
     if (!fileNames.isEmpty() && pwstdin) {
@@ -206,6 +214,7 @@ int main(int argc, char** argv)
         }
         mainWindow.openDatabase(filename, password, parser.value(keyfileOption));
     }
+    StartupTrace::mark("open databases");
 
     // start minimized if configured
     if (config()->get(Config::GUI_MinimizeOnStartup).toBool()) {
@@ -214,6 +223,7 @@ int main(int argc, char** argv)
         mainWindow.bringToFront();
         Application::processEvents();
     }
+    StartupTrace::mark("window shown");
 
     int exitCode = Application::exec();
 
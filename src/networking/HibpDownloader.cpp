@@ -18,8 +18,13 @@
 #include "HibpDownloader.h"
 #include "NetworkManager.h"
 
+#include "core/Global.h"
+
 #include <QCryptographicHash>
+#include <QDateTime>
 #include <QNetworkReply>
+#include <QSet>
+#include <QtConcurrent>
 
 namespace
 {
@@ -41,11 +46,11 @@ namespace
      * Returns the number of times the password is found in breaches, or
      * 0 if the password is not in the HIBP result.
      */
-    int pwnCount(const QString& password, const QString& hibpResult)
+    int pwnCount(const QString& sha1, const QString& hibpResult)
     {
         // The first 5 characters of the hash are in the URL already,
         // the HIBP result contains the remainder
-        auto pos = hibpResult.indexOf(sha1Hex(password).mid(5));
+        auto pos = hibpResult.indexOf(sha1.mid(5));
         if (pos < 0) {
             return 0;
         }
@@ -64,6 +69,10 @@ namespace
     }
 } // namespace
 
+// Browsers allow about as many connections per host
+const int HibpDownloader::MaxParallelRequests = 6;
+const qint64 HibpDownloader::ResultLifetime = 24 * 60 * 60 * 1000;
+
 HibpDownloader::HibpDownloader(QObject* parent)
     : QObject(parent)
 {
@@ -82,59 +91,182 @@ HibpDownloader::~HibpDownloader()
  */
 void HibpDownloader::add(const QString& password)
 {
-    if (!m_pwdsToTry.contains(password)) {
-        m_pwdsToTry << password;
+    addHashed(password, sha1Hex(password));
+}
+
+/*
+ * Add many passwords to the list of passwords to check.
+ *
+ * Each distinct password is hashed once, on the thread pool.
+ */
+void HibpDownloader::add(const QStringList& passwords)
+{
+    QStringList unhashed;
+    QSet<QString> seen;
+    for (const auto& password : passwords) {
+        if (!m_sha1s.contains(password) && !seen.contains(password)) {
+            seen.insert(password);
+            unhashed.append(password);
+        }
+    }
+
+    const auto sha1s = QtConcurrent::blockingMapped<QStringList>(unhashed, sha1Hex);
+    for (int i = 0; i < unhashed.size(); ++i) {
+        addHashed(unhashed.at(i), sha1s.at(i));
     }
 }
 
+void HibpDownloader::addHashed(const QString& password, const QString& sha1)
+{
+    const auto prefix = sha1.left(5);
+    auto passwords = m_passwordsByPrefix.find(prefix);
+    if (passwords == m_passwordsByPrefix.end()) {
+        passwords = m_passwordsByPrefix.insert(prefix, {});
+        m_prefixesToFetch << prefix;
+    } else if (passwords->contains(password)) {
+        return;
+    }
+
+    // Ranges already being fetched will report this password as well
+    passwords->append(password);
+    m_sha1s.insert(password, sha1);
+    ++m_passwordsToValidate;
+    ++m_passwordsRemaining;
+}
+
 /*
  * Start validating the passwords against HIBP.
  */
 void HibpDownloader::validate()
 {
-    for (auto password : m_pwdsToTry) {
+    m_validating = true;
+    m_passwordsToValidate = 0;
+    startRequests();
+}
+
+int HibpDownloader::passwordsToValidate() const
+{
+    return m_passwordsToValidate;
+}
+
+int HibpDownloader::passwordsRemaining() const
+{
+    return m_passwordsRemaining;
+}
+
+/*
+ * Abort the current online activity (if any).
+ */
+void HibpDownloader::abort()
+{
+    for (auto reply : m_replies.keys()) {
+        reply->abort();
+        reply->deleteLater();
+    }
+    m_replies.clear();
+    m_passwordsByPrefix.clear();
+    m_sha1s.clear();
+    m_prefixesToFetch.clear();
+    m_passwordsToValidate = 0;
+    m_passwordsRemaining = 0;
+    m_validating = false;
+}
+
+/*
+ * Send requests for the pending ranges until the request limit is reached.
+ */
+void HibpDownloader::startRequests()
+{
+    while (m_validating && !m_prefixesToFetch.isEmpty() && m_replies.size() < MaxParallelRequests) {
+        const auto prefix = m_prefixesToFetch.takeFirst();
+
+        // Skip the request if all passwords of the range have been checked recently
+        auto& passwords = m_passwordsByPrefix[prefix];
+        QList<QPair<QString, int>> cachedResults;
+        for (auto it = passwords.begin(); it != passwords.end();) {
+            int count = 0;
+            if (takeCachedResult(*it, count)) {
+                cachedResults.append({*it, count});
+                m_sha1s.remove(*it);
+                it = passwords.erase(it);
+                --m_passwordsRemaining;
+            } else {
+                ++it;
+            }
+        }
+        const bool fetch = !passwords.isEmpty();
+        if (!fetch) {
+            m_passwordsByPrefix.remove(prefix);
+        }
+        for (const auto& result : asConst(cachedResults)) {
+            emit hibpResult(result.first, result.second);
+        }
+        if (!fetch || !m_validating) {
+            continue;
+        }
+
         // The URL we query is https://api.pwnedpasswords.com/range/XXXXX,
         // where XXXXX is the first five bytes of the hex representation of
         // the password's SHA1.
-        const auto url = QString("https://api.pwnedpasswords.com/range/") + sha1Hex(password).left(5);
+        const auto url = QString("https://api.pwnedpasswords.com/range/") + prefix;
 
         // HIBP requires clients to specify a user agent in the request
         // (https://haveibeenpwned.com/API/v3#UserAgent); however, in order
         // to minimize the amount of information we expose about ourselves,
         // we don't add the KeePassXC version number or platform.
-        auto request = QNetworkRequest(url);
+        auto request = networkRequest(url);
         request.setRawHeader("User-Agent", "KeePassXC");
 
         // Finally, submit the request to HIBP.
         auto reply = getNetMgr()->get(request);
         connect(reply, &QNetworkReply::finished, this, &HibpDownloader::fetchFinished);
         connect(reply, &QIODevice::readyRead, this, &HibpDownloader::fetchReadyRead);
-        m_replies.insert(reply, {password, {}});
+        m_replies.insert(reply, {prefix, {}});
     }
 
-    m_pwdsToTry.clear();
+    if (m_prefixesToFetch.isEmpty() && m_replies.isEmpty()) {
+        m_validating = false;
+    }
 }
 
-int HibpDownloader::passwordsToValidate() const
+/*
+ * Get the hash of a password added for validation.
+ */
+QString HibpDownloader::passwordSha1(const QString& password) const
 {
-    return m_pwdsToTry.size();
+    auto sha1 = m_sha1s.constFind(password);
+    return sha1 != m_sha1s.constEnd() ? sha1.value() : sha1Hex(password);
 }
 
-int HibpDownloader::passwordsRemaining() const
+bool HibpDownloader::takeCachedResult(const QString& password, int& count)
 {
-    return m_replies.size();
+    auto result = m_results.find(passwordSha1(password));
+    if (result == m_results.end()) {
+        return false;
+    }
+    if (result->expires < QDateTime::currentMSecsSinceEpoch()) {
+        m_results.erase(result);
+        return false;
+    }
+    count = result->count;
+    return true;
 }
 
 /*
- * Abort the current online activity (if any).
+ * Report the results of all passwords in a fetched range.
  */
-void HibpDownloader::abort()
+void HibpDownloader::reportRange(const QString& prefix, const QString& hibpResult)
 {
-    for (auto reply : m_replies.keys()) {
-        reply->abort();
-        reply->deleteLater();
+    const auto passwords = m_passwordsByPrefix.take(prefix);
+    const auto expires = QDateTime::currentMSecsSinceEpoch() + ResultLifetime;
+    for (const auto& password : passwords) {
+        const auto sha1 = passwordSha1(password);
+        m_sha1s.remove(password);
+        const auto count = pwnCount(sha1, hibpResult);
+        m_results.insert(sha1, {count, expires});
+        --m_passwordsRemaining;
+        emit hibpResult(password, count);
     }
-    m_replies.clear();
 }
 
 /*
@@ -164,7 +296,7 @@ void HibpDownloader::fetchFinished()
     const auto ok = reply->error() == QNetworkReply::NoError;
     const auto err = reply->errorString();
 
-    const auto password = entry->first;
+    const auto prefix = entry->first;
     const auto hibpReply = entry->second;
 
     reply->deleteLater();
@@ -182,6 +314,7 @@ void HibpDownloader::fetchFinished()
         return;
     }
 
-    // Current password validated, send the result to the caller
-    emit hibpResult(password, pwnCount(password, hibpReply));
+    // Passwords of the range validated, send the results to the caller
+    reportRange(prefix, hibpReply);
+    startRequests();
 }
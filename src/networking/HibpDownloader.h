@@ -36,6 +36,11 @@ class QNetworkReply;
  * Usage: Pass the password to check to the ctor and process
  * the `finished` signal to get the result. Process the
  * `failed` signal to handle errors.
+ *
+ * Passwords whose hashes share a range prefix are checked with a
+ * single request, at most MaxParallelRequests requests are sent at
+ * a time. Results are remembered for ResultLifetime, so checking an
+ * unchanged password again does not cause another request.
  */
 class HibpDownloader : public QObject
 {
@@ -46,10 +51,14 @@ public:
     ~HibpDownloader() override;
 
     void add(const QString& password);
+    void add(const QStringList& passwords);
     void validate();
     int passwordsToValidate() const;
     int passwordsRemaining() const;
 
+    static const int MaxParallelRequests;
+    static const qint64 ResultLifetime;
+
 signals:
     void hibpResult(const QString& password, int count);
     void fetchFailed(const QString& error);
@@ -62,8 +71,26 @@ private slots:
     void fetchReadyRead();
 
 private:
-    QStringList m_pwdsToTry; // The list of remaining passwords to validate
+    struct CachedResult
+    {
+        int count = 0;
+        qint64 expires = 0;
+    };
+
+    void addHashed(const QString& password, const QString& sha1);
+    QString passwordSha1(const QString& password) const;
+    void startRequests();
+    bool takeCachedResult(const QString& password, int& count);
+    void reportRange(const QString& prefix, const QString& hibpResult);
+
+    QHash<QString, QStringList> m_passwordsByPrefix; // Passwords to validate, by the range they are in
+    QHash<QString, QString> m_sha1s; // Hashes of the passwords to validate
+    QStringList m_prefixesToFetch; // Ranges not requested yet, in the order they were added
     QHash<QNetworkReply*, QPair<QString, QByteArray>> m_replies;
+    QHash<QString, CachedResult> m_results; // Recent results by password hash
+    int m_passwordsToValidate = 0;
+    int m_passwordsRemaining = 0;
+    bool m_validating = false;
 };
 
 #endif // KEEPASSXC_HIBPDOWNLOADER_H
@@ -21,15 +21,140 @@
 
 #include "NetworkManager.h"
 
+#include <QAbstractNetworkCache>
+#include <QBuffer>
+#include <QCache>
 #include <QCoreApplication>
 #include <QNetworkAccessManager>
 
+namespace
+{
+    // Favicons and HIBP ranges are small, this keeps a few thousand of them
+    const int MaxCacheSize = 16 * 1024 * 1024;
+
+    /**
+     * HTTP cache of the replies of the application, kept in memory only.
+     *
+     * Fetched favicons and password hash ranges are never written to disk.
+     * The network access manager checks the freshness of the cached replies
+     * against their cache headers and revalidates stale ones.
+     */
+    class NetworkMemoryCache : public QAbstractNetworkCache
+    {
+    public:
+        explicit NetworkMemoryCache(QObject* parent)
+            : QAbstractNetworkCache(parent)
+        {
+            m_items.setMaxCost(MaxCacheSize);
+        }
+
+        ~NetworkMemoryCache() override
+        {
+            qDeleteAll(m_inserting);
+        }
+
+        QNetworkCacheMetaData metaData(const QUrl& url) override
+        {
+            auto item = m_items.object(url);
+            return item ? item->metaData : QNetworkCacheMetaData();
+        }
+
+        void updateMetaData(const QNetworkCacheMetaData& metaData) override
+        {
+            auto item = m_items.object(metaData.url());
+            if (item) {
+                item->metaData = metaData;
+            }
+        }
+
+        QIODevice* data(const QUrl& url) override
+        {
+            auto item = m_items.object(url);
+            if (!item) {
+                return nullptr;
+            }
+            // The reader takes ownership of the device
+            auto buffer = new QBuffer();
+            buffer->setData(item->data);
+            buffer->open(QIODevice::ReadOnly);
+            return buffer;
+        }
+
+        bool remove(const QUrl& url) override
+        {
+            return m_items.remove(url);
+        }
+
+        qint64 cacheSize() const override
+        {
+            return m_items.totalCost();
+        }
+
+        QIODevice* prepare(const QNetworkCacheMetaData& metaData) override
+        {
+            if (!metaData.isValid() || !metaData.url().isValid() || !metaData.saveToDisk()) {
+                return nullptr;
+            }
+            auto buffer = new QBuffer();
+            buffer->open(QIODevice::ReadWrite);
+            m_inserting.insert(buffer, metaData);
+            return buffer;
+        }
+
+        void insert(QIODevice* device) override
+        {
+            auto buffer = qobject_cast<QBuffer*>(device);
+            auto metaData = m_inserting.find(buffer);
+            if (metaData == m_inserting.end()) {
+                return;
+            }
+            const auto size = buffer->size();
+            if (size < MaxCacheSize) {
+                auto item = new Item{metaData.value(), buffer->data()};
+                m_items.insert(item->metaData.url(), item, static_cast<int>(size));
+            }
+            m_inserting.erase(metaData);
+            delete buffer;
+        }
+
+        void clear() override
+        {
+            m_items.clear();
+        }
+
+    private:
+        struct Item
+        {
+            QNetworkCacheMetaData metaData;
+            QByteArray data;
+        };
+
+        QCache<QUrl, Item> m_items;
+        QHash<QBuffer*, QNetworkCacheMetaData> m_inserting;
+    };
+} // namespace
+
 QNetworkAccessManager* g_netMgr = nullptr;
 QNetworkAccessManager* getNetMgr()
 {
     if (!g_netMgr) {
         g_netMgr = new QNetworkAccessManager(QCoreApplication::instance());
+        g_netMgr->setCache(new NetworkMemoryCache(g_netMgr));
     }
     return g_netMgr;
 }
+
+/**
+ * Create a request sharing the connections and the cache of the application.
+ *
+ * @param url URL to fetch
+ * @return request that may be multiplexed over a kept alive HTTP/2 connection,
+ *         fresh cached replies are used according to the default cache load control
+ */
+QNetworkRequest networkRequest(const QUrl& url)
+{
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    return request;
+}
 #endif
@@ -22,9 +22,12 @@
 
 #ifdef WITH_XC_NETWORKING
 
+#include <QNetworkRequest>
+
 class QNetworkAccessManager;
 
 QNetworkAccessManager* getNetMgr();
+QNetworkRequest networkRequest(const QUrl& url);
 #else
 Q_STATIC_ASSERT_X(false, "Qt Networking used when WITH_XC_NETWORKING is disabled!");
 #endif
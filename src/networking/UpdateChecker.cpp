@@ -63,8 +63,12 @@ void UpdateChecker::checkForUpdates(bool manuallyRequested)
 
         QUrl apiUrl = QUrl(apiUrlStr);
 
-        QNetworkRequest request(apiUrl);
+        auto request = networkRequest(apiUrl);
         request.setRawHeader("Accept", "application/json");
+        // A manual check must see the latest release
+        if (m_isManuallyRequested) {
+            request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+        }
 
         m_reply = getNetMgr()->get(request);
 
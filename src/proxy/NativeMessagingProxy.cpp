@@ -60,18 +60,17 @@ void NativeMessagingProxy::setupStandardInput()
     QtConcurrent::run([this] {
         while (std::cin.good()) {
             if (std::cin.peek() != EOF) {
-                uint length = 0;
-                for (uint i = 0; i < sizeof(uint); ++i) {
-                    length |= getchar() << (i * 8);
+                // The length is sent in native byte order, the message is relayed as is
+                quint32 length = 0;
+                if (!std::cin.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+                    break;
                 }
 
-                QString msg;
-                msg.reserve(length);
-                for (uint i = 0; i < length; ++i) {
-                    msg.append(getchar());
-                }
+                QByteArray msg(static_cast<int>(length), Qt::Uninitialized);
+                std::cin.read(msg.data(), msg.size());
+                msg.resize(static_cast<int>(std::cin.gcount()));
 
-                if (msg.length() > 0) {
+                if (!msg.isEmpty()) {
                     emit stdinMessage(msg);
                 }
             }
@@ -81,10 +80,10 @@ void NativeMessagingProxy::setupStandardInput()
     });
 }
 
-void NativeMessagingProxy::transferStdinMessage(const QString& msg)
+void NativeMessagingProxy::transferStdinMessage(const QByteArray& msg)
 {
     if (m_localSocket && m_localSocket->state() == QLocalSocket::ConnectedState) {
-        m_localSocket->write(msg.toUtf8(), msg.length());
+        m_localSocket->write(msg);
         m_localSocket->flush();
     }
 }
@@ -106,14 +105,20 @@ void NativeMessagingProxy::setupLocalSocket()
 
 void NativeMessagingProxy::transferSocketMessage()
 {
-    auto msg = m_localSocket->readAll();
-    if (!msg.isEmpty()) {
+    // Replies written right after each other arrive in one read, the browser expects one frame per reply
+    m_pendingData.append(m_localSocket->readAll());
+    const auto messages = BrowserShared::takeMessages(m_pendingData);
+    for (const auto& msg : messages) {
         // Explicitly write the message length as 1 byte chunks
         uint len = msg.size();
         std::cout.write(reinterpret_cast<char*>(&len), sizeof(len));
-
-        // Write the message and flush the stream
-        std::cout << msg.toStdString() << std::flush;
+        std::cout.write(msg.constData(), msg.size());
+    }
+    if (!messages.isEmpty()) {
+        std::cout.flush();
+    }
+    if (m_pendingData.size() > BrowserShared::NATIVEMSG_MAX_LENGTH) {
+        m_pendingData.clear();
     }
 }
 
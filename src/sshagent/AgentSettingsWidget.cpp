@@ -47,6 +47,7 @@ void AgentSettingsWidget::loadSettings()
     auto sshAgentEnabled = sshAgent()->isEnabled();
 
     m_ui->enableSSHAgentCheckBox->setChecked(sshAgentEnabled);
+    m_ui->serveKeysCheckBox->setChecked(sshAgent()->serveKeys());
 #ifdef Q_OS_WIN
     m_ui->usePageantRadioButton->setChecked(sshAgent()->usePageant());
     m_ui->useOpenSSHRadioButton->setChecked(sshAgent()->useOpenSSH());
@@ -66,7 +67,11 @@ void AgentSettingsWidget::loadSettings()
 
     m_ui->sshAuthSockMessageWidget->setVisible(sshAgentEnabled);
 
-    if (sshAgentEnabled) {
+    if (sshAgentEnabled && sshAgent()->serveKeys()) {
+        m_ui->sshAuthSockMessageWidget->showMessage(
+            tr("Keys of unlocked databases are served on %1").arg(sshAgent()->serverSocketPath()),
+            MessageWidget::Information);
+    } else if (sshAgentEnabled) {
 #ifndef Q_OS_WIN
         if (sshAuthSock.isEmpty() && sshAuthSockOverride.isEmpty()) {
             m_ui->sshAuthSockMessageWidget->showMessage(
@@ -98,6 +103,7 @@ void AgentSettingsWidget::saveSettings()
     sshAgent()->setUsePageant(m_ui->usePageantRadioButton->isChecked() || m_ui->useBothRadioButton->isChecked());
     sshAgent()->setUseOpenSSH(m_ui->useOpenSSHRadioButton->isChecked() || m_ui->useBothRadioButton->isChecked());
 #endif
+    sshAgent()->setServeKeys(m_ui->serveKeysCheckBox->isChecked());
     sshAgent()->setEnabled(m_ui->enableSSHAgentCheckBox->isChecked());
 }
 
@@ -0,0 +1,197 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KeeAgentEntryIndex.h"
+
+#include "core/Database.h"
+#include "core/Group.h"
+
+KeeAgentEntryIndex::KeeAgentEntryIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+{
+    connect(db, &Database::groupAdded, this, &KeeAgentEntryIndex::scheduleSweep);
+    connect(db, &Database::groupRemoved, this, &KeeAgentEntryIndex::clear);
+    // Modified signals are blocked while a database is read or the journal is replayed
+    connect(db, &Database::databaseOpened, this, &KeeAgentEntryIndex::clear);
+    connect(db, &Database::databaseDiscarded, this, &KeeAgentEntryIndex::clear);
+}
+
+/**
+ * Get the index of a database, creating it on first use.
+ *
+ * @param db database to index
+ * @return index owned by the database
+ */
+KeeAgentEntryIndex* KeeAgentEntryIndex::forDatabase(Database* db)
+{
+    auto index = db->findChild<KeeAgentEntryIndex*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!index) {
+        index = new KeeAgentEntryIndex(db);
+    }
+    return index;
+}
+
+/**
+ * @return entries with valid KeeAgent settings, in the order of the group tree
+ */
+QVector<Entry*> KeeAgentEntryIndex::entries()
+{
+    ensureCurrent();
+
+    if (!m_orderValid) {
+        m_orderValid = true;
+        m_entries.clear();
+        if (m_rootGroup && !m_settings.isEmpty()) {
+            m_rootGroup->forEachEntryRecursive([this](Entry* entry) {
+                if (m_settings.contains(entry)) {
+                    m_entries.append(entry);
+                }
+                return true;
+            });
+        }
+    }
+    return m_entries;
+}
+
+/**
+ * Get the parsed KeeAgent settings of an entry.
+ *
+ * @param entry entry of the database
+ * @param settings receives the settings of the entry
+ * @return true if the entry has valid settings
+ */
+bool KeeAgentEntryIndex::settings(const Entry* entry, KeeAgentSettings& settings)
+{
+    ensureCurrent();
+
+    const auto it = m_settings.constFind(entry);
+    if (it == m_settings.constEnd()) {
+        return false;
+    }
+    settings = it.value();
+    return true;
+}
+
+void KeeAgentEntryIndex::addEntry(Entry* entry)
+{
+    if (entry->database() == m_db) {
+        drop(entry);
+        index(entry);
+    }
+}
+
+void KeeAgentEntryIndex::invalidateEntry()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry) {
+        addEntry(entry);
+    }
+}
+
+void KeeAgentEntryIndex::removeEntry(Entry* entry)
+{
+    drop(entry);
+    disconnect(entry, nullptr, this, nullptr);
+}
+
+void KeeAgentEntryIndex::removeDestroyedEntry(QObject* entry)
+{
+    // The entry is already destroyed at this point, only its address is used
+    drop(static_cast<const Entry*>(entry));
+}
+
+void KeeAgentEntryIndex::scheduleSweep()
+{
+    // Entries of an added group do not emit entryAdded
+    m_sweepPending = true;
+    m_orderValid = false;
+}
+
+void KeeAgentEntryIndex::clear()
+{
+    for (const auto* entry : asConst(m_indexed)) {
+        disconnect(entry, nullptr, this, nullptr);
+    }
+    if (m_rootGroup) {
+        m_rootGroup->forEachGroupRecursive([this](const Group* group) {
+            disconnect(group, nullptr, this, nullptr);
+            return true;
+        });
+    }
+    m_indexed.clear();
+    m_settings.clear();
+    m_entries.clear();
+    m_rootGroup = m_db->rootGroup();
+    m_sweepPending = true;
+    m_orderValid = false;
+}
+
+void KeeAgentEntryIndex::ensureCurrent()
+{
+    if (m_rootGroup != m_db->rootGroup()) {
+        clear();
+    }
+    if (m_sweepPending) {
+        sweep();
+    }
+}
+
+/**
+ * Index all entries of the database that are not indexed yet.
+ */
+void KeeAgentEntryIndex::sweep()
+{
+    m_sweepPending = false;
+    m_rootGroup = m_db->rootGroup();
+    if (!m_rootGroup) {
+        return;
+    }
+
+    m_rootGroup->forEachGroupRecursive([this](Group* group) {
+        connect(group, &Group::entryAdded, this, &KeeAgentEntryIndex::addEntry, Qt::UniqueConnection);
+        connect(group, &Group::entryRemoved, this, &KeeAgentEntryIndex::removeEntry, Qt::UniqueConnection);
+        for (auto* entry : group->entries()) {
+            if (!m_indexed.contains(entry)) {
+                index(entry);
+            }
+        }
+        return true;
+    });
+}
+
+void KeeAgentEntryIndex::index(Entry* entry)
+{
+    m_indexed.insert(entry);
+
+    KeeAgentSettings settings;
+    if (settings.fromEntry(entry)) {
+        m_settings.insert(entry, settings);
+        m_orderValid = false;
+    }
+
+    connect(entry, &Entry::modified, this, &KeeAgentEntryIndex::invalidateEntry, Qt::UniqueConnection);
+    connect(entry, &QObject::destroyed, this, &KeeAgentEntryIndex::removeDestroyedEntry, Qt::UniqueConnection);
+}
+
+void KeeAgentEntryIndex::drop(const Entry* entry)
+{
+    m_indexed.remove(entry);
+    if (m_settings.remove(entry) > 0) {
+        m_orderValid = false;
+    }
+}
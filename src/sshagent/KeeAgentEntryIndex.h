@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_KEEAGENTENTRYINDEX_H
+#define KEEPASSXC_KEEAGENTENTRYINDEX_H
+
+#include "sshagent/KeeAgentSettings.h"
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QVector>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Per database index of the entries with KeeAgent settings.
+ *
+ * The settings attachment of every entry is parsed once and kept until the
+ * entry is modified, so the agent only has to visit the entries that have
+ * settings when a database is unlocked or its identities are listed again.
+ * The index is built on the first lookup and updated as entries are added,
+ * modified, moved or deleted. Whether an entry is in the recycle bin is not
+ * part of the index and still has to be checked.
+ */
+class KeeAgentEntryIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    static KeeAgentEntryIndex* forDatabase(Database* db);
+
+    QVector<Entry*> entries();
+    bool settings(const Entry* entry, KeeAgentSettings& settings);
+
+private slots:
+    void addEntry(Entry* entry);
+    void invalidateEntry();
+    void removeEntry(Entry* entry);
+    void removeDestroyedEntry(QObject* entry);
+    void scheduleSweep();
+    void clear();
+
+private:
+    explicit KeeAgentEntryIndex(Database* db);
+
+    void ensureCurrent();
+    void sweep();
+    void index(Entry* entry);
+    void drop(const Entry* entry);
+
+    Database* m_db;
+    QPointer<Group> m_rootGroup;
+    bool m_sweepPending = true;
+    bool m_orderValid = false;
+    QSet<const Entry*> m_indexed;
+    QHash<const Entry*, KeeAgentSettings> m_settings;
+    // Entries with settings in the order of the group tree
+    QVector<Entry*> m_entries;
+};
+
+#endif // KEEPASSXC_KEEAGENTENTRYINDEX_H
@@ -26,10 +26,21 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QMutex>
 #include <QProcessEnvironment>
 #include <QTextCodec>
 #include <QXmlStreamReader>
 
+namespace
+{
+    // Settings of entries that every unlock and identity listing would parse again
+    const int MaxCachedSettings = 1024;
+
+    // Keyed by the stored XML, so changed settings are parsed again
+    QHash<QByteArray, KeeAgentSettings> s_parsedSettings;
+    QMutex s_parsedSettingsMutex;
+} // namespace
+
 KeeAgentSettings::KeeAgentSettings()
 {
     reset();
@@ -356,10 +367,29 @@ bool KeeAgentSettings::inEntryAttachments(const EntryAttachments* attachments)
 bool KeeAgentSettings::fromEntry(const Entry* entry)
 {
     const auto attachments = entry->attachments();
-    if (attachments->hasKey("KeeAgent.settings")) {
-        return fromXml(attachments->value("KeeAgent.settings"));
+    if (!attachments->hasKey("KeeAgent.settings")) {
+        return false;
+    }
+
+    const auto xml = attachments->value("KeeAgent.settings");
+    QMutexLocker locker(&s_parsedSettingsMutex);
+    const auto cached = s_parsedSettings.constFind(xml);
+    if (cached != s_parsedSettings.constEnd()) {
+        *this = cached.value();
+        return true;
     }
-    return false;
+    locker.unlock();
+
+    if (!fromXml(xml)) {
+        return false;
+    }
+
+    locker.relock();
+    if (s_parsedSettings.size() >= MaxCachedSettings) {
+        s_parsedSettings.clear();
+    }
+    s_parsedSettings.insert(xml, *this);
+    return true;
 }
 
 /**
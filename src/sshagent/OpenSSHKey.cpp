@@ -25,15 +25,56 @@
 #include "crypto/SymmetricCipher.h"
 
 #include <QRegularExpression>
+#include <QScopeGuard>
 #include <QStringList>
 
+#include <botan/ecdsa.h>
+#include <botan/ed25519.h>
+#include <botan/mem_ops.h>
+#include <botan/pubkey.h>
 #include <botan/pwdhash.h>
+#include <botan/rsa.h>
 
 const QString OpenSSHKey::TYPE_DSA_PRIVATE = "DSA PRIVATE KEY";
 const QString OpenSSHKey::TYPE_RSA_PRIVATE = "RSA PRIVATE KEY";
 const QString OpenSSHKey::TYPE_OPENSSH_PRIVATE = "OPENSSH PRIVATE KEY";
 const QString OpenSSHKey::OPENSSH_CIPHER_SUFFIX = "@openssh.com";
 
+namespace
+{
+    bool readBigInt(BinaryStream& stream, Botan::BigInt& i)
+    {
+        QByteArray ba;
+        if (!stream.readString(ba)) {
+            return false;
+        }
+        i = Botan::BigInt(reinterpret_cast<const uint8_t*>(ba.constData()), ba.size());
+        // Private key parts are read this way as well
+        Botan::secure_scrub_memory(ba.data(), static_cast<size_t>(ba.size()));
+        return true;
+    }
+
+    void writeMPInt(BinaryStream& stream, QByteArray ba)
+    {
+        while (!ba.isEmpty() && ba.at(0) == '\0') {
+            ba.remove(0, 1);
+        }
+        // A set high bit would make the integer negative
+        if (!ba.isEmpty() && (static_cast<quint8>(ba.at(0)) & 0x80)) {
+            ba.prepend('\0');
+        }
+        stream.writeString(ba);
+    }
+
+    QByteArray signMessage(Botan::PK_Signer& signer, const QByteArray& data)
+    {
+        auto rng = randomGen()->getRng();
+        auto signature =
+            signer.sign_message(reinterpret_cast<const uint8_t*>(data.constData()), data.size(), *rng);
+        return QByteArray(reinterpret_cast<const char*>(signature.data()), signature.size());
+    }
+} // namespace
+
 OpenSSHKey::OpenSSHKey(QObject* parent)
     : QObject(parent)
     , m_check(0)
@@ -663,3 +704,111 @@ uint qHash(const OpenSSHKey& key)
 {
     return qHash(key.fingerprint());
 }
+
+/**
+ * Sign data with the private key in the format of the SSH agent protocol.
+ *
+ * @param data data to sign
+ * @param signature output signature blob with the signature algorithm and the signature
+ * @param flags SSH agent signature flags selecting the hash of RSA signatures
+ * @return true on success
+ */
+bool OpenSSHKey::sign(const QByteArray& data, QByteArray& signature, quint32 flags)
+{
+    if (m_rawPrivateData.isEmpty()) {
+        m_error = tr("Can't sign with the private key as it is empty");
+        return false;
+    }
+
+    // Private key material copied out of the key is scrubbed on every return path
+    QByteArray privateData(m_rawPrivateData.constData(), m_rawPrivateData.size());
+    QByteArray privateKey;
+    auto scrubPrivateData = qScopeGuard([&privateData, &privateKey] {
+        Botan::secure_scrub_memory(privateData.data(), static_cast<size_t>(privateData.size()));
+        Botan::secure_scrub_memory(privateKey.data(), static_cast<size_t>(privateKey.size()));
+    });
+    BinaryStream privateStream(&privateData);
+    signature.clear();
+    BinaryStream signatureStream(&signature);
+    auto rng = randomGen()->getRng();
+
+    try {
+        if (m_type == "ssh-ed25519") {
+            QByteArray publicKey;
+            if (!privateStream.readString(publicKey) || !privateStream.readString(privateKey)) {
+                m_error = tr("Unexpected EOF while reading private key");
+                return false;
+            }
+
+            Botan::Ed25519_PrivateKey key(Botan::secure_vector<uint8_t>(privateKey.begin(), privateKey.end()));
+            Botan::PK_Signer signer(key, *rng, "Pure");
+            signatureStream.writeString(m_type);
+            signatureStream.writeString(signMessage(signer, data));
+            return true;
+        } else if (m_type == "ssh-rsa") {
+            Botan::BigInt n, e, d, iqmp, p, q;
+            if (!readBigInt(privateStream, n) || !readBigInt(privateStream, e) || !readBigInt(privateStream, d)
+                || !readBigInt(privateStream, iqmp) || !readBigInt(privateStream, p)
+                || !readBigInt(privateStream, q)) {
+                m_error = tr("Unexpected EOF while reading private key");
+                return false;
+            }
+
+            QString algorithm = "ssh-rsa";
+            std::string padding = "EMSA3(SHA-1)";
+            if (flags & SIGN_RSA_SHA2_512) {
+                algorithm = "rsa-sha2-512";
+                padding = "EMSA3(SHA-512)";
+            } else if (flags & SIGN_RSA_SHA2_256) {
+                algorithm = "rsa-sha2-256";
+                padding = "EMSA3(SHA-256)";
+            }
+
+            Botan::RSA_PrivateKey key(p, q, e, d, n);
+            Botan::PK_Signer signer(key, *rng, padding);
+            signatureStream.writeString(algorithm);
+            signatureStream.writeString(signMessage(signer, data));
+            return true;
+        } else if (m_type.startsWith("ecdsa-sha2-nistp")) {
+            QString curve;
+            QByteArray publicKey;
+            Botan::BigInt x;
+            if (!privateStream.readString(curve) || !privateStream.readString(publicKey)
+                || !readBigInt(privateStream, x)) {
+                m_error = tr("Unexpected EOF while reading private key");
+                return false;
+            }
+
+            // clang-format off
+            static const QMap<QString, QPair<std::string, std::string>> curves {
+                { "nistp256", {"secp256r1", "EMSA1(SHA-256)"} },
+                { "nistp384", {"secp384r1", "EMSA1(SHA-384)"} },
+                { "nistp521", {"secp521r1", "EMSA1(SHA-512)"} },
+            };
+            // clang-format on
+            if (!curves.contains(curve)) {
+                m_error = tr("Unknown key type: %1").arg(m_type);
+                return false;
+            }
+
+            Botan::ECDSA_PrivateKey key(*rng, Botan::EC_Group(curves[curve].first), x);
+            Botan::PK_Signer signer(key, *rng, curves[curve].second);
+            // The signature is r and s of equal size concatenated
+            auto rs = signMessage(signer, data);
+            QByteArray ecdsaSignature;
+            BinaryStream ecdsaStream(&ecdsaSignature);
+            writeMPInt(ecdsaStream, rs.left(rs.size() / 2));
+            writeMPInt(ecdsaStream, rs.mid(rs.size() / 2));
+
+            signatureStream.writeString(m_type);
+            signatureStream.writeString(ecdsaSignature);
+            return true;
+        }
+    } catch (std::exception& e) {
+        m_error = tr("Signing failed: %1").arg(e.what());
+        return false;
+    }
+
+    m_error = tr("Signing is not supported for key type: %1").arg(m_type);
+    return false;
+}
@@ -57,11 +57,16 @@ public:
     bool writePublic(BinaryStream& stream);
     bool writePrivate(BinaryStream& stream);
 
+    bool sign(const QByteArray& data, QByteArray& signature, quint32 flags = 0);
+
     static const QString TYPE_DSA_PRIVATE;
     static const QString TYPE_RSA_PRIVATE;
     static const QString TYPE_OPENSSH_PRIVATE;
     static const QString OPENSSH_CIPHER_SUFFIX;
 
+    static const quint32 SIGN_RSA_SHA2_256 = 2;
+    static const quint32 SIGN_RSA_SHA2_512 = 4;
+
 private:
     enum KeyPart
     {
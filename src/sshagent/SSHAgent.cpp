@@ -22,11 +22,15 @@
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "sshagent/BinaryStream.h"
+#include "sshagent/KeeAgentEntryIndex.h"
 #include "sshagent/KeeAgentSettings.h"
+#include "sshagent/SSHAgentServer.h"
 
+#include <QDir>
 #include <QFileInfo>
-#include <QLocalSocket>
+#include <QStandardPaths>
 #include <QThread>
+#include <QtConcurrent>
 
 #ifdef Q_OS_WIN
 #include <QtEndian>
@@ -40,6 +44,15 @@ SSHAgent* SSHAgent::instance()
     return s_sshAgent;
 }
 
+SSHAgent::SSHAgent()
+{
+    // The connection must not outlive the event dispatcher of the application
+    auto app = QCoreApplication::instance();
+    if (app) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &SSHAgent::disconnectAgent);
+    }
+}
+
 bool SSHAgent::isEnabled() const
 {
     return config()->get(Config::SSHAgent_Enabled).toBool();
@@ -49,6 +62,8 @@ void SSHAgent::setEnabled(bool enabled)
 {
     if (isEnabled() && !enabled) {
         removeAllIdentities();
+        disconnectAgent();
+        stopServer();
     }
 
     config()->set(Config::SSHAgent_Enabled, enabled);
@@ -134,6 +149,45 @@ QString SSHAgent::securityKeyProvider(bool allowOverride) const
     return skProvider;
 }
 
+/**
+ * @return true if the keys of unlocked databases are served on the own agent socket
+ *         instead of being added to an external agent
+ */
+bool SSHAgent::serveKeys() const
+{
+    return config()->get(Config::SSHAgent_ServeKeys).toBool();
+}
+
+void SSHAgent::setServeKeys(bool serveKeys)
+{
+    if (!serveKeys) {
+        stopServer();
+    }
+
+    config()->set(Config::SSHAgent_ServeKeys, serveKeys);
+}
+
+/**
+ * @return path of the agent socket served by KeePassXC, a pipe name on Windows
+ */
+QString SSHAgent::serverSocketPath() const
+{
+    auto path = config()->get(Config::SSHAgent_ServerSocketPath).toString();
+    if (!path.isEmpty()) {
+        return path;
+    }
+
+#ifndef Q_OS_WIN
+    auto runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (runtimeDir.isEmpty()) {
+        runtimeDir = QDir::tempPath();
+    }
+    return runtimeDir + "/keepassxc-ssh-agent.socket";
+#else
+    return "\\\\.\\pipe\\keepassxc-ssh-agent";
+#endif
+}
+
 const QString SSHAgent::errorString() const
 {
     return m_error;
@@ -163,38 +217,135 @@ bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out)
     if (usePageant() && !sendMessagePageant(in, out)) {
         return false;
     }
-    if (useOpenSSH() && !sendMessageOpenSSH(in, out)) {
+    if (!useOpenSSH()) {
+        return true;
+    }
+#endif
+    QList<QByteArray> responses;
+    if (!sendMessagesOpenSSH({in}, responses)) {
         return false;
     }
+    out = responses.first();
     return true;
-#else
-    return sendMessageOpenSSH(in, out);
+}
+
+/**
+ * Send several messages to the agent and read all responses.
+ *
+ * @param in messages to send
+ * @param out responses in the order of the messages
+ * @return true if a response was read for every message
+ */
+bool SSHAgent::sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out)
+{
+#ifdef Q_OS_WIN
+    if (usePageant() || !useOpenSSH()) {
+        // Pageant handles one message at a time
+        out.clear();
+        for (const auto& message : in) {
+            QByteArray response;
+            if (!sendMessage(message, response)) {
+                return false;
+            }
+            out.append(response);
+        }
+        return true;
+    }
 #endif
+    return sendMessagesOpenSSH(in, out);
 }
 
-bool SSHAgent::sendMessageOpenSSH(const QByteArray& in, QByteArray& out)
+bool SSHAgent::sendMessagesOpenSSH(const QList<QByteArray>& in, QList<QByteArray>& out)
 {
-    QLocalSocket socket;
-    BinaryStream stream(&socket);
+    // The agent may have closed an idle connection, which is only noticed once it is used again
+    bool reused = m_socket && m_socket->state() == QLocalSocket::ConnectedState && m_socket->bytesAvailable() == 0
+                  && m_socketPath == socketPath();
+    if (!reused && !connectAgent()) {
+        return false;
+    }
 
-    socket.connectToServer(socketPath());
-    if (!socket.waitForConnected(500)) {
-        m_error = tr("Agent connection failed.");
+    if (exchangeMessages(in, out)) {
+        return true;
+    }
+    disconnectAgent();
+
+    if (!reused || !connectAgent()) {
         return false;
     }
+    if (exchangeMessages(in, out)) {
+        return true;
+    }
+    disconnectAgent();
+    return false;
+}
 
-    stream.writeString(in);
-    stream.flush();
+bool SSHAgent::connectAgent()
+{
+    disconnectAgent();
 
-    if (!stream.readString(out)) {
-        m_error = tr("Agent protocol error.");
+    m_socketPath = socketPath();
+    m_socket.reset(new QLocalSocket());
+    m_socket->connectToServer(m_socketPath);
+    if (!m_socket->waitForConnected(500)) {
+        m_error = tr("Agent connection failed.");
+        disconnectAgent();
         return false;
     }
+    return true;
+}
+
+/**
+ * Pipeline messages over the current connection, the agent answers them in order.
+ */
+bool SSHAgent::exchangeMessages(const QList<QByteArray>& in, QList<QByteArray>& out)
+{
+    BinaryStream stream(m_socket.data());
+    out.clear();
+
+    for (int first = 0; first < in.size(); first += MAX_PIPELINED_MESSAGES) {
+        const int last = qMin(in.size(), first + MAX_PIPELINED_MESSAGES);
+        for (int i = first; i < last; ++i) {
+            stream.writeString(in.at(i));
+        }
+        stream.flush();
+
+        for (int i = first; i < last; ++i) {
+            QByteArray response;
+            if (!stream.readString(response)) {
+                m_error = tr("Agent protocol error.");
+                return false;
+            }
+            out.append(response);
+        }
+    }
+
+    return true;
+}
+
+void SSHAgent::disconnectAgent()
+{
+    m_socket.reset();
+    m_socketPath.clear();
+}
 
-    socket.close();
+bool SSHAgent::startServer()
+{
+    if (!m_server) {
+        m_server = new SSHAgentServer(this);
+    }
+    if (!m_server->listen(serverSocketPath())) {
+        m_error = m_server->errorString();
+        return false;
+    }
     return true;
 }
 
+void SSHAgent::stopServer()
+{
+    delete m_server;
+    m_server = nullptr;
+}
+
 #ifdef Q_OS_WIN
 bool SSHAgent::sendMessagePageant(const QByteArray& in, QByteArray& out)
 {
@@ -280,6 +431,16 @@ bool SSHAgent::addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, co
         return false;
     }
 
+    QByteArray responseData;
+    if (!sendMessage(addIdentityRequest(key, settings), responseData)) {
+        return false;
+    }
+
+    return addIdentityResponse(key, settings, databaseUuid, responseData);
+}
+
+QByteArray SSHAgent::addIdentityRequest(OpenSSHKey& key, const KeeAgentSettings& settings)
+{
     QByteArray requestData;
     BinaryStream request(&requestData);
     bool isSecurityKey = key.type().startsWith("sk-");
@@ -305,11 +466,20 @@ bool SSHAgent::addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, co
         request.writeString(securityKeyProvider());
     }
 
-    QByteArray responseData;
-    if (!sendMessage(requestData, responseData)) {
-        return false;
-    }
+    return requestData;
+}
 
+/**
+ * Handle the response of the agent to adding an identity.
+ *
+ * @return true if the agent accepted the identity
+ */
+bool SSHAgent::addIdentityResponse(const OpenSSHKey& key,
+                                   const KeeAgentSettings& settings,
+                                   const QUuid& databaseUuid,
+                                   const QByteArray& responseData)
+{
+    bool isSecurityKey = key.type().startsWith("sk-");
     if (responseData.length() < 1 || static_cast<quint8>(responseData[0]) != SSH_AGENT_SUCCESS) {
         m_error =
             tr("Agent refused this identity. Possible reasons include:") + "\n" + tr("The key has already been added.");
@@ -492,6 +662,10 @@ void SSHAgent::databaseLocked(const QSharedPointer<Database>& db)
         return;
     }
 
+    if (m_server) {
+        m_server->removeDatabase(db);
+    }
+
     auto it = m_addedKeys.begin();
     while (it != m_addedKeys.end()) {
         if (it.value().first != db->uuid()) {
@@ -514,31 +688,98 @@ void SSHAgent::databaseUnlocked(const QSharedPointer<Database>& db)
         return;
     }
 
-    for (auto entry : db->rootGroup()->entriesRecursive()) {
+    // Keys are only read once a client asks for them
+    if (serveKeys()) {
+        if (startServer()) {
+            m_server->addDatabase(db);
+        } else {
+            emit error(m_error);
+        }
+        return;
+    }
+
+    struct PendingIdentity
+    {
+        KeeAgentSettings settings;
+        OpenSSHKey key;
+        QString password;
+        QString comment;
+        bool opened = false;
+    };
+    QList<PendingIdentity> identities;
+
+    auto index = KeeAgentEntryIndex::forDatabase(db.data());
+    for (auto* entry : index->entries()) {
         if (entry->isRecycled()) {
             continue;
         }
 
-        KeeAgentSettings settings;
+        PendingIdentity identity;
 
-        if (!settings.fromEntry(entry)) {
+        if (!index->settings(entry, identity.settings)) {
             continue;
         }
 
-        if (!settings.allowUseOfSshKey() || !settings.addAtDatabaseOpen()) {
+        if (!identity.settings.allowUseOfSshKey() || !identity.settings.addAtDatabaseOpen()) {
             continue;
         }
 
-        OpenSSHKey key;
+        // Only read the key here, decrypting it is left to the worker threads
+        if (!identity.settings.toOpenSSHKey(entry, identity.key, false)) {
+            continue;
+        }
+
+        identity.password = entry->password();
+        identity.comment = identity.key.comment();
+        identities.append(identity);
+    }
 
-        if (!settings.toOpenSSHKey(entry, key, true)) {
+    QtConcurrent::blockingMap(identities, [](PendingIdentity& identity) {
+        identity.opened = identity.key.openKey(identity.password);
+        // The comment stored in the encrypted part replaces the one derived from the entry
+        if (identity.key.comment().isEmpty()) {
+            identity.key.setComment(identity.comment);
+        }
+    });
+
+    QList<PendingIdentity*> pending;
+    QList<QByteArray> requests;
+    bool knownKeys = true;
+    for (auto& identity : identities) {
+        if (!identity.opened) {
+            continue;
+        }
+        // Ignore ownership conflicts of keys previously added by another database
+        auto added = m_addedKeys.constFind(identity.key);
+        if (added != m_addedKeys.constEnd() && added->first != db->uuid()) {
             continue;
         }
+        knownKeys = knownKeys && added != m_addedKeys.constEnd();
+        pending.append(&identity);
+        requests.append(addIdentityRequest(identity.key, identity.settings));
+    }
 
-        // Add key to agent; ignore errors if we have previously added the key
-        bool known_key = m_addedKeys.contains(key);
-        if (!addIdentity(key, settings, db->uuid()) && !known_key) {
-            emit error(m_error);
+    if (requests.isEmpty()) {
+        return;
+    }
+
+    QList<QByteArray> responses;
+    if (!isAgentRunning()) {
+        m_error = tr("No agent running, cannot add identity.");
+    } else if (sendMessages(requests, responses)) {
+        for (int i = 0; i < pending.size(); ++i) {
+            // Add key to agent; ignore errors if we have previously added the key
+            bool known_key = m_addedKeys.contains(pending.at(i)->key);
+            if (!addIdentityResponse(pending.at(i)->key, pending.at(i)->settings, db->uuid(), responses.at(i))
+                && !known_key) {
+                emit error(m_error);
+            }
         }
+        return;
+    }
+
+    // The agent could not be reached at all, report that once
+    if (!knownKeys) {
+        emit error(m_error);
     }
 }
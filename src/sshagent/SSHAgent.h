@@ -20,17 +20,20 @@
 #define KEEPASSXC_SSHAGENT_H
 
 #include <QHash>
+#include <QLocalSocket>
 
 #include "OpenSSHKey.h"
 
 class KeeAgentSettings;
 class Database;
+class SSHAgentServer;
 
 class SSHAgent : public QObject
 {
     Q_OBJECT
 
 public:
+    SSHAgent();
     ~SSHAgent() override = default;
     static SSHAgent* instance();
 
@@ -48,6 +51,9 @@ public:
     void setUseOpenSSH(bool useOpenSSH);
     void setUsePageant(bool usePageant);
 #endif
+    bool serveKeys() const;
+    void setServeKeys(bool serveKeys);
+    QString serverSocketPath() const;
 
     const QString errorString() const;
     bool isAgentRunning() const;
@@ -79,8 +85,23 @@ private:
     const quint8 SSH_AGENT_CONSTRAIN_CONFIRM = 2;
     const quint8 SSH_AGENT_CONSTRAIN_EXTENSION = 255;
 
+    // Keys are added in batches of this size without waiting for each response
+    const int MAX_PIPELINED_MESSAGES = 32;
+
+    QByteArray addIdentityRequest(OpenSSHKey& key, const KeeAgentSettings& settings);
+    bool addIdentityResponse(const OpenSSHKey& key,
+                             const KeeAgentSettings& settings,
+                             const QUuid& databaseUuid,
+                             const QByteArray& responseData);
+
     bool sendMessage(const QByteArray& in, QByteArray& out);
-    bool sendMessageOpenSSH(const QByteArray& in, QByteArray& out);
+    bool sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out);
+    bool sendMessagesOpenSSH(const QList<QByteArray>& in, QList<QByteArray>& out);
+    bool connectAgent();
+    bool exchangeMessages(const QList<QByteArray>& in, QList<QByteArray>& out);
+    void disconnectAgent();
+    bool startServer();
+    void stopServer();
 #ifdef Q_OS_WIN
     bool sendMessagePageant(const QByteArray& in, QByteArray& out);
 
@@ -90,6 +111,13 @@ private:
 
     QHash<OpenSSHKey, QPair<QUuid, bool>> m_addedKeys;
     QString m_error;
+
+    // Connection to the OpenSSH agent, kept open between messages
+    QScopedPointer<QLocalSocket> m_socket;
+    QString m_socketPath;
+
+    // Agent socket of KeePassXC itself, only created when serving keys
+    SSHAgentServer* m_server = nullptr;
 };
 
 static inline SSHAgent* sshAgent()
@@ -0,0 +1,376 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SSHAgentServer.h"
+
+#include "core/Clock.h"
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/Tools.h"
+#include "sshagent/BinaryStream.h"
+#include "sshagent/KeeAgentEntryIndex.h"
+#include "sshagent/KeeAgentSettings.h"
+#include "sshagent/OpenSSHKey.h"
+
+#include <QLocalSocket>
+#include <QtEndian>
+
+SSHAgentServer::SSHAgentServer(QObject* parent)
+    : QObject(parent)
+{
+    m_server.setSocketOptions(QLocalServer::UserAccessOption);
+    connect(&m_server, &QLocalServer::newConnection, this, &SSHAgentServer::acceptConnections);
+}
+
+SSHAgentServer::~SSHAgentServer()
+{
+    close();
+}
+
+/**
+ * Start serving on a socket.
+ *
+ * @param socketPath path of the socket, or name of the pipe on Windows
+ * @return true if the server is listening
+ */
+bool SSHAgentServer::listen(const QString& socketPath)
+{
+    if (m_server.isListening()) {
+        if (m_server.fullServerName() == socketPath) {
+            return true;
+        }
+        close();
+    }
+
+    // Remove a socket left behind by a previous instance, but nothing else at that path
+    if (!Tools::removeStaleSocket(socketPath)) {
+        m_error = tr("Refusing to replace %1, it is not a socket of the current user.").arg(socketPath);
+        return false;
+    }
+    if (!m_server.listen(socketPath)) {
+        m_error = tr("Failed to listen on the agent socket %1: %2").arg(socketPath, m_server.errorString());
+        return false;
+    }
+    return true;
+}
+
+void SSHAgentServer::close()
+{
+    for (auto it = m_pendingData.constBegin(); it != m_pendingData.constEnd(); ++it) {
+        it.key()->disconnect(this);
+        it.key()->deleteLater();
+    }
+    m_pendingData.clear();
+    m_server.close();
+}
+
+bool SSHAgentServer::isListening() const
+{
+    return m_server.isListening();
+}
+
+const QString SSHAgentServer::errorString() const
+{
+    return m_error;
+}
+
+/**
+ * Serve the keys of an unlocked database that are set to be added at database open.
+ *
+ * @param db unlocked database
+ */
+void SSHAgentServer::addDatabase(const QSharedPointer<Database>& db)
+{
+    removeDatabase(db);
+
+    ServedDatabase served;
+    served.database = db.data();
+    served.addedAt = Clock::currentMilliSecondsSinceEpoch();
+    m_databases.append(served);
+
+    connect(db.data(), &Database::modified, this, &SSHAgentServer::invalidateIdentities);
+    connect(db.data(), &Database::databaseDiscarded, this, &SSHAgentServer::invalidateIdentities);
+    m_identitiesValid = false;
+}
+
+/**
+ * Stop serving the keys of a database and discard its decrypted private keys.
+ *
+ * @param db locked database
+ */
+void SSHAgentServer::removeDatabase(const QSharedPointer<Database>& db)
+{
+    if (!db) {
+        return;
+    }
+
+    disconnect(db.data(), nullptr, this, nullptr);
+    for (int i = m_databases.size() - 1; i >= 0; --i) {
+        if (!m_databases.at(i).database || m_databases.at(i).database == db.data()) {
+            m_databases.removeAt(i);
+        }
+    }
+    for (int i = m_identities.size() - 1; i >= 0; --i) {
+        if (!m_identities.at(i).database || m_identities.at(i).database == db.data()) {
+            m_identities.removeAt(i);
+        }
+    }
+    m_identityIndex.clear();
+    m_identitiesValid = false;
+}
+
+/**
+ * Answer a single agent request.
+ *
+ * @param request request message without the length prefix
+ * @return response message without the length prefix
+ */
+QByteArray SSHAgentServer::handleRequest(const QByteArray& request)
+{
+    QByteArray requestData = request;
+    BinaryStream stream(&requestData);
+
+    quint8 type;
+    if (!stream.read(type)) {
+        return failure();
+    }
+
+    if (type == SSH_AGENTC_REQUEST_IDENTITIES) {
+        return identitiesAnswer();
+    }
+
+    if (type == SSH_AGENTC_SIGN_REQUEST) {
+        QByteArray keyBlob;
+        QByteArray data;
+        quint32 flags;
+        if (!stream.readString(keyBlob) || !stream.readString(data) || !stream.read(flags)) {
+            return failure();
+        }
+        return signResponse(keyBlob, data, flags);
+    }
+
+    return failure();
+}
+
+void SSHAgentServer::acceptConnections()
+{
+    while (m_server.hasPendingConnections()) {
+        auto socket = m_server.nextPendingConnection();
+        // Only the user running KeePassXC may use its keys
+        if (!Tools::isSocketPeerSameUser(socket->socketDescriptor())) {
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        m_pendingData.insert(socket, {});
+        connect(socket, &QLocalSocket::readyRead, this, &SSHAgentServer::readRequests);
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket] {
+            m_pendingData.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void SSHAgentServer::readRequests()
+{
+    auto socket = qobject_cast<QLocalSocket*>(sender());
+    auto pending = m_pendingData.find(socket);
+    if (!socket || pending == m_pendingData.end()) {
+        return;
+    }
+
+    pending->append(socket->readAll());
+
+    // Clients may pipeline several requests, each is answered in order
+    QByteArray responses;
+    BinaryStream responseStream(&responses);
+    while (pending->size() >= 4) {
+        quint32 length = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(pending->constData()));
+        if (length > AGENT_MAX_MSGLEN) {
+            m_pendingData.erase(pending);
+            socket->disconnectFromServer();
+            return;
+        }
+        if (static_cast<quint32>(pending->size()) - 4 < length) {
+            break;
+        }
+
+        auto response = handleRequest(pending->mid(4, static_cast<int>(length)));
+        pending->remove(0, static_cast<int>(length) + 4);
+        responseStream.writeString(response);
+    }
+
+    if (!responses.isEmpty()) {
+        socket->write(responses);
+        socket->flush();
+    }
+}
+
+void SSHAgentServer::invalidateIdentities()
+{
+    m_identitiesValid = false;
+}
+
+/**
+ * Index the public keys of all served databases.
+ *
+ * Keys are read without decrypting them where the key format allows it,
+ * private keys already decrypted for an unchanged identity are kept.
+ */
+void SSHAgentServer::buildIdentities()
+{
+    QHash<QPair<QUuid, QByteArray>, QSharedPointer<OpenSSHKey>> decryptedKeys;
+    for (const auto& identity : asConst(m_identities)) {
+        if (identity.key) {
+            decryptedKeys.insert(qMakePair(identity.entryUuid, identity.keyBlob), identity.key);
+        }
+    }
+
+    m_identities.clear();
+    m_identityIndex.clear();
+    m_identitiesValid = true;
+
+    for (const auto& served : asConst(m_databases)) {
+        if (!served.database || !served.database->rootGroup()) {
+            continue;
+        }
+
+        auto index = KeeAgentEntryIndex::forDatabase(served.database);
+        for (auto* entry : index->entries()) {
+            if (entry->isRecycled()) {
+                continue;
+            }
+
+            KeeAgentSettings settings;
+            if (!index->settings(entry, settings) || !settings.allowUseOfSshKey() || !settings.addAtDatabaseOpen()) {
+                continue;
+            }
+            // There is nobody to ask for a confirmation
+            if (settings.useConfirmConstraintWhenAdding()) {
+                continue;
+            }
+
+            OpenSSHKey key;
+            if (!settings.toOpenSSHKey(entry, key, false)) {
+                continue;
+            }
+
+            Identity identity;
+            BinaryStream keyStream(&identity.keyBlob);
+            if (!key.writePublic(keyStream)) {
+                continue;
+            }
+            // The first database owns a key that is stored in several databases
+            if (m_identityIndex.contains(identity.keyBlob)) {
+                continue;
+            }
+
+            identity.database = served.database;
+            identity.entryUuid = entry->uuid();
+            identity.comment = key.comment();
+            if (settings.useLifetimeConstraintWhenAdding()) {
+                identity.expiresAt = served.addedAt + settings.lifetimeConstraintDuration() * 1000LL;
+            }
+            identity.key = decryptedKeys.value(qMakePair(identity.entryUuid, identity.keyBlob));
+
+            m_identityIndex.insert(identity.keyBlob, m_identities.size());
+            m_identities.append(identity);
+        }
+    }
+}
+
+bool SSHAgentServer::isExpired(const Identity& identity) const
+{
+    return identity.expiresAt > 0 && Clock::currentMilliSecondsSinceEpoch() >= identity.expiresAt;
+}
+
+QByteArray SSHAgentServer::identitiesAnswer()
+{
+    if (!m_identitiesValid) {
+        buildIdentities();
+    }
+
+    QByteArray identitiesData;
+    BinaryStream identitiesStream(&identitiesData);
+    quint32 count = 0;
+    for (const auto& identity : asConst(m_identities)) {
+        if (!isExpired(identity)) {
+            identitiesStream.writeString(identity.keyBlob);
+            identitiesStream.writeString(identity.comment);
+            ++count;
+        }
+    }
+
+    QByteArray responseData;
+    BinaryStream response(&responseData);
+    response.write(SSH_AGENT_IDENTITIES_ANSWER);
+    response.write(count);
+    response.write(identitiesData);
+    return responseData;
+}
+
+QByteArray SSHAgentServer::signResponse(const QByteArray& keyBlob, const QByteArray& data, quint32 flags)
+{
+    if (!m_identitiesValid) {
+        buildIdentities();
+    }
+
+    auto index = m_identityIndex.constFind(keyBlob);
+    if (index == m_identityIndex.constEnd()) {
+        return failure();
+    }
+
+    auto& identity = m_identities[index.value()];
+    if (isExpired(identity) || !identity.database) {
+        return failure();
+    }
+
+    if (!identity.key) {
+        auto entry = identity.database->rootGroup()->findEntryByUuid(identity.entryUuid);
+        auto index = KeeAgentEntryIndex::forDatabase(identity.database);
+        KeeAgentSettings settings;
+        auto key = QSharedPointer<OpenSSHKey>::create();
+        if (!entry || !index->settings(entry, settings) || !settings.toOpenSSHKey(entry, *key, true)) {
+            return failure();
+        }
+
+        // The entry may have changed since the identities were listed
+        QByteArray decryptedBlob;
+        BinaryStream keyStream(&decryptedBlob);
+        if (!key->writePublic(keyStream) || decryptedBlob != keyBlob) {
+            return failure();
+        }
+        identity.key = key;
+    }
+
+    QByteArray signature;
+    if (!identity.key->sign(data, signature, flags)) {
+        m_error = identity.key->errorString();
+        return failure();
+    }
+
+    QByteArray responseData;
+    BinaryStream response(&responseData);
+    response.write(SSH_AGENT_SIGN_RESPONSE);
+    response.writeString(signature);
+    return responseData;
+}
+
+QByteArray SSHAgentServer::failure() const
+{
+    return QByteArray(1, static_cast<char>(SSH_AGENT_FAILURE));
+}
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_SSHAGENTSERVER_H
+#define KEEPASSXC_SSHAGENTSERVER_H
+
+#include <QHash>
+#include <QLocalServer>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QUuid>
+
+class Database;
+class OpenSSHKey;
+class QLocalSocket;
+
+/**
+ * SSH agent serving the keys of the unlocked databases on its own socket.
+ *
+ * Instead of pushing every key into an external agent when a database is
+ * unlocked, the server only keeps track of the databases. The list of
+ * identities is built from the public keys on the first request and rebuilt
+ * after a database was modified, private keys are decrypted on their first
+ * sign request and kept until the database is locked. Only identities and
+ * signatures are served, all other requests are answered with a failure.
+ */
+class SSHAgentServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SSHAgentServer(QObject* parent = nullptr);
+    ~SSHAgentServer() override;
+
+    bool listen(const QString& socketPath);
+    void close();
+    bool isListening() const;
+    const QString errorString() const;
+
+    void addDatabase(const QSharedPointer<Database>& db);
+    void removeDatabase(const QSharedPointer<Database>& db);
+
+    QByteArray handleRequest(const QByteArray& request);
+
+private slots:
+    void acceptConnections();
+    void readRequests();
+    void invalidateIdentities();
+
+private:
+    const quint8 SSH_AGENT_FAILURE = 5;
+    const quint8 SSH_AGENTC_REQUEST_IDENTITIES = 11;
+    const quint8 SSH_AGENT_IDENTITIES_ANSWER = 12;
+    const quint8 SSH_AGENTC_SIGN_REQUEST = 13;
+    const quint8 SSH_AGENT_SIGN_RESPONSE = 14;
+
+    // Same limit as the OpenSSH agent, larger messages close the connection
+    const quint32 AGENT_MAX_MSGLEN = 256 * 1024;
+
+    struct Identity
+    {
+        QPointer<Database> database;
+        QUuid entryUuid;
+        QByteArray keyBlob;
+        QString comment;
+        qint64 expiresAt = 0;
+        // Holds the private key after the first signature
+        QSharedPointer<OpenSSHKey> key;
+    };
+
+    struct ServedDatabase
+    {
+        QPointer<Database> database;
+        qint64 addedAt = 0;
+    };
+
+    void buildIdentities();
+    bool isExpired(const Identity& identity) const;
+    QByteArray identitiesAnswer();
+    QByteArray signResponse(const QByteArray& keyBlob, const QByteArray& data, quint32 flags);
+    QByteArray failure() const;
+
+    QLocalServer m_server;
+    QString m_error;
+    QHash<QLocalSocket*, QByteArray> m_pendingData;
+
+    QList<ServedDatabase> m_databases;
+    QList<Identity> m_identities;
+    QHash<QByteArray, int> m_identityIndex;
+    bool m_identitiesValid = false;
+};
+
+#endif // KEEPASSXC_SSHAGENTSERVER_H
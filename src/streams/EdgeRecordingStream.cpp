@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EdgeRecordingStream.h"
+
+/**
+ * @param baseDevice device to write to
+ * @param edgeSize number of bytes to keep of the start and the end of the data
+ */
+EdgeRecordingStream::EdgeRecordingStream(QIODevice* baseDevice, qint64 edgeSize)
+    : LayeredStream(baseDevice)
+    , m_edgeSize(edgeSize)
+{
+}
+
+/**
+ * @return number of bytes written to the base device
+ */
+qint64 EdgeRecordingStream::writtenSize() const
+{
+    return m_writtenSize;
+}
+
+/**
+ * @return first bytes written, up to the edge size
+ */
+QByteArray EdgeRecordingStream::head() const
+{
+    return m_head;
+}
+
+/**
+ * @return last bytes written, up to the edge size
+ */
+QByteArray EdgeRecordingStream::tail() const
+{
+    return m_tail;
+}
+
+qint64 EdgeRecordingStream::writeData(const char* data, qint64 maxSize)
+{
+    const qint64 written = LayeredStream::writeData(data, maxSize);
+    if (written < 0) {
+        setErrorString(m_baseDevice->errorString());
+        return written;
+    }
+
+    if (m_head.size() < m_edgeSize) {
+        m_head.append(data, static_cast<int>(qMin(written, m_edgeSize - m_head.size())));
+    }
+    if (written >= m_edgeSize) {
+        m_tail = QByteArray(data + written - m_edgeSize, static_cast<int>(m_edgeSize));
+    } else {
+        m_tail.append(data, static_cast<int>(written));
+        if (m_tail.size() > m_edgeSize) {
+            m_tail.remove(0, static_cast<int>(m_tail.size() - m_edgeSize));
+        }
+    }
+    m_writtenSize += written;
+    return written;
+}
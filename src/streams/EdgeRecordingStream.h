@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_EDGERECORDINGSTREAM_H
+#define KEEPASSXC_EDGERECORDINGSTREAM_H
+
+#include "streams/LayeredStream.h"
+
+/**
+ * Stream that passes written data on and keeps a copy of its start and end.
+ *
+ * Lets FileWatcher learn the checksums of a file that was just written
+ * without reading it again.
+ */
+class EdgeRecordingStream : public LayeredStream
+{
+    Q_OBJECT
+
+public:
+    EdgeRecordingStream(QIODevice* baseDevice, qint64 edgeSize);
+
+    qint64 writtenSize() const;
+    QByteArray head() const;
+    QByteArray tail() const;
+
+protected:
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    const qint64 m_edgeSize;
+    qint64 m_writtenSize = 0;
+    QByteArray m_head;
+    QByteArray m_tail;
+};
+
+#endif // KEEPASSXC_EDGERECORDINGSTREAM_H
@@ -17,6 +17,8 @@
 
 #include "HashedBlockStream.h"
 
+#include <QtEndian>
+
 #include "core/Endian.h"
 #include "crypto/CryptoHash.h"
 
@@ -24,7 +26,7 @@ const QSysInfo::Endian HashedBlockStream::ByteOrder = QSysInfo::LittleEndian;
 
 HashedBlockStream::HashedBlockStream(QIODevice* baseDevice)
     : LayeredStream(baseDevice)
-    , m_blockSize(1024 * 1024)
+    , m_blockSize(DefaultBlockSize)
 {
     init();
 }
@@ -124,31 +126,37 @@ qint64 HashedBlockStream::readData(char* data, qint64 maxSize)
 
 bool HashedBlockStream::readHashedBlock()
 {
-    bool ok;
+    // Block index, hash and size are fetched with a single read
+    char blockHeader[BlockHeaderSize];
+    qint64 headerSize = m_baseDevice->read(blockHeader, BlockHeaderSize);
 
-    auto index = Endian::readSizedInt<quint32>(m_baseDevice, ByteOrder, &ok);
-    if (!ok || index != m_blockIndex) {
+    if (headerSize < 4 || qFromLittleEndian<quint32>(blockHeader) != m_blockIndex) {
         m_error = true;
         setErrorString("Invalid block index.");
         return false;
     }
 
-    QByteArray hash = m_baseDevice->read(32);
-    if (hash.size() != 32) {
+    if (headerSize < 4 + HashSize) {
         m_error = true;
         setErrorString("Invalid hash size.");
         return false;
     }
+    const QByteArray hash = QByteArray::fromRawData(blockHeader + 4, HashSize);
 
-    m_blockSize = Endian::readSizedInt<qint32>(m_baseDevice, ByteOrder, &ok);
-    if (!ok || m_blockSize < 0) {
+    if (headerSize != BlockHeaderSize) {
+        m_error = true;
+        setErrorString("Invalid block size.");
+        return false;
+    }
+    m_blockSize = qFromLittleEndian<qint32>(blockHeader + 4 + HashSize);
+    if (m_blockSize < 0) {
         m_error = true;
         setErrorString("Invalid block size.");
         return false;
     }
 
     if (m_blockSize == 0) {
-        if (hash.count('\0') != 32) {
+        if (hash.count('\0') != HashSize) {
             m_error = true;
             setErrorString("Invalid hash of final block.");
             return false;
@@ -158,8 +166,9 @@ bool HashedBlockStream::readHashedBlock()
         return false;
     }
 
-    m_buffer = m_baseDevice->read(m_blockSize);
-    if (m_buffer.size() != m_blockSize) {
+    // Read into the existing buffer, consecutive blocks usually have the same size
+    m_buffer.resize(m_blockSize);
+    if (m_baseDevice->read(m_buffer.data(), m_blockSize) != m_blockSize) {
         m_error = true;
         setErrorString("Block too short.");
         return false;
@@ -188,6 +197,10 @@ qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
     qint64 bytesRemaining = maxSize;
     qint64 offset = 0;
 
+    if (m_buffer.capacity() < m_blockSize) {
+        m_buffer.reserve(m_blockSize);
+    }
+
     while (bytesRemaining > 0) {
         int bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(m_blockSize - m_buffer.size()));
 
@@ -212,27 +225,17 @@ qint64 HashedBlockStream::writeData(const char* data, qint64 maxSize)
 
 bool HashedBlockStream::writeHashedBlock()
 {
-    if (!Endian::writeSizedInt<qint32>(m_blockIndex, m_baseDevice, ByteOrder)) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
-        return false;
-    }
+    QByteArray blockHeader = Endian::sizedIntToBytes<qint32>(m_blockIndex, ByteOrder);
     m_blockIndex++;
 
-    QByteArray hash;
     if (!m_buffer.isEmpty()) {
-        hash = CryptoHash::hash(m_buffer, CryptoHash::Sha256);
+        blockHeader.append(CryptoHash::hash(m_buffer, CryptoHash::Sha256));
     } else {
-        hash.fill(0, 32);
-    }
-
-    if (m_baseDevice->write(hash) != hash.size()) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
-        return false;
+        blockHeader.append(HashSize, '\0');
     }
+    blockHeader.append(Endian::sizedIntToBytes<qint32>(m_buffer.size(), ByteOrder));
 
-    if (!Endian::writeSizedInt<qint32>(m_buffer.size(), m_baseDevice, ByteOrder)) {
+    if (m_baseDevice->write(blockHeader) != blockHeader.size()) {
         m_error = true;
         setErrorString(m_baseDevice->errorString());
         return false;
@@ -245,7 +248,8 @@ bool HashedBlockStream::writeHashedBlock()
             return false;
         }
 
-        m_buffer.clear();
+        // Keeps the reserved capacity for the next block
+        m_buffer.resize(0);
     }
 
     return true;
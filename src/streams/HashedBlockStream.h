@@ -27,6 +27,8 @@ class HashedBlockStream : public LayeredStream
     Q_OBJECT
 
 public:
+    static constexpr qint32 DefaultBlockSize = 1024 * 1024;
+
     explicit HashedBlockStream(QIODevice* baseDevice);
     HashedBlockStream(QIODevice* baseDevice, qint32 blockSize);
     ~HashedBlockStream() override;
@@ -46,6 +48,8 @@ private:
     bool writeHashedBlock();
 
     static const QSysInfo::Endian ByteOrder;
+    static const int HashSize = 32;
+    static const int BlockHeaderSize = 4 + HashSize + 4;
     qint32 m_blockSize;
     QByteArray m_buffer;
     int m_bufferPos;
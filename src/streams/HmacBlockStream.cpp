@@ -17,6 +17,9 @@
 
 #include "HmacBlockStream.h"
 
+#include <QtConcurrent>
+#include <QtEndian>
+
 #include "core/Endian.h"
 #include "crypto/CryptoHash.h"
 
@@ -24,7 +27,7 @@ const QSysInfo::Endian HmacBlockStream::ByteOrder = QSysInfo::LittleEndian;
 
 HmacBlockStream::HmacBlockStream(QIODevice* baseDevice, QByteArray key)
     : LayeredStream(baseDevice)
-    , m_blockSize(1024 * 1024)
+    , m_blockSize(DefaultBlockSize)
     , m_key(std::move(key))
 {
     init();
@@ -50,6 +53,21 @@ void HmacBlockStream::init()
     m_blockIndex = 0;
     m_eof = false;
     m_error = false;
+    m_verifiedBlocks.clear();
+    m_aheadError.clear();
+}
+
+/**
+ * Read several blocks at once and verify their HMACs concurrently.
+ *
+ * The data of a block is only released once it and all blocks in front of it
+ * have been verified, reading stops at the first block that fails.
+ *
+ * @param blocks number of blocks read ahead, 1 verifies every block in turn
+ */
+void HmacBlockStream::setVerifyAhead(int blocks)
+{
+    m_verifyAhead = qMax(1, blocks);
 }
 
 bool HmacBlockStream::reset()
@@ -126,49 +144,52 @@ bool HmacBlockStream::readHashedBlock()
     if (m_eof) {
         return false;
     }
-    QByteArray hmac = m_baseDevice->read(32);
-    if (hmac.size() != 32) {
-        m_error = true;
-        setErrorString("Invalid HMAC size.");
-        return false;
+    if (m_verifyAhead > 1) {
+        return readVerifiedBlock();
     }
 
-    QByteArray blockSizeBytes = m_baseDevice->read(4);
-    if (blockSizeBytes.size() != 4) {
+    // Read into the existing buffer, consecutive blocks usually have the same size
+    char hmac[HmacSize];
+    QString error = readRawBlock(hmac, m_buffer);
+    if (!error.isEmpty()) {
         m_error = true;
-        setErrorString("Invalid block size size.");
+        setErrorString(error);
         return false;
     }
-    auto blockSize = Endian::bytesToSizedInt<qint32>(blockSizeBytes, ByteOrder);
-    if (blockSize < 0) {
+
+    if (QByteArray::fromRawData(hmac, HmacSize) != blockHmac(m_blockIndex, m_buffer, m_key)) {
         m_error = true;
-        setErrorString("Invalid block size.");
+        setErrorString("Mismatch between hash and data.");
         return false;
     }
 
-    m_buffer = m_baseDevice->read(blockSize);
-    if (m_buffer.size() != blockSize) {
-        m_error = true;
-        setErrorString("Block too short.");
+    m_bufferPos = 0;
+    ++m_blockIndex;
+
+    if (m_buffer.isEmpty()) {
+        m_eof = true;
         return false;
     }
 
-    CryptoHash hasher(CryptoHash::Sha256, true);
-    hasher.setKey(getCurrentHmacKey());
-    hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
-    hasher.addData(blockSizeBytes);
-    hasher.addData(m_buffer);
+    return true;
+}
 
-    if (hmac != hasher.result()) {
+bool HmacBlockStream::readVerifiedBlock()
+{
+    if (m_verifiedBlocks.isEmpty() && m_aheadError.isEmpty()) {
+        verifyAhead();
+    }
+    if (m_verifiedBlocks.isEmpty()) {
         m_error = true;
-        setErrorString("Mismatch between hash and data.");
+        setErrorString(m_aheadError);
         return false;
     }
 
+    m_buffer = m_verifiedBlocks.takeFirst();
     m_bufferPos = 0;
     ++m_blockIndex;
 
-    if (blockSize == 0) {
+    if (m_buffer.isEmpty()) {
         m_eof = true;
         return false;
     }
@@ -176,6 +197,73 @@ bool HmacBlockStream::readHashedBlock()
     return true;
 }
 
+/**
+ * Read the next blocks and verify them on the global thread pool while the following ones are read.
+ */
+void HmacBlockStream::verifyAhead()
+{
+    QList<QByteArray> blocks;
+    QList<QFuture<bool>> checks;
+    while (blocks.size() < m_verifyAhead) {
+        QByteArray hmac(HmacSize, '\0');
+        QByteArray data;
+        m_aheadError = readRawBlock(hmac.data(), data);
+        if (!m_aheadError.isEmpty()) {
+            break;
+        }
+
+        // Captured by value, checks behind a failed block are left to finish on their own
+        quint64 blockIndex = m_blockIndex + blocks.size();
+        QByteArray key = m_key;
+        checks.append(QtConcurrent::run(
+            [blockIndex, data, hmac, key] { return hmac == blockHmac(blockIndex, data, key); }));
+        blocks.append(data);
+        if (data.isEmpty()) {
+            break;
+        }
+    }
+
+    for (int i = 0; i < checks.size(); ++i) {
+        if (!checks[i].result()) {
+            m_aheadError = "Mismatch between hash and data.";
+            return;
+        }
+        m_verifiedBlocks.append(blocks.at(i));
+    }
+}
+
+/**
+ * Read the HMAC and data of the next block from the base device.
+ *
+ * @param hmac receives the HMAC of the block
+ * @param data receives the data of the block
+ * @return error message, empty on success
+ */
+QString HmacBlockStream::readRawBlock(char* hmac, QByteArray& data)
+{
+    // Fetch HMAC and block size with a single read, small reads are costly on network file systems
+    char blockHeader[BlockHeaderSize];
+    qint64 headerSize = m_baseDevice->read(blockHeader, BlockHeaderSize);
+    if (headerSize < HmacSize) {
+        return "Invalid HMAC size.";
+    }
+    if (headerSize != BlockHeaderSize) {
+        return "Invalid block size size.";
+    }
+    auto blockSize = qFromLittleEndian<qint32>(blockHeader + HmacSize);
+    if (blockSize < 0) {
+        return "Invalid block size.";
+    }
+
+    data.resize(blockSize);
+    if (m_baseDevice->read(data.data(), blockSize) != blockSize) {
+        return "Block too short.";
+    }
+
+    memcpy(hmac, blockHeader, HmacSize);
+    return {};
+}
+
 qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
 {
     Q_ASSERT(maxSize >= 0);
@@ -187,6 +275,10 @@ qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
     qint64 bytesRemaining = maxSize;
     qint64 offset = 0;
 
+    if (m_buffer.capacity() < m_blockSize) {
+        m_buffer.reserve(m_blockSize);
+    }
+
     while (bytesRemaining > 0) {
         qint64 bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(m_blockSize - m_buffer.size()));
 
@@ -208,20 +300,10 @@ qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
 
 bool HmacBlockStream::writeHashedBlock()
 {
-    CryptoHash hasher(CryptoHash::Sha256, true);
-    hasher.setKey(getCurrentHmacKey());
-    hasher.addData(Endian::sizedIntToBytes<quint64>(m_blockIndex, ByteOrder));
-    hasher.addData(Endian::sizedIntToBytes<qint32>(m_buffer.size(), ByteOrder));
-    hasher.addData(m_buffer);
-    QByteArray hash = hasher.result();
-
-    if (m_baseDevice->write(hash) != hash.size()) {
-        m_error = true;
-        setErrorString(m_baseDevice->errorString());
-        return false;
-    }
+    QByteArray blockHeader = blockHmac(m_blockIndex, m_buffer, m_key);
+    blockHeader.append(Endian::sizedIntToBytes<qint32>(m_buffer.size(), ByteOrder));
 
-    if (!Endian::writeSizedInt<qint32>(m_buffer.size(), m_baseDevice, ByteOrder)) {
+    if (m_baseDevice->write(blockHeader) != blockHeader.size()) {
         m_error = true;
         setErrorString(m_baseDevice->errorString());
         return false;
@@ -234,15 +316,32 @@ bool HmacBlockStream::writeHashedBlock()
             return false;
         }
 
-        m_buffer.clear();
+        // Keeps the reserved capacity for the next block
+        m_buffer.resize(0);
     }
     ++m_blockIndex;
     return true;
 }
 
-QByteArray HmacBlockStream::getCurrentHmacKey() const
+/**
+ * Calculate the HMAC-SHA256 of a block, which covers its index, size and data.
+ *
+ * @param blockIndex block index
+ * @param data block data
+ * @param key HMAC key of the stream
+ * @return block HMAC
+ */
+QByteArray HmacBlockStream::blockHmac(quint64 blockIndex, const QByteArray& data, const QByteArray& key)
 {
-    return getHmacKey(m_blockIndex, m_key);
+    char indexAndSize[sizeof(quint64) + sizeof(qint32)];
+    qToLittleEndian<quint64>(blockIndex, indexAndSize);
+    qToLittleEndian<qint32>(data.size(), indexAndSize + sizeof(quint64));
+
+    CryptoHash hasher(CryptoHash::Sha256, true);
+    hasher.setKey(getHmacKey(blockIndex, key));
+    hasher.addData(QByteArray::fromRawData(indexAndSize, sizeof(indexAndSize)));
+    hasher.addData(data);
+    return hasher.result();
 }
 
 QByteArray HmacBlockStream::getHmacKey(quint64 blockIndex, const QByteArray& key)
@@ -18,6 +18,7 @@
 #ifndef KEEPASSX_HMACBLOCKSTREAM_H
 #define KEEPASSX_HMACBLOCKSTREAM_H
 
+#include <QList>
 #include <QSysInfo>
 
 #include "streams/LayeredStream.h"
@@ -27,6 +28,8 @@ class HmacBlockStream : public LayeredStream
     Q_OBJECT
 
 public:
+    static constexpr qint32 DefaultBlockSize = 1024 * 1024;
+
     explicit HmacBlockStream(QIODevice* baseDevice, QByteArray key);
     HmacBlockStream(QIODevice* baseDevice, QByteArray key, qint32 blockSize);
     ~HmacBlockStream() override;
@@ -36,6 +39,8 @@ public:
 
     static QByteArray getHmacKey(quint64 blockIndex, const QByteArray& key);
 
+    void setVerifyAhead(int blocks);
+
     bool atEnd() const override;
 
 protected:
@@ -45,10 +50,15 @@ protected:
 private:
     void init();
     bool readHashedBlock();
+    bool readVerifiedBlock();
+    void verifyAhead();
+    QString readRawBlock(char* hmac, QByteArray& data);
     bool writeHashedBlock();
-    QByteArray getCurrentHmacKey() const;
+    static QByteArray blockHmac(quint64 blockIndex, const QByteArray& data, const QByteArray& key);
 
     static const QSysInfo::Endian ByteOrder;
+    static const int HmacSize = 32;
+    static const int BlockHeaderSize = HmacSize + 4;
     qint32 m_blockSize;
     QByteArray m_buffer;
     QByteArray m_key;
@@ -56,6 +66,12 @@ private:
     quint64 m_blockIndex;
     bool m_eof;
     bool m_error;
+
+    int m_verifyAhead = 1;
+    // Blocks read ahead whose HMAC has been verified, in stream order
+    QList<QByteArray> m_verifiedBlocks;
+    // Error of the block following the verified ones
+    QString m_aheadError;
 };
 
 #endif // KEEPASSX_HMACBLOCKSTREAM_H
@@ -0,0 +1,286 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelGzipStream.h"
+
+#include <cmath>
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <zlib.h>
+
+#include "core/Endian.h"
+
+namespace
+{
+    // Size of the deflate window, also used as preset dictionary for the next chunk
+    const int WindowSize = 32 * 1024;
+
+    struct Chunk
+    {
+        QByteArray input;
+        QByteArray dictionary;
+        int level;
+        bool finish;
+    };
+
+    /**
+     * Estimate the Shannon entropy of a chunk from every fourth byte.
+     *
+     * @return bits per byte, between 0 and 8
+     */
+    double sampledEntropy(const QByteArray& data)
+    {
+        const int Stride = 4;
+        int histogram[256] = {};
+        int samples = 0;
+        auto bytes = reinterpret_cast<const uchar*>(data.constData());
+        for (int i = 0; i < data.size(); i += Stride) {
+            ++histogram[bytes[i]];
+            ++samples;
+        }
+
+        double entropy = 0.0;
+        for (int count : histogram) {
+            if (count > 0) {
+                double p = static_cast<double>(count) / samples;
+                entropy -= p * std::log2(p);
+            }
+        }
+        return entropy;
+    }
+
+    struct CompressedChunk
+    {
+        QByteArray output;
+        quint32 crc = 0;
+        bool ok = false;
+    };
+
+    CompressedChunk compressChunk(const Chunk& chunk)
+    {
+        CompressedChunk result;
+        auto input = reinterpret_cast<const Bytef*>(chunk.input.constData());
+        result.crc = static_cast<quint32>(crc32(0L, input, static_cast<uInt>(chunk.input.size())));
+
+        // Already compressed data such as images and archives is stored, data that
+        // hardly contains repetitions is only Huffman coded and text is compressed best
+        int level = chunk.level;
+        int strategy = Z_DEFAULT_STRATEGY;
+        if (level < 0) {
+            double entropy = sampledEntropy(chunk.input);
+            if (entropy >= 7.5) {
+                level = 0;
+            } else if (entropy >= 7.0) {
+                level = 1;
+                strategy = Z_HUFFMAN_ONLY;
+            } else if (entropy >= 6.0) {
+                level = 1;
+            } else {
+                level = 9;
+            }
+        }
+
+        z_stream stream = {};
+        if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK) {
+            return result;
+        }
+
+        // Neither stored nor Huffman coded blocks refer to previous data
+        if (!chunk.dictionary.isEmpty() && level > 0 && strategy != Z_HUFFMAN_ONLY) {
+            deflateSetDictionary(
+                &stream, reinterpret_cast<const Bytef*>(chunk.dictionary.constData()), chunk.dictionary.size());
+        }
+
+        // deflateBound() covers Z_FINISH, a sync flush marker adds at most a few bytes
+        result.output.resize(static_cast<int>(deflateBound(&stream, chunk.input.size())) + 16);
+        stream.next_in = const_cast<Bytef*>(input);
+        stream.avail_in = static_cast<uInt>(chunk.input.size());
+        stream.next_out = reinterpret_cast<Bytef*>(result.output.data());
+        stream.avail_out = static_cast<uInt>(result.output.size());
+
+        int flush = chunk.finish ? Z_FINISH : Z_SYNC_FLUSH;
+        int status;
+        while (true) {
+            status = deflate(&stream, flush);
+            if (status != Z_OK || stream.avail_out != 0) {
+                break;
+            }
+            int written = result.output.size();
+            result.output.resize(written + WindowSize);
+            stream.next_out = reinterpret_cast<Bytef*>(result.output.data() + written);
+            stream.avail_out = WindowSize;
+        }
+
+        result.output.resize(static_cast<int>(stream.total_out));
+        result.ok = chunk.finish ? status == Z_STREAM_END : (status == Z_OK || status == Z_BUF_ERROR);
+        deflateEnd(&stream);
+        return result;
+    }
+} // namespace
+
+ParallelGzipStream::ParallelGzipStream(QIODevice* baseDevice, int compressionLevel, int chunkSize)
+    : LayeredStream(baseDevice)
+    , m_compressionLevel(compressionLevel)
+    , m_chunkSize(qMax(chunkSize, WindowSize))
+    , m_batchSize(qMax(QThread::idealThreadCount(), 2))
+    , m_crc(0)
+    , m_inputSize(0)
+    , m_headerWritten(false)
+    , m_finished(false)
+    , m_error(false)
+{
+}
+
+ParallelGzipStream::~ParallelGzipStream()
+{
+    close();
+}
+
+bool ParallelGzipStream::open(QIODevice::OpenMode mode)
+{
+    if (mode & QIODevice::ReadOnly) {
+        qWarning("ParallelGzipStream::open: Reading is not supported.");
+        return false;
+    }
+
+    m_pending.clear();
+    m_buffer.clear();
+    m_dictionary.clear();
+    m_crc = static_cast<quint32>(crc32(0L, Z_NULL, 0));
+    m_inputSize = 0;
+    m_headerWritten = false;
+    m_finished = false;
+    m_error = false;
+
+    return LayeredStream::open(mode);
+}
+
+void ParallelGzipStream::close()
+{
+    if (isWritable() && !m_finished && !m_error) {
+        m_pending.append(m_buffer);
+        m_buffer.clear();
+        if (compressPending(true)) {
+            QByteArray trailer;
+            trailer.append(Endian::sizedIntToBytes<quint32>(m_crc, QSysInfo::LittleEndian));
+            trailer.append(Endian::sizedIntToBytes<quint32>(m_inputSize, QSysInfo::LittleEndian));
+            writeToBase(trailer);
+        }
+        m_finished = true;
+    }
+
+    LayeredStream::close();
+}
+
+qint64 ParallelGzipStream::readData(char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 ParallelGzipStream::writeData(const char* data, qint64 maxSize)
+{
+    Q_ASSERT(maxSize >= 0);
+
+    if (m_error) {
+        return -1;
+    }
+
+    qint64 offset = 0;
+    while (offset < maxSize) {
+        int bytesToCopy = static_cast<int>(qMin(maxSize - offset, static_cast<qint64>(m_chunkSize - m_buffer.size())));
+        m_buffer.append(data + offset, bytesToCopy);
+        offset += bytesToCopy;
+
+        if (m_buffer.size() == m_chunkSize) {
+            m_pending.append(m_buffer);
+            m_buffer.clear();
+            if (m_pending.size() >= m_batchSize && !compressPending(false)) {
+                return -1;
+            }
+        }
+    }
+
+    return maxSize;
+}
+
+/**
+ * Deflate all pending chunks concurrently and write them to the base device in order.
+ *
+ * @param finish whether the last pending chunk terminates the deflate stream
+ * @return true on success
+ */
+bool ParallelGzipStream::compressPending(bool finish)
+{
+    if (!m_headerWritten) {
+        // Minimal gzip member header: deflate method, no flags, no mtime, unknown OS
+        static const char header[] = {'\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\xff'};
+        if (!writeToBase(QByteArray(header, sizeof(header)))) {
+            return false;
+        }
+        m_headerWritten = true;
+    }
+
+    QVector<Chunk> chunks;
+    chunks.reserve(m_pending.size());
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const QByteArray& previous = (i == 0) ? m_dictionary : m_pending.at(i - 1);
+        bool last = finish && i == m_pending.size() - 1;
+        chunks.append({m_pending.at(i), previous.right(WindowSize), m_compressionLevel, last});
+    }
+    if (!m_pending.isEmpty()) {
+        m_dictionary = m_pending.last().right(WindowSize);
+    }
+    m_pending.clear();
+
+    QVector<CompressedChunk> results;
+    if (chunks.size() == 1) {
+        results.append(compressChunk(chunks.first()));
+    } else {
+        results = QtConcurrent::blockingMapped<QVector<CompressedChunk>>(chunks, compressChunk);
+    }
+
+    for (int i = 0; i < results.size(); ++i) {
+        const auto& result = results.at(i);
+        if (!result.ok) {
+            m_error = true;
+            setErrorString(tr("Internal zlib error when compressing."));
+            return false;
+        }
+        if (!writeToBase(result.output)) {
+            return false;
+        }
+        auto inputSize = chunks.at(i).input.size();
+        m_crc = static_cast<quint32>(crc32_combine(m_crc, result.crc, inputSize));
+        m_inputSize += static_cast<quint32>(inputSize);
+    }
+
+    return true;
+}
+
+bool ParallelGzipStream::writeToBase(const QByteArray& data)
+{
+    if (m_baseDevice->write(data) != data.size()) {
+        m_error = true;
+        setErrorString(m_baseDevice->errorString());
+        return false;
+    }
+    return true;
+}
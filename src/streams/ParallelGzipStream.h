@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_PARALLELGZIPSTREAM_H
+#define KEEPASSX_PARALLELGZIPSTREAM_H
+
+#include <QList>
+
+#include "streams/LayeredStream.h"
+
+/**
+ * Write-only gzip compressor that deflates independent chunks of the
+ * input on the global thread pool.
+ *
+ * Each chunk is primed with the last 32 KiB of its predecessor and ends
+ * on a byte boundary (Z_SYNC_FLUSH), so the concatenated output forms a
+ * single standard gzip member readable by any inflater, including
+ * QtIOCompressor.
+ *
+ * A negative compression level selects the level and strategy of every
+ * chunk from the sampled entropy of its input.
+ */
+class ParallelGzipStream : public LayeredStream
+{
+    Q_OBJECT
+
+public:
+    static const int DefaultChunkSize = 128 * 1024;
+    static const int AutoCompressionLevel = -1;
+
+    explicit ParallelGzipStream(QIODevice* baseDevice, int compressionLevel = 6, int chunkSize = DefaultChunkSize);
+    ~ParallelGzipStream() override;
+
+    bool open(QIODevice::OpenMode mode) override;
+    void close() override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    bool compressPending(bool finish);
+    bool writeToBase(const QByteArray& data);
+
+    const int m_compressionLevel;
+    const int m_chunkSize;
+    const int m_batchSize;
+    QList<QByteArray> m_pending;
+    QByteArray m_buffer;
+    QByteArray m_dictionary;
+    quint32 m_crc;
+    quint32 m_inputSize;
+    bool m_headerWritten;
+    bool m_finished;
+    bool m_error;
+};
+
+#endif // KEEPASSX_PARALLELGZIPSTREAM_H
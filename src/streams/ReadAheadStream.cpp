@@ -0,0 +1,192 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReadAheadStream.h"
+
+#include <QThread>
+
+ReadAheadStream::ReadAheadStream(QIODevice* baseDevice, int blockSize, int queueLength)
+    : LayeredStream(baseDevice)
+    , m_blockSize(qMax(blockSize, 1))
+    , m_queueLength(qMax(queueLength, 1))
+    , m_finished(false)
+    , m_aborted(false)
+    , m_baseFailed(false)
+    , m_bufferPos(0)
+    , m_error(false)
+{
+}
+
+ReadAheadStream::~ReadAheadStream()
+{
+    close();
+}
+
+bool ReadAheadStream::open(QIODevice::OpenMode mode)
+{
+    if (mode & QIODevice::WriteOnly) {
+        qWarning("ReadAheadStream::open: Writing is not supported.");
+        return false;
+    }
+
+    if (!LayeredStream::open(mode)) {
+        return false;
+    }
+
+    m_queue.clear();
+    m_baseError.clear();
+    m_finished = false;
+    m_aborted = false;
+    m_baseFailed = false;
+    m_buffer.clear();
+    m_bufferPos = 0;
+    m_error = false;
+
+    m_worker.reset(QThread::create([this] { fillQueue(); }));
+    m_worker->start();
+    return true;
+}
+
+void ReadAheadStream::close()
+{
+    stopWorker();
+    LayeredStream::close();
+}
+
+bool ReadAheadStream::atEnd() const
+{
+    if (m_error) {
+        return true;
+    }
+    if (m_bufferPos < m_buffer.size()) {
+        return false;
+    }
+
+    // Block until the worker either produced more data or hit the end of the base device,
+    // downstream layers (e.g. block ciphers removing padding) rely on this being exact.
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.isEmpty() && !m_finished) {
+        m_blockAvailable.wait(&m_mutex);
+    }
+    return m_queue.isEmpty();
+}
+
+qint64 ReadAheadStream::readData(char* data, qint64 maxSize)
+{
+    Q_ASSERT(maxSize >= 0);
+
+    if (m_error) {
+        return -1;
+    }
+
+    qint64 offset = 0;
+
+    while (offset < maxSize) {
+        if (m_bufferPos == m_buffer.size() && !takeBlock()) {
+            break;
+        }
+
+        qint64 bytesToCopy = qMin(maxSize - offset, static_cast<qint64>(m_buffer.size() - m_bufferPos));
+
+        memcpy(data + offset, m_buffer.constData() + m_bufferPos, static_cast<size_t>(bytesToCopy));
+
+        offset += bytesToCopy;
+        m_bufferPos += bytesToCopy;
+    }
+
+    if (m_error && offset == 0) {
+        return -1;
+    }
+    return offset;
+}
+
+qint64 ReadAheadStream::writeData(const char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+bool ReadAheadStream::takeBlock()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.isEmpty() && !m_finished) {
+        m_blockAvailable.wait(&m_mutex);
+    }
+
+    if (m_queue.isEmpty()) {
+        if (m_baseFailed) {
+            m_error = true;
+            setErrorString(m_baseError);
+        }
+        return false;
+    }
+
+    m_buffer = m_queue.dequeue();
+    m_bufferPos = 0;
+    m_spaceAvailable.wakeOne();
+    return true;
+}
+
+void ReadAheadStream::fillQueue()
+{
+    while (true) {
+        QByteArray block(m_blockSize, Qt::Uninitialized);
+        qint64 bytesRead = m_baseDevice->read(block.data(), m_blockSize);
+
+        QMutexLocker locker(&m_mutex);
+        if (bytesRead < 0) {
+            m_baseFailed = true;
+            m_baseError = m_baseDevice->errorString();
+            break;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+
+        block.resize(static_cast<int>(bytesRead));
+        while (m_queue.size() >= m_queueLength && !m_aborted) {
+            m_spaceAvailable.wait(&m_mutex);
+        }
+        if (m_aborted) {
+            break;
+        }
+        m_queue.enqueue(block);
+        m_blockAvailable.wakeAll();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+    m_blockAvailable.wakeAll();
+}
+
+void ReadAheadStream::stopWorker()
+{
+    if (!m_worker) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_aborted = true;
+        m_queue.clear();
+        m_spaceAvailable.wakeAll();
+    }
+
+    m_worker->wait();
+    m_worker.reset();
+}
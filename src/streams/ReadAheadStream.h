@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSX_READAHEADSTREAM_H
+#define KEEPASSX_READAHEADSTREAM_H
+
+#include <QMutex>
+#include <QQueue>
+#include <QScopedPointer>
+#include <QWaitCondition>
+
+#include "streams/LayeredStream.h"
+
+class QThread;
+
+/**
+ * Read-only layered stream that pulls data from its base device on a
+ * worker thread and hands it out in blocks through a bounded queue.
+ *
+ * Chaining several of these between expensive stream layers lets each
+ * layer run on its own thread, so a reader is limited by the slowest
+ * stage instead of the sum of all stages. The base device must not be
+ * accessed by anyone else while this stream is open.
+ */
+class ReadAheadStream : public LayeredStream
+{
+    Q_OBJECT
+
+public:
+    static const int DefaultBlockSize = 1024 * 1024;
+    static const int DefaultQueueLength = 4;
+
+    explicit ReadAheadStream(QIODevice* baseDevice,
+                             int blockSize = DefaultBlockSize,
+                             int queueLength = DefaultQueueLength);
+    ~ReadAheadStream() override;
+
+    bool open(QIODevice::OpenMode mode) override;
+    void close() override;
+    bool atEnd() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    void fillQueue();
+    bool takeBlock();
+    void stopWorker();
+
+    const int m_blockSize;
+    const int m_queueLength;
+    QScopedPointer<QThread> m_worker;
+
+    mutable QMutex m_mutex;
+    mutable QWaitCondition m_blockAvailable;
+    QWaitCondition m_spaceAvailable;
+    QQueue<QByteArray> m_queue;
+    QString m_baseError;
+    bool m_finished;
+    bool m_aborted;
+    bool m_baseFailed;
+
+    // Only accessed from the consuming thread
+    QByteArray m_buffer;
+    int m_bufferPos;
+    bool m_error;
+};
+
+#endif // KEEPASSX_READAHEADSTREAM_H
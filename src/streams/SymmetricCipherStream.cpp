@@ -17,11 +17,20 @@
 
 #include "SymmetricCipherStream.h"
 
+namespace
+{
+    // Data is processed in chunks of this size, a multiple of all cipher block sizes
+    constexpr int ChunkSize = 64 * 1024;
+    // Largest read that is decrypted in the caller's buffer at once
+    constexpr qint64 MaxDirectSize = 16 * 1024 * 1024;
+} // namespace
+
 SymmetricCipherStream::SymmetricCipherStream(QIODevice* baseDevice)
     : LayeredStream(baseDevice)
     , m_cipher(new SymmetricCipher())
     , m_bufferPos(0)
-    , m_bufferFilling(false)
+    , m_readySize(0)
+    , m_readEnd(false)
     , m_error(false)
     , m_isInitialized(false)
     , m_dataWritten(false)
@@ -45,14 +54,18 @@ bool SymmetricCipherStream::init(SymmetricCipher::Mode mode,
         return false;
     }
     m_streamCipher = m_cipher->blockSize(m_cipher->mode()) == 1;
+    // Room for a chunk and the blocks held back from the previous one
+    m_buffer.reserve(ChunkSize + 2 * blockSize());
     return true;
 }
 
 void SymmetricCipherStream::resetInternalState()
 {
-    m_buffer.clear();
+    // The reserved capacity is kept
+    m_buffer.resize(0);
     m_bufferPos = 0;
-    m_bufferFilling = false;
+    m_readySize = 0;
+    m_readEnd = false;
     m_error = false;
     m_dataWritten = false;
     m_cipher->reset();
@@ -95,75 +108,147 @@ qint64 SymmetricCipherStream::readData(char* data, qint64 maxSize)
         return -1;
     }
 
-    qint64 bytesRemaining = maxSize;
     qint64 offset = 0;
 
-    while (bytesRemaining > 0) {
-        if ((m_bufferPos == m_buffer.size()) || m_bufferFilling) {
-            if (!readBlock()) {
-                if (m_error) {
-                    return -1;
-                } else {
-                    return maxSize - bytesRemaining;
-                }
-            }
+    while (offset < maxSize) {
+        if (m_bufferPos < m_readySize) {
+            int bytesToCopy = static_cast<int>(qMin(maxSize - offset, static_cast<qint64>(m_readySize - m_bufferPos)));
+            memcpy(data + offset, m_buffer.constData() + m_bufferPos, bytesToCopy);
+            offset += bytesToCopy;
+            m_bufferPos += bytesToCopy;
+            continue;
         }
 
-        int bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(m_buffer.size() - m_bufferPos));
-
-        memcpy(data + offset, m_buffer.constData() + m_bufferPos, bytesToCopy);
+        if (m_readEnd) {
+            break;
+        }
 
-        offset += bytesToCopy;
-        m_bufferPos += bytesToCopy;
-        bytesRemaining -= bytesToCopy;
+        // Large reads are decrypted in the caller's buffer without a copy
+        if (m_buffer.size() == m_readySize && maxSize - offset >= ChunkSize) {
+            qint64 bytesRead = readDirect(data + offset, maxSize - offset);
+            if (bytesRead < 0) {
+                return -1;
+            }
+            offset += bytesRead;
+        } else if (!readBlock()) {
+            return -1;
+        }
     }
 
-    return maxSize;
+    return offset;
 }
 
-bool SymmetricCipherStream::readBlock()
+/**
+ * Read and process data in the caller's buffer, the blocks that
+ * cannot be processed yet are moved into the internal buffer.
+ *
+ * @param data output buffer
+ * @param maxSize size of the output buffer, at least one chunk
+ * @return number of processed bytes in the output buffer, -1 on error
+ */
+qint64 SymmetricCipherStream::readDirect(char* data, qint64 maxSize)
 {
-    QByteArray newData;
+    const int size = static_cast<int>(qMin(maxSize, MaxDirectSize) / blockSize() * blockSize());
+    qint64 readResult = m_baseDevice->read(data, size);
+    if (readResult == -1) {
+        m_error = true;
+        setErrorString(m_baseDevice->errorString());
+        return -1;
+    }
 
-    if (m_bufferFilling) {
-        newData.resize(blockSize() - m_buffer.size());
-    } else {
-        m_buffer.clear();
-        newData.resize(blockSize());
+    const int length = static_cast<int>(readResult);
+    const bool atEnd = length == 0 || m_baseDevice->atEnd();
+    const int ready = processableSize(length);
+    if (ready > 0 && !m_cipher->process(data, ready)) {
+        m_error = true;
+        setErrorString(m_cipher->errorString());
+        return -1;
+    }
+
+    m_buffer.resize(0);
+    m_buffer.append(data + ready, length - ready);
+    m_bufferPos = 0;
+    m_readySize = 0;
+    if (atEnd && !finishRead()) {
+        return -1;
     }
+    return ready;
+}
 
-    int readResult = m_baseDevice->read(newData.data(), newData.size());
+/**
+ * Read and process the next chunk in the internal buffer.
+ *
+ * @return false on error
+ */
+bool SymmetricCipherStream::readBlock()
+{
+    // All processed data was consumed, move the pending blocks to the front
+    m_buffer.remove(0, m_readySize);
+    m_bufferPos = 0;
+    m_readySize = 0;
 
+    const int pending = m_buffer.size();
+    m_buffer.resize(pending + ChunkSize);
+    qint64 readResult = m_baseDevice->read(m_buffer.data() + pending, ChunkSize);
     if (readResult == -1) {
+        m_buffer.resize(pending);
         m_error = true;
         setErrorString(m_baseDevice->errorString());
         return false;
-    } else {
-        m_buffer.append(newData.left(readResult));
     }
+    m_buffer.resize(pending + static_cast<int>(readResult));
 
-    if (!m_streamCipher && m_buffer.size() != blockSize()) {
-        m_bufferFilling = true;
+    const bool atEnd = readResult == 0 || m_baseDevice->atEnd();
+    m_readySize = processableSize(m_buffer.size());
+    if (m_readySize > 0 && !m_cipher->process(m_buffer.data(), m_readySize)) {
+        m_error = true;
+        setErrorString(m_cipher->errorString());
+        return false;
+    }
+
+    return !atEnd || finishRead();
+}
+
+/**
+ * Process the blocks left in the internal buffer at the end of the base device.
+ *
+ * @return false on error
+ */
+bool SymmetricCipherStream::finishRead()
+{
+    m_readEnd = true;
+
+    QByteArray tail = m_buffer.mid(m_readySize);
+    if (tail.isEmpty()) {
+        return true;
+    }
+
+    // Padding is removed from the last block
+    bool ok = m_streamCipher ? m_cipher->process(tail) : m_cipher->finish(tail);
+    if (!ok) {
+        m_error = true;
+        setErrorString(m_cipher->errorString());
         return false;
-    } else {
-        m_bufferPos = 0;
-        m_bufferFilling = false;
-
-        if (!m_streamCipher && m_baseDevice->atEnd()) {
-            if (!m_cipher->finish(m_buffer)) {
-                m_error = true;
-                setErrorString(m_cipher->errorString());
-                return false;
-            }
-        } else if (m_buffer.size() > 0) {
-            if (!m_cipher->process(m_buffer)) {
-                m_error = true;
-                setErrorString(m_cipher->errorString());
-                return false;
-            }
-        }
-        return m_buffer.size() > 0;
     }
+
+    m_buffer.resize(m_readySize);
+    m_buffer.append(tail);
+    m_readySize = m_buffer.size();
+    return true;
+}
+
+/**
+ * @param size number of bytes read but not processed yet
+ * @return number of bytes that can be processed before the end of the base device is known,
+ *         the last full block of a block cipher is held back since it may carry padding
+ */
+int SymmetricCipherStream::processableSize(int size) const
+{
+    if (m_streamCipher) {
+        return size;
+    }
+    const int aligned = size - size % blockSize();
+    return qMax(0, aligned - blockSize());
 }
 
 qint64 SymmetricCipherStream::writeData(const char* data, qint64 maxSize)
@@ -175,25 +260,16 @@ qint64 SymmetricCipherStream::writeData(const char* data, qint64 maxSize)
     }
 
     m_dataWritten = true;
-    qint64 bytesRemaining = maxSize;
     qint64 offset = 0;
 
-    while (bytesRemaining > 0) {
-        int bytesToCopy = qMin(bytesRemaining, static_cast<qint64>(blockSize() - m_buffer.size()));
+    while (offset < maxSize) {
+        int bytesToCopy = static_cast<int>(qMin(maxSize - offset, static_cast<qint64>(ChunkSize - m_buffer.size())));
 
         m_buffer.append(data + offset, bytesToCopy);
-
         offset += bytesToCopy;
-        bytesRemaining -= bytesToCopy;
-
-        if (m_buffer.size() == blockSize()) {
-            if (!writeBlock(false)) {
-                if (m_error) {
-                    return -1;
-                } else {
-                    return maxSize - bytesRemaining;
-                }
-            }
+
+        if (m_buffer.size() == ChunkSize && !writeBlock(false)) {
+            return -1;
         }
     }
 
@@ -202,16 +278,15 @@ qint64 SymmetricCipherStream::writeData(const char* data, qint64 maxSize)
 
 bool SymmetricCipherStream::writeBlock(bool lastBlock)
 {
-    Q_ASSERT(m_streamCipher || lastBlock || (m_buffer.size() == blockSize()));
+    Q_ASSERT(m_streamCipher || lastBlock || (m_buffer.size() % blockSize() == 0));
 
     if (lastBlock && !m_streamCipher) {
-        QByteArray end;
         if (!m_cipher->finish(m_buffer)) {
             m_error = true;
             setErrorString(m_cipher->errorString());
             return false;
         }
-    } else if (!m_cipher->process(m_buffer)) {
+    } else if (!m_buffer.isEmpty() && !m_cipher->process(m_buffer)) {
         m_error = true;
         setErrorString(m_cipher->errorString());
         return false;
@@ -221,16 +296,13 @@ bool SymmetricCipherStream::writeBlock(bool lastBlock)
         m_error = true;
         setErrorString(m_baseDevice->errorString());
         return false;
-    } else {
-        m_buffer.clear();
-        return true;
     }
+
+    m_buffer.resize(0);
+    return true;
 }
 
 int SymmetricCipherStream::blockSize() const
 {
-    if (m_streamCipher) {
-        return 1024;
-    }
     return m_cipher->blockSize(m_cipher->mode());
 }
@@ -43,14 +43,19 @@ protected:
 
 private:
     void resetInternalState();
+    qint64 readDirect(char* data, qint64 maxSize);
     bool readBlock();
+    bool finishRead();
+    int processableSize(int size) const;
     bool writeBlock(bool lastBlock);
     int blockSize() const;
 
     const QScopedPointer<SymmetricCipher> m_cipher;
+    // Processed data up to m_readySize followed by the blocks not processed yet when reading
     QByteArray m_buffer;
     int m_bufferPos;
-    bool m_bufferFilling;
+    int m_readySize;
+    bool m_readEnd;
     bool m_error;
     bool m_isInitialized;
     bool m_dataWritten;
@@ -5623,7 +5623,7 @@ static const unsigned int DictNodes[84251] =
     3034661327,1785741549,3034693682,3034727387,3034792173,153190820, 3034824706,1681883162,3034841664,3034887400,3035004946,3035021335,3035037828,3032694787,18956290,  
     3035054087,3035070483,3035086867,17449017,  3035116777,3035185159,108134407, 3035215082,3035257822,24304606,  3035284217
 };
-static unsigned char WordEndBits[10532] =
+static const unsigned char WordEndBits[10532] =
 {
     96, 225,51, 252,41, 19, 188,28, 31, 240,29, 2,  68, 32, 4,  252,161,143,72, 96, 194,223,123,131,33, 228,59, 232,224,16, 195,129,34, 26, 40, 130,194,144,0,  32, 0,  
     0,  0,  0,  34, 0,  0,  0,  0,  0,  0,  0,  0,  2,  32, 64, 0,  0,  0,  0,  0,  0,  1,  4,  0,  0,  2,  0,  0,  16, 0,  1,  64, 0,  0,  8,  0,  0,  4,  80, 8,  0,  
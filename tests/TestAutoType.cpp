@@ -278,6 +278,49 @@ void TestAutoType::testGlobalAutoTypeRegExp()
     m_test->clearActions();
 }
 
+void TestAutoType::testGlobalAutoTypeWildcard()
+{
+    AutoTypeAssociations::Association association;
+    association.window = "Mozilla Firefox - *";
+    association.sequence = "prefix";
+    m_entry2->autoTypeAssociations()->add(association);
+    association.window = "*terminal*";
+    association.sequence = "infix";
+    m_entry2->autoTypeAssociations()->add(association);
+
+    m_test->setActiveWindowTitle("mozilla firefox - Start Page");
+    emit osUtils->globalShortcutTriggered("autotype");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("prefix"));
+    m_test->clearActions();
+
+    m_test->setActiveWindowTitle("user@host: Terminal");
+    emit osUtils->globalShortcutTriggered("autotype");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("infix"));
+    m_test->clearActions();
+
+    // the prefix has to match from the start of the title
+    m_test->setActiveWindowTitle("Not Mozilla Firefox - Start Page");
+    emit osUtils->globalShortcutTriggered("autotype");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString(""));
+    m_test->clearActions();
+
+    // changed associations are matched without reopening the database
+    association.window = "Mozilla Firefox - Start Page";
+    association.sequence = "exact";
+    m_entry2->autoTypeAssociations()->remove(1);
+    m_entry2->autoTypeAssociations()->remove(0);
+    m_entry2->autoTypeAssociations()->add(association);
+
+    m_test->setActiveWindowTitle("Mozilla Firefox - Start Page");
+    emit osUtils->globalShortcutTriggered("autotype");
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("exact"));
+    m_test->clearActions();
+}
+
 void TestAutoType::testAutoTypeResults()
 {
     QScopedPointer<Entry> entry(new Entry());
@@ -443,4 +486,13 @@ void TestAutoType::testAutoTypeEffectiveSequences()
     QCOMPARE(entry5->effectiveAutoTypeSequence(), QString());
     QCOMPARE(entry6->defaultAutoTypeSequence(), sequenceOrphan);
     QCOMPARE(entry6->effectiveAutoTypeSequence(), QString());
+
+    // Changes to parent groups apply to the cached sequences of child groups
+    group1->setDefaultAutoTypeSequence(QString());
+    QCOMPARE(group2->effectiveAutoTypeSequence(), defaultSequence);
+    QCOMPARE(entry3->effectiveAutoTypeSequence(), defaultSequence);
+    group2->setParent(group3);
+    QCOMPARE(group2->effectiveAutoTypeSequence(), QString());
+    group3->setAutoTypeEnabled(Group::Inherit);
+    QCOMPARE(group2->effectiveAutoTypeSequence(), sequenceG3);
 }
@@ -47,6 +47,7 @@ private slots:
     void testGlobalAutoTypeUrlSubdomainMatch();
     void testGlobalAutoTypeTitleMatchDisabled();
     void testGlobalAutoTypeRegExp();
+    void testGlobalAutoTypeWildcard();
     void testAutoTypeResults();
     void testAutoTypeResults_data();
     void testAutoTypeSyntaxChecks();
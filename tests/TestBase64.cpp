@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestBase64.h"
+#include "core/Base64.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(TestBase64)
+
+void TestBase64::testEncode()
+{
+    QCOMPARE(Base64::encode(QByteArray()), QString());
+    QCOMPARE(Base64::encode("f"), QString("Zg=="));
+    QCOMPARE(Base64::encode("fo"), QString("Zm8="));
+    QCOMPARE(Base64::encode("foo"), QString("Zm9v"));
+    QCOMPARE(Base64::encode("foobar"), QString("Zm9vYmFy"));
+
+    QByteArray data;
+    for (int i = 0; i < 1000; ++i) {
+        data.append(static_cast<char>(i * 7));
+        QCOMPARE(Base64::encode(data), QString::fromLatin1(data.toBase64()));
+    }
+}
+
+void TestBase64::testDecode()
+{
+    QCOMPARE(Base64::decode(QString()), QByteArray());
+    QCOMPARE(Base64::decode(QString("Zg==")), QByteArray("f"));
+    QCOMPARE(Base64::decode(QString("Zm8=")), QByteArray("fo"));
+    QCOMPARE(Base64::decode(QString("Zm9vYmFy")), QByteArray("foobar"));
+
+    // Whitespace and other characters outside of the alphabet are skipped
+    QCOMPARE(Base64::decode(QString("Zm9v\nYm Fy\r\n")), QByteArray("foobar"));
+    QCOMPARE(Base64::decode(QString::fromUtf8("Zm9\xc3\xa4vYmFy")), QByteArray("foobar"));
+
+    QByteArray data;
+    for (int i = 0; i < 1000; ++i) {
+        data.append(static_cast<char>(i * 13));
+        QCOMPARE(Base64::decode(QString::fromLatin1(data.toBase64())), data);
+    }
+}
+
+void TestBase64::testDecodeIncremental()
+{
+    QByteArray data;
+    for (int i = 0; i < 4096; ++i) {
+        data.append(static_cast<char>(i * 31));
+    }
+    QString text = QString::fromLatin1(data.toBase64());
+
+    for (int pieceSize : {1, 2, 3, 5, 7, 64, 1000}) {
+        QByteArray output;
+        Base64::Decoder decoder(output);
+        for (int i = 0; i < text.size(); i += pieceSize) {
+            decoder.decode(text.midRef(i, pieceSize));
+        }
+        QCOMPARE(output, data);
+    }
+}
@@ -17,8 +17,10 @@
 
 #include "TestBrowser.h"
 
+#include "browser/BrowserEntryConfig.h"
 #include "browser/BrowserMessageBuilder.h"
 #include "browser/BrowserSettings.h"
+#include "browser/BrowserShared.h"
 #include "core/Group.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
@@ -91,6 +93,32 @@ void TestBrowser::testDecryptMessage()
     auto decrypted = browserMessageBuilder()->decryptMessage(message, NONCE, PUBLICKEY, SERVERSECRETKEY);
 
     QCOMPARE(decrypted["action"].toString(), QString("test-action"));
+
+    // The box key of a client is only computed once
+    browserMessageBuilder()->m_sharedKeys.clear();
+    browserMessageBuilder()->decryptMessage(message, NONCE, PUBLICKEY, SERVERSECRETKEY);
+    decrypted = browserMessageBuilder()->decryptMessage(message, NONCE, PUBLICKEY, SERVERSECRETKEY);
+    QCOMPARE(decrypted["action"].toString(), QString("test-action"));
+    QCOMPARE(browserMessageBuilder()->m_sharedKeys.size(), 1);
+
+    // Tampered messages are rejected
+    QVERIFY(browserMessageBuilder()->decryptMessage(message.replace(0, 1, "A"), NONCE, PUBLICKEY, SERVERSECRETKEY)
+                .isEmpty());
+}
+
+void TestBrowser::testTakeMessages()
+{
+    QByteArray buffer(R"({"action":"a"}{"action":"b}\"{"}{"action":)");
+    auto messages = BrowserShared::takeMessages(buffer);
+    QCOMPARE(messages.size(), 2);
+    QCOMPARE(messages.at(0), QByteArray(R"({"action":"a"})"));
+    QCOMPARE(messages.at(1), QByteArray(R"({"action":"b}\"{"})"));
+    QCOMPARE(buffer, QByteArray(R"({"action":)"));
+
+    buffer.append(R"("c"})");
+    messages = BrowserShared::takeMessages(buffer);
+    QCOMPARE(messages, QList<QByteArray>({R"({"action":"c"})"}));
+    QVERIFY(buffer.isEmpty());
 }
 
 void TestBrowser::testGetBase64FromKey()
@@ -396,6 +424,55 @@ void TestBrowser::testSearchEntriesWithAdditionalURLs()
     QCOMPARE(additionalResult[0]->url(), QString("https://github.com/"));
 }
 
+void TestBrowser::testSearchEntriesIndexUpdates()
+{
+    auto db = QSharedPointer<Database>::create();
+    auto* root = db->rootGroup();
+
+    QStringList urls = {"https://github.com/", "https://login.example.com"};
+    auto entries = createEntries(urls, root);
+
+    const QString siteUrl("https://login.example.com");
+    auto result = m_browserService->searchEntries(db, siteUrl, siteUrl);
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result[0], entries[1]);
+
+    // Changed, added and additional URLs are picked up by the index
+    entries[0]->setUrl("https://example.com");
+    entries[1]->setUrl("https://other.example.com");
+    auto* added = new Entry();
+    added->setUuid(QUuid::createUuid());
+    added->setUrl("https://github.com");
+    added->attributes()->set(EntryAttributes::AdditionalUrlAttribute, "https://www.example.com");
+    added->setGroup(root);
+
+    result = m_browserService->searchEntries(db, siteUrl, siteUrl);
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result[0], entries[0]);
+
+    // www is only omitted if the group says so
+    result = m_browserService->searchEntries(db, "https://example.com", "https://example.com");
+    QCOMPARE(result.size(), 1);
+    root->customData()->set(BrowserService::OPTION_OMIT_WWW, TRUE_STR);
+    result = m_browserService->searchEntries(db, "https://example.com", "https://example.com");
+    QCOMPARE(result.size(), 2);
+    QCOMPARE(result[1], added);
+
+    // Group options are still applied to indexed entries
+    auto* group = new Group();
+    group->setParent(root);
+    group->customData()->set(BrowserService::OPTION_HIDE_ENTRY, TRUE_STR);
+    entries[0]->setGroup(group);
+    result = m_browserService->searchEntries(db, "https://example.com", "https://example.com");
+    QCOMPARE(result.size(), 1);
+    QCOMPARE(result[0], added);
+
+    // Deleted entries are dropped from the index
+    delete added;
+    result = m_browserService->searchEntries(db, "https://example.com", "https://example.com");
+    QVERIFY(result.isEmpty());
+}
+
 void TestBrowser::testInvalidEntries()
 {
     auto db = QSharedPointer<Database>::create();
@@ -736,3 +813,30 @@ void TestBrowser::testRestrictBrowserKey()
     QCOMPARE(sorted[2]->url(), QString("https://example.com/2"));
     QCOMPARE(sorted[3]->url(), QString("https://example.com/0"));
 }
+
+void TestBrowser::testEntryConfigCache()
+{
+    QScopedPointer<Entry> entry(new Entry());
+    BrowserEntryConfig config;
+    QVERIFY(!config.load(entry.data()));
+    config.allow("example.com");
+    config.deny("example.org");
+    config.setRealm("realm");
+    config.save(entry.data());
+
+    for (int i = 0; i < 2; ++i) {
+        BrowserEntryConfig loaded;
+        QVERIFY(loaded.load(entry.data()));
+        QVERIFY(loaded.isAllowed("example.com"));
+        QVERIFY(loaded.isDenied("example.org"));
+        QCOMPARE(loaded.realm(), QString("realm"));
+    }
+
+    // Changed settings are not served from the cache
+    config.allow("example.org");
+    config.save(entry.data());
+    BrowserEntryConfig changed;
+    QVERIFY(changed.load(entry.data()));
+    QVERIFY(changed.isAllowed("example.org"));
+    QVERIFY(!changed.isDenied("example.org"));
+}
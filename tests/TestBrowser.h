@@ -34,6 +34,7 @@ private slots:
     void testChangePublicKeys();
     void testEncryptMessage();
     void testDecryptMessage();
+    void testTakeMessages();
     void testGetBase64FromKey();
     void testIncrementNonce();
     void testBuildResponse();
@@ -45,11 +46,13 @@ private slots:
     void testSearchEntriesByReference();
     void testSearchEntriesWithPort();
     void testSearchEntriesWithAdditionalURLs();
+    void testSearchEntriesIndexUpdates();
     void testInvalidEntries();
     void testSubdomainsAndPaths();
     void testBestMatchingCredentials();
     void testBestMatchingWithAdditionalURLs();
     void testRestrictBrowserKey();
+    void testEntryConfigCache();
 
 private:
     QList<Entry*> createEntries(QStringList& urls, Group* root) const;
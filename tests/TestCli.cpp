@@ -22,6 +22,7 @@
 #include "core/Config.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/PasswordHealth.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
 #include "keys/FileKey.h"
@@ -33,11 +34,14 @@
 #include "cli/AttachmentExport.h"
 #include "cli/AttachmentImport.h"
 #include "cli/AttachmentRemove.h"
+#include "cli/Batch.h"
 #include "cli/Clip.h"
 #include "cli/DatabaseCreate.h"
 #include "cli/DatabaseEdit.h"
+#include "cli/DatabaseGenerate.h"
 #include "cli/DatabaseInfo.h"
 #include "cli/Diceware.h"
+#include "cli/Diff.h"
 #include "cli/Edit.h"
 #include "cli/Estimate.h"
 #include "cli/Export.h"
@@ -51,10 +55,14 @@
 #include "cli/Remove.h"
 #include "cli/RemoveGroup.h"
 #include "cli/Search.h"
+#include "cli/Serve.h"
 #include "cli/Show.h"
 #include "cli/Utils.h"
 
 #include <QClipboard>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSignalSpy>
 #include <QTest>
 #include <QtConcurrent>
@@ -227,16 +235,19 @@ void TestCli::testBatchCommands()
     QVERIFY(Commands::getCommand("attachment-export"));
     QVERIFY(Commands::getCommand("attachment-import"));
     QVERIFY(Commands::getCommand("attachment-rm"));
+    QVERIFY(Commands::getCommand("batch"));
     QVERIFY(Commands::getCommand("clip"));
     QVERIFY(Commands::getCommand("close"));
     QVERIFY(Commands::getCommand("db-create"));
     QVERIFY(Commands::getCommand("db-info"));
     QVERIFY(Commands::getCommand("diceware"));
+    QVERIFY(Commands::getCommand("diff"));
     QVERIFY(Commands::getCommand("edit"));
     QVERIFY(Commands::getCommand("estimate"));
     QVERIFY(Commands::getCommand("export"));
     QVERIFY(Commands::getCommand("generate"));
     QVERIFY(Commands::getCommand("help"));
+    QVERIFY(Commands::getCommand("hibp-convert"));
     QVERIFY(Commands::getCommand("import"));
     QVERIFY(Commands::getCommand("ls"));
     QVERIFY(Commands::getCommand("merge"));
@@ -245,10 +256,11 @@ void TestCli::testBatchCommands()
     QVERIFY(Commands::getCommand("open"));
     QVERIFY(Commands::getCommand("rm"));
     QVERIFY(Commands::getCommand("rmdir"));
+    QVERIFY(Commands::getCommand("serve"));
     QVERIFY(Commands::getCommand("show"));
     QVERIFY(Commands::getCommand("search"));
     QVERIFY(!Commands::getCommand("doesnotexist"));
-    QCOMPARE(Commands::getCommands().size(), 26);
+    QCOMPARE(Commands::getCommands().size(), 30);
 }
 
 void TestCli::testInteractiveCommands()
@@ -264,11 +276,13 @@ void TestCli::testInteractiveCommands()
     QVERIFY(Commands::getCommand("db-create"));
     QVERIFY(Commands::getCommand("db-info"));
     QVERIFY(Commands::getCommand("diceware"));
+    QVERIFY(Commands::getCommand("diff"));
     QVERIFY(Commands::getCommand("edit"));
     QVERIFY(Commands::getCommand("estimate"));
     QVERIFY(Commands::getCommand("exit"));
     QVERIFY(Commands::getCommand("generate"));
     QVERIFY(Commands::getCommand("help"));
+    QVERIFY(Commands::getCommand("hibp-convert"));
     QVERIFY(Commands::getCommand("ls"));
     QVERIFY(Commands::getCommand("merge"));
     QVERIFY(Commands::getCommand("mkdir"));
@@ -280,7 +294,7 @@ void TestCli::testInteractiveCommands()
     QVERIFY(Commands::getCommand("show"));
     QVERIFY(Commands::getCommand("search"));
     QVERIFY(!Commands::getCommand("doesnotexist"));
-    QCOMPARE(Commands::getCommands().size(), 26);
+    QCOMPARE(Commands::getCommands().size(), 28);
 }
 
 void TestCli::testAdd()
@@ -448,6 +462,22 @@ void TestCli::testAnalyze()
     QVERIFY(output.contains("123"));
     m_stderr->readLine(); // Skip password prompt
     QCOMPARE(m_stderr->readAll(), QByteArray());
+
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--health", "--format", "jsonl", "--hibp", hibpPath, m_dbFile->fileName()});
+    m_stderr->readLine(); // Skip password prompt
+    QVERIFY(m_stderr->readAll().startsWith("Evaluating database entries against HIBP file"));
+    QStringList findings;
+    for (const auto& line : m_stdout->readAll().split('\n')) {
+        if (!line.isEmpty()) {
+            const auto finding = QJsonDocument::fromJson(line).object();
+            findings << QString("%1 %2 %3").arg(finding.value("type").toString(),
+                                               finding.value("path").toString(),
+                                               QString::number(finding.value("count").toInt()));
+        }
+    }
+    QVERIFY(findings.contains("leaked Sample Entry 123"));
+    QVERIFY(findings.contains("weak Sample Entry 0"));
 }
 
 void TestCli::testAttachmentExport()
@@ -628,6 +658,49 @@ void TestCli::testAttachmentRemove()
     QVERIFY(!db->rootGroup()->findEntryByPath("/Sample Entry")->attachments()->hasKey("Sample attachment.txt"));
 }
 
+void TestCli::testBatch()
+{
+    Batch batchCmd;
+    QVERIFY(!batchCmd.name.isEmpty());
+    QVERIFY(batchCmd.getDescriptionLine().contains(batchCmd.name));
+
+    Commands::setupCommands(false);
+    setInput({"a",
+              "add -q -u newuser --url https://example.com/ /newentry",
+              "",
+              "# comment",
+              R"(["edit", "-q", "--title", "renamed entry", "/newentry"])",
+              "rm -q doesnotexist",
+              "open other.kdbx",
+              "mkdir -q /newgroup"});
+    QCOMPARE(execCmd(batchCmd, {"batch", m_dbFile->fileName()}), EXIT_FAILURE);
+    m_stderr->readLine(); // skip password prompt
+    QCOMPARE(m_stderr->readLine(), QByteArray("Entry doesnotexist not found.\n"));
+    QCOMPARE(m_stderr->readLine(), QByteArray("Command open can not be used in a batch.\n"));
+    QCOMPARE(m_stdout->readLine(), QByteArray("2\tok\tadd\n"));
+    QCOMPARE(m_stdout->readLine(),
+             QByteArray(R"({"command":"edit","line":5,"status":"ok"})"
+                        "\n"));
+    QCOMPARE(m_stdout->readLine(), QByteArray("6\terror\trm\n"));
+    QCOMPARE(m_stdout->readLine(), QByteArray("7\terror\topen\n"));
+    QCOMPARE(m_stdout->readLine(), QByteArray("8\tok\tmkdir\n"));
+
+    auto db = readDatabase();
+    QVERIFY(db);
+    QVERIFY(!db->rootGroup()->findEntryByPath("/newentry"));
+    auto entry = db->rootGroup()->findEntryByPath("/renamed entry");
+    QVERIFY(entry);
+    QCOMPARE(entry->username(), QString("newuser"));
+    QVERIFY(db->rootGroup()->findGroupByPath("/newgroup"));
+
+    // Commands after the first failing one are not run
+    setInput({"a", "rm -q doesnotexist", "mkdir -q /othergroup"});
+    QCOMPARE(execCmd(batchCmd, {"batch", "--stop-on-error", m_dbFile->fileName()}), EXIT_FAILURE);
+    db = readDatabase();
+    QVERIFY(db);
+    QVERIFY(!db->rootGroup()->findGroupByPath("/othergroup"));
+}
+
 void TestCli::testClip()
 {
     if (QProcessEnvironment::systemEnvironment().contains("WAYLAND_DISPLAY")) {
@@ -993,6 +1066,55 @@ void TestCli::testDatabaseEdit()
     QCOMPARE(m_stderr->readLine(), QByteArray("Cannot remove all the keys from a database.\n"));
 }
 
+void TestCli::testDatabaseGenerate()
+{
+    DatabaseGenerate generateCmd;
+    QVERIFY(!generateCmd.name.isEmpty());
+    QVERIFY(generateCmd.getDescriptionLine().contains(generateCmd.name));
+
+    QScopedPointer<QTemporaryDir> testDir(new QTemporaryDir());
+    QString dbFilename = testDir->path() + "/testGenerate.kdbx";
+    const QStringList arguments = {"db-generate", "-p", "--entries", "50", "--groups", "6", "--depth", "2",
+                                   "--history", "2", "--attachments", "20", "--attachment-size", "4",
+                                   "--references", "10", "--totp", "10", "--passkeys", "10", "--seed", "7"};
+
+    execCmd(generateCmd, QStringList(arguments) << dbFilename << "--entries" << "many");
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid value many for --entries.\n"));
+    QVERIFY(!QFile::exists(dbFilename));
+
+    setInput({"a", "a"});
+    execCmd(generateCmd, QStringList(arguments) << dbFilename);
+    m_stderr->readLine();
+    m_stderr->readLine();
+    QCOMPARE(m_stdout->readLine(), QByteArray("Successfully generated new database with 50 entries.\n"));
+
+    auto db = readDatabase(dbFilename, "a");
+    QVERIFY(db);
+    const auto entries = db->rootGroup()->entriesRecursive();
+    QCOMPARE(entries.size(), 50);
+    QCOMPARE(db->rootGroup()->groupsRecursive(false).size(), 6);
+    for (const auto* entry : entries) {
+        QCOMPARE(entry->historyItems().size(), 2);
+    }
+
+    // The same seed gives the same database
+    auto secondFilename = testDir->path() + "/testGenerate2.kdbx";
+    setInput({"a", "a"});
+    execCmd(generateCmd, QStringList(arguments) << secondFilename);
+    auto second = readDatabase(secondFilename, "a");
+    QVERIFY(second);
+    for (const auto* entry : entries) {
+        auto copy = second->rootGroup()->findEntryByUuid(entry->uuid());
+        QVERIFY(copy);
+        QCOMPARE(copy->password(), entry->password());
+        QCOMPARE(copy->attachments()->keys(), entry->attachments()->keys());
+    }
+
+    // Should refuse to overwrite an existing file
+    execCmd(generateCmd, QStringList(arguments) << dbFilename);
+    QCOMPARE(m_stdout->readAll(), QByteArray());
+}
+
 void TestCli::testInfo()
 {
     DatabaseInfo infoCmd;
@@ -1025,6 +1147,14 @@ void TestCli::testInfo()
     QCOMPARE(m_stdout->readLine(), QByteArray("Number of weak passwords: 2\n"));
     QCOMPARE(m_stdout->readLine(), QByteArray("Entries excluded from reports: 0\n"));
     QCOMPARE(m_stdout->readLine(), QByteArray("Average password length: 11 characters\n"));
+    QCOMPARE(m_stdout->readLine(), QByteArray("Estimated memory usage:\n"));
+    QVERIFY(m_stdout->readLine().startsWith("  Entries: "));
+    QVERIFY(m_stdout->readLine().startsWith("  History: "));
+    QVERIFY(m_stdout->readLine().startsWith("  Attachments: "));
+    QVERIFY(m_stdout->readLine().startsWith("  Custom icons: "));
+    QVERIFY(m_stdout->readLine().startsWith("  Search indexes: "));
+    QVERIFY(m_stdout->readLine().startsWith("  Caches: "));
+    QVERIFY(m_stdout->readLine().startsWith("  Total: "));
 
     // Test with quiet option.
     setInput("a");
@@ -1064,6 +1194,13 @@ void TestCli::testDiceware()
     execCmd(dicewareCmd, {"diceware", "-W", "bleuh"});
     QCOMPARE(m_stderr->readLine(), QByteArray("Invalid word count bleuh\n"));
 
+    execCmd(dicewareCmd, {"diceware", "-W", "3", "--count", "50"});
+    const auto passphrases = QString::fromUtf8(m_stdout->readAll()).split('\n', Qt::SkipEmptyParts);
+    QCOMPARE(passphrases.size(), 50);
+    for (const auto& line : passphrases) {
+        QCOMPARE(line.split(" ").size(), 3);
+    }
+
     TemporaryFile wordFile;
     wordFile.open();
     for (int i = 0; i < 4500; ++i) {
@@ -1269,6 +1406,38 @@ void TestCli::testEstimate()
     }
 }
 
+void TestCli::testEstimateBatch()
+{
+    const QStringList passwords = {"password", "sdfgsdfg", "", "xzxzy"};
+    // More lines than one parallel chunk
+    QStringList input;
+    for (int i = 0; i < 1500; ++i) {
+        input << passwords.at(i % passwords.size());
+    }
+
+    Estimate estimateCmd;
+    setInput(input);
+    QCOMPARE(execCmd(estimateCmd, {"estimate", "--batch", "--format", "jsonl"}), EXIT_SUCCESS);
+
+    const auto lines = m_stdout->readAll().split('\n');
+    QCOMPARE(lines.size(), input.size() + 1);
+    for (int i = 0; i < input.size(); ++i) {
+        const auto result = QJsonDocument::fromJson(lines.at(i)).object();
+        QCOMPARE(result.value("length").toInt(), input.at(i).length());
+        QCOMPARE(result.value("entropy").toDouble(), PasswordHealth(input.at(i)).entropy());
+    }
+
+    setInput(passwords);
+    QCOMPARE(execCmd(estimateCmd, {"estimate", "--batch", "-a", "--format", "jsonl"}), EXIT_SUCCESS);
+    const auto result = QJsonDocument::fromJson(m_stdout->readLine()).object();
+    const auto match = result.value("matches").toArray().first().toObject();
+    QCOMPARE(match.value("type").toString(), QString("dictionary"));
+    QCOMPARE(match.value("token").toString(), QString("password"));
+
+    setInput("password");
+    QCOMPARE(execCmd(estimateCmd, {"estimate", "--batch", "password"}), EXIT_FAILURE);
+}
+
 void TestCli::testExport()
 {
     Export exportCmd;
@@ -1302,6 +1471,15 @@ void TestCli::testExport()
 
     QVERIFY(db->import(xmlOutput.fileName()));
 
+    // JSON lines exporting
+    setInput("a");
+    execCmd(exportCmd, {"export", "-q", "-f", "jsonl", "--fields", "path,password", m_dbFile->fileName()});
+    QByteArray jsonData = m_stdout->readAll();
+    QVERIFY(jsonData.contains("{\"password\":\"Password\",\"path\":\"/Sample Entry\"}\n"));
+    auto sourceDb = readDatabase();
+    QVERIFY(sourceDb);
+    QCOMPARE(jsonData.count('\n'), sourceDb->rootGroup()->entriesRecursive().size());
+
     // CSV exporting
     setInput("a");
     execCmd(exportCmd, {"export", "-f", "csv", m_dbFile->fileName()});
@@ -1383,6 +1561,18 @@ void TestCli::testGenerate()
     // Testing with invalid word count format
     execCmd(generateCmd, {"generate", "-L", "bleuh"});
     QCOMPARE(m_stderr->readLine(), QByteArray("Invalid password length bleuh\n"));
+
+    // Testing bulk generation
+    execCmd(generateCmd, {"generate", "-L", "12", "--count", "1000"});
+    const auto passwords = QString::fromUtf8(m_stdout->readAll()).split('\n', Qt::SkipEmptyParts);
+    QCOMPARE(passwords.size(), 1000);
+    QRegularExpression regex("^.{12}$");
+    for (const auto& password : passwords) {
+        QVERIFY2(regex.match(password).hasMatch(), qPrintable("Password " + password + " has the wrong length"));
+    }
+
+    execCmd(generateCmd, {"generate", "--count", "0"});
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid count 0\n"));
 }
 
 void TestCli::testImport()
@@ -1614,6 +1804,56 @@ void TestCli::testList()
     QCOMPARE(m_stdout->readAll(), QByteArray());
 }
 
+void TestCli::testDiff()
+{
+    Diff diffCmd;
+    QVERIFY(!diffCmd.name.isEmpty());
+    QVERIFY(diffCmd.getDescriptionLine().contains(diffCmd.name));
+
+    auto db = readDatabase();
+    QVERIFY(db);
+    auto* removedEntry = new Entry();
+    removedEntry->setUuid(QUuid::createUuid());
+    removedEntry->setTitle("Old Website");
+    auto* generalGroup = db->rootGroup()->findGroupByPath("/General/");
+    QVERIFY(generalGroup);
+    generalGroup->addEntry(removedEntry);
+    TemporaryFile oldFile;
+    oldFile.open();
+    oldFile.close();
+    db->saveAs(oldFile.fileName());
+
+    setInput("a");
+    execCmd(diffCmd, {"diff", "-s", oldFile.fileName(), oldFile.fileName()});
+    QCOMPARE(m_stdout->readAll(), QByteArray("The databases contain the same entries.\n"));
+
+    auto* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("Some Website");
+    auto* group = db->rootGroup()->findGroupByPath("/Internet/");
+    QVERIFY(group);
+    group->addEntry(entry);
+    delete removedEntry;
+    auto* modifiedEntry = db->rootGroup()->findEntryByPath("/Sample Entry");
+    QVERIFY(modifiedEntry);
+    modifiedEntry->setPassword("changed");
+
+    TemporaryFile newFile;
+    newFile.open();
+    newFile.close();
+    db->saveAs(newFile.fileName());
+
+    setInput("a");
+    execCmd(diffCmd, {"diff", "-s", oldFile.fileName(), newFile.fileName()});
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    QList<QByteArray> outLines = m_stdout->readAll().split('\n');
+    QCOMPARE(outLines.size(), 4);
+    QVERIFY(outLines.at(0).startsWith("Added Internet/Some Website ["));
+    QVERIFY(outLines.at(1).startsWith("Removed General/Old Website ["));
+    QVERIFY(outLines.at(2).startsWith("Modified Sample Entry ["));
+}
+
 void TestCli::testMerge()
 {
     Merge mergeCmd;
@@ -1736,6 +1976,30 @@ void TestCli::testMerge()
     execCmd(mergeCmd, {"merge", "-q", sourceFile.fileName(), sourceFile.fileName()});
     QCOMPARE(m_stderr->readAll(), QByteArray());
     QCOMPARE(m_stdout->readAll(), QByteArray());
+
+    // Several databases are merged in one pass
+    auto* otherEntry = new Entry();
+    otherEntry->setUuid(QUuid::createUuid());
+    otherEntry->setTitle("Other Website");
+    group->addEntry(otherEntry);
+    TemporaryFile sourceFile2;
+    sourceFile2.open();
+    sourceFile2.close();
+    db->saveAs(sourceFile2.fileName());
+
+    setInput("a");
+    execCmd(mergeCmd, {"merge", "-s", targetFile2.fileName(), sourceFile.fileName(), sourceFile2.fileName()});
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    QList<QByteArray> outLines4 = m_stdout->readAll().split('\n');
+    QVERIFY(outLines4.contains(QString("Successfully merged %1, %2 into %3.")
+                                   .arg(sourceFile.fileName(), sourceFile2.fileName(), targetFile2.fileName())
+                                   .toUtf8()));
+
+    mergedDb = QSharedPointer<Database>::create();
+    QVERIFY(mergedDb->open(targetFile2.fileName(), oldKey));
+    QVERIFY(mergedDb->rootGroup()->findEntryByPath("/Internet/Some Website"));
+    QVERIFY(mergedDb->rootGroup()->findEntryByPath("/Internet/Other Website"));
 }
 
 void TestCli::testMergeWithKeys()
@@ -2005,6 +2269,22 @@ void TestCli::testSearch()
     QCOMPARE(m_stderr->readAll(), QByteArray());
     QCOMPARE(m_stdout->readAll(), QByteArray("/Sample Entry\n"));
 
+    // Streamed JSON output with field selection
+    setInput("a");
+    execCmd(searchCmd,
+            {"search", "-q", "--format", "json", "--fields", "path,username", m_dbFile->fileName(), "Sample"});
+    QCOMPARE(m_stdout->readAll(),
+             QByteArray("[\n{\"path\":\"/Sample Entry\",\"username\":\"User Name\"}\n]\n"));
+
+    setInput("a");
+    execCmd(searchCmd,
+            {"search", "-q", "--format", "jsonl", "--fields", "title,password", m_dbFile->fileName(), "Sample"});
+    QCOMPARE(m_stdout->readAll(), QByteArray("{\"password\":\"Password\",\"title\":\"Sample Entry\"}\n"));
+
+    setInput("a");
+    QCOMPARE(execCmd(searchCmd, {"search", "-q", "--fields", "secret", m_dbFile->fileName(), "Sample"}), EXIT_FAILURE);
+    QVERIFY(m_stderr->readAll().contains("Unknown field secret"));
+
     setInput("a");
     execCmd(searchCmd, {"search", m_dbFile->fileName(), "Does Not Exist"});
     m_stderr->readLine(); // skip password prompt
@@ -2057,6 +2337,54 @@ void TestCli::testSearch()
     QCOMPARE(m_stdout->readAll(), QByteArray("/Sample Entry\n/Homebanking/Subgroup/Subgroup Entry\n"));
 }
 
+void TestCli::testServe()
+{
+    Serve serveCmd;
+    QVERIFY(!serveCmd.name.isEmpty());
+    QVERIFY(serveCmd.getDescriptionLine().contains(serveCmd.name));
+
+    Commands::setupCommands(false);
+    auto db = readDatabase();
+    QVERIFY(db);
+
+    auto request = [&db](const QByteArray& json) {
+        const auto response = Serve::handleRequest(db, json);
+        // The output of a request is not written to the streams of the process
+        return QJsonDocument::fromJson(response).object();
+    };
+
+    auto response = request(R"(["show", "-a", "UserName", "/Sample Entry"])");
+    QCOMPARE(response.value("status").toString(), QString("ok"));
+    QCOMPARE(response.value("stdout").toString(), QString("User Name\n"));
+    QCOMPARE(response.value("stderr").toString(), QString());
+
+    response = request(R"(["show", "/doesnotexist"])");
+    QCOMPARE(response.value("status").toString(), QString("error"));
+    QVERIFY(response.value("stderr").toString().contains("doesnotexist"));
+
+    // Only commands reading the database are served
+    response = request(R"(["rm", "/Sample Entry"])");
+    QCOMPARE(response.value("status").toString(), QString("error"));
+    QVERIFY(db->rootGroup()->findEntryByPath("/Sample Entry"));
+
+    // Clients cannot write files
+    TemporaryFile exportFile;
+    QVERIFY(exportFile.open());
+    exportFile.close();
+    exportFile.remove();
+    response = request(QJsonDocument(QJsonArray{"attachment-export",
+                                                "/Sample Entry",
+                                                "Sample attachment.txt",
+                                                exportFile.fileName()})
+                           .toJson(QJsonDocument::Compact));
+    QCOMPARE(response.value("status").toString(), QString("error"));
+    QVERIFY(!QFile::exists(exportFile.fileName()));
+
+    response = request("show /Sample Entry");
+    QCOMPARE(response.value("status").toString(), QString("error"));
+    QCOMPARE(m_stdout->readAll(), QByteArray());
+}
+
 void TestCli::testShow()
 {
     Show showCmd;
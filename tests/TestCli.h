@@ -50,15 +50,19 @@ private slots:
     void testAttachmentExport();
     void testAttachmentImport();
     void testAttachmentRemove();
+    void testBatch();
     void testClip();
     void testCommandParsing_data();
     void testCommandParsing();
     void testCreate();
     void testDatabaseEdit();
+    void testDatabaseGenerate();
     void testDiceware();
+    void testDiff();
     void testEdit();
     void testEstimate_data();
     void testEstimate();
+    void testEstimateBatch();
     void testExport();
     void testGenerate_data();
     void testGenerate();
@@ -77,6 +81,7 @@ private slots:
     void testRemoveGroup();
     void testRemoveQuiet();
     void testSearch();
+    void testServe();
     void testShow();
     void testInvalidDbFiles();
     void testYubiKeyOption();
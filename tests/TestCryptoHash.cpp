@@ -19,7 +19,9 @@
 
 #include "crypto/Crypto.h"
 #include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
 
+#include <QBuffer>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestCryptoHash)
@@ -62,3 +64,30 @@ void TestCryptoHash::test()
              QByteArray::fromHex("0d41b612584ed39ff72944c29494573e40f4bb95283455fae2e0be1e3565aa9f48057d59e6ffd777970e2"
                                  "82871c25a549a2763e5b724794f312c97021c42f91d"));
 }
+
+void TestCryptoHash::testHashAll()
+{
+    // Small batches are hashed in turn, large ones on the thread pool
+    for (int size : {16, 1024 * 1024}) {
+        QVector<QByteArray> inputs;
+        for (int i = 0; i < 8; ++i) {
+            inputs.append(randomGen()->randomArray(size + i));
+        }
+        inputs.append(QByteArray());
+
+        const auto results = CryptoHash::hashAll(inputs, CryptoHash::Sha256);
+        QCOMPARE(results.size(), inputs.size());
+        for (int i = 0; i < inputs.size(); ++i) {
+            QCOMPARE(results.at(i), CryptoHash::hash(inputs.at(i), CryptoHash::Sha256));
+        }
+    }
+
+    QByteArray data = randomGen()->randomArray(3 * 1024 * 1024 + 5);
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    CryptoHash cryptoHash(CryptoHash::Sha512);
+    QVERIFY(cryptoHash.addData(&buffer));
+    QCOMPARE(cryptoHash.result(), CryptoHash::hash(data, CryptoHash::Sha512));
+
+    QVERIFY(!CryptoHash::implementation(CryptoHash::Sha256).isEmpty());
+}
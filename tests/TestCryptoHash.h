@@ -27,6 +27,7 @@ class TestCryptoHash : public QObject
 private slots:
     void initTestCase();
     void test();
+    void testHashAll();
 };
 
 #endif // KEEPASSX_TESTCRYPTOHASH_H
@@ -110,3 +110,26 @@ void TestCsvExporter::testNestedGroups()
             .append(ExpectedHeaderLine)
             .append("\"Passwords/Test Group Name/Test Sub Group Name\",\"Test Entry Title\",\"\",\"\",\"\",\"\"")));
 }
+
+void TestCsvExporter::testLargeExport()
+{
+    // Enough entries to be written in several chunks
+    auto* group = new Group();
+    group->setName("Group");
+    group->setParent(m_db->rootGroup());
+    for (int i = 0; i < 2000; ++i) {
+        auto* entry = new Entry();
+        entry->setGroup(group);
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setNotes(QString(50, QChar(0x00E9)));
+    }
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    QVERIFY(m_csvExporter->exportDatabase(&buffer, m_db));
+    const auto exported = QString::fromUtf8(buffer.buffer());
+
+    QCOMPARE(exported, m_csvExporter->exportDatabase(m_db));
+    QCOMPARE(exported.count('\n'), 2001);
+    QVERIFY(exported.contains("\"Passwords/Group\",\"Entry 1999\""));
+}
@@ -341,3 +341,57 @@ void TestCsvParser::testUnicode()
     QVERIFY(t.at(0).at(2) == "3śAż");
     QVERIFY(t.at(0).at(3) == "żac");
 }
+
+void TestCsvParser::testRowCallback()
+{
+    QTextStream out(file.data());
+    out << "1,2\n#comment\n3\n4,5,6\n7\n";
+    out.flush();
+
+    CsvTable rows;
+    QVERIFY(parser->parse(file.data(), [&rows](const CsvRow& row) {
+        rows.append(row);
+        return rows.size() < 3;
+    }));
+    QCOMPARE(rows.size(), 3);
+    QCOMPARE(rows.at(0), CsvRow({"1", "2"}));
+    // Rows handed to the callback are not filled up
+    QCOMPARE(rows.at(1), CsvRow({"3"}));
+    QCOMPARE(rows.at(2), CsvRow({"4", "5", "6"}));
+    QVERIFY(parser->getCsvTable().isEmpty());
+}
+
+void TestCsvParser::testBlockBoundaries()
+{
+    // Rows, quoted line breaks and CRLF line ends end up on both sides of the read blocks
+    const int rows = 20000;
+    QTextStream out(file.data());
+    for (int i = 0; i < rows; ++i) {
+        out << i << ",\"line\r\nbreak " << i << "\",\"\"\"quoted\"\"\"\r\n";
+    }
+    out.flush();
+
+    parser->setMaxRows(10);
+    QVERIFY(parser->parse(file.data()));
+    QVERIFY(parser->isTruncated());
+    QCOMPARE(parser->getCsvTable().size(), 10);
+    QCOMPARE(parser->getCsvTable().at(9).at(0), QString("9"));
+
+    // Reparsing reads the same window again
+    QVERIFY(parser->reparse());
+    QCOMPARE(parser->getCsvTable().size(), 10);
+    parser->setMaxRows(0);
+    QVERIFY(parser->reparse());
+    QVERIFY(!parser->isTruncated());
+    QCOMPARE(parser->getCsvRows(), rows);
+
+    int row = 0;
+    QVERIFY(parser->parse(file.data(), [&row](const CsvRow& csvRow) {
+        if (csvRow != CsvRow({QString::number(row), QString("line\nbreak %1").arg(row), "\"quoted\""})) {
+            return false;
+        }
+        ++row;
+        return true;
+    }));
+    QCOMPARE(row, rows);
+}
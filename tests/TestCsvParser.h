@@ -56,6 +56,8 @@ private slots:
     void testQuoted();
     void testMultiline();
     void testColumns();
+    void testRowCallback();
+    void testBlockBoundaries();
 
 private:
     QScopedPointer<QTemporaryFile> file;
@@ -18,15 +18,21 @@
 
 #include "TestDatabase.h"
 
+#include <QBuffer>
+#include <QPointer>
 #include <QRegularExpression>
 #include <QSignalSpy>
 #include <QTest>
 
 #include "config-keepassx-tests.h"
+#include "core/Clock.h"
+#include "core/DatabaseMemoryIndex.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
+#include "format/KdbxJournal.h"
+#include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "util/TemporaryFile.h"
 
@@ -63,6 +69,50 @@ void TestDatabase::testOpen()
     QVERIFY(db->isModified());
 }
 
+void TestDatabase::testOpenFromData()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QFile file(dbFileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const auto fileData = file.readAll();
+    file.close();
+
+    auto db = QSharedPointer<Database>::create();
+    QVERIFY(db->open(dbFileName, fileData, key));
+    QVERIFY(db->isInitialized());
+
+    auto fileDb = QSharedPointer<Database>::create();
+    QVERIFY(fileDb->open(dbFileName, key));
+    QCOMPARE(db->rootGroup()->entriesRecursive().size(), fileDb->rootGroup()->entriesRecursive().size());
+
+    // Contents that are not a database are not replaced by the file
+    auto corruptDb = QSharedPointer<Database>::create();
+    QVERIFY(!corruptDb->open(dbFileName, fileData.left(fileData.size() / 2), key));
+}
+
+void TestDatabase::testReuseTransformedKey()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+    auto db = QSharedPointer<Database>::create();
+    QVERIFY(db->open(dbFileName, key));
+
+    auto copy = QSharedPointer<Database>::create();
+    copy->reuseTransformedKey(*db);
+    QVERIFY(copy->open(dbFileName, key));
+    QCOMPARE(copy->transformedDatabaseKey(), db->transformedDatabaseKey());
+
+    // The transformed key of a database with a different seed is not taken
+    auto otherSeed = QSharedPointer<Database>::create();
+    QVERIFY(otherSeed->setKey(key));
+    copy = QSharedPointer<Database>::create();
+    copy->reuseTransformedKey(*otherSeed);
+    QVERIFY(copy->open(dbFileName, key));
+    QCOMPARE(copy->transformedDatabaseKey(), db->transformedDatabaseKey());
+}
+
 void TestDatabase::testSave()
 {
     TemporaryFile tempFile;
@@ -92,18 +142,68 @@ void TestDatabase::testSave()
     QVERIFY2(db->save(Database::DirectWrite, QString(), &error), error.toLatin1());
     QVERIFY(!db->isModified());
 
+    // Test coalesced saves, the file is complete before its directory is synced to disk
+    for (const auto& name : {"test3a", "test3b"}) {
+        db->metadata()->setName(name);
+        QVERIFY2(db->save(Database::Coalesced, QString(), &error), error.toLatin1());
+        QVERIFY(!db->isModified());
+    }
+    auto saved = QSharedPointer<Database>::create();
+    QVERIFY(saved->open(tempFile.fileName(), key, &error));
+    QCOMPARE(saved->metadata()->name(), QString("test3b"));
+
     // Test save backups
+    auto readFile = [](const QString& filePath) {
+        QFile file(filePath);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    };
     TemporaryFile backupFile;
     auto backupFilePath = backupFile.fileName();
-    db->metadata()->setName("test4");
-    QVERIFY2(db->save(Database::Atomic, backupFilePath, &error), error.toLatin1());
-    QVERIFY(!db->isModified());
+    for (auto action : {Database::Atomic, Database::TempFile, Database::DirectWrite, Database::Coalesced}) {
+        auto previousFile = readFile(tempFile.fileName());
+        db->metadata()->setName(QString("test4-%1").arg(action));
+        QVERIFY2(db->save(action, backupFilePath, &error), error.toLatin1());
+        QVERIFY(!db->isModified());
+        QCOMPARE(readFile(backupFilePath), previousFile);
+    }
+
+    // The backup does not share its data with the saved file
+    auto backup = readFile(backupFilePath);
+    db->metadata()->setName("test5");
+    QVERIFY2(db->save(Database::DirectWrite, {}, &error), error.toLatin1());
+    QCOMPARE(readFile(backupFilePath), backup);
 
     QVERIFY(QFile::exists(backupFilePath));
     QFile::remove(backupFilePath);
     QVERIFY(!QFile::exists(backupFilePath));
 }
 
+void TestDatabase::testSaveSnapshot()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+    auto db = QSharedPointer<Database>::create();
+    QVERIFY(db->open(dbFileName, key));
+    db->metadata()->setName("snapshot");
+
+    // Changes made after the snapshot are not written
+    KeePass2Writer writer;
+    QVERIFY(writer.snapshotDatabase(db.data()));
+    db->metadata()->setName("changed");
+    db->rootGroup()->setName("changed");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY2(writer.writeDatabase(&buffer, db.data()), qPrintable(writer.errorString()));
+
+    buffer.seek(0);
+    auto written = QSharedPointer<Database>::create();
+    KeePass2Reader reader;
+    QVERIFY(reader.readDatabase(&buffer, key, written.data()));
+    QCOMPARE(written->metadata()->name(), QString("snapshot"));
+    QVERIFY(written->rootGroup()->name() != QString("changed"));
+}
+
 void TestDatabase::testSaveAs()
 {
     TemporaryFile tempFile;
@@ -138,6 +238,96 @@ void TestDatabase::testSaveAs()
     QCOMPARE(error, QString("Could not save, database has not been initialized!"));
 }
 
+void TestDatabase::testSaveJournal()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    QVERIFY2(db->open(tempFile.fileName(), key, &error), qPrintable(error));
+    auto journalFilePath = KdbxJournal::journalFilePath(db->canonicalFilePath());
+
+    auto group = new Group();
+    group->setUuid(QUuid::createUuid());
+    group->setName("journaled group");
+    group->setParent(db->rootGroup());
+
+    auto entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("journaled");
+    entry->setPassword("secret");
+    entry->attachments()->set("attachment", QByteArray("attachment data"));
+    entry->setGroup(group);
+
+    auto deletedEntry = new Entry();
+    deletedEntry->setUuid(QUuid::createUuid());
+    deletedEntry->setGroup(db->rootGroup());
+    auto deletedUuid = deletedEntry->uuid();
+
+    QVERIFY2(db->saveToJournal(&error), qPrintable(error));
+    QVERIFY(QFile::exists(journalFilePath));
+    QVERIFY(db->isModified());
+
+    // Consecutive changes to the same entry are replayed in order
+    entry->setTitle("renamed");
+    entry->setGroup(db->rootGroup());
+    delete deletedEntry;
+    QVERIFY2(db->saveToJournal(&error), qPrintable(error));
+
+    auto db2 = QSharedPointer<Database>::create();
+    QVERIFY2(db2->open(tempFile.fileName(), key, &error), qPrintable(error));
+    QVERIFY(db2->isModified());
+    auto replayed = db2->rootGroup()->findEntryByUuid(entry->uuid());
+    QVERIFY(replayed);
+    QCOMPARE(replayed->title(), QString("renamed"));
+    QCOMPARE(replayed->password(), QString("secret"));
+    QCOMPARE(replayed->attachments()->value("attachment"), QByteArray("attachment data"));
+    QCOMPARE(replayed->group(), db2->rootGroup());
+    QVERIFY(db2->rootGroup()->findGroupByUuid(group->uuid()));
+    QVERIFY(!db2->rootGroup()->findEntryByUuid(deletedUuid));
+    QVERIFY(db2->containsDeletedObject(deletedUuid));
+
+    // Changes outside of entries and groups need a full save
+    db->metadata()->setName("journal");
+    QVERIFY(!db->saveToJournal(&error));
+
+    // A full save replaces the journal
+    QFile journalFile(journalFilePath);
+    QVERIFY(journalFile.open(QIODevice::ReadOnly));
+    const auto journal = journalFile.readAll();
+    journalFile.close();
+    QVERIFY2(db->save(Database::Atomic, {}, &error), qPrintable(error));
+    QVERIFY(!QFile::exists(journalFilePath));
+
+    // A journal of another version of the file is kept instead of being replayed or overwritten
+    QVERIFY(journalFile.open(QIODevice::WriteOnly));
+    QCOMPARE(journalFile.write(journal), qint64(journal.size()));
+    journalFile.close();
+    auto db3 = QSharedPointer<Database>::create();
+    QVERIFY2(db3->open(tempFile.fileName(), key, &error), qPrintable(error));
+    QVERIFY(!db3->isModified());
+    const auto keptJournalFilePath = journalFilePath + ".unmerged";
+    QCOMPARE(db3->keptJournalFilePath(), keptJournalFilePath);
+    QVERIFY(!QFile::exists(journalFilePath));
+    QFile keptJournalFile(keptJournalFilePath);
+    QVERIFY(keptJournalFile.open(QIODevice::ReadOnly));
+    QCOMPARE(keptJournalFile.readAll(), journal);
+    keptJournalFile.close();
+    QVERIFY(keptJournalFile.remove());
+
+    // Touching the file does not invalidate the journal, only other contents do
+    QFile dbFile(tempFile.fileName());
+    QVERIFY(dbFile.open(QIODevice::ReadWrite));
+    QVERIFY(dbFile.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+    dbFile.close();
+    db3->rootGroup()->findEntryByUuid(entry->uuid())->setTitle("touched");
+    QVERIFY2(db3->saveToJournal(&error), qPrintable(error));
+}
+
 void TestDatabase::testSignals()
 {
     TemporaryFile tempFile;
@@ -233,10 +423,25 @@ void TestDatabase::testEmptyRecycleBinWithHierarchicalData()
     QFile originalFile(filename);
     qint64 initialSize = originalFile.size();
 
+    QList<QPointer<Entry>> recycledEntries;
+    QList<QUuid> recycledUuids;
+    for (auto* entry : db->metadata()->recycleBin()->entriesRecursive()) {
+        recycledEntries.append(entry);
+        recycledUuids.append(entry->uuid());
+    }
+    QVERIFY(!recycledEntries.isEmpty());
+
     db->emptyRecycleBin();
     QVERIFY(db->metadata()->recycleBin());
     QVERIFY(db->metadata()->recycleBin()->entries().empty());
     QVERIFY(db->metadata()->recycleBin()->children().empty());
+    for (const auto& uuid : asConst(recycledUuids)) {
+        QVERIFY(db->containsDeletedObject(uuid));
+    }
+    // Detached entries are deleted in chunks while the event loop runs
+    QTRY_VERIFY(std::all_of(recycledEntries.begin(), recycledEntries.end(), [](const QPointer<Entry>& entry) {
+        return entry.isNull();
+    }));
 
     QTemporaryFile afterCleanup;
     afterCleanup.open();
@@ -267,4 +472,178 @@ void TestDatabase::testCustomIcons()
     QCOMPARE(iconData.data, icon2);
     QCOMPARE(iconData.name, QString("Test"));
     QCOMPARE(iconData.lastModified, date);
+
+    // Duplicates map to the first icon with the same data
+    QUuid uuid3 = QUuid::createUuid();
+    db.metadata()->addCustomIcon(uuid3, icon1);
+    QList<QPair<QUuid, QByteArray>> icons;
+    for (const auto& uuid : db.metadata()->customIconsOrder()) {
+        icons.append({uuid, db.metadata()->customIcon(uuid).data});
+    }
+    const auto duplicates = Metadata::findDuplicateIcons(icons);
+    QCOMPARE(duplicates.size(), 1);
+    QCOMPARE(duplicates.value(uuid3), uuid1);
+}
+
+void TestDatabase::testTagList()
+{
+    Database db;
+    auto root = db.rootGroup();
+    auto group = new Group();
+    group->setParent(root);
+
+    auto entry1 = new Entry();
+    entry1->setGroup(root);
+    entry1->setTags("b,c");
+    entry1->setUsername("Name1");
+    auto entry2 = new Entry();
+    entry2->setGroup(group);
+    entry2->setTags("c");
+    entry2->setUsername("Name2");
+    auto entry3 = new Entry();
+    entry3->setGroup(group);
+    entry3->setUsername("Name2");
+
+    QCOMPARE(db.tagList(), QStringList({"b", "c"}));
+    db.updateCommonUsernames();
+    QCOMPARE(db.commonUsernames(), QStringList({"Name2", "Name1"}));
+    QCOMPARE(db.usernameList(), QStringList({"Name1", "Name2"}));
+
+    QSignalSpy spyAdded(&db, SIGNAL(tagAdded(QString, int)));
+    QSignalSpy spyRemoved(&db, SIGNAL(tagRemoved(QString, int)));
+
+    // Tags still used by other entries are not announced
+    entry3->setTags("a,c");
+    QCOMPARE(db.tagList(), QStringList({"a", "b", "c"}));
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(spyAdded.at(0).at(0).toString(), QString("a"));
+    QCOMPARE(spyAdded.at(0).at(1).toInt(), 0);
+    QCOMPARE(spyRemoved.count(), 0);
+
+    entry1->removeTag("b");
+    QCOMPARE(db.tagList(), QStringList({"a", "c"}));
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyRemoved.at(0).at(0).toString(), QString("b"));
+    QCOMPARE(spyRemoved.at(0).at(1).toInt(), 1);
+
+    // Modifications that keep the tags do not touch the tag list
+    entry1->setPassword("password");
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(spyRemoved.count(), 1);
+
+    // Tags of recycled entries are not listed
+    db.recycleGroup(group);
+    QCOMPARE(db.tagList(), QStringList({"c"}));
+    QCOMPARE(spyRemoved.count(), 2);
+    QCOMPARE(spyRemoved.at(1).at(0).toString(), QString("a"));
+
+    auto entry4 = new Entry();
+    entry4->setTags("d");
+    entry4->setGroup(root);
+    QCOMPARE(db.tagList(), QStringList({"c", "d"}));
+
+    delete entry1;
+    QCOMPARE(db.tagList(), QStringList({"d"}));
+    db.updateCommonUsernames();
+    QCOMPARE(db.commonUsernames(), QStringList({"Name2"}));
+    QCOMPARE(db.usernameList(), QStringList({"Name2"}));
+
+    // The ranking follows username changes
+    entry4->setUsername("Name3");
+    entry4->clone(Entry::CloneNewUuid)->setGroup(root);
+    entry4->clone(Entry::CloneNewUuid)->setGroup(root);
+    db.updateCommonUsernames(1);
+    QCOMPARE(db.commonUsernames(), QStringList({"Name3"}));
+    QCOMPARE(db.usernameList(), QStringList({"Name2", "Name3"}));
+}
+
+void TestDatabase::testDeletedObjects()
+{
+    Database db;
+    const auto now = Clock::currentDateTimeUtc();
+    const auto uuid1 = QUuid::createUuid();
+    const auto uuid2 = QUuid::createUuid();
+
+    db.addDeletedObject({uuid1, now.addDays(-400)});
+    db.addDeletedObject({uuid2, now.addDays(-10)});
+    db.addDeletedObject({uuid1, now.addDays(-5)});
+    QVERIFY(db.containsDeletedObject(uuid1));
+    QVERIFY(db.containsDeletedObject(uuid2));
+    QVERIFY(!db.containsDeletedObject(QUuid::createUuid()));
+
+    // A uuid stays deleted as long as one of its records is left
+    QCOMPARE(db.pruneDeletedObjects(now.addDays(-30)), 1);
+    QCOMPARE(db.deletedObjects().size(), 2);
+    QCOMPARE(db.deletedObjects().first().uuid, uuid2);
+    QVERIFY(db.containsDeletedObject(uuid1));
+
+    QCOMPARE(db.pruneDeletedObjects(now.addDays(-7)), 1);
+    QVERIFY(!db.containsDeletedObject(uuid2));
+    QVERIFY(db.containsDeletedObject(uuid1));
+
+    db.setDeletedObjects({});
+    QVERIFY(!db.containsDeletedObject(uuid1));
+}
+
+void TestDatabase::testReleaseDataInBackground()
+{
+    auto db = QSharedPointer<Database>::create();
+    auto group = new Group();
+    group->setParent(db->rootGroup());
+    QPointer<Entry> entry = new Entry();
+    entry->setGroup(group);
+    entry->setTitle("entry");
+    QPointer<Entry> historyItem = new Entry();
+    entry->addHistoryItem(historyItem);
+
+    QSignalSpy spyModified(db.data(), SIGNAL(modified()));
+    QSignalSpy spyGroupRemoved(db.data(), SIGNAL(groupRemoved()));
+    db->releaseData(true);
+
+    QVERIFY(db->rootGroup());
+    QVERIFY(db->rootGroup()->entriesRecursive().isEmpty());
+    QVERIFY(db->deletedObjects().isEmpty());
+    QTRY_VERIFY(entry.isNull() && historyItem.isNull());
+    QCOMPARE(spyModified.count(), 0);
+    QCOMPARE(spyGroupRemoved.count(), 0);
+}
+
+void TestDatabase::testMemoryUsage()
+{
+    Database db;
+    auto index = DatabaseMemoryIndex::forDatabase(&db);
+    const auto empty = index->usage();
+    QCOMPARE(empty.entries, 0);
+    QCOMPARE(empty.attachments, 0);
+
+    auto entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->setNotes(QString(1000, 'n'));
+    entry->attachments()->set("data.bin", QByteArray(4096, 'a'));
+    auto usage = index->usage();
+    QVERIFY(usage.entries > 2000);
+    QVERIFY(usage.attachments > 4096);
+    QCOMPARE(usage.history, 0);
+    const auto entries = usage.entries;
+    const auto attachments = usage.attachments;
+
+    // History items share the notes and the attachment data of the entry
+    entry->addHistoryItem(entry->clone(Entry::CloneNoFlags));
+    usage = index->usage();
+    QVERIFY(usage.history > 0);
+    QVERIFY(usage.history < 2000);
+    QCOMPARE(usage.attachments, attachments);
+
+    entry->attachments()->set("other.bin", QByteArray(100, 'b'));
+    QVERIFY(index->usage().attachments > attachments + 100);
+
+    db.metadata()->addCustomIcon(QUuid::createUuid(), QByteArray(100, 'i'));
+    QCOMPARE(index->usage().customIcons, 100);
+    QVERIFY(index->usage().total() > entries + attachments);
+
+    delete entry;
+    usage = index->usage();
+    QCOMPARE(usage.entries, 0);
+    QCOMPARE(usage.history, 0);
+    QCOMPARE(usage.attachments, 0);
 }
@@ -28,14 +28,22 @@ class TestDatabase : public QObject
 private slots:
     void initTestCase();
     void testOpen();
+    void testOpenFromData();
+    void testReuseTransformedKey();
     void testSave();
+    void testSaveSnapshot();
     void testSaveAs();
+    void testSaveJournal();
     void testSignals();
     void testEmptyRecycleBinOnDisabled();
     void testEmptyRecycleBinOnNotCreated();
     void testEmptyRecycleBinOnEmpty();
     void testEmptyRecycleBinWithHierarchicalData();
     void testCustomIcons();
+    void testTagList();
+    void testDeletedObjects();
+    void testReleaseDataInBackground();
+    void testMemoryUsage();
 };
 
 #endif // KEEPASSX_TESTDATABASE_H
@@ -16,14 +16,19 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QBuffer>
+#include <QSignalSpy>
 #include <QTest>
 
 #include "TestEntry.h"
 #include "core/Clock.h"
+#include "core/EntryExpiryIndex.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/TimeInfo.h"
+#include "core/Totp.h"
 #include "crypto/Crypto.h"
+#include "mock/MockClock.h"
 
 QTEST_GUILESS_MAIN(TestEntry)
 
@@ -47,6 +52,89 @@ void TestEntry::testHistoryItemDeletion()
     QVERIFY(historyEntry.isNull());
 }
 
+void TestEntry::testHistoryItemSharing()
+{
+    const QString notes = QString("notes").repeated(1000);
+    QScopedPointer<Entry> entry(new Entry());
+    entry->setNotes(notes);
+    entry->setTitle("title");
+
+    // Separate copies like the ones read from a file
+    auto historyEntry = new Entry();
+    historyEntry->setNotes(QString::fromUtf8(notes.toUtf8()));
+    historyEntry->setTitle("old title");
+    QVERIFY(historyEntry->notes().constData() != entry->notes().constData());
+
+    entry->addHistoryItem(historyEntry);
+    QCOMPARE(historyEntry->notes(), notes);
+    QCOMPARE(historyEntry->notes().constData(), entry->notes().constData());
+    QCOMPARE(historyEntry->title(), QString("old title"));
+
+    // Unchanged fields are shared with the previous history item as well
+    auto secondHistoryEntry = new Entry();
+    secondHistoryEntry->setNotes(notes);
+    secondHistoryEntry->setTitle(QString::fromUtf8("old title"));
+    entry->addHistoryItem(secondHistoryEntry);
+    QCOMPARE(secondHistoryEntry->title().constData(), historyEntry->title().constData());
+
+    // History items are snapshots that do not track their own changes
+    const auto modificationTime = historyEntry->timeInfo().lastModificationTime();
+    QSignalSpy spyModified(historyEntry, &Entry::modified);
+    historyEntry->customData()->set("key", "value");
+    QCOMPARE(spyModified.count(), 0);
+    QCOMPARE(historyEntry->timeInfo().lastModificationTime(), modificationTime);
+}
+
+void TestEntry::testSizeCache()
+{
+    QScopedPointer<Entry> entry(new Entry());
+    entry->setNotes("notes");
+    const int size = entry->size();
+    QCOMPARE(entry->size(), size);
+
+    // Modifications are noticed while the modified signal is disabled as well
+    entry->setEmitModified(false);
+    entry->attributes()->set("attr", "value");
+    entry->attachments()->set("attachment", "data");
+    entry->setTags("tag");
+    QVERIFY(entry->size() > size);
+
+    QScopedPointer<Entry> clone(entry->clone(Entry::CloneNoFlags));
+    QCOMPARE(entry->size(), clone->size());
+}
+
+void TestEntry::testInternedAttributeKeys()
+{
+    QScopedPointer<Entry> entry(new Entry());
+    // Separate copy like the ones read from a file
+    entry->attributes()->set(QString::fromUtf8("KPEX_PASSKEY_USERNAME"), "user", true);
+    entry->attributes()->set("custom", "value");
+
+    const auto keys = entry->attributes()->keys();
+    const int index = keys.indexOf(EntryAttributes::KPEX_PASSKEY_USERNAME);
+    QVERIFY(index >= 0);
+    QCOMPARE(keys.at(index).constData(), EntryAttributes::KPEX_PASSKEY_USERNAME.constData());
+    QVERIFY(entry->attributes()->isProtected(EntryAttributes::KPEX_PASSKEY_USERNAME));
+    QCOMPARE(entry->attributes()->value("custom"), QString("value"));
+}
+
+void TestEntry::testAttachmentStreams()
+{
+    QScopedPointer<Entry> entry(new Entry());
+    const QByteArray data = QByteArray("attachment data").repeated(1000);
+
+    QBuffer input;
+    input.setData(data);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+    QVERIFY(entry->attachments()->readFrom("a.bin", &input));
+    QCOMPARE(entry->attachments()->value("a.bin"), data);
+
+    QBuffer output;
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    QVERIFY(entry->attachments()->writeTo("a.bin", &output));
+    QCOMPARE(output.data(), data);
+}
+
 void TestEntry::testCopyDataFrom()
 {
     QScopedPointer<Entry> entry(new Entry());
@@ -77,6 +165,12 @@ void TestEntry::testCopyDataFrom()
     QCOMPARE(entry2->attachments()->value("test"), QByteArray("123"));
     QCOMPARE(entry2->attachments()->value("test2"), QByteArray("456"));
 
+    // Copied attachments share their data and compare equal until one of them changes
+    QCOMPARE(entry2->attachments()->value("test").constData(), entry->attachments()->value("test").constData());
+    QVERIFY(*entry2->attachments() == *entry->attachments());
+    entry2->attachments()->set("test2", "789");
+    QVERIFY(*entry2->attachments() != *entry->attachments());
+
     QCOMPARE(entry2->autoTypeAssociations()->size(), 2);
     QCOMPARE(entry2->autoTypeAssociations()->get(0).window, QString("1"));
     QCOMPARE(entry2->autoTypeAssociations()->get(1).window, QString("3"));
@@ -445,6 +539,111 @@ void TestEntry::testResolveReferencePlaceholders()
              entry3->attributes()->value("AttributeNotes"));
 }
 
+void TestEntry::testReferenceIndex()
+{
+    Database db;
+    auto* root = db.rootGroup();
+    auto* group = new Group();
+    group->setParent(root);
+
+    auto* target = new Entry();
+    target->setGroup(group);
+    target->setTitle("Target");
+    target->setUsername("user");
+
+    auto* tstEntry = new Entry();
+    tstEntry->setGroup(root);
+    tstEntry->setTitle("{REF:U@T:Target}");
+    QCOMPARE(tstEntry->resolveMultiplePlaceholders(tstEntry->title()), QString("user"));
+
+    // The index follows changes to the referenced entries
+    target->setUsername("other");
+    QCOMPARE(tstEntry->resolveMultiplePlaceholders(tstEntry->title()), QString("other"));
+    target->setTitle("Renamed");
+    QCOMPARE(tstEntry->resolveMultiplePlaceholders(tstEntry->title()), QString());
+
+    // The first entry in tree order wins
+    auto* first = new Entry();
+    first->setGroup(root);
+    first->setTitle("Renamed");
+    first->setUsername("first");
+    tstEntry->setTitle("{REF:U@T:Renamed}");
+    QCOMPARE(tstEntry->resolveMultiplePlaceholders(tstEntry->title()), QString("first"));
+    QCOMPARE(root->findEntryBySearchTerm(target->uuidToHex(), EntryReferenceType::QUuid), target);
+
+    delete first;
+    QCOMPARE(tstEntry->resolveMultiplePlaceholders(tstEntry->title()), QString("other"));
+
+    // Referrers are found by uuid and follow changes to the referring entries
+    QVERIFY(root->referencesRecursive(target).isEmpty());
+    tstEntry->setUsername("{REF:U@I:" + target->uuidToHex().toUpper() + "}");
+    QCOMPARE(root->referencesRecursive(target), QList<Entry*>() << tstEntry);
+    QCOMPARE(group->referencesRecursive(target), QList<Entry*>());
+    tstEntry->setUsername("plain");
+    QVERIFY(root->referencesRecursive(target).isEmpty());
+}
+
+void TestEntry::testPlaceholderCache()
+{
+    Database db;
+    auto* root = db.rootGroup();
+
+    auto* target = new Entry();
+    target->setGroup(root);
+    target->setTitle("Target");
+    target->setPassword("secret");
+
+    auto* entry = new Entry();
+    entry->setGroup(root);
+    entry->setUsername("user");
+    entry->setTitle("{USERNAME} {REF:P@I:" + target->uuidToHex() + "}");
+    QCOMPARE(entry->resolveMultiplePlaceholders(entry->title()), QString("user secret"));
+
+    // Own changes and changes to referenced entries are picked up
+    entry->setUsername("other");
+    QCOMPARE(entry->resolveMultiplePlaceholders(entry->title()), QString("other secret"));
+    target->setPassword("changed");
+    QCOMPARE(entry->resolveMultiplePlaceholders(entry->title()), QString("other changed"));
+    entry->attributes()->set("Attribute", "value");
+    QCOMPARE(entry->resolvePlaceholder("{S:Attribute}"), QString("value"));
+    entry->attributes()->set("Attribute", "new value");
+    QCOMPARE(entry->resolvePlaceholder("{S:Attribute}"), QString("new value"));
+
+    // Time dependent placeholders are never cached
+    MockClock::setup(new MockClock(2020, 1, 2, 3, 4, 5));
+    QCOMPARE(entry->resolveMultiplePlaceholders("{DT_UTC_SIMPLE}"), QString("20200102030405"));
+    MockClock::teardown();
+    MockClock::setup(new MockClock(2021, 1, 2, 3, 4, 5));
+    QCOMPARE(entry->resolveMultiplePlaceholders("{DT_UTC_SIMPLE}"), QString("20210102030405"));
+    MockClock::teardown();
+
+    // Every reference of a field is resolved, no matter how many there are
+    QStringList references;
+    QStringList passwords;
+    for (int i = 0; i < 100; ++i) {
+        auto* referenced = new Entry();
+        referenced->setGroup(root);
+        referenced->setPassword(QString::number(i));
+        references << "{REF:P@I:" + referenced->uuidToHex() + "}";
+        passwords << QString::number(i);
+    }
+    entry->setNotes(references.join(' '));
+    QCOMPARE(entry->resolveMultiplePlaceholders(entry->notes()), passwords.join(' '));
+
+    // Chains that reference the next link more than once are resolved in full
+    auto* link = new Entry();
+    link->setGroup(root);
+    link->setPassword("end");
+    for (int i = 0; i < 3; ++i) {
+        auto* next = new Entry();
+        next->setGroup(root);
+        const QString reference = "{REF:P@I:" + link->uuidToHex() + "}";
+        next->setPassword(reference + reference);
+        link = next;
+    }
+    QCOMPARE(entry->resolveMultiplePlaceholders("{REF:P@I:" + link->uuidToHex() + "}"), QString("end").repeated(8));
+}
+
 void TestEntry::testResolveNonIdPlaceholdersToUuid()
 {
     Database db;
@@ -592,6 +791,32 @@ void TestEntry::testResolveClonedEntry()
     QCOMPARE(cclone4->resolveMultiplePlaceholders(cclone4->password()), original->password());
 }
 
+void TestEntry::testTotpCache()
+{
+    // Test vectors from RFC 6238, the first time is the last second of its time step
+    auto clock = new MockClock(QDateTime::fromSecsSinceEpoch(1111111109, Qt::UTC));
+    MockClock::setup(clock);
+
+    Entry entry;
+    auto settings = Totp::createSettings("GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ");
+    entry.setTotp(settings);
+    QCOMPARE(entry.totp(), QString("081804"));
+    QCOMPARE(entry.totp(), QString("081804"));
+
+    // The code of the next time step was generated ahead
+    clock->advanceSecond(2);
+    QCOMPARE(entry.totp(), Totp::generateTotp(settings, 1111111111));
+
+    // Changed settings are picked up immediately
+    settings->digits = 8;
+    entry.setTotp(settings);
+    QCOMPARE(entry.totp(), QString("14050471"));
+    entry.attributes()->set(Totp::ATTRIBUTE_OTP, Totp::writeSettings(Totp::createSettings("GEZDGNBVGY3TQOJQ")));
+    QCOMPARE(entry.totp(), Totp::generateTotp(Totp::createSettings("GEZDGNBVGY3TQOJQ"), 1111111111));
+
+    MockClock::teardown();
+}
+
 void TestEntry::testIsRecycled()
 {
     auto entry = new Entry();
@@ -617,6 +842,50 @@ void TestEntry::testIsRecycled()
     QVERIFY(entry1->isRecycled());
 }
 
+void TestEntry::testExpiryIndex()
+{
+    Database db;
+    auto root = db.rootGroup();
+    const auto now = Clock::currentDateTimeUtc();
+
+    auto expired = new Entry();
+    expired->setGroup(root);
+    expired->setExpiryTime(now.addDays(-1));
+    expired->setExpires(true);
+    auto expiring = new Entry();
+    expiring->setGroup(root);
+    expiring->setExpiryTime(now.addDays(5));
+    expiring->setExpires(true);
+    auto unlimited = new Entry();
+    unlimited->setGroup(root);
+
+    auto index = EntryExpiryIndex::forDatabase(&db);
+    QCOMPARE(EntryExpiryIndex::forDatabase(&db), index);
+    QCOMPARE(index->entriesExpiringBefore(now), QList<Entry*>({expired}));
+    QCOMPARE(index->entriesExpiringBefore(now.addDays(10)), QList<Entry*>({expired, expiring}));
+    QCOMPARE(index->nextExpiryAfter(now), now.addDays(5));
+
+    // Changed expiry times reorder the queue
+    unlimited->setExpiryTime(now.addDays(2));
+    unlimited->setExpires(true);
+    expiring->setExpires(false);
+    QCOMPARE(index->entriesExpiringBefore(now.addDays(10)), QList<Entry*>({expired, unlimited}));
+    QCOMPARE(index->nextExpiryAfter(now.addDays(2)), QDateTime());
+
+    // Entries in the recycle bin are left out, also when their group is recycled
+    db.recycleEntry(expired);
+    QCOMPARE(index->entriesExpiringBefore(now), QList<Entry*>());
+    auto group = new Group();
+    group->setParent(root);
+    unlimited->setGroup(group);
+    QCOMPARE(index->entriesExpiringBefore(now.addDays(10)), QList<Entry*>({unlimited}));
+    db.recycleGroup(group);
+    QCOMPARE(index->entriesExpiringBefore(now.addDays(10)), QList<Entry*>());
+
+    delete expiring;
+    QCOMPARE(index->nextExpiryAfter(now.addDays(-10)), QDateTime());
+}
+
 void TestEntry::testMoveUpDown()
 {
     Database db;
@@ -771,3 +1040,30 @@ void TestEntry::testPreviousParentGroup()
     QVERIFY(entry->previousParentGroupUuid() == group1->uuid());
     QVERIFY(entry->previousParentGroup() == group1);
 }
+
+void TestEntry::testTimeInfo()
+{
+    TimeInfo timeInfo;
+    const auto time = Clock::datetimeUtc(1, 1, 1, 12, 30, 15).addMSecs(250);
+    timeInfo.setLastModificationTime(time);
+    QCOMPARE(timeInfo.lastModificationTime(), time);
+    QCOMPARE(timeInfo.lastModificationTime().timeSpec(), Qt::UTC);
+
+    timeInfo.setExpiryTime(QDateTime());
+    QVERIFY(timeInfo.expiryTime().isNull());
+
+    // Milliseconds are ignored on request, also before the epoch
+    TimeInfo other = timeInfo;
+    QVERIFY(other == timeInfo);
+    other.setLastModificationTime(time.addMSecs(500));
+    QVERIFY(other != timeInfo);
+    QVERIFY(other.equals(timeInfo, CompareItemIgnoreMilliseconds));
+    other.setLastModificationTime(time.addMSecs(-500));
+    QVERIFY(!other.equals(timeInfo, CompareItemIgnoreMilliseconds));
+
+    // The expiry time is only compared for expiring items when ignoring disabled values
+    other = timeInfo;
+    other.setExpiryTime(time);
+    QVERIFY(other != timeInfo);
+    QVERIFY(other.equals(timeInfo, CompareItemIgnoreDisabled));
+}
@@ -29,17 +29,26 @@ class TestEntry : public QObject
 private slots:
     void initTestCase();
     void testHistoryItemDeletion();
+    void testHistoryItemSharing();
+    void testSizeCache();
+    void testInternedAttributeKeys();
     void testCopyDataFrom();
+    void testAttachmentStreams();
     void testClone();
     void testResolveUrl();
     void testResolveUrlPlaceholders();
     void testResolveRecursivePlaceholders();
     void testResolveReferencePlaceholders();
+    void testReferenceIndex();
+    void testPlaceholderCache();
     void testResolveNonIdPlaceholdersToUuid();
     void testResolveClonedEntry();
+    void testTotpCache();
     void testIsRecycled();
+    void testExpiryIndex();
     void testMoveUpDown();
     void testPreviousParentGroup();
+    void testTimeInfo();
 };
 
 #endif // KEEPASSX_TESTENTRY_H
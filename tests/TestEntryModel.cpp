@@ -29,6 +29,7 @@
 #include "gui/entry/AutoTypeAssociationsModel.h"
 #include "gui/entry/EntryAttachmentsModel.h"
 #include "gui/entry/EntryAttributesModel.h"
+#include "gui/entry/EntryHistoryModel.h"
 #include "gui/entry/EntryModel.h"
 #include "modeltest.h"
 
@@ -117,9 +118,28 @@ void TestEntryModel::test()
     QCOMPARE(spyAboutToRemove.count(), 1);
     QCOMPARE(spyRemoved.count(), 1);
 
+    // Switching groups updates the rows instead of resetting the model
     QSignalSpy spyReset(model, SIGNAL(modelReset()));
     model->setGroup(group2);
-    QCOMPARE(spyReset.count(), 1);
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(spyAboutToRemove.count(), 2);
+    QCOMPARE(spyAboutToAdd.count(), 2);
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->entryFromIndex(model->index(0, 1)), entry2);
+
+    // Search results keep the rows of entries found again
+    auto entry4 = new Entry();
+    entry4->setGroup(group2);
+    model->setEntries({entry1, entry2, entry3});
+    QCOMPARE(model->rowCount(), 3);
+    QPersistentModelIndex entry2Index(model->indexFromEntry(entry2));
+    model->setEntries({entry4, entry2, entry1});
+    QCOMPARE(spyReset.count(), 0);
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(model->entryFromIndex(model->index(0, 1)), entry4);
+    QCOMPARE(model->entryFromIndex(model->index(1, 1)), entry2);
+    QCOMPARE(model->entryFromIndex(model->index(2, 1)), entry1);
+    QCOMPARE(entry2Index.row(), 1);
 
     delete group1;
     delete group2;
@@ -346,6 +366,54 @@ void TestEntryModel::testProxyModel()
     delete db;
 }
 
+void TestEntryModel::testDisplayCache()
+{
+    auto group = new Group();
+    auto entry1 = new Entry();
+    entry1->setGroup(group);
+    entry1->setTitle("b title");
+    auto entry2 = new Entry();
+    entry2->setGroup(group);
+    entry2->setTitle("A title");
+    auto entry3 = new Entry();
+    entry3->setGroup(group);
+    entry3->setTitle("{USERNAME}");
+    entry3->setUsername("c title");
+
+    auto modelSource = new EntryModel(this);
+    auto modelProxy = new SortFilterHideProxyModel(this);
+    modelProxy->setSourceModel(modelSource);
+    modelProxy->setSortRole(Qt::UserRole);
+    modelSource->setGroup(group);
+
+    const auto titleIndex = modelSource->index(0, EntryModel::Title);
+    const auto attachmentsIndex = modelSource->index(0, EntryModel::Attachments);
+    QCOMPARE(modelSource->data(titleIndex).toString(), QString("b title"));
+    QCOMPARE(modelSource->data(attachmentsIndex).toString(), QString());
+
+    // Changes that do not emit entryDataChanged are picked up as well
+    entry1->setTitle("d title");
+    entry1->attachments()->set("file.txt", QByteArray("data"));
+    QCOMPARE(modelSource->data(titleIndex).toString(), QString("d title"));
+    QCOMPARE(modelSource->data(attachmentsIndex).toString(), QString("file.txt"));
+
+    modelProxy->sort(EntryModel::Title);
+    QCOMPARE(modelProxy->index(0, EntryModel::Title).data().toString(), QString("A title"));
+    QCOMPARE(modelProxy->index(1, EntryModel::Title).data().toString(), QString("c title"));
+    QCOMPARE(modelProxy->index(2, EntryModel::Title).data().toString(), QString("d title"));
+
+    // Sort keys follow changed values
+    entry2->setTitle("e title");
+    entry3->setUsername("a title");
+    modelProxy->invalidate();
+    QCOMPARE(modelProxy->index(0, EntryModel::Title).data().toString(), QString("a title"));
+    QCOMPARE(modelProxy->index(2, EntryModel::Title).data().toString(), QString("e title"));
+
+    delete modelProxy;
+    delete modelSource;
+    delete group;
+}
+
 void TestEntryModel::testDatabaseDelete()
 {
     auto model = new EntryModel(this);
@@ -376,3 +444,100 @@ void TestEntryModel::testDatabaseDelete()
     delete modelTest;
     delete model;
 }
+
+void TestEntryModel::testBulkUpdate()
+{
+    auto model = new EntryModel(this);
+    auto modelTest = new ModelTest(model, this);
+
+    Database db;
+    QSignalSpy spyModified(&db, SIGNAL(modified()));
+    auto group = db.rootGroup();
+    auto entry1 = new Entry();
+    entry1->setGroup(group);
+    auto entry2 = new Entry();
+    entry2->setGroup(group);
+    auto entry3 = new Entry();
+    entry3->setGroup(group);
+    model->setGroup(group);
+    QCOMPARE(model->rowCount(), 3);
+    QTRY_COMPARE(spyModified.count(), 1);
+    spyModified.clear();
+
+    QSignalSpy spyReset(model, SIGNAL(modelReset()));
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+    QSignalSpy spyInserted(model, SIGNAL(rowsInserted(QModelIndex, int, int)));
+    {
+        DatabaseBulkUpdate bulkUpdate(&db);
+        delete entry1;
+        delete entry2;
+        auto entry4 = new Entry();
+        entry4->setGroup(group);
+        entry3->setTitle("changed");
+        QVERIFY(db.isBulkUpdating());
+    }
+
+    // The rows are reset once instead of being changed one by one
+    QVERIFY(!db.isBulkUpdating());
+    QCOMPARE(spyReset.count(), 1);
+    QCOMPARE(spyRemoved.count(), 0);
+    QCOMPARE(spyInserted.count(), 0);
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(model->entryFromIndex(model->index(0, 0)), entry3);
+    QTRY_COMPARE(spyModified.count(), 1);
+
+    // Changes outside of a bulk update are announced as usual
+    delete entry3;
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyReset.count(), 1);
+
+    delete modelTest;
+    delete model;
+}
+
+void TestEntryModel::testHistoryModel()
+{
+    auto model = new EntryHistoryModel(this);
+    auto modelTest = new ModelTest(model, this);
+
+    const auto modified = QDateTime(QDate(2026, 1, 1), QTime(12, 0), Qt::UTC);
+    QScopedPointer<Entry> entry(new Entry());
+    for (int i = 0; i < 100; ++i) {
+        auto historyItem = new Entry();
+        historyItem->setTitle(QString("title%1").arg(i / 2));
+        historyItem->setUsername(QString("user%1").arg((i + 1) / 2));
+        TimeInfo timeInfo;
+        timeInfo.setLastModificationTime(modified.addSecs(i));
+        historyItem->setTimeInfo(timeInfo);
+        entry->addHistoryItem(historyItem);
+    }
+    TimeInfo timeInfo;
+    timeInfo.setLastModificationTime(modified.addSecs(100));
+    entry->setTimeInfo(timeInfo);
+
+    // Rows are fetched in batches, newest first
+    model->setEntries(entry->historyItems(), entry.data());
+    QVERIFY(model->rowCount() < 101);
+    QVERIFY(model->canFetchMore(QModelIndex()));
+    while (model->canFetchMore(QModelIndex())) {
+        model->fetchMore(QModelIndex());
+    }
+    QCOMPARE(model->rowCount(), 101);
+    QVERIFY(!model->entryFromIndex(model->index(0, 0)));
+    QCOMPARE(model->entryFromIndex(model->index(1, 0)), entry->historyItems().at(99));
+
+    QCOMPARE(model->data(model->index(1, 2)).toString(), QString("Username"));
+    QCOMPARE(model->data(model->index(2, 2)).toString(), QString("Title"));
+    QCOMPARE(model->data(model->index(100, 2)).toString(), QString());
+
+    // Deleting a row compares the newer row with the next older one
+    QSignalSpy spyChanged(model, SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)));
+    model->deleteIndex(model->index(2, 0));
+    QCOMPARE(spyChanged.count(), 1);
+    QCOMPARE(model->rowCount(), 100);
+    QCOMPARE(model->data(model->index(1, 2)).toString(), QString("Title, Username"));
+    QCOMPARE(model->deletedEntries().size(), 1);
+
+    delete modelTest;
+    delete model;
+}
@@ -33,7 +33,10 @@ private slots:
     void testCustomIconModel();
     void testAutoTypeAssociationsModel();
     void testProxyModel();
+    void testDisplayCache();
     void testDatabaseDelete();
+    void testBulkUpdate();
+    void testHistoryModel();
 };
 
 #endif // KEEPASSX_TESTENTRYMODEL_H
@@ -17,12 +17,19 @@
 
 #include "TestEntrySearcher.h"
 #include "core/Group.h"
+#include "core/LiveSearch.h"
 #include "core/Tools.h"
+#include "crypto/Crypto.h"
 
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestEntrySearcher)
 
+void TestEntrySearcher::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
 void TestEntrySearcher::init()
 {
     m_rootGroup = new Group();
@@ -394,3 +401,199 @@ void TestEntrySearcher::testUUIDSearch()
     m_searchResult = m_entrySearcher.search("uuid:" + Tools::uuidToHex(uuid1), m_rootGroup);
     QCOMPARE(m_searchResult.count(), 1);
 }
+
+void TestEntrySearcher::testSearchIndex()
+{
+    Database db;
+    auto group = new Group();
+    group->setName("group1");
+    group->setParent(db.rootGroup());
+
+    auto entry1 = new Entry();
+    entry1->setGroup(group);
+    entry1->setTitle("GitHub");
+    entry1->setUsername("alice");
+
+    auto entry2 = new Entry();
+    entry2->setGroup(group);
+    entry2->setTitle("GitLab");
+    entry2->setNotes("MIRROR OF GITHUB");
+
+    // Placeholders are resolved on every search
+    auto entry3 = new Entry();
+    entry3->setGroup(db.rootGroup());
+    entry3->setTitle("{USERNAME}");
+    entry3->setUsername("github-bot");
+
+    m_searchResult = m_entrySearcher.search("github", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry3, entry1, entry2}));
+    m_searchResult = m_entrySearcher.search("title:github", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry3, entry1}));
+    m_searchResult = m_entrySearcher.search("gith*b", db.rootGroup());
+    QCOMPARE(m_searchResult.size(), 3);
+
+    // Modified entries are re-indexed
+    entry1->setTitle("Codeberg");
+    entry2->setNotes("");
+    m_searchResult = m_entrySearcher.search("github", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry3}));
+    m_searchResult = m_entrySearcher.search("codeberg", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1}));
+
+    entry3->setUsername("robot");
+    m_searchResult = m_entrySearcher.search("title:robot", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry3}));
+
+    // Renamed groups are reflected in the hierarchy
+    m_searchResult = m_entrySearcher.search("group:/*/group1", db.rootGroup());
+    QCOMPARE(m_searchResult.size(), 2);
+    group->setName("renamed");
+    m_searchResult = m_entrySearcher.search("group:/*/group1", db.rootGroup());
+    QCOMPARE(m_searchResult.size(), 0);
+    m_searchResult = m_entrySearcher.search("group:/*/renamed", db.rootGroup());
+    QCOMPARE(m_searchResult.size(), 2);
+
+    delete entry2;
+    m_searchResult = m_entrySearcher.search("gitlab", db.rootGroup());
+    QCOMPARE(m_searchResult, {});
+}
+
+void TestEntrySearcher::testParallelSearch()
+{
+    Database db;
+    for (int i = 0; i < EntrySearcher::ParallelThreshold * 2; ++i) {
+        auto entry = new Entry();
+        entry->setGroup(db.rootGroup());
+        entry->setTitle(QString("entry%1").arg(i));
+        entry->setNotes(i % 3 == 0 ? "fizz" : "buzz");
+    }
+
+    const QStringList searches{"entry1", "entry1* fizz", "-notes:buzz", "*title:entry\\d{2}$"};
+    for (const auto& search : searches) {
+        m_entrySearcher.setParallel(false);
+        auto expected = m_entrySearcher.search(search, db.rootGroup());
+        m_entrySearcher.setParallel(true);
+        m_searchResult = m_entrySearcher.search(search, db.rootGroup());
+        QVERIFY(!m_searchResult.isEmpty());
+        QCOMPARE(m_searchResult, expected);
+    }
+}
+
+void TestEntrySearcher::testRefinedSearch()
+{
+    Database db;
+    auto entry1 = new Entry();
+    entry1->setGroup(db.rootGroup());
+    entry1->setTitle("GitHub");
+
+    auto entry2 = new Entry();
+    entry2->setGroup(db.rootGroup());
+    entry2->setTitle("Gitea");
+
+    auto entry3 = new Entry();
+    entry3->setGroup(db.rootGroup());
+    entry3->setTitle("Other");
+    entry3->setTags("git");
+
+    m_searchResult = m_entrySearcher.search("gi", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1, entry2}));
+
+    // Tags have to match entirely, the longer word matches the tag of entry3
+    m_searchResult = m_entrySearcher.search("git", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1, entry2, entry3}));
+
+    m_searchResult = m_entrySearcher.search("gith", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1}));
+    m_searchResult = m_entrySearcher.search("gith -title:hub", db.rootGroup());
+    QCOMPARE(m_searchResult, {});
+
+    // Changes between searches are picked up
+    entry2->setTitle("GitHost");
+    m_searchResult = m_entrySearcher.search("gith", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1, entry2}));
+
+    auto entry4 = new Entry();
+    entry4->setGroup(db.rootGroup());
+    entry4->setTitle("GitHub Enterprise");
+    m_searchResult = m_entrySearcher.search("githu", db.rootGroup());
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1, entry4}));
+}
+
+void TestEntrySearcher::testLiteralTerms()
+{
+    auto entry1 = new Entry();
+    entry1->setGroup(m_rootGroup);
+    entry1->setTitle("Foo.Bar");
+    entry1->setTags("Work");
+    entry1->setNotes("[notes]");
+
+    auto entry2 = new Entry();
+    entry2->setGroup(m_rootGroup);
+    entry2->setTitle("FooXBar");
+
+    // Plain words match literally, wildcards still apply
+    m_searchResult = m_entrySearcher.search("o.b", m_rootGroup);
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1}));
+    m_searchResult = m_entrySearcher.search("o?b", m_rootGroup);
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1, entry2}));
+    m_searchResult = m_entrySearcher.search("notes:[notes]", m_rootGroup);
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1}));
+
+    // Tags have to match entirely
+    m_searchResult = m_entrySearcher.search("tag:work", m_rootGroup);
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1}));
+    m_searchResult = m_entrySearcher.search("tag:wor", m_rootGroup);
+    QCOMPARE(m_searchResult, {});
+
+    // The evaluation order does not change the result
+    m_searchResult = m_entrySearcher.search("foo -tag:work uuid:" + entry2->uuidToHex(), m_rootGroup);
+    QCOMPARE(m_searchResult, QList<Entry*>({entry2}));
+
+    m_entrySearcher.setCaseSensitive(true);
+    m_searchResult = m_entrySearcher.search("foo", m_rootGroup);
+    QCOMPARE(m_searchResult, {});
+    m_searchResult = m_entrySearcher.search("Foo", m_rootGroup);
+    QCOMPARE(m_searchResult, QList<Entry*>({entry1, entry2}));
+}
+
+void TestEntrySearcher::testLiveSearch()
+{
+    Database db;
+    auto entry1 = new Entry();
+    entry1->setGroup(db.rootGroup());
+    entry1->setTitle("Server");
+    entry1->setTags("prod");
+
+    auto entry2 = new Entry();
+    entry2->setGroup(db.rootGroup());
+    entry2->setTitle("Staging");
+
+    auto search = LiveSearch::forQuery(&db, "tag:prod");
+    QCOMPARE(LiveSearch::forQuery(&db, "tag:prod"), search);
+    QCOMPARE(search->results(), QList<Entry*>({entry1}));
+
+    // Modified, added and moved entries are matched again
+    entry2->setTags("prod");
+    QCOMPARE(search->results(), QList<Entry*>({entry1, entry2}));
+    entry1->setTags("test");
+    QCOMPARE(search->results(), QList<Entry*>({entry2}));
+
+    auto group = new Group();
+    group->setParent(db.rootGroup());
+    auto entry3 = new Entry();
+    entry3->setGroup(group);
+    entry3->setTags("prod");
+    QCOMPARE(search->results(), QList<Entry*>({entry2, entry3}));
+
+    entry2->setGroup(group);
+    QCOMPARE(search->results(), QList<Entry*>({entry3, entry2}));
+
+    // Groups with searching disabled are skipped like in a full search
+    group->setSearchingEnabled(Group::Disable);
+    QCOMPARE(search->results(), {});
+    group->setSearchingEnabled(Group::Inherit);
+    QCOMPARE(search->results(), m_entrySearcher.search("tag:prod", db.rootGroup()));
+
+    delete entry3;
+    QCOMPARE(search->results(), QList<Entry*>({entry2}));
+}
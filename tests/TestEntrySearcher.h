@@ -28,6 +28,7 @@ class TestEntrySearcher : public QObject
     Q_OBJECT
 
 private slots:
+    void initTestCase();
     void init();
     void cleanup();
 
@@ -39,6 +40,11 @@ private slots:
     void testGroup();
     void testSkipProtected();
     void testUUIDSearch();
+    void testSearchIndex();
+    void testParallelSearch();
+    void testRefinedSearch();
+    void testLiteralTerms();
+    void testLiveSearch();
 
 private:
     Group* m_rootGroup;
@@ -31,6 +31,24 @@ void TestFdoSecrets::testDhIetf1024Sha256Aes128CbcPkcs7()
 {
     FdoSecrets::DhIetf1024Sha256Aes128CbcPkcs7 cipher(randomGen()->randomArray(128));
     QVERIFY(cipher.isValid());
+
+    // Secrets encrypted in one batch use their own IV and decrypt individually
+    QList<FdoSecrets::Secret> secrets;
+    for (const auto& value : {QByteArray("first"), QByteArray(), QByteArray(100, 'x')}) {
+        FdoSecrets::Secret secret{};
+        secret.value = value;
+        secret.contentType = "text/plain";
+        secrets << secret;
+    }
+    const auto encrypted = cipher.encrypt(secrets);
+    QCOMPARE(encrypted.size(), secrets.size());
+    QVERIFY(encrypted.at(0).parameters != encrypted.at(1).parameters);
+    for (int i = 0; i < secrets.size(); ++i) {
+        QVERIFY(encrypted.at(i).value != secrets.at(i).value);
+        const auto decrypted = cipher.decrypt(encrypted.at(i));
+        QCOMPARE(decrypted.value, secrets.at(i).value);
+        QCOMPARE(decrypted.contentType, secrets.at(i).contentType);
+    }
 }
 
 void TestFdoSecrets::testCrazyAttributeKey()
@@ -422,6 +422,38 @@ void TestGroup::testClone()
             != originalGroup->timeInfo().lastModificationTime());
 }
 
+void TestGroup::testCloneEntries()
+{
+    Database db;
+    auto* group = new Group();
+    group->setParent(db.rootGroup());
+
+    auto* target = new Entry();
+    target->setGroup(group);
+    target->setPassword("secret");
+    auto* outside = new Entry();
+    outside->setGroup(db.rootGroup());
+    outside->setPassword("other");
+    auto* source = new Entry();
+    source->setGroup(db.rootGroup());
+    source->setPassword("{REF:P@I:" + target->uuidToHex() + "}");
+    source->setNotes("{REF:P@I:" + outside->uuidToHex() + "}");
+
+    const auto clones = Group::cloneEntries({target, source});
+    QCOMPARE(clones.size(), 2);
+    QCOMPARE(clones.at(0)->group(), group);
+    QCOMPARE(clones.at(1)->group(), db.rootGroup());
+
+    // References between the selected entries point at the clones, others are kept
+    QCOMPARE(clones.at(1)->password(), QString("{REF:P@I:%1}").arg(clones.at(0)->uuidToHex().toUpper()));
+    QCOMPARE(clones.at(1)->notes(), source->notes());
+    QCOMPARE(clones.at(1)->resolveMultiplePlaceholders(clones.at(1)->password()), QString("secret"));
+
+    // References to the originals added by the flags are not rewritten
+    const auto refClones = Group::cloneEntries({target}, Entry::CloneDefault | Entry::ClonePassAsRef);
+    QCOMPARE(refClones.first()->password(), QString("{REF:P@I:%1}").arg(target->uuidToHex().toUpper()));
+}
+
 void TestGroup::testCopyCustomIcons()
 {
     QScopedPointer<Database> dbSource(new Database());
@@ -988,6 +1020,11 @@ void TestGroup::testChildrenSort()
     QCOMPARE(children[6]->name(), QString("sub_45p"));
     QCOMPARE(children[7]->name(), QString("sub_010"));
     QCOMPARE(children[8]->name(), QString("sub_000"));
+
+    // Sorting a sorted tree leaves the groups unmodified
+    QSignalSpy spyModified(subParent, SIGNAL(modified()));
+    subParent->sortChildrenRecursively(true);
+    QCOMPARE(spyModified.count(), 0);
     delete parent;
 }
 
@@ -1021,6 +1058,40 @@ void TestGroup::testHierarchy()
     QVERIFY(hierarchy.size() == 2);
     QVERIFY(hierarchy.contains("group2"));
     QVERIFY(hierarchy.contains("group3"));
+
+    // Cached paths follow renames and moves of parent groups
+    QCOMPARE(group3->fullPath(), QString("/group1/group2/group3"));
+    group2->setName("renamed");
+    QCOMPARE(group3->fullPath(), QString("/group1/renamed/group3"));
+    QCOMPARE(group3->hierarchy(), QStringList({"group1", "renamed", "group3"}));
+    group3->setParent(&group1);
+    QCOMPARE(group3->fullPath(), QString("/group1/group3"));
+    QCOMPARE(group3->hierarchy(), QStringList({"group1", "group3"}));
+}
+
+void TestGroup::testIsRecycled()
+{
+    Database db;
+    auto group = new Group();
+    group->setParent(db.rootGroup());
+    auto child = new Group();
+    child->setParent(group);
+    QVERIFY(!child->isRecycled());
+
+    db.recycleGroup(group);
+    QVERIFY(group->isRecycled());
+    QVERIFY(child->isRecycled());
+
+    child->setParent(db.rootGroup());
+    QVERIFY(!child->isRecycled());
+    QVERIFY(group->isRecycled());
+
+    // Changing the recycle bin is picked up without any group changing
+    db.metadata()->setRecycleBin(child);
+    QVERIFY(child->isRecycled());
+    QVERIFY(!group->isRecycled());
+    db.metadata()->setRecycleBin(nullptr);
+    QVERIFY(!child->isRecycled());
 }
 
 void TestGroup::testApplyGroupIconRecursively()
@@ -1146,6 +1217,56 @@ void TestGroup::testUsernamesRecursive()
     QVERIFY(usernames.indexOf("Name2") < usernames.indexOf("Name1"));
 }
 
+void TestGroup::testForEachRecursive()
+{
+    Database database;
+    auto root = database.rootGroup();
+
+    auto group1 = new Group();
+    group1->setParent(root);
+    auto group2 = new Group();
+    group2->setParent(group1);
+    auto group3 = new Group();
+    group3->setParent(root);
+
+    auto entry1 = root->addEntryWithPath("Entry1");
+    auto entry2 = group2->addEntryWithPath("Entry2");
+    auto entry3 = group3->addEntryWithPath("Entry3");
+    entry1->addHistoryItem(entry1->clone(Entry::CloneNoFlags));
+    auto entry4 = new Entry();
+    entry4->setGroup(group1);
+
+    QList<const Group*> groups;
+    QVERIFY(root->forEachGroupRecursive([&groups](const Group* group) {
+        groups.append(group);
+        return true;
+    }));
+    QCOMPARE(groups, asConst(*root).groupsRecursive(true));
+
+    QList<Entry*> entries;
+    QVERIFY(root->forEachEntryRecursive(
+        [&entries](Entry* entry) {
+            entries.append(entry);
+            return true;
+        },
+        true));
+    QCOMPARE(entries, root->entriesRecursive(true));
+    QCOMPARE(entries.size(), 5);
+
+    // Returning false stops the traversal right away
+    entries.clear();
+    QVERIFY(!root->forEachEntryRecursive([&entries, entry4](Entry* entry) {
+        entries.append(entry);
+        return entry != entry4;
+    }));
+    QCOMPARE(entries, QList<Entry*>({entry1, entry4}));
+
+    QCOMPARE(root->findEntryByUuid(entry2->uuid()), entry2);
+    QCOMPARE(root->findEntryByUuid(entry3->uuid(), false), static_cast<Entry*>(nullptr));
+    QCOMPARE(root->findGroupByUuid(group2->uuid()), group2);
+    QCOMPARE(group3->findGroupByUuid(group2->uuid()), static_cast<Group*>(nullptr));
+}
+
 void TestGroup::testMoveUpDown()
 {
     Database database;
@@ -1319,3 +1440,46 @@ void TestGroup::testAutoTypeState()
     QVERIFY(!entry1->groupAutoTypeEnabled());
     QVERIFY(entry2->groupAutoTypeEnabled());
 }
+
+void TestGroup::testInheritedProperties()
+{
+    Database db;
+    auto* root = db.rootGroup();
+
+    auto* group1 = new Group();
+    group1->setParent(root);
+    auto* group2 = new Group();
+    group2->setParent(group1);
+    auto* group3 = new Group();
+    group3->setParent(group2);
+
+    const QString key("TestKey");
+    QCOMPARE(group3->resolveCustomDataTriState(key), Group::Inherit);
+    QVERIFY(group3->resolveSearchingEnabled());
+
+    // Changes to any ancestor are seen by cached descendants
+    group1->customData()->set(key, TRUE_STR);
+    group1->setSearchingEnabled(Group::Disable);
+    QCOMPARE(group3->resolveCustomDataTriState(key), Group::Enable);
+    QCOMPARE(group3->resolveCustomDataString(key), TRUE_STR);
+    QCOMPARE(group3->resolveCustomDataTriState(key, false), Group::Inherit);
+    QVERIFY(!group3->resolveSearchingEnabled());
+
+    group1->customData()->set(key, FALSE_STR);
+    group2->setSearchingEnabled(Group::Enable);
+    QCOMPARE(group3->resolveCustomDataTriState(key), Group::Disable);
+    QVERIFY(group3->resolveSearchingEnabled());
+
+    group2->customData()->set(key, TRUE_STR);
+    QCOMPARE(group3->resolveCustomDataTriState(key), Group::Enable);
+    group2->customData()->remove(key);
+    QCOMPARE(group3->resolveCustomDataTriState(key), Group::Disable);
+
+    // Moving a group changes what it inherits
+    group3->setParent(root);
+    QCOMPARE(group3->resolveCustomDataTriState(key), Group::Inherit);
+    QVERIFY(group3->resolveSearchingEnabled());
+    group3->setParent(group1);
+    QCOMPARE(group3->resolveCustomDataTriState(key), Group::Disable);
+    QVERIFY(!group3->resolveSearchingEnabled());
+}
@@ -35,6 +35,7 @@ private slots:
     void testDeleteSignals();
     void testCopyCustomIcon();
     void testClone();
+    void testCloneEntries();
     void testCopyCustomIcons();
     void testFindEntry();
     void testFindGroupByPath();
@@ -45,11 +46,14 @@ private slots:
     void testEquals();
     void testChildrenSort();
     void testHierarchy();
+    void testIsRecycled();
     void testApplyGroupIconRecursively();
     void testUsernamesRecursive();
+    void testForEachRecursive();
     void testMoveUpDown();
     void testPreviousParentGroup();
     void testAutoTypeState();
+    void testInheritedProperties();
 };
 
 #endif // KEEPASSX_TESTGROUP_H
@@ -149,3 +149,43 @@ void TestGroupModel::test()
     delete modelTest;
     delete model;
 }
+
+void TestGroupModel::testCachedRows()
+{
+    QScopedPointer<Database> db(new Database());
+    Group* root = db->rootGroup();
+
+    QList<Group*> groups;
+    for (int i = 0; i < 5; ++i) {
+        auto group = new Group();
+        group->setName(QString("group%1").arg(i));
+        group->setParent(root);
+        groups.append(group);
+    }
+
+    GroupModel model(db.data());
+    QModelIndex rootIndex = model.index(0, 0);
+    for (int i = 0; i < groups.size(); ++i) {
+        QCOMPARE(model.index(groups.at(i)).row(), i);
+        QCOMPARE(model.parent(model.index(i, 0, rootIndex)), rootIndex);
+    }
+
+    // Rows change with every move, add and removal
+    groups.at(0)->setParent(root, 3);
+    QCOMPARE(model.index(groups.at(0)).row(), 3);
+    QCOMPARE(model.index(groups.at(1)).row(), 0);
+    QCOMPARE(model.index(groups.at(4)).row(), 4);
+
+    delete groups.at(2);
+    QCOMPARE(model.index(groups.at(0)).row(), 2);
+    QCOMPARE(model.index(groups.at(4)).row(), 3);
+
+    groups.at(4)->setParent(groups.at(1));
+    QCOMPARE(model.index(groups.at(4)).row(), 0);
+    QCOMPARE(model.parent(model.index(groups.at(4))), model.index(groups.at(1)));
+
+    // Display data follows modifications of the group
+    QCOMPARE(model.data(model.index(groups.at(3))).toString(), QString("group3"));
+    groups.at(3)->setName("renamed");
+    QCOMPARE(model.data(model.index(groups.at(3))).toString(), QString("renamed"));
+}
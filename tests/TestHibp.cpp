@@ -23,6 +23,7 @@
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QCryptographicHash>
 #include <QList>
 #include <QTest>
 
@@ -118,3 +119,84 @@ void TestHibp::testPwned()
     QCOMPARE(findings[1].first, entry4);
     QCOMPARE(findings[1].second, 456);
 }
+
+void TestHibp::testLargeFile()
+{
+    // Spans several read blocks, so records are split at block boundaries
+    QByteArray hibpContents;
+    for (int i = 0; i < 60000; ++i) {
+        hibpContents.append(QCryptographicHash::hash(QByteArray::number(i), QCryptographicHash::Sha1).toHex());
+        hibpContents.append(":").append(QByteArray::number(i)).append("\r\n");
+    }
+    hibpContents.append("\n0BEEC7B5EA3F0FDBC95D0DD47F3C5BC275DA8A33:123");
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    auto entry1 = new Entry();
+    entry1->setPassword("foo");
+    entry1->setGroup(m_db->rootGroup());
+
+    auto entry2 = new Entry();
+    entry2->setPassword("12345");
+    entry2->setGroup(m_db->rootGroup());
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY(HibpOffline::report(m_db, hibpBuffer, findings, &error));
+    QCOMPARE(error, QString());
+    QCOMPARE(findings.size(), 2);
+    QCOMPARE(findings[0].first, entry2);
+    QCOMPARE(findings[0].second, 12345);
+    QCOMPARE(findings[1].first, entry1);
+    QCOMPARE(findings[1].second, 123);
+}
+
+void TestHibp::testConvert()
+{
+    QByteArray hibpContents(TEST_HIBP_CONTENTS);
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    QByteArray converted;
+    QBuffer convertedBuffer(&converted);
+    QVERIFY(convertedBuffer.open(QIODevice::WriteOnly));
+    QString error;
+    QVERIFY(HibpOffline::convert(hibpBuffer, convertedBuffer, &error));
+    QCOMPARE(error, QString());
+    convertedBuffer.close();
+
+    Group* root = m_db->rootGroup();
+
+    auto entry1 = new Entry();
+    entry1->setPassword("bar");
+    entry1->setGroup(root);
+
+    auto entry2 = new Entry();
+    entry2->setPassword("xyz");
+    entry2->setGroup(root);
+
+    auto entry3 = new Entry();
+    entry3->setPassword("foo");
+    entry3->setGroup(root);
+
+    QVERIFY(convertedBuffer.open(QIODevice::ReadOnly));
+    QVERIFY(HibpOffline::isBinaryFormat(convertedBuffer));
+    QList<QPair<const Entry*, int>> findings;
+    QVERIFY(HibpOffline::report(m_db, convertedBuffer, findings, &error));
+    QCOMPARE(error, QString());
+    QCOMPARE(findings.size(), 2);
+    QCOMPARE(findings[0].first, entry3);
+    QCOMPARE(findings[0].second, 123);
+    QCOMPARE(findings[1].first, entry1);
+    QCOMPARE(findings[1].second, 456);
+
+    // Hashes have to be sorted to be binary searched
+    QByteArray unsortedContents("62cdb7020ff920e5aa642c3d4066950dd1f01f4d:456\n"
+                                "0BEEC7B5EA3F0FDBC95D0DD47F3C5BC275DA8A33:123\n");
+    QBuffer unsortedBuffer(&unsortedContents);
+    QVERIFY(unsortedBuffer.open(QIODevice::ReadOnly));
+    QBuffer output;
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    QVERIFY(!HibpOffline::convert(unsortedBuffer, output, &error));
+    QVERIFY(!error.isEmpty());
+}
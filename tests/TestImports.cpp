@@ -23,9 +23,13 @@
 #include "core/Totp.h"
 #include "crypto/Crypto.h"
 #include "format/BitwardenReader.h"
+#include "format/JsonStreamReader.h"
 #include "format/OPUXReader.h"
 #include "format/OpVaultReader.h"
 
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QList>
 #include <QTest>
@@ -315,3 +319,53 @@ void TestImports::testBitwardenPasskey()
     QCOMPARE(attr->value(EntryAttributes::KPEX_PASSKEY_USER_HANDLE),
              QStringLiteral("aTFtdmFnOHYtS2dxVEJ0by1rSFpLWGg0enlTVC1iUVJReDZ5czJXa3c2aw"));
 }
+
+void TestImports::testJsonStreamReader()
+{
+    // Escapes, surrogate pairs and multibyte characters split across the first block
+    QByteArray padding(JsonStreamReader::BlockSize - 30, 'x');
+    QByteArray json = "{\"padding\": \"" + padding + "\", \"text\": \"a\\\"b\\\\c\\n\\u00e9\\ud83d\\ude00"
+                      "\xe2\x82\xac\", \"items\": [1, -2.5e3, true, false, null, {\"nested\": [[]]}], \"end\": {}}\n";
+
+    QBuffer buffer(&json);
+    buffer.open(QIODevice::ReadOnly);
+    JsonStreamReader reader(&buffer);
+    QList<int> percents;
+    reader.setProgressCallback([&percents](int percent) { percents << percent; }, json.size());
+    QCOMPARE(reader.readValue().toObject(), QJsonDocument::fromJson(json).object());
+    QVERIFY(reader.finish());
+    QCOMPARE(percents.last(), 100);
+
+    // Walk the members one at a time
+    buffer.seek(0);
+    JsonStreamReader walker(&buffer);
+    QStringList keys;
+    QJsonArray items;
+    QString key;
+    QVERIFY(walker.enterObject());
+    while (walker.nextMember(key)) {
+        keys << key;
+        if (key == "items") {
+            QVERIFY(walker.enterArray());
+            while (walker.nextElement()) {
+                items.append(walker.readValue());
+            }
+        } else {
+            QVERIFY(walker.skipValue());
+        }
+    }
+    QVERIFY2(walker.finish(), qPrintable(walker.errorString()));
+    QCOMPARE(keys, QStringList({"padding", "text", "items", "end"}));
+    QCOMPARE(items, QJsonDocument::fromJson(json).object().value("items").toArray());
+
+    // Truncated and malformed documents
+    for (const QByteArray& invalid : {QByteArray("{\"a\": [1, 2"), QByteArray("[1,]"), QByteArray("{} x")}) {
+        QByteArray data = invalid;
+        QBuffer invalidBuffer(&data);
+        invalidBuffer.open(QIODevice::ReadOnly);
+        JsonStreamReader invalidReader(&invalidBuffer);
+        invalidReader.readValue();
+        QVERIFY(!invalidReader.finish());
+        QVERIFY(invalidReader.hasError());
+    }
+}
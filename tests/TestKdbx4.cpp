@@ -19,16 +19,22 @@
 
 #include "config-keepassx-tests.h"
 #include "core/Metadata.h"
+#include "crypto/Random.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KdbxXmlWriter.h"
 #include "format/KeePass2.h"
+#include "format/KeePass2RandomStream.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
+#include "format/XmlStreamWriter.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
 #include "mock/MockChallengeResponseKey.h"
 #include "mock/MockClock.h"
+#include "util/TemporaryFile.h"
+#include <QFileInfo>
 #include <QTest>
+#include <QXmlStreamWriter>
 
 int main(int argc, char* argv[])
 {
@@ -114,6 +120,7 @@ void TestKdbx4AesKdf::initTestCaseImpl()
 }
 
 Q_DECLARE_METATYPE(QUuid)
+Q_DECLARE_METATYPE(Database::CompressionAlgorithm)
 
 void TestKdbx4Format::init()
 {
@@ -513,6 +520,293 @@ void TestKdbx4Format::testAttachmentIndexStability()
     QCOMPARE(a3->value("y"), attachment3);
 }
 
+void TestKdbx4Format::testLargePayload()
+{
+    QFETCH(Database::CompressionAlgorithm, compression);
+    QFETCH(int, compressionLevel);
+
+    // Payloads spanning several HMAC blocks are decrypted through the read-ahead pipeline
+    QScopedPointer<Database> db(new Database());
+    db->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2ID)));
+    db->setKey(QSharedPointer<CompositeKey>::create());
+    db->setCompressionAlgorithm(compression);
+    db->metadata()->setCompressionLevel(compressionLevel);
+
+    QList<QUuid> uuids;
+    QList<QByteArray> attachments;
+    QList<QByteArray> texts;
+    for (int i = 0; i < 4; ++i) {
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setTitle(QString("Entry %1").arg(i));
+        auto attachment = randomGen()->randomArray(1024 * 1024);
+        entry->attachments()->set("blob", attachment);
+        // Automatic compression stores the random data and compresses the text best
+        auto text = QByteArray("Lorem ipsum dolor sit amet ").repeated((i + 1) * 8192);
+        entry->attachments()->set("text", text);
+        entry->setGroup(db->rootGroup());
+        uuids.append(entry->uuid());
+        attachments.append(attachment);
+        texts.append(text);
+    }
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    KeePass2Writer writer;
+    QVERIFY(writer.writeDatabase(&buffer, db.data()));
+    QVERIFY(buffer.size() > 3 * 1024 * 1024);
+
+    buffer.seek(0);
+    KeePass2Reader reader;
+    auto db2 = QSharedPointer<Database>::create();
+    reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), db2.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+
+    for (int i = 0; i < uuids.size(); ++i) {
+        auto entry = db2->rootGroup()->findEntryByUuid(uuids.at(i));
+        QVERIFY(entry);
+        QCOMPARE(entry->title(), QString("Entry %1").arg(i));
+        QCOMPARE(entry->attachments()->value("blob"), attachments.at(i));
+        QCOMPARE(entry->attachments()->value("text"), texts.at(i));
+    }
+
+    // Corrupting a block in the middle of the payload must still be detected
+    buffer.buffer()[buffer.size() / 2] = ~buffer.buffer().at(buffer.size() / 2);
+    buffer.seek(0);
+    KeePass2Reader corruptReader;
+    auto db3 = QSharedPointer<Database>::create();
+    corruptReader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), db3.data());
+    QVERIFY(corruptReader.hasError());
+}
+
+void TestKdbx4Format::testLargePayload_data()
+{
+    QTest::addColumn<Database::CompressionAlgorithm>("compression");
+    QTest::addColumn<int>("compressionLevel");
+    QTest::newRow("uncompressed") << Database::CompressionNone << Metadata::AutoCompressionLevel;
+    QTest::newRow("gzip auto") << Database::CompressionGZip << Metadata::AutoCompressionLevel;
+    QTest::newRow("gzip fastest") << Database::CompressionGZip << 1;
+    QTest::newRow("gzip smallest") << Database::CompressionGZip << 9;
+}
+
+void TestKdbx4Format::testBlockSize()
+{
+    QScopedPointer<Database> db(new Database());
+    db->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2ID)));
+    db->setKey(QSharedPointer<CompositeKey>::create());
+    db->setCompressionAlgorithm(Database::CompressionNone);
+
+    auto entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    auto attachment = randomGen()->randomArray(256 * 1024);
+    entry->attachments()->set("blob", attachment);
+    entry->setGroup(db->rootGroup());
+
+    QBuffer defaultBuffer;
+    defaultBuffer.open(QBuffer::ReadWrite);
+    KeePass2Writer defaultWriter;
+    QVERIFY(defaultWriter.writeDatabase(&defaultBuffer, db.data()));
+
+    // Every block records its size, the reader does not need to know it in advance
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    KeePass2Writer writer;
+    writer.setBlockSize(4096);
+    QVERIFY(writer.writeDatabase(&buffer, db.data()));
+    QVERIFY(buffer.size() >= defaultBuffer.size() + (256 / 4 - 1) * (32 + 4));
+
+    buffer.seek(0);
+    KeePass2Reader reader;
+    auto db2 = QSharedPointer<Database>::create();
+    reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), db2.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    QCOMPARE(db2->rootGroup()->findEntryByUuid(entry->uuid())->attachments()->value("blob"), attachment);
+}
+
+void TestKdbx4Format::testChallengeResponseSeed()
+{
+    QScopedPointer<Database> db(new Database());
+    db->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2ID)));
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("test"));
+    key->addChallengeResponseKey(QSharedPointer<MockChallengeResponseKey>::create(QByteArray("secret")));
+    db->setKey(key);
+
+    // The seed answered by the challenge-response key is kept between saves
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    KeePass2Writer writer;
+    QVERIFY(writer.writeDatabase(&buffer, db.data()));
+    const auto seed = db->kdf()->seed();
+    QVERIFY(key->isChallengeAnswered(seed));
+    buffer.seek(0);
+    QVERIFY(writer.writeDatabase(&buffer, db.data()));
+    QCOMPARE(db->kdf()->seed(), seed);
+
+    buffer.seek(0);
+    KeePass2Reader reader;
+    auto db2 = QSharedPointer<Database>::create();
+    reader.readDatabase(&buffer, key, db2.data());
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    QCOMPARE(db2->kdf()->seed(), seed);
+
+    // Without challenge-response keys every save gets a new seed
+    auto passwordKey = QSharedPointer<CompositeKey>::create();
+    passwordKey->addKey(QSharedPointer<PasswordKey>::create("test"));
+    db->setKey(passwordKey);
+    buffer.seek(0);
+    QVERIFY(writer.writeDatabase(&buffer, db.data()));
+    QVERIFY(db->kdf()->seed() != seed);
+}
+
+void TestKdbx4Format::testDeferredAttachments()
+{
+    auto db = QSharedPointer<Database>::create();
+    db->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2ID)));
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("test"));
+    db->setKey(key);
+
+    auto attachment1 = randomGen()->randomArray(4096);
+    auto attachment2 = QByteArray("second");
+
+    auto entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->attachments()->set("a", attachment1);
+    entry->attachments()->set("b", attachment2);
+    entry->setGroup(db->rootGroup());
+    auto uuid = entry->uuid();
+
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+
+    QString error;
+    QVERIFY2(db->saveAs(tempFile.fileName(), Database::Atomic, {}, &error), qPrintable(error));
+
+    auto db2 = QSharedPointer<Database>::create();
+    QVERIFY2(db2->open(tempFile.fileName(), key, &error, Database::DeferAttachments), qPrintable(error));
+
+    auto attachments = db2->rootGroup()->findEntryByUuid(uuid)->attachments();
+    QCOMPARE(attachments->keys().size(), 2);
+    QVERIFY(attachments->isDeferred("a"));
+    QVERIFY(attachments->isDeferred("b"));
+    QCOMPARE(attachments->attachmentsSize(), 2 + attachment1.size() + attachment2.size());
+
+    QCOMPARE(attachments->value("b"), attachment2);
+    QVERIFY(!attachments->isDeferred("b"));
+    QVERIFY(attachments->isDeferred("a"));
+
+    // Saving reads the remaining deferred attachments before the file is replaced
+    QVERIFY2(db2->save(Database::Atomic, {}, &error), qPrintable(error));
+    QVERIFY(!attachments->isDeferred("a"));
+    QCOMPARE(attachments->value("a"), attachment1);
+
+    auto db3 = QSharedPointer<Database>::create();
+    QVERIFY2(db3->open(tempFile.fileName(), key, &error), qPrintable(error));
+    auto reloaded = db3->rootGroup()->findEntryByUuid(uuid)->attachments();
+    QVERIFY(!reloaded->isDeferred("a"));
+    QCOMPARE(reloaded->value("a"), attachment1);
+    QCOMPARE(reloaded->value("b"), attachment2);
+}
+
+void TestKdbx4Format::testDeferredAttachmentsChangedOnDisk()
+{
+    auto db = QSharedPointer<Database>::create();
+    db->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2ID)));
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("test"));
+    db->setKey(key);
+
+    auto entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->attachments()->set("a", randomGen()->randomArray(4096));
+    entry->setGroup(db->rootGroup());
+    auto uuid = entry->uuid();
+
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+
+    QString error;
+    QVERIFY2(db->saveAs(tempFile.fileName(), Database::Atomic, {}, &error), qPrintable(error));
+
+    auto db2 = QSharedPointer<Database>::create();
+    QVERIFY2(db2->open(tempFile.fileName(), key, &error, Database::DeferAttachments), qPrintable(error));
+    auto attachments = db2->rootGroup()->findEntryByUuid(uuid)->attachments();
+    QVERIFY(attachments->isDeferred("a"));
+
+    // The attachment data is cut off after the database was opened
+    QFile file(tempFile.fileName());
+    const auto truncatedSize = file.size() / 2;
+    QVERIFY(file.resize(truncatedSize));
+
+    QBuffer output;
+    output.open(QIODevice::WriteOnly);
+    QVERIFY(!attachments->writeTo("a", &output, &error));
+    QVERIFY(!error.isEmpty());
+    QVERIFY(output.data().isEmpty());
+
+    // Neither saving nor extracting may replace the attachment with an empty one
+    error.clear();
+    QVERIFY(!db2->save(Database::Atomic, {}, &error));
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(QFileInfo(tempFile.fileName()).size(), truncatedSize);
+    QVERIFY(attachments->isDeferred("a"));
+
+    error.clear();
+    QByteArray xml;
+    QVERIFY(!db2->extract(xml, &error));
+    QVERIFY(!error.isEmpty());
+    QVERIFY(!attachments->loadDeferred());
+}
+
+void TestKdbx4Format::testReadOnlyOpen()
+{
+    auto db = QSharedPointer<Database>::create();
+    db->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2ID)));
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("test"));
+    db->setKey(key);
+
+    auto entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setTitle("old title");
+    entry->attachments()->set("a", QByteArray("attachment"));
+    entry->addHistoryItem(entry->clone(Entry::CloneNoFlags));
+    entry->setTitle("title");
+    entry->setGroup(db->rootGroup());
+    auto uuid = entry->uuid();
+
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+
+    QString error;
+    QVERIFY2(db->saveAs(tempFile.fileName(), Database::Atomic, {}, &error), qPrintable(error));
+
+    auto db2 = QSharedPointer<Database>::create();
+    QVERIFY2(db2->open(tempFile.fileName(), key, &error, Database::ReadOnly), qPrintable(error));
+    QVERIFY(db2->isReadOnly());
+
+    // Lookups see the current entries, without their history
+    auto readEntry = db2->rootGroup()->findEntryByUuid(uuid);
+    QVERIFY(readEntry);
+    QCOMPARE(readEntry->title(), QString("title"));
+    QVERIFY(readEntry->historyItems().isEmpty());
+    QVERIFY(readEntry->attachments()->isDeferred("a"));
+    QCOMPARE(readEntry->attachments()->value("a"), QByteArray("attachment"));
+
+    // Saving would drop the history that was left out
+    QVERIFY(!db2->save(Database::Atomic, {}, &error));
+    QVERIFY(!db2->saveToJournal(&error));
+
+    auto db3 = QSharedPointer<Database>::create();
+    QVERIFY2(db3->open(tempFile.fileName(), key, &error), qPrintable(error));
+    QVERIFY(!db3->isReadOnly());
+    QCOMPARE(db3->rootGroup()->findEntryByUuid(uuid)->historyItems().size(), 1);
+}
+
 void TestKdbx4Format::testCustomData()
 {
     Database db;
@@ -606,3 +900,130 @@ void TestKdbx4Format::testCustomData()
     QCOMPARE(newEntry->customData()->value(customDataKey1), customData1);
     QCOMPARE(newEntry->customData()->value(customDataKey2), customData2);
 }
+
+void TestKdbx4Format::testReadPublicCustomData()
+{
+    auto db = QSharedPointer<Database>::create();
+    db->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2ID)));
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("test"));
+    db->setKey(key);
+    db->setPublicName("Public");
+    db->setPublicIcon(3);
+
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+    QString error;
+    QVERIFY2(db->saveAs(tempFile.fileName(), Database::Atomic, {}, &error), qPrintable(error));
+
+    KeePass2Reader reader;
+    QVariantMap publicCustomData;
+    QVERIFY2(reader.readPublicCustomData(tempFile.fileName(), publicCustomData), qPrintable(reader.errorString()));
+    QCOMPARE(publicCustomData, db->publicCustomData());
+
+    // A changed file is read again
+    db->setPublicName("Renamed");
+    QVERIFY2(db->saveAs(tempFile.fileName(), Database::Atomic, {}, &error), qPrintable(error));
+    QVERIFY(reader.readPublicCustomData(tempFile.fileName(), publicCustomData));
+    QCOMPARE(publicCustomData.value("KPXC_PUBLIC_NAME").toString(), QString("Renamed"));
+
+    QFile file(tempFile.fileName());
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("not a database");
+    file.close();
+    QVERIFY(!reader.readPublicCustomData(tempFile.fileName(), publicCustomData));
+}
+
+void TestKdbx4Format::testXmlStreamWriter()
+{
+    // The KDBX XML writer must produce exactly what QXmlStreamWriter did before
+    QString text = QString::fromUtf8("a<b>&\"c\" \xc3\xa4\xe2\x82\xac\xf0\x9f\x94\x91\ttab\nline\r\nwindows\rmac");
+
+    QBuffer expected;
+    expected.open(QBuffer::WriteOnly);
+    QXmlStreamWriter qtWriter(&expected);
+    qtWriter.setAutoFormatting(true);
+    qtWriter.setAutoFormattingIndent(-1);
+    qtWriter.setCodec("UTF-8");
+    qtWriter.writeStartDocument("1.0", true);
+    qtWriter.writeStartElement("KeePassFile");
+    qtWriter.writeStartElement("Meta");
+    qtWriter.writeTextElement("Generator", text);
+    qtWriter.writeEmptyElement("Empty");
+    qtWriter.writeStartElement("Value");
+    qtWriter.writeAttribute("Ref", "12");
+    qtWriter.writeEndElement();
+    qtWriter.writeStartElement("Value");
+    qtWriter.writeAttribute("Protected", "True");
+    qtWriter.writeCharacters(QByteArray("secret").toBase64());
+    qtWriter.writeEndElement();
+    qtWriter.writeTextElement("Number", "-42");
+    qtWriter.writeEndElement();
+    qtWriter.writeStartElement("Root");
+    qtWriter.writeEndDocument();
+
+    QBuffer actual;
+    actual.open(QBuffer::WriteOnly);
+    XmlStreamWriter writer;
+    writer.setDevice(&actual);
+    writer.writeStartDocument();
+    writer.writeStartElement("KeePassFile");
+    writer.writeStartElement("Meta");
+    writer.writeStartElement("Generator");
+    writer.writeCharacters(text);
+    writer.writeEndElement();
+    writer.writeEmptyElement("Empty");
+    writer.writeStartElement("Value");
+    writer.writeAttribute("Ref", 12);
+    writer.writeEndElement();
+    writer.writeStartElement("Value");
+    writer.writeAttribute("Protected", "True");
+    writer.writeBase64(QByteArray("secret"));
+    writer.writeEndElement();
+    writer.writeStartElement("Number");
+    writer.writeNumber(-42);
+    writer.writeEndElement();
+    writer.writeEndElement();
+    writer.writeStartElement("Root");
+    writer.writeEndDocument();
+    QVERIFY(!writer.hasError());
+
+    QCOMPARE(actual.data(), expected.data());
+}
+
+void TestKdbx4Format::benchmarkWriteXml()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    Database db;
+    auto group = new Group();
+    group->setUuid(QUuid::createUuid());
+    group->setParent(db.rootGroup());
+    for (int i = 0; i < 100000; ++i) {
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setUsername(QString("user%1@example.com").arg(i));
+        entry->setPassword(QString("password %1").arg(i));
+        entry->setUrl(QString("https://example.com/%1").arg(i));
+        entry->setNotes("Some notes & <markup>");
+        entry->setGroup(group);
+    }
+
+    KeePass2RandomStream randomStream;
+    QVERIFY(randomStream.init(SymmetricCipher::ChaCha20, QByteArray(64, '\x01')));
+
+    QBENCHMARK
+    {
+        QBuffer buffer;
+        buffer.open(QBuffer::WriteOnly);
+        KdbxXmlWriter writer(KeePass2::FILE_VERSION_4);
+        writer.writeDatabase(&buffer, &db, &randomStream);
+        QVERIFY(!writer.hasError());
+    };
+}
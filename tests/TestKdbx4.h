@@ -65,7 +65,17 @@ private slots:
     void testUpgradeMasterKeyIntegrity();
     void testUpgradeMasterKeyIntegrity_data();
     void testAttachmentIndexStability();
+    void testLargePayload();
+    void testLargePayload_data();
+    void testBlockSize();
+    void testChallengeResponseSeed();
+    void testDeferredAttachments();
+    void testDeferredAttachmentsChangedOnDisk();
+    void testReadOnlyOpen();
     void testCustomData();
+    void testReadPublicCustomData();
+    void testXmlStreamWriter();
+    void benchmarkWriteXml();
 };
 
 #endif // KEEPASSXC_TEST_KDBX4_H
@@ -318,6 +318,9 @@ void TestKeePass2Format::testXmlEntryHistory()
         QCOMPARE(entry->title(), QString("Sample Entry 1"));
         QCOMPARE(entry->url(), QString("http://www.somesite.com/"));
     }
+
+    // Identical values of history items are read into shared strings
+    QVERIFY(entryMain->historyItems().at(0)->url().isSharedWith(entryMain->historyItems().at(1)->url()));
 }
 
 void TestKeePass2Format::testXmlDeletedObjects()
@@ -19,6 +19,7 @@
 #include "TestKeys.h"
 
 #include <QBuffer>
+#include <QTemporaryFile>
 #include <QTest>
 
 #include "config-keepassx-tests.h"
@@ -33,6 +34,7 @@
 #include "keys/CompositeKey.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
+#include "keys/TransformedKeyCache.h"
 #include "mock/MockChallengeResponseKey.h"
 
 QTEST_GUILESS_MAIN(TestKeys)
@@ -200,6 +202,31 @@ void TestKeys::testFileKeyHash()
     fileKey.load(&keyBuffer);
 
     QCOMPARE(fileKey.rawKey(), cryptoHash.result());
+
+    // Large binary key files are hashed in blocks, files from a memory mapping
+    QBuffer largeBuffer;
+    largeBuffer.open(QBuffer::ReadWrite);
+    FileKey::createRandom(&largeBuffer, 3 * 1024 * 1024 + 17);
+    largeBuffer.buffer()[0] = '\0';
+
+    CryptoHash largeHash(CryptoHash::Sha256);
+    largeHash.addData(largeBuffer.data());
+    const auto expected = largeHash.result();
+
+    FileKey largeKey;
+    QVERIFY(largeKey.load(&largeBuffer));
+    QCOMPARE(largeKey.type(), FileKey::Hashed);
+    QCOMPARE(largeKey.rawKey(), expected);
+
+    QTemporaryFile largeFile;
+    QVERIFY(largeFile.open());
+    QCOMPARE(largeFile.write(largeBuffer.data()), largeBuffer.size());
+    largeFile.close();
+
+    FileKey largeFileKey;
+    QVERIFY(largeFileKey.load(largeFile.fileName()));
+    QCOMPARE(largeFileKey.type(), FileKey::Hashed);
+    QCOMPARE(largeFileKey.rawKey(), expected);
 }
 
 void TestKeys::testFileKeyError()
@@ -327,3 +354,43 @@ void TestKeys::testCompositeKeyComponents()
     QVERIFY(!reader.readDatabase(&buffer, compositeKeyDec4, db2.data()));
     QVERIFY(reader.hasError());
 }
+
+void TestKeys::testTransformedKeyCache()
+{
+    const auto databaseUuid = QUuid::createUuid();
+    auto compositeKey = QSharedPointer<CompositeKey>::create();
+    compositeKey->addKey(QSharedPointer<PasswordKey>::create("password"));
+
+    AesKdf kdf(true);
+    kdf.setRounds(1000);
+    kdf.randomizeSeed();
+
+    QByteArray expected;
+    QVERIFY(compositeKey->transform(kdf, expected));
+
+    // The cache is only used once it is enabled for a key
+    QByteArray cached;
+    QVERIFY(!transformedKeyCache()->get(databaseUuid, kdf, compositeKey->rawKey(), cached));
+
+    compositeKey->setTransformedKeyCache(databaseUuid);
+    QByteArray transformed;
+    QVERIFY(compositeKey->transform(kdf, transformed));
+    QCOMPARE(transformed, expected);
+    QVERIFY(transformedKeyCache()->get(databaseUuid, kdf, compositeKey->rawKey(), cached));
+    QCOMPARE(cached, expected);
+
+    // A transformation with the same parameters is answered from the cache
+    transformedKeyCache()->insert(databaseUuid, kdf, compositeKey->rawKey(), QByteArray(32, 'x'));
+    QVERIFY(compositeKey->transform(kdf, transformed));
+    QCOMPARE(transformed, QByteArray(32, 'x'));
+
+    // Different credentials or a new seed miss the cache
+    QVERIFY(!transformedKeyCache()->get(databaseUuid, kdf, PasswordKey("other").rawKey(), cached));
+    kdf.randomizeSeed();
+    QVERIFY(!transformedKeyCache()->get(databaseUuid, kdf, compositeKey->rawKey(), cached));
+    QVERIFY(compositeKey->transform(kdf, transformed));
+    QVERIFY(transformed != QByteArray(32, 'x'));
+
+    transformedKeyCache()->remove(databaseUuid);
+    QVERIFY(!transformedKeyCache()->get(databaseUuid, kdf, compositeKey->rawKey(), cached));
+}
@@ -1452,6 +1452,121 @@ void TestMerge::testMergeModified()
     QTRY_VERIFY(!modifiedSignalSpy.empty());
 }
 
+void TestMerge::testMergeSharedHistory()
+{
+    QScopedPointer<Database> dbDestination(createTestDatabase());
+    Entry* destinationEntry = dbDestination->rootGroup()->findEntryByPath("entry1");
+    m_clock->advanceSecond(1);
+    destinationEntry->beginUpdate();
+    destinationEntry->setPassword("first");
+    destinationEntry->endUpdate();
+    QScopedPointer<Database> dbSource(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneIncludeHistory, Group::CloneIncludeEntries));
+    Entry* sourceEntry = dbSource->rootGroup()->findEntryByUuid(destinationEntry->uuid());
+    QCOMPARE(sourceEntry->contentHash(), destinationEntry->contentHash());
+    QCOMPARE(sourceEntry->historyItems().first()->contentHash(), destinationEntry->historyItems().first()->contentHash());
+
+    m_clock->advanceSecond(1);
+    sourceEntry->beginUpdate();
+    sourceEntry->setPassword("second");
+    sourceEntry->endUpdate();
+    QVERIFY(sourceEntry->contentHash() != destinationEntry->contentHash());
+    m_clock->advanceSecond(1);
+    destinationEntry->beginUpdate();
+    destinationEntry->setPassword("third");
+    destinationEntry->endUpdate();
+
+    // The history items both databases share are kept, only the missing version is added
+    const auto historyItems = destinationEntry->historyItems();
+    Merger merger(dbSource.data(), dbDestination.data());
+    merger.merge();
+    QCOMPARE(destinationEntry->password(), QString("third"));
+    QCOMPARE(destinationEntry->historyItems().size(), historyItems.size() + 1);
+    QCOMPARE(destinationEntry->historyItems().mid(0, historyItems.size()), historyItems);
+    QCOMPARE(destinationEntry->historyItems().last()->password(), QString("second"));
+
+    // Merging identical histories again does not change anything
+    const auto mergedHistoryItems = destinationEntry->historyItems();
+    Merger merger2(dbSource.data(), dbDestination.data());
+    merger2.merge();
+    QCOMPARE(destinationEntry->historyItems(), mergedHistoryItems);
+}
+
+void TestMerge::testMergeInBackground()
+{
+    QSharedPointer<Database> dbDestination(createTestDatabase());
+    QSharedPointer<Database> dbSource(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneNoFlags, Group::CloneIncludeEntries));
+    dbDestination->metadata()->setRecycleBin(dbDestination->rootGroup()->findChildByName("group2"));
+
+    // Without changes the target database is left alone
+    QPointer<Group> rootGroup = dbDestination->rootGroup();
+    QVERIFY(Merger::mergeInBackground(dbSource, dbDestination).isEmpty());
+    QCOMPARE(dbDestination->rootGroup(), rootGroup.data());
+
+    m_clock->advanceSecond(1);
+    Entry* entry = dbSource->rootGroup()->findEntryByPath("entry1");
+    entry->beginUpdate();
+    entry->setTitle("new title");
+    entry->endUpdate();
+
+    auto* newEntry = new Entry();
+    newEntry->setUuid(QUuid::createUuid());
+    newEntry->setTitle("entry3");
+    newEntry->setGroup(dbSource->rootGroup()->findChildByName("group2"));
+    const QDateTime locationChanged = newEntry->timeInfo().locationChanged();
+    m_clock->advanceSecond(1);
+
+    QVERIFY(!Merger::mergeInBackground(dbSource, dbDestination).isEmpty());
+    QVERIFY(!rootGroup);
+    QVERIFY(dbDestination->isModified());
+    QVERIFY(dbDestination->rootGroup()->findEntryByPath("new title"));
+
+    Entry* mergedEntry = dbDestination->rootGroup()->findEntryByUuid(newEntry->uuid());
+    QVERIFY(mergedEntry);
+    QCOMPARE(mergedEntry->group()->name(), QString("group2"));
+    QCOMPARE(mergedEntry->timeInfo().locationChanged(), locationChanged);
+
+    // The metadata refers to the groups of the merged tree
+    QVERIFY(dbDestination->metadata()->recycleBin());
+    QCOMPARE(dbDestination->metadata()->recycleBin()->name(), QString("group2"));
+}
+
+void TestMerge::testMergeChangedSubtree()
+{
+    QScopedPointer<Database> dbDestination(createTestDatabase());
+    auto* group3 = new Group();
+    group3->setUuid(QUuid::createUuid());
+    group3->setName("group3");
+    group3->setParent(dbDestination->rootGroup()->findChildByName("group2"));
+    auto* entry3 = new Entry();
+    entry3->setUuid(QUuid::createUuid());
+    entry3->setTitle("entry3");
+    entry3->setGroup(group3);
+
+    QScopedPointer<Database> dbSource(
+        createTestDatabaseStructureClone(dbDestination.data(), Entry::CloneNoFlags, Group::CloneIncludeEntries));
+    Merger merger1(dbSource.data(), dbDestination.data());
+    QVERIFY(merger1.merge().isEmpty());
+
+    // Only the changed entry deep down the tree is merged
+    m_clock->advanceSecond(1);
+    Entry* sourceEntry = dbSource->rootGroup()->findEntryByUuid(entry3->uuid());
+    sourceEntry->beginUpdate();
+    sourceEntry->setTitle("new title");
+    sourceEntry->endUpdate();
+
+    Merger merger2(dbSource.data(), dbDestination.data());
+    QCOMPARE(merger2.merge().size(), 1);
+    Entry* mergedEntry = dbDestination->rootGroup()->findEntryByUuid(entry3->uuid());
+    QVERIFY(mergedEntry);
+    QCOMPARE(mergedEntry->title(), QString("new title"));
+    QCOMPARE(mergedEntry->group()->name(), QString("group3"));
+
+    Merger merger3(dbSource.data(), dbDestination.data());
+    QVERIFY(merger3.merge().isEmpty());
+}
+
 Database* TestMerge::createTestDatabase()
 {
     auto db = new Database();
@@ -56,6 +56,9 @@ private slots:
     void testDeletedGroup();
     void testDeletedRevertedEntry();
     void testDeletedRevertedGroup();
+    void testMergeSharedHistory();
+    void testMergeInBackground();
+    void testMergeChangedSubtree();
 
 private:
     Database* createTestDatabase();
@@ -664,6 +664,16 @@ void TestModified::testCustomData()
     QTRY_COMPARE(spyModified.count(), spyCount);
     group->customData()->set("Key", "Value");
     QTRY_COMPARE(spyModified.count(), spyCount);
+
+    // Equal keys of different objects share their data
+    auto keyData = [](const CustomData* customData, const QString& key) {
+        const auto keys = customData->keys();
+        return keys.at(keys.indexOf(key)).constData();
+    };
+    QCOMPARE(keyData(entry->customData(), "Key"), keyData(group->customData(), "Key"));
+    entry->customData()->rename("Key", "Renamed");
+    QCOMPARE(entry->customData()->value("Renamed"), QString("Value"));
+    QVERIFY(!entry->customData()->contains("Key"));
 }
 
 void TestModified::testBlockModifiedSignal()
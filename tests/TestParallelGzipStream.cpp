@@ -0,0 +1,194 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestParallelGzipStream.h"
+
+#include <QBuffer>
+#include <QTest>
+
+#include <zlib.h>
+
+#include "FailDevice.h"
+#include "streams/ParallelGzipStream.h"
+#include "streams/qtiocompressor.h"
+
+QTEST_GUILESS_MAIN(TestParallelGzipStream)
+
+namespace
+{
+    const int ChunkSize = 32 * 1024;
+
+    /**
+     * @return text with repetitions followed by bytes that do not compress, so the
+     *         automatic level takes different choices on different chunks
+     */
+    QByteArray testData(int size)
+    {
+        QByteArray data;
+        data.reserve(size);
+        quint32 state = 0x12345678;
+        while (data.size() < size) {
+            if ((data.size() / (ChunkSize / 2)) % 2 == 0) {
+                data.append("<Entry><Title>Example entry</Title></Entry>\n");
+            } else {
+                state = state * 1664525u + 1013904223u;
+                data.append(static_cast<char>(state >> 24));
+            }
+        }
+        data.truncate(size);
+        return data;
+    }
+
+    QByteArray compress(const QByteArray& data, int level, const QList<int>& pieceSizes = {})
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        ParallelGzipStream stream(&buffer, level, ChunkSize);
+        if (!stream.open(QIODevice::WriteOnly)) {
+            return {};
+        }
+
+        int offset = 0;
+        int piece = 0;
+        while (offset < data.size()) {
+            int size = pieceSizes.isEmpty() ? data.size() : pieceSizes.at(piece++ % pieceSizes.size());
+            size = qMin(size, data.size() - offset);
+            if (stream.write(data.constData() + offset, size) != size) {
+                return {};
+            }
+            offset += size;
+        }
+        stream.close();
+        return buffer.data();
+    }
+
+    /**
+     * Inflate a gzip file the way gunzip does, including the check of the CRC and size in the trailer.
+     *
+     * @return true if the data holds exactly one valid gzip member
+     */
+    bool gunzip(const QByteArray& compressed, QByteArray& output)
+    {
+        z_stream stream = {};
+        if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK) {
+            return false;
+        }
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.constData()));
+        stream.avail_in = static_cast<uInt>(compressed.size());
+        char buffer[16 * 1024];
+        int status;
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = sizeof(buffer);
+            status = inflate(&stream, Z_NO_FLUSH);
+            output.append(buffer, static_cast<int>(sizeof(buffer) - stream.avail_out));
+        } while (status == Z_OK);
+
+        bool ok = status == Z_STREAM_END && stream.avail_in == 0;
+        inflateEnd(&stream);
+        return ok;
+    }
+} // namespace
+
+void TestParallelGzipStream::testRoundTrip_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("level");
+
+    QTest::newRow("empty") << 0 << 6;
+    QTest::newRow("part of a chunk") << 1000 << 6;
+    QTest::newRow("one chunk") << ChunkSize << 6;
+    QTest::newRow("several batches") << ChunkSize * 37 + 123 << 6;
+    QTest::newRow("stored") << ChunkSize * 5 << 0;
+    QTest::newRow("automatic") << ChunkSize * 9 + 1 << int(ParallelGzipStream::AutoCompressionLevel);
+}
+
+void TestParallelGzipStream::testRoundTrip()
+{
+    QFETCH(int, size);
+    QFETCH(int, level);
+
+    const auto data = testData(size);
+    const auto compressed = compress(data, level);
+    QVERIFY(!compressed.isEmpty());
+
+    QByteArray inflated;
+    QVERIFY(gunzip(compressed, inflated));
+    QCOMPARE(inflated, data);
+
+    // The reader used for KDBX files
+    QBuffer buffer;
+    buffer.setData(compressed);
+    buffer.open(QIODevice::ReadOnly);
+    QtIOCompressor reader(&buffer);
+    reader.setStreamFormat(QtIOCompressor::GzipFormat);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.readAll(), data);
+}
+
+void TestParallelGzipStream::testChunkBoundaries()
+{
+    // Chunks are cut at the same input offsets however the data is written
+    const auto data = testData(ChunkSize * 11 + 17);
+    const auto expected = compress(data, 6);
+    QCOMPARE(compress(data, 6, {1, ChunkSize - 1, 7}), expected);
+    QCOMPARE(compress(data, 6, {ChunkSize}), expected);
+    QCOMPARE(compress(data, 6, {ChunkSize + 1, 3 * ChunkSize}), expected);
+}
+
+void TestParallelGzipStream::testCloseMidChunk()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    ParallelGzipStream stream(&buffer, 6, ChunkSize);
+    QVERIFY(stream.open(QIODevice::WriteOnly));
+
+    const auto data = testData(ChunkSize * 2 + ChunkSize / 3);
+    QCOMPARE(stream.write(data), qint64(data.size()));
+    // Nothing but full batches is compressed before the stream is closed
+    QVERIFY(buffer.data().size() < data.size());
+    stream.close();
+    QVERIFY(!stream.isOpen());
+
+    QByteArray inflated;
+    QVERIFY(gunzip(buffer.data(), inflated));
+    QCOMPARE(inflated, data);
+
+    // Closing again does not append another trailer
+    const auto written = buffer.data();
+    stream.close();
+    QCOMPARE(buffer.data(), written);
+}
+
+void TestParallelGzipStream::testWriteFailure()
+{
+    const auto data = testData(ChunkSize * 64);
+
+    // The base device fails while a batch is written
+    FailDevice failDevice(ChunkSize);
+    QVERIFY(failDevice.open(QIODevice::WriteOnly));
+    ParallelGzipStream stream(&failDevice, 0, ChunkSize);
+    QVERIFY(stream.open(QIODevice::WriteOnly));
+    QCOMPARE(stream.write(data), qint64(-1));
+    QCOMPARE(stream.errorString(), QString("FAILDEVICE"));
+    // Later writes fail as well and closing does not write a trailer
+    QCOMPARE(stream.write(data.left(10)), qint64(-1));
+    const auto written = failDevice.data();
+    stream.close();
+    QCOMPARE(failDevice.data(), written);
+}
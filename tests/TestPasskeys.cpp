@@ -17,6 +17,7 @@
 
 #include "TestPasskeys.h"
 #include "browser/BrowserCbor.h"
+#include "browser/BrowserEntryIndex.h"
 #include "browser/BrowserMessageBuilder.h"
 #include "browser/BrowserPasskeysClient.h"
 #include "browser/BrowserService.h"
@@ -212,10 +213,18 @@ void TestPasskeys::testLoadingECPrivateKeyFromPem()
         "1NSVVBMUxWd3pHcHlJbTFmT0JuMVFuUmEwUUgyN0FEQWFKR0h5c1EiLCJvcmlnaW4iOiJodHRwczovL3dlYmF1dGhuLmlvIiwiY3Jvc3NPcmln"
         "aW4iOmZhbHNlfQ");
 
+    browserPasskeys()->clearKeyCache();
     const auto signature = browserPasskeys()->buildSignature(authenticatorData, clientData, privateKeyPem);
     QCOMPARE(
         browserMessageBuilder()->getBase64FromArray(signature),
         QString("MEYCIQCpbDaYJ4b2ofqWBxfRNbH3XCpsyao7Iui5lVuJRU9HIQIhAPl5moNZgJu5zmurkKK_P900Ct6wd3ahVIqCEqTeeRdE"));
+
+    // The parsed key is reused for the next signature
+    QCOMPARE(browserPasskeys()->m_privateKeys.size(), 1);
+    QVERIFY(!browserPasskeys()->buildSignature(authenticatorData, clientData, privateKeyPem).isEmpty());
+    QCOMPARE(browserPasskeys()->m_privateKeys.size(), 1);
+    browserPasskeys()->clearKeyCache();
+    QVERIFY(browserPasskeys()->m_privateKeys.isEmpty());
 }
 
 void TestPasskeys::testLoadingRSAPrivateKeyFromPem()
@@ -537,6 +546,19 @@ void TestPasskeys::testEntry()
                                         QString("privateKey"));
 
     QVERIFY(entry->hasPasskey());
+
+    // Passkeys are indexed by their relying party
+    auto index = BrowserEntryIndex::forDatabase(&db);
+    QCOMPARE(index->passkeyCandidates("example.com"), QSet<Entry*>({entry}));
+    QCOMPARE(index->passkeyEntries(), QList<Entry*>({entry}));
+    QCOMPARE(index->entries(), QList<Entry*>({entry}));
+    entry->attributes()->set(EntryAttributes::KPEX_PASSKEY_RELYING_PARTY, "example.org");
+    QVERIFY(index->passkeyCandidates("example.com").isEmpty());
+    QCOMPARE(index->passkeyCandidates("example.org"), QSet<Entry*>({entry}));
+    delete entry;
+    QVERIFY(index->passkeyCandidates("example.org").isEmpty());
+    QVERIFY(index->passkeyEntries().isEmpty());
+    QVERIFY(index->entries().isEmpty());
 }
 
 void TestPasskeys::testIsDomain()
@@ -20,7 +20,9 @@
 #include "core/PassphraseGenerator.h"
 #include "crypto/Crypto.h"
 
+#include <QFile>
 #include <QRegularExpression>
+#include <QTemporaryDir>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestPassphraseGenerator)
@@ -68,3 +70,37 @@ void TestPassphraseGenerator::testUniqueEntriesInWordlist()
     // so this fails
     QVERIFY(!generator.isValid());
 }
+
+void TestPassphraseGenerator::testWordListCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const auto path = dir.filePath("test.wordlist");
+    auto writeWords = [&](const QStringList& words) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(words.join("\n").toUtf8());
+    };
+
+    PassphraseGenerator generator;
+    generator.m_minimum_wordlist_length = 4;
+    generator.setWordCount(1);
+
+    writeWords({"alpha", "beta", "gamma", "delta"});
+    generator.setWordList(path);
+    QVERIFY(generator.isValid());
+    QCOMPARE(generator.estimateEntropy(), 2.0);
+
+    // Switching back to a parsed list uses the cached words
+    generator.setDefaultWordList();
+    generator.setWordList(path);
+    QCOMPARE(generator.estimateEntropy(), 2.0);
+
+    // A changed file is parsed again
+    writeWords({"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"});
+    generator.setWordList(path);
+    QCOMPARE(generator.estimateEntropy(), 3.0);
+    QVERIFY(QRegularExpression("^(alpha|beta|gamma|delta|epsilon|zeta|eta|theta)$")
+                .match(generator.generatePassphrase())
+                .hasMatch());
+}
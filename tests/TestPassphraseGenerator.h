@@ -28,6 +28,7 @@ private slots:
     void initTestCase();
     void testWordCase();
     void testUniqueEntriesInWordlist();
+    void testWordListCache();
 };
 
 #endif // KEEPASSXC_TESTPASSPHRASEGENERATOR_H
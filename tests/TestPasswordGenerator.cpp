@@ -19,6 +19,7 @@
 #include "crypto/Crypto.h"
 
 #include <QRegularExpression>
+#include <QSet>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestPasswordGenerator)
@@ -281,3 +282,21 @@ void TestPasswordGenerator::testReset()
     QCOMPARE(m_generator.getExcludedCharacterSet(), default_generator.getExcludedCharacterSet());
     QCOMPARE(m_generator.getLength(), default_generator.getLength());
 }
+
+void TestPasswordGenerator::testGeneratePasswords()
+{
+    m_generator.setCharClasses(PasswordGenerator::CharClass::LowerLetters | PasswordGenerator::CharClass::Numbers);
+    m_generator.setFlags(PasswordGenerator::GeneratorFlag::CharFromEveryGroup);
+    m_generator.setLength(10);
+    QVERIFY(m_generator.isValid());
+
+    const auto passwords = m_generator.generatePasswords(5000);
+    QCOMPARE(passwords.size(), 5000);
+    QRegularExpression expected(R"(^(?=.*[a-z])(?=.*\d)[a-z\d]{10}$)");
+    QSet<QString> unique;
+    for (const auto& password : passwords) {
+        QVERIFY2(expected.match(password).hasMatch(), qPrintable(password));
+        unique.insert(password);
+    }
+    QCOMPARE(unique.size(), passwords.size());
+}
@@ -17,6 +17,9 @@
 
 #include "TestPasswordHealth.h"
 
+#include "core/DatabaseStats.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
 #include "core/PasswordHealth.h"
 
 #include <QTest>
@@ -63,4 +66,103 @@ void TestPasswordHealth::testNoDb()
     QCOMPARE(excellent.quality(), PasswordHealth::Quality::Excellent);
     QVERIFY(excellent.scoreReason().isEmpty());
     QVERIFY(excellent.scoreDetails().isEmpty());
+
+    // Long secrets are matched on a prefix window, the rest is extrapolated
+    const auto window = QString("prompter-ream-oversleep-step-extortion-quarrel-reflected-prefix!");
+    QCOMPARE(window.length(), 64);
+    const auto windowEntropy = PasswordHealth::estimateEntropy(window);
+    QCOMPARE(PasswordHealth::estimateEntropy(window + window), windowEntropy * 2);
+}
+
+void TestPasswordHealth::testEntropyCache()
+{
+    PasswordEntropyCache cache;
+    QCOMPARE(cache.entropy("Yohb2ChR4"), PasswordHealth("Yohb2ChR4").entropy());
+    QCOMPARE(cache.entropy("Yohb2ChR4"), PasswordHealth("Yohb2ChR4").entropy());
+    QCOMPARE(cache.entropy(""), 0.0);
+
+    // Pre-warmed entropies are served from the cache, clearing drops them
+    cache.clear();
+    QCOMPARE(cache.memoryUsage(), 0);
+    cache.prewarm({"Yohb2ChR4", "MIhIN9UKrgtPL2hp", "Yohb2ChR4"});
+    const auto prewarmedUsage = cache.memoryUsage();
+    QVERIFY(prewarmedUsage > 0);
+    QCOMPARE(cache.entropy("MIhIN9UKrgtPL2hp"), PasswordHealth("MIhIN9UKrgtPL2hp").entropy());
+    QCOMPARE(cache.memoryUsage(), prewarmedUsage);
+    cache.clear();
+    QCOMPARE(cache.memoryUsage(), 0);
+
+    auto db = QSharedPointer<Database>::create();
+    auto entry1 = new Entry();
+    entry1->setPassword("MIhIN9UKrgtPL2hp");
+    entry1->setGroup(db->rootGroup());
+    auto entry2 = new Entry();
+    entry2->setPassword("MIhIN9UKrgtPL2hp");
+    entry2->setGroup(db->rootGroup());
+
+    // Re-use is still counted for cached passwords
+    for (int i = 0; i < 2; ++i) {
+        const auto health = HealthChecker(db).evaluate(entry1);
+        QCOMPARE(health->score(), PasswordHealth("MIhIN9UKrgtPL2hp").score() - 15);
+        QCOMPARE(health->quality(), PasswordHealth::Quality::Weak);
+    }
+    QCOMPARE(entry1->passwordHealth()->quality(), PasswordHealth::Quality::Good);
+
+    // The cached health of an entry follows its password
+    entry1->setPassword("secret");
+    QCOMPARE(entry1->passwordHealth()->quality(), PasswordHealth::Quality::Poor);
+    entry1->attributes()->set(EntryAttributes::PasswordKey, "MIhIN9UKrgtPL2hp", true);
+    QCOMPARE(entry1->passwordHealth()->quality(), PasswordHealth::Quality::Good);
+}
+
+void TestPasswordHealth::testDatabaseStats()
+{
+    auto db = QSharedPointer<Database>::create();
+    auto group = new Group();
+    group->setParent(db->rootGroup());
+    auto entry1 = new Entry();
+    entry1->setPassword("MIhIN9UKrgtPL2hp");
+    entry1->setGroup(db->rootGroup());
+    auto entry2 = new Entry();
+    entry2->setPassword("secret");
+    entry2->setGroup(group);
+
+    DatabaseStats stats(db);
+    QCOMPARE(stats.groupCount, 2);
+    QCOMPARE(stats.entryCount, 2);
+    QCOMPARE(stats.uniquePasswords, 2);
+    QCOMPARE(stats.reusedPasswords, 0);
+    QCOMPARE(stats.shortPasswords, 1);
+    QCOMPARE(stats.weakPasswords, 1);
+    QCOMPARE(stats.totalPasswordLength, 22);
+
+    // Modified and added entries update the counters
+    entry2->setPassword("MIhIN9UKrgtPL2hp");
+    auto entry3 = new Entry();
+    entry3->setGroup(group);
+    entry3->setExpires(true);
+    entry3->setExpiryTime(QDateTime::currentDateTimeUtc().addDays(-1));
+    stats = DatabaseStats(db);
+    QCOMPARE(stats.entryCount, 3);
+    QCOMPARE(stats.expiredEntries, 1);
+    QCOMPARE(stats.uniquePasswords, 1);
+    QCOMPARE(stats.reusedPasswords, 1);
+    QCOMPARE(stats.maxPwdReuse(), 2);
+    QCOMPARE(stats.shortPasswords, 0);
+    QCOMPARE(stats.weakPasswords, 2);
+
+    // Entries of groups moved into the recycle bin are no longer counted
+    db->metadata()->setRecycleBinEnabled(true);
+    db->recycleGroup(group);
+    stats = DatabaseStats(db);
+    QCOMPARE(stats.groupCount, 1);
+    QCOMPARE(stats.entryCount, 1);
+    QCOMPARE(stats.uniquePasswords, 1);
+    QCOMPARE(stats.reusedPasswords, 0);
+    QCOMPARE(stats.weakPasswords, 0);
+
+    delete entry1;
+    stats = DatabaseStats(db);
+    QCOMPARE(stats.entryCount, 0);
+    QCOMPARE(stats.uniquePasswords, 0);
 }
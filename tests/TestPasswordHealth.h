@@ -27,6 +27,8 @@ class TestPasswordHealth : public QObject
 private slots:
     void initTestCase();
     void testNoDb();
+    void testEntropyCache();
+    void testDatabaseStats();
 };
 
 #endif // KEEPASSX_TESTPASSWORDHEALTH_H
@@ -21,6 +21,7 @@
 #include "crypto/Random.h"
 
 #include <QTest>
+#include <QVector>
 
 QTEST_GUILESS_MAIN(TestRandomGenerator)
 
@@ -58,3 +59,24 @@ void TestRandomGenerator::testUIntRange()
         QVERIFY(rand < 200);
     }
 }
+
+void TestRandomGenerator::testBuffer()
+{
+    // A tiny block is refilled on almost every draw
+    RandomBuffer buffer(6);
+    QCOMPARE(buffer.randomUInt(0), 0U);
+    QCOMPARE(buffer.randomUInt(1), 0U);
+
+    QVector<int> counts(4, 0);
+    for (int i = 0; i < 4000; ++i) {
+        ++counts[static_cast<int>(buffer.randomUInt(4))];
+    }
+    for (int count : counts) {
+        QVERIFY(count > 800);
+    }
+
+    // Draws of the thread buffer span several refills
+    for (int i = 0; i < 5000; ++i) {
+        QVERIFY(randomGen()->randomUInt(10) < 10);
+    }
+}
@@ -18,10 +18,15 @@
 #include "TestSSHAgent.h"
 #include "config-keepassx-tests.h"
 #include "core/Config.h"
+#include "core/Database.h"
+#include "core/Group.h"
 #include "crypto/Crypto.h"
+#include "sshagent/BinaryStream.h"
+#include "sshagent/KeeAgentEntryIndex.h"
 #include "sshagent/KeeAgentSettings.h"
 #include "sshagent/OpenSSHKeyGen.h"
 #include "sshagent/SSHAgent.h"
+#include "sshagent/SSHAgentServer.h"
 
 #include <QTest>
 
@@ -224,6 +229,188 @@ void TestSSHAgent::testToOpenSSHKey()
     QVERIFY(!key.publicKey().isEmpty());
 }
 
+void TestSSHAgent::testDatabaseUnlocked()
+{
+    SSHAgent agent;
+    agent.setEnabled(true);
+    agent.setAuthSockOverride(m_agentSocketFileName);
+
+    QVERIFY(agent.isAgentRunning());
+
+    auto db = QSharedPointer<Database>::create();
+    QList<OpenSSHKey> keys;
+
+    KeeAgentSettings settings;
+    settings.setAllowUseOfSshKey(true);
+    settings.setAddAtDatabaseOpen(true);
+    settings.setRemoveAtDatabaseClose(true);
+    settings.setSelectedType("attachment");
+    settings.setAttachmentName("id_ed25519");
+
+    for (int i = 0; i < 3; ++i) {
+        OpenSSHKey key;
+        QVERIFY(OpenSSHKeyGen::generateEd25519(key));
+
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setGroup(db->rootGroup());
+        entry->attachments()->set("id_ed25519", key.privateKey().toLatin1());
+        settings.toEntry(entry);
+        keys.append(key);
+    }
+
+    // an encrypted key that is decrypted with the entry password
+    auto entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setGroup(db->rootGroup());
+    entry->setPassword("correctpassphrase");
+    settings.setSelectedType("file");
+    settings.setFileName(QString("%1/id_rsa-encrypted-asn1").arg(QString(KEEPASSX_TEST_DATA_DIR)));
+    settings.toEntry(entry);
+
+    OpenSSHKey encryptedKey;
+    QVERIFY(settings.toOpenSSHKey(entry, encryptedKey, true));
+    keys.append(encryptedKey);
+
+    bool keyInAgent;
+
+    agent.databaseUnlocked(db);
+    for (const auto& key : keys) {
+        QVERIFY(agent.checkIdentity(key, keyInAgent) && keyInAgent);
+    }
+
+    agent.databaseLocked(db);
+    for (const auto& key : keys) {
+        QVERIFY(agent.checkIdentity(key, keyInAgent) && !keyInAgent);
+    }
+}
+
+void TestSSHAgent::testServeKeys()
+{
+    SSHAgentServer server;
+    auto db = QSharedPointer<Database>::create();
+
+    KeeAgentSettings settings;
+    settings.setAllowUseOfSshKey(true);
+    settings.setAddAtDatabaseOpen(true);
+    settings.setSelectedType("attachment");
+    settings.setAttachmentName("id_key");
+
+    QList<OpenSSHKey> keys;
+    for (int i = 0; i < 3; ++i) {
+        OpenSSHKey key;
+        QVERIFY(i == 0 ? OpenSSHKeyGen::generateEd25519(key)
+                       : (i == 1 ? OpenSSHKeyGen::generateRSA(key, 2048) : OpenSSHKeyGen::generateECDSA(key, 256)));
+
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setGroup(db->rootGroup());
+        entry->attachments()->set("id_key", key.privateKey().toLatin1());
+        settings.toEntry(entry);
+        keys.append(key);
+    }
+
+    // Nothing is served before the database is added
+    QByteArray request(1, 11);
+    QByteArray emptyData = server.handleRequest(request);
+    BinaryStream emptyResponse(&emptyData);
+    quint8 type;
+    quint32 count;
+    QVERIFY(emptyResponse.read(type) && emptyResponse.read(count));
+    QCOMPARE(type, static_cast<quint8>(12));
+    QCOMPARE(count, 0u);
+
+    server.addDatabase(db);
+    QByteArray identitiesData = server.handleRequest(request);
+    BinaryStream identities(&identitiesData);
+    QVERIFY(identities.read(type) && identities.read(count));
+    QCOMPARE(type, static_cast<quint8>(12));
+    QCOMPARE(count, 3u);
+
+    const QStringList algorithms = {"ssh-ed25519", "rsa-sha2-256", "ecdsa-sha2-nistp256"};
+    for (int i = 0; i < keys.size(); ++i) {
+        QByteArray keyBlob;
+        BinaryStream keyStream(&keyBlob);
+        QVERIFY(keys[i].writePublic(keyStream));
+
+        QByteArray signRequest;
+        BinaryStream signStream(&signRequest);
+        signStream.write(static_cast<quint8>(13));
+        signStream.writeString(keyBlob);
+        signStream.writeString(QByteArray("data to sign"));
+        signStream.write(OpenSSHKey::SIGN_RSA_SHA2_256);
+
+        QByteArray signData = server.handleRequest(signRequest);
+        BinaryStream signResponse(&signData);
+        QByteArray signatureBlob;
+        QVERIFY(signResponse.read(type) && signResponse.readString(signatureBlob));
+        QCOMPARE(type, static_cast<quint8>(14));
+
+        BinaryStream signatureStream(&signatureBlob);
+        QString algorithm;
+        QByteArray signature;
+        QVERIFY(signatureStream.readString(algorithm) && signatureStream.readString(signature));
+        QCOMPARE(algorithm, algorithms[i]);
+        QVERIFY(!signature.isEmpty());
+    }
+
+    // Locking the database stops serving its keys
+    server.removeDatabase(db);
+    QByteArray lockedData = server.handleRequest(request);
+    BinaryStream lockedIdentities(&lockedData);
+    QVERIFY(lockedIdentities.read(type) && lockedIdentities.read(count));
+    QCOMPARE(count, 0u);
+}
+
+void TestSSHAgent::testEntryIndex()
+{
+    auto db = QSharedPointer<Database>::create();
+    auto index = KeeAgentEntryIndex::forDatabase(db.data());
+    QCOMPARE(KeeAgentEntryIndex::forDatabase(db.data()), index);
+
+    KeeAgentSettings settings;
+    settings.setAllowUseOfSshKey(true);
+    settings.setSelectedType("attachment");
+    settings.setAttachmentName("id_ed25519");
+
+    auto plain = new Entry();
+    plain->setUuid(QUuid::createUuid());
+    plain->setGroup(db->rootGroup());
+
+    auto first = new Entry();
+    first->setUuid(QUuid::createUuid());
+    first->setGroup(db->rootGroup());
+    settings.toEntry(first);
+
+    QCOMPARE(index->entries(), QVector<Entry*>({first}));
+    KeeAgentSettings indexed;
+    QVERIFY(!index->settings(plain, indexed));
+    QVERIFY(index->settings(first, indexed));
+    QCOMPARE(indexed, settings);
+
+    // Entries gain and lose settings with their attachment
+    settings.toEntry(plain);
+    QCOMPARE(index->entries(), QVector<Entry*>({plain, first}));
+    settings.setAddAtDatabaseOpen(true);
+    settings.toEntry(first);
+    QVERIFY(index->settings(first, indexed));
+    QVERIFY(indexed.addAtDatabaseOpen());
+    plain->attachments()->remove("KeeAgent.settings");
+    QCOMPARE(index->entries(), QVector<Entry*>({first}));
+
+    // Entries of added groups are picked up, deleted entries are dropped
+    auto group = new Group();
+    auto second = new Entry();
+    second->setUuid(QUuid::createUuid());
+    second->setGroup(group);
+    settings.toEntry(second);
+    group->setParent(db->rootGroup());
+    QCOMPARE(index->entries(), QVector<Entry*>({first, second}));
+
+    delete first;
+    QCOMPARE(index->entries(), QVector<Entry*>({second}));
+}
+
 void TestSSHAgent::testKeyGenRSA()
 {
     SSHAgent agent;
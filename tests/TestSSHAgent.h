@@ -35,6 +35,9 @@ private slots:
     void testLifetimeConstraint();
     void testConfirmConstraint();
     void testToOpenSSHKey();
+    void testDatabaseUnlocked();
+    void testServeKeys();
+    void testEntryIndex();
     void testKeyGenRSA();
     void testKeyGenECDSA();
     void testKeyGenEd25519();
@@ -198,7 +198,14 @@ void TestSymmetricCipher::testAesKdf()
     QVERIFY(SymmetricCipher::aesKdf(key, 1, data));
     QCOMPARE(data, result);
 
-    // TODO: Test multiple rounds of AES KDF
+    // Both halves of a key are transformed on their own threads
+    auto first = QByteArray::fromHex("6bc1bee22e409f96e93d7e117393172a");
+    auto second = QByteArray::fromHex("ae2d8a571e03ac9c9eb76fac45af8e51");
+    auto both = first + second;
+    QVERIFY(SymmetricCipher::aesKdf(key, 20000, first));
+    QVERIFY(SymmetricCipher::aesKdf(key, 20000, second));
+    QVERIFY(SymmetricCipher::aesKdf(key, 20000, both));
+    QCOMPARE(both, first + second);
 }
 
 void TestSymmetricCipher::testTwofish256CbcEncryption()
@@ -455,3 +462,55 @@ void TestSymmetricCipher::testStreamReset()
     writer.close();
     QCOMPARE(buffer.buffer().size(), 16);
 }
+
+void TestSymmetricCipher::testStreamChunks_data()
+{
+    QTest::addColumn<SymmetricCipher::Mode>("mode");
+    QTest::addColumn<int>("ivSize");
+    QTest::newRow("AES256-CBC") << SymmetricCipher::Aes256_CBC << 16;
+    QTest::newRow("Twofish-CBC") << SymmetricCipher::Twofish_CBC << 16;
+    QTest::newRow("ChaCha20") << SymmetricCipher::ChaCha20 << 12;
+}
+
+void TestSymmetricCipher::testStreamChunks()
+{
+    QFETCH(SymmetricCipher::Mode, mode);
+    QFETCH(int, ivSize);
+
+    const QByteArray key(32, 'k');
+    const QByteArray iv(ivSize, 'i');
+    QByteArray plainText;
+    for (int i = 0; i < 300 * 1024 + 7; ++i) {
+        plainText.append(static_cast<char>(i * 31 + i / 256));
+    }
+
+    // Writes of odd sizes end up in whole chunks
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    SymmetricCipherStream writer(&buffer);
+    QVERIFY(writer.init(mode, SymmetricCipher::Encrypt, key, iv));
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+    for (int pos = 0; pos < plainText.size(); pos += 70001) {
+        const auto part = plainText.mid(pos, 70001);
+        QCOMPARE(writer.write(part), qint64(part.size()));
+    }
+    writer.close();
+
+    QByteArray cipherText = plainText;
+    SymmetricCipher cipher;
+    QVERIFY(cipher.init(mode, SymmetricCipher::Encrypt, key, iv));
+    QVERIFY(cipher.finish(cipherText));
+    QCOMPARE(buffer.data(), cipherText);
+
+    // Small reads go through the internal buffer, large ones are decrypted in place
+    buffer.reset();
+    SymmetricCipherStream reader(&buffer);
+    QVERIFY(reader.init(mode, SymmetricCipher::Decrypt, key, iv));
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QByteArray decrypted = reader.read(5);
+    decrypted.append(reader.read(200 * 1024));
+    decrypted.append(reader.read(3));
+    decrypted.append(reader.readAll());
+    QCOMPARE(decrypted.size(), plainText.size());
+    QVERIFY(decrypted == plainText);
+}
@@ -39,6 +39,8 @@ private slots:
     void testChaCha20();
     void testPadding();
     void testStreamReset();
+    void testStreamChunks_data();
+    void testStreamChunks();
 };
 
 #endif // KEEPASSX_TESTSYMMETRICCIPHER_H
@@ -18,8 +18,11 @@
 #include "TestTools.h"
 
 #include "core/Clock.h"
+#include "core/PerformanceStats.h"
 
+#include <QFile>
 #include <QRegularExpression>
+#include <QTemporaryDir>
 #include <QTest>
 #include <QUuid>
 
@@ -66,6 +69,10 @@ void TestTools::testIsBase64()
     QVERIFY(!Tools::isBase64(QByteArray("abcd123==")));
     QVERIFY(!Tools::isBase64(QByteArray("abc_")));
     QVERIFY(!Tools::isBase64(QByteArray("123")));
+    QVERIFY(Tools::isBase64(QByteArray()));
+    QVERIFY(!Tools::isBase64(QByteArray("====")));
+    QVERIFY(!Tools::isBase64(QByteArray("1=34")));
+    QVERIFY(!Tools::isBase64(QByteArray("12\xe9=")));
 }
 
 void TestTools::testIsAsciiString()
@@ -272,3 +279,55 @@ void TestTools::testArrayContainsValues()
     const auto result3 = Tools::getMissingValuesFromList<int>(numberValues, QList<int>({6, 7, 8}));
     QCOMPARE(result3.length(), 3);
 }
+
+void TestTools::testPerformanceStats()
+{
+    PerformanceStats::setEnabled(true);
+    PerformanceStats::reset();
+    QVERIFY(PerformanceStats::report().contains("Nothing recorded yet"));
+
+    PerformanceStats::record("test.operation", 1000000);
+    PerformanceStats::record("test.operation", 3000000);
+    PerformanceStats::record("test.operation", 100000000);
+    {
+        PerformanceStats::ScopedTimer timer("test.scoped");
+    }
+
+    auto report = PerformanceStats::report();
+    QVERIFY(report.contains("- test.operation: 3 call"));
+    QVERIFY(report.contains("mean 34.67 ms"));
+    QVERIFY(report.contains("max 100.00 ms"));
+    QVERIFY(report.contains("- test.scoped: 1 call"));
+    // Operations are listed by name
+    QVERIFY(report.indexOf("test.operation") < report.indexOf("test.scoped"));
+
+    // Disabled timers record nothing
+    PerformanceStats::reset();
+    PerformanceStats::setEnabled(false);
+    {
+        PerformanceStats::ScopedTimer timer("test.scoped");
+    }
+    PerformanceStats::setEnabled(true);
+    QVERIFY(!PerformanceStats::report().contains("test.scoped"));
+    PerformanceStats::reset();
+}
+
+void TestTools::testRemoveStaleSocket()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // Nothing in the way
+    const auto missingPath = dir.filePath("missing.sock");
+    QVERIFY(Tools::removeStaleSocket(missingPath));
+
+#ifdef Q_OS_UNIX
+    // Files that are not sockets are never removed
+    const auto filePath = dir.filePath("file.sock");
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+    QVERIFY(!Tools::removeStaleSocket(filePath));
+    QVERIFY(QFile::exists(filePath));
+#endif
+}
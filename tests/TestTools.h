@@ -37,6 +37,8 @@ private slots:
     void testConvertToRegex();
     void testConvertToRegex_data();
     void testArrayContainsValues();
+    void testPerformanceStats();
+    void testRemoveStaleSocket();
 };
 
 #endif // KEEPASSX_TESTTOOLS_H
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkBrowser.h"
+#include "DatabaseGenerator.h"
+
+#include "browser/BrowserService.h"
+#include "browser/BrowserSettings.h"
+#include "core/Group.h"
+#include "crypto/Crypto.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkBrowser)
+
+void BenchmarkBrowser::initTestCase()
+{
+    QVERIFY(Crypto::init());
+    browserSettings()->setBestMatchOnly(false);
+}
+
+void BenchmarkBrowser::benchmarkSearchEntries_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkBrowser::benchmarkSearchEntries()
+{
+    QFETCH(int, entryCount);
+    auto db = DatabaseGenerator::generate(entryCount);
+    const auto siteUrl = DatabaseGenerator::url(42);
+
+    // The first search builds the index of the database
+    QVERIFY(!browserService()->searchEntries(db, siteUrl, siteUrl).isEmpty());
+    QBENCHMARK
+    {
+        browserService()->searchEntries(db, siteUrl, siteUrl);
+    }
+}
+
+void BenchmarkBrowser::benchmarkSortEntries_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkBrowser::benchmarkSortEntries()
+{
+    QFETCH(int, entryCount);
+    auto db = DatabaseGenerator::generate(entryCount);
+    auto entries = db->rootGroup()->entriesRecursive();
+    const auto siteUrl = DatabaseGenerator::url(42);
+
+    QBENCHMARK
+    {
+        browserService()->sortEntries(entries, siteUrl, siteUrl);
+    }
+}
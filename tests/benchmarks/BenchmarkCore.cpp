@@ -0,0 +1,219 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkCore.h"
+#include "DatabaseGenerator.h"
+
+#include "core/Database.h"
+#include "core/EntrySearcher.h"
+#include "core/Group.h"
+#include "core/HibpOffline.h"
+#include "core/Merger.h"
+#include "core/PasswordHealth.h"
+#include "crypto/Crypto.h"
+#include "format/CsvParser.h"
+#include "format/KeePass2Reader.h"
+#include "format/KeePass2Writer.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QTemporaryFile>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(BenchmarkCore)
+
+void BenchmarkCore::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void BenchmarkCore::benchmarkKdbx4Write_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkCore::benchmarkKdbx4Write()
+{
+    QFETCH(int, entryCount);
+    auto db = DatabaseGenerator::generate(entryCount);
+
+    QBENCHMARK
+    {
+        QBuffer buffer;
+        buffer.open(QBuffer::WriteOnly);
+        KeePass2Writer writer;
+        QVERIFY(writer.writeDatabase(&buffer, db.data()));
+    }
+}
+
+void BenchmarkCore::benchmarkKdbx4Read_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkCore::benchmarkKdbx4Read()
+{
+    QFETCH(int, entryCount);
+    QByteArray data;
+    {
+        auto db = DatabaseGenerator::generate(entryCount);
+        QBuffer buffer(&data);
+        buffer.open(QBuffer::WriteOnly);
+        KeePass2Writer writer;
+        QVERIFY(writer.writeDatabase(&buffer, db.data()));
+    }
+
+    const auto key = DatabaseGenerator::key();
+    QBENCHMARK
+    {
+        QBuffer buffer(&data);
+        buffer.open(QBuffer::ReadOnly);
+        Database db;
+        KeePass2Reader reader;
+        QVERIFY(reader.readDatabase(&buffer, key, &db));
+    }
+}
+
+void BenchmarkCore::benchmarkEntrySearcher_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkCore::benchmarkEntrySearcher()
+{
+    QFETCH(int, entryCount);
+    auto db = DatabaseGenerator::generate(entryCount);
+    const QStringList queries = {"user42", "url:domain7.com", "title:\"Entry 9\" -notes:nothing", "tag:synthetic"};
+
+    EntrySearcher searcher;
+    QBENCHMARK
+    {
+        for (const auto& query : queries) {
+            searcher.search(query, db->rootGroup());
+        }
+    }
+}
+
+void BenchmarkCore::benchmarkMerge_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkCore::benchmarkMerge()
+{
+    QFETCH(int, entryCount);
+    auto source = DatabaseGenerator::generate(entryCount);
+    auto target = QSharedPointer<Database>::create();
+    auto oldRoot = target->setRootGroup(source->rootGroup()->clone(Entry::CloneNoFlags, Group::CloneIncludeEntries));
+    delete oldRoot;
+
+    // Change every tenth entry of the source, the merge has to update them in the target
+    int index = 0;
+    source->rootGroup()->forEachEntryRecursive([&index](Entry* entry) {
+        if (index++ % 10 == 0) {
+            entry->setNotes("Changed");
+            auto timeInfo = entry->timeInfo();
+            timeInfo.setLastModificationTime(timeInfo.lastModificationTime().addSecs(60));
+            entry->setTimeInfo(timeInfo);
+        }
+        return true;
+    });
+
+    // The databases are in sync after a merge, so it is measured once
+    QBENCHMARK_ONCE
+    {
+        Merger merger(source.data(), target.data());
+        merger.merge();
+    }
+}
+
+void BenchmarkCore::benchmarkCsvParser_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkCore::benchmarkCsvParser()
+{
+    QFETCH(int, entryCount);
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("\"Group\",\"Title\",\"Username\",\"Password\",\"URL\",\"Notes\"\n");
+    for (int i = 0; i < entryCount; ++i) {
+        file.write(QString("\"Root/Group %1\",\"Entry %2\",\"user%2@example.com\",\"%3\",\"%4\",\"Line 1\nLine 2\"\n")
+                       .arg(i / 100)
+                       .arg(i)
+                       .arg(DatabaseGenerator::password(i), DatabaseGenerator::url(i))
+                       .toUtf8());
+    }
+    file.close();
+
+    QBENCHMARK
+    {
+        CsvParser parser;
+        QVERIFY(parser.parse(&file));
+    }
+}
+
+void BenchmarkCore::benchmarkPasswordHealth_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkCore::benchmarkPasswordHealth()
+{
+    QFETCH(int, entryCount);
+    auto db = DatabaseGenerator::generate(entryCount);
+    const auto entries = db->rootGroup()->entriesRecursive();
+
+    QBENCHMARK
+    {
+        HealthChecker checker(db);
+        for (const auto* entry : entries) {
+            checker.evaluate(entry);
+        }
+    }
+}
+
+void BenchmarkCore::benchmarkHibpOffline_data()
+{
+    DatabaseGenerator::addSizes();
+}
+
+void BenchmarkCore::benchmarkHibpOffline()
+{
+    QFETCH(int, entryCount);
+    auto db = DatabaseGenerator::generate(entryCount);
+
+    // Every other password is pwned, the rest of the file are unrelated hashes
+    QByteArray hibpContents;
+    for (int i = 0; i < entryCount; ++i) {
+        const auto password = i % 2 == 0 ? DatabaseGenerator::password(i) : QString("unrelated %1").arg(i);
+        hibpContents.append(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha1).toHex().toUpper());
+        hibpContents.append(':');
+        hibpContents.append(QByteArray::number(i + 1));
+        hibpContents.append('\n');
+    }
+
+    QBENCHMARK
+    {
+        QBuffer buffer(&hibpContents);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        QList<QPair<const Entry*, int>> findings;
+        QString error;
+        QVERIFY(HibpOffline::report(db, buffer, findings, &error));
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BENCHMARKCORE_H
+#define KEEPASSXC_BENCHMARKCORE_H
+
+#include <QObject>
+
+class BenchmarkCore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void benchmarkKdbx4Write_data();
+    void benchmarkKdbx4Write();
+    void benchmarkKdbx4Read_data();
+    void benchmarkKdbx4Read();
+    void benchmarkEntrySearcher_data();
+    void benchmarkEntrySearcher();
+    void benchmarkMerge_data();
+    void benchmarkMerge();
+    void benchmarkCsvParser_data();
+    void benchmarkCsvParser();
+    void benchmarkPasswordHealth_data();
+    void benchmarkPasswordHealth();
+    void benchmarkHibpOffline_data();
+    void benchmarkHibpOffline();
+};
+
+#endif // KEEPASSXC_BENCHMARKCORE_H
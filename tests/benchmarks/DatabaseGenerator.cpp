@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseGenerator.h"
+
+#include "core/Database.h"
+#include "core/SyntheticDatabase.h"
+#include "format/KeePass2.h"
+#include "keys/CompositeKey.h"
+#include "keys/PasswordKey.h"
+
+#include <QTest>
+
+namespace DatabaseGenerator
+{
+    /**
+     * @param entryCount number of entries, not counting history items
+     * @return database with a fast KDF and the key of key()
+     */
+    QSharedPointer<Database> generate(int entryCount)
+    {
+        auto db = QSharedPointer<Database>::create();
+        auto kdf = KeePass2::uuidToKdf(KeePass2::KDF_AES_KDBX4);
+        kdf->setRounds(1);
+        db->changeKdf(kdf);
+        db->setKey(key());
+
+        SyntheticDatabase::Options options;
+        options.entries = entryCount;
+        options.groups = qMax(1, entryCount / 100);
+        SyntheticDatabase(options).populate(db.data());
+        return db;
+    }
+
+    QSharedPointer<const CompositeKey> key()
+    {
+        auto key = QSharedPointer<CompositeKey>::create();
+        key->addKey(QSharedPointer<PasswordKey>::create("benchmark"));
+        return key;
+    }
+
+    QString password(int index)
+    {
+        return SyntheticDatabase::password(index);
+    }
+
+    QString url(int index)
+    {
+        return SyntheticDatabase::url(index);
+    }
+
+    void addSizes()
+    {
+        QTest::addColumn<int>("entryCount");
+        QTest::newRow("1k") << 1000;
+        QTest::newRow("10k") << 10000;
+        QTest::newRow("100k") << 100000;
+    }
+} // namespace DatabaseGenerator
@@ -0,0 +1,45 @@
+/*
+ *  Copyright (C) 2026 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASEGENERATOR_H
+#define KEEPASSXC_DATABASEGENERATOR_H
+
+#include <QSharedPointer>
+
+class CompositeKey;
+class Database;
+
+/**
+ * Synthetic databases for the benchmarks.
+ *
+ * Databases are generated deterministically by SyntheticDatabase, so results
+ * of different builds can be compared. Entries are spread over groups of 100
+ * entries, their URLs over 1000 domains, and every tenth password is shared
+ * with other entries.
+ */
+namespace DatabaseGenerator
+{
+    QSharedPointer<Database> generate(int entryCount);
+    QSharedPointer<const CompositeKey> key();
+    QString password(int index);
+    QString url(int index);
+
+    // Database sizes every benchmark is run with
+    void addSizes();
+} // namespace DatabaseGenerator
+
+#endif // KEEPASSXC_DATABASEGENERATOR_H
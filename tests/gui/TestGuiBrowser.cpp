@@ -98,6 +98,7 @@ void TestGuiBrowser::init()
     QTest::keyClick(editPassword, Qt::Key_Enter);
 
     m_dbWidget = m_tabWidget->currentDatabaseWidget();
+    QTRY_VERIFY(!m_dbWidget->isLocked());
     m_db = m_dbWidget->database();
 }
 
@@ -334,6 +334,18 @@ void TestGuiFdoSecrets::testServiceSearch()
         COMPARE(unlocked, {QDBusObjectPath(item->path())});
     }
 
+    // search after modifying the attributes
+    {
+        entry->attributes()->set("fdosecrets-test", "3");
+        DBUS_GET2(unlocked, locked, service->SearchItems({{"fdosecrets-test", "1"}}));
+        COMPARE(locked, {});
+        COMPARE(unlocked, {});
+        DBUS_GET2(unlocked2, locked2, service->SearchItems({{"fdosecrets-test", "3"}, {"Title", entry->title()}}));
+        COMPARE(locked2, {});
+        COMPARE(unlocked2, {QDBusObjectPath(item->path())});
+        entry->attributes()->set("fdosecrets-test", "1");
+    }
+
     // searching using empty terms returns nothing
     {
         DBUS_GET2(unlocked, locked, service->SearchItems({}));
@@ -380,9 +392,8 @@ void TestGuiFdoSecrets::testServiceSearchBlockingUnlock()
     // when database is locked, nothing is returned
     FdoSecrets::settings()->setUnlockBeforeSearch(true);
     {
-        // SearchItems will block because the blocking wait is implemented
-        // using a local QEventLoop.
-        // so we do a little trick here to get the return value back
+        // SearchItems only replies once the database is unlocked,
+        // so we do a little trick here to drive the dialog while waiting for the reply
         bool unlockDialogWorks = false;
         QTimer::singleShot(50, [&]() { unlockDialogWorks = driveUnlockDialog(); });
 
@@ -1216,6 +1227,13 @@ void TestGuiFdoSecrets::testItemChange()
         COMPARE(args.size(), 1);
         COMPARE(args.at(0).value<QDBusObjectPath>().path(), item->path());
     }
+
+    // repeated changes are sent in one batch
+    spyItemChanged.clear();
+    entry->setNotes("first");
+    entry->setNotes("second");
+    VERIFY(waitForSignal(spyItemChanged, 1));
+    COMPARE(spyItemChanged.first().at(0).value<QDBusObjectPath>().path(), item->path());
 }
 
 void TestGuiFdoSecrets::testItemReplace()
@@ -1299,7 +1317,7 @@ void TestGuiFdoSecrets::testItemReplace()
             COMPARE(args.at(0).value<QDBusObjectPath>().path(), item4->path());
         }
         // there may be multiple changed signals, due to each item attribute is set separately
-        VERIFY(!spyItemChanged.isEmpty());
+        QTRY_VERIFY(!spyItemChanged.isEmpty());
         for (const auto& args : spyItemChanged) {
             COMPARE(args.size(), 1);
             COMPARE(args.at(0).value<QDBusObjectPath>().path(), item4->path());
@@ -1696,6 +1714,8 @@ void TestGuiFdoSecrets::lockDatabaseInBackend()
 void TestGuiFdoSecrets::unlockDatabaseInBackend()
 {
     m_dbWidget->performUnlockDatabase("a");
+    // The database is read in a worker thread
+    QTRY_VERIFY(!m_dbWidget->isLocked());
     m_db = m_dbWidget->database();
     processEvents();
 }
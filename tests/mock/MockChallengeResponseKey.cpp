@@ -33,3 +33,8 @@ bool MockChallengeResponseKey::challenge(const QByteArray& challenge)
     m_challenge = challenge;
     return true;
 }
+
+bool MockChallengeResponseKey::hasResponse(const QByteArray& challenge) const
+{
+    return !challenge.isEmpty() && m_challenge == challenge;
+}
@@ -33,6 +33,7 @@ public:
     QByteArray rawKey() const override;
 
     bool challenge(const QByteArray& challenge) override;
+    bool hasResponse(const QByteArray& challenge) const override;
 
 private:
     QByteArray m_challenge;
@@ -27,7 +27,9 @@ MockRemoteProcess::MockRemoteProcess(QObject* parent, const QString& dbPath)
 
 void MockRemoteProcess::start(const QString&)
 {
-    QFile ::copy(m_dbPath, m_tempFileLocation);
+    // The download file of a remote is kept between syncs
+    QFile::remove(m_tempFileLocation);
+    QFile::copy(m_dbPath, m_tempFileLocation);
 }
 
 qint64 MockRemoteProcess::write(const QString& data)